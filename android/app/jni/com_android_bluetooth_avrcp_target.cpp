@@ -107,6 +107,20 @@ class AvrcpMediaInterfaceImpl : public MediaInterface {
     getFolderItems(player_id, media_id, folder_cb);
   }
 
+  void GetFolderItemsRange(uint16_t player_id, std::string media_id,
+                           uint32_t start_item, uint32_t end_item,
+                           FolderItemsRangeCallback folder_cb) override {
+    // The Java media layer has no paging support so always hand back the
+    // whole folder, the native service caches it and serves later pages.
+    auto cb_lambda = [](FolderItemsRangeCallback cb,
+                        std::vector<ListItem> item_list) {
+      uint32_t total_items = item_list.size();
+      cb.Run(total_items, 0, std::move(item_list));
+    };
+
+    getFolderItems(player_id, media_id, base::Bind(cb_lambda, folder_cb));
+  }
+
   void SetBrowsedPlayer(uint16_t player_id,
                         SetBrowsedPlayerCallback browse_cb) override {
     setBrowsedPlayer(player_id, browse_cb);
@@ -21,6 +21,8 @@
 #include <grp.h>
 #include <sys/stat.h>
 
+#include <algorithm>
+#include <cstring>
 #include <memory>
 
 #include "a2dp_encoding.h"
@@ -38,6 +40,10 @@
 #define A2DP_HOST_DATA_PATH "/var/run/bluetooth/audio/.a2dp_data"
 // TODO(b/198260375): Make A2DP data owner group configurable.
 #define A2DP_HOST_DATA_GROUP "bluetooth-audio"
+// When set, PCM is carried over a shared memory ring handed over to the audio
+// server on the data socket rather than over the socket itself.
+#define A2DP_HOST_DATA_RING_PROPERTY "bluetooth.a2dp.data_ring.enabled"
+#define A2DP_HOST_DATA_RING_SIZE (32 * 1024)
 
 namespace {
 
@@ -90,6 +96,10 @@ static void btif_a2dp_data_cb([[maybe_unused]] tUIPC_CH_ID ch_id,
 static void a2dp_data_path_open() {
   UIPC_Open(*a2dp_uipc, UIPC_CH_ID_AV_AUDIO, btif_a2dp_data_cb,
             A2DP_HOST_DATA_PATH);
+  if (osi_property_get_bool(A2DP_HOST_DATA_RING_PROPERTY, false)) {
+    UIPC_Ioctl(*a2dp_uipc, UIPC_CH_ID_AV_AUDIO, UIPC_SET_SHM_RING,
+               reinterpret_cast<void*>(A2DP_HOST_DATA_RING_SIZE));
+  }
   struct group* grp = getgrnam(A2DP_HOST_DATA_GROUP);
   chmod(A2DP_HOST_DATA_PATH, 0770);
   if (grp) {
@@ -264,7 +274,18 @@ size_t read(uint8_t* p_buf, uint32_t len) {
   if (a2dp_uipc == nullptr) {
     return 0;
   }
-  bytes_read = UIPC_Read(*a2dp_uipc, UIPC_CH_ID_AV_AUDIO, p_buf, len);
+  // PCM on the shared memory ring is taken straight from the ring, without
+  // staging it through UIPC_Read
+  uint32_t avail = 0;
+  const uint8_t* p_data =
+      UIPC_AcquireRead(*a2dp_uipc, UIPC_CH_ID_AV_AUDIO, len, &avail);
+  if (p_data != nullptr) {
+    bytes_read = std::min(avail, len);
+    memcpy(p_buf, p_data, bytes_read);
+    UIPC_ReleaseRead(*a2dp_uipc, UIPC_CH_ID_AV_AUDIO, bytes_read);
+  } else {
+    bytes_read = UIPC_Read(*a2dp_uipc, UIPC_CH_ID_AV_AUDIO, p_buf, len);
+  }
   total_bytes_read_ += bytes_read;
   // MONOTONIC_RAW isn't affected by NTP, audio stack rely on this
   // to get precise delay calculation.
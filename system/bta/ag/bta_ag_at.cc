@@ -23,12 +23,17 @@
  ******************************************************************************/
 #define LOG_TAG "bta_ag_at"
 
+#include <algorithm>
 #include <cstdint>
+#include <cstring>
+#include <map>
+#include <vector>
 
 #include "bt_target.h"  // Must be first to define build configuration:
 
 #include "bta/ag/bta_ag_at.h"
 #include "bta/ag/bta_ag_int.h"
+#include "bta/include/bta_at_index.h"
 #include "bta/include/utl.h"
 #include "osi/include/allocator.h"
 #include "osi/include/log.h"
@@ -37,17 +42,45 @@
  *  Constants
  ****************************************************************************/
 
+/******************************************************************************
+ *
+ * Function         bta_ag_at_index
+ *
+ * Description      Get the index over the command names of an AT command
+ *                  table, building it on first use.  Only called from the
+ *                  BTA thread.
+ *
+ *
+ * Returns          The index
+ *
+ *****************************************************************************/
+static const BtaAtIndex* bta_ag_at_index(const tBTA_AG_AT_CMD* p_at_tbl) {
+  static std::map<const tBTA_AG_AT_CMD*, BtaAtIndex> indexes;
+
+  auto it = indexes.find(p_at_tbl);
+  if (it == indexes.end()) {
+    std::vector<const char*> names;
+    for (size_t idx = 0; p_at_tbl[idx].p_cmd[0] != 0; idx++) {
+      names.push_back(p_at_tbl[idx].p_cmd);
+    }
+    it = indexes.emplace(p_at_tbl, BtaAtIndex(names, true)).first;
+  }
+  return &it->second;
+}
+
 /******************************************************************************
  *
  * Function         bta_ag_at_init
  *
- * Description      Initialize the AT command parser control block.
+ * Description      Initialize the AT command parser control block.  The
+ *                  command table must be set before.
  *
  *
  * Returns          void
  *
  *****************************************************************************/
 void bta_ag_at_init(tBTA_AG_AT_CB* p_cb) {
+  p_cb->p_at_index = bta_ag_at_index(p_cb->p_at_tbl);
   p_cb->p_cmd_buf = nullptr;
   p_cb->cmd_pos = 0;
 }
@@ -82,19 +115,15 @@ void bta_ag_at_reinit(tBTA_AG_AT_CB* p_cb) {
  *
  *****************************************************************************/
 void bta_ag_process_at(tBTA_AG_AT_CB* p_cb, char* p_end) {
-  uint16_t idx;
+  size_t idx;
   uint8_t arg_type;
   char* p_arg;
   int16_t int_arg = 0;
-  /* loop through at command table looking for match */
-  for (idx = 0; p_cb->p_at_tbl[idx].p_cmd[0] != 0; idx++) {
-    if (!utl_strucmp(p_cb->p_at_tbl[idx].p_cmd, p_cb->p_cmd_buf)) {
-      break;
-    }
-  }
+  /* find the first command in the table that the buffer starts with */
+  idx = p_cb->p_at_index->Find(p_cb->p_cmd_buf);
 
   /* if there is a match; verify argument type */
-  if (p_cb->p_at_tbl[idx].p_cmd[0] != 0) {
+  if (idx != BtaAtIndex::kNoMatch) {
     /* start of argument is p + strlen matching command */
     p_arg = p_cb->p_cmd_buf + strlen(p_cb->p_at_tbl[idx].p_cmd);
     if (p_arg > p_end) {
@@ -159,7 +188,7 @@ void bta_ag_process_at(tBTA_AG_AT_CB* p_cb, char* p_end) {
     }
   } else {
     /* else no match call error callback */
-    LOG_WARN("Unmatched command index %d", idx);
+    LOG_WARN("Unmatched command");
     (*p_cb->p_err_cback)((tBTA_AG_SCB*)p_cb->p_user, true, p_cb->p_cmd_buf);
   }
 }
@@ -177,7 +206,7 @@ void bta_ag_process_at(tBTA_AG_AT_CB* p_cb, char* p_end) {
  *
  *****************************************************************************/
 void bta_ag_at_parse(tBTA_AG_AT_CB* p_cb, char* p_buf, uint16_t len) {
-  int i = 0;
+  uint16_t i = 0;
   char* p_save;
 
   if (p_cb->p_cmd_buf == nullptr) {
@@ -185,40 +214,51 @@ void bta_ag_at_parse(tBTA_AG_AT_CB* p_cb, char* p_buf, uint16_t len) {
     p_cb->cmd_pos = 0;
   }
 
-  for (i = 0; i < len;) {
-    while (p_cb->cmd_pos < p_cb->cmd_max_len - 1 && i < len) {
-      /* Skip null characters between AT commands. */
-      if ((p_cb->cmd_pos == 0) && (p_buf[i] == 0)) {
-        i++;
-        continue;
-      }
+  /* a buffer can hold several commands, or parts of them */
+  while (i < len) {
+    /* Skip null characters between AT commands. */
+    if (p_cb->cmd_pos == 0) {
+      while (i < len && p_buf[i] == 0) i++;
+      if (i == len) break;
+    }
 
-      p_cb->p_cmd_buf[p_cb->cmd_pos] = p_buf[i++];
-      if (p_cb->p_cmd_buf[p_cb->cmd_pos] == '\r' ||
-          p_cb->p_cmd_buf[p_cb->cmd_pos] == '\n') {
-        p_cb->p_cmd_buf[p_cb->cmd_pos] = 0;
-        if ((p_cb->cmd_pos > 2) &&
-            (p_cb->p_cmd_buf[0] == 'A' || p_cb->p_cmd_buf[0] == 'a') &&
-            (p_cb->p_cmd_buf[1] == 'T' || p_cb->p_cmd_buf[1] == 't')) {
-          p_save = p_cb->p_cmd_buf;
-          char* p_end = p_cb->p_cmd_buf + p_cb->cmd_pos;
-          p_cb->p_cmd_buf += 2;
-          bta_ag_process_at(p_cb, p_end);
-          p_cb->p_cmd_buf = p_save;
-        }
+    /* drop a command that does not fit, and parse the rest of the buffer */
+    uint16_t room = p_cb->cmd_max_len - 1 - p_cb->cmd_pos;
+    if (room == 0) {
+      p_cb->cmd_pos = 0;
+      continue;
+    }
 
-        p_cb->cmd_pos = 0;
+    /* copy up to the end of the command in one go */
+    uint16_t run = 0;
+    uint16_t max_run = std::min<uint16_t>(room, len - i);
+    while (run < max_run && p_buf[i + run] != '\r' && p_buf[i + run] != '\n' &&
+           p_buf[i + run] != 0x1A && p_buf[i + run] != 0x1B) {
+      run++;
+    }
+    memcpy(p_cb->p_cmd_buf + p_cb->cmd_pos, p_buf + i, run);
+    p_cb->cmd_pos += run;
+    i += run;
+    if (run == max_run) continue;
 
-      } else if (p_cb->p_cmd_buf[p_cb->cmd_pos] == 0x1A ||
-                 p_cb->p_cmd_buf[p_cb->cmd_pos] == 0x1B) {
-        p_cb->p_cmd_buf[++p_cb->cmd_pos] = 0;
-        (*p_cb->p_err_cback)((tBTA_AG_SCB*)p_cb->p_user, true, p_cb->p_cmd_buf);
-        p_cb->cmd_pos = 0;
-      } else {
-        ++p_cb->cmd_pos;
+    char c = p_buf[i++];
+    if (c == '\r' || c == '\n') {
+      p_cb->p_cmd_buf[p_cb->cmd_pos] = 0;
+      if ((p_cb->cmd_pos > 2) &&
+          (p_cb->p_cmd_buf[0] == 'A' || p_cb->p_cmd_buf[0] == 'a') &&
+          (p_cb->p_cmd_buf[1] == 'T' || p_cb->p_cmd_buf[1] == 't')) {
+        p_save = p_cb->p_cmd_buf;
+        char* p_end = p_cb->p_cmd_buf + p_cb->cmd_pos;
+        p_cb->p_cmd_buf += 2;
+        bta_ag_process_at(p_cb, p_end);
+        p_cb->p_cmd_buf = p_save;
       }
+    } else {
+      /* 0x1A or 0x1B */
+      p_cb->p_cmd_buf[p_cb->cmd_pos] = c;
+      p_cb->p_cmd_buf[++p_cb->cmd_pos] = 0;
+      (*p_cb->p_err_cback)((tBTA_AG_SCB*)p_cb->p_user, true, p_cb->p_cmd_buf);
     }
-
-    if (i < len) p_cb->cmd_pos = 0;
+    p_cb->cmd_pos = 0;
   }
 }
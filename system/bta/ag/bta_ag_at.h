@@ -58,6 +58,7 @@ typedef struct {
 } tBTA_AG_AT_CMD;
 
 /* callback function executed when command is parsed */
+class BtaAtIndex;
 struct tBTA_AG_SCB;
 typedef void(tBTA_AG_AT_CMD_CBACK)(tBTA_AG_SCB* p_user, uint16_t command_id,
                                    uint8_t arg_type, char* p_arg, char* p_end,
@@ -70,6 +71,7 @@ typedef void(tBTA_AG_AT_ERR_CBACK)(tBTA_AG_SCB* p_user, bool unknown,
 /* AT command parsing control block */
 typedef struct {
   const tBTA_AG_AT_CMD* p_at_tbl;    /* AT command table */
+  const BtaAtIndex* p_at_index;      /* index over p_at_tbl command names */
   tBTA_AG_AT_CMD_CBACK* p_cmd_cback; /* command callback */
   tBTA_AG_AT_ERR_CBACK* p_err_cback; /* error callback */
   void* p_user;                      /* user-defined data */
@@ -87,7 +89,8 @@ typedef struct {
  *
  * Function         bta_ag_at_init
  *
- * Description      Initialize the AT command parser control block.
+ * Description      Initialize the AT command parser control block.  The
+ *                  command table must be set before.
  *
  *
  * Returns          void
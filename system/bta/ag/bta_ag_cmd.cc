@@ -496,31 +496,20 @@ static tBTA_AG_PEER_CODEC bta_ag_parse_bac(tBTA_AG_SCB* p_scb, char* p_s,
  ******************************************************************************/
 
 static void bta_ag_process_unat_res(char* unat_result) {
-  uint8_t j = 0;
-  uint8_t pairs_of_nl_cr;
-  char trim_data[BTA_AG_AT_MAX_LEN];
-
-  uint8_t str_leng = strlen(unat_result);
-
-  /* If no extra CR and LF, just return */
-  if (str_leng < 4) return;
-
-  /* Remove the carriage return and left feed */
-  while (unat_result[0] == '\r' && unat_result[1] == '\n' &&
-         unat_result[str_leng - 2] == '\r' &&
-         unat_result[str_leng - 1] == '\n') {
-    pairs_of_nl_cr = 1;
-    for (int i = 0; i < (str_leng - 4 * pairs_of_nl_cr); i++) {
-      trim_data[j++] = unat_result[i + pairs_of_nl_cr * 2];
-    }
-    /* Add EOF */
-    trim_data[j] = '\0';
-    str_leng = str_leng - 4;
-    strlcpy(unat_result, trim_data, str_leng + 1);
-    j = 0;
-
-    if (str_leng < 4) return;
+  size_t start = 0;
+  size_t end = strlen(unat_result);
+
+  /* Remove the carriage return and line feed pairs around the result */
+  while (end - start >= 4 && unat_result[start] == '\r' &&
+         unat_result[start + 1] == '\n' && unat_result[end - 2] == '\r' &&
+         unat_result[end - 1] == '\n') {
+    start += 2;
+    end -= 2;
   }
+  if (start == 0) return;
+
+  memmove(unat_result, unat_result + start, end - start);
+  unat_result[end - start] = '\0';
 }
 
 /*******************************************************************************
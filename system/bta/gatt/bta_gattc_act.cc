@@ -532,7 +532,7 @@ void bta_gattc_conn(tBTA_GATTC_CLCB* p_clcb, const tBTA_GATTC_DATA* p_data) {
   }
 
   /* start database cache if needed */
-  if (p_clcb->p_srcb->gatt_database.IsEmpty() ||
+  if (p_clcb->p_srcb->gatt_database->IsEmpty() ||
       p_clcb->p_srcb->state != BTA_GATTC_SERV_IDLE) {
     if (p_clcb->p_srcb->state == BTA_GATTC_SERV_IDLE) {
       p_clcb->p_srcb->state = BTA_GATTC_SERV_LOAD;
@@ -540,9 +540,9 @@ void bta_gattc_conn(tBTA_GATTC_CLCB* p_clcb, const tBTA_GATTC_DATA* p_data) {
       // changed indication is received, the database might be out of date. So
       // if robust caching is enabled, any time when connection is established,
       // always check the db hash first, not just load the stored database.
-      gatt::Database db = bta_gattc_cache_load(p_clcb->p_srcb->server_bda);
-      if (!bta_gattc_is_robust_caching_enabled() && !db.IsEmpty()) {
-        p_clcb->p_srcb->gatt_database = db;
+      auto db = bta_gattc_cache_load(p_clcb->p_srcb->server_bda);
+      if (!bta_gattc_is_robust_caching_enabled() && db) {
+        p_clcb->p_srcb->gatt_database = std::move(db);
         p_clcb->p_srcb->state = BTA_GATTC_SERV_IDLE;
         bta_gattc_reset_discover_st(p_clcb->p_srcb, GATT_SUCCESS);
       } else {
@@ -810,7 +810,7 @@ void bta_gattc_disc_cmpl(tBTA_GATTC_CLCB* p_clcb,
   if (p_clcb->status != GATT_SUCCESS) {
     /* clean up cache */
     if (p_clcb->p_srcb) {
-      p_clcb->p_srcb->gatt_database.Clear();
+      p_clcb->p_srcb->gatt_database = std::make_shared<const gatt::Database>();
     }
 
     /* used to reset cache in application */
@@ -889,6 +889,7 @@ void bta_gattc_read_multi(tBTA_GATTC_CLCB* p_clcb,
 
   read_param.read_multiple.num_handles = p_data->api_read_multi.num_attr;
   read_param.read_multiple.auth_req = p_data->api_read_multi.auth_req;
+  read_param.read_multiple.variable_len = p_data->api_read_multi.variable_len;
   memcpy(&read_param.read_multiple.handles, p_data->api_read_multi.handles,
          sizeof(uint16_t) * p_data->api_read_multi.num_attr);
 
@@ -985,6 +986,31 @@ static void bta_gattc_read_cmpl(tBTA_GATTC_CLCB* p_clcb,
   }
 }
 
+/** read multiple complete */
+static void bta_gattc_read_multi_cmpl(tBTA_GATTC_CLCB* p_clcb,
+                                      const tBTA_GATTC_OP_CMPL* p_data) {
+  GATT_READ_MULTI_OP_CB cb = p_clcb->p_q_cmd->api_read_multi.read_cb;
+  void* my_cb_data = p_clcb->p_q_cmd->api_read_multi.read_cb_data;
+
+  tBTA_GATTC_MULTI handles;
+  handles.num_attr = p_clcb->p_q_cmd->api_read_multi.num_attr;
+  memcpy(handles.handles, p_clcb->p_q_cmd->api_read_multi.handles,
+         sizeof(uint16_t) * handles.num_attr);
+
+  osi_free_and_reset((void**)&p_clcb->p_q_cmd);
+
+  if (cb) {
+    if (p_data->p_cmpl == nullptr) {
+      cb(p_clcb->bta_conn_id, p_data->status, handles, 0, nullptr,
+         my_cb_data);
+      return;
+    }
+    cb(p_clcb->bta_conn_id, p_data->status, handles,
+       p_data->p_cmpl->att_value.len, p_data->p_cmpl->att_value.value,
+       my_cb_data);
+  }
+}
+
 /** write complete */
 static void bta_gattc_write_cmpl(tBTA_GATTC_CLCB* p_clcb,
                                  const tBTA_GATTC_OP_CMPL* p_data) {
@@ -1079,8 +1105,10 @@ void bta_gattc_op_cmpl(tBTA_GATTC_CLCB* p_clcb, const tBTA_GATTC_DATA* p_data) {
       return;
   }
 
-  if (p_clcb->p_q_cmd->hdr.event !=
-      bta_gattc_opcode_to_int_evt[op - GATTC_OPTYPE_READ]) {
+  bool read_multi = op == GATTC_OPTYPE_READ &&
+                    p_clcb->p_q_cmd->hdr.event == BTA_GATTC_API_READ_MULTI_EVT;
+  if (!read_multi && p_clcb->p_q_cmd->hdr.event !=
+                         bta_gattc_opcode_to_int_evt[op - GATTC_OPTYPE_READ]) {
     uint8_t mapped_op =
         p_clcb->p_q_cmd->hdr.event - BTA_GATTC_API_READ_EVT + GATTC_OPTYPE_READ;
     if (mapped_op > GATTC_OPTYPE_INDICATION) mapped_op = 0;
@@ -1104,7 +1132,10 @@ void bta_gattc_op_cmpl(tBTA_GATTC_CLCB* p_clcb, const tBTA_GATTC_DATA* p_data) {
   }
 
   /* service handle change void the response, discard it */
-  if (op == GATTC_OPTYPE_READ)
+  if (read_multi)
+    bta_gattc_read_multi_cmpl(p_clcb, &p_data->op_cmpl);
+
+  else if (op == GATTC_OPTYPE_READ)
     bta_gattc_read_cmpl(p_clcb, &p_data->op_cmpl);
 
   else if (op == GATTC_OPTYPE_WRITE)
@@ -1145,7 +1176,7 @@ void bta_gattc_search(tBTA_GATTC_CLCB* p_clcb, const tBTA_GATTC_DATA* p_data) {
   tGATT_STATUS status = GATT_INTERNAL_ERROR;
   tBTA_GATTC cb_data;
   VLOG(1) << __func__ << ": conn_id=" << loghex(p_clcb->bta_conn_id);
-  if (p_clcb->p_srcb && !p_clcb->p_srcb->gatt_database.IsEmpty()) {
+  if (p_clcb->p_srcb && !p_clcb->p_srcb->gatt_database->IsEmpty()) {
     status = GATT_SUCCESS;
     /* search the local cache of a server device */
     bta_gattc_search_service(p_clcb, p_data->api_search.p_srvc_uuid);
@@ -1262,7 +1293,7 @@ void bta_gattc_process_api_refresh(const RawAddress& remote_bda) {
     }
     /* in all other cases, mark it and delete the cache */
 
-    p_srvc_cb->gatt_database.Clear();
+    p_srvc_cb->gatt_database = std::make_shared<const gatt::Database>();
   }
 
   /* used to reset cache in application */
@@ -1279,10 +1310,11 @@ static bool bta_gattc_process_srvc_chg_ind(uint16_t conn_id,
   Uuid gattp_uuid = Uuid::From16Bit(UUID_SERVCLASS_GATT_SERVER);
   Uuid srvc_chg_uuid = Uuid::From16Bit(GATT_UUID_GATT_SRV_CHGD);
 
-  if (p_srcb->gatt_database.IsEmpty() && p_srcb->state == BTA_GATTC_SERV_IDLE) {
-    gatt::Database db = bta_gattc_cache_load(p_srcb->server_bda);
-    if (!db.IsEmpty()) {
-      p_srcb->gatt_database = db;
+  if (p_srcb->gatt_database->IsEmpty() &&
+      p_srcb->state == BTA_GATTC_SERV_IDLE) {
+    auto db = bta_gattc_cache_load(p_srcb->server_bda);
+    if (db) {
+      p_srcb->gatt_database = std::move(db);
     }
   }
 
@@ -108,20 +108,10 @@ static void bta_gattc_display_explore_record(const DatabaseBuilder& database) {
 
 /** Initialize the database cache and discovery related resources */
 void bta_gattc_init_cache(tBTA_GATTC_SERV* p_srvc_cb) {
-  p_srvc_cb->gatt_database = gatt::Database();
+  p_srvc_cb->gatt_database = std::make_shared<const gatt::Database>();
   p_srvc_cb->pending_discovery.Clear();
 }
 
-const Service* bta_gattc_find_matching_service(
-    const std::list<Service>& services, uint16_t handle) {
-  for (const Service& service : services) {
-    if (handle >= service.handle && handle <= service.end_handle)
-      return &service;
-  }
-
-  return nullptr;
-}
-
 /** Start primary service discovery */
 tGATT_STATUS bta_gattc_discover_pri_service(uint16_t conn_id,
                                             tBTA_GATTC_SERV* p_server_cb,
@@ -210,10 +200,11 @@ static void bta_gattc_explore_srvc_finished(uint16_t conn_id,
   /* no service found at all, the end of server discovery*/
   LOG(INFO) << __func__ << ": service discovery finished";
 
-  p_srvc_cb->gatt_database = p_srvc_cb->pending_discovery.Build();
+  p_srvc_cb->gatt_database = std::make_shared<const gatt::Database>(
+      p_srvc_cb->pending_discovery.Build());
 
 #if (BTA_GATT_DEBUG == TRUE)
-  bta_gattc_display_cache_server(p_srvc_cb->gatt_database);
+  bta_gattc_display_cache_server(*p_srvc_cb->gatt_database);
 #endif
   /* save cache to NV */
   p_clcb->p_srcb->state = BTA_GATTC_SERV_SAVE;
@@ -226,7 +217,7 @@ static void bta_gattc_explore_srvc_finished(uint16_t conn_id,
     }
   } else {
     // If robust caching is enabled, do something optimized
-    Octet16 hash = p_clcb->p_srcb->gatt_database.Hash();
+    Octet16 hash = p_clcb->p_srcb->gatt_database->Hash();
     bool success = bta_gattc_hash_write(hash, p_clcb->p_srcb->gatt_database);
 
     // If the device is trusted, link the addr file to hash file
@@ -502,7 +493,7 @@ void bta_gattc_disc_cmpl_cback(uint16_t conn_id, tGATT_DISC_TYPE disc_type,
 
 /** search local cache for matching service record */
 void bta_gattc_search_service(tBTA_GATTC_CLCB* p_clcb, Uuid* p_uuid) {
-  for (const Service& service : p_clcb->p_srcb->gatt_database.Services()) {
+  for (const Service& service : p_clcb->p_srcb->gatt_database->Services()) {
     if (p_uuid && *p_uuid != service.uuid) continue;
 
 #if (BTA_GATT_DEBUG == TRUE)
@@ -522,9 +513,9 @@ void bta_gattc_search_service(tBTA_GATTC_CLCB* p_clcb, Uuid* p_uuid) {
 }
 
 const std::list<Service>* bta_gattc_get_services_srcb(tBTA_GATTC_SERV* p_srcb) {
-  if (!p_srcb || p_srcb->gatt_database.IsEmpty()) return NULL;
+  if (!p_srcb || p_srcb->gatt_database->IsEmpty()) return NULL;
 
-  return &p_srcb->gatt_database.Services();
+  return &p_srcb->gatt_database->Services();
 }
 
 const std::list<Service>* bta_gattc_get_services(uint16_t conn_id) {
@@ -539,31 +530,22 @@ const std::list<Service>* bta_gattc_get_services(uint16_t conn_id) {
 
 const Service* bta_gattc_get_service_for_handle_srcb(tBTA_GATTC_SERV* p_srcb,
                                                      uint16_t handle) {
-  const std::list<Service>* services = bta_gattc_get_services_srcb(p_srcb);
-  if (services == NULL) return NULL;
-  return bta_gattc_find_matching_service(*services, handle);
+  if (!p_srcb) return NULL;
+  return p_srcb->gatt_database->FindService(handle);
 }
 
 const Service* bta_gattc_get_service_for_handle(uint16_t conn_id,
                                                 uint16_t handle) {
-  const std::list<Service>* services = bta_gattc_get_services(conn_id);
-  if (services == NULL) return NULL;
+  tBTA_GATTC_CLCB* p_clcb = bta_gattc_find_clcb_by_conn_id(conn_id);
+  if (p_clcb == NULL) return NULL;
 
-  return bta_gattc_find_matching_service(*services, handle);
+  return bta_gattc_get_service_for_handle_srcb(p_clcb->p_srcb, handle);
 }
 
 const Characteristic* bta_gattc_get_characteristic_srcb(tBTA_GATTC_SERV* p_srcb,
                                                         uint16_t handle) {
-  const Service* service =
-      bta_gattc_get_service_for_handle_srcb(p_srcb, handle);
-
-  if (!service) return NULL;
-
-  for (const Characteristic& charac : service->characteristics) {
-    if (handle == charac.value_handle) return &charac;
-  }
-
-  return NULL;
+  if (!p_srcb) return NULL;
+  return p_srcb->gatt_database->FindCharacteristic(handle);
 }
 
 const Characteristic* bta_gattc_get_characteristic(uint16_t conn_id,
@@ -578,20 +560,8 @@ const Characteristic* bta_gattc_get_characteristic(uint16_t conn_id,
 
 const Descriptor* bta_gattc_get_descriptor_srcb(tBTA_GATTC_SERV* p_srcb,
                                                 uint16_t handle) {
-  const Service* service =
-      bta_gattc_get_service_for_handle_srcb(p_srcb, handle);
-
-  if (!service) {
-    return NULL;
-  }
-
-  for (const Characteristic& charac : service->characteristics) {
-    for (const Descriptor& desc : charac.descriptors) {
-      if (handle == desc.handle) return &desc;
-    }
-  }
-
-  return NULL;
+  if (!p_srcb) return NULL;
+  return p_srcb->gatt_database->FindDescriptor(handle);
 }
 
 const Descriptor* bta_gattc_get_descriptor(uint16_t conn_id, uint16_t handle) {
@@ -605,18 +575,8 @@ const Descriptor* bta_gattc_get_descriptor(uint16_t conn_id, uint16_t handle) {
 
 const Characteristic* bta_gattc_get_owning_characteristic_srcb(
     tBTA_GATTC_SERV* p_srcb, uint16_t handle) {
-  const Service* service =
-      bta_gattc_get_service_for_handle_srcb(p_srcb, handle);
-
-  if (!service) return NULL;
-
-  for (const Characteristic& charac : service->characteristics) {
-    for (const Descriptor& desc : charac.descriptors) {
-      if (handle == desc.handle) return &charac;
-    }
-  }
-
-  return NULL;
+  if (!p_srcb) return NULL;
+  return p_srcb->gatt_database->FindOwningCharacteristic(handle);
 }
 
 const Characteristic* bta_gattc_get_owning_characteristic(uint16_t conn_id,
@@ -674,7 +634,7 @@ static void bta_gattc_read_db_hash_cmpl(tBTA_GATTC_CLCB* p_clcb,
     if (len == remote_hash.max_size()) {
       std::copy(data, data + len, remote_hash.begin());
 
-      Octet16 local_hash = p_clcb->p_srcb->gatt_database.Hash();
+      Octet16 local_hash = p_clcb->p_srcb->gatt_database->Hash();
       matched = (local_hash == remote_hash);
 
       LOG_DEBUG("lhash=%s",
@@ -684,9 +644,9 @@ static void bta_gattc_read_db_hash_cmpl(tBTA_GATTC_CLCB* p_clcb,
           base::HexEncode(remote_hash.data(), remote_hash.size()).c_str());
 
       if (!matched) {
-        gatt::Database db = bta_gattc_hash_load(remote_hash);
-        if (!db.IsEmpty()) {
-          p_clcb->p_srcb->gatt_database = db;
+        auto db = bta_gattc_hash_load(remote_hash);
+        if (db) {
+          p_clcb->p_srcb->gatt_database = std::move(db);
           found = true;
         }
         // If the device is trusted, link addr file to correct hash file
@@ -700,9 +660,9 @@ static void bta_gattc_read_db_hash_cmpl(tBTA_GATTC_CLCB* p_clcb,
     // If is_svc_chg is true, do not read the existing cache.
     bool is_a_bonded_dev = btm_sec_is_a_bonded_dev(p_clcb->p_srcb->server_bda);
     if (!is_svc_chg && is_a_bonded_dev) {
-      gatt::Database db = bta_gattc_cache_load(p_clcb->p_srcb->server_bda);
-      if (!db.IsEmpty()) {
-        p_clcb->p_srcb->gatt_database = db;
+      auto db = bta_gattc_cache_load(p_clcb->p_srcb->server_bda);
+      if (db) {
+        p_clcb->p_srcb->gatt_database = std::move(db);
         found = true;
       }
       LOG_DEBUG("load cache directly, result=%d", found);
@@ -721,7 +681,7 @@ static void bta_gattc_read_db_hash_cmpl(tBTA_GATTC_CLCB* p_clcb,
       LOG_DEBUG("hash found in cache, skip service discovery");
 
 #if (BTA_GATT_DEBUG == TRUE)
-      bta_gattc_display_cache_server(p_clcb->p_srcb->gatt_database);
+      bta_gattc_display_cache_server(*p_clcb->p_srcb->gatt_database);
 #endif
 
       p_clcb->p_srcb->state = BTA_GATTC_SERV_IDLE;
@@ -875,19 +835,19 @@ static void bta_gattc_get_gatt_db_impl(tBTA_GATTC_SERV* p_srvc_cb,
           << StringPrintf(": start_handle 0x%04x, end_handle 0x%04x",
                           start_handle, end_handle);
 
-  if (p_srvc_cb->gatt_database.IsEmpty()) {
+  if (p_srvc_cb->gatt_database->IsEmpty()) {
     *count = 0;
     *db = NULL;
     return;
   }
 
-  size_t db_size = bta_gattc_get_db_size(p_srvc_cb->gatt_database.Services(),
+  size_t db_size = bta_gattc_get_db_size(p_srvc_cb->gatt_database->Services(),
                                          start_handle, end_handle);
 
   void* buffer = osi_malloc(db_size * sizeof(btgatt_db_element_t));
   btgatt_db_element_t* curr_db_attr = (btgatt_db_element_t*)buffer;
 
-  for (const Service& service : p_srvc_cb->gatt_database.Services()) {
+  for (const Service& service : p_srvc_cb->gatt_database->Services()) {
     if (service.handle < start_handle) continue;
 
     if (service.end_handle > end_handle) break;
@@ -965,7 +925,7 @@ void bta_gattc_get_gatt_db(uint16_t conn_id, uint16_t start_handle,
   }
 
   if (!p_clcb->p_srcb || p_clcb->p_srcb->pending_discovery.InProgress() ||
-      p_clcb->p_srcb->gatt_database.IsEmpty()) {
+      p_clcb->p_srcb->gatt_database->IsEmpty()) {
     LOG(ERROR) << "No server cache available";
     return;
   }
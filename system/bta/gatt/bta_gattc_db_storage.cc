@@ -21,9 +21,18 @@
 #include <base/logging.h>
 #include <base/strings/string_number_conversions.h>
 #include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
+#include <unistd.h>
 
+#include <algorithm>
+#include <cstring>
+#include <list>
+#include <map>
+#include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "bta/gatt/bta_gattc_int.h"
@@ -45,6 +54,7 @@ using std::vector;
 #define GATT_HASH_EXPIRED_TIME 604800
 
 static void bta_gattc_hash_remove_least_recently_used_if_possible();
+static void bta_gattc_hash_forget(const string& hash_file);
 
 static void bta_gattc_generate_cache_file_name(char* buffer, size_t buffer_len,
                                                const RawAddress& bda) {
@@ -59,7 +69,99 @@ static void bta_gattc_generate_hash_file_name(char* buffer, size_t buffer_len,
            base::HexEncode(hash.data(), 16).c_str());
 }
 
-static gatt::Database EMPTY_DB;
+namespace {
+
+struct Octet16Hash {
+  size_t operator()(const Octet16& hash) const {
+    // The database hash is an AES-CMAC, so any of its bytes are well spread.
+    size_t result;
+    memcpy(&result, hash.data(), sizeof(result));
+    return result;
+  }
+};
+
+/* In-memory index of the GATT cache files. Databases are indexed by their
+ * hash, so peers exposing an identical database share a single deserialized
+ * copy, and each known peer address points at the hash of its database. This
+ * lets a reconnection to a known peer skip the file system entirely. */
+class DatabaseIndex {
+ public:
+  std::shared_ptr<const gatt::Database> FindByHash(const Octet16& hash) {
+    auto it = databases_.find(hash);
+    if (it == databases_.end()) return nullptr;
+
+    lru_.splice(lru_.begin(), lru_, it->second.lru_it);
+    return it->second.database;
+  }
+
+  std::shared_ptr<const gatt::Database> FindByAddress(const RawAddress& bda) {
+    auto it = hash_by_address_.find(bda);
+    if (it == hash_by_address_.end()) return nullptr;
+    return FindByHash(it->second);
+  }
+
+  void Insert(const Octet16& hash,
+              std::shared_ptr<const gatt::Database> database) {
+    auto it = databases_.find(hash);
+    if (it != databases_.end()) {
+      lru_.splice(lru_.begin(), lru_, it->second.lru_it);
+      return;
+    }
+
+    if (databases_.size() >= GATT_HASH_MAX_SIZE) Erase(lru_.back());
+
+    lru_.push_front(hash);
+    databases_.emplace(hash, Entry{std::move(database), lru_.begin()});
+  }
+
+  /* Drops the database, e.g. once its hash file is removed, along with the
+   * addresses pointing at it */
+  void Erase(const Octet16& hash) {
+    auto it = databases_.find(hash);
+    if (it == databases_.end()) return;
+
+    lru_.erase(it->second.lru_it);
+    databases_.erase(it);
+    for (auto link = hash_by_address_.begin();
+         link != hash_by_address_.end();) {
+      if (link->second == hash) {
+        link = hash_by_address_.erase(link);
+      } else {
+        ++link;
+      }
+    }
+  }
+
+  void Link(const RawAddress& bda, const Octet16& hash) {
+    hash_by_address_[bda] = hash;
+  }
+
+  void Unlink(const RawAddress& bda) { hash_by_address_.erase(bda); }
+
+ private:
+  struct Entry {
+    std::shared_ptr<const gatt::Database> database;
+    std::list<Octet16>::iterator lru_it;
+  };
+
+  std::unordered_map<Octet16, Entry, Octet16Hash> databases_;
+  /* Most recently used hash first */
+  std::list<Octet16> lru_;
+  std::map<RawAddress, Octet16> hash_by_address_;
+};
+
+DatabaseIndex database_index;
+
+/* On-disk layout of a cache file: a header followed by the attributes */
+struct StoredDatabaseHeader {
+  uint16_t cache_ver;
+  uint16_t num_attr;
+};
+
+static_assert(alignof(StoredAttribute) <= sizeof(StoredDatabaseHeader),
+              "attributes must be naturally aligned in a mapped cache file");
+
+}  // namespace
 
 /*******************************************************************************
  *
@@ -69,54 +171,57 @@ static gatt::Database EMPTY_DB;
  *
  * Parameter        fname: input file name
  *
- * Returns          non-empty GATT database on success, empty GATT database
- *                  otherwise
+ * Returns          non-empty GATT database on success, nullptr otherwise
  *
  ******************************************************************************/
-static gatt::Database bta_gattc_load_db(const char* fname) {
-  FILE* fd = fopen(fname, "rb");
-  if (!fd) {
+static std::shared_ptr<const gatt::Database> bta_gattc_load_db(
+    const char* fname) {
+  int fd = open(fname, O_RDONLY | O_CLOEXEC);
+  if (fd == -1) {
     LOG(ERROR) << __func__ << ": can't open GATT cache file " << fname
                << " for reading, error: " << strerror(errno);
-    return EMPTY_DB;
+    return nullptr;
   }
 
-  uint16_t cache_ver = 0;
-  uint16_t num_attr = 0;
-
-  if (fread(&cache_ver, sizeof(uint16_t), 1, fd) != 1) {
-    LOG(ERROR) << __func__ << ": can't read GATT cache version from: " << fname;
-    goto done;
+  struct stat st;
+  if (fstat(fd, &st) == -1 ||
+      static_cast<size_t>(st.st_size) < sizeof(StoredDatabaseHeader)) {
+    LOG(ERROR) << __func__ << ": can't read GATT cache header from: " << fname;
+    close(fd);
+    return nullptr;
   }
 
-  if (cache_ver != GATT_CACHE_VERSION) {
-    LOG(ERROR) << __func__ << ": wrong GATT cache version: " << fname;
-    goto done;
+  // Map the file and deserialize the attributes in place rather than reading
+  // them into an intermediate buffer first.
+  size_t size = st.st_size;
+  void* map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) {
+    LOG(ERROR) << __func__ << ": can't map GATT cache file " << fname
+               << ", error: " << strerror(errno);
+    return nullptr;
   }
 
-  if (fread(&num_attr, sizeof(uint16_t), 1, fd) != 1) {
-    LOG(ERROR) << __func__
-               << ": can't read number of GATT attributes: " << fname;
-    goto done;
-  }
-
-  {
-    std::vector<StoredAttribute> attr(num_attr);
-
-    if (fread(attr.data(), sizeof(StoredAttribute), num_attr, fd) != num_attr) {
-      LOG(ERROR) << __func__ << ": can't read GATT attributes: " << fname;
-      goto done;
-    }
-    fclose(fd);
-
+  std::shared_ptr<const gatt::Database> result;
+  const auto* header = static_cast<const StoredDatabaseHeader*>(map);
+  if (header->cache_ver != GATT_CACHE_VERSION) {
+    LOG(ERROR) << __func__ << ": wrong GATT cache version: " << fname;
+  } else if (size < sizeof(StoredDatabaseHeader) +
+                        header->num_attr * sizeof(StoredAttribute)) {
+    LOG(ERROR) << __func__ << ": can't read GATT attributes: " << fname;
+  } else {
+    const auto* attr = reinterpret_cast<const StoredAttribute*>(
+        static_cast<const uint8_t*>(map) + sizeof(StoredDatabaseHeader));
     bool success = false;
-    gatt::Database result = gatt::Database::Deserialize(attr, &success);
-    return success ? result : EMPTY_DB;
+    gatt::Database db =
+        gatt::Database::Deserialize(attr, header->num_attr, &success);
+    if (success && !db.IsEmpty()) {
+      result = std::make_shared<const gatt::Database>(std::move(db));
+    }
   }
 
-done:
-  fclose(fd);
-  return EMPTY_DB;
+  munmap(map, size);
+  return result;
 }
 
 /*******************************************************************************
@@ -127,14 +232,23 @@ done:
  *
  * Parameter        bd_address: remote device address
  *
- * Returns          non-empty GATT database on success, empty GATT database
- *                  otherwise
+ * Returns          non-empty GATT database on success, nullptr otherwise
  *
  ******************************************************************************/
-gatt::Database bta_gattc_cache_load(const RawAddress& server_bda) {
+std::shared_ptr<const gatt::Database> bta_gattc_cache_load(
+    const RawAddress& server_bda) {
+  auto cached = database_index.FindByAddress(server_bda);
+  if (cached) return cached;
+
   char fname[255] = {0};
   bta_gattc_generate_cache_file_name(fname, sizeof(fname), server_bda);
-  return bta_gattc_load_db(fname);
+  auto db = bta_gattc_load_db(fname);
+  if (db) {
+    Octet16 hash = db->Hash();
+    database_index.Insert(hash, db);
+    database_index.Link(server_bda, hash);
+  }
+  return db;
 }
 
 /*******************************************************************************
@@ -145,14 +259,18 @@ gatt::Database bta_gattc_cache_load(const RawAddress& server_bda) {
  *
  * Parameter        hash: 16-byte value
  *
- * Returns          non-empty GATT database on success, empty GATT database
- *                  otherwise
+ * Returns          non-empty GATT database on success, nullptr otherwise
  *
  ******************************************************************************/
-gatt::Database bta_gattc_hash_load(const Octet16& hash) {
+std::shared_ptr<const gatt::Database> bta_gattc_hash_load(const Octet16& hash) {
+  auto cached = database_index.FindByHash(hash);
+  if (cached) return cached;
+
   char fname[255] = {0};
   bta_gattc_generate_hash_file_name(fname, sizeof(fname), hash);
-  return bta_gattc_load_db(fname);
+  auto db = bta_gattc_load_db(fname);
+  if (db) database_index.Insert(hash, db);
+  return db;
 }
 
 /*******************************************************************************
@@ -176,17 +294,11 @@ static bool bta_gattc_store_db(const char* fname,
     return false;
   }
 
-  uint16_t cache_ver = GATT_CACHE_VERSION;
-  if (fwrite(&cache_ver, sizeof(uint16_t), 1, fd) != 1) {
-    LOG(ERROR) << __func__ << ": can't write GATT cache version: " << fname;
-    fclose(fd);
-    return false;
-  }
-
   uint16_t num_attr = attr.size();
-  if (fwrite(&num_attr, sizeof(uint16_t), 1, fd) != 1) {
-    LOG(ERROR) << __func__
-               << ": can't write GATT cache attribute count: " << fname;
+  StoredDatabaseHeader header = {.cache_ver = GATT_CACHE_VERSION,
+                                 .num_attr = num_attr};
+  if (fwrite(&header, sizeof(header), 1, fd) != 1) {
+    LOG(ERROR) << __func__ << ": can't write GATT cache header: " << fname;
     fclose(fd);
     return false;
   }
@@ -216,14 +328,14 @@ static bool bta_gattc_store_db(const char* fname,
  *
  ******************************************************************************/
 void bta_gattc_cache_write(const RawAddress& server_bda,
-                           const gatt::Database& database) {
+                           std::shared_ptr<const gatt::Database> database) {
   char addr_file[255] = {0};
   char hash_file[255] = {0};
-  Octet16 hash = database.Hash();
+  Octet16 hash = database->Hash();
   bta_gattc_generate_cache_file_name(addr_file, sizeof(addr_file), server_bda);
   bta_gattc_generate_hash_file_name(hash_file, sizeof(hash_file), hash);
 
-  bool result = bta_gattc_hash_write(hash, database);
+  bool result = bta_gattc_hash_write(hash, std::move(database));
   // Only link addr_file to hash file when hash_file is created successfully.
   if (result) {
     bta_gattc_cache_link(server_bda, hash);
@@ -251,7 +363,10 @@ void bta_gattc_cache_link(const RawAddress& server_bda, const Octet16& hash) {
   unlink(addr_file);  // remove addr file first if the file exists
   if (link(hash_file, addr_file) == -1) {
     LOG_ERROR("link %s to %s, errno=%d", addr_file, hash_file, errno);
+    database_index.Unlink(server_bda);
+    return;
   }
+  database_index.Link(server_bda, hash);
 }
 
 /*******************************************************************************
@@ -262,16 +377,20 @@ void bta_gattc_cache_link(const RawAddress& server_bda, const Octet16& hash) {
  *                  cache is available to save for specific hash.
  *
  * Parameter        hash: 16-byte value
- *                  database: gatt::Database instance.
+ *                  database: gatt::Database instance, shared with the cache.
  *
  * Returns          true on success, false otherwise
  *
  ******************************************************************************/
-bool bta_gattc_hash_write(const Octet16& hash, const gatt::Database& database) {
+bool bta_gattc_hash_write(const Octet16& hash,
+                          std::shared_ptr<const gatt::Database> database) {
   char fname[255] = {0};
   bta_gattc_generate_hash_file_name(fname, sizeof(fname), hash);
   bta_gattc_hash_remove_least_recently_used_if_possible();
-  return bta_gattc_store_db(fname, database.Serialize());
+  if (!bta_gattc_store_db(fname, database->Serialize())) return false;
+
+  database_index.Insert(hash, std::move(database));
+  return true;
 }
 
 /*******************************************************************************
@@ -291,6 +410,7 @@ void bta_gattc_cache_reset(const RawAddress& server_bda) {
   char fname[255] = {0};
   bta_gattc_generate_cache_file_name(fname, sizeof(fname), server_bda);
   unlink(fname);
+  database_index.Unlink(server_bda);
 }
 
 /*******************************************************************************
@@ -371,12 +491,41 @@ static void bta_gattc_hash_remove_least_recently_used_if_possible() {
   // if the number of hash files exceeds the limit, remove the cadidate item.
   if (count > GATT_HASH_MAX_SIZE && !candidate_item.empty()) {
     unlink(candidate_item.c_str());
+    bta_gattc_hash_forget(candidate_item);
     LOG_DEBUG("delete hash file (size), name=%s", candidate_item.c_str());
   }
 
   // If there is any file expired, also delete it.
   for (string expired_item : expired_items) {
     unlink(expired_item.c_str());
+    bta_gattc_hash_forget(expired_item);
     LOG_DEBUG("delete hash file (expired), name=%s", expired_item.c_str());
   }
 }
+
+/*******************************************************************************
+ *
+ * Function         bta_gattc_hash_forget
+ *
+ * Description      Drop the in-memory copy of a database whose hash file was
+ *                  removed, so that it is not served from memory anymore
+ *
+ * Parameter        hash_file: full path of the removed hash file
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+static void bta_gattc_hash_forget(const string& hash_file) {
+  size_t prefix_len = strlen(GATT_HASH_PATH_PREFIX);
+  if (hash_file.compare(0, prefix_len, GATT_HASH_PATH_PREFIX) != 0) return;
+
+  vector<uint8_t> bytes;
+  Octet16 hash;
+  if (!base::HexStringToBytes(hash_file.substr(prefix_len), &bytes) ||
+      bytes.size() != hash.size()) {
+    LOG_WARN("unexpected hash file name %s", hash_file.c_str());
+    return;
+  }
+  std::copy(bytes.begin(), bytes.end(), hash.begin());
+  database_index.Erase(hash);
+}
@@ -25,6 +25,7 @@
 #define BTA_GATTC_INT_H
 
 #include <cstdint>
+#include <memory>
 
 #include "bt_target.h"  // Must be first to define build configuration
 #include "bta/gatt/database.h"
@@ -150,8 +151,11 @@ typedef struct {
 typedef struct {
   BT_HDR_RIGID hdr;
   tGATT_AUTH_REQ auth_req;
+  bool variable_len;
   uint8_t num_attr;
   uint16_t handles[GATT_MAX_READ_MULTI_HANDLES];
+  GATT_READ_MULTI_OP_CB read_cb;
+  void* read_cb_data;
 } tBTA_GATTC_API_READ_MULTI;
 
 typedef struct {
@@ -206,7 +210,10 @@ typedef struct {
 
   uint8_t state;
 
-  gatt::Database gatt_database;
+  /* Never null. Shared with the GATT cache and with other servers exposing the
+   * same database, so it is replaced as a whole rather than modified */
+  std::shared_ptr<const gatt::Database> gatt_database =
+      std::make_shared<const gatt::Database>();
   uint8_t update_count; /* indication received */
   uint8_t num_clcb;     /* number of associated CLCB */
 
@@ -482,12 +489,15 @@ extern bool bta_gattc_conn_dealloc(const RawAddress& remote_bda);
 extern bool bta_gattc_read_db_hash(tBTA_GATTC_CLCB* p_clcb, bool is_svc_chg);
 
 /* bta_gattc_db_storage */
-extern gatt::Database bta_gattc_hash_load(const Octet16& hash);
-extern bool bta_gattc_hash_write(const Octet16& hash,
-                                 const gatt::Database& database);
-extern gatt::Database bta_gattc_cache_load(const RawAddress& server_bda);
-extern void bta_gattc_cache_write(const RawAddress& server_bda,
-                                  const gatt::Database& database);
+extern std::shared_ptr<const gatt::Database> bta_gattc_hash_load(
+    const Octet16& hash);
+extern bool bta_gattc_hash_write(
+    const Octet16& hash, std::shared_ptr<const gatt::Database> database);
+extern std::shared_ptr<const gatt::Database> bta_gattc_cache_load(
+    const RawAddress& server_bda);
+extern void bta_gattc_cache_write(
+    const RawAddress& server_bda,
+    std::shared_ptr<const gatt::Database> database);
 extern void bta_gattc_cache_link(const RawAddress& server_bda,
                                  const Octet16& hash);
 extern void bta_gattc_cache_reset(const RawAddress& server_bda);
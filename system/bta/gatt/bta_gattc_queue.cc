@@ -16,13 +16,17 @@
 
 #include "bta_gatt_queue.h"
 
+#include <base/logging.h>
+#include <base/strings/stringprintf.h>
+
 #include <list>
 #include <unordered_map>
 #include <unordered_set>
 
+#include "common/time_util.h"
 #include "osi/include/allocator.h"
-
-#include <base/logging.h>
+#include "osi/include/properties.h"
+#include "stack/include/bt_types.h"
 
 using gatt_operation = BtaGattQueue::gatt_operation;
 
@@ -32,14 +36,39 @@ constexpr uint8_t GATT_WRITE_CHAR = 3;
 constexpr uint8_t GATT_WRITE_DESC = 4;
 constexpr uint8_t GATT_CONFIG_MTU = 5;
 
+constexpr char kCoalesceReadsProperty[] =
+    "persist.bluetooth.gatt_queue.coalesce_reads";
+
 struct gatt_read_op_data {
   GATT_READ_OP_CB cb;
   void* cb_data;
 };
 
+struct gatt_read_multi_op_data {
+  std::list<gatt_operation> ops;
+};
+
 std::unordered_map<uint16_t, std::list<gatt_operation>>
     BtaGattQueue::gatt_op_queue;
 std::unordered_set<uint16_t> BtaGattQueue::gatt_op_queue_executing;
+std::unordered_map<uint16_t, BtaGattQueue::gatt_connection>
+    BtaGattQueue::gatt_connections;
+
+static bool is_read_op(const gatt_operation& op) {
+  return op.type == GATT_READ_CHAR || op.type == GATT_READ_DESC;
+}
+
+BtaGattQueue::gatt_connection& BtaGattQueue::get_connection(uint16_t conn_id) {
+  auto it = gatt_connections.find(conn_id);
+  if (it == gatt_connections.end()) {
+    gatt_connection connection = {};
+    connection.coalesce_reads =
+        osi_property_get_bool(kCoalesceReadsProperty, false);
+    connection.read_multi_var_supported = true;
+    it = gatt_connections.emplace(conn_id, connection).first;
+  }
+  return it->second;
+}
 
 void BtaGattQueue::mark_as_not_executing(uint16_t conn_id) {
   gatt_op_queue_executing.erase(conn_id);
@@ -109,6 +138,109 @@ void BtaGattQueue::gatt_configure_mtu_op_finished(uint16_t conn_id,
   }
 }
 
+void BtaGattQueue::gatt_read_multi_op_finished(uint16_t conn_id,
+                                               tGATT_STATUS status,
+                                               const tBTA_GATTC_MULTI& handles,
+                                               uint16_t len, uint8_t* value,
+                                               void* data) {
+  gatt_read_multi_op_data* tmp = (gatt_read_multi_op_data*)data;
+  std::list<gatt_operation> ops = std::move(tmp->ops);
+  delete tmp;
+
+  gatt_connection& connection = get_connection(conn_id);
+  if (status == GATT_REQ_NOT_SUPPORTED) {
+    LOG(INFO) << __func__ << ": conn_id=" << loghex(conn_id)
+              << " does not support Read Multiple Variable Length";
+    connection.read_multi_var_supported = false;
+  }
+
+  /* Split the Length Value tuples of the response back into the reads. The
+   * response is truncated to the MTU: reads it could not hold are read again,
+   * as are all of them if the request failed. */
+  struct read_result {
+    gatt_operation op;
+    uint16_t len;
+    uint8_t* value;
+  };
+  std::list<read_result> results;
+  std::list<gatt_operation> retries;
+  uint8_t* p = value;
+  uint16_t remaining = (status == GATT_SUCCESS && value) ? len : 0;
+  bool truncated = status != GATT_SUCCESS;
+  for (auto& op : ops) {
+    uint16_t value_len = 0;
+    if (!truncated && remaining >= 2) {
+      STREAM_TO_UINT16(value_len, p);
+      remaining -= 2;
+      truncated = value_len > remaining;
+    } else {
+      truncated = true;
+    }
+
+    if (truncated) {
+      /* Only the first read cut short is sure to need reading on its own */
+      op.no_coalescing = status != GATT_SUCCESS || retries.empty();
+      retries.push_back(std::move(op));
+      continue;
+    }
+    results.push_back({std::move(op), value_len, p});
+    p += value_len;
+    remaining -= value_len;
+  }
+
+  connection.reads_coalesced += results.size();
+  connection.reads_retried += retries.size();
+
+  mark_as_not_executing(conn_id);
+  if (!retries.empty() && gatt_op_queue.count(conn_id)) {
+    std::list<gatt_operation>& gatt_ops = gatt_op_queue[conn_id];
+    gatt_ops.splice(gatt_ops.begin(), retries);
+  }
+  gatt_execute_next_op(conn_id);
+
+  for (auto& result : results) {
+    if (result.op.read_cb) {
+      result.op.read_cb(conn_id, GATT_SUCCESS, result.op.handle, result.len,
+                        result.value, result.op.read_cb_data);
+    }
+  }
+}
+
+/* Sends the reads at the head of the queue in a single Read Multiple Variable
+ * Length request, if there are several and the connection allows it */
+bool BtaGattQueue::gatt_execute_read_multi(
+    uint16_t conn_id, std::list<gatt_operation>& gatt_ops) {
+  gatt_connection& connection = get_connection(conn_id);
+  if (!connection.coalesce_reads || !connection.read_multi_var_supported) {
+    return false;
+  }
+
+  tBTA_GATTC_MULTI handles = {.num_attr = 0};
+  auto end = gatt_ops.begin();
+  while (end != gatt_ops.end() && is_read_op(*end) && !end->no_coalescing &&
+         handles.num_attr < GATT_MAX_READ_MULTI_HANDLES) {
+    handles.handles[handles.num_attr++] = end->handle;
+    end++;
+  }
+  if (handles.num_attr < 2) return false;
+
+  gatt_read_multi_op_data* data = new gatt_read_multi_op_data;
+  data->ops.splice(data->ops.end(), gatt_ops, gatt_ops.begin(), end);
+
+  uint64_t now_us = bluetooth::common::time_get_os_boottime_us();
+  for (const auto& op : data->ops) {
+    uint64_t wait_us = now_us - op.enqueue_time_us;
+    connection.total_wait_us += wait_us;
+    connection.max_wait_us = std::max(connection.max_wait_us, wait_us);
+  }
+  connection.ops_executed += handles.num_attr;
+  connection.read_multi_requests++;
+
+  BTA_GATTC_ReadMultiple(conn_id, &handles, true, GATT_AUTH_REQ_NONE,
+                         gatt_read_multi_op_finished, data);
+  return true;
+}
+
 void BtaGattQueue::gatt_execute_next_op(uint16_t conn_id) {
   APPL_TRACE_DEBUG("%s: conn_id=0x%x", __func__, conn_id);
   if (gatt_op_queue.empty()) {
@@ -132,8 +264,20 @@ void BtaGattQueue::gatt_execute_next_op(uint16_t conn_id) {
 
   std::list<gatt_operation>& gatt_ops = map_ptr->second;
 
+  if (is_read_op(gatt_ops.front()) &&
+      gatt_execute_read_multi(conn_id, gatt_ops)) {
+    return;
+  }
+
   gatt_operation& op = gatt_ops.front();
 
+  gatt_connection& connection = get_connection(conn_id);
+  uint64_t wait_us =
+      bluetooth::common::time_get_os_boottime_us() - op.enqueue_time_us;
+  connection.ops_executed++;
+  connection.total_wait_us += wait_us;
+  connection.max_wait_us = std::max(connection.max_wait_us, wait_us);
+
   if (op.type == GATT_READ_CHAR) {
     gatt_read_op_data* data =
         (gatt_read_op_data*)osi_malloc(sizeof(gatt_read_op_data));
@@ -179,26 +323,76 @@ void BtaGattQueue::gatt_execute_next_op(uint16_t conn_id) {
   gatt_ops.pop_front();
 }
 
+void BtaGattQueue::gatt_enqueue_op(uint16_t conn_id, gatt_operation op) {
+  op.enqueue_time_us = bluetooth::common::time_get_os_boottime_us();
+  std::list<gatt_operation>& gatt_ops = gatt_op_queue[conn_id];
+  gatt_ops.push_back(std::move(op));
+
+  gatt_connection& connection = get_connection(conn_id);
+  connection.max_depth = std::max(connection.max_depth, gatt_ops.size());
+}
+
 void BtaGattQueue::Clean(uint16_t conn_id) {
   gatt_op_queue.erase(conn_id);
   gatt_op_queue_executing.erase(conn_id);
+
+  /* Statistics are kept for dumpsys, settings go with the peer */
+  auto it = gatt_connections.find(conn_id);
+  if (it != gatt_connections.end()) {
+    it->second.coalesce_reads =
+        osi_property_get_bool(kCoalesceReadsProperty, false);
+    it->second.read_multi_var_supported = true;
+  }
+}
+
+void BtaGattQueue::SetReadCoalescing(uint16_t conn_id, bool enable) {
+  get_connection(conn_id).coalesce_reads = enable;
+}
+
+void BtaGattQueue::DebugDump(int fd) {
+  dprintf(fd, "GATT client queue:\n");
+  for (const auto& [conn_id, connection] : gatt_connections) {
+    auto queue = gatt_op_queue.find(conn_id);
+    size_t depth = queue == gatt_op_queue.end() ? 0 : queue->second.size();
+    uint64_t avg_wait_us = connection.ops_executed
+                               ? connection.total_wait_us /
+                                     connection.ops_executed
+                               : 0;
+    dprintf(fd,
+            "  conn_id: 0x%04x, coalesce_reads: %s%s, queued: %zu, "
+            "max_queued: %zu\n",
+            conn_id, connection.coalesce_reads ? "true" : "false",
+            connection.read_multi_var_supported ? "" : " (not supported)",
+            depth, connection.max_depth);
+    dprintf(fd,
+            "    ops: %llu, read_multi_requests: %llu, reads_coalesced: %llu, "
+            "reads_retried: %llu\n",
+            (unsigned long long)connection.ops_executed,
+            (unsigned long long)connection.read_multi_requests,
+            (unsigned long long)connection.reads_coalesced,
+            (unsigned long long)connection.reads_retried);
+    dprintf(fd, "    queue latency avg: %llu ms, max: %llu ms\n",
+            (unsigned long long)avg_wait_us / 1000,
+            (unsigned long long)connection.max_wait_us / 1000);
+  }
+  dprintf(fd, "\n");
 }
 
 void BtaGattQueue::ReadCharacteristic(uint16_t conn_id, uint16_t handle,
                                       GATT_READ_OP_CB cb, void* cb_data) {
-  gatt_op_queue[conn_id].push_back({.type = GATT_READ_CHAR,
-                                    .handle = handle,
-                                    .read_cb = cb,
-                                    .read_cb_data = cb_data});
+  gatt_enqueue_op(conn_id, {.type = GATT_READ_CHAR,
+                           .handle = handle,
+                           .read_cb = cb,
+                           .read_cb_data = cb_data});
   gatt_execute_next_op(conn_id);
 }
 
 void BtaGattQueue::ReadDescriptor(uint16_t conn_id, uint16_t handle,
                                   GATT_READ_OP_CB cb, void* cb_data) {
-  gatt_op_queue[conn_id].push_back({.type = GATT_READ_DESC,
-                                    .handle = handle,
-                                    .read_cb = cb,
-                                    .read_cb_data = cb_data});
+  gatt_enqueue_op(conn_id, {.type = GATT_READ_DESC,
+                           .handle = handle,
+                           .read_cb = cb,
+                           .read_cb_data = cb_data});
   gatt_execute_next_op(conn_id);
 }
 
@@ -206,12 +400,12 @@ void BtaGattQueue::WriteCharacteristic(uint16_t conn_id, uint16_t handle,
                                        std::vector<uint8_t> value,
                                        tGATT_WRITE_TYPE write_type,
                                        GATT_WRITE_OP_CB cb, void* cb_data) {
-  gatt_op_queue[conn_id].push_back({.type = GATT_WRITE_CHAR,
-                                    .handle = handle,
-                                    .write_cb = cb,
-                                    .write_cb_data = cb_data,
-                                    .write_type = write_type,
-                                    .value = std::move(value)});
+  gatt_enqueue_op(conn_id, {.type = GATT_WRITE_CHAR,
+                           .handle = handle,
+                           .write_cb = cb,
+                           .write_cb_data = cb_data,
+                           .write_type = write_type,
+                           .value = std::move(value)});
   gatt_execute_next_op(conn_id);
 }
 
@@ -219,12 +413,12 @@ void BtaGattQueue::WriteDescriptor(uint16_t conn_id, uint16_t handle,
                                    std::vector<uint8_t> value,
                                    tGATT_WRITE_TYPE write_type,
                                    GATT_WRITE_OP_CB cb, void* cb_data) {
-  gatt_op_queue[conn_id].push_back({.type = GATT_WRITE_DESC,
-                                    .handle = handle,
-                                    .write_cb = cb,
-                                    .write_cb_data = cb_data,
-                                    .write_type = write_type,
-                                    .value = std::move(value)});
+  gatt_enqueue_op(conn_id, {.type = GATT_WRITE_DESC,
+                           .handle = handle,
+                           .write_cb = cb,
+                           .write_cb_data = cb_data,
+                           .write_type = write_type,
+                           .value = std::move(value)});
   gatt_execute_next_op(conn_id);
 }
 
@@ -232,7 +426,7 @@ void BtaGattQueue::ConfigureMtu(uint16_t conn_id, uint16_t mtu) {
   LOG(INFO) << __func__ << ", mtu: " << static_cast<int>(mtu);
   std::vector<uint8_t> value = {static_cast<uint8_t>(mtu & 0xff),
                                 static_cast<uint8_t>(mtu >> 8)};
-  gatt_op_queue[conn_id].push_back({.type = GATT_CONFIG_MTU,
-                                    .value = std::move(value)});
+  gatt_enqueue_op(conn_id,
+                  {.type = GATT_CONFIG_MTU, .value = std::move(value)});
   gatt_execute_next_op(conn_id);
 }
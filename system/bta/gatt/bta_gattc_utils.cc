@@ -214,7 +214,7 @@ void bta_gattc_clcb_dealloc(tBTA_GATTC_CLCB* p_clcb) {
     p_srcb->mtu = 0;
 
     // clear reallocating
-    p_srcb->gatt_database.Clear();
+    p_srcb->gatt_database = std::make_shared<const gatt::Database>();
   }
 
   osi_free_and_reset((void**)&p_clcb->p_q_cmd);
@@ -306,7 +306,6 @@ tBTA_GATTC_SERV* bta_gattc_srcb_alloc(const RawAddress& bda) {
 
   if (p_tcb != NULL) {
     // clear reallocating
-    p_tcb->gatt_database.Clear();
     p_tcb->pending_discovery.Clear();
     *p_tcb = tBTA_GATTC_SERV();
 
@@ -61,6 +61,102 @@ Service* FindService(std::list<Service>& services, uint16_t handle) {
   return nullptr;
 }
 
+Database::Database(const Database& other) : services(other.services) {
+  BuildIndex();
+}
+
+Database& Database::operator=(const Database& other) {
+  if (this != &other) {
+    services = other.services;
+    BuildIndex();
+  }
+  return *this;
+}
+
+void Database::BuildIndex() {
+  service_index.clear();
+  attribute_index.clear();
+
+  size_t num_attributes = 0;
+  for (const Service& service : services) {
+    for (const Characteristic& charac : service.characteristics) {
+      num_attributes += 1 + charac.descriptors.size();
+    }
+  }
+
+  service_index.reserve(services.size());
+  attribute_index.reserve(num_attributes);
+  for (const Service& service : services) {
+    service_index.push_back(&service);
+    for (const Characteristic& charac : service.characteristics) {
+      attribute_index.push_back({charac.value_handle, &charac, nullptr});
+      for (const Descriptor& desc : charac.descriptors) {
+        attribute_index.push_back({desc.handle, &charac, &desc});
+      }
+    }
+  }
+
+  // Both are usually in order already, as services are discovered and stored
+  // in handle order.
+  std::stable_sort(service_index.begin(), service_index.end(),
+                   [](const Service* a, const Service* b) {
+                     return a->handle < b->handle;
+                   });
+  std::stable_sort(attribute_index.begin(), attribute_index.end(),
+                   [](const AttributeIndexEntry& a,
+                      const AttributeIndexEntry& b) {
+                     return a.handle < b.handle;
+                   });
+}
+
+const Service* Database::FindService(uint16_t handle) const {
+  // Find the last service starting at or before the handle
+  auto it = std::upper_bound(
+      service_index.begin(), service_index.end(), handle,
+      [](uint16_t h, const Service* service) { return h < service->handle; });
+  if (it == service_index.begin()) return nullptr;
+  --it;
+  return HandleInRange(**it, handle) ? *it : nullptr;
+}
+
+const Characteristic* Database::FindCharacteristic(
+    uint16_t value_handle) const {
+  auto it = std::lower_bound(attribute_index.begin(), attribute_index.end(),
+                             value_handle,
+                             [](const AttributeIndexEntry& entry, uint16_t h) {
+                               return entry.handle < h;
+                             });
+  for (; it != attribute_index.end() && it->handle == value_handle; ++it) {
+    if (it->descriptor == nullptr) return it->characteristic;
+  }
+  return nullptr;
+}
+
+const Descriptor* Database::FindDescriptor(uint16_t handle) const {
+  auto it = std::lower_bound(attribute_index.begin(), attribute_index.end(),
+                             handle,
+                             [](const AttributeIndexEntry& entry, uint16_t h) {
+                               return entry.handle < h;
+                             });
+  for (; it != attribute_index.end() && it->handle == handle; ++it) {
+    if (it->descriptor != nullptr) return it->descriptor;
+  }
+  return nullptr;
+}
+
+const Characteristic* Database::FindOwningCharacteristic(
+    uint16_t handle) const {
+  auto it = std::lower_bound(attribute_index.begin(), attribute_index.end(),
+                             handle,
+                             [](const AttributeIndexEntry& entry, uint16_t h) {
+                               return entry.handle < h;
+                             });
+  for (; it != attribute_index.end() && it->handle == handle; ++it) {
+    if (it->descriptor != nullptr) return it->characteristic;
+  }
+  return nullptr;
+}
+
 std::string Database::ToString() const {
   std::stringstream tmp;
 
@@ -139,11 +235,17 @@ std::vector<StoredAttribute> Database::Serialize() const {
 
 Database Database::Deserialize(const std::vector<StoredAttribute>& nv_attr,
                                bool* success) {
+  return Deserialize(nv_attr.data(), nv_attr.size(), success);
+}
+
+Database Database::Deserialize(const StoredAttribute* nv_attr, size_t num_attr,
+                               bool* success) {
   // clear reallocating
   Database result;
-  auto it = nv_attr.cbegin();
+  const StoredAttribute* it = nv_attr;
+  const StoredAttribute* end = nv_attr + num_attr;
 
-  for (; it != nv_attr.cend(); ++it) {
+  for (; it != end; ++it) {
     const auto& attr = *it;
     if (attr.type != PRIMARY_SERVICE && attr.type != SECONDARY_SERVICE) break;
     result.services.emplace_back(Service{
@@ -155,7 +257,7 @@ Database Database::Deserialize(const std::vector<StoredAttribute>& nv_attr,
   }
 
   auto current_service_it = result.services.begin();
-  for (; it != nv_attr.cend(); it++) {
+  for (; it != end; it++) {
     const auto& attr = *it;
 
     // go to the service this attribute belongs to; attributes are stored in
@@ -174,8 +276,8 @@ Database Database::Deserialize(const std::vector<StoredAttribute>& nv_attr,
     }
 
     if (attr.type == INCLUDE) {
-      Service* included_service =
-          FindService(result.services, attr.value.included_service.handle);
+      Service* included_service = gatt::FindService(
+          result.services, attr.value.included_service.handle);
       if (!included_service) {
         LOG(ERROR) << __func__ << ": Non-existing included service!";
         *success = false;
@@ -209,6 +311,7 @@ Database Database::Deserialize(const std::vector<StoredAttribute>& nv_attr,
       }
     }
   }
+  result.BuildIndex();
   *success = true;
   return result;
 }
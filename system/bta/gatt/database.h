@@ -102,22 +102,45 @@ class DatabaseBuilder;
 
 class Database {
  public:
+  Database() = default;
+  Database(const Database& other);
+  Database& operator=(const Database& other);
+  /* Moving keeps the list nodes, so the handle index stays valid */
+  Database(Database&& other) = default;
+  Database& operator=(Database&& other) = default;
+
   /* Return true if there are no services in this database. */
   bool IsEmpty() const { return services.empty(); }
 
   /* Clear the GATT database. This method forces relocation to ensure no extra
    * space is used unnecesarly */
-  void Clear() { std::list<Service>().swap(services); }
+  void Clear() {
+    std::list<Service>().swap(services);
+    std::vector<const Service*>().swap(service_index);
+    std::vector<AttributeIndexEntry>().swap(attribute_index);
+  }
 
   /* Return list of services available in this database */
   const std::list<Service>& Services() const { return services; }
 
+  /* Handle lookups. These use a flat, handle sorted index of the database
+   * instead of walking the service list, and return nullptr when nothing
+   * matches. */
+  const Service* FindService(uint16_t handle) const;
+  const Characteristic* FindCharacteristic(uint16_t value_handle) const;
+  const Descriptor* FindDescriptor(uint16_t handle) const;
+  const Characteristic* FindOwningCharacteristic(uint16_t handle) const;
+
   std::string ToString() const;
 
   std::vector<gatt::StoredAttribute> Serialize() const;
 
   static Database Deserialize(const std::vector<gatt::StoredAttribute>& nv_attr,
                               bool* success);
+  /* Same as above, but reads the attributes in place, i.e. straight from a
+   * memory mapped cache file */
+  static Database Deserialize(const gatt::StoredAttribute* nv_attr,
+                              size_t num_attr, bool* success);
 
   /* Return 128 bit unique identifier of this GATT database */
   Octet16 Hash() const;
@@ -125,7 +148,23 @@ class Database {
   friend class DatabaseBuilder;
 
  private:
+  /* Characteristic value or descriptor handle, with pointers into |services| */
+  struct AttributeIndexEntry {
+    uint16_t handle;
+    const Characteristic* characteristic;
+    /* nullptr for characteristic value handles */
+    const Descriptor* descriptor;
+  };
+
+  /* Rebuild the handle index after |services| changed */
+  void BuildIndex();
+
   std::list<Service> services;
+
+  /* Services sorted by start handle */
+  std::vector<const Service*> service_index;
+  /* Characteristic values and descriptors sorted by handle */
+  std::vector<AttributeIndexEntry> attribute_index;
 };
 
 /* Find a service that should contain handle. Helper method for internal use
@@ -242,7 +242,8 @@ bool DatabaseBuilder::SetValueOfDescriptors(
 bool DatabaseBuilder::InProgress() const { return !database.services.empty(); }
 
 Database DatabaseBuilder::Build() {
-  Database tmp = database;
+  Database tmp = std::move(database);
+  tmp.BuildIndex();
   database.Clear();
   return tmp;
 }
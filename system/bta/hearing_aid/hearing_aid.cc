@@ -1266,8 +1266,9 @@ class HearingAidImpl : public HearingAid {
       return;
     }
 
-    std::vector<uint16_t> chan_left;
-    std::vector<uint16_t> chan_right;
+    // Both channels stay interleaved, as the encoder takes them in one pass
+    pcm_data.resize(num_samples * 2);
+    int16_t* pcm = pcm_data.data();
     if (left == nullptr || right == nullptr) {
       for (int i = 0; i < num_samples; i++) {
         const uint8_t* sample = data.data() + i * 4;
@@ -1278,39 +1279,25 @@ class HearingAidImpl : public HearingAid {
         int16_t right = (int16_t)((*(sample + 1) << 8) + *sample) >> 1;
 
         uint16_t mono_data = (int16_t)(((uint32_t)left + (uint32_t)right) >> 1);
-        chan_left.push_back(mono_data);
-        chan_right.push_back(mono_data);
+        pcm[2 * i] = mono_data;
+        pcm[2 * i + 1] = mono_data;
       }
     } else {
       for (int i = 0; i < num_samples; i++) {
         const uint8_t* sample = data.data() + i * 4;
 
         uint16_t left = (int16_t)((*(sample + 1) << 8) + *sample) >> 1;
-        chan_left.push_back(left);
+        pcm[2 * i] = left;
 
         sample += 2;
         uint16_t right = (int16_t)((*(sample + 1) << 8) + *sample) >> 1;
-        chan_right.push_back(right);
+        pcm[2 * i + 1] = right;
       }
     }
 
     // TODO: monural, binarual check
 
-    // divide encoded data into packets, add header, send.
-
-    // TODO: make those buffers static and global to prevent constant
-    // reallocations
-    // TODO: this should basically fit the encoded data, tune the size later
-    std::vector<uint8_t> encoded_data_left;
     if (left) {
-      // TODO: instead of a magic number, we need to figure out the correct
-      // buffer size
-      encoded_data_left.resize(4000);
-      int encoded_size =
-          g722_encode(encoder_state_left, encoded_data_left.data(),
-                      (const int16_t*)chan_left.data(), chan_left.size());
-      encoded_data_left.resize(encoded_size);
-
       uint16_t cid = GAP_ConnGetL2CAPCid(left->gap_handle);
       uint16_t packets_in_chans = L2CA_FlushChannel(cid, L2CAP_FLUSH_CHANS_GET);
       if (packets_in_chans) {
@@ -1333,16 +1320,7 @@ class HearingAidImpl : public HearingAid {
       check_and_do_rssi_read(left);
     }
 
-    std::vector<uint8_t> encoded_data_right;
     if (right) {
-      // TODO: instead of a magic number, we need to figure out the correct
-      // buffer size
-      encoded_data_right.resize(4000);
-      int encoded_size =
-          g722_encode(encoder_state_right, encoded_data_right.data(),
-                      (const int16_t*)chan_right.data(), chan_right.size());
-      encoded_data_right.resize(encoded_size);
-
       uint16_t cid = GAP_ConnGetL2CAPCid(right->gap_handle);
       uint16_t packets_in_chans = L2CA_FlushChannel(cid, L2CAP_FLUSH_CHANS_GET);
       if (packets_in_chans) {
@@ -1365,52 +1343,89 @@ class HearingAidImpl : public HearingAid {
       check_and_do_rssi_read(right);
     }
 
-    size_t encoded_data_size =
-        std::max(encoded_data_left.size(), encoded_data_right.size());
+    // G.722 produces one byte for every two samples
+    size_t encoded_data_size = num_samples / 2;
 
     uint16_t packet_size =
         CalcCompressedAudioPacketSize(codec_in_use, default_data_interval_ms);
 
-    if (need_drop) {
+    // The encoders still consume the audio of dropped or stalled packets
+    scratch_data.resize(packet_size);
+
+    // divide encoded data into packets, add header, send.
+    for (size_t i = 0; i < encoded_data_size; i += packet_size) {
+      size_t encoded_len = std::min<size_t>(packet_size, encoded_data_size - i);
+
+      BT_HDR* packet_left = nullptr;
+      BT_HDR* packet_right = nullptr;
+      if (!need_drop) {
+        if (left) packet_left = NewAudioPacket(packet_size, left);
+        if (right) packet_right = NewAudioPacket(packet_size, right);
+      }
+
+      // Encode straight into the L2CAP SDUs, past the sequence number
+      uint8_t* data_left = packet_left
+                               ? get_l2cap_sdu_start_ptr(packet_left) + 1
+                               : scratch_data.data();
+      uint8_t* data_right = packet_right
+                                ? get_l2cap_sdu_start_ptr(packet_right) + 1
+                                : scratch_data.data();
+      g722_encode_stereo(left ? encoder_state_left : nullptr,
+                         right ? encoder_state_right : nullptr, data_left,
+                         data_right, pcm + 2 * 2 * i, 2 * encoded_len);
+
+      if (need_drop) continue;
+
       if (left) {
-        left->audio_stats.packet_drop_count++;
+        left->audio_stats.packet_send_count++;
+        SendAudio(packet_left, encoded_len, left);
       }
       if (right) {
-        right->audio_stats.packet_drop_count++;
+        right->audio_stats.packet_send_count++;
+        SendAudio(packet_right, encoded_len, right);
       }
-      return;
+      seq_counter++;
     }
 
-    for (size_t i = 0; i < encoded_data_size; i += packet_size) {
+    if (need_drop) {
       if (left) {
-        left->audio_stats.packet_send_count++;
-        SendAudio(encoded_data_left.data() + i, packet_size, left);
+        left->audio_stats.packet_drop_count++;
       }
       if (right) {
-        right->audio_stats.packet_send_count++;
-        SendAudio(encoded_data_right.data() + i, packet_size, right);
+        right->audio_stats.packet_drop_count++;
       }
-      seq_counter++;
+      return;
     }
+
     if (left) left->audio_stats.frame_send_count++;
     if (right) right->audio_stats.frame_send_count++;
   }
 
-  void SendAudio(uint8_t* encoded_data, uint16_t packet_size,
-                 HearingDevice* hearingAid) {
+  /* Returns the packet to encode the audio for the device into, with the
+   * sequence number set, or nullptr while its playback is stalled */
+  BT_HDR* NewAudioPacket(uint16_t packet_size, HearingDevice* hearingAid) {
     if (!hearingAid->playback_started || !hearingAid->command_acked) {
       VLOG(2) << __func__
               << ": Playback stalled, device=" << hearingAid->address
               << ", cmd send=" << hearingAid->playback_started
               << ", cmd acked=" << hearingAid->command_acked;
-      return;
+      return nullptr;
     }
 
     BT_HDR* audio_packet = malloc_l2cap_buf(packet_size + 1);
     uint8_t* p = get_l2cap_sdu_start_ptr(audio_packet);
     *p = seq_counter;
-    p++;
-    memcpy(p, encoded_data, packet_size);
+    return audio_packet;
+  }
+
+  void SendAudio(BT_HDR* audio_packet, size_t encoded_len,
+                 HearingDevice* hearingAid) {
+    if (audio_packet == nullptr) return;
+
+    uint8_t* p = get_l2cap_sdu_start_ptr(audio_packet) + 1;
+    uint16_t packet_size = audio_packet->len - 1;
+    // Pad the last packet of the frame, if the audio did not fill it up
+    memset(p + encoded_len, 0, packet_size - encoded_len);
 
     DVLOG(2) << hearingAid->address << " : " << base::HexEncode(p, packet_size);
 
@@ -1735,6 +1750,10 @@ class HearingAidImpl : public HearingAid {
  private:
   uint8_t gatt_if;
   uint8_t seq_counter;
+  /* audio buffers kept across ticks, to not reallocate them 100 times a
+   * second */
+  std::vector<int16_t> pcm_data;
+  std::vector<uint8_t> scratch_data;
   /* current volume gain for the hearing aids*/
   int8_t current_volume;
   bluetooth::hearing_aid::HearingAidCallbacks* callbacks;
@@ -26,7 +26,7 @@
 #include "audio_hal_interface/hearing_aid_software_encoding.h"
 #include "audio_hearing_aid_hw/include/audio_hearing_aid_hw.h"
 #include "bta/include/bta_hearing_aid_api.h"
-#include "common/repeating_timer.h"
+#include "common/audio_tick_scheduler.h"
 #include "common/time_util.h"
 #include "osi/include/wakelock.h"
 #include "stack/include/btu.h"  // get_main_thread
@@ -61,7 +61,7 @@ int bit_rate = -1;
 int sample_rate = -1;
 int data_interval_ms = -1;
 int num_channels = 2;
-bluetooth::common::RepeatingTimer audio_timer;
+bluetooth::common::AudioTickScheduler audio_ticks;
 HearingAidAudioReceiver* localAudioReceiver = nullptr;
 std::unique_ptr<tUIPC_STATE> uipc_hearing_aid = nullptr;
 
@@ -84,7 +84,7 @@ AudioHalStats stats;
 bool hearing_aid_on_resume_req(bool start_media_task);
 bool hearing_aid_on_suspend_req();
 
-void send_audio_data() {
+void send_audio_data(const bluetooth::common::AudioTick& tick) {
   uint32_t bytes_per_tick =
       (num_channels * sample_rate * data_interval_ms * (bit_rate / 8)) / 1000;
 
@@ -126,19 +126,21 @@ void start_audio_ticks() {
   }
 
   wakelock_acquire();
-  audio_timer.SchedulePeriodic(
+  // Ticks run on the main thread, whose scheduling is left as is
+  audio_ticks.Start(
       get_main_thread()->GetWeakPtr(), FROM_HERE, base::Bind(&send_audio_data),
 #if BASE_VER < 931007
-      base::TimeDelta::FromMilliseconds(data_interval_ms));
+      base::TimeDelta::FromMilliseconds(data_interval_ms),
 #else
-      base::Milliseconds(data_interval_ms));
+      base::Milliseconds(data_interval_ms),
 #endif
+      {});
   LOG(INFO) << __func__ << ": running with data interval: " << data_interval_ms;
 }
 
 void stop_audio_ticks() {
   LOG(INFO) << __func__ << ": stopped";
-  audio_timer.CancelAndWait();
+  audio_ticks.CancelAndWait();
   wakelock_release();
 }
 
@@ -451,4 +453,5 @@ void HearingAidAudioSource::DebugDump(int fd) {
                  : 0)
          << std::endl;
   dprintf(fd, "%s", stream.str().c_str());
+  audio_ticks.DebugDump(fd);
 }
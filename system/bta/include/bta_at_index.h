@@ -0,0 +1,56 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/* Index over the names of an AT command or result table, used by the AG
+ * command parser and the HF client result parser.
+ *
+ * Both parsers match a table entry when its name is a prefix of the input,
+ * and the first such entry in table order wins. The index is a trie of the
+ * names, so a lookup walks the start of the input once instead of comparing
+ * it against every name in turn. It is built once per table and does not
+ * allocate on lookups.
+ */
+class BtaAtIndex {
+ public:
+  static constexpr size_t kNoMatch = SIZE_MAX;
+
+  /* |names| are in table order. With |ignore_case|, lower case letters in
+   * the input match upper case letters in the names, like utl_strucmp(). */
+  BtaAtIndex(const std::vector<const char*>& names, bool ignore_case);
+
+  /* Returns the position in |names| of the first name that is a prefix of
+   * the NUL terminated |str|, or kNoMatch if no name is. */
+  size_t Find(const char* str) const;
+
+ private:
+  struct Node {
+    char c;
+    uint16_t first_child;  /* 0 if none, the root is never a child */
+    uint16_t next_sibling; /* 0 if none */
+    size_t match;          /* first name ending here, or kNoMatch */
+  };
+
+  uint16_t FindChild(uint16_t node, char c) const;
+
+  std::vector<Node> nodes_;
+  bool ignore_case_;
+};
@@ -14,6 +14,8 @@
  * limitations under the License.
  */
 
+#pragma once
+
 #include <cstdint>
 #include <list>
 #include <unordered_map>
@@ -32,6 +34,12 @@
  *
  * If you decide to use those methods in your app, make sure to not mix it with
  * existing BTA_GATTC_* API.
+ *
+ * With read coalescing enabled for a connection, reads queued next to each
+ * other are sent together in a single Read Multiple Variable Length request,
+ * and completed one by one as if they had been read on their own. Reads the
+ * response could not hold are read again on their own, as are all of them if
+ * the request fails.
  */
 class BtaGattQueue {
  public:
@@ -49,6 +57,8 @@ class BtaGattQueue {
                               tGATT_WRITE_TYPE write_type, GATT_WRITE_OP_CB cb,
                               void* cb_data);
   static void ConfigureMtu(uint16_t conn_id, uint16_t mtu);
+  static void SetReadCoalescing(uint16_t conn_id, bool enable);
+  static void DebugDump(int fd);
 
   /* Holds pending GATT operations */
   struct gatt_operation {
@@ -64,6 +74,24 @@ class BtaGattQueue {
     /* write-specific fields */
     tGATT_WRITE_TYPE write_type;
     std::vector<uint8_t> value;
+
+    uint64_t enqueue_time_us;
+    /* set to read on its own, when it could not be read with others */
+    bool no_coalescing;
+  };
+
+  /* Holds the settings and statistics of the queue of a connection */
+  struct gatt_connection {
+    bool coalesce_reads;
+    bool read_multi_var_supported;
+
+    uint64_t ops_executed;
+    uint64_t read_multi_requests;
+    uint64_t reads_coalesced;
+    uint64_t reads_retried;
+    uint64_t total_wait_us;
+    uint64_t max_wait_us;
+    size_t max_depth;
   };
 
  private:
@@ -77,9 +105,20 @@ class BtaGattQueue {
                                      const uint8_t* value, void* data);
   static void gatt_configure_mtu_op_finished(uint16_t conn_id,
                                              tGATT_STATUS status, void* data);
+  static bool gatt_execute_read_multi(uint16_t conn_id,
+                                      std::list<gatt_operation>& gatt_ops);
+  static void gatt_read_multi_op_finished(uint16_t conn_id,
+                                          tGATT_STATUS status,
+                                          const tBTA_GATTC_MULTI& handles,
+                                          uint16_t len, uint8_t* value,
+                                          void* data);
+  static void gatt_enqueue_op(uint16_t conn_id, gatt_operation op);
+  static gatt_connection& get_connection(uint16_t conn_id);
 
   // maps connection id to operations waiting for execution
   static std::unordered_map<uint16_t, std::list<gatt_operation>> gatt_op_queue;
   // contain connection ids that currently execute operations
   static std::unordered_set<uint16_t> gatt_op_queue_executing;
+  // maps connection id to its queue settings and statistics
+  static std::unordered_map<uint16_t, gatt_connection> gatt_connections;
 };
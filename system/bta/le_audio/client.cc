@@ -1137,6 +1137,7 @@ class LeAudioClientImpl : public LeAudioClient {
       leAudioDevice->audio_directions_ |=
           le_audio::types::kLeAudioDirectionSink;
       leAudioDevice->snk_audio_locations_ = snk_audio_locations;
+      leAudioDevice->CapabilitiesUpdated();
 
       LeAudioDeviceGroup* group = aseGroups_.FindById(leAudioDevice->group_id_);
       callbacks_->OnSinkAudioLocationAvailable(leAudioDevice->address_,
@@ -1168,6 +1169,7 @@ class LeAudioClientImpl : public LeAudioClient {
       leAudioDevice->audio_directions_ |=
           le_audio::types::kLeAudioDirectionSource;
       leAudioDevice->src_audio_locations_ = src_audio_locations;
+      leAudioDevice->CapabilitiesUpdated();
 
       LeAudioDeviceGroup* group = aseGroups_.FindById(leAudioDevice->group_id_);
       /* Read of source audio locations during initial attribute discovery.
@@ -1815,6 +1817,9 @@ class LeAudioClientImpl : public LeAudioClient {
       }
     }
 
+    /* PAC characteristics and ASEs were refreshed */
+    leAudioDevice->CapabilitiesUpdated();
+
     leAudioDevice->known_service_handles_ = true;
     leAudioDevice->notify_connected_after_read_ = true;
 
@@ -3322,6 +3327,11 @@ class LeAudioClientImpl : public LeAudioClient {
           break;
         }
 
+        /* The controller clock paces the SDUs sent as well */
+        if (event->ts != 0) {
+          leAudioClientAudioSource->UpdateControllerTimestamp(event->ts);
+        }
+
         SendAudioData(event->p_msg->data + event->p_msg->offset,
                       event->p_msg->len - event->p_msg->offset,
                       event->cis_conn_hdl, event->ts);
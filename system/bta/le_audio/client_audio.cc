@@ -55,6 +55,10 @@ struct AudioHalStats {
 
 AudioHalStats stats;
 
+/* Shared by the unicast and broadcast sources, only one of which is acquired
+ * at a time */
+bluetooth::common::AudioTickScheduler audio_ticks;
+
 bool le_audio_source_on_metadata_update_req(
     const sink_metadata_t& sink_metadata) {
   // TODO: update microphone configuration based on sink metadata
@@ -81,7 +85,8 @@ bool LeAudioClientAudioSource::SinkOnResumeReq(bool start_media_task) {
   return true;
 }
 
-void LeAudioClientAudioSource::SendAudioData() {
+void LeAudioClientAudioSource::SendAudioData(
+    const bluetooth::common::AudioTick& tick) {
   // 24 bit audio is aligned to 32bit
   int bytes_per_sample = (source_codec_config_.bits_per_sample == 24)
                              ? 4
@@ -138,19 +143,24 @@ bool LeAudioClientAudioSource::InitAudioSinkThread(const std::string name) {
 
 void LeAudioClientAudioSource::StartAudioTicks() {
   wakelock_acquire();
-  audio_timer_.SchedulePeriodic(
+  /* The worker thread already runs with real time priority. SDUs are sent on
+   * the controller clock, which the ticks follow when it is known. */
+  audio_ticks.Start(
       worker_thread_->GetWeakPtr(), FROM_HERE,
       base::Bind(&LeAudioClientAudioSource::SendAudioData,
                  base::Unretained(this)),
 #if BASE_VER < 931007
-      base::TimeDelta::FromMicroseconds(source_codec_config_.data_interval_us));
+      base::TimeDelta::FromMicroseconds(source_codec_config_.data_interval_us),
 #else
-      base::Microseconds(source_codec_config_.data_interval_us));
+      base::Microseconds(source_codec_config_.data_interval_us),
 #endif
+      {.timer_slack_ns = bluetooth::common::AudioTickScheduler::
+           kAudioTimerSlackNs,
+       .follow_reference = true});
 }
 
 void LeAudioClientAudioSource::StopAudioTicks() {
-  audio_timer_.CancelAndWait();
+  audio_ticks.CancelAndWait();
   wakelock_release();
 }
 
@@ -472,6 +482,11 @@ void LeAudioClientAudioSource::UpdateRemoteDelay(uint16_t remote_delay_ms) {
   sinkClientInterface_->SetRemoteDelay(remote_delay_ms);
 }
 
+void LeAudioClientAudioSource::UpdateControllerTimestamp(
+    uint32_t sdu_timestamp_us) {
+  audio_ticks.OnReferenceTimestamp(sdu_timestamp_us);
+}
+
 void LeAudioClientAudioSource::DebugDump(int fd) {
   uint64_t now_us = bluetooth::common::time_get_os_boottime_us();
   std::stringstream stream;
@@ -488,6 +503,7 @@ void LeAudioClientAudioSource::DebugDump(int fd) {
                  : 0)
          << std::endl;
   dprintf(fd, "%s", stream.str().c_str());
+  audio_ticks.DebugDump(fd);
 }
 
 void LeAudioClientAudioSource::UpdateAudioConfigToHal(
@@ -19,7 +19,7 @@
 #include <future>
 
 #include "audio_hal_interface/le_audio_software.h"
-#include "common/repeating_timer.h"
+#include "common/audio_tick_scheduler.h"
 
 /* Implementations of Le Audio will also implement this interface */
 class LeAudioClientAudioSinkReceiver {
@@ -126,6 +126,9 @@ class LeAudioClientAudioSource {
   virtual void UpdateRemoteDelay(uint16_t remote_delay_ms);
   virtual void UpdateAudioConfigToHal(const ::le_audio::offload_config& config);
   virtual void SuspendedForReconfiguration();
+  /* Time stamp of an SDU received from the controller, on the clock it sends
+   * SDUs with */
+  virtual void UpdateControllerTimestamp(uint32_t sdu_timestamp_us);
 
   static void DebugDump(int fd);
 
@@ -142,9 +145,8 @@ class LeAudioClientAudioSource {
 
   void StartAudioTicks();
   void StopAudioTicks();
-  void SendAudioData();
+  void SendAudioData(const bluetooth::common::AudioTick& tick);
 
-  bluetooth::common::RepeatingTimer audio_timer_;
   LeAudioCodecConfiguration source_codec_config_;
   LeAudioClientAudioSinkReceiver* audioSinkReceiver_;
   bluetooth::audio::le_audio::LeAudioClientInterface::Sink*
@@ -58,6 +58,7 @@ void LeAudioDeviceGroup::AddNode(
     const std::shared_ptr<LeAudioDevice>& leAudioDevice) {
   leAudioDevice->group_id_ = group_id_;
   leAudioDevices_.push_back(std::weak_ptr<LeAudioDevice>(leAudioDevice));
+  supported_configuration_memo_.clear();
   MetricsCollector::Get()->OnGroupSizeUpdate(group_id_, leAudioDevices_.size());
 }
 
@@ -75,6 +76,7 @@ void LeAudioDeviceGroup::RemoveNode(
           leAudioDevices_.begin(), leAudioDevices_.end(),
           [&leAudioDevice](auto& d) { return d.lock() == leAudioDevice; }),
       leAudioDevices_.end());
+  supported_configuration_memo_.clear();
   MetricsCollector::Get()->OnGroupSizeUpdate(group_id_, leAudioDevices_.size());
 }
 
@@ -1199,6 +1201,34 @@ void LeAudioDeviceGroup::SetPendingConfiguration(void) {
   stream_conf.pending_configuration = true;
 }
 
+/* Returns everything the configuration matching depends on for the group
+ * devices: connection state, available contexts, ASEs, audio locations and
+ * PACs generation.
+ */
+std::vector<uint32_t> LeAudioDeviceGroup::GetConfigurationMatchingState(void) {
+  std::vector<uint32_t> state;
+  state.reserve(leAudioDevices_.size() * 8);
+
+  for (auto& d : leAudioDevices_) {
+    auto device = d.lock();
+    if (!device) {
+      state.push_back(UINT32_MAX);
+      continue;
+    }
+
+    state.push_back(device->GetCapabilitiesGeneration());
+    state.push_back(device->conn_id_ != GATT_INVALID_CONN_ID);
+    state.push_back(device->GetAvailableContexts().to_ulong());
+    state.push_back(device->ases_.size());
+    state.push_back(device->snk_pacs_.size());
+    state.push_back(device->src_pacs_.size());
+    state.push_back(device->snk_audio_locations_.to_ulong());
+    state.push_back(device->src_audio_locations_.to_ulong());
+  }
+
+  return state;
+}
+
 const set_configurations::AudioSetConfiguration*
 LeAudioDeviceGroup::FindFirstSupportedConfiguration(
     LeAudioContextType context_type) {
@@ -1208,23 +1238,41 @@ LeAudioDeviceGroup::FindFirstSupportedConfiguration(
   DLOG(INFO) << __func__ << " context type: " << (int)context_type
              << " number of connected devices: " << NumOfConnected();
 
+  /* Reuse the previous result unless anything it was matched against has
+   * changed since.
+   */
+  auto devices_state = GetConfigurationMatchingState();
+  auto memo = supported_configuration_memo_.find(context_type);
+  if (memo != supported_configuration_memo_.end() &&
+      memo->second.confs == confs &&
+      memo->second.devices_state == devices_state) {
+    return memo->second.conf;
+  }
+
+  const set_configurations::AudioSetConfiguration* supported_conf = nullptr;
+
   /* Filter out device set for all scenarios */
   if (!set_configurations::check_if_may_cover_scenario(confs,
                                                        NumOfConnected())) {
     LOG(ERROR) << __func__ << ", group is unable to cover scenario";
-    return nullptr;
-  }
-
-  /* Filter out device set for each end every scenario */
-
-  for (const auto& conf : *confs) {
-    if (IsConfigurationSupported(conf, context_type)) {
-      DLOG(INFO) << __func__ << " found: " << conf->name;
-      return conf;
+  } else {
+    /* Filter out device set for each end every scenario */
+    for (const auto& conf : *confs) {
+      if (IsConfigurationSupported(conf, context_type)) {
+        DLOG(INFO) << __func__ << " found: " << conf->name;
+        supported_conf = conf;
+        break;
+      }
     }
   }
 
-  return nullptr;
+  supported_configuration_memo_[context_type] = {
+      .confs = confs,
+      .devices_state = std::move(devices_state),
+      .conf = supported_conf,
+  };
+
+  return supported_conf;
 }
 
 /* This method should choose aproperiate ASEs to be active and set a cached
@@ -1322,6 +1370,16 @@ void LeAudioDeviceGroup::Dump(int fd) {
 void LeAudioDevice::ClearPACs(void) {
   snk_pacs_.clear();
   src_pacs_.clear();
+  CapabilitiesUpdated();
+}
+
+/* Must be called whenever PACs, ASEs or audio locations of the device are
+ * modified in place, as matching results cached for them become stale.
+ */
+void LeAudioDevice::CapabilitiesUpdated(void) {
+  capabilities_gen_++;
+  snk_pac_index_.reset();
+  src_pac_index_.reset();
 }
 
 LeAudioDevice::~LeAudioDevice(void) {
@@ -1351,6 +1409,7 @@ void LeAudioDevice::RegisterPACs(
   }
 
   pac_db->insert(pac_db->begin(), pac_recs->begin(), pac_recs->end());
+  CapabilitiesUpdated();
 }
 
 struct ase* LeAudioDevice::GetAseByValHandle(uint16_t val_hdl) {
@@ -1662,6 +1721,35 @@ LeAudioDevice::GetCodecConfigurationSupportedPac(
 
   /* TODO: Validate channel locations */
 
+  if (codec_capability_setting.id.coding_format ==
+      types::kLeAudioCodingFormatLC3) {
+    const auto& lc3_config =
+        std::get<LeAudioLc3Config>(codec_capability_setting.config);
+    if (!lc3_config.sampling_frequency || !lc3_config.frame_duration)
+      return nullptr;
+
+    /* Only check the records supporting the sampling frequency and frame
+     * duration, in the order they were registered in.
+     */
+    const auto& index = GetPacIndex(direction);
+    auto candidates = index.find((*lc3_config.sampling_frequency << 8) |
+                                 *lc3_config.frame_duration);
+    if (candidates == index.end()) return nullptr;
+
+    for (const auto& [tuple_idx, rec_idx] : candidates->second) {
+      if (tuple_idx >= pacs.size()) break;
+
+      auto& pac_recs = std::get<1>(pacs[tuple_idx]);
+      if (rec_idx >= pac_recs.size()) continue;
+
+      if (IsCodecCapabilitySettingSupported(pac_recs[rec_idx],
+                                            codec_capability_setting))
+        return &pac_recs[rec_idx];
+    }
+
+    return nullptr;
+  }
+
   for (const auto& pac_tuple : pacs) {
     /* Get PAC records from tuple as second element from tuple */
     auto& pac_recs = std::get<1>(pac_tuple);
@@ -1678,6 +1766,52 @@ LeAudioDevice::GetCodecConfigurationSupportedPac(
   return nullptr;
 }
 
+const LeAudioDevice::PacIndex& LeAudioDevice::GetPacIndex(uint8_t direction) {
+  bool is_sink = (direction == types::kLeAudioDirectionSink);
+  auto& pacs = is_sink ? snk_pacs_ : src_pacs_;
+  auto& index = is_sink ? snk_pac_index_ : src_pac_index_;
+
+  if (index) return *index;
+
+  index.emplace();
+  for (size_t tuple_idx = 0; tuple_idx < pacs.size(); tuple_idx++) {
+    auto& pac_recs = std::get<1>(pacs[tuple_idx]);
+
+    for (size_t rec_idx = 0; rec_idx < pac_recs.size(); rec_idx++) {
+      const auto& pac = pac_recs[rec_idx];
+      if (pac.codec_id.coding_format != types::kLeAudioCodingFormatLC3)
+        continue;
+
+      auto sampling_freqs = pac.codec_spec_caps.Find(
+          codec_spec_caps::kLeAudioCodecLC3TypeSamplingFreq);
+      auto frame_durations = pac.codec_spec_caps.Find(
+          codec_spec_caps::kLeAudioCodecLC3TypeFrameDuration);
+      if (!sampling_freqs || !frame_durations) continue;
+
+      uint16_t freq_caps = VEC_UINT8_TO_UINT16(sampling_freqs.value());
+      uint8_t duration_caps = VEC_UINT8_TO_UINT8(frame_durations.value());
+
+      /* Bit n of the capabilities stands for configuration value n + 1 */
+      for (uint8_t freq_bit = 0; freq_bit < 16; freq_bit++) {
+        if (!(freq_caps & (1 << freq_bit))) continue;
+
+        for (uint8_t duration :
+             {codec_spec_conf::kLeAudioCodecLC3FrameDur7500us,
+              codec_spec_conf::kLeAudioCodecLC3FrameDur10000us}) {
+          if (!(duration_caps &
+                codec_spec_caps::FrameDurationConfig2Capability(duration)))
+            continue;
+
+          (*index)[((freq_bit + 1) << 8) | duration].emplace_back(
+              tuple_idx, rec_idx);
+        }
+      }
+    }
+  }
+
+  return *index;
+}
+
 /**
  * Returns supported PHY's bitfield
  */
@@ -21,6 +21,8 @@
 #include <memory>
 #include <optional>
 #include <tuple>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "bt_types.h"
@@ -94,10 +96,13 @@ class LeAudioDevice {
         group_id_(group_id),
         csis_member_(false),
         audio_directions_(0),
-        link_quality_timer(nullptr) {}
+        link_quality_timer(nullptr),
+        capabilities_gen_(0) {}
   ~LeAudioDevice(void);
 
   void ClearPACs(void);
+  void CapabilitiesUpdated(void);
+  uint32_t GetCapabilitiesGeneration(void) const { return capabilities_gen_; }
   void RegisterPACs(std::vector<struct types::acs_ac_record>* apr_db,
                     std::vector<struct types::acs_ac_record>* apr);
   struct types::ase* GetAseByValHandle(uint16_t val_hdl);
@@ -153,6 +158,22 @@ class LeAudioDevice {
   types::AudioContexts avail_src_contexts_;
   types::AudioContexts supp_snk_context_;
   types::AudioContexts supp_src_context_;
+
+  /* Bumped whenever PACs, ASEs or audio locations change, so that cached
+   * configuration matching results for this device get recomputed.
+   */
+  uint32_t capabilities_gen_;
+
+  /* LC3 PAC records bucketed by sampling frequency and frame duration, as
+   * (PAC tuple, record) positions within snk_pacs_ or src_pacs_. Built on
+   * demand and dropped whenever the capabilities change.
+   */
+  using PacIndex =
+      std::unordered_map<uint16_t, std::vector<std::pair<size_t, size_t>>>;
+  std::optional<PacIndex> snk_pac_index_;
+  std::optional<PacIndex> src_pac_index_;
+
+  const PacIndex& GetPacIndex(uint8_t direction);
 };
 
 /* LeAudioDevices class represents a wraper helper over all devices in le audio
@@ -300,6 +321,19 @@ class LeAudioDeviceGroup {
       const set_configurations::AudioSetConfiguration* audio_set_configuration,
       types::LeAudioContextType context_type);
   uint32_t GetTransportLatencyUs(uint8_t direction);
+  std::vector<uint32_t> GetConfigurationMatchingState(void);
+
+  /* Results of FindFirstSupportedConfiguration() per context type, valid
+   * for as long as the configurations and the matching state of the group
+   * devices they were computed from stay the same.
+   */
+  struct SupportedConfigurationMemo {
+    const set_configurations::AudioSetConfigurations* confs;
+    std::vector<uint32_t> devices_state;
+    const set_configurations::AudioSetConfiguration* conf;
+  };
+  std::map<types::LeAudioContextType, SupportedConfigurationMemo>
+      supported_configuration_memo_;
 
   /* Mask and table of currently supported contexts */
   types::LeAudioContextType active_context_type_;
@@ -444,6 +444,7 @@ class LeAudioAseConfigurationTest : public Test {
         ::le_audio::codec_spec_conf::kLeAudioLocationFrontRight;
 
     device->conn_id_ = index;
+    device->CapabilitiesUpdated();
     return device.get();
   }
 
@@ -506,6 +507,7 @@ class LeAudioAseConfigurationTest : public Test {
 
       data[i].device->snk_pacs_ = snk_pac_builder.Get();
       data[i].device->src_pacs_ = src_pac_builder.Get();
+      data[i].device->CapabilitiesUpdated();
     }
 
     /* Stimulate update of active context map */
@@ -547,6 +549,7 @@ class LeAudioAseConfigurationTest : public Test {
 
         data[i].device->snk_pacs_ = snk_pac_builder.Get();
         data[i].device->src_pacs_ = src_pac_builder.Get();
+        data[i].device->CapabilitiesUpdated();
       }
 
       /* Stimulate update of active context map */
@@ -629,6 +632,7 @@ class LeAudioAseConfigurationTest : public Test {
               parameters*/
               device->snk_pacs_ = pac_builder.Get();
               device->src_pacs_ = pac_builder.Get();
+              device->CapabilitiesUpdated();
             }
 
             bool success_expected = is_lc3_setting_supported;
@@ -844,6 +848,48 @@ TEST_F(LeAudioAseConfigurationTest, test_lc3_config_media) {
   TestLc3CodecConfig(LeAudioContextType::MEDIA);
 }
 
+TEST_F(LeAudioAseConfigurationTest, test_configuration_follows_pacs_change) {
+  LeAudioDevice* device = AddTestDevice(1, 0);
+
+  PublishedAudioCapabilitiesBuilder pac_builder;
+  pac_builder.Add(LeAudioCodecIdLc3,
+                  GetSamplingFrequency(Lc3SettingId::LC3_16_2),
+                  GetFrameDuration(Lc3SettingId::LC3_16_2),
+                  kLeAudioCodecLC3ChannelCountSingleChannel,
+                  GetOctetsPerCodecFrame(Lc3SettingId::LC3_16_2));
+  device->snk_pacs_ = pac_builder.Get();
+  device->CapabilitiesUpdated();
+
+  uint16_t context_type = static_cast<uint16_t>(LeAudioContextType::RINGTONE);
+  group_->UpdateActiveContextsMap(context_type);
+  ASSERT_TRUE(group_->IsContextSupported(LeAudioContextType::RINGTONE));
+
+  /* Nothing changed, the previous result holds */
+  ASSERT_EQ(std::nullopt, group_->UpdateActiveContextsMap(context_type));
+  ASSERT_TRUE(group_->IsContextSupported(LeAudioContextType::RINGTONE));
+
+  device->ClearPACs();
+  group_->UpdateActiveContextsMap(context_type);
+  ASSERT_FALSE(group_->IsContextSupported(LeAudioContextType::RINGTONE));
+
+  device->snk_pacs_ = pac_builder.Get();
+  device->CapabilitiesUpdated();
+  group_->UpdateActiveContextsMap(context_type);
+  ASSERT_TRUE(group_->IsContextSupported(LeAudioContextType::RINGTONE));
+
+  /* Same number of records, but none of them supported anymore */
+  PublishedAudioCapabilitiesBuilder unsupported_pac_builder;
+  unsupported_pac_builder.Add(
+      LeAudioCodecIdLc3, GetSamplingFrequency(Lc3SettingId::UNSUPPORTED),
+      GetFrameDuration(Lc3SettingId::LC3_16_2),
+      kLeAudioCodecLC3ChannelCountSingleChannel,
+      GetOctetsPerCodecFrame(Lc3SettingId::LC3_16_2));
+  device->snk_pacs_ = unsupported_pac_builder.Get();
+  device->CapabilitiesUpdated();
+  group_->UpdateActiveContextsMap(context_type);
+  ASSERT_FALSE(group_->IsContextSupported(LeAudioContextType::RINGTONE));
+}
+
 TEST_F(LeAudioAseConfigurationTest, test_unsupported_codec) {
   const LeAudioCodecId UnsupportedCodecId = {
       .coding_format = kLeAudioCodingFormatVendorSpecific,
@@ -861,6 +907,7 @@ TEST_F(LeAudioAseConfigurationTest, test_unsupported_codec) {
                   GetOctetsPerCodecFrame(Lc3SettingId::LC3_16_2));
   device->snk_pacs_ = pac_builder.Get();
   device->src_pacs_ = pac_builder.Get();
+  device->CapabilitiesUpdated();
 
   ASSERT_FALSE(group_->Configure(LeAudioContextType::RINGTONE));
   TestAsesInactive();
@@ -17,6 +17,8 @@
 
 #pragma once
 
+#include <memory>
+
 #include "le_audio_types.h"
 
 namespace le_audio {
@@ -15,6 +15,11 @@
  *
  */
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include <string>
 #include <string_view>
 
@@ -25,6 +30,7 @@
 #include "flatbuffers/util.h"
 #include "le_audio_set_configuration_provider.h"
 #include "osi/include/log.h"
+#include "osi/include/properties.h"
 
 using le_audio::set_configurations::AudioSetConfiguration;
 using le_audio::set_configurations::AudioSetConfigurations;
@@ -37,7 +43,19 @@ using le_audio::types::LeAudioContextType;
 namespace le_audio {
 using ::le_audio::CodecManager;
 
+/* Set configurations are compiled into FlatBuffers binaries at build time and
+ * read in place. Setting this property loads the JSON sources instead, so that
+ * they can be edited on a development device. */
+static constexpr char kLeAudioSetConfigsFromJsonProperty[] =
+    "persist.bluetooth.leaudio.json_set_configurations";
+
 #ifdef OS_ANDROID
+static const std::vector<const char*> kLeAudioSetConfigsBinary = {
+    "/apex/com.android.btservices/etc/bluetooth/le_audio/"
+    "audio_set_configurations.bin"};
+static const std::vector<const char*> kLeAudioSetScenariosBinary = {
+    "/apex/com.android.btservices/etc/bluetooth/le_audio/"
+    "audio_set_scenarios.bin"};
 static const std::vector<
     std::pair<const char* /*schema*/, const char* /*content*/>>
     kLeAudioSetConfigs = {
@@ -52,6 +70,10 @@ static const std::vector<
                              "/apex/com.android.btservices/etc/bluetooth/"
                              "le_audio/audio_set_scenarios.json"}};
 #else
+static const std::vector<const char*> kLeAudioSetConfigsBinary = {
+    "audio_set_configurations.bin"};
+static const std::vector<const char*> kLeAudioSetScenariosBinary = {
+    "audio_set_scenarios.bin"};
 static const std::vector<
     std::pair<const char* /*schema*/, const char* /*content*/>>
     kLeAudioSetConfigs = {
@@ -62,9 +84,52 @@ static const std::vector<
         {"audio_set_scenarios.bfbs", "audio_set_scenarios.json"}};
 #endif
 
+/** Read-only memory mapping of a whole file */
+class MappedFile {
+ public:
+  explicit MappedFile(const char* path) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return;
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+      void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (data != MAP_FAILED) {
+        data_ = static_cast<const uint8_t*>(data);
+        size_ = st.st_size;
+      }
+    }
+    close(fd);
+  }
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  ~MappedFile() {
+    if (data_) munmap(const_cast<uint8_t*>(data_), size_);
+  }
+
+  const uint8_t* data() const { return data_; }
+  size_t size() const { return size_; }
+
+ private:
+  const uint8_t* data_ = nullptr;
+  size_t size_ = 0;
+};
+
 /** Provides a set configurations for the given context type */
 struct AudioSetConfigurationProviderJson {
   AudioSetConfigurationProviderJson() {
+    if (!osi_property_get_bool(kLeAudioSetConfigsFromJsonProperty, false)) {
+      if (LoadBinaryContent(kLeAudioSetConfigsBinary,
+                            kLeAudioSetScenariosBinary))
+        return;
+
+      LOG_WARN(": Compiled set configurations not available, using JSON.");
+      configurations_.clear();
+      context_configurations_.clear();
+    }
+
     ASSERT_LOG(LoadContent(kLeAudioSetConfigs, kLeAudioSetScenarios),
                ": Unable to load le audio set configuration files.");
   }
@@ -359,8 +424,28 @@ struct AudioSetConfigurationProviderJson {
     if (!ok) return ok;
 
     /* Import from flatbuffers */
-    auto configurations_root = bluetooth::le_audio::GetAudioSetConfigurations(
-        configurations_parser_.builder_.GetBufferPointer());
+    return LoadConfigurationsFromFlat(
+        bluetooth::le_audio::GetAudioSetConfigurations(
+            configurations_parser_.builder_.GetBufferPointer()));
+  }
+
+  bool LoadConfigurationsFromBinary(const char* binary_file) {
+    MappedFile content(binary_file);
+    if (!content.data()) return false;
+
+    flatbuffers::Verifier verifier(content.data(), content.size());
+    if (!bluetooth::le_audio::VerifyAudioSetConfigurationsBuffer(verifier)) {
+      LOG_ERROR(": Invalid set configurations in %s", binary_file);
+      return false;
+    }
+
+    /* Read in place, nothing to parse */
+    return LoadConfigurationsFromFlat(
+        bluetooth::le_audio::GetAudioSetConfigurations(content.data()));
+  }
+
+  bool LoadConfigurationsFromFlat(
+      const bluetooth::le_audio::AudioSetConfigurations* configurations_root) {
     if (!configurations_root) return false;
 
     auto flat_qos_configs = configurations_root->qos_configurations();
@@ -436,8 +521,27 @@ struct AudioSetConfigurationProviderJson {
     if (!ok) return ok;
 
     /* Import from flatbuffers */
-    auto scenarios_root = bluetooth::le_audio::GetAudioSetScenarios(
-        scenarios_parser_.builder_.GetBufferPointer());
+    return LoadScenariosFromFlat(bluetooth::le_audio::GetAudioSetScenarios(
+        scenarios_parser_.builder_.GetBufferPointer()));
+  }
+
+  bool LoadScenariosFromBinary(const char* binary_file) {
+    MappedFile content(binary_file);
+    if (!content.data()) return false;
+
+    flatbuffers::Verifier verifier(content.data(), content.size());
+    if (!bluetooth::le_audio::VerifyAudioSetScenariosBuffer(verifier)) {
+      LOG_ERROR(": Invalid scenarios in %s", binary_file);
+      return false;
+    }
+
+    /* Read in place, nothing to parse */
+    return LoadScenariosFromFlat(
+        bluetooth::le_audio::GetAudioSetScenarios(content.data()));
+  }
+
+  bool LoadScenariosFromFlat(
+      const bluetooth::le_audio::AudioSetScenarios* scenarios_root) {
     if (!scenarios_root) return false;
 
     auto flat_scenarios = scenarios_root->scenarios();
@@ -469,6 +573,18 @@ struct AudioSetConfigurationProviderJson {
     return true;
   }
 
+  bool LoadBinaryContent(const std::vector<const char*>& config_files,
+                         const std::vector<const char*>& scenario_files) {
+    for (auto binary : config_files) {
+      if (!LoadConfigurationsFromBinary(binary)) return false;
+    }
+
+    for (auto binary : scenario_files) {
+      if (!LoadScenariosFromBinary(binary)) return false;
+    }
+    return true;
+  }
+
   std::string ContextTypeToScenario(
       ::le_audio::types::LeAudioContextType context_type) {
     switch (context_type) {
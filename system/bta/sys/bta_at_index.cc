@@ -0,0 +1,68 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "bta/include/bta_at_index.h"
+
+#include <base/logging.h>
+
+#include <algorithm>
+
+namespace {
+
+char to_upper(char c) { return (c >= 'a' && c <= 'z') ? c - 0x20 : c; }
+
+}  // namespace
+
+BtaAtIndex::BtaAtIndex(const std::vector<const char*>& names,
+                       bool ignore_case)
+    : ignore_case_(ignore_case) {
+  nodes_.push_back({0, 0, 0, kNoMatch});
+  for (size_t i = 0; i < names.size(); i++) {
+    uint16_t node = 0;
+    for (const char* p = names[i]; *p != 0; p++) {
+      uint16_t child = FindChild(node, *p);
+      if (child == 0) {
+        CHECK(nodes_.size() < UINT16_MAX);
+        child = static_cast<uint16_t>(nodes_.size());
+        nodes_.push_back({*p, 0, nodes_[node].first_child, kNoMatch});
+        nodes_[node].first_child = child;
+      }
+      node = child;
+    }
+    /* An empty name would match everything, tables use it as terminator */
+    if (node != 0) nodes_[node].match = std::min(nodes_[node].match, i);
+  }
+}
+
+uint16_t BtaAtIndex::FindChild(uint16_t node, char c) const {
+  for (uint16_t child = nodes_[node].first_child; child != 0;
+       child = nodes_[child].next_sibling) {
+    if (nodes_[child].c == c) return child;
+  }
+  return 0;
+}
+
+size_t BtaAtIndex::Find(const char* str) const {
+  size_t match = kNoMatch;
+  uint16_t node = 0;
+  /* Names never contain NUL, so the walk stops at the end of |str| */
+  for (; *str != 0; str++) {
+    node = FindChild(node, ignore_case_ ? to_upper(*str) : *str);
+    if (node == 0) break;
+    match = std::min(match, nodes_[node].match);
+  }
+  return match;
+}
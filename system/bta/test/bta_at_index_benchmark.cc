@@ -0,0 +1,203 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <base/logging.h>
+#include <benchmark/benchmark.h>
+
+#include <cstring>
+#include <iterator>
+#include <vector>
+
+#include "bta/include/bta_at_index.h"
+
+using ::benchmark::State;
+
+namespace {
+
+// Command names of the AG HFP command table, in table order
+const std::vector<const char*> kAgCommands = {
+    "A",     "D",     "+VGS",  "+VGM",  "+CCWA", "+CHLD", "+CHUP", "+CIND",
+    "+CLIP", "+CMER", "+VTS",  "+BINP", "+BLDN", "+BVRA", "+BRSF", "+NREC",
+    "+CNUM", "+BTRH", "+CLCC", "+COPS", "+CMEE", "+BIA",  "+CBC",  "+BCC",
+    "+BCS",  "+BIND", "+BIEV", "+BAC"};
+
+// What an AG receives from a hands-free unit connecting and taking a call,
+// without the leading "AT"
+const char* const kAgTraffic[] = {
+    "+BRSF=959",
+    "+BAC=1,2",
+    "+CIND=?",
+    "+CIND?",
+    "+CMER=3,0,0,1",
+    "+CHLD=?",
+    "+BIND=1,2",
+    "+BIND=?",
+    "+BIND?",
+    "+CMEE=1",
+    "+CLIP=1",
+    "+CCWA=1",
+    "+NREC=0",
+    "+VGS=9",
+    "+VGM=9",
+    "+BIA=0,0",
+    "+COPS=3,0",
+    "+COPS?",
+    "+CLCC",
+    "+BCS=2",
+    "A",
+    "+CLCC",
+    "+BIEV=2,5",
+    "+CHUP",
+    "+CLCC",
+    "+XAPL=05AC-1702-0100,7",
+    "+IPHONEACCEV=1,1,9",
+};
+
+// Result names of the HF client parsers, in table order
+const std::vector<const char*> kHfEvents = {
+    "OK",
+    "ERROR",
+    "RING",
+    "+BRSF:",
+    "+CIND:",
+    "+CIEV:",
+    "+CHLD:",
+    "+BCS:",
+    "+BSIR:",
+    "+CME ERROR:",
+    "+VGM:",
+    "+VGM=",
+    "+VGS:",
+    "+VGS=",
+    "+BVRA:",
+    "+CLIP:",
+    "+CCWA:",
+    "+COPS:",
+    "+BINP:",
+    "+CLCC:",
+    "+CNUM:",
+    "+BTRH:",
+    "+BIND:",
+    "BUSY",
+    "DELAYED",
+    "NO CARRIER",
+    "NO ANSWER",
+    "REJECTLISTED",
+};
+
+// What a hands-free unit receives from the AG for the same exchange, without
+// the leading <cr><lf>
+const char* const kHfTraffic[] = {
+    "+BRSF: 3903\r\n",
+    "OK\r\n",
+    "+CIND: (\"call\",(0,1)),(\"callsetup\",(0-3)),(\"service\",(0-1))\r\n",
+    "OK\r\n",
+    "+CIND: 0,0,1,4,0,4,0\r\n",
+    "OK\r\n",
+    "+CHLD: (0,1,2,3)\r\n",
+    "OK\r\n",
+    "+BIND: (1,2)\r\n",
+    "+BIND: 1,1\r\n",
+    "+BIND: 2,1\r\n",
+    "+CIEV: 2,1\r\n",
+    "RING\r\n",
+    "+CLIP: \"5551234\",129\r\n",
+    "+CIEV: 1,1\r\n",
+    "+CIEV: 2,0\r\n",
+    "+CLCC: 1,1,0,0,0,\"5551234\",129\r\n",
+    "+VGS: 9\r\n",
+    "+CIEV: 1,0\r\n",
+    "NO CARRIER\r\n",
+    "+XAPL=iPhone,6\r\n",
+};
+
+// Case insensitive prefix compare, same as utl_strucmp()
+int strucmp(const char* p_s, const char* p_t) {
+  while (*p_s && *p_t) {
+    char c = *p_t++;
+    if (c >= 'a' && c <= 'z') c -= 0x20;
+    if (*p_s++ != c) return -1;
+  }
+  return (*p_t == 0 && *p_s != 0) ? 1 : 0;
+}
+
+// What the AG command parser did before: compare with every command in turn
+void BM_AgCommandLookupLinear(State& state) {
+  for (auto _ : state) {
+    for (const char* command : kAgTraffic) {
+      size_t idx = 0;
+      while (idx < kAgCommands.size() && strucmp(kAgCommands[idx], command)) {
+        idx++;
+      }
+      benchmark::DoNotOptimize(idx);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * std::size(kAgTraffic));
+}
+BENCHMARK(BM_AgCommandLookupLinear);
+
+void BM_AgCommandLookupIndex(State& state) {
+  BtaAtIndex index(kAgCommands, true);
+  for (auto _ : state) {
+    for (const char* command : kAgTraffic) {
+      benchmark::DoNotOptimize(index.Find(command));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * std::size(kAgTraffic));
+}
+BENCHMARK(BM_AgCommandLookupIndex);
+
+// What the HF client parser did before: try every parser in turn, each of
+// which compares the event with its own name
+void BM_HfEventLookupLinear(State& state) {
+  for (auto _ : state) {
+    for (const char* event : kHfTraffic) {
+      size_t idx = 0;
+      while (idx < kHfEvents.size() &&
+             strncmp(kHfEvents[idx], event, strlen(kHfEvents[idx])) != 0) {
+        idx++;
+      }
+      benchmark::DoNotOptimize(idx);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * std::size(kHfTraffic));
+}
+BENCHMARK(BM_HfEventLookupLinear);
+
+void BM_HfEventLookupIndex(State& state) {
+  BtaAtIndex index(kHfEvents, false);
+  for (auto _ : state) {
+    for (const char* event : kHfTraffic) {
+      benchmark::DoNotOptimize(index.Find(event));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * std::size(kHfTraffic));
+}
+BENCHMARK(BM_HfEventLookupIndex);
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  // Disable LOG() output from libchrome
+  logging::LoggingSettings log_settings;
+  log_settings.logging_dest = logging::LoggingDestination::LOG_NONE;
+  CHECK(logging::InitLogging(log_settings)) << "Failed to set up logging";
+  ::benchmark::Initialize(&argc, argv);
+  if (::benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  ::benchmark::RunSpecifiedBenchmarks();
+}
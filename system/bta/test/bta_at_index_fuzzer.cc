@@ -0,0 +1,74 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <fuzzer/FuzzedDataProvider.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "bta/include/bta_at_index.h"
+
+namespace {
+
+constexpr size_t kMaxNames = 64;
+constexpr size_t kMaxNameLength = 16;
+
+char to_upper(char c) { return (c >= 'a' && c <= 'z') ? c - 0x20 : c; }
+
+// The lookup BtaAtIndex replaces: the first name in table order that is a
+// prefix of |str|
+size_t LinearFind(const std::vector<const char*>& names, const char* str,
+                  bool ignore_case) {
+  for (size_t i = 0; i < names.size(); i++) {
+    size_t len = strlen(names[i]);
+    if (len == 0) continue;
+    size_t j = 0;
+    while (j < len && str[j] != 0 &&
+           (ignore_case ? to_upper(str[j]) : str[j]) == names[i][j]) {
+      j++;
+    }
+    if (j == len) return i;
+  }
+  return BtaAtIndex::kNoMatch;
+}
+
+}  // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+  FuzzedDataProvider fdp(data, size);
+  bool ignore_case = fdp.ConsumeBool();
+
+  std::vector<std::string> storage;
+  size_t num_names = fdp.ConsumeIntegralInRange<size_t>(0, kMaxNames);
+  for (size_t i = 0; i < num_names; i++) {
+    std::string name = fdp.ConsumeRandomLengthString(kMaxNameLength);
+    storage.push_back(name.substr(0, strlen(name.c_str())));
+  }
+  std::vector<const char*> names;
+  for (const auto& name : storage) names.push_back(name.c_str());
+
+  BtaAtIndex index(names, ignore_case);
+  while (fdp.remaining_bytes() > 0) {
+    std::string str = fdp.ConsumeRandomLengthString(2 * kMaxNameLength);
+    if (index.Find(str.c_str()) !=
+        LinearFind(names, str.c_str(), ignore_case)) {
+      abort();
+    }
+  }
+  return 0;
+}
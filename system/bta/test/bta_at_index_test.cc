@@ -0,0 +1,67 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "bta/include/bta_at_index.h"
+
+#include <gtest/gtest.h>
+
+TEST(BtaAtIndexTest, finds_name_at_start_of_input) {
+  BtaAtIndex index({"+VGS", "+VGM", "+CIND", "+CIEV"}, false);
+  EXPECT_EQ(index.Find("+VGS=5"), 0u);
+  EXPECT_EQ(index.Find("+VGM=5"), 1u);
+  EXPECT_EQ(index.Find("+CIND?"), 2u);
+  EXPECT_EQ(index.Find("+CIEV"), 3u);
+}
+
+TEST(BtaAtIndexTest, no_match) {
+  BtaAtIndex index({"+VGS", "+CIND"}, false);
+  EXPECT_EQ(index.Find(""), BtaAtIndex::kNoMatch);
+  EXPECT_EQ(index.Find("+VG"), BtaAtIndex::kNoMatch);
+  EXPECT_EQ(index.Find("+CIE"), BtaAtIndex::kNoMatch);
+  EXPECT_EQ(index.Find("VGS"), BtaAtIndex::kNoMatch);
+}
+
+TEST(BtaAtIndexTest, first_match_in_table_order) {
+  BtaAtIndex index({"+CMEE", "+C", "+CM", "D"}, false);
+  EXPECT_EQ(index.Find("+CMEE=1"), 0u);
+  EXPECT_EQ(index.Find("+CMER=3,0,0,1"), 1u);
+  EXPECT_EQ(index.Find("+CM"), 1u);
+  EXPECT_EQ(index.Find("D1234;"), 3u);
+
+  BtaAtIndex reversed({"+C", "+CMEE"}, false);
+  EXPECT_EQ(reversed.Find("+CMEE=1"), 0u);
+}
+
+TEST(BtaAtIndexTest, duplicate_names_match_the_first) {
+  BtaAtIndex index({"OK", "+COPS:", "OK"}, false);
+  EXPECT_EQ(index.Find("OK\r\n"), 0u);
+}
+
+TEST(BtaAtIndexTest, ignore_case) {
+  BtaAtIndex index({"+BRSF", "+CME ERROR:"}, true);
+  EXPECT_EQ(index.Find("+brsf=1"), 0u);
+  EXPECT_EQ(index.Find("+BrSf=1"), 0u);
+  EXPECT_EQ(index.Find("+cme error: 3"), 1u);
+
+  BtaAtIndex case_sensitive({"+BRSF"}, false);
+  EXPECT_EQ(case_sensitive.Find("+brsf=1"), BtaAtIndex::kNoMatch);
+}
+
+TEST(BtaAtIndexTest, empty_names_never_match) {
+  BtaAtIndex index({"", "A"}, false);
+  EXPECT_EQ(index.Find("B"), BtaAtIndex::kNoMatch);
+  EXPECT_EQ(index.Find("A"), 1u);
+}
@@ -0,0 +1,352 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <base/logging.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <map>
+#include <vector>
+
+#include "bta/include/bta_gatt_queue.h"
+
+uint8_t appl_trace_level = BT_TRACE_LEVEL_WARNING;
+void LogMsg(uint32_t trace_set_mask, const char* fmt_str, ...) {}
+
+namespace {
+
+constexpr uint16_t kConnId = 0x0003;
+constexpr uint64_t kConnectionIntervalMs = 30;
+
+// A GATT server reached over a link that takes a connection interval to
+// carry each request and its response
+class FakeGattServer {
+ public:
+  void Reset(uint16_t mtu, bool read_multi_var_supported) {
+    mtu_ = mtu;
+    read_multi_var_supported_ = read_multi_var_supported;
+    values_.clear();
+    unreadable_.clear();
+    pending_.clear();
+    elapsed_ms_ = 0;
+    requests_ = 0;
+    read_multi_requests_ = 0;
+  }
+
+  void AddValue(uint16_t handle, std::vector<uint8_t> value) {
+    values_[handle] = std::move(value);
+  }
+
+  void SetUnreadable(uint16_t handle) { unreadable_.push_back(handle); }
+
+  // Carries the outstanding requests, and their responses, until the client
+  // has nothing left to send
+  void Run() {
+    while (!pending_.empty()) {
+      auto response = std::move(pending_.front());
+      pending_.pop_front();
+      elapsed_ms_ += kConnectionIntervalMs;
+      response();
+    }
+  }
+
+  void Read(uint16_t handle, GATT_READ_OP_CB cb, void* cb_data) {
+    requests_++;
+    pending_.push_back([=]() {
+      tGATT_STATUS status = GATT_SUCCESS;
+      std::vector<uint8_t> value;
+      if (IsUnreadable(handle)) {
+        status = GATT_INSUF_AUTHENTICATION;
+      } else {
+        // Long values are read with Read Blob requests below BTA
+        value = values_[handle];
+      }
+      cb(kConnId, status, handle, value.size(), value.data(), cb_data);
+    });
+  }
+
+  void ReadMultiple(const tBTA_GATTC_MULTI& handles, bool variable_len,
+                    GATT_READ_MULTI_OP_CB cb, void* cb_data) {
+    requests_++;
+    read_multi_requests_++;
+    pending_.push_back([=]() {
+      if (!variable_len || !read_multi_var_supported_) {
+        cb(kConnId, GATT_REQ_NOT_SUPPORTED, handles, 0, nullptr, cb_data);
+        return;
+      }
+      std::vector<uint8_t> rsp;
+      for (int i = 0; i < handles.num_attr; i++) {
+        if (IsUnreadable(handles.handles[i])) {
+          cb(kConnId, GATT_INSUF_AUTHENTICATION, handles, 0, nullptr,
+             cb_data);
+          return;
+        }
+        const auto& value = values_[handles.handles[i]];
+        rsp.push_back(value.size() & 0xff);
+        rsp.push_back(value.size() >> 8);
+        rsp.insert(rsp.end(), value.begin(), value.end());
+      }
+      rsp.resize(std::min<size_t>(rsp.size(), mtu_ - 1));
+      cb(kConnId, GATT_SUCCESS, handles, rsp.size(), rsp.data(), cb_data);
+    });
+  }
+
+  void Write(uint16_t handle, std::vector<uint8_t> value, GATT_WRITE_OP_CB cb,
+             void* cb_data) {
+    requests_++;
+    pending_.push_back([=]() {
+      values_[handle] = value;
+      cb(kConnId, GATT_SUCCESS, handle, value.size(), value.data(), cb_data);
+    });
+  }
+
+  uint64_t elapsed_ms() const { return elapsed_ms_; }
+  int requests() const { return requests_; }
+  int read_multi_requests() const { return read_multi_requests_; }
+
+ private:
+  bool IsUnreadable(uint16_t handle) const {
+    return std::find(unreadable_.begin(), unreadable_.end(), handle) !=
+           unreadable_.end();
+  }
+
+  uint16_t mtu_ = 23;
+  bool read_multi_var_supported_ = true;
+  std::map<uint16_t, std::vector<uint8_t>> values_;
+  std::vector<uint16_t> unreadable_;
+  std::deque<std::function<void()>> pending_;
+  uint64_t elapsed_ms_ = 0;
+  int requests_ = 0;
+  int read_multi_requests_ = 0;
+};
+
+FakeGattServer server;
+
+}  // namespace
+
+void BTA_GATTC_ReadCharacteristic(uint16_t conn_id, uint16_t handle,
+                                  tGATT_AUTH_REQ auth_req,
+                                  GATT_READ_OP_CB callback, void* cb_data) {
+  server.Read(handle, callback, cb_data);
+}
+
+void BTA_GATTC_ReadCharDescr(uint16_t conn_id, uint16_t handle,
+                             tGATT_AUTH_REQ auth_req, GATT_READ_OP_CB callback,
+                             void* cb_data) {
+  server.Read(handle, callback, cb_data);
+}
+
+void BTA_GATTC_ReadMultiple(uint16_t conn_id, tBTA_GATTC_MULTI* p_read_multi,
+                            bool variable_len, tGATT_AUTH_REQ auth_req,
+                            GATT_READ_MULTI_OP_CB callback, void* cb_data) {
+  server.ReadMultiple(*p_read_multi, variable_len, callback, cb_data);
+}
+
+void BTA_GATTC_WriteCharValue(uint16_t conn_id, uint16_t handle,
+                              tGATT_WRITE_TYPE write_type,
+                              std::vector<uint8_t> value,
+                              tGATT_AUTH_REQ auth_req,
+                              GATT_WRITE_OP_CB callback, void* cb_data) {
+  server.Write(handle, std::move(value), callback, cb_data);
+}
+
+void BTA_GATTC_WriteCharDescr(uint16_t conn_id, uint16_t handle,
+                              std::vector<uint8_t> value,
+                              tGATT_AUTH_REQ auth_req,
+                              GATT_WRITE_OP_CB callback, void* cb_data) {
+  server.Write(handle, std::move(value), callback, cb_data);
+}
+
+void BTA_GATTC_ConfigureMTU(uint16_t conn_id, uint16_t mtu,
+                            GATT_CONFIGURE_MTU_OP_CB callback, void* cb_data) {
+  callback(conn_id, GATT_SUCCESS, cb_data);
+}
+
+namespace {
+
+struct ReadResult {
+  tGATT_STATUS status;
+  std::vector<uint8_t> value;
+};
+
+std::map<uint16_t, ReadResult> read_results;
+int writes_completed = 0;
+
+void OnRead(uint16_t conn_id, tGATT_STATUS status, uint16_t handle,
+            uint16_t len, uint8_t* value, void* data) {
+  read_results[handle] = {status, std::vector<uint8_t>(value, value + len)};
+}
+
+void OnWrite(uint16_t conn_id, tGATT_STATUS status, uint16_t handle,
+             uint16_t len, const uint8_t* value, void* data) {
+  writes_completed++;
+}
+
+// The characteristics an LE Audio client reads, and the CCCDs it writes, when
+// connecting to a set member: PACS, ASCS, CSIS and VCS
+struct LeAudioPeer {
+  std::map<uint16_t, std::vector<uint8_t>> reads;
+  std::vector<uint16_t> cccds;
+};
+
+LeAudioPeer MakeLeAudioPeer() {
+  LeAudioPeer peer;
+  std::vector<uint8_t> pac(26);
+  for (size_t i = 0; i < pac.size(); i++) pac[i] = i;
+  // PACS: sink and source PAC records, audio locations and contexts
+  peer.reads[0x0012] = pac;
+  peer.reads[0x0015] = {0x01, 0x00, 0x00, 0x00};
+  peer.reads[0x0018] = pac;
+  peer.reads[0x001b] = {0x01, 0x00, 0x00, 0x00};
+  peer.reads[0x001e] = {0x06, 0x00, 0x02, 0x00};
+  peer.reads[0x0021] = {0xff, 0x0f, 0x02, 0x00};
+  // ASCS: two sink ASEs and a source ASE, idle
+  peer.reads[0x0032] = {0x01, 0x00};
+  peer.reads[0x0035] = {0x02, 0x00};
+  peer.reads[0x0038] = {0x03, 0x00};
+  // CSIS: SIRK, set size, lock and rank
+  peer.reads[0x0052] = std::vector<uint8_t>(17, 0x5a);
+  peer.reads[0x0055] = {0x02};
+  peer.reads[0x0058] = {0x01};
+  peer.reads[0x005a] = {0x01};
+  // VCS: volume state and flags
+  peer.reads[0x0072] = {0x80, 0x00, 0x01};
+  peer.reads[0x0075] = {0x01};
+  peer.cccds = {0x0013, 0x0019, 0x001f, 0x0022, 0x0033, 0x0036,
+                0x0039, 0x003c, 0x0053, 0x0059, 0x0073, 0x0076};
+  return peer;
+}
+
+class BtaGattQueueTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    read_results.clear();
+    writes_completed = 0;
+    peer_ = MakeLeAudioPeer();
+  }
+
+  void TearDown() override { BtaGattQueue::Clean(kConnId); }
+
+  void StartServer(uint16_t mtu, bool read_multi_var_supported = true) {
+    server.Reset(mtu, read_multi_var_supported);
+    for (const auto& [handle, value] : peer_.reads) {
+      server.AddValue(handle, value);
+    }
+  }
+
+  // Queues what the client does on connection, and returns the time it takes
+  // for the peer to be ready
+  uint64_t Connect() {
+    for (const auto& [handle, value] : peer_.reads) {
+      BtaGattQueue::ReadCharacteristic(kConnId, handle, OnRead, nullptr);
+    }
+    for (uint16_t cccd : peer_.cccds) {
+      BtaGattQueue::WriteDescriptor(kConnId, cccd, {0x01, 0x00},
+                                    GATT_WRITE, OnWrite, nullptr);
+    }
+    server.Run();
+    return server.elapsed_ms();
+  }
+
+  void ExpectAllRead() {
+    ASSERT_EQ(read_results.size(), peer_.reads.size());
+    for (const auto& [handle, value] : peer_.reads) {
+      ASSERT_EQ(read_results[handle].status, GATT_SUCCESS) << handle;
+      ASSERT_EQ(read_results[handle].value, value) << handle;
+    }
+    ASSERT_EQ(writes_completed, (int)peer_.cccds.size());
+  }
+
+  LeAudioPeer peer_;
+};
+
+TEST_F(BtaGattQueueTest, serial_by_default) {
+  StartServer(100);
+  Connect();
+  ExpectAllRead();
+  ASSERT_EQ(server.read_multi_requests(), 0);
+  ASSERT_EQ(server.requests(),
+            (int)(peer_.reads.size() + peer_.cccds.size()));
+}
+
+TEST_F(BtaGattQueueTest, time_to_ready) {
+  StartServer(100);
+  uint64_t serial_ms = Connect();
+  ExpectAllRead();
+  BtaGattQueue::Clean(kConnId);
+
+  SetUp();
+  StartServer(100);
+  BtaGattQueue::SetReadCoalescing(kConnId, true);
+  uint64_t coalesced_ms = Connect();
+  ExpectAllRead();
+
+  LOG(INFO) << "LE Audio peer ready after " << serial_ms << " ms, "
+            << coalesced_ms << " ms with reads coalesced";
+  ASSERT_GT(server.read_multi_requests(), 0);
+  ASSERT_LT(coalesced_ms * 3, serial_ms * 2);
+}
+
+TEST_F(BtaGattQueueTest, truncated_response_is_read_again) {
+  // 22 octets of response: the PAC records never fit along with others
+  StartServer(23);
+  BtaGattQueue::SetReadCoalescing(kConnId, true);
+  Connect();
+  ExpectAllRead();
+  ASSERT_GT(server.read_multi_requests(), 0);
+}
+
+TEST_F(BtaGattQueueTest, read_multi_var_not_supported) {
+  StartServer(100, false);
+  BtaGattQueue::SetReadCoalescing(kConnId, true);
+  Connect();
+  ExpectAllRead();
+  // Tried once, then the reads are sent one by one
+  ASSERT_EQ(server.read_multi_requests(), 1);
+}
+
+TEST_F(BtaGattQueueTest, failed_read_multi_reports_each_read) {
+  StartServer(100);
+  server.SetUnreadable(0x0055);
+  BtaGattQueue::SetReadCoalescing(kConnId, true);
+  Connect();
+
+  ASSERT_EQ(read_results.size(), peer_.reads.size());
+  for (const auto& [handle, value] : peer_.reads) {
+    if (handle == 0x0055) {
+      ASSERT_EQ(read_results[handle].status, GATT_INSUF_AUTHENTICATION);
+    } else {
+      ASSERT_EQ(read_results[handle].status, GATT_SUCCESS) << handle;
+      ASSERT_EQ(read_results[handle].value, value) << handle;
+    }
+  }
+}
+
+TEST_F(BtaGattQueueTest, writes_are_not_reordered) {
+  StartServer(100);
+  BtaGattQueue::SetReadCoalescing(kConnId, true);
+  BtaGattQueue::ReadCharacteristic(kConnId, 0x0075, OnRead, nullptr);
+  BtaGattQueue::WriteCharacteristic(kConnId, 0x0075, {0x00}, GATT_WRITE,
+                                    OnWrite, nullptr);
+  BtaGattQueue::ReadCharacteristic(kConnId, 0x0075, OnRead, nullptr);
+  server.Run();
+  ASSERT_EQ(server.read_multi_requests(), 0);
+  ASSERT_EQ(read_results[0x0075].value, std::vector<uint8_t>{0x00});
+}
+
+}  // namespace
@@ -0,0 +1,193 @@
+/******************************************************************************
+ *
+ *  Copyright 2022 The Android Open Source Project
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+#include <base/logging.h>
+#include <benchmark/benchmark.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "gatt/database.h"
+#include "gatt/database_builder.h"
+#include "types/bluetooth/uuid.h"
+
+using ::benchmark::State;
+using bluetooth::Uuid;
+
+namespace gatt {
+namespace {
+
+#define NUM_SERVICES 20
+#define NUM_CHARACTERISTICS_PER_SERVICE 10
+
+constexpr uint16_t kCacheVersion = 6;
+
+// Builds a database the size of a feature rich peripheral: 20 services with
+// 10 characteristics each, every characteristic having a CCC descriptor.
+Database BuildSampleDatabase() {
+  DatabaseBuilder builder;
+  uint16_t handle = 0x0001;
+  for (int s = 0; s < NUM_SERVICES; s++) {
+    uint16_t service_handle = handle++;
+    uint16_t end_handle = service_handle + NUM_CHARACTERISTICS_PER_SERVICE * 3;
+    builder.AddService(service_handle, end_handle,
+                       Uuid::From16Bit(0x1800 + s), true);
+    for (int c = 0; c < NUM_CHARACTERISTICS_PER_SERVICE; c++) {
+      builder.AddCharacteristic(handle, handle + 1,
+                                Uuid::From16Bit(0x2A00 + c), 0x1A);
+      builder.AddDescriptor(handle + 2, Uuid::From16Bit(0x2902));
+      handle += 3;
+    }
+  }
+  return builder.Build();
+}
+
+std::vector<uint16_t> ValueHandles(const Database& db) {
+  std::vector<uint16_t> handles;
+  for (const Service& service : db.Services()) {
+    for (const Characteristic& charac : service.characteristics) {
+      handles.push_back(charac.value_handle);
+    }
+  }
+  return handles;
+}
+
+// The lookup the GATT client did before the handle index existed.
+const Characteristic* FindCharacteristicByWalking(const Database& db,
+                                                  uint16_t handle) {
+  for (const Service& service : db.Services()) {
+    if (handle < service.handle || handle > service.end_handle) continue;
+    for (const Characteristic& charac : service.characteristics) {
+      if (handle == charac.value_handle) return &charac;
+    }
+    return nullptr;
+  }
+  return nullptr;
+}
+
+class BM_GattDatabase : public ::benchmark::Fixture {
+ protected:
+  void SetUp(State& st) override {
+    ::benchmark::Fixture::SetUp(st);
+    db_ = BuildSampleDatabase();
+    handles_ = ValueHandles(db_);
+
+    char path[] = "/tmp/gatt_cache_benchmark_XXXXXX";
+    int fd = mkstemp(path);
+    CHECK(fd != -1);
+    path_ = path;
+
+    std::vector<StoredAttribute> attr = db_.Serialize();
+    uint16_t header[2] = {kCacheVersion, static_cast<uint16_t>(attr.size())};
+    CHECK(write(fd, header, sizeof(header)) == sizeof(header));
+    size_t len = attr.size() * sizeof(StoredAttribute);
+    CHECK(write(fd, attr.data(), len) == static_cast<ssize_t>(len));
+    close(fd);
+  }
+
+  void TearDown(State& st) override {
+    unlink(path_.c_str());
+    ::benchmark::Fixture::TearDown(st);
+  }
+
+  Database db_;
+  std::vector<uint16_t> handles_;
+  std::string path_;
+};
+
+// Cold load as it was done before: read the file into a vector, then rebuild
+// the database from it.
+BENCHMARK_F(BM_GattDatabase, cold_load_fread)(State& state) {
+  for (auto _ : state) {
+    FILE* fd = fopen(path_.c_str(), "rb");
+    uint16_t header[2];
+    CHECK(fread(header, sizeof(header), 1, fd) == 1);
+    std::vector<StoredAttribute> attr(header[1]);
+    CHECK(fread(attr.data(), sizeof(StoredAttribute), header[1], fd) ==
+          header[1]);
+    fclose(fd);
+    bool success = false;
+    Database db = Database::Deserialize(attr, &success);
+    benchmark::DoNotOptimize(db);
+  }
+}
+
+// Cold load as done now: map the file and deserialize in place.
+BENCHMARK_F(BM_GattDatabase, cold_load_mmap)(State& state) {
+  for (auto _ : state) {
+    int fd = open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+    struct stat st;
+    fstat(fd, &st);
+    void* map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    const auto* header = static_cast<const uint16_t*>(map);
+    bool success = false;
+    Database db = Database::Deserialize(
+        reinterpret_cast<const StoredAttribute*>(header + 2), header[1],
+        &success);
+    munmap(map, st.st_size);
+    benchmark::DoNotOptimize(db);
+  }
+}
+
+// Warm reconnect: the database is already in the in-memory hash index, so the
+// connection gets a copy of the shared instance.
+BENCHMARK_F(BM_GattDatabase, warm_load_from_index)(State& state) {
+  for (auto _ : state) {
+    Database db = db_;
+    benchmark::DoNotOptimize(db);
+  }
+}
+
+BENCHMARK_F(BM_GattDatabase, find_characteristic_walk)(State& state) {
+  for (auto _ : state) {
+    for (uint16_t handle : handles_) {
+      benchmark::DoNotOptimize(FindCharacteristicByWalking(db_, handle));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * handles_.size());
+}
+
+BENCHMARK_F(BM_GattDatabase, find_characteristic_index)(State& state) {
+  for (auto _ : state) {
+    for (uint16_t handle : handles_) {
+      benchmark::DoNotOptimize(db_.FindCharacteristic(handle));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * handles_.size());
+}
+
+}  // namespace
+}  // namespace gatt
+
+int main(int argc, char** argv) {
+  // Disable LOG() output from libchrome
+  logging::LoggingSettings log_settings;
+  log_settings.logging_dest = logging::LoggingDestination::LOG_NONE;
+  CHECK(logging::InitLogging(log_settings)) << "Failed to set up logging";
+  ::benchmark::Initialize(&argc, argv);
+  if (::benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  ::benchmark::RunSpecifiedBenchmarks();
+}
@@ -285,4 +285,55 @@ TEST(GattCacheTest,
   // LOG(ERROR) << " " << base::HexEncode(&attr, len);
   EXPECT_EQ(memcmp(binary_form, &attr, len), 0);
 }
+
+/* This test makes sure that handle lookups through the database index find
+ * the same attributes as walking the service list, also after the database was
+ * copied or deserialized. */
+TEST(GattDatabaseTest, handle_lookup_test) {
+  DatabaseBuilder builder;
+  builder.AddService(0x0001, 0x000f, SERVICE_1_UUID, true);
+  builder.AddService(0x0010, 0x001f, SERVICE_2_UUID, false);
+  builder.AddCharacteristic(0x0003, 0x0004, SERVICE_1_CHAR_1_UUID, 0x02);
+  builder.AddDescriptor(0x0005, SERVICE_1_CHAR_1_DESC_1_UUID);
+  builder.AddCharacteristic(0x0011, 0x0012, SERVICE_1_CHAR_1_UUID, 0x10);
+  builder.AddDescriptor(0x0013, SERVICE_1_CHAR_1_DESC_1_UUID);
+
+  Database built = builder.Build();
+  Database copied = built;
+  bool success = false;
+  Database deserialized = Database::Deserialize(built.Serialize(), &success);
+  ASSERT_TRUE(success);
+
+  for (const Database* db : {&built, &copied, &deserialized}) {
+    const Service* service = db->FindService(0x0005);
+    ASSERT_NE(service, nullptr);
+    EXPECT_EQ(service->handle, 0x0001);
+    service = db->FindService(0x001f);
+    ASSERT_NE(service, nullptr);
+    EXPECT_EQ(service->handle, 0x0010);
+    EXPECT_EQ(db->FindService(0x0020), nullptr);
+
+    const Characteristic* charac = db->FindCharacteristic(0x0012);
+    ASSERT_NE(charac, nullptr);
+    EXPECT_EQ(charac->declaration_handle, 0x0011);
+    EXPECT_EQ(charac->properties, 0x10);
+    // Descriptor and declaration handles are not characteristic values
+    EXPECT_EQ(db->FindCharacteristic(0x0013), nullptr);
+    EXPECT_EQ(db->FindCharacteristic(0x0011), nullptr);
+
+    const Descriptor* desc = db->FindDescriptor(0x0005);
+    ASSERT_NE(desc, nullptr);
+    EXPECT_EQ(desc->uuid, SERVICE_1_CHAR_1_DESC_1_UUID);
+    EXPECT_EQ(db->FindDescriptor(0x0004), nullptr);
+
+    charac = db->FindOwningCharacteristic(0x0013);
+    ASSERT_NE(charac, nullptr);
+    EXPECT_EQ(charac->value_handle, 0x0012);
+    EXPECT_EQ(db->FindOwningCharacteristic(0x0012), nullptr);
+  }
+
+  copied.Clear();
+  EXPECT_EQ(copied.FindService(0x0001), nullptr);
+  EXPECT_EQ(copied.FindCharacteristic(0x0004), nullptr);
+}
 }  // namespace gatt
@@ -0,0 +1,175 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <base/logging.h>
+#include <benchmark/benchmark.h>
+#include <gmock/gmock.h>
+
+#include <memory>
+#include <vector>
+
+#include "bta/le_audio/devices.h"
+#include "bta/le_audio/le_audio_set_configuration_provider.h"
+#include "bta/le_audio/le_audio_types.h"
+#include "btm_api_mock.h"
+#include "mock_controller.h"
+#include "stack/btm/btm_int_types.h"
+
+tACL_CONN* btm_bda_to_acl(const RawAddress& bda, tBT_TRANSPORT transport) {
+  return nullptr;
+}
+
+using ::benchmark::State;
+using le_audio::AudioSetConfigurationProvider;
+using le_audio::LeAudioDevice;
+using le_audio::LeAudioDeviceGroup;
+using le_audio::types::acs_ac_record;
+using le_audio::types::LeAudioContextType;
+using le_audio::types::LeAudioLtvMap;
+
+namespace {
+
+constexpr int kGroupId = 1;
+constexpr LeAudioContextType kStreamContext = LeAudioContextType::MEDIA;
+
+/* A LC3 record as published by earbuds, for all the frame durations */
+acs_ac_record Lc3PacRecord(uint16_t sampling_frequencies,
+                           uint16_t min_octets_per_frame,
+                           uint16_t max_octets_per_frame) {
+  namespace caps = le_audio::codec_spec_caps;
+
+  uint32_t octets_per_frame_range =
+      min_octets_per_frame | (max_octets_per_frame << 16);
+  return acs_ac_record(
+      {.codec_id = le_audio::set_configurations::LeAudioCodecIdLc3,
+       .codec_spec_caps = LeAudioLtvMap({
+           {caps::kLeAudioCodecLC3TypeSamplingFreq,
+            UINT16_TO_VEC_UINT8(sampling_frequencies)},
+           {caps::kLeAudioCodecLC3TypeFrameDuration,
+            UINT8_TO_VEC_UINT8(caps::kLeAudioCodecLC3FrameDur7500us |
+                               caps::kLeAudioCodecLC3FrameDur10000us)},
+           {caps::kLeAudioCodecLC3TypeAudioChannelCounts,
+            UINT8_TO_VEC_UINT8(
+                caps::kLeAudioCodecLC3ChannelCountSingleChannel)},
+           {caps::kLeAudioCodecLC3TypeOctetPerFrame,
+            UINT32_TO_VEC_UINT8(octets_per_frame_range)},
+           {caps::kLeAudioCodecLC3TypeMaxCodecFramesPerSdu,
+            UINT8_TO_VEC_UINT8(1)},
+       }),
+       .metadata = std::vector<uint8_t>(0)});
+}
+
+std::shared_ptr<LeAudioDevice> AddEarbud(LeAudioDeviceGroup* group,
+                                         uint8_t index, uint32_t location) {
+  namespace caps = le_audio::codec_spec_caps;
+
+  auto device = std::make_shared<LeAudioDevice>(
+      RawAddress({0xC0, 0xDE, 0xC0, 0xDE, 0x00, index}), false);
+  group->AddNode(device);
+
+  device->ases_.emplace_back(0x0000, 0x0000,
+                             le_audio::types::kLeAudioDirectionSink);
+  device->ases_.emplace_back(0x0000, 0x0000,
+                             le_audio::types::kLeAudioDirectionSink);
+  device->ases_.emplace_back(0x0000, 0x0000,
+                             le_audio::types::kLeAudioDirectionSource);
+
+  std::vector<acs_ac_record> snk_recs = {
+      Lc3PacRecord(caps::kLeAudioSamplingFreq16000Hz |
+                       caps::kLeAudioSamplingFreq24000Hz |
+                       caps::kLeAudioSamplingFreq32000Hz,
+                   30, 80),
+      Lc3PacRecord(caps::kLeAudioSamplingFreq48000Hz, 75, 155),
+  };
+  std::vector<acs_ac_record> src_recs = {
+      Lc3PacRecord(caps::kLeAudioSamplingFreq16000Hz |
+                       caps::kLeAudioSamplingFreq32000Hz,
+                   30, 80),
+  };
+  device->snk_pacs_.emplace_back(le_audio::types::hdl_pair(), snk_recs);
+  device->src_pacs_.emplace_back(le_audio::types::hdl_pair(), src_recs);
+  device->snk_audio_locations_ = location;
+  device->src_audio_locations_ = location;
+
+  auto all_contexts =
+      static_cast<uint16_t>(le_audio::types::kLeAudioContextAllTypes);
+  device->SetSupportedContexts(all_contexts, all_contexts);
+  device->SetAvailableContexts(all_contexts, all_contexts);
+  device->conn_id_ = index;
+  device->CapabilitiesUpdated();
+
+  return device;
+}
+
+/*
+ * Picks the configuration for a stereo earbuds pair, as done when the stream
+ * is requested, and configures the ASEs with it. Capabilities are either
+ * left as is between stream requests, or announced as changed before each.
+ */
+void BM_StreamSetup(State& state) {
+  const bool pacs_changed = state.range(0);
+
+  testing::NiceMock<bluetooth::manager::MockBtmInterface> btm_interface;
+  testing::NiceMock<controller::MockControllerInterface> controller_interface;
+  bluetooth::manager::SetMockBtmInterface(&btm_interface);
+  controller::SetMockControllerInterface(&controller_interface);
+  AudioSetConfigurationProvider::Initialize();
+
+  auto group = std::make_unique<LeAudioDeviceGroup>(kGroupId);
+  std::vector<std::shared_ptr<LeAudioDevice>> earbuds = {
+      AddEarbud(group.get(), 1,
+                le_audio::codec_spec_conf::kLeAudioLocationFrontLeft),
+      AddEarbud(group.get(), 2,
+                le_audio::codec_spec_conf::kLeAudioLocationFrontRight),
+  };
+
+  size_t configured = 0;
+  for (auto _ : state) {
+    if (pacs_changed) {
+      for (auto& earbud : earbuds) earbud->CapabilitiesUpdated();
+    }
+
+    group->UpdateActiveContextsMap(
+        static_cast<uint16_t>(le_audio::types::kLeAudioContextAllTypes));
+    if (group->Configure(kStreamContext)) configured++;
+    group->Deactivate();
+  }
+
+  state.counters["configured"] = configured;
+
+  group.reset();
+  earbuds.clear();
+  AudioSetConfigurationProvider::Cleanup();
+  controller::SetMockControllerInterface(nullptr);
+  bluetooth::manager::SetMockBtmInterface(nullptr);
+}
+
+BENCHMARK(BM_StreamSetup)->ArgName("pacs_changed")->Arg(0)->Arg(1);
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  // Disable LOG() output from libchrome
+  logging::LoggingSettings log_settings;
+  log_settings.logging_dest = logging::LoggingDestination::LOG_NONE;
+  CHECK(logging::InitLogging(log_settings)) << "Failed to set up logging";
+
+  ::benchmark::Initialize(&argc, argv);
+  if (::benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  ::benchmark::RunSpecifiedBenchmarks();
+}
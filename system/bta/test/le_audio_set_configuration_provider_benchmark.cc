@@ -0,0 +1,76 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <base/logging.h>
+#include <benchmark/benchmark.h>
+
+#include <cstring>
+
+#include "bta/le_audio/le_audio_set_configuration_provider.h"
+
+using ::benchmark::State;
+using le_audio::AudioSetConfigurationProvider;
+using le_audio::types::LeAudioContextType;
+
+namespace {
+bool load_json = false;
+}  // namespace
+
+// Stands in for the property a developer sets to load the JSON sources
+bool osi_property_get_bool(const char* key, bool default_value) {
+  if (strcmp(key, "persist.bluetooth.leaudio.json_set_configurations") == 0)
+    return load_json;
+  return default_value;
+}
+
+namespace {
+
+/*
+ * Loads the set configurations and scenarios as the stack does when LE Audio
+ * gets enabled, either from the binaries compiled at build time or by parsing
+ * the JSON sources. Runs from the directory holding the benchmark data files.
+ */
+void BM_LoadSetConfigurations(State& state) {
+  load_json = state.range(0);
+
+  size_t num_media_configs = 0;
+  for (auto _ : state) {
+    AudioSetConfigurationProvider::Initialize();
+    auto confs = AudioSetConfigurationProvider::Get()->GetConfigurations(
+        LeAudioContextType::MEDIA);
+    num_media_configs = confs ? confs->size() : 0;
+    AudioSetConfigurationProvider::Cleanup();
+  }
+
+  state.counters["media_configs"] = num_media_configs;
+}
+
+BENCHMARK(BM_LoadSetConfigurations)->ArgName("json")->Arg(0)->Arg(1);
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  // Disable LOG() output from libchrome
+  logging::LoggingSettings log_settings;
+  log_settings.logging_dest = logging::LoggingDestination::LOG_NONE;
+  CHECK(logging::InitLogging(log_settings)) << "Failed to set up logging";
+
+  ::benchmark::Initialize(&argc, argv);
+  if (::benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  ::benchmark::RunSpecifiedBenchmarks();
+}
@@ -209,6 +209,22 @@ class MediaInterfaceWrapper : public MediaInterface {
                                bound_cb));
   }
 
+  void GetFolderItemsRange(uint16_t player_id, std::string media_id,
+                           uint32_t start_item, uint32_t end_item,
+                           FolderItemsRangeCallback folder_cb) override {
+    auto cb_lambda = [](FolderItemsRangeCallback cb, uint32_t total_items,
+                        uint32_t first_item, std::vector<ListItem> item_list) {
+      do_in_main_thread(FROM_HERE, base::Bind(cb, total_items, first_item,
+                                              std::move(item_list)));
+    };
+
+    auto bound_cb = base::Bind(cb_lambda, folder_cb);
+
+    do_in_avrcp_jni(base::Bind(&MediaInterface::GetFolderItemsRange,
+                               base::Unretained(wrapped_), player_id, media_id,
+                               start_item, end_item, bound_cb));
+  }
+
   void SetBrowsedPlayer(uint16_t player_id,
                         SetBrowsedPlayerCallback browse_cb) override {
     auto cb_lambda = [](SetBrowsedPlayerCallback cb, bool success,
@@ -23,17 +23,21 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <linux/uhid.h>
-#include <poll.h>
 #include <pthread.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
+#include <sys/epoll.h>
 #include <unistd.h>
 
+#include <atomic>
+#include <mutex>
+
 #include "bta_api.h"
 #include "bta_hh_api.h"
 #include "btif_hh.h"
 #include "btif_util.h"
+#include "common/time_util.h"
 #include "osi/include/allocator.h"
 #include "osi/include/compat.h"
 #include "osi/include/osi.h"
@@ -62,18 +66,27 @@ void uhid_set_non_blocking(int fd) {
                      strerror(errno));
 }
 
+/* All uhid devices are polled by one thread, started when the first device
+ * is opened and stopped once none is left */
+static int uhid_epoll_fd = -1;
+static pthread_t uhid_poll_thread_id = -1;
+static std::atomic<bool> uhid_keep_polling{false};
+/* Held by the polling thread while it services a device */
+static std::mutex uhid_poll_mutex;
+
 /*Internal function to perform UHID write and error checking*/
-static int uhid_write(int fd, const struct uhid_event* ev) {
+static int uhid_write(int fd, const struct uhid_event* ev,
+                      size_t len = sizeof(struct uhid_event)) {
   ssize_t ret;
-  OSI_NO_INTR(ret = write(fd, ev, sizeof(*ev)));
+  OSI_NO_INTR(ret = write(fd, ev, len));
 
   if (ret < 0) {
     int rtn = -errno;
     APPL_TRACE_ERROR("%s: Cannot write to uhid:%s", __func__, strerror(errno));
     return rtn;
-  } else if (ret != (ssize_t)sizeof(*ev)) {
+  } else if (ret != (ssize_t)len) {
     APPL_TRACE_ERROR("%s: Wrong size written to uhid: %zd != %zu", __func__,
-                     ret, sizeof(*ev));
+                     ret, len);
     return -EFAULT;
   }
 
@@ -237,14 +250,14 @@ static inline pthread_t create_thread(void* (*start_routine)(void*),
  *
  * Function btif_hh_poll_event_thread
  *
- * Description the polling thread which polls for event from UHID driver
+ * Description the polling thread which polls for events from the UHID driver
+ *             for all the connected devices
  *
  * Returns void
  *
  ******************************************************************************/
-static void* btif_hh_poll_event_thread(void* arg) {
-  btif_hh_device_t* p_dev = (btif_hh_device_t*)arg;
-  struct pollfd pfds[1];
+static void* btif_hh_poll_event_thread(UNUSED_ATTR void* arg) {
+  struct epoll_event events[BTIF_HH_MAX_HID];
 
   // This thread is created by bt_main_thread with RT priority. Lower the thread
   // priority here since the tasks in this thread is not timing critical.
@@ -252,50 +265,109 @@ static void* btif_hh_poll_event_thread(void* arg) {
   sched_params.sched_priority = THREAD_NORMAL_PRIORITY;
   if (sched_setscheduler(gettid(), SCHED_OTHER, &sched_params)) {
     APPL_TRACE_ERROR("%s: Failed to set thread priority to normal", __func__);
-    p_dev->hh_poll_thread_id = -1;
     return 0;
   }
-  p_dev->pid = gettid();
   pthread_setname_np(pthread_self(), BT_HH_THREAD);
-  LOG_DEBUG("Host hid polling thread created name:%s pid:%d fd:%d",
-            BT_HH_THREAD, p_dev->pid, p_dev->fd);
+  LOG_DEBUG("Host hid polling thread created name:%s pid:%d", BT_HH_THREAD,
+            gettid());
 
-  pfds[0].fd = p_dev->fd;
-  pfds[0].events = POLLIN;
-
-  // Set the uhid fd as non-blocking to ensure we never block the BTU thread
-  uhid_set_non_blocking(p_dev->fd);
-
-  while (p_dev->hh_keep_polling) {
+  while (uhid_keep_polling) {
     int ret;
-    OSI_NO_INTR(ret = poll(pfds, 1, 50));
+    OSI_NO_INTR(ret = epoll_wait(uhid_epoll_fd, events, BTIF_HH_MAX_HID, 50));
     if (ret < 0) {
       APPL_TRACE_ERROR("%s: Cannot poll for fds: %s\n", __func__,
                        strerror(errno));
       break;
     }
-    if (pfds[0].revents & POLLIN) {
-      APPL_TRACE_DEBUG("%s: POLLIN", __func__);
-      ret = uhid_read_event(p_dev);
-      if (ret != 0) break;
+    for (int i = 0; i < ret; i++) {
+      std::lock_guard<std::mutex> lock(uhid_poll_mutex);
+      btif_hh_device_t* p_dev = (btif_hh_device_t*)events[i].data.ptr;
+      // The device may have been closed since epoll_wait() returned
+      if (!p_dev->hh_keep_polling) continue;
+      APPL_TRACE_DEBUG("%s: events 0x%x fd:%d", __func__, events[i].events,
+                       p_dev->fd);
+      if (uhid_read_event(p_dev) != 0) {
+        epoll_ctl(uhid_epoll_fd, EPOLL_CTL_DEL, p_dev->fd, nullptr);
+        p_dev->hh_keep_polling = 0;
+        p_dev->hh_poll_thread_id = -1;
+      }
     }
   }
 
-  p_dev->hh_poll_thread_id = -1;
-  p_dev->pid = -1;
   return 0;
 }
 
+static void btif_hh_start_polling(btif_hh_device_t* p_dev) {
+  // Set the uhid fd as non-blocking to ensure we never block the BTU thread
+  uhid_set_non_blocking(p_dev->fd);
+
+  if (uhid_poll_thread_id == (pthread_t)-1) {
+    uhid_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (uhid_epoll_fd < 0) {
+      APPL_TRACE_ERROR("%s: Cannot create epoll fd: %s", __func__,
+                       strerror(errno));
+      return;
+    }
+    uhid_keep_polling = true;
+    uhid_poll_thread_id = create_thread(btif_hh_poll_event_thread, nullptr);
+    if (uhid_poll_thread_id == (pthread_t)-1) {
+      close(uhid_epoll_fd);
+      uhid_epoll_fd = -1;
+      return;
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(uhid_poll_mutex);
+  struct epoll_event event;
+  event.events = EPOLLIN;
+  event.data.ptr = p_dev;
+  if (epoll_ctl(uhid_epoll_fd, EPOLL_CTL_ADD, p_dev->fd, &event) < 0 &&
+      (errno != EEXIST ||
+       epoll_ctl(uhid_epoll_fd, EPOLL_CTL_MOD, p_dev->fd, &event) < 0)) {
+    APPL_TRACE_ERROR("%s: Cannot poll uhid fd %d: %s", __func__, p_dev->fd,
+                     strerror(errno));
+    return;
+  }
+  p_dev->hh_keep_polling = 1;
+  p_dev->hh_poll_thread_id = uhid_poll_thread_id;
+}
+
+/* Stops the polling thread once no device is polled anymore */
+static void btif_hh_stop_polling_if_idle() {
+  if (uhid_poll_thread_id == (pthread_t)-1) return;
+  {
+    std::lock_guard<std::mutex> lock(uhid_poll_mutex);
+    for (int i = 0; i < BTIF_HH_MAX_HID; i++) {
+      if (btif_hh_cb.devices[i].hh_keep_polling) return;
+    }
+  }
+
+  uhid_keep_polling = false;
+  pthread_join(uhid_poll_thread_id, NULL);
+  uhid_poll_thread_id = -1;
+  close(uhid_epoll_fd);
+  uhid_epoll_fd = -1;
+}
+
 static inline void btif_hh_close_poll_thread(btif_hh_device_t* p_dev) {
   APPL_TRACE_DEBUG("%s", __func__);
-  p_dev->hh_keep_polling = 0;
-  if (p_dev->hh_poll_thread_id > 0)
-    pthread_join(p_dev->hh_poll_thread_id, NULL);
-
-  return;
+  {
+    std::lock_guard<std::mutex> lock(uhid_poll_mutex);
+    if (p_dev->hh_keep_polling && p_dev->fd >= 0) {
+      epoll_ctl(uhid_epoll_fd, EPOLL_CTL_DEL, p_dev->fd, nullptr);
+    }
+    p_dev->hh_keep_polling = 0;
+    p_dev->hh_poll_thread_id = -1;
+  }
+  btif_hh_stop_polling_if_idle();
 }
 
 void bta_hh_co_destroy(int fd) {
+  for (int i = 0; i < BTIF_HH_MAX_HID; i++) {
+    if (btif_hh_cb.devices[i].fd == fd)
+      btif_hh_close_poll_thread(&btif_hh_cb.devices[i]);
+  }
+
   struct uhid_event ev;
   memset(&ev, 0, sizeof(ev));
   ev.type = UHID_DESTROY;
@@ -307,17 +379,19 @@ void bta_hh_co_destroy(int fd) {
 int bta_hh_co_write(int fd, uint8_t* rpt, uint16_t len) {
   APPL_TRACE_VERBOSE("%s: UHID write %d", __func__, len);
 
+  // Only the event type, the report size and the report are written, not the
+  // whole event, so there is no need to clear it
   struct uhid_event ev;
-  memset(&ev, 0, sizeof(ev));
-  ev.type = UHID_INPUT;
-  ev.u.input.size = len;
-  if (len > sizeof(ev.u.input.data)) {
+  ev.type = UHID_INPUT2;
+  ev.u.input2.size = len;
+  if (len > sizeof(ev.u.input2.data)) {
     APPL_TRACE_WARNING("%s: Report size greater than allowed size", __func__);
     return -1;
   }
-  memcpy(ev.u.input.data, rpt, len);
+  memcpy(ev.u.input2.data, rpt, len);
 
-  return uhid_write(fd, &ev);
+  return uhid_write(fd, &ev,
+                    sizeof(ev.type) + sizeof(ev.u.input2.size) + len);
 }
 
 /*******************************************************************************
@@ -361,9 +435,7 @@ void bta_hh_co_open(uint8_t dev_handle, uint8_t sub_class,
           APPL_TRACE_DEBUG("%s: uhid fd = %d", __func__, p_dev->fd);
       }
 
-      p_dev->hh_keep_polling = 1;
-      p_dev->hh_poll_thread_id =
-          create_thread(btif_hh_poll_event_thread, p_dev);
+      btif_hh_start_polling(p_dev);
       break;
     }
     p_dev = NULL;
@@ -389,9 +461,7 @@ void bta_hh_co_open(uint8_t dev_handle, uint8_t sub_class,
           return;
         } else {
           APPL_TRACE_DEBUG("%s: uhid fd = %d", __func__, p_dev->fd);
-          p_dev->hh_keep_polling = 1;
-          p_dev->hh_poll_thread_id =
-              create_thread(btif_hh_poll_event_thread, p_dev);
+          btif_hh_start_polling(p_dev);
         }
 
         break;
@@ -405,6 +475,7 @@ void bta_hh_co_open(uint8_t dev_handle, uint8_t sub_class,
   }
 
   p_dev->dev_status = BTHH_CONN_STATE_CONNECTED;
+  p_dev->input_stats = {};
   p_dev->get_rpt_id_queue = fixed_queue_new(SIZE_MAX);
   CHECK(p_dev->get_rpt_id_queue);
 #ifdef OS_ANDROID  // Host kernel does not support UHID_SET_REPORT
@@ -495,6 +566,8 @@ void bta_hh_co_data(uint8_t dev_handle, uint8_t* p_rpt, uint16_t len,
     return;
   }
 
+  uint64_t received_us = bluetooth::common::time_get_os_boottime_us();
+
   // Wait a maximum of MAX_POLLING_ATTEMPTS x POLLING_SLEEP_DURATION in case
   // device creation is pending.
   if (p_dev->fd >= 0) {
@@ -507,10 +580,20 @@ void bta_hh_co_data(uint8_t dev_handle, uint8_t* p_rpt, uint16_t len,
 
   // Send the HID data to the kernel.
   if ((p_dev->fd >= 0) && p_dev->ready_for_data) {
-    bta_hh_co_write(p_dev->fd, p_rpt, len);
+    if (bta_hh_co_write(p_dev->fd, p_rpt, len) == 0) {
+      uint64_t latency_us =
+          bluetooth::common::time_get_os_boottime_us() - received_us;
+      p_dev->input_stats.reports++;
+      p_dev->input_stats.total_latency_us += latency_us;
+      if (latency_us > p_dev->input_stats.max_latency_us)
+        p_dev->input_stats.max_latency_us = latency_us;
+    } else {
+      p_dev->input_stats.drops++;
+    }
   } else {
     APPL_TRACE_WARNING("%s: Error: fd = %d, ready %d, len = %d", __func__,
                        p_dev->fd, p_dev->ready_for_data, len);
+    p_dev->input_stats.drops++;
   }
 }
 
@@ -188,7 +188,7 @@ void bta_pan_co_rx_flow(UNUSED_ATTR uint16_t handle, UNUSED_ATTR uint8_t app_id,
   BTIF_TRACE_API("bta_pan_co_rx_flow, enabled:%d, not used", enable);
   btpan_conn_t* conn = btpan_find_conn_handle(handle);
   if (!conn || conn->state != PAN_STATE_OPEN) return;
-  btpan_set_flow_control(enable);
+  btpan_set_flow_control(conn, enable);
 }
 
 /*******************************************************************************
@@ -0,0 +1,76 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "stack/include/bt_octets.h"
+#include "types/bluetooth/uuid.h"
+#include "types/raw_address.h"
+
+/**
+ * Everything the config holds about one bonded device.
+ *
+ * Built from a copy of the whole config section, so that adapter enable and
+ * the profile loaders read every device with a single config lookup instead of
+ * one locked lookup, and possibly one keystore request, per property. The
+ * fields every loader needs are parsed once when the record is built, the
+ * profile specific ones are parsed from the copy when they are asked for, with
+ * the same rules as btif_config_get_*().
+ */
+class BtifBondedDeviceRecord {
+ public:
+  BtifBondedDeviceRecord(
+      const RawAddress& address,
+      std::unordered_map<std::string, std::string> properties);
+
+  const RawAddress& address() const { return address_; }
+
+  // BR/EDR link key, set only when its type is stored too
+  const std::optional<LinkKey>& link_key() const { return link_key_; }
+  int link_key_type() const { return link_key_type_; }
+  int pin_length() const { return pin_length_; }
+
+  std::optional<uint32_t> dev_class() const { return dev_class_; }
+  std::optional<int> dev_type() const { return dev_type_; }
+  std::optional<int> addr_type() const { return addr_type_; }
+
+  // Services from the "Service" property, in stored order
+  const std::vector<bluetooth::Uuid>& uuids() const { return uuids_; }
+  bool HasUuid(const bluetooth::Uuid& uuid) const;
+
+  bool HasProperty(const std::string& key) const;
+  const std::string* GetStr(const std::string& key) const;
+  std::optional<int> GetInt(const std::string& key) const;
+  std::optional<uint64_t> GetUint64(const std::string& key) const;
+  std::optional<std::vector<uint8_t>> GetBin(const std::string& key) const;
+
+ private:
+  RawAddress address_;
+  std::unordered_map<std::string, std::string> properties_;
+  std::optional<LinkKey> link_key_;
+  int link_key_type_ = 0;
+  int pin_length_ = 0;
+  std::optional<uint32_t> dev_class_;
+  std::optional<int> dev_type_;
+  std::optional<int> addr_type_;
+  std::vector<bluetooth::Uuid> uuids_;
+};
@@ -25,6 +25,7 @@
 #include <string>
 #include <vector>
 
+#include "btif/include/btif_bonded_device_record.h"
 #include "osi/include/config.h"
 #include "types/ble_address_with_type.h"
 #include "types/raw_address.h"
@@ -66,6 +67,8 @@ size_t btif_config_get_bin_length(const std::string& section,
                                   const std::string& key);
 
 std::vector<RawAddress> btif_config_get_paired_devices();
+// Paired devices with all of their stored properties, read in one pass
+std::vector<BtifBondedDeviceRecord> btif_config_get_paired_device_records();
 
 void btif_config_save(void);
 void btif_config_flush(void);
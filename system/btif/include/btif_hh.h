@@ -90,8 +90,13 @@ typedef struct {
   int fd;
   bool ready_for_data;
   pthread_t hh_poll_thread_id;
-  pid_t pid{-1};
   uint8_t hh_keep_polling;
+  struct {
+    uint64_t reports;           // Input reports written to uhid
+    uint64_t drops;             // Input reports that could not be written
+    uint64_t total_latency_us;  // From reception until written to uhid
+    uint64_t max_latency_us;
+  } input_stats;
   alarm_t* vup_timer;
   fixed_queue_t* get_rpt_id_queue;
 #ifdef OS_ANDROID
@@ -33,4 +33,7 @@ btpan_interface_t* btif_pan_interface();
 void btif_pan_init();
 void btif_pan_cleanup();
 
+/* Dumps the frame and octet counters of the TAP interface to |fd| */
+void btif_debug_pan_dump(int fd);
+
 #endif
@@ -63,6 +63,7 @@ typedef struct {
   tBTA_PAN_ROLE local_role;
   tBTA_PAN_ROLE remote_role;
   RawAddress eth_addr;
+  int flow;  // 1: BNEP accepts outbound data on this connection
 } btpan_conn_t;
 
 typedef struct {
@@ -71,10 +72,15 @@ typedef struct {
   int tap_fd;
   int enabled;
   int open_count;
-  int flow;  // 1: outbound data flow on; 0: outbound data flow off
+  int flow;  // 1: outbound data flow on, on every open connection
   btpan_conn_t conns[MAX_PAN_CONNS];
-  int congest_packet_size;
-  unsigned char congest_packet[1600];  // max ethernet packet size
+  uint64_t tap_open_time_ms;
+  uint64_t read_batches;
+  struct {
+    uint64_t frames;
+    uint64_t octets;
+    uint64_t drops;
+  } uplink, downlink;  // uplink: TAP driver to BNEP; downlink: BNEP to TAP
 } btpan_cb_t;
 
 /*******************************************************************************
@@ -86,7 +92,7 @@ btpan_conn_t* btpan_new_conn(int handle, const RawAddress& addr,
                              tBTA_PAN_ROLE local_role, tBTA_PAN_ROLE peer_role);
 btpan_conn_t* btpan_find_conn_addr(const RawAddress& addr);
 btpan_conn_t* btpan_find_conn_handle(uint16_t handle);
-void btpan_set_flow_control(bool enable);
+void btpan_set_flow_control(btpan_conn_t* conn, bool enable);
 int btpan_get_connected_count(void);
 int btpan_tap_open(void);
 void create_tap_read_thread(int tap_fd);
@@ -51,6 +51,7 @@
 #include "audio_hal_interface/a2dp_encoding.h"
 #include "bt_utils.h"
 #include "bta/include/bta_csis_api.h"
+#include "bta/include/bta_gatt_queue.h"
 #include "bta/include/bta_has_api.h"
 #include "bta/include/bta_hearing_aid_api.h"
 #include "bta/include/bta_hf_client_api.h"
@@ -69,6 +70,7 @@
 #include "btif_hf.h"
 #include "btif_keystore.h"
 #include "btif_metrics_logging.h"
+#include "btif_pan.h"
 #include "btif_storage.h"
 #include "common/address_obfuscator.h"
 #include "common/metric_id_allocator.h"
@@ -85,10 +87,12 @@
 #include "osi/include/log.h"
 #include "osi/include/osi.h"
 #include "osi/include/wakelock.h"
+#include "stack/eatt/eatt.h"
 #include "stack/gatt/connection_manager.h"
 #include "stack/include/avdt_api.h"
 #include "stack/include/btm_api.h"
 #include "stack/include/btu.h"
+#include "stack/include/gatt_api.h"
 #include "types/raw_address.h"
 
 using bluetooth::csis::CsisClientInterface;
@@ -442,6 +446,7 @@ static void dump(int fd, const char** arguments) {
   bluetooth::avrcp::AvrcpService::DebugDump(fd);
   btif_debug_config_dump(fd);
   BTA_HfClientDumpStatistics(fd);
+  btif_debug_pan_dump(fd);
   wakelock_debug_dump(fd);
   osi_allocator_debug_dump(fd);
   alarm_debug_dump(fd);
@@ -456,6 +461,9 @@ static void dump(int fd, const char** arguments) {
   VolumeControl::DebugDump(fd);
 #endif
   connection_manager::dump(fd);
+  GATTS_DumpNotificationStats(fd);
+  bluetooth::eatt::EattExtension::GetInstance()->Dump(fd);
+  BtaGattQueue::DebugDump(fd);
   bluetooth::bqr::DebugDump(fd);
   bluetooth::shim::Dump(fd, arguments);
 }
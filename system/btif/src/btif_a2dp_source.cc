@@ -41,9 +41,9 @@
 #include "btif_av_co.h"
 #include "btif_metrics_logging.h"
 #include "btif_util.h"
+#include "common/audio_tick_scheduler.h"
 #include "common/message_loop_thread.h"
 #include "common/metrics.h"
-#include "common/repeating_timer.h"
 #include "common/time_util.h"
 #include "osi/include/allocator.h"
 #include "osi/include/fixed_queue.h"
@@ -58,7 +58,8 @@
 
 using bluetooth::common::A2dpSessionMetrics;
 using bluetooth::common::BluetoothMetricsLogger;
-using bluetooth::common::RepeatingTimer;
+using bluetooth::common::AudioTick;
+using bluetooth::common::AudioTickScheduler;
 
 extern std::unique_ptr<tUIPC_STATE> a2dp_uipc;
 
@@ -219,7 +220,7 @@ class BtifA2dpSource {
 
   fixed_queue_t* tx_audio_queue;
   bool tx_flush; /* Discards any outgoing data when true */
-  RepeatingTimer media_alarm;
+  AudioTickScheduler media_alarm;
   const tA2DP_ENCODER_INTERFACE* encoder_interface;
   uint64_t encoder_interval_ms; /* Local copy of the encoder interval */
   BtifMediaStats stats;
@@ -262,7 +263,7 @@ static void btif_a2dp_source_encoder_user_config_update_event(
 static void btif_a2dp_source_audio_feeding_update_event(
     const btav_a2dp_codec_config_t& codec_audio_config);
 static bool btif_a2dp_source_audio_tx_flush_req(void);
-static void btif_a2dp_source_audio_handle_timer(void);
+static void btif_a2dp_source_audio_handle_timer(const AudioTick& tick);
 static uint32_t btif_a2dp_source_read_callback(uint8_t* p_buf, uint32_t len);
 static bool btif_a2dp_source_enqueue_callback(BT_HDR* p_buf, size_t frames_n,
                                               uint32_t bytes_read);
@@ -825,7 +826,7 @@ static void btif_a2dp_source_audio_tx_start_event(void) {
   btif_a2dp_source_cb.tx_flush = false;
 
   wakelock_acquire();
-  btif_a2dp_source_cb.media_alarm.SchedulePeriodic(
+  btif_a2dp_source_cb.media_alarm.Start(
       btif_a2dp_source_thread.GetWeakPtr(), FROM_HERE,
       base::Bind(&btif_a2dp_source_audio_handle_timer),
 #if BASE_VER < 931007
@@ -833,7 +834,8 @@ static void btif_a2dp_source_audio_tx_start_event(void) {
 #else
       base::Milliseconds(
 #endif
-          btif_a2dp_source_cb.encoder_interface->get_encoder_interval_ms()));
+          btif_a2dp_source_cb.encoder_interface->get_encoder_interval_ms()),
+      {.timer_slack_ns = AudioTickScheduler::kAudioTimerSlackNs});
 
   btif_a2dp_source_cb.stats.Reset();
   // Assign session_start_us to 1 when
@@ -910,7 +912,7 @@ static void btif_a2dp_source_audio_tx_stop_event(void) {
     btif_a2dp_source_cb.encoder_interface->feeding_reset();
 }
 
-static void btif_a2dp_source_audio_handle_timer(void) {
+static void btif_a2dp_source_audio_handle_timer(const AudioTick& tick) {
   if (btif_av_is_a2dp_offload_running()) return;
 
   uint64_t timestamp_us = bluetooth::common::time_get_os_boottime_us();
@@ -931,7 +933,9 @@ static void btif_a2dp_source_audio_handle_timer(void) {
     btif_a2dp_source_cb.encoder_interface->set_transmit_queue_length(
         transmit_queue_length);
   }
-  btif_a2dp_source_cb.encoder_interface->send_frames(timestamp_us);
+  // Encoders feed the audio elapsed since their previous call: going by the
+  // deadlines, each tick sends one interval of audio however late it runs
+  btif_a2dp_source_cb.encoder_interface->send_frames(tick.deadline_us);
   bta_av_ci_src_data_ready(BTA_AV_CHNL_AUDIO);
   update_scheduling_stats(&btif_a2dp_source_cb.stats.tx_queue_enqueue_stats,
                           timestamp_us,
@@ -1320,6 +1324,9 @@ void btif_a2dp_source_debug_dump(int fd) {
       (unsigned long long)dequeue_stats->max_premature_scheduling_delta_us /
           1000,
       (unsigned long long)ave_time_us / 1000);
+
+  dprintf(fd, "  Media ticks:\n");
+  btif_a2dp_source_cb.media_alarm.DebugDump(fd);
 }
 
 static void btif_a2dp_source_update_metrics(void) {
@@ -0,0 +1,104 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "btif/include/btif_bonded_device_record.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include "gd/common/numbers.h"
+#include "gd/common/strings.h"
+
+using bluetooth::Uuid;
+
+BtifBondedDeviceRecord::BtifBondedDeviceRecord(
+    const RawAddress& address,
+    std::unordered_map<std::string, std::string> properties)
+    : address_(address), properties_(std::move(properties)) {
+  auto link_key = GetBin("LinkKey");
+  auto link_key_type = GetInt("LinkKeyType");
+  if (link_key && link_key_type) {
+    LinkKey key = {};
+    std::memcpy(key.data(), link_key->data(),
+                std::min(link_key->size(), key.size()));
+    link_key_ = key;
+    link_key_type_ = *link_key_type;
+  }
+  pin_length_ = GetInt("PinLength").value_or(0);
+
+  auto dev_class = GetInt("DevClass");
+  if (dev_class) dev_class_ = static_cast<uint32_t>(*dev_class);
+  dev_type_ = GetInt("DevType");
+  addr_type_ = GetInt("AddrType");
+
+  // Same format and rules as btif_split_uuids_string(): 128-bit UUIDs
+  // separated by spaces, stopping at the first one that doesn't parse
+  const std::string* services = GetStr("Service");
+  if (services != nullptr) {
+    size_t pos = 0;
+    while (pos < services->size()) {
+      bool is_valid;
+      Uuid uuid = Uuid::FromString(
+          services->substr(pos, Uuid::kString128BitLen), &is_valid);
+      if (!is_valid) break;
+      uuids_.push_back(uuid);
+      pos = services->find(' ', pos);
+      if (pos == std::string::npos) break;
+      pos++;
+    }
+  }
+}
+
+bool BtifBondedDeviceRecord::HasUuid(const Uuid& uuid) const {
+  return std::find(uuids_.begin(), uuids_.end(), uuid) != uuids_.end();
+}
+
+bool BtifBondedDeviceRecord::HasProperty(const std::string& key) const {
+  return properties_.find(key) != properties_.end();
+}
+
+const std::string* BtifBondedDeviceRecord::GetStr(
+    const std::string& key) const {
+  auto it = properties_.find(key);
+  return it == properties_.end() ? nullptr : &it->second;
+}
+
+std::optional<int> BtifBondedDeviceRecord::GetInt(
+    const std::string& key) const {
+  const std::string* value = GetStr(key);
+  if (value == nullptr) return std::nullopt;
+  auto large_value = bluetooth::common::Int64FromString(*value);
+  if (!large_value ||
+      !bluetooth::common::IsNumberInNumericLimits<int>(*large_value)) {
+    return std::nullopt;
+  }
+  return static_cast<int>(*large_value);
+}
+
+std::optional<uint64_t> BtifBondedDeviceRecord::GetUint64(
+    const std::string& key) const {
+  const std::string* value = GetStr(key);
+  if (value == nullptr) return std::nullopt;
+  return bluetooth::common::Uint64FromString(*value);
+}
+
+std::optional<std::vector<uint8_t>> BtifBondedDeviceRecord::GetBin(
+    const std::string& key) const {
+  const std::string* value = GetStr(key);
+  if (value == nullptr) return std::nullopt;
+  return bluetooth::common::FromHexString(*value);
+}
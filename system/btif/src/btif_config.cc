@@ -310,6 +310,22 @@ std::vector<RawAddress> btif_config_get_paired_devices() {
   return result;
 }
 
+std::vector<BtifBondedDeviceRecord> btif_config_get_paired_device_records() {
+  CHECK(bluetooth::shim::is_gd_stack_started_up());
+  auto devices =
+      bluetooth::shim::BtifConfigInterface::GetPersistentDevicesWithProperties();
+
+  std::vector<BtifBondedDeviceRecord> result;
+  result.reserve(devices.size());
+  for (auto& device : devices) {
+    RawAddress addr = {};
+    if (RawAddress::FromString(device.first, addr)) {
+      result.emplace_back(addr, std::move(device.second));
+    }
+  }
+  return result;
+}
+
 bool btif_config_remove(const std::string& section, const std::string& key) {
   CHECK(bluetooth::shim::is_gd_stack_started_up());
   return bluetooth::shim::BtifConfigInterface::RemoveProperty(section, key);
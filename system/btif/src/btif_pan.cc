@@ -31,10 +31,10 @@
 #include <base/bind.h>
 #include <base/location.h>
 #include <fcntl.h>
+#include <inttypes.h>
 #include <linux/if_ether.h>
 #include <linux/if_tun.h>
 #include <net/if.h>
-#include <poll.h>
 #include <sys/ioctl.h>
 #include <unistd.h>
 
@@ -43,6 +43,7 @@
 #include "btif/include/btif_common.h"
 #include "btif/include/btif_pan_internal.h"
 #include "btif/include/btif_sock_thread.h"
+#include "common/time_util.h"
 #include "device/include/controller.h"
 #include "include/hardware/bt_pan.h"
 #include "osi/include/allocator.h"
@@ -66,8 +67,6 @@
                        __func__, #s, __LINE__)                           \
   } while (0)
 
-#define MIN(x, y) (((x) < (y)) ? (x) : (y))
-
 btpan_cb_t btpan_cb;
 
 static bool jni_initialized;
@@ -338,17 +337,35 @@ static int tap_if_down(const char* devname) {
   return 0;
 }
 
-void btpan_set_flow_control(bool enable) {
+// A frame read from the TAP driver may be sent over any open connection, and
+// BNEP drops it when that connection's transmit queue is full. So the driver
+// is only read while every open connection accepts outbound data.
+static void btpan_update_flow() {
   if (btpan_cb.tap_fd == -1) return;
 
-  btpan_cb.flow = enable;
-  if (enable) {
+  int flow = 1;
+  for (int i = 0; i < MAX_PAN_CONNS; i++) {
+    const btpan_conn_t& conn = btpan_cb.conns[i];
+    if (conn.handle != -1 && conn.state == PAN_STATE_OPEN && !conn.flow) {
+      flow = 0;
+      break;
+    }
+  }
+  if (flow == btpan_cb.flow) return;
+
+  btpan_cb.flow = flow;
+  if (flow) {
     btsock_thread_add_fd(pan_pth, btpan_cb.tap_fd, 0, SOCK_THREAD_FD_RD, 0);
     do_in_main_thread(FROM_HERE,
                       base::Bind(btu_exec_tap_fd_read, btpan_cb.tap_fd));
   }
 }
 
+void btpan_set_flow_control(btpan_conn_t* conn, bool enable) {
+  conn->flow = enable;
+  btpan_update_flow();
+}
+
 int btpan_tap_open() {
   struct ifreq ifr;
   int fd, err;
@@ -377,6 +394,10 @@ int btpan_tap_open() {
   if (tap_if_up(TAP_IF_NAME, controller_get_interface()->get_address()) == 0) {
     int flags = fcntl(fd, F_GETFL, 0);
     fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+    btpan_cb.tap_open_time_ms = bluetooth::common::time_get_os_boottime_ms();
+    btpan_cb.read_batches = 0;
+    memset(&btpan_cb.uplink, 0, sizeof(btpan_cb.uplink));
+    memset(&btpan_cb.downlink, 0, sizeof(btpan_cb.downlink));
     return fd;
   }
   BTIF_TRACE_ERROR("can not bring up tap interface:%s", TAP_IF_NAME);
@@ -385,25 +406,47 @@ int btpan_tap_open() {
 }
 
 int btpan_tap_send(int tap_fd, const RawAddress& src, const RawAddress& dst,
-                   uint16_t proto, const char* buf, uint16_t len,
-                   UNUSED_ATTR bool ext, UNUSED_ATTR bool forward) {
+                   uint16_t proto, const char* buf, uint16_t len, bool ext,
+                   UNUSED_ATTR bool forward) {
   if (tap_fd != INVALID_FD) {
+    /* Extension headers BNEP forwards ahead of the payload have no meaning on
+     * the ethernet side, skip them */
+    while (ext) {
+      if (len < 2 || len - 2 < (uint8_t)buf[1]) {
+        LOG_ERROR("btpan_tap_send malformed extension header");
+        btpan_cb.downlink.drops++;
+        return -1;
+      }
+      ext = buf[0] & 0x80;
+      uint16_t ext_len = 2 + (uint8_t)buf[1];
+      buf += ext_len;
+      len -= ext_len;
+    }
+
+    if (len > TAP_MAX_PKT_WRITE_LEN) {
+      LOG_ERROR("btpan_tap_send eth packet size:%d is exceeded limit!", len);
+      btpan_cb.downlink.drops++;
+      return -1;
+    }
+
     tETH_HDR eth_hdr;
     eth_hdr.h_dest = dst;
     eth_hdr.h_src = src;
     eth_hdr.h_proto = htons(proto);
     char packet[TAP_MAX_PKT_WRITE_LEN + sizeof(tETH_HDR)];
     memcpy(packet, &eth_hdr, sizeof(tETH_HDR));
-    if (len > TAP_MAX_PKT_WRITE_LEN) {
-      LOG_ERROR("btpan_tap_send eth packet size:%d is exceeded limit!", len);
-      return -1;
-    }
     memcpy(packet + sizeof(tETH_HDR), buf, len);
 
     /* Send data to network interface */
     ssize_t ret;
     OSI_NO_INTR(ret = write(tap_fd, packet, len + sizeof(tETH_HDR)));
     BTIF_TRACE_DEBUG("ret:%d", ret);
+    if (ret < 0) {
+      btpan_cb.downlink.drops++;
+    } else {
+      btpan_cb.downlink.frames++;
+      btpan_cb.downlink.octets += ret;
+    }
     return (int)ret;
   }
   return -1;
@@ -453,8 +496,9 @@ static void btpan_open_conn(btpan_conn_t* conn, tBTA_PAN* p_data) {
     }
 
     if (btpan_cb.tap_fd >= 0) {
-      btpan_cb.flow = 1;
+      conn->flow = 1;
       conn->state = PAN_STATE_OPEN;
+      btpan_update_flow();
     }
   }
 }
@@ -474,6 +518,9 @@ static void btpan_close_conn(btpan_conn_t* conn) {
         btpan_tap_close(btpan_cb.tap_fd);
         btpan_cb.tap_fd = INVALID_FD;
       }
+    } else {
+      // The closed connection no longer holds back the others
+      btpan_update_flow();
     }
   }
 }
@@ -638,12 +685,11 @@ static void bta_pan_callback(tBTA_PAN_EVT event, tBTA_PAN* p_data) {
                         sizeof(tBTA_PAN), NULL);
 }
 
-#define IS_EXCEPTION(e) ((e) & (POLLHUP | POLLRDHUP | POLLERR | POLLNVAL))
 static void btu_exec_tap_fd_read(int fd) {
-  struct pollfd ufd;
-
   if (fd == INVALID_FD || fd != btpan_cb.tap_fd) return;
 
+  btpan_cb.read_batches++;
+
   // Don't occupy BTU context too long, avoid buffer overruns and
   // give other profiles a chance to run by limiting the amount of memory
   // PAN can use.
@@ -654,38 +700,36 @@ static void btu_exec_tap_fd_read(int fd) {
 
     uint8_t* packet = (uint8_t*)buffer + sizeof(BT_HDR) + buffer->offset;
 
-    // If we don't have an undelivered packet left over, pull one from the TAP
-    // driver.
-    // We save it in the congest_packet right away in case we can't deliver it
-    // in this
-    // attempt.
-    if (!btpan_cb.congest_packet_size) {
-      ssize_t ret;
-      OSI_NO_INTR(ret = read(fd, btpan_cb.congest_packet,
-                             sizeof(btpan_cb.congest_packet)));
-      switch (ret) {
-        case -1:
-          BTIF_TRACE_ERROR("%s unable to read from driver: %s", __func__,
-                           strerror(errno));
-          osi_free(buffer);
-          // add fd back to monitor thread to try it again later
-          btsock_thread_add_fd(pan_pth, fd, 0, SOCK_THREAD_FD_RD, 0);
-          return;
-        case 0:
-          BTIF_TRACE_WARNING("%s end of file reached.", __func__);
-          osi_free(buffer);
-          // add fd back to monitor thread to process the exception
-          btsock_thread_add_fd(pan_pth, fd, 0, SOCK_THREAD_FD_RD, 0);
-          return;
-        default:
-          btpan_cb.congest_packet_size = ret;
-          break;
-      }
+    // Read the frame straight into the buffer handed to BNEP, behind the
+    // headroom BNEP and L2CAP need for their headers. The TAP fd is non
+    // blocking, so the batch ends once the driver has no more frames queued.
+    ssize_t ret;
+    OSI_NO_INTR(ret = read(fd, packet, buffer->len));
+    if (ret == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      osi_free(buffer);
+      break;
+    }
+    switch (ret) {
+      case -1:
+        BTIF_TRACE_ERROR("%s unable to read from driver: %s", __func__,
+                         strerror(errno));
+        osi_free(buffer);
+        // add fd back to monitor thread to try it again later
+        btsock_thread_add_fd(pan_pth, fd, 0, SOCK_THREAD_FD_RD, 0);
+        return;
+      case 0:
+        BTIF_TRACE_WARNING("%s end of file reached.", __func__);
+        osi_free(buffer);
+        // add fd back to monitor thread to process the exception
+        btsock_thread_add_fd(pan_pth, fd, 0, SOCK_THREAD_FD_RD, 0);
+        return;
+      default:
+        buffer->len = ret;
+        break;
     }
 
-    memcpy(packet, btpan_cb.congest_packet,
-           MIN(btpan_cb.congest_packet_size, buffer->len));
-    buffer->len = MIN(btpan_cb.congest_packet_size, buffer->len);
+    btpan_cb.uplink.frames++;
+    btpan_cb.uplink.octets += buffer->len;
 
     if (buffer->len > sizeof(tETH_HDR) && should_forward((tETH_HDR*)packet)) {
       // Extract the ethernet header from the buffer since the PAN_WriteBuf
@@ -698,23 +742,17 @@ static void btu_exec_tap_fd_read(int fd) {
       // Skip the ethernet header.
       buffer->len -= sizeof(tETH_HDR);
       buffer->offset += sizeof(tETH_HDR);
-      if (forward_bnep(&hdr, buffer) != FORWARD_CONGEST)
-        btpan_cb.congest_packet_size = 0;
+      int result = forward_bnep(&hdr, buffer);
+      if (result != FORWARD_SUCCESS) btpan_cb.uplink.drops++;
+      // Reading stops as soon as a connection turns its flow off, so BNEP's
+      // queue should not overflow; if it still does, let it drain
+      if (result == FORWARD_CONGEST) break;
     } else {
       BTIF_TRACE_WARNING("%s dropping packet of length %d", __func__,
                          buffer->len);
-      btpan_cb.congest_packet_size = 0;
+      btpan_cb.uplink.drops++;
       osi_free(buffer);
     }
-
-    // Bail out of the loop if reading from the TAP fd would block.
-    ufd.fd = fd;
-    ufd.events = POLLIN;
-    ufd.revents = 0;
-
-    int ret;
-    OSI_NO_INTR(ret = poll(&ufd, 1, 0));
-    if (ret <= 0 || IS_EXCEPTION(ufd.revents)) break;
   }
 
   if (btpan_cb.flow) {
@@ -723,6 +761,39 @@ static void btu_exec_tap_fd_read(int fd) {
   }
 }
 
+static uint64_t per_second(uint64_t count, uint64_t elapsed_ms) {
+  return elapsed_ms ? count * 1000 / elapsed_ms : 0;
+}
+
+void btif_debug_pan_dump(int fd) {
+  dprintf(fd, "\nPAN TAP interface:\n");
+  if (btpan_cb.tap_fd == INVALID_FD) {
+    dprintf(fd, "  Closed\n");
+    return;
+  }
+
+  uint64_t elapsed_ms = bluetooth::common::time_get_os_boottime_ms() -
+                        btpan_cb.tap_open_time_ms;
+  dprintf(fd, "  Open for %" PRIu64 " ms, %" PRIu64 " read batches\n",
+          elapsed_ms, btpan_cb.read_batches);
+  dprintf(fd,
+          "  Uplink: frames=%" PRIu64 " (%" PRIu64 "/s) octets=%" PRIu64
+          " (%" PRIu64 "/s) drops=%" PRIu64 "\n",
+          btpan_cb.uplink.frames,
+          per_second(btpan_cb.uplink.frames, elapsed_ms),
+          btpan_cb.uplink.octets,
+          per_second(btpan_cb.uplink.octets, elapsed_ms),
+          btpan_cb.uplink.drops);
+  dprintf(fd,
+          "  Downlink: frames=%" PRIu64 " (%" PRIu64 "/s) octets=%" PRIu64
+          " (%" PRIu64 "/s) drops=%" PRIu64 "\n",
+          btpan_cb.downlink.frames,
+          per_second(btpan_cb.downlink.frames, elapsed_ms),
+          btpan_cb.downlink.octets,
+          per_second(btpan_cb.downlink.octets, elapsed_ms),
+          btpan_cb.downlink.drops);
+}
+
 static void btif_pan_close_all_conns() {
   if (!stack_initialized) return;
 
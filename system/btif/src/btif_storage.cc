@@ -39,6 +39,9 @@
 #include <string.h>
 #include <time.h>
 
+#include <algorithm>
+#include <memory>
+#include <unordered_map>
 #include <vector>
 
 #include "bta_csis_api.h"
@@ -49,6 +52,7 @@
 #include "bta_hh_api.h"
 #include "bta_le_audio_api.h"
 #include "btif_api.h"
+#include "btif_bonded_device_record.h"
 #include "btif_config.h"
 #include "btif_hd.h"
 #include "btif_hh.h"
@@ -188,11 +192,14 @@ extern void btif_gatts_add_bonded_dev_from_nv(const RawAddress& bda);
  ******************************************************************************/
 
 static bt_status_t btif_in_fetch_bonded_ble_device(
-    const std::string& remote_bd_addr, int add,
+    const BtifBondedDeviceRecord& record, int add,
     btif_bonded_devices_t* p_bonded_devices);
 static bt_status_t btif_in_fetch_bonded_device(const std::string& bdstr);
+static bool btif_in_has_ble_bond(const std::string& bdstr);
+static bool btif_in_is_bonded_device(const BtifBondedDeviceRecord& record);
 
 static bool btif_has_ble_keys(const std::string& bdstr);
+static const char* btif_storage_get_ble_key_name(uint8_t key_type);
 
 /*******************************************************************************
  *  Static functions
@@ -436,98 +443,122 @@ static bt_status_t btif_in_fetch_bonded_device(const std::string& bdstr) {
       bt_linkkey_file_found = false;
     }
   }
-  if ((btif_in_fetch_bonded_ble_device(bdstr, false, NULL) !=
-       BT_STATUS_SUCCESS) &&
-      (!bt_linkkey_file_found)) {
+  if (!btif_in_has_ble_bond(bdstr) && !bt_linkkey_file_found) {
     return BT_STATUS_FAIL;
   }
   return BT_STATUS_SUCCESS;
 }
 
+/* Same as btif_in_fetch_bonded_device(), on a record read at enable */
+static bool btif_in_is_bonded_device(const BtifBondedDeviceRecord& record) {
+  if (record.link_key()) return true;
+  return btif_in_fetch_bonded_ble_device(record, false, NULL) ==
+         BT_STATUS_SUCCESS;
+}
+
 /*******************************************************************************
  *
  * Function         btif_in_fetch_bonded_devices
  *
  * Description      Internal helper function to fetch the bonded devices
- *                  from NVRAM
+ *                  from the records of all paired devices, and add them to
+ *                  BTA if |add| is set
  *
  * Returns          BT_STATUS_SUCCESS if successful, BT_STATUS_FAIL otherwise
  *
  ******************************************************************************/
 static bt_status_t btif_in_fetch_bonded_devices(
+    const std::vector<BtifBondedDeviceRecord>& records,
     btif_bonded_devices_t* p_bonded_devices, int add) {
   memset(p_bonded_devices, 0, sizeof(btif_bonded_devices_t));
 
-  bool bt_linkkey_file_found = false;
-  int device_type;
-
-  for (const auto& bd_addr : btif_config_get_paired_devices()) {
-    auto name = bd_addr.ToString();
-
-    BTIF_TRACE_DEBUG("Remote device:%s", name.c_str());
-    LinkKey link_key;
-    size_t size = sizeof(link_key);
-    if (btif_config_get_bin(name, "LinkKey", link_key.data(), &size)) {
-      int linkkey_type;
-      if (btif_config_get_int(name, "LinkKeyType", &linkkey_type)) {
-        if (add) {
-          DEV_CLASS dev_class = {0, 0, 0};
-          int cod;
-          int pin_length = 0;
-          if (btif_config_get_int(name, "DevClass", &cod))
-            uint2devclass((uint32_t)cod, dev_class);
-          btif_config_get_int(name, "PinLength", &pin_length);
-          BTA_DmAddDevice(bd_addr, dev_class, link_key, (uint8_t)linkkey_type,
-                          pin_length);
-
-          if (btif_config_get_int(name, "DevType", &device_type) &&
-              (device_type == BT_DEVICE_TYPE_DUMO)) {
-            btif_gatts_add_bonded_dev_from_nv(bd_addr);
-          }
-        }
-        bt_linkkey_file_found = true;
-        if (p_bonded_devices->num_devices < BTM_SEC_MAX_DEVICE_RECORDS) {
-          p_bonded_devices->devices[p_bonded_devices->num_devices++] = bd_addr;
-        } else {
-          BTIF_TRACE_WARNING("%s: exceed the max number of bonded devices",
-                             __func__);
+  for (const auto& record : records) {
+    const RawAddress& bd_addr = record.address();
+    bool bt_linkkey_file_found = false;
+
+    BTIF_TRACE_DEBUG("Remote device:%s", bd_addr.ToString().c_str());
+    if (record.link_key()) {
+      if (add) {
+        DEV_CLASS dev_class = {0, 0, 0};
+        if (record.dev_class()) uint2devclass(*record.dev_class(), dev_class);
+        BTA_DmAddDevice(bd_addr, dev_class, *record.link_key(),
+                        (uint8_t)record.link_key_type(),
+                        (uint8_t)record.pin_length());
+
+        if (record.dev_type() == BT_DEVICE_TYPE_DUMO) {
+          btif_gatts_add_bonded_dev_from_nv(bd_addr);
         }
+      }
+      bt_linkkey_file_found = true;
+      if (p_bonded_devices->num_devices < BTM_SEC_MAX_DEVICE_RECORDS) {
+        p_bonded_devices->devices[p_bonded_devices->num_devices++] = bd_addr;
       } else {
-        bt_linkkey_file_found = false;
+        BTIF_TRACE_WARNING("%s: exceed the max number of bonded devices",
+                           __func__);
       }
     }
-    if (!btif_in_fetch_bonded_ble_device(name, add, p_bonded_devices) && !bt_linkkey_file_found) {
-      LOG_VERBOSE("No link key or ble key found for device:%s", name.c_str());
+    if (btif_in_fetch_bonded_ble_device(record, add, p_bonded_devices) !=
+            BT_STATUS_SUCCESS &&
+        !bt_linkkey_file_found) {
+      LOG_VERBOSE("No link key or ble key found for device:%s",
+                  bd_addr.ToString().c_str());
     }
   }
   return BT_STATUS_SUCCESS;
 }
 
-static void btif_read_le_key(const uint8_t key_type, const size_t key_len,
-                             RawAddress bd_addr, const tBLE_ADDR_TYPE addr_type,
+static bt_status_t btif_in_fetch_bonded_devices(
+    btif_bonded_devices_t* p_bonded_devices, int add) {
+  return btif_in_fetch_bonded_devices(btif_config_get_paired_device_records(),
+                                      p_bonded_devices, add);
+}
+
+/* LE keys of a bonded device, in the order they are added to BTA */
+static const struct {
+  uint8_t key_type;
+  size_t key_len;
+} btif_le_bonding_keys[] = {
+    {BTM_LE_KEY_PENC, sizeof(tBTM_LE_PENC_KEYS)},
+    {BTM_LE_KEY_PID, sizeof(tBTM_LE_PID_KEYS)},
+    {BTM_LE_KEY_LID, sizeof(tBTM_LE_PID_KEYS)},
+    {BTM_LE_KEY_PCSRK, sizeof(tBTM_LE_PCSRK_KEYS)},
+    {BTM_LE_KEY_LENC, sizeof(tBTM_LE_LENC_KEYS)},
+    {BTM_LE_KEY_LCSRK, sizeof(tBTM_LE_LCSRK_KEYS)},
+};
+
+static void btif_read_le_key(const BtifBondedDeviceRecord& record,
+                             const uint8_t key_type, const size_t key_len,
+                             const tBLE_ADDR_TYPE addr_type,
                              const bool add_key, bool* device_added,
                              bool* key_found) {
   CHECK(device_added);
   CHECK(key_found);
 
+  auto value = record.GetBin(btif_storage_get_ble_key_name(key_type));
+  if (!value) return;
+
   tBTA_LE_KEY_VALUE key;
   memset(&key, 0, sizeof(key));
+  if (value->size() != key_len) {
+    LOG_WARN("Ignoring key type %d of size %zu, expected %zu", key_type,
+             value->size(), key_len);
+    return;
+  }
+  memcpy(&key, value->data(), key_len);
 
-  if (btif_storage_get_ble_bonding_key(bd_addr, key_type, (uint8_t*)&key,
-                                       key_len) == BT_STATUS_SUCCESS) {
-    if (add_key) {
-      if (!*device_added) {
-        BTA_DmAddBleDevice(bd_addr, addr_type, BT_DEVICE_TYPE_BLE);
-        *device_added = true;
-      }
-
-      BTIF_TRACE_DEBUG("%s() Adding key type %d for %s", __func__, key_type,
-                       bd_addr.ToString().c_str());
-      BTA_DmAddBleKey(bd_addr, &key, key_type);
+  if (add_key) {
+    const RawAddress& bd_addr = record.address();
+    if (!*device_added) {
+      BTA_DmAddBleDevice(bd_addr, addr_type, BT_DEVICE_TYPE_BLE);
+      *device_added = true;
     }
 
-    *key_found = true;
+    BTIF_TRACE_DEBUG("%s() Adding key type %d for %s", __func__, key_type,
+                     bd_addr.ToString().c_str());
+    BTA_DmAddBleKey(bd_addr, &key, key_type);
   }
+
+  *key_found = true;
 }
 
 /*******************************************************************************
@@ -906,29 +937,30 @@ bt_status_t btif_storage_remove_bonded_device(
  * We still allow such devices to bond in order to give the user a chance to
  * update firmware.
  */
-static void remove_devices_with_sample_ltk() {
-  std::vector<RawAddress> bad_ltk;
-  for (const auto& bd_addr : btif_config_get_paired_devices()) {
-    auto name = bd_addr.ToString();
+static void remove_devices_with_sample_ltk(
+    std::vector<BtifBondedDeviceRecord>* records) {
+  auto is_bad_ltk = [](const BtifBondedDeviceRecord& record) {
+    auto value = record.GetBin("LE_KEY_PENC");
+    if (!value || value->size() != sizeof(tBTM_LE_PENC_KEYS)) return false;
 
     tBTA_LE_KEY_VALUE key;
     memset(&key, 0, sizeof(key));
+    memcpy(&key, value->data(), sizeof(tBTM_LE_PENC_KEYS));
+    return is_sample_ltk(key.penc_key.ltk);
+  };
 
-    if (btif_storage_get_ble_bonding_key(
-            bd_addr, BTM_LE_KEY_PENC, (uint8_t*)&key,
-            sizeof(tBTM_LE_PENC_KEYS)) == BT_STATUS_SUCCESS) {
-      if (is_sample_ltk(key.penc_key.ltk)) {
-        bad_ltk.push_back(bd_addr);
-      }
+  for (auto it = records->begin(); it != records->end();) {
+    if (!is_bad_ltk(*it)) {
+      ++it;
+      continue;
     }
-  }
-
-  for (RawAddress address : bad_ltk) {
+    RawAddress address = it->address();
     android_errorWriteLog(0x534e4554, "128437297");
     LOG(ERROR) << __func__
                << ": removing bond to device using test TLK: " << address;
 
     btif_storage_remove_bonded_device(&address);
+    it = records->erase(it);
   }
 }
 
@@ -996,6 +1028,65 @@ void btif_storage_load_consolidate_devices(void) {
   }
 }
 
+/* Remote properties of a bonded device reported at enable, taken from its
+ * record so that they can be delivered after enable has returned */
+struct btif_bonded_device_properties_t {
+  RawAddress address;
+  bt_bdname_t name;
+  uint32_t name_len;
+  bt_bdname_t alias;
+  uint32_t alias_len;
+  uint32_t cod;
+  uint32_t devtype;
+  std::vector<Uuid> uuids;
+};
+
+/* Bonded devices whose properties are reported per JNI thread task, so that
+ * other upstream events don't wait behind hundreds of bonds. All the tasks are
+ * queued while loading, ahead of the adapter state change to ON. */
+#define BTIF_STORAGE_BONDED_PROPERTIES_BATCH_SIZE 16
+
+static void btif_storage_fill_bdname(const std::string* value,
+                                     bt_bdname_t* name, uint32_t* len) {
+  memset(name, 0, sizeof(*name));
+  *len = 0;
+  if (value == nullptr) return;
+  *len = std::min(value->size(), sizeof(name->name) - 1);
+  memcpy(name->name, value->data(), *len);
+}
+
+static void btif_storage_report_bonded_device_properties(
+    std::shared_ptr<std::vector<btif_bonded_device_properties_t>> devices,
+    size_t first) {
+  size_t last = std::min(first + BTIF_STORAGE_BONDED_PROPERTIES_BATCH_SIZE,
+                         devices->size());
+  for (size_t i = first; i < last; i++) {
+    btif_bonded_device_properties_t& device = (*devices)[i];
+    bt_property_t remote_properties[5];
+    uint32_t num_props = 0;
+
+    BTIF_STORAGE_FILL_PROPERTY(&remote_properties[num_props++],
+                               BT_PROPERTY_BDNAME, device.name_len,
+                               &device.name);
+    BTIF_STORAGE_FILL_PROPERTY(&remote_properties[num_props++],
+                               BT_PROPERTY_REMOTE_FRIENDLY_NAME,
+                               device.alias_len, &device.alias);
+    BTIF_STORAGE_FILL_PROPERTY(&remote_properties[num_props++],
+                               BT_PROPERTY_CLASS_OF_DEVICE, sizeof(device.cod),
+                               &device.cod);
+    BTIF_STORAGE_FILL_PROPERTY(&remote_properties[num_props++],
+                               BT_PROPERTY_TYPE_OF_DEVICE,
+                               sizeof(device.devtype), &device.devtype);
+    BTIF_STORAGE_FILL_PROPERTY(
+        &remote_properties[num_props++], BT_PROPERTY_UUIDS,
+        device.uuids.size() * sizeof(Uuid),
+        device.uuids.empty() ? NULL : device.uuids.data());
+
+    btif_remote_properties_evt(BT_STATUS_SUCCESS, &device.address, num_props,
+                               remote_properties);
+  }
+}
+
 /*******************************************************************************
  *
  * Function         btif_storage_load_bonded_devices
@@ -1003,7 +1094,9 @@ void btif_storage_load_consolidate_devices(void) {
  * Description      BTIF storage API - Loads all the bonded devices from NVRAM
  *                  and adds to the BTA.
  *                  Additionally, this API also invokes the adaper_properties_cb
- *                  and remote_device_properties_cb for each of the bonded
+ *                  and, from later JNI thread tasks in batches of
+ *                  BTIF_STORAGE_BONDED_PROPERTIES_BATCH_SIZE devices, the
+ *                  remote_device_properties_cb for each of the bonded
  *                  devices.
  *
  * Returns          BT_STATUS_SUCCESS if successful, BT_STATUS_FAIL otherwise
@@ -1014,18 +1107,20 @@ bt_status_t btif_storage_load_bonded_devices(void) {
   uint32_t i = 0;
   bt_property_t adapter_props[6];
   uint32_t num_props = 0;
-  bt_property_t remote_properties[8];
   RawAddress addr;
-  bt_bdname_t name, alias;
+  bt_bdname_t name;
   bt_scan_mode_t mode;
   uint32_t disc_timeout;
   Uuid local_uuids[BT_MAX_NUM_UUIDS];
-  Uuid remote_uuids[BT_MAX_NUM_UUIDS];
   bt_status_t status;
 
-  remove_devices_with_sample_ltk();
+  /* Every bonded device section is read once, all the rest works on these */
+  std::vector<BtifBondedDeviceRecord> records =
+      btif_config_get_paired_device_records();
 
-  btif_in_fetch_bonded_devices(&bonded_devices, 1);
+  remove_devices_with_sample_ltk(&records);
+
+  btif_in_fetch_bonded_devices(records, &bonded_devices, 1);
 
   /* Now send the adapter_properties_cb with all adapter_properties */
   {
@@ -1088,46 +1183,40 @@ bt_status_t btif_storage_load_bonded_devices(void) {
   BTIF_TRACE_EVENT("%s: %d bonded devices found", __func__,
                    bonded_devices.num_devices);
 
-  {
-    for (i = 0; i < bonded_devices.num_devices; i++) {
-      RawAddress* p_remote_addr;
-
-      /*
-       * TODO: improve handling of missing fields in NVRAM.
-       */
-      uint32_t cod = 0;
-      uint32_t devtype = 0;
-
-      num_props = 0;
-      p_remote_addr = &bonded_devices.devices[i];
-      memset(remote_properties, 0, sizeof(remote_properties));
-      BTIF_STORAGE_GET_REMOTE_PROP(p_remote_addr, BT_PROPERTY_BDNAME, &name,
-                                   sizeof(name), remote_properties[num_props]);
-      num_props++;
-
-      BTIF_STORAGE_GET_REMOTE_PROP(p_remote_addr,
-                                   BT_PROPERTY_REMOTE_FRIENDLY_NAME, &alias,
-                                   sizeof(alias), remote_properties[num_props]);
-      num_props++;
-
-      BTIF_STORAGE_GET_REMOTE_PROP(p_remote_addr, BT_PROPERTY_CLASS_OF_DEVICE,
-                                   &cod, sizeof(cod),
-                                   remote_properties[num_props]);
-      num_props++;
-
-      BTIF_STORAGE_GET_REMOTE_PROP(p_remote_addr, BT_PROPERTY_TYPE_OF_DEVICE,
-                                   &devtype, sizeof(devtype),
-                                   remote_properties[num_props]);
-      num_props++;
-
-      BTIF_STORAGE_GET_REMOTE_PROP(p_remote_addr, BT_PROPERTY_UUIDS,
-                                   remote_uuids, sizeof(remote_uuids),
-                                   remote_properties[num_props]);
-      num_props++;
+  std::unordered_map<RawAddress, const BtifBondedDeviceRecord*>
+      records_by_address;
+  for (const auto& record : records) {
+    records_by_address[record.address()] = &record;
+  }
 
-      btif_remote_properties_evt(BT_STATUS_SUCCESS, p_remote_addr, num_props,
-                                 remote_properties);
-    }
+  auto devices =
+      std::make_shared<std::vector<btif_bonded_device_properties_t>>(
+          bonded_devices.num_devices);
+  for (i = 0; i < bonded_devices.num_devices; i++) {
+    const BtifBondedDeviceRecord& record =
+        *records_by_address[bonded_devices.devices[i]];
+    btif_bonded_device_properties_t& device = (*devices)[i];
+
+    /*
+     * TODO: improve handling of missing fields in NVRAM.
+     */
+    device.address = record.address();
+    btif_storage_fill_bdname(record.GetStr(BTIF_STORAGE_PATH_REMOTE_NAME),
+                             &device.name, &device.name_len);
+    btif_storage_fill_bdname(record.GetStr(BTIF_STORAGE_PATH_REMOTE_ALIASE),
+                             &device.alias, &device.alias_len);
+    device.cod = record.dev_class().value_or(0);
+    device.devtype = record.dev_type().value_or(0);
+    device.uuids.assign(
+        record.uuids().begin(),
+        record.uuids().begin() +
+            std::min<size_t>(record.uuids().size(), BT_MAX_NUM_UUIDS));
+  }
+  for (size_t first = 0; first < devices->size();
+       first += BTIF_STORAGE_BONDED_PROPERTIES_BATCH_SIZE) {
+    do_in_jni_thread(
+        FROM_HERE, base::BindOnce(&btif_storage_report_bonded_device_properties,
+                                  devices, first));
   }
   return BT_STATUS_SUCCESS;
 }
@@ -1187,33 +1276,31 @@ bt_status_t btif_storage_add_ble_bonding_key(RawAddress* remote_bd_addr,
  *                  BT_STATUS_FAIL otherwise
  *
  ******************************************************************************/
-bt_status_t btif_storage_get_ble_bonding_key(const RawAddress& remote_bd_addr,
-                                             uint8_t key_type,
-                                             uint8_t* key_value,
-                                             int key_length) {
-  const char* name;
+static const char* btif_storage_get_ble_key_name(uint8_t key_type) {
   switch (key_type) {
     case BTM_LE_KEY_PENC:
-      name = "LE_KEY_PENC";
-      break;
+      return "LE_KEY_PENC";
     case BTM_LE_KEY_PID:
-      name = "LE_KEY_PID";
-      break;
+      return "LE_KEY_PID";
     case BTM_LE_KEY_PCSRK:
-      name = "LE_KEY_PCSRK";
-      break;
+      return "LE_KEY_PCSRK";
     case BTM_LE_KEY_LENC:
-      name = "LE_KEY_LENC";
-      break;
+      return "LE_KEY_LENC";
     case BTM_LE_KEY_LCSRK:
-      name = "LE_KEY_LCSRK";
-      break;
+      return "LE_KEY_LCSRK";
     case BTM_LE_KEY_LID:
-      name = "LE_KEY_LID";
-      break;
+      return "LE_KEY_LID";
     default:
-      return BT_STATUS_FAIL;
+      return nullptr;
   }
+}
+
+bt_status_t btif_storage_get_ble_bonding_key(const RawAddress& remote_bd_addr,
+                                             uint8_t key_type,
+                                             uint8_t* key_value,
+                                             int key_length) {
+  const char* name = btif_storage_get_ble_key_name(key_type);
+  if (name == nullptr) return BT_STATUS_FAIL;
   size_t length = key_length;
   int ret =
       btif_config_get_bin(remote_bd_addr.ToString(), name, key_value, &length);
@@ -1336,47 +1423,31 @@ bt_status_t btif_storage_remove_ble_local_keys(void) {
 }
 
 static bt_status_t btif_in_fetch_bonded_ble_device(
-    const std::string& remote_bd_addr, int add,
+    const BtifBondedDeviceRecord& record, int add,
     btif_bonded_devices_t* p_bonded_devices) {
-  int device_type;
   tBLE_ADDR_TYPE addr_type;
   bool device_added = false;
   bool key_found = false;
 
-  if (!btif_config_get_int(remote_bd_addr, "DevType", &device_type))
-    return BT_STATUS_FAIL;
+  if (!record.dev_type()) return BT_STATUS_FAIL;
 
-  if ((device_type & BT_DEVICE_TYPE_BLE) == BT_DEVICE_TYPE_BLE ||
-      btif_has_ble_keys(remote_bd_addr)) {
+  if ((*record.dev_type() & BT_DEVICE_TYPE_BLE) == BT_DEVICE_TYPE_BLE ||
+      record.HasProperty("LE_KEY_PENC")) {
+    const RawAddress& bd_addr = record.address();
     BTIF_TRACE_DEBUG("%s Found a LE device: %s", __func__,
-                     remote_bd_addr.c_str());
+                     bd_addr.ToString().c_str());
 
-    RawAddress bd_addr;
-    RawAddress::FromString(remote_bd_addr, bd_addr);
-
-    if (btif_storage_get_remote_addr_type(&bd_addr, &addr_type) !=
-        BT_STATUS_SUCCESS) {
+    if (record.addr_type()) {
+      addr_type = static_cast<tBLE_ADDR_TYPE>(*record.addr_type());
+    } else {
       addr_type = BLE_ADDR_PUBLIC;
       btif_storage_set_remote_addr_type(&bd_addr, BLE_ADDR_PUBLIC);
     }
 
-    btif_read_le_key(BTM_LE_KEY_PENC, sizeof(tBTM_LE_PENC_KEYS), bd_addr,
-                     addr_type, add, &device_added, &key_found);
-
-    btif_read_le_key(BTM_LE_KEY_PID, sizeof(tBTM_LE_PID_KEYS), bd_addr,
-                     addr_type, add, &device_added, &key_found);
-
-    btif_read_le_key(BTM_LE_KEY_LID, sizeof(tBTM_LE_PID_KEYS), bd_addr,
-                     addr_type, add, &device_added, &key_found);
-
-    btif_read_le_key(BTM_LE_KEY_PCSRK, sizeof(tBTM_LE_PCSRK_KEYS), bd_addr,
-                     addr_type, add, &device_added, &key_found);
-
-    btif_read_le_key(BTM_LE_KEY_LENC, sizeof(tBTM_LE_LENC_KEYS), bd_addr,
-                     addr_type, add, &device_added, &key_found);
-
-    btif_read_le_key(BTM_LE_KEY_LCSRK, sizeof(tBTM_LE_LCSRK_KEYS), bd_addr,
-                     addr_type, add, &device_added, &key_found);
+    for (const auto& le_key : btif_le_bonding_keys) {
+      btif_read_le_key(record, le_key.key_type, le_key.key_len, addr_type, add,
+                       &device_added, &key_found);
+    }
 
     // Fill in the bonded devices
     if (device_added) {
@@ -1394,6 +1465,30 @@ static bt_status_t btif_in_fetch_bonded_ble_device(
   return BT_STATUS_FAIL;
 }
 
+/* Whether btif_in_fetch_bonded_ble_device() would find LE keys for the
+ * device, without reading its whole section */
+static bool btif_in_has_ble_bond(const std::string& bdstr) {
+  int device_type;
+  if (!btif_config_get_int(bdstr, "DevType", &device_type)) return false;
+
+  if ((device_type & BT_DEVICE_TYPE_BLE) != BT_DEVICE_TYPE_BLE &&
+      !btif_has_ble_keys(bdstr)) {
+    return false;
+  }
+
+  RawAddress bd_addr;
+  RawAddress::FromString(bdstr, bd_addr);
+  for (const auto& le_key : btif_le_bonding_keys) {
+    tBTA_LE_KEY_VALUE key;
+    if (btif_storage_get_ble_bonding_key(bd_addr, le_key.key_type,
+                                         (uint8_t*)&key, le_key.key_len) ==
+        BT_STATUS_SUCCESS) {
+      return true;
+    }
+  }
+  return false;
+}
+
 bt_status_t btif_storage_set_remote_addr_type(const RawAddress* remote_bd_addr,
                                               tBLE_ADDR_TYPE addr_type) {
   int ret = btif_config_set_int(remote_bd_addr->ToString(), "AddrType",
@@ -1499,16 +1594,16 @@ bt_status_t btif_storage_add_hid_device_info(
  *
  ******************************************************************************/
 bt_status_t btif_storage_load_bonded_hid_info(void) {
-  for (const auto& bd_addr : btif_config_get_paired_devices()) {
-    auto name = bd_addr.ToString();
+  for (const auto& record : btif_config_get_paired_device_records()) {
+    const RawAddress& bd_addr = record.address();
 
-    BTIF_TRACE_DEBUG("Remote device:%s", name.c_str());
+    BTIF_TRACE_DEBUG("Remote device:%s", bd_addr.ToString().c_str());
 
-    int value;
-    if (!btif_config_get_int(name, "HidAttrMask", &value)) continue;
-    uint16_t attr_mask = (uint16_t)value;
+    auto attr_mask_value = record.GetInt("HidAttrMask");
+    if (!attr_mask_value) continue;
+    uint16_t attr_mask = (uint16_t)*attr_mask_value;
 
-    if (btif_in_fetch_bonded_device(name) != BT_STATUS_SUCCESS) {
+    if (!btif_in_is_bonded_device(record)) {
       btif_storage_remove_hid_info(bd_addr);
       continue;
     }
@@ -1516,38 +1611,21 @@ bt_status_t btif_storage_load_bonded_hid_info(void) {
     tBTA_HH_DEV_DSCP_INFO dscp_info;
     memset(&dscp_info, 0, sizeof(dscp_info));
 
-    btif_config_get_int(name, "HidSubClass", &value);
-    uint8_t sub_class = (uint8_t)value;
-
-    btif_config_get_int(name, "HidAppId", &value);
-    uint8_t app_id = (uint8_t)value;
-
-    btif_config_get_int(name, "HidVendorId", &value);
-    dscp_info.vendor_id = (uint16_t)value;
-
-    btif_config_get_int(name, "HidProductId", &value);
-    dscp_info.product_id = (uint16_t)value;
-
-    btif_config_get_int(name, "HidVersion", &value);
-    dscp_info.version = (uint8_t)value;
-
-    btif_config_get_int(name, "HidCountryCode", &value);
-    dscp_info.ctry_code = (uint8_t)value;
-
-    value = 0;
-    btif_config_get_int(name, "HidSSRMaxLatency", &value);
-    dscp_info.ssr_max_latency = (uint16_t)value;
-
-    value = 0;
-    btif_config_get_int(name, "HidSSRMinTimeout", &value);
-    dscp_info.ssr_min_tout = (uint16_t)value;
-
-    size_t len = btif_config_get_bin_length(name, "HidDescriptor");
-    if (len > 0) {
-      dscp_info.descriptor.dl_len = (uint16_t)len;
-      dscp_info.descriptor.dsc_list = (uint8_t*)alloca(len);
-      btif_config_get_bin(name, "HidDescriptor",
-                          (uint8_t*)dscp_info.descriptor.dsc_list, &len);
+    uint8_t sub_class = (uint8_t)record.GetInt("HidSubClass").value_or(0);
+    uint8_t app_id = (uint8_t)record.GetInt("HidAppId").value_or(0);
+    dscp_info.vendor_id = (uint16_t)record.GetInt("HidVendorId").value_or(0);
+    dscp_info.product_id = (uint16_t)record.GetInt("HidProductId").value_or(0);
+    dscp_info.version = (uint8_t)record.GetInt("HidVersion").value_or(0);
+    dscp_info.ctry_code = (uint8_t)record.GetInt("HidCountryCode").value_or(0);
+    dscp_info.ssr_max_latency =
+        (uint16_t)record.GetInt("HidSSRMaxLatency").value_or(0);
+    dscp_info.ssr_min_tout =
+        (uint16_t)record.GetInt("HidSSRMinTimeout").value_or(0);
+
+    auto descriptor = record.GetBin("HidDescriptor");
+    if (descriptor && !descriptor->empty()) {
+      dscp_info.descriptor.dl_len = (uint16_t)descriptor->size();
+      dscp_info.descriptor.dsc_list = descriptor->data();
     }
 
     // add extracted information to BTA HH
@@ -1640,84 +1718,40 @@ void btif_storage_add_hearing_aid(const HearingDevice& dev_info) {
 
 /** Loads information about bonded hearing aid devices */
 void btif_storage_load_bonded_hearing_aids() {
-  for (const auto& bd_addr : btif_config_get_paired_devices()) {
-    const std::string& name = bd_addr.ToString();
-
-    int size = STORAGE_UUID_STRING_SIZE * HEARINGAID_MAX_NUM_UUIDS;
-    char uuid_str[size];
-    bool isHearingaidDevice = false;
-    if (btif_config_get_str(name, BTIF_STORAGE_PATH_REMOTE_SERVICE, uuid_str,
-                            &size)) {
-      Uuid p_uuid[HEARINGAID_MAX_NUM_UUIDS];
-      size_t num_uuids =
-          btif_split_uuids_string(uuid_str, p_uuid, HEARINGAID_MAX_NUM_UUIDS);
-      for (size_t i = 0; i < num_uuids; i++) {
-        if (p_uuid[i] == Uuid::FromString("FDF0")) {
-          isHearingaidDevice = true;
-          break;
-        }
-      }
-    }
-    if (!isHearingaidDevice) {
+  static const Uuid kHearingAidUuid = Uuid::FromString("FDF0");
+  for (const auto& record : btif_config_get_paired_device_records()) {
+    if (!record.HasUuid(kHearingAidUuid)) {
       continue;
     }
 
-    BTIF_TRACE_DEBUG("Remote device:%s", name.c_str());
+    const RawAddress& bd_addr = record.address();
+    BTIF_TRACE_DEBUG("Remote device:%s", bd_addr.ToString().c_str());
 
-    if (btif_in_fetch_bonded_device(name) != BT_STATUS_SUCCESS) {
+    if (!btif_in_is_bonded_device(record)) {
       btif_storage_remove_hearing_aid(bd_addr);
       continue;
     }
 
-    int value;
-    uint8_t capabilities = 0;
-    if (btif_config_get_int(name, HEARING_AID_CAPABILITIES, &value))
-      capabilities = value;
-
-    uint16_t codecs = 0;
-    if (btif_config_get_int(name, HEARING_AID_CODECS, &value)) codecs = value;
-
-    uint16_t audio_control_point_handle = 0;
-    if (btif_config_get_int(name, HEARING_AID_AUDIO_CONTROL_POINT, &value))
-      audio_control_point_handle = value;
-
-    uint16_t audio_status_handle = 0;
-    if (btif_config_get_int(name, HEARING_AID_AUDIO_STATUS_HANDLE, &value))
-      audio_status_handle = value;
-
-    uint16_t audio_status_ccc_handle = 0;
-    if (btif_config_get_int(name, HEARING_AID_AUDIO_STATUS_CCC_HANDLE, &value))
-      audio_status_ccc_handle = value;
-
-    uint16_t service_changed_ccc_handle = 0;
-    if (btif_config_get_int(name, HEARING_AID_SERVICE_CHANGED_CCC_HANDLE,
-                            &value))
-      service_changed_ccc_handle = value;
-
-    uint16_t volume_handle = 0;
-    if (btif_config_get_int(name, HEARING_AID_VOLUME_HANDLE, &value))
-      volume_handle = value;
-
-    uint16_t read_psm_handle = 0;
-    if (btif_config_get_int(name, HEARING_AID_READ_PSM_HANDLE, &value))
-      read_psm_handle = value;
-
-    uint64_t lvalue;
-    uint64_t hi_sync_id = 0;
-    if (btif_config_get_uint64(name, HEARING_AID_SYNC_ID, &lvalue))
-      hi_sync_id = lvalue;
-
-    uint16_t render_delay = 0;
-    if (btif_config_get_int(name, HEARING_AID_RENDER_DELAY, &value))
-      render_delay = value;
-
-    uint16_t preparation_delay = 0;
-    if (btif_config_get_int(name, HEARING_AID_PREPARATION_DELAY, &value))
-      preparation_delay = value;
-
-    uint16_t is_acceptlisted = 0;
-    if (btif_config_get_int(name, HEARING_AID_IS_ACCEPTLISTED, &value))
-      is_acceptlisted = value;
+    uint8_t capabilities = record.GetInt(HEARING_AID_CAPABILITIES).value_or(0);
+    uint16_t codecs = record.GetInt(HEARING_AID_CODECS).value_or(0);
+    uint16_t audio_control_point_handle =
+        record.GetInt(HEARING_AID_AUDIO_CONTROL_POINT).value_or(0);
+    uint16_t audio_status_handle =
+        record.GetInt(HEARING_AID_AUDIO_STATUS_HANDLE).value_or(0);
+    uint16_t audio_status_ccc_handle =
+        record.GetInt(HEARING_AID_AUDIO_STATUS_CCC_HANDLE).value_or(0);
+    uint16_t service_changed_ccc_handle =
+        record.GetInt(HEARING_AID_SERVICE_CHANGED_CCC_HANDLE).value_or(0);
+    uint16_t volume_handle =
+        record.GetInt(HEARING_AID_VOLUME_HANDLE).value_or(0);
+    uint16_t read_psm_handle =
+        record.GetInt(HEARING_AID_READ_PSM_HANDLE).value_or(0);
+    uint64_t hi_sync_id = record.GetUint64(HEARING_AID_SYNC_ID).value_or(0);
+    uint16_t render_delay = record.GetInt(HEARING_AID_RENDER_DELAY).value_or(0);
+    uint16_t preparation_delay =
+        record.GetInt(HEARING_AID_PREPARATION_DELAY).value_or(0);
+    uint16_t is_acceptlisted =
+        record.GetInt(HEARING_AID_IS_ACCEPTLISTED).value_or(0);
 
     // add extracted information to BTA Hearing Aid
     do_in_main_thread(
@@ -1846,34 +1880,17 @@ void btif_storage_set_leaudio_autoconnect(const RawAddress& addr,
 
 /** Loads information about bonded Le Audio devices */
 void btif_storage_load_bonded_leaudio() {
-  for (const auto& bd_addr : btif_config_get_paired_devices()) {
-    auto name = bd_addr.ToString();
-
-    int size = STORAGE_UUID_STRING_SIZE * BT_MAX_NUM_UUIDS;
-    char uuid_str[size];
-    bool isLeAudioDevice = false;
-    if (btif_config_get_str(name, BTIF_STORAGE_PATH_REMOTE_SERVICE, uuid_str,
-                            &size)) {
-      Uuid p_uuid[BT_MAX_NUM_UUIDS];
-      size_t num_uuids =
-          btif_split_uuids_string(uuid_str, p_uuid, BT_MAX_NUM_UUIDS);
-      for (size_t i = 0; i < num_uuids; i++) {
-        if (p_uuid[i] == Uuid::FromString("184E")) {
-          isLeAudioDevice = true;
-          break;
-        }
-      }
-    }
-    if (!isLeAudioDevice) {
+  static const Uuid kLeAudioUuid = Uuid::FromString("184E");
+  for (const auto& record : btif_config_get_paired_device_records()) {
+    if (!record.HasUuid(kLeAudioUuid)) {
       continue;
     }
 
-    BTIF_TRACE_DEBUG("Remote device:%s", name.c_str());
+    const RawAddress& bd_addr = record.address();
+    BTIF_TRACE_DEBUG("Remote device:%s", bd_addr.ToString().c_str());
 
-    int value;
-    bool autoconnect = false;
-    if (btif_config_get_int(name, BTIF_STORAGE_LEAUDIO_AUTOCONNECT, &value))
-      autoconnect = !!value;
+    bool autoconnect =
+        !!record.GetInt(BTIF_STORAGE_LEAUDIO_AUTOCONNECT).value_or(0);
 
     do_in_main_thread(
         FROM_HERE, Bind(&LeAudioClient::AddFromStorage, bd_addr, autoconnect));
@@ -1952,24 +1969,18 @@ void btif_storage_set_leaudio_has_features(const RawAddress& address,
 }
 
 void btif_storage_load_bonded_leaudio_has_devices() {
-  for (const auto& bd_addr : btif_config_get_paired_devices()) {
-    const std::string& name = bd_addr.ToString();
-
-    if (!btif_config_exist(name, HAS_IS_ACCEPTLISTED) &&
-        !btif_config_exist(name, HAS_FEATURES))
+  for (const auto& record : btif_config_get_paired_device_records()) {
+    if (!record.HasProperty(HAS_IS_ACCEPTLISTED) &&
+        !record.HasProperty(HAS_FEATURES))
       continue;
 
-    int value;
-    uint16_t is_acceptlisted = 0;
-    if (btif_config_get_int(name, HAS_IS_ACCEPTLISTED, &value))
-      is_acceptlisted = value;
-
-    uint8_t features = 0;
-    if (btif_config_get_int(name, HAS_FEATURES, &value)) features = value;
+    uint16_t is_acceptlisted = record.GetInt(HAS_IS_ACCEPTLISTED).value_or(0);
+    uint8_t features = record.GetInt(HAS_FEATURES).value_or(0);
 
 #ifndef TARGET_FLOSS
     do_in_main_thread(FROM_HERE, Bind(&le_audio::has::HasClient::AddFromStorage,
-                                      bd_addr, features, is_acceptlisted));
+                                      record.address(), features,
+                                      is_acceptlisted));
 #else
     ASSERT_LOG(false, "TODO - Fix LE audio build.");
 #endif
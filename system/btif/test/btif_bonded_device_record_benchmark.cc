@@ -0,0 +1,188 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <base/logging.h>
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "btif/include/btif_bonded_device_record.h"
+#include "storage/config_cache.h"
+#include "storage/config_cache_helper.h"
+#include "storage/device.h"
+#include "types/raw_address.h"
+
+using ::benchmark::State;
+using bluetooth::Uuid;
+using bluetooth::storage::ConfigCache;
+using bluetooth::storage::ConfigCacheHelper;
+using bluetooth::storage::Device;
+
+namespace {
+
+#define NUM_BONDS 500
+
+// Per property reads of everything the profile loaders below need
+const char* const kProfileProperties[] = {
+    "HidAttrMask",        "HidSubClass",      "HidAppId",
+    "HidVendorId",        "HidProductId",     "HidVersion",
+    "HidCountryCode",     "HidSSRMaxLatency", "HidSSRMinTimeout",
+    "LeAudioAutoconnect", "LeAudioHasFlags",  "LeAudioHasIsAcceptlisted",
+    "HearingAidReadPsmHandle"};
+
+const char* const kLeKeys[] = {"LE_KEY_PENC",  "LE_KEY_PID",  "LE_KEY_LID",
+                               "LE_KEY_PCSRK", "LE_KEY_LENC", "LE_KEY_LCSRK"};
+
+// How many passes over the bonded devices enable makes: the bonded devices
+// themselves, then the HID, hearing aid, LE Audio and HAS loaders
+constexpr int kLoadPasses = 5;
+
+// A config with NUM_BONDS bonds, a mix of classic, LE and dual mode devices
+// with the properties a phone typically stores for them
+std::unique_ptr<ConfigCache> GenerateConfig() {
+  auto config =
+      std::make_unique<ConfigCache>(NUM_BONDS, Device::kLinkKeyProperties);
+  ConfigCacheHelper helper = ConfigCacheHelper::FromConfigCache(*config);
+  std::vector<uint8_t> key(16, 0x5a);
+  std::string services;
+  for (uint16_t uuid : {0x1108, 0x110b, 0x110c, 0x110e, 0x111e, 0x1200,
+                        0x184e, 0x1800}) {
+    if (!services.empty()) services += " ";
+    services += Uuid::From16Bit(uuid).ToString();
+  }
+
+  for (int i = 0; i < NUM_BONDS; i++) {
+    std::string section =
+        RawAddress({0x00, 0x11, 0x22, 0x33, (uint8_t)(i >> 8),
+                    (uint8_t)(i & 0xff)})
+            .ToString();
+    int dev_type = 1 + i % 3;
+    config->SetProperty(section, "Name", "Device " + std::to_string(i));
+    if (i % 4 == 0) config->SetProperty(section, "Aliase", "My device");
+    helper.SetInt(section, "DevClass", 0x240404);
+    helper.SetInt(section, "DevType", dev_type);
+    helper.SetInt(section, "AddrType", 0);
+    config->SetProperty(section, "Service", services);
+    if (dev_type != 2) {
+      helper.SetBin(section, "LinkKey", key);
+      helper.SetInt(section, "LinkKeyType", 5);
+      helper.SetInt(section, "PinLength", 0);
+    }
+    if (dev_type != 1) {
+      for (const char* le_key : kLeKeys) {
+        helper.SetBin(section, le_key, std::vector<uint8_t>(28, 0xa5));
+      }
+    }
+    if (i % 10 == 0) {
+      for (const char* property : kProfileProperties) {
+        helper.SetInt(section, property, 1);
+      }
+      helper.SetBin(section, "HidDescriptor", std::vector<uint8_t>(100, 1));
+    }
+  }
+  return config;
+}
+
+class BM_BondedDeviceLoad : public ::benchmark::Fixture {
+ protected:
+  void SetUp(State& st) override {
+    ::benchmark::Fixture::SetUp(st);
+    config_ = GenerateConfig();
+  }
+
+  void TearDown(State& st) override {
+    config_.reset();
+    ::benchmark::Fixture::TearDown(st);
+  }
+
+  std::unique_ptr<ConfigCache> config_;
+};
+
+// What btif did before: every pass lists the bonded devices and then reads
+// each property it needs with its own lookup
+BENCHMARK_F(BM_BondedDeviceLoad, per_property_lookups)(State& state) {
+  ConfigCacheHelper helper = ConfigCacheHelper::FromConfigCache(*config_);
+  for (auto _ : state) {
+    for (int pass = 0; pass < kLoadPasses; pass++) {
+      for (const auto& section : config_->GetPersistentSections()) {
+        benchmark::DoNotOptimize(helper.GetBin(section, "LinkKey"));
+        benchmark::DoNotOptimize(helper.GetInt(section, "LinkKeyType"));
+        benchmark::DoNotOptimize(helper.GetInt(section, "DevType"));
+        benchmark::DoNotOptimize(config_->GetProperty(section, "Service"));
+        if (pass > 0) {
+          for (const char* property : kProfileProperties) {
+            benchmark::DoNotOptimize(helper.GetInt(section, property));
+          }
+          continue;
+        }
+        benchmark::DoNotOptimize(helper.GetInt(section, "DevClass"));
+        benchmark::DoNotOptimize(helper.GetInt(section, "PinLength"));
+        benchmark::DoNotOptimize(helper.GetInt(section, "AddrType"));
+        for (const char* le_key : kLeKeys) {
+          benchmark::DoNotOptimize(helper.GetBin(section, le_key));
+        }
+        benchmark::DoNotOptimize(config_->GetProperty(section, "Name"));
+        benchmark::DoNotOptimize(config_->GetProperty(section, "Aliase"));
+      }
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * NUM_BONDS);
+}
+
+// What btif does now: every pass copies all bonded sections at once and reads
+// the same properties from the parsed records
+BENCHMARK_F(BM_BondedDeviceLoad, records)(State& state) {
+  for (auto _ : state) {
+    for (int pass = 0; pass < kLoadPasses; pass++) {
+      std::vector<BtifBondedDeviceRecord> records;
+      for (auto& section : config_->GetPersistentSectionsWithProperties()) {
+        RawAddress address;
+        RawAddress::FromString(section.section, address);
+        records.emplace_back(address, std::move(section.properties));
+      }
+      for (const auto& record : records) {
+        if (pass > 0) {
+          for (const char* property : kProfileProperties) {
+            benchmark::DoNotOptimize(record.GetInt(property));
+          }
+          continue;
+        }
+        for (const char* le_key : kLeKeys) {
+          benchmark::DoNotOptimize(record.GetBin(le_key));
+        }
+        benchmark::DoNotOptimize(record.GetStr("Name"));
+        benchmark::DoNotOptimize(record.GetStr("Aliase"));
+      }
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * NUM_BONDS);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  // Disable LOG() output from libchrome
+  logging::LoggingSettings log_settings;
+  log_settings.logging_dest = logging::LoggingDestination::LOG_NONE;
+  CHECK(logging::InitLogging(log_settings)) << "Failed to set up logging";
+  ::benchmark::Initialize(&argc, argv);
+  if (::benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  ::benchmark::RunSpecifiedBenchmarks();
+}
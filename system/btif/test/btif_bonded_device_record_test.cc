@@ -0,0 +1,97 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "btif/include/btif_bonded_device_record.h"
+
+#include <gtest/gtest.h>
+
+using bluetooth::Uuid;
+
+namespace {
+
+const RawAddress kAddress({0x00, 0x11, 0x22, 0x33, 0x44, 0x55});
+
+}  // namespace
+
+TEST(BtifBondedDeviceRecordTest, parse_common_fields) {
+  BtifBondedDeviceRecord record(
+      kAddress, {
+                    {"LinkKey", "000102030405060708090a0b0c0d0e0f"},
+                    {"LinkKeyType", "5"},
+                    {"PinLength", "4"},
+                    {"DevClass", "2360344"},
+                    {"DevType", "3"},
+                    {"AddrType", "1"},
+                    {"Service",
+                     "0000110b-0000-1000-8000-00805f9b34fb "
+                     "0000184e-0000-1000-8000-00805f9b34fb"},
+                });
+
+  EXPECT_EQ(record.address(), kAddress);
+  ASSERT_TRUE(record.link_key());
+  EXPECT_EQ((*record.link_key())[0], 0x00);
+  EXPECT_EQ((*record.link_key())[15], 0x0f);
+  EXPECT_EQ(record.link_key_type(), 5);
+  EXPECT_EQ(record.pin_length(), 4);
+  EXPECT_EQ(record.dev_class(), 2360344u);
+  EXPECT_EQ(record.dev_type(), 3);
+  EXPECT_EQ(record.addr_type(), 1);
+  ASSERT_EQ(record.uuids().size(), 2u);
+  EXPECT_TRUE(record.HasUuid(Uuid::From16Bit(0x110b)));
+  EXPECT_TRUE(record.HasUuid(Uuid::FromString("184E")));
+  EXPECT_FALSE(record.HasUuid(Uuid::FromString("FDF0")));
+}
+
+TEST(BtifBondedDeviceRecordTest, link_key_needs_type) {
+  BtifBondedDeviceRecord record(
+      kAddress, {{"LinkKey", "000102030405060708090a0b0c0d0e0f"}});
+  EXPECT_FALSE(record.link_key());
+  EXPECT_EQ(record.pin_length(), 0);
+  EXPECT_FALSE(record.dev_type());
+  EXPECT_TRUE(record.uuids().empty());
+}
+
+TEST(BtifBondedDeviceRecordTest, uuids_stop_at_invalid_entry) {
+  BtifBondedDeviceRecord record(
+      kAddress, {{"Service",
+                  "0000110b-0000-1000-8000-00805f9b34fb invalid "
+                  "0000184e-0000-1000-8000-00805f9b34fb"}});
+  ASSERT_EQ(record.uuids().size(), 1u);
+  EXPECT_EQ(record.uuids()[0], Uuid::From16Bit(0x110b));
+}
+
+TEST(BtifBondedDeviceRecordTest, profile_properties) {
+  BtifBondedDeviceRecord record(kAddress,
+                                {
+                                    {"HidAttrMask", "1"},
+                                    {"HidDescriptor", "0506"},
+                                    {"HearingAidSyncId", "12345678901"},
+                                    {"Name", "Headset"},
+                                    {"Overflow", "4294967296"},
+                                    {"NotHex", "xyz"},
+                                });
+  EXPECT_TRUE(record.HasProperty("HidAttrMask"));
+  EXPECT_FALSE(record.HasProperty("HidSubClass"));
+  EXPECT_EQ(record.GetInt("HidAttrMask"), 1);
+  EXPECT_FALSE(record.GetInt("HidSubClass"));
+  EXPECT_FALSE(record.GetInt("Overflow"));
+  EXPECT_EQ(record.GetUint64("HearingAidSyncId"), 12345678901u);
+  EXPECT_EQ(record.GetBin("HidDescriptor"),
+            std::vector<uint8_t>({0x05, 0x06}));
+  EXPECT_FALSE(record.GetBin("NotHex"));
+  ASSERT_NE(record.GetStr("Name"), nullptr);
+  EXPECT_EQ(*record.GetStr("Name"), "Headset");
+}
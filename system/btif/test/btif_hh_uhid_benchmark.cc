@@ -0,0 +1,129 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <base/logging.h>
+#include <benchmark/benchmark.h>
+#include <linux/uhid.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstring>
+#include <thread>
+
+using ::benchmark::State;
+
+namespace {
+
+// Stands in for /dev/uhid: a datagram socket whose other end is drained by
+// a thread, so that every write is copied out like the kernel does
+class UhidStandIn {
+ public:
+  UhidStandIn() {
+    CHECK(socketpair(AF_UNIX, SOCK_SEQPACKET, 0, fds_) == 0);
+    reader_ = std::thread([this]() {
+      struct uhid_event ev;
+      while (read(fds_[1], &ev, sizeof(ev)) > 0) {
+      }
+    });
+  }
+
+  ~UhidStandIn() {
+    shutdown(fds_[0], SHUT_RDWR);
+    reader_.join();
+    close(fds_[0]);
+    close(fds_[1]);
+  }
+
+  int fd() const { return fds_[0]; }
+
+ private:
+  int fds_[2];
+  std::thread reader_;
+};
+
+// Generates input reports the way a gamepad does: the same layout with a
+// few bytes changing from one report to the next
+class ReportGenerator {
+ public:
+  explicit ReportGenerator(size_t size) : size_(size) {
+    memset(report_, 0, sizeof(report_));
+    report_[0] = 0x01;  // Report ID
+  }
+
+  const uint8_t* Next() {
+    counter_++;
+    report_[1] = counter_ & 0xff;
+    report_[size_ - 1] = counter_ >> 8;
+    return report_;
+  }
+
+  size_t size() const { return size_; }
+
+ private:
+  size_t size_;
+  uint32_t counter_ = 0;
+  uint8_t report_[UHID_DATA_MAX];
+};
+
+// How bta_hh_co_write() wrote input reports before: a cleared UHID_INPUT
+// event, written whole
+void BM_UhidInputFullEvent(State& state) {
+  UhidStandIn uhid;
+  ReportGenerator generator(state.range(0));
+  for (auto _ : state) {
+    struct uhid_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.type = UHID_INPUT;
+    ev.u.input.size = generator.size();
+    memcpy(ev.u.input.data, generator.Next(), generator.size());
+    benchmark::DoNotOptimize(write(uhid.fd(), &ev, sizeof(ev)));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_UhidInputFullEvent)->Arg(8)->Arg(64);
+
+// How bta_hh_co_write() writes input reports now: a UHID_INPUT2 event, of
+// which only the header and the report are written
+void BM_UhidInputReportOnly(State& state) {
+  UhidStandIn uhid;
+  ReportGenerator generator(state.range(0));
+  for (auto _ : state) {
+    struct uhid_event ev;
+    ev.type = UHID_INPUT2;
+    ev.u.input2.size = generator.size();
+    memcpy(ev.u.input2.data, generator.Next(), generator.size());
+    benchmark::DoNotOptimize(
+        write(uhid.fd(), &ev,
+              sizeof(ev.type) + sizeof(ev.u.input2.size) + generator.size()));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_UhidInputReportOnly)->Arg(8)->Arg(64);
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  // Disable LOG() output from libchrome
+  logging::LoggingSettings log_settings;
+  log_settings.logging_dest = logging::LoggingDestination::LOG_NONE;
+  CHECK(logging::InitLogging(log_settings)) << "Failed to set up logging";
+  ::benchmark::Initialize(&argc, argv);
+  if (::benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  ::benchmark::RunSpecifiedBenchmarks();
+}
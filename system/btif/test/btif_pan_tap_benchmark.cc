@@ -0,0 +1,211 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <arpa/inet.h>
+#include <base/logging.h>
+#include <benchmark/benchmark.h>
+#include <fcntl.h>
+#include <linux/if_ether.h>
+#include <linux/if_packet.h>
+#include <linux/if_tun.h>
+#include <net/if.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+using ::benchmark::State;
+
+namespace {
+
+constexpr char kTapName[] = "bt-pan-bench";
+
+// The buffers btif_pan reads frames into: PAN_BUF_SIZE, with the BT_HDR and
+// PAN_MINIMUM_OFFSET in front of the frame
+constexpr size_t kBufferSize = 4096 + 16;
+constexpr size_t kHeadroom = 8 + 15 + 13;
+
+constexpr int kFramesPerBatch = 64;
+constexpr size_t kEthHeaderSize = 14;
+constexpr size_t kPayloadSize = 1500;
+
+// A TAP device looped back through a packet socket bound to it: frames sent
+// on the packet socket are read from the TAP fd, like the frames the network
+// stack routes to bt-pan. Needs CAP_NET_ADMIN.
+class TapLoopback {
+ public:
+  ~TapLoopback() {
+    if (packet_fd_ >= 0) close(packet_fd_);
+    if (tap_fd_ >= 0) close(tap_fd_);
+  }
+
+  bool Open() {
+    tap_fd_ = open("/dev/tun", O_RDWR | O_NONBLOCK);
+    if (tap_fd_ < 0) tap_fd_ = open("/dev/net/tun", O_RDWR | O_NONBLOCK);
+    if (tap_fd_ < 0) return false;
+
+    struct ifreq ifr;
+    memset(&ifr, 0, sizeof(ifr));
+    ifr.ifr_flags = IFF_TAP | IFF_NO_PI;
+    strncpy(ifr.ifr_name, kTapName, IFNAMSIZ - 1);
+    if (ioctl(tap_fd_, TUNSETIFF, &ifr) < 0) return false;
+
+    packet_fd_ = socket(AF_PACKET, SOCK_RAW, htons(ETH_P_ALL));
+    if (packet_fd_ < 0) return false;
+    ifr.ifr_flags = IFF_UP;
+    if (ioctl(packet_fd_, SIOCSIFFLAGS, &ifr) < 0) return false;
+
+    struct sockaddr_ll addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sll_family = AF_PACKET;
+    addr.sll_protocol = htons(ETH_P_ALL);
+    addr.sll_ifindex = if_nametoindex(kTapName);
+    if (bind(packet_fd_, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+      return false;
+    }
+
+    // Unicast to a MAC that is not the TAP's, so that the kernel drops the
+    // frames written to the TAP fd without processing them further
+    memset(frame_, 0, sizeof(frame_));
+    const uint8_t dst[] = {0x02, 0x11, 0x22, 0x33, 0x44, 0x55};
+    const uint8_t src[] = {0x02, 0x66, 0x77, 0x88, 0x99, 0xaa};
+    memcpy(frame_, dst, sizeof(dst));
+    memcpy(frame_ + 6, src, sizeof(src));
+    frame_[12] = ETH_P_IP >> 8;
+    frame_[13] = ETH_P_IP & 0xff;
+    Drain();
+    return true;
+  }
+
+  // Queues |count| full size frames on the TAP fd
+  void Inject(int count) {
+    for (int i = 0; i < count; i++) {
+      send(packet_fd_, frame_, sizeof(frame_), 0);
+    }
+  }
+
+  void Drain() {
+    uint8_t buf[sizeof(frame_)];
+    while (read(tap_fd_, buf, sizeof(buf)) > 0) {
+    }
+  }
+
+  int tap_fd() const { return tap_fd_; }
+  const uint8_t* frame() const { return frame_; }
+
+ private:
+  int tap_fd_ = -1;
+  int packet_fd_ = -1;
+  uint8_t frame_[kEthHeaderSize + kPayloadSize];
+};
+
+// The TAP read loop before: read each frame into a staging buffer, copy it
+// into the buffer handed to BNEP, and poll() the fd to see if another frame
+// is queued
+void BM_TapUplinkPollPerFrame(State& state) {
+  TapLoopback tap;
+  if (!tap.Open()) {
+    state.SkipWithError("Unable to open a TAP device");
+    return;
+  }
+  uint8_t staging[1600];
+  int64_t frames = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    tap.Inject(kFramesPerBatch);
+    state.ResumeTiming();
+    for (;;) {
+      ssize_t ret = read(tap.tap_fd(), staging, sizeof(staging));
+      if (ret <= 0) break;
+      uint8_t* buffer = static_cast<uint8_t*>(malloc(kBufferSize));
+      memcpy(buffer + kHeadroom, staging, ret);
+      benchmark::DoNotOptimize(buffer);
+      free(buffer);
+      frames++;
+
+      struct pollfd ufd = {tap.tap_fd(), POLLIN, 0};
+      if (poll(&ufd, 1, 0) <= 0) break;
+    }
+  }
+  state.SetItemsProcessed(frames);
+}
+BENCHMARK(BM_TapUplinkPollPerFrame);
+
+// The TAP read loop now: read each frame straight into the buffer handed to
+// BNEP, until the non blocking fd runs dry
+void BM_TapUplinkReadUntilEagain(State& state) {
+  TapLoopback tap;
+  if (!tap.Open()) {
+    state.SkipWithError("Unable to open a TAP device");
+    return;
+  }
+  int64_t frames = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    tap.Inject(kFramesPerBatch);
+    state.ResumeTiming();
+    for (;;) {
+      uint8_t* buffer = static_cast<uint8_t*>(malloc(kBufferSize));
+      ssize_t ret =
+          read(tap.tap_fd(), buffer + kHeadroom, kBufferSize - kHeadroom);
+      benchmark::DoNotOptimize(buffer);
+      free(buffer);
+      if (ret <= 0) break;
+      frames++;
+    }
+  }
+  state.SetItemsProcessed(frames);
+}
+BENCHMARK(BM_TapUplinkReadUntilEagain);
+
+// Writing frames received over BNEP, each built in a staging buffer
+void BM_TapDownlink(State& state) {
+  TapLoopback tap;
+  if (!tap.Open()) {
+    state.SkipWithError("Unable to open a TAP device");
+    return;
+  }
+  const uint8_t* payload = tap.frame() + kEthHeaderSize;
+  for (auto _ : state) {
+    for (int i = 0; i < kFramesPerBatch; i++) {
+      uint8_t packet[2000 + kEthHeaderSize];
+      memcpy(packet, tap.frame(), kEthHeaderSize);
+      memcpy(packet + kEthHeaderSize, payload, kPayloadSize);
+      benchmark::DoNotOptimize(
+          write(tap.tap_fd(), packet, kEthHeaderSize + kPayloadSize));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kFramesPerBatch);
+}
+BENCHMARK(BM_TapDownlink);
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  // Disable LOG() output from libchrome
+  logging::LoggingSettings log_settings;
+  log_settings.logging_dest = logging::LoggingDestination::LOG_NONE;
+  CHECK(logging::InitLogging(log_settings)) << "Failed to set up logging";
+  ::benchmark::Initialize(&argc, argv);
+  if (::benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  ::benchmark::RunSpecifiedBenchmarks();
+}
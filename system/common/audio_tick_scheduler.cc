@@ -0,0 +1,353 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "audio_tick_scheduler.h"
+
+#include "message_loop_thread.h"
+#include "time_util.h"
+
+#include <base/callback.h>
+#include <base/logging.h>
+#include <sys/prctl.h>
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <sstream>
+
+namespace bluetooth {
+
+namespace common {
+
+#if BASE_VER < 931007
+constexpr base::TimeDelta kMinimumPeriod = base::TimeDelta::FromMicroseconds(1);
+#else
+constexpr base::TimeDelta kMinimumPeriod = base::Microseconds(1);
+#endif
+
+constexpr uint64_t AudioTickStats::kLatenessBucketUpperUs[];
+
+AudioTickTimeline::AudioTickTimeline(uint64_t period_us,
+                                     size_t max_catch_up_ticks,
+                                     bool follow_reference)
+    : nominal_period_ns_(period_us * 1000),
+      period_ns_(period_us * 1000),
+      max_catch_up_ticks_(max_catch_up_ticks),
+      follow_reference_(follow_reference) {}
+
+void AudioTickTimeline::Start(uint64_t now_us) {
+  period_ns_ = nominal_period_ns_;
+  next_deadline_ns_ = now_us * 1000 + period_ns_;
+  last_lateness_us_ = 0;
+  stats_ = {};
+  ResetDrift();
+}
+
+bool AudioTickTimeline::NextTick(uint64_t now_us, AudioTick* tick) {
+  uint64_t now_ns = now_us * 1000;
+  if (now_ns < next_deadline_ns_) return false;
+
+  // Deadlines after this one which are already due as well
+  uint64_t overdue = (now_ns - next_deadline_ns_) / period_ns_;
+  if (overdue > max_catch_up_ticks_) {
+    uint64_t dropped = overdue - max_catch_up_ticks_;
+    next_deadline_ns_ += dropped * period_ns_;
+    stats_.dropped_ticks += dropped;
+    stats_.resyncs++;
+    overdue = max_catch_up_ticks_;
+  }
+
+  tick->deadline_us = next_deadline_ns_ / 1000;
+  tick->lateness_us = now_us - tick->deadline_us;
+  tick->catch_up = overdue > 0;
+  next_deadline_ns_ += period_ns_;
+
+  stats_.ticks++;
+  if (tick->catch_up) stats_.catch_up_ticks++;
+  RecordLateness(tick->lateness_us);
+  return true;
+}
+
+void AudioTickTimeline::RecordLateness(uint64_t lateness_us) {
+  size_t bucket = 0;
+  while (bucket < AudioTickStats::kNumLatenessBuckets - 1 &&
+         lateness_us >= AudioTickStats::kLatenessBucketUpperUs[bucket]) {
+    bucket++;
+  }
+  stats_.lateness_histogram[bucket]++;
+  stats_.max_lateness_us = std::max(stats_.max_lateness_us, lateness_us);
+
+  if (stats_.ticks > 1) {
+    double variation = std::abs(static_cast<double>(lateness_us) -
+                                static_cast<double>(last_lateness_us_));
+    stats_.jitter_us += (variation - stats_.jitter_us) / 16;
+  }
+  last_lateness_us_ = lateness_us;
+}
+
+void AudioTickTimeline::ResetDrift() {
+  has_reference_ = false;
+  has_first_window_ = false;
+  stats_.drift_ppm = 0;
+  period_ns_ = nominal_period_ns_;
+}
+
+void AudioTickTimeline::OnReferenceTimestamp(uint64_t now_us,
+                                             uint32_t reference_us) {
+  stats_.reference_samples++;
+  if (!has_reference_) {
+    has_reference_ = true;
+    reference_anchor_local_us_ = now_us;
+    last_reference_us_ = reference_us;
+    reference_elapsed_us_ = 0;
+    window_end_us_ = kDriftWindowUs;
+    window_min_offset_us_ = std::numeric_limits<int64_t>::max();
+    return;
+  }
+
+  // Unsigned difference, to go over the wrap around of the reference
+  reference_elapsed_us_ +=
+      static_cast<uint32_t>(reference_us - last_reference_us_);
+  last_reference_us_ = reference_us;
+
+  int64_t offset_us =
+      static_cast<int64_t>(now_us - reference_anchor_local_us_) -
+      static_cast<int64_t>(reference_elapsed_us_);
+  if (offset_us < window_min_offset_us_) {
+    window_min_offset_us_ = offset_us;
+    window_min_reference_us_ = reference_elapsed_us_;
+  }
+  if (reference_elapsed_us_ < window_end_us_) return;
+
+  int64_t min_offset_us = window_min_offset_us_;
+  uint64_t min_reference_us = window_min_reference_us_;
+  window_end_us_ = reference_elapsed_us_ + kDriftWindowUs;
+  window_min_offset_us_ = std::numeric_limits<int64_t>::max();
+
+  if (!has_first_window_) {
+    has_first_window_ = true;
+    first_min_offset_us_ = min_offset_us;
+    first_min_reference_us_ = min_reference_us;
+    return;
+  }
+  if (min_reference_us <= first_min_reference_us_) return;
+
+  double drift_ppm = (min_offset_us - first_min_offset_us_) * 1e6 /
+                     (min_reference_us - first_min_reference_us_);
+  if (std::abs(drift_ppm) > kMaxDriftPpm) {
+    LOG(WARNING) << __func__ << ": reference clock jumped, drift "
+                 << drift_ppm << " ppm, restarting the estimation";
+    ResetDrift();
+    return;
+  }
+
+  stats_.drift_ppm = drift_ppm;
+  if (follow_reference_) {
+    period_ns_ = std::llround(nominal_period_ns_ * (1 + drift_ppm / 1e6));
+  }
+}
+
+static void SetTimerSlack(uint64_t timer_slack_ns) {
+  if (prctl(PR_SET_TIMERSLACK, timer_slack_ns) != 0) {
+    LOG(ERROR) << __func__ << ": unable to set timer slack to "
+               << timer_slack_ns << " ns, error: " << strerror(errno);
+  }
+}
+
+// This runs on user thread
+AudioTickScheduler::~AudioTickScheduler() {
+  std::lock_guard<std::recursive_mutex> api_lock(api_mutex_);
+  if (message_loop_thread_ != nullptr && message_loop_thread_->IsRunning()) {
+    CancelAndWait();
+  }
+}
+
+// This runs on user thread
+bool AudioTickScheduler::Start(const base::WeakPtr<MessageLoopThread>& thread,
+                               const base::Location& from_here, Task task,
+                               base::TimeDelta period,
+                               const Options& options) {
+  if (period < kMinimumPeriod) {
+    LOG(ERROR) << __func__ << ": period must be at least " << kMinimumPeriod;
+    return false;
+  }
+
+  std::lock_guard<std::recursive_mutex> api_lock(api_mutex_);
+  if (thread == nullptr) {
+    LOG(ERROR) << __func__ << ": thread must be non-null";
+    return false;
+  }
+  CancelAndWait();
+
+  if (options.real_time && !thread->EnableRealTimeScheduling()) {
+    LOG(WARNING) << __func__ << ": running ticks without real time priority";
+  }
+  if (options.timer_slack_ns != 0) {
+    thread->DoInThread(FROM_HERE,
+                       base::BindOnce(&SetTimerSlack, options.timer_slack_ns));
+  }
+
+  {
+    std::lock_guard<std::mutex> timeline_lock(timeline_mutex_);
+    timeline_ = AudioTickTimeline(period.InMicroseconds(),
+                                  options.max_catch_up_ticks,
+                                  options.follow_reference);
+    timeline_.Start(time_get_os_monotonic_us());
+  }
+  task_ = std::move(task);
+  task_wrapper_.Reset(
+      base::Bind(&AudioTickScheduler::RunTask, base::Unretained(this)));
+  message_loop_thread_ = thread;
+  if (!ScheduleNextTick(from_here)) {
+    LOG(ERROR) << __func__
+               << ": failed to post task to message loop for thread " << *thread
+               << ", from " << from_here.ToString();
+    task_wrapper_.Cancel();
+    message_loop_thread_ = nullptr;
+    return false;
+  }
+  return true;
+}
+
+// This runs on user thread
+void AudioTickScheduler::Cancel() {
+  std::promise<void> promise;
+  CancelHelper(std::move(promise));
+}
+
+// This runs on user thread
+void AudioTickScheduler::CancelAndWait() {
+  std::promise<void> promise;
+  auto future = promise.get_future();
+  CancelHelper(std::move(promise));
+  future.wait();
+}
+
+// This runs on user thread
+void AudioTickScheduler::CancelHelper(std::promise<void> promise) {
+  std::lock_guard<std::recursive_mutex> api_lock(api_mutex_);
+  MessageLoopThread* scheduled_thread = message_loop_thread_.get();
+  if (scheduled_thread == nullptr) {
+    promise.set_value();
+    return;
+  }
+  if (scheduled_thread->GetThreadId() == base::PlatformThread::CurrentId()) {
+    CancelClosure(std::move(promise));
+    return;
+  }
+  scheduled_thread->DoInThread(
+      FROM_HERE, base::BindOnce(&AudioTickScheduler::CancelClosure,
+                                base::Unretained(this), std::move(promise)));
+}
+
+// This runs on message loop thread
+void AudioTickScheduler::CancelClosure(std::promise<void> promise) {
+  message_loop_thread_ = nullptr;
+  task_wrapper_.Cancel();
+#if BASE_VER < 927031
+  task_ = {};
+#else
+  task_ = base::NullCallback();
+#endif
+  promise.set_value();
+}
+
+// This runs on user thread
+bool AudioTickScheduler::IsScheduled() const {
+  std::lock_guard<std::recursive_mutex> api_lock(api_mutex_);
+  return message_loop_thread_ != nullptr && message_loop_thread_->IsRunning();
+}
+
+// This runs on any thread
+void AudioTickScheduler::OnReferenceTimestamp(uint32_t reference_us) {
+  uint64_t now_us = time_get_os_monotonic_us();
+  std::lock_guard<std::mutex> timeline_lock(timeline_mutex_);
+  timeline_.OnReferenceTimestamp(now_us, reference_us);
+}
+
+// This runs on any thread
+AudioTickStats AudioTickScheduler::GetStats() const {
+  std::lock_guard<std::mutex> timeline_lock(timeline_mutex_);
+  return timeline_.GetStats();
+}
+
+void AudioTickScheduler::DebugDump(int fd) const {
+  AudioTickStats stats = GetStats();
+  std::stringstream stream;
+  stream << "    Audio ticks (total / catch up / dropped)                : "
+         << stats.ticks << " / " << stats.catch_up_ticks << " / "
+         << stats.dropped_ticks
+         << "\n    Audio tick resyncs                                      : "
+         << stats.resyncs
+         << "\n    Audio tick lateness in us (max / jitter)                : "
+         << stats.max_lateness_us << " / " << std::llround(stats.jitter_us)
+         << "\n    Audio tick lateness histogram (<250us .. >=5ms)         : ";
+  for (size_t i = 0; i < AudioTickStats::kNumLatenessBuckets; i++) {
+    stream << (i ? " / " : "") << stats.lateness_histogram[i];
+  }
+  stream << "\n    Audio clock drift in ppm (reference samples)            : "
+         << stats.drift_ppm << " (" << stats.reference_samples << ")"
+         << std::endl;
+  dprintf(fd, "%s", stream.str().c_str());
+}
+
+bool AudioTickScheduler::ScheduleNextTick(const base::Location& from_here) {
+  uint64_t deadline_us;
+  {
+    std::lock_guard<std::mutex> timeline_lock(timeline_mutex_);
+    deadline_us = timeline_.NextDeadlineUs();
+  }
+  uint64_t now_us = time_get_os_monotonic_us();
+  int64_t delay_us = deadline_us > now_us ? deadline_us - now_us : 0;
+  return message_loop_thread_->DoInThreadDelayed(
+      from_here, task_wrapper_.callback(),
+#if BASE_VER < 931007
+      base::TimeDelta::FromMicroseconds(delay_us));
+#else
+      base::Microseconds(delay_us));
+#endif
+}
+
+// This runs on message loop thread
+void AudioTickScheduler::RunTask() {
+  if (message_loop_thread_ == nullptr || !message_loop_thread_->IsRunning()) {
+    LOG(ERROR) << __func__
+               << ": message_loop_thread_ is null or is not running";
+    return;
+  }
+  CHECK_EQ(message_loop_thread_->GetThreadId(),
+           base::PlatformThread::CurrentId())
+      << ": task must run on message loop thread";
+
+  // Ticks due by the wake up run back to back, each handling one period
+  uint64_t now_us = time_get_os_monotonic_us();
+  AudioTick tick;
+  while (true) {
+    {
+      std::lock_guard<std::mutex> timeline_lock(timeline_mutex_);
+      if (!timeline_.NextTick(now_us, &tick)) break;
+    }
+    task_.Run(tick);
+    // The task cancelled the ticks
+    if (message_loop_thread_ == nullptr) return;
+  }
+
+  ScheduleNextTick(FROM_HERE);
+}
+
+}  // namespace common
+
+}  // namespace bluetooth
@@ -0,0 +1,246 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <base/bind.h>
+#include <base/cancelable_callback.h>
+#include <base/location.h>
+#include <base/time/time.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <mutex>
+
+namespace bluetooth {
+
+namespace common {
+
+class MessageLoopThread;
+
+/**
+ * One tick of an audio source: the encoder handles exactly one period of
+ * audio for each of them, however late it runs.
+ */
+struct AudioTick {
+  // CLOCK_MONOTONIC time the tick was due at
+  uint64_t deadline_us;
+  // How long after its deadline the tick runs
+  uint64_t lateness_us;
+  // The tick was missed by a late wake up, and runs back to back with the
+  // next one
+  bool catch_up;
+};
+
+struct AudioTickStats {
+  static constexpr size_t kNumLatenessBuckets = 6;
+  // Upper bounds of the lateness histogram buckets, the last one is open
+  static constexpr uint64_t kLatenessBucketUpperUs[kNumLatenessBuckets - 1] = {
+      250, 500, 1000, 2000, 5000};
+
+  uint64_t ticks = 0;
+  uint64_t catch_up_ticks = 0;
+  // Ticks never run as more were missed than could be caught up with
+  uint64_t dropped_ticks = 0;
+  uint64_t resyncs = 0;
+  uint64_t lateness_histogram[kNumLatenessBuckets] = {};
+  uint64_t max_lateness_us = 0;
+  // Smoothed variation of the lateness from one tick to the next, computed
+  // as the RFC 3550 interarrival jitter
+  double jitter_us = 0;
+  // Rate of the local clock against the reference clock: positive when the
+  // local clock runs fast
+  double drift_ppm = 0;
+  uint64_t reference_samples = 0;
+};
+
+/**
+ * Timing of the ticks of an audio source, without the thread running them.
+ *
+ * Deadlines sit on a grid anchored when the timeline starts, so lateness of
+ * a tick never accumulates into the following ones. Ticks missed by a late
+ * wake up are caught up with back to back, up to a limit beyond which they
+ * are dropped and the grid skips ahead.
+ *
+ * When fed timestamps of a reference clock, such as the SDU timestamps of
+ * the controller, the timeline estimates the drift of the local clock
+ * against it and can stretch its period to tick at the reference rate.
+ */
+class AudioTickTimeline {
+ public:
+  // Drift beyond which the reference is considered to have jumped, and the
+  // estimation restarts
+  static constexpr double kMaxDriftPpm = 500;
+  // Reference clock time over which the offset to the local clock is
+  // measured. Timestamps only reach the host late, never early, so the
+  // smallest offset of each window is the one kept.
+  static constexpr uint64_t kDriftWindowUs = 1000000;
+
+  AudioTickTimeline(uint64_t period_us, size_t max_catch_up_ticks,
+                    bool follow_reference);
+
+  /**
+   * Anchors the first deadline one period after now_us
+   */
+  void Start(uint64_t now_us);
+
+  /**
+   * Pops the oldest tick due at now_us into tick.
+   *
+   * @param now_us time the ticks are run at
+   * @param tick tick to run
+   * @return true iff a tick is due, false when the next deadline is after
+   * now_us
+   */
+  bool NextTick(uint64_t now_us, AudioTick* tick);
+
+  /**
+   * Returns the deadline of the next tick
+   */
+  uint64_t NextDeadlineUs() const { return next_deadline_ns_ / 1000; }
+
+  /**
+   * Feeds the timestamp of the reference clock taken at local time now_us.
+   * The reference is a 32 bit microsecond counter that wraps around.
+   */
+  void OnReferenceTimestamp(uint64_t now_us, uint32_t reference_us);
+
+  const AudioTickStats& GetStats() const { return stats_; }
+
+ private:
+  void RecordLateness(uint64_t lateness_us);
+  void ResetDrift();
+
+  uint64_t nominal_period_ns_;
+  uint64_t period_ns_;
+  size_t max_catch_up_ticks_;
+  bool follow_reference_;
+  uint64_t next_deadline_ns_ = 0;
+  uint64_t last_lateness_us_ = 0;
+
+  bool has_reference_ = false;
+  uint64_t reference_anchor_local_us_ = 0;
+  uint32_t last_reference_us_ = 0;
+  uint64_t reference_elapsed_us_ = 0;
+  uint64_t window_end_us_ = 0;
+  int64_t window_min_offset_us_ = 0;
+  uint64_t window_min_reference_us_ = 0;
+  bool has_first_window_ = false;
+  int64_t first_min_offset_us_ = 0;
+  uint64_t first_min_reference_us_ = 0;
+
+  AudioTickStats stats_;
+};
+
+/**
+ * Runs the ticks of an audio source on a MessageLoopThread, against absolute
+ * CLOCK_MONOTONIC deadlines rather than a fixed delay from one tick to the
+ * next. See AudioTickTimeline for how late ticks are handled.
+ *
+ * Warning: MessageLoopThread must be running when any task is scheduled or
+ * being executed
+ */
+class AudioTickScheduler final {
+ public:
+  using Task = base::RepeatingCallback<void(const AudioTick&)>;
+
+  struct Options {
+    // Run the thread with SCHED_FIFO priority
+    bool real_time = false;
+    // Timer slack of the thread in nanoseconds, 0 to leave it as is
+    uint64_t timer_slack_ns = 0;
+    // Missed ticks run back to back after a late wake up, before the
+    // remaining ones are dropped
+    size_t max_catch_up_ticks = 2;
+    // Stretch the period to tick at the rate of the reference clock
+    bool follow_reference = false;
+  };
+
+  // Timer slack for audio threads: the kernel default, which threads of a
+  // background process otherwise get raised well beyond a tick period
+  static constexpr uint64_t kAudioTimerSlackNs = 50000;
+
+  AudioTickScheduler() = default;
+  AudioTickScheduler(const AudioTickScheduler&) = delete;
+  AudioTickScheduler& operator=(const AudioTickScheduler&) = delete;
+
+  ~AudioTickScheduler();
+
+  /**
+   * Start running task each period on the MessageLoopThread. Only one task
+   * can be scheduled at a time. If another task is scheduled, it will cancel
+   * the previous task synchronously; this blocks until the previous task is
+   * cancelled. Statistics of the previous task are reset.
+   *
+   * @param thread thread to run the task
+   * @param from_here location where this task is originated
+   * @param task task created through base::Bind(), run for each tick
+   * @param period period of the ticks
+   * @param options scheduling options of the thread and ticks
+   * @return true iff task is scheduled successfully
+   */
+  bool Start(const base::WeakPtr<MessageLoopThread>& thread,
+             const base::Location& from_here, Task task,
+             base::TimeDelta period, const Options& options);
+
+  /**
+   * Post an event which cancels the current task asynchronously
+   */
+  void Cancel();
+
+  /**
+   * Post an event which cancels the current task and wait for the cancellation
+   * to be completed
+   */
+  void CancelAndWait();
+
+  /**
+   * Returns true when there is a pending task scheduled on a running thread,
+   * otherwise false.
+   */
+  bool IsScheduled() const;
+
+  /**
+   * Feeds a timestamp of the reference clock, in microseconds, taken now.
+   * Can be called from any thread.
+   */
+  void OnReferenceTimestamp(uint32_t reference_us);
+
+  /**
+   * Returns the statistics of the current or last scheduled task
+   */
+  AudioTickStats GetStats() const;
+
+  void DebugDump(int fd) const;
+
+ private:
+  base::WeakPtr<MessageLoopThread> message_loop_thread_;
+  base::CancelableClosure task_wrapper_;
+  Task task_;
+  AudioTickTimeline timeline_{1, 0, false};
+  mutable std::mutex timeline_mutex_;
+  mutable std::recursive_mutex api_mutex_;
+  void CancelHelper(std::promise<void> promise);
+  void CancelClosure(std::promise<void> promise);
+  bool ScheduleNextTick(const base::Location& from_here);
+
+  void RunTask();
+};
+
+}  // namespace common
+
+}  // namespace bluetooth
@@ -0,0 +1,267 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <base/bind.h>
+#include <base/logging.h>
+#include <gtest/gtest.h>
+
+#include <future>
+#include <vector>
+
+#include "audio_tick_scheduler.h"
+#include "message_loop_thread.h"
+
+using bluetooth::common::AudioTick;
+using bluetooth::common::AudioTickScheduler;
+using bluetooth::common::AudioTickStats;
+using bluetooth::common::AudioTickTimeline;
+using bluetooth::common::MessageLoopThread;
+
+namespace {
+
+constexpr uint64_t kStartUs = 1000000;
+constexpr uint64_t kPeriodUs = 10000;
+
+std::vector<AudioTick> RunDueTicks(AudioTickTimeline* timeline,
+                                   uint64_t now_us) {
+  std::vector<AudioTick> ticks;
+  AudioTick tick;
+  while (timeline->NextTick(now_us, &tick)) ticks.push_back(tick);
+  return ticks;
+}
+
+}  // namespace
+
+TEST(AudioTickTimelineTest, no_tick_before_deadline) {
+  AudioTickTimeline timeline(kPeriodUs, 2, false);
+  timeline.Start(kStartUs);
+
+  EXPECT_EQ(timeline.NextDeadlineUs(), kStartUs + kPeriodUs);
+  EXPECT_TRUE(RunDueTicks(&timeline, kStartUs + kPeriodUs - 1).empty());
+}
+
+TEST(AudioTickTimelineTest, lateness_does_not_accumulate) {
+  AudioTickTimeline timeline(kPeriodUs, 2, false);
+  timeline.Start(kStartUs);
+
+  // Each wake up is 700 us late, deadlines stay on the grid nonetheless
+  for (uint64_t i = 1; i <= 100; i++) {
+    auto ticks = RunDueTicks(&timeline, kStartUs + i * kPeriodUs + 700);
+    ASSERT_EQ(ticks.size(), 1u);
+    EXPECT_EQ(ticks[0].deadline_us, kStartUs + i * kPeriodUs);
+    EXPECT_EQ(ticks[0].lateness_us, 700u);
+    EXPECT_FALSE(ticks[0].catch_up);
+  }
+
+  const AudioTickStats& stats = timeline.GetStats();
+  EXPECT_EQ(stats.ticks, 100u);
+  EXPECT_EQ(stats.catch_up_ticks, 0u);
+  EXPECT_EQ(stats.max_lateness_us, 700u);
+  EXPECT_EQ(stats.lateness_histogram[2], 100u);
+  EXPECT_DOUBLE_EQ(stats.jitter_us, 0);
+}
+
+TEST(AudioTickTimelineTest, late_wake_up_catches_up) {
+  AudioTickTimeline timeline(kPeriodUs, 2, false);
+  timeline.Start(kStartUs);
+
+  // Woken up after the second deadline: both ticks run, the missed one first
+  auto ticks = RunDueTicks(&timeline, kStartUs + 2 * kPeriodUs + 100);
+  ASSERT_EQ(ticks.size(), 2u);
+  EXPECT_EQ(ticks[0].deadline_us, kStartUs + kPeriodUs);
+  EXPECT_TRUE(ticks[0].catch_up);
+  EXPECT_EQ(ticks[1].deadline_us, kStartUs + 2 * kPeriodUs);
+  EXPECT_FALSE(ticks[1].catch_up);
+  EXPECT_EQ(timeline.NextDeadlineUs(), kStartUs + 3 * kPeriodUs);
+
+  const AudioTickStats& stats = timeline.GetStats();
+  EXPECT_EQ(stats.catch_up_ticks, 1u);
+  EXPECT_EQ(stats.dropped_ticks, 0u);
+  EXPECT_EQ(stats.resyncs, 0u);
+}
+
+TEST(AudioTickTimelineTest, stall_drops_ticks_beyond_catch_up) {
+  AudioTickTimeline timeline(kPeriodUs, 2, false);
+  timeline.Start(kStartUs);
+
+  // Ten deadlines missed: the last three run, on the grid
+  auto ticks = RunDueTicks(&timeline, kStartUs + 10 * kPeriodUs + 100);
+  ASSERT_EQ(ticks.size(), 3u);
+  EXPECT_EQ(ticks[0].deadline_us, kStartUs + 8 * kPeriodUs);
+  EXPECT_EQ(ticks[2].deadline_us, kStartUs + 10 * kPeriodUs);
+  EXPECT_EQ(timeline.NextDeadlineUs(), kStartUs + 11 * kPeriodUs);
+
+  const AudioTickStats& stats = timeline.GetStats();
+  EXPECT_EQ(stats.ticks, 3u);
+  EXPECT_EQ(stats.catch_up_ticks, 2u);
+  EXPECT_EQ(stats.dropped_ticks, 7u);
+  EXPECT_EQ(stats.resyncs, 1u);
+  EXPECT_EQ(stats.lateness_histogram[AudioTickStats::kNumLatenessBuckets - 1],
+            2u);
+}
+
+TEST(AudioTickTimelineTest, jitter_follows_lateness_variation) {
+  AudioTickTimeline timeline(kPeriodUs, 2, false);
+  timeline.Start(kStartUs);
+
+  for (uint64_t i = 1; i <= 200; i++) {
+    RunDueTicks(&timeline, kStartUs + i * kPeriodUs + (i % 2 ? 0 : 400));
+  }
+
+  const AudioTickStats& stats = timeline.GetStats();
+  EXPECT_NEAR(stats.jitter_us, 400, 1);
+  EXPECT_EQ(stats.max_lateness_us, 400u);
+}
+
+TEST(AudioTickTimelineTest, drift_against_reference) {
+  AudioTickTimeline timeline(kPeriodUs, 2, true);
+  timeline.Start(kStartUs);
+
+  // The local clock runs 100 ppm fast: 10001 us elapse for each SDU interval
+  // of the reference, which wraps around. Timestamps reach the host up to
+  // 3 ms late.
+  uint32_t reference_us = UINT32_MAX - 5 * kPeriodUs;
+  uint64_t now_us = kStartUs;
+  for (int i = 0; i < 1000; i++) {
+    timeline.OnReferenceTimestamp(now_us + (i * 7919) % 3000, reference_us);
+    reference_us += kPeriodUs;
+    now_us += kPeriodUs + 1;
+  }
+
+  const AudioTickStats& stats = timeline.GetStats();
+  EXPECT_NEAR(stats.drift_ppm, 100, 10);
+  EXPECT_EQ(stats.reference_samples, 1000u);
+
+  // The period is stretched to tick at the reference rate
+  uint64_t deadline_us = timeline.NextDeadlineUs();
+  RunDueTicks(&timeline, deadline_us);
+  EXPECT_NEAR(timeline.NextDeadlineUs() - deadline_us, kPeriodUs + 1, 1);
+}
+
+TEST(AudioTickTimelineTest, reference_jump_restarts_drift_estimation) {
+  AudioTickTimeline timeline(kPeriodUs, 2, true);
+  timeline.Start(kStartUs);
+
+  uint32_t reference_us = 0;
+  uint64_t now_us = kStartUs;
+  for (int i = 0; i < 300; i++) {
+    timeline.OnReferenceTimestamp(now_us, reference_us);
+    reference_us += kPeriodUs;
+    now_us += kPeriodUs;
+    // The reference restarts from scratch, as if the stream was set up again
+    if (i == 150) reference_us = 0;
+  }
+
+  EXPECT_DOUBLE_EQ(timeline.GetStats().drift_ppm, 0);
+  uint64_t deadline_us = timeline.NextDeadlineUs();
+  RunDueTicks(&timeline, deadline_us);
+  EXPECT_EQ(timeline.NextDeadlineUs() - deadline_us, kPeriodUs);
+}
+
+class AudioTickSchedulerTest : public ::testing::Test {
+ public:
+  void CountTicks(size_t num_ticks, std::promise<void>* promise,
+                  const AudioTick& tick) {
+    ticks_.push_back(tick);
+    if (ticks_.size() == num_ticks) promise->set_value();
+  }
+
+  void CancelOnTick(std::promise<void>* promise, const AudioTick& tick) {
+    ticks_.push_back(tick);
+    scheduler_.CancelAndWait();
+    promise->set_value();
+  }
+
+  void ShouldNotHappen(const AudioTick& tick) { FAIL() << "Should not happen"; }
+
+ protected:
+  AudioTickScheduler scheduler_;
+  std::vector<AudioTick> ticks_;
+};
+
+TEST_F(AudioTickSchedulerTest, initial_is_not_scheduled) {
+  ASSERT_FALSE(scheduler_.IsScheduled());
+}
+
+TEST_F(AudioTickSchedulerTest, periodic_run) {
+  MessageLoopThread message_loop_thread("test_thread");
+  message_loop_thread.StartUp();
+  std::promise<void> promise;
+  auto future = promise.get_future();
+  size_t num_ticks = 100;
+  int64_t period_us = 5000;
+
+  ASSERT_TRUE(scheduler_.Start(
+      message_loop_thread.GetWeakPtr(), FROM_HERE,
+      base::BindRepeating(&AudioTickSchedulerTest::CountTicks,
+                          base::Unretained(this), num_ticks, &promise),
+#if BASE_VER < 931007
+      base::TimeDelta::FromMicroseconds(period_us),
+#else
+      base::Microseconds(period_us),
+#endif
+      {.timer_slack_ns = AudioTickScheduler::kAudioTimerSlackNs}));
+  future.get();
+  scheduler_.CancelAndWait();
+
+  // Deadlines are a period apart, however late each tick ran
+  for (size_t i = 1; i < num_ticks; i++) {
+    EXPECT_EQ(ticks_[i].deadline_us - ticks_[i - 1].deadline_us,
+              (uint64_t)period_us);
+  }
+  EXPECT_GE(scheduler_.GetStats().ticks, num_ticks);
+  EXPECT_FALSE(scheduler_.IsScheduled());
+}
+
+TEST_F(AudioTickSchedulerTest, cancel_from_task) {
+  MessageLoopThread message_loop_thread("test_thread");
+  message_loop_thread.StartUp();
+  std::promise<void> promise;
+  auto future = promise.get_future();
+
+  ASSERT_TRUE(scheduler_.Start(
+      message_loop_thread.GetWeakPtr(), FROM_HERE,
+      base::BindRepeating(&AudioTickSchedulerTest::CancelOnTick,
+                          base::Unretained(this), &promise),
+#if BASE_VER < 931007
+      base::TimeDelta::FromMilliseconds(5),
+#else
+      base::Milliseconds(5),
+#endif
+      {}));
+  future.get();
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+  EXPECT_EQ(ticks_.size(), 1u);
+  EXPECT_FALSE(scheduler_.IsScheduled());
+}
+
+TEST_F(AudioTickSchedulerTest, zero_period_is_rejected) {
+  MessageLoopThread message_loop_thread("test_thread");
+  message_loop_thread.StartUp();
+
+  ASSERT_FALSE(scheduler_.Start(
+      message_loop_thread.GetWeakPtr(), FROM_HERE,
+      base::BindRepeating(&AudioTickSchedulerTest::ShouldNotHappen,
+                          base::Unretained(this)),
+#if BASE_VER < 931007
+      base::TimeDelta::FromMilliseconds(0),
+#else
+      base::Milliseconds(0),
+#endif
+      {}));
+  EXPECT_FALSE(scheduler_.IsScheduled());
+}
@@ -19,9 +19,12 @@
 #include <base/run_loop.h>
 #include <base/threading/thread.h>
 #include <benchmark/benchmark.h>
+#include <atomic>
+#include <chrono>
 #include <future>
 #include <memory>
 #include <thread>
+#include <vector>
 
 #include "abstract_message_loop.h"
 #include "common/message_loop_thread.h"
@@ -32,6 +35,7 @@ using ::benchmark::State;
 using bluetooth::common::MessageLoopThread;
 
 #define NUM_MESSAGES_TO_SEND 100000
+#define NUM_PRODUCERS 4
 
 volatile static int g_counter = 0;
 static std::unique_ptr<std::promise<void>> g_counter_promise = nullptr;
@@ -371,6 +375,128 @@ BENCHMARK_F(BM_MessageLooopThread, sequential_execution)(State& state) {
   }
 };
 
+void callback_multi_producer(void* context) {
+  // Producers increment concurrently to the thread running the tasks
+  if (++(*static_cast<std::atomic<int>*>(context)) >= NUM_MESSAGES_TO_SEND) {
+    g_counter_promise->set_value();
+  }
+}
+
+void callback_wakeup(std::chrono::steady_clock::time_point posted_at,
+                     std::chrono::steady_clock::duration* latency) {
+  *latency = std::chrono::steady_clock::now() - posted_at;
+  g_counter_promise->set_value();
+}
+
+// Posts from several threads at once, as the HCI, audio and socket threads do
+// to the main thread
+void RunMultiProducer(MessageLoopThread* thread, State& state) {
+  std::atomic<int> counter;
+  for (auto _ : state) {
+    counter = 0;
+    g_counter_promise = std::make_unique<std::promise<void>>();
+    std::future<void> counter_future = g_counter_promise->get_future();
+    std::vector<std::thread> producers;
+    for (int p = 0; p < NUM_PRODUCERS; p++) {
+      producers.emplace_back([thread, &counter]() {
+        for (int i = 0; i < NUM_MESSAGES_TO_SEND / NUM_PRODUCERS; i++) {
+          thread->DoInThread(
+              FROM_HERE, base::BindOnce(&callback_multi_producer, &counter));
+        }
+      });
+    }
+    for (auto& producer : producers) producer.join();
+    counter_future.wait();
+  }
+  state.SetItemsProcessed(state.iterations() * NUM_MESSAGES_TO_SEND);
+}
+
+// Time from the post to the start of the task, on an idle thread
+void RunWakeupLatency(MessageLoopThread* thread, State& state) {
+  std::chrono::steady_clock::duration total_latency{};
+  for (auto _ : state) {
+    std::chrono::steady_clock::duration latency;
+    g_counter_promise = std::make_unique<std::promise<void>>();
+    std::future<void> counter_future = g_counter_promise->get_future();
+    thread->DoInThread(FROM_HERE,
+                       base::BindOnce(&callback_wakeup,
+                                      std::chrono::steady_clock::now(),
+                                      &latency));
+    counter_future.wait();
+    total_latency += latency;
+  }
+  state.counters["wakeup_latency_us"] = benchmark::Counter(
+      std::chrono::duration<double, std::micro>(total_latency).count(),
+      benchmark::Counter::kAvgIterations);
+}
+
+BENCHMARK_F(BM_MessageLooopThread, multi_producer)(State& state) {
+  RunMultiProducer(message_loop_thread_, state);
+};
+
+BENCHMARK_F(BM_MessageLooopThread, wakeup_latency)(State& state) {
+  RunWakeupLatency(message_loop_thread_, state);
+};
+
+class BM_TaskQueueThread : public BM_ThreadPerformance {
+ protected:
+  void SetUp(State& st) override {
+    BM_ThreadPerformance::SetUp(st);
+    std::future<void> set_up_future = set_up_promise_->get_future();
+    message_loop_thread_ =
+        new MessageLoopThread("BM_TaskQueueThread thread", false,
+                              MessageLoopThread::Backend::kTaskQueue);
+    message_loop_thread_->StartUp();
+    message_loop_thread_->DoInThread(
+        FROM_HERE, base::BindOnce(&std::promise<void>::set_value,
+                                  base::Unretained(set_up_promise_.get())));
+    set_up_future.wait();
+  }
+
+  void TearDown(State& st) override {
+    message_loop_thread_->ShutDown();
+    delete message_loop_thread_;
+    message_loop_thread_ = nullptr;
+    BM_ThreadPerformance::TearDown(st);
+  }
+
+  MessageLoopThread* message_loop_thread_ = nullptr;
+};
+
+BENCHMARK_F(BM_TaskQueueThread, batch_enque_dequeue)(State& state) {
+  for (auto _ : state) {
+    g_counter = 0;
+    g_counter_promise = std::make_unique<std::promise<void>>();
+    std::future<void> counter_future = g_counter_promise->get_future();
+    for (int i = 0; i < NUM_MESSAGES_TO_SEND; i++) {
+      fixed_queue_enqueue(bt_msg_queue_, (void*)&g_counter);
+      message_loop_thread_->DoInThread(
+          FROM_HERE, base::BindOnce(&callback_batch, bt_msg_queue_, nullptr));
+    }
+    counter_future.wait();
+  }
+};
+
+BENCHMARK_F(BM_TaskQueueThread, sequential_execution)(State& state) {
+  for (auto _ : state) {
+    for (int i = 0; i < NUM_MESSAGES_TO_SEND; i++) {
+      g_counter_promise = std::make_unique<std::promise<void>>();
+      std::future<void> counter_future = g_counter_promise->get_future();
+      message_loop_thread_->DoInThread(
+          FROM_HERE, base::BindOnce(&callback_sequential, nullptr));
+      counter_future.wait();
+    }
+  }
+};
+
+BENCHMARK_F(BM_TaskQueueThread, multi_producer)(State& state) {
+  RunMultiProducer(message_loop_thread_, state);
+};
+
+BENCHMARK_F(BM_TaskQueueThread, wakeup_latency)(State& state) {
+  RunWakeupLatency(message_loop_thread_, state);
+};
+
 class BM_LibChromeThread : public BM_ThreadPerformance {
  protected:
   void SetUp(State& st) override {
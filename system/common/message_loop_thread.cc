@@ -37,6 +37,10 @@ MessageLoopThread::MessageLoopThread(const std::string& thread_name)
 
 MessageLoopThread::MessageLoopThread(const std::string& thread_name,
                                      bool is_main)
+    : MessageLoopThread(thread_name, is_main, Backend::kMessageLoop) {}
+
+MessageLoopThread::MessageLoopThread(const std::string& thread_name,
+                                     bool is_main, Backend backend)
     : thread_name_(thread_name),
       message_loop_(nullptr),
       run_loop_(nullptr),
@@ -46,6 +50,7 @@ MessageLoopThread::MessageLoopThread(const std::string& thread_name,
       weak_ptr_factory_(this),
       shutting_down_(false),
       is_main_(is_main),
+      backend_(backend),
       rust_thread_(nullptr) {}
 
 MessageLoopThread::~MessageLoopThread() { ShutDown(); }
@@ -84,6 +89,9 @@ bool MessageLoopThread::DoInThread(const base::Location& from_here,
 bool MessageLoopThread::DoInThreadDelayed(const base::Location& from_here,
                                           base::OnceClosure task,
                                           const base::TimeDelta& delay) {
+  // Only taken by a running thread with the task queue backend
+  if (task_queue_.TryPost(&task, delay)) return true;
+
   std::lock_guard<std::recursive_mutex> api_lock(api_mutex_);
   if (is_main_ && init_flags::gd_rust_is_enabled()) {
     if (rust_thread_ == nullptr) {
@@ -228,6 +236,10 @@ void MessageLoopThread::Run(std::promise<void> start_up_promise) {
     base::PlatformThread::SetName(thread_name_);
     message_loop_ = new btbase::AbstractMessageLoop();
     run_loop_ = new base::RunLoop();
+    if (backend_ == Backend::kTaskQueue ||
+        init_flags::message_loop_task_queue_is_enabled()) {
+      task_queue_.Open(message_loop_);
+    }
     thread_id_ = base::PlatformThread::CurrentId();
     linux_tid_ = static_cast<pid_t>(syscall(SYS_gettid));
     start_up_promise.set_value();
@@ -238,6 +250,7 @@ void MessageLoopThread::Run(std::promise<void> start_up_promise) {
 
   {
     std::lock_guard<std::recursive_mutex> api_lock(api_mutex_);
+    task_queue_.Close();
     thread_id_ = -1;
     linux_tid_ = -1;
     delete message_loop_;
@@ -29,6 +29,7 @@
 #include "src/message_loop_thread.rs.h"
 
 #include "abstract_message_loop.h"
+#include "task_queue.h"
 
 namespace bluetooth {
 
@@ -39,6 +40,18 @@ namespace common {
  */
 class MessageLoopThread final {
  public:
+  /**
+   * How tasks posted through DoInThread() and DoInThreadDelayed() reach the
+   * message loop
+   */
+  enum class Backend {
+    // Posted to the task runner of the message loop, unless the
+    // message_loop_task_queue init flag is set
+    kMessageLoop,
+    // Posted without locking to a TaskQueue draining into the message loop
+    kTaskQueue,
+  };
+
   /**
    * Create a message loop thread with name. Thread won't be running until
    * StartUp is called.
@@ -47,6 +60,8 @@ class MessageLoopThread final {
    */
   explicit MessageLoopThread(const std::string& thread_name);
   explicit MessageLoopThread(const std::string& thread_name, bool is_main);
+  explicit MessageLoopThread(const std::string& thread_name, bool is_main,
+                             Backend backend);
 
   MessageLoopThread(const MessageLoopThread&) = delete;
   MessageLoopThread& operator=(const MessageLoopThread&) = delete;
@@ -201,6 +216,8 @@ class MessageLoopThread final {
   base::WeakPtrFactory<MessageLoopThread> weak_ptr_factory_;
   bool shutting_down_;
   bool is_main_;
+  const Backend backend_;
+  TaskQueue task_queue_;
   ::rust::Box<shim::rust::MessageLoopThread>* rust_thread_ = nullptr;
 };
 
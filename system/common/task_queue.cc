@@ -0,0 +1,196 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "task_queue.h"
+
+#include <base/bind.h>
+#include <base/logging.h>
+
+#include <thread>
+
+#include "time_util.h"
+
+namespace bluetooth {
+
+namespace common {
+
+constexpr size_t TaskQueue::kDefaultMaxTasksPerDrain;
+
+TaskQueue::TaskQueue(size_t max_tasks_per_drain)
+    : max_tasks_per_drain_(max_tasks_per_drain > 0 ? max_tasks_per_drain : 1),
+      head_(&stub_),
+      tail_(&stub_) {}
+
+TaskQueue::~TaskQueue() { Close(); }
+
+void TaskQueue::Open(btbase::AbstractMessageLoop* message_loop) {
+  CHECK(message_loop != nullptr);
+  message_loop_ = message_loop;
+  open_.store(true);
+}
+
+void TaskQueue::Close() {
+  if (!open_.exchange(false)) return;
+  // Posts which found the queue open complete before anything is torn down
+  while (producers_.load() != 0) std::this_thread::yield();
+
+  bool busy;
+  while (Task* task = Dequeue(&busy)) delete task;
+  while (!timers_.empty()) {
+    delete timers_.top();
+    timers_.pop();
+  }
+  drain_scheduled_.store(false);
+  armed_deadline_us_ = UINT64_MAX;
+  message_loop_ = nullptr;
+}
+
+bool TaskQueue::TryPost(base::OnceClosure* task,
+                        const base::TimeDelta& delay) {
+  producers_.fetch_add(1);
+  if (!open_.load()) {
+    producers_.fetch_sub(1);
+    return false;
+  }
+
+  Task* node = new Task;
+  node->closure = std::move(*task);
+  node->deadline_us = delay > base::TimeDelta()
+                          ? time_get_os_monotonic_us() + delay.InMicroseconds()
+                          : 0;
+  Enqueue(node);
+  ScheduleDrain();
+
+  producers_.fetch_sub(1, std::memory_order_release);
+  return true;
+}
+
+void TaskQueue::Enqueue(Node* node) {
+  node->next.store(nullptr, std::memory_order_relaxed);
+  Node* prev = head_.exchange(node, std::memory_order_acq_rel);
+  prev->next.store(node, std::memory_order_release);
+}
+
+TaskQueue::Task* TaskQueue::Dequeue(bool* busy) {
+  *busy = false;
+  Node* tail = tail_;
+  Node* next = tail->next.load(std::memory_order_acquire);
+  if (tail == &stub_) {
+    if (next == nullptr) {
+      *busy = head_.load(std::memory_order_acquire) != &stub_;
+      return nullptr;
+    }
+    tail_ = next;
+    tail = next;
+    next = next->next.load(std::memory_order_acquire);
+  }
+  if (next != nullptr) {
+    tail_ = next;
+    return static_cast<Task*>(tail);
+  }
+  if (tail != head_.load(std::memory_order_acquire)) {
+    *busy = true;
+    return nullptr;
+  }
+  // tail is the last task, queue the stub behind it so that it can be popped
+  Enqueue(&stub_);
+  next = tail->next.load(std::memory_order_acquire);
+  if (next != nullptr) {
+    tail_ = next;
+    return static_cast<Task*>(tail);
+  }
+  *busy = true;
+  return nullptr;
+}
+
+void TaskQueue::ScheduleDrain() {
+  // Pairs with the exchange of Drain(): either the drain in progress sees the
+  // task just queued, or a new drain is posted for it
+  if (drain_scheduled_.exchange(true, std::memory_order_acq_rel)) return;
+  if (!message_loop_->task_runner()->PostTask(
+          FROM_HERE,
+          base::BindOnce(&TaskQueue::Drain, base::Unretained(this)))) {
+    LOG(ERROR) << __func__ << ": failed to post drain to message loop";
+  }
+}
+
+void TaskQueue::Drain() {
+  drain_scheduled_.exchange(false, std::memory_order_acq_rel);
+
+  bool busy = false;
+  size_t num_tasks = 0;
+  for (; num_tasks < max_tasks_per_drain_; num_tasks++) {
+    Task* task = Dequeue(&busy);
+    if (task == nullptr) break;
+    if (task->deadline_us != 0) {
+      task->sequence = next_sequence_++;
+      timers_.push(task);
+      continue;
+    }
+    std::move(task->closure).Run();
+    delete task;
+  }
+  // Let the message loop run its own tasks before draining the rest, or
+  // retry once the producer half way through its post is done
+  if (num_tasks == max_tasks_per_drain_ || busy) ScheduleDrain();
+
+  RunDueTimers();
+  ArmTimer();
+}
+
+void TaskQueue::RunDueTimers() {
+  if (timers_.empty()) return;
+  uint64_t now_us = time_get_os_monotonic_us();
+  while (!timers_.empty() && timers_.top()->deadline_us <= now_us) {
+    Task* task = timers_.top();
+    timers_.pop();
+    std::move(task->closure).Run();
+    delete task;
+  }
+}
+
+void TaskQueue::ArmTimer() {
+  if (timers_.empty()) return;
+  uint64_t deadline_us = timers_.top()->deadline_us;
+  // The wake up already posted comes first
+  if (deadline_us >= armed_deadline_us_) return;
+  armed_deadline_us_ = deadline_us;
+
+  uint64_t now_us = time_get_os_monotonic_us();
+  int64_t delay_us = deadline_us > now_us ? deadline_us - now_us : 0;
+  if (!message_loop_->task_runner()->PostDelayedTask(
+          FROM_HERE,
+          base::BindOnce(&TaskQueue::OnTimer, base::Unretained(this),
+                         deadline_us),
+#if BASE_VER < 931007
+          base::TimeDelta::FromMicroseconds(delay_us))) {
+#else
+          base::Microseconds(delay_us))) {
+#endif
+    LOG(ERROR) << __func__ << ": failed to post wake up to message loop";
+  }
+}
+
+void TaskQueue::OnTimer(uint64_t deadline_us) {
+  // Wake ups superseded by an earlier one still fire, and find nothing due
+  if (deadline_us == armed_deadline_us_) armed_deadline_us_ = UINT64_MAX;
+  RunDueTimers();
+  ArmTimer();
+}
+
+}  // namespace common
+
+}  // namespace bluetooth
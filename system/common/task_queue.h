@@ -0,0 +1,136 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <base/callback.h>
+#include <base/time/time.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <queue>
+#include <vector>
+
+#include "abstract_message_loop.h"
+
+namespace bluetooth {
+
+namespace common {
+
+/**
+ * Tasks of a message loop, posted from any thread without taking a lock.
+ *
+ * Immediate tasks go through an intrusive multi-producer single-consumer
+ * queue. Only the post finding the queue idle wakes the message loop up, by
+ * posting a drain task to it: the tasks posted meanwhile run in the same
+ * drain, up to max_tasks_per_drain of them before the message loop gets to
+ * run its own tasks again.
+ *
+ * Delayed tasks go through the same queue, and are moved by the drain into a
+ * timer heap owned by the message loop thread. A single delayed wake up is
+ * kept posted to the message loop, for the earliest of them.
+ *
+ * Tasks posted from one thread run in order, delayed tasks in order of their
+ * deadline then of their posting.
+ */
+class TaskQueue final {
+ public:
+  // Tasks run by a drain before yielding back to the message loop
+  static constexpr size_t kDefaultMaxTasksPerDrain = 64;
+
+  explicit TaskQueue(size_t max_tasks_per_drain = kDefaultMaxTasksPerDrain);
+  TaskQueue(const TaskQueue&) = delete;
+  TaskQueue& operator=(const TaskQueue&) = delete;
+
+  ~TaskQueue();
+
+  /**
+   * Start taking tasks, run on message_loop. Must be called on the thread
+   * running message_loop.
+   */
+  void Open(btbase::AbstractMessageLoop* message_loop);
+
+  /**
+   * Stop taking tasks and destroy the pending ones without running them.
+   * Must be called on the thread running the message loop, before the
+   * message loop is destroyed. Waits for the posts in progress to complete.
+   */
+  void Close();
+
+  /**
+   * Post a task, from any thread
+   *
+   * @param task task to run, left as is when it cannot be posted
+   * @param delay delay for the task to be executed
+   * @return true iff the task is posted, false when the queue is closed
+   */
+  bool TryPost(base::OnceClosure* task, const base::TimeDelta& delay);
+
+ private:
+  struct Node {
+    std::atomic<Node*> next{nullptr};
+  };
+
+  struct Task : Node {
+    base::OnceClosure closure;
+    // CLOCK_MONOTONIC time the task is due at, 0 for immediate tasks
+    uint64_t deadline_us;
+    // Posting order of the delayed tasks, breaks ties between deadlines
+    uint64_t sequence = 0;
+  };
+
+  struct LaterDeadline {
+    bool operator()(const Task* a, const Task* b) const {
+      if (a->deadline_us != b->deadline_us) {
+        return a->deadline_us > b->deadline_us;
+      }
+      return a->sequence > b->sequence;
+    }
+  };
+
+  void Enqueue(Node* node);
+  // Pops the oldest task, or nullptr with busy set when a producer is half
+  // way through its post and the queue cannot be read past it yet
+  Task* Dequeue(bool* busy);
+
+  void ScheduleDrain();
+  void Drain();
+  void RunDueTimers();
+  void ArmTimer();
+  void OnTimer(uint64_t deadline_us);
+
+  const size_t max_tasks_per_drain_;
+  btbase::AbstractMessageLoop* message_loop_ = nullptr;
+  std::atomic<bool> open_{false};
+  // Posts in progress, waited for by Close()
+  std::atomic<int> producers_{0};
+  std::atomic<bool> drain_scheduled_{false};
+
+  // Producers push at head_, the message loop thread pops at tail_
+  std::atomic<Node*> head_;
+  Node* tail_;
+  Node stub_;
+
+  // Owned by the message loop thread
+  std::priority_queue<Task*, std::vector<Task*>, LaterDeadline> timers_;
+  uint64_t next_sequence_ = 0;
+  uint64_t armed_deadline_us_ = UINT64_MAX;
+};
+
+}  // namespace common
+
+}  // namespace bluetooth
@@ -0,0 +1,178 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "task_queue.h"
+
+#include <base/bind.h>
+#include <base/logging.h>
+#include <gtest/gtest.h>
+
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "message_loop_thread.h"
+
+using bluetooth::common::MessageLoopThread;
+using bluetooth::common::TaskQueue;
+
+namespace {
+
+constexpr int kNumProducers = 4;
+constexpr int kTasksPerProducer = 10000;
+
+#if BASE_VER < 931007
+base::TimeDelta Ms(int64_t ms) { return base::TimeDelta::FromMilliseconds(ms); }
+#else
+base::TimeDelta Ms(int64_t ms) { return base::Milliseconds(ms); }
+#endif
+
+void Append(std::vector<int>* values, int value) { values->push_back(value); }
+
+}  // namespace
+
+class TaskQueueTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    thread_ = std::make_unique<MessageLoopThread>(
+        "task_queue_test", false, MessageLoopThread::Backend::kTaskQueue);
+    thread_->StartUp();
+  }
+
+  void TearDown() override { thread_.reset(); }
+
+  // Waits for the tasks posted so far to run
+  void Flush(const base::TimeDelta& delay = base::TimeDelta()) {
+    std::promise<void> promise;
+    auto future = promise.get_future();
+    ASSERT_TRUE(thread_->DoInThreadDelayed(
+        FROM_HERE,
+        base::BindOnce(&std::promise<void>::set_value,
+                       base::Unretained(&promise)),
+        delay));
+    future.wait();
+  }
+
+  std::unique_ptr<MessageLoopThread> thread_;
+};
+
+TEST_F(TaskQueueTest, closed_queue_leaves_task_as_is) {
+  TaskQueue queue;
+  base::OnceClosure task = base::BindOnce([]() {});
+  EXPECT_FALSE(queue.TryPost(&task, base::TimeDelta()));
+  EXPECT_FALSE(task.is_null());
+}
+
+TEST_F(TaskQueueTest, tasks_of_each_producer_run_in_order) {
+  std::vector<std::vector<int>> values(kNumProducers);
+  std::vector<std::thread> producers;
+  for (int p = 0; p < kNumProducers; p++) {
+    producers.emplace_back([this, &values, p]() {
+      for (int i = 0; i < kTasksPerProducer; i++) {
+        ASSERT_TRUE(thread_->DoInThread(
+            FROM_HERE, base::BindOnce(&Append, &values[p], i)));
+      }
+    });
+  }
+  for (auto& producer : producers) producer.join();
+  Flush();
+
+  for (int p = 0; p < kNumProducers; p++) {
+    ASSERT_EQ(values[p].size(), (size_t)kTasksPerProducer);
+    for (int i = 0; i < kTasksPerProducer; i++) EXPECT_EQ(values[p][i], i);
+  }
+}
+
+TEST_F(TaskQueueTest, delayed_tasks_run_by_deadline_then_post_order) {
+  std::vector<int> values;
+  thread_->DoInThreadDelayed(FROM_HERE, base::BindOnce(&Append, &values, 3),
+                             Ms(30));
+  thread_->DoInThreadDelayed(FROM_HERE, base::BindOnce(&Append, &values, 1),
+                             Ms(10));
+  thread_->DoInThread(FROM_HERE, base::BindOnce(&Append, &values, 0));
+  thread_->DoInThreadDelayed(FROM_HERE, base::BindOnce(&Append, &values, 2),
+                             Ms(10));
+  Flush(Ms(60));
+
+  EXPECT_EQ(values, std::vector<int>({0, 1, 2, 3}));
+}
+
+TEST_F(TaskQueueTest, delayed_task_does_not_run_early) {
+  auto start = std::chrono::steady_clock::now();
+  Flush(Ms(20));
+  EXPECT_GE(std::chrono::steady_clock::now() - start,
+            std::chrono::milliseconds(20));
+}
+
+TEST_F(TaskQueueTest, shut_down_drops_pending_delayed_tasks) {
+  std::vector<int> values;
+  ASSERT_TRUE(thread_->DoInThreadDelayed(
+      FROM_HERE, base::BindOnce(&Append, &values, 1), Ms(1000)));
+  thread_->ShutDown();
+
+  EXPECT_TRUE(values.empty());
+  EXPECT_FALSE(
+      thread_->DoInThread(FROM_HERE, base::BindOnce(&Append, &values, 2)));
+
+  // The thread starts again with an empty queue
+  thread_->StartUp();
+  Flush();
+  EXPECT_TRUE(values.empty());
+}
+
+TEST_F(TaskQueueTest, drain_yields_to_message_loop) {
+  // A queue draining a single task at a time, on a thread of its own
+  MessageLoopThread host("task_queue_host");
+  host.StartUp();
+  auto task_runner = host.message_loop()->task_runner();
+  TaskQueue queue(1);
+  std::promise<void> opened;
+  task_runner->PostTask(FROM_HERE,
+                        base::BindOnce(&TaskQueue::Open,
+                                       base::Unretained(&queue),
+                                       host.message_loop()));
+  task_runner->PostTask(FROM_HERE,
+                        base::BindOnce(&std::promise<void>::set_value,
+                                       base::Unretained(&opened)));
+  opened.get_future().wait();
+
+  // Hold the thread until everything is posted
+  std::promise<void> release;
+  std::shared_future<void> released = release.get_future().share();
+  task_runner->PostTask(FROM_HERE,
+                        base::BindOnce(&std::shared_future<void>::wait,
+                                       base::Unretained(&released)));
+
+  std::vector<int> values;
+  for (int i = 0; i < 3; i++) {
+    base::OnceClosure task = base::BindOnce(&Append, &values, i);
+    ASSERT_TRUE(queue.TryPost(&task, base::TimeDelta()));
+  }
+  std::promise<void> closed;
+  task_runner->PostTask(FROM_HERE, base::BindOnce(&Append, &values, -1));
+  task_runner->PostTask(
+      FROM_HERE, base::BindOnce(&TaskQueue::Close, base::Unretained(&queue)));
+  task_runner->PostTask(FROM_HERE,
+                        base::BindOnce(&std::promise<void>::set_value,
+                                       base::Unretained(&closed)));
+  release.set_value();
+  closed.get_future().wait();
+
+  // The drain runs the first task then is posted again, behind the tasks of
+  // the message loop. The tasks left are dropped when the queue closes.
+  EXPECT_EQ(values, std::vector<int>({0, -1}));
+}
@@ -30,6 +30,10 @@ uint64_t time_get_os_boottime_ms();
 // Get the OS boot time in microseconds.
 uint64_t time_get_os_boottime_us();
 
+// Get the OS monotonic time in microseconds, which does not advance while the
+// system is suspended.
+uint64_t time_get_os_monotonic_us();
+
 // Get the current wall clock time in microseconds.
 uint64_t time_gettimeofday_us();
 
@@ -32,6 +32,12 @@
 #include "g722_typedefs.h"
 #include "g722_enc_dec.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 #if !defined(FALSE)
 #define FALSE 0
 #endif
@@ -259,17 +265,118 @@ static int16_t qm2[4] =
 {
     -7408,  -1616,   7408,   1616
 };
-static int16_t qmf_coeffs[12] =
+/* The transmit QMF coefficients are
+ *     3, -11, 12, 32, -210, 951, 3876, -805, 362, -156, 53, -11
+ * applied to the even samples of the history, and in reverse order to the odd
+ * ones. They are stored interleaved the way the history is laid out, so that
+ * one pass of multiply-accumulate over the 24 samples directly yields the sum
+ * and the difference of the two filters.
+ */
+#if defined(__SSE2__) || defined(__ARM_NEON)
+#define G722_QMF_ALIGN __attribute__((aligned(16)))
+#else
+#define G722_QMF_ALIGN
+#endif
+static const int16_t qmf_sum_coeffs[24] G722_QMF_ALIGN =
+{
+       3,  -11,  -11,   53,   12, -156,   32,  362,
+    -210, -805,  951, 3876, 3876,  951, -805, -210,
+     362,   32, -156,   12,   53,  -11,  -11,    3
+};
+static const int16_t qmf_diff_coeffs[24] G722_QMF_ALIGN =
 {
-       3,  -11,   12,   32, -210,  951, 3876, -805,  362, -156,   53,  -11,
+      -3,  -11,   11,   53,  -12, -156,  -32,  362,
+     210, -805, -951, 3876,-3876,  951,  805, -210,
+    -362,   32,  156,   12,  -53,  -11,   11,    3
 };
 static int16_t ihn[3] = {0, 1, 0};
 static int16_t ihp[3] = {0, 3, 2};
 static int16_t wh[3] = {0, -214, 798};
 static int16_t rh2[4] = {2, 1, 2, 1};
 
-int g722_encode(g722_encode_state_t *s, uint8_t g722_data[],
-                       const int16_t amp[], int len)
+/* Input samples per channel the history is built for at once */
+#define G722_QMF_BLOCK_LEN  (160)
+
+/* Applies the transmit QMF to the 24 samples history x[], oldest first.
+   The accumulations cannot overflow 32 bits for 16 bit samples, so the
+   vectorized versions are bit exact with the plain one. */
+#if defined(__SSE2__)
+static __inline void qmf_tx(const int16_t x[], int *xlow, int *xhigh)
+{
+    __m128i sum = _mm_setzero_si128();
+    __m128i diff = _mm_setzero_si128();
+    int i;
+
+    for (i = 0;  i < 24;  i += 8)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *) &x[i]);
+
+        sum = _mm_add_epi32(sum, _mm_madd_epi16(v,
+                _mm_load_si128((const __m128i *) &qmf_sum_coeffs[i])));
+        diff = _mm_add_epi32(diff, _mm_madd_epi16(v,
+                _mm_load_si128((const __m128i *) &qmf_diff_coeffs[i])));
+    }
+    /* Reduce both accumulators at once: sum in lane 0, diff in lane 2 */
+    sum = _mm_add_epi32(_mm_unpacklo_epi64(sum, diff),
+                        _mm_unpackhi_epi64(sum, diff));
+    sum = _mm_add_epi32(sum, _mm_srli_epi64(sum, 32));
+
+    /* We shift by 12 to allow for the QMF filters (DC gain = 4096), plus 1
+       to allow for us summing two filters, plus 1 to allow for the 15 bit
+       input to the G.722 algorithm. */
+    *xlow = _mm_cvtsi128_si32(sum) >> 14;
+    *xhigh = _mm_cvtsi128_si32(_mm_srli_si128(sum, 8)) >> 14;
+}
+#elif defined(__ARM_NEON)
+static __inline void qmf_tx(const int16_t x[], int *xlow, int *xhigh)
+{
+    int32x4_t sum = vdupq_n_s32(0);
+    int32x4_t diff = vdupq_n_s32(0);
+    int32x2_t acc;
+    int i;
+
+    for (i = 0;  i < 24;  i += 8)
+    {
+        int16x8_t v = vld1q_s16(&x[i]);
+        int16x8_t cs = vld1q_s16(&qmf_sum_coeffs[i]);
+        int16x8_t cd = vld1q_s16(&qmf_diff_coeffs[i]);
+
+        sum = vmlal_s16(sum, vget_low_s16(v), vget_low_s16(cs));
+        sum = vmlal_s16(sum, vget_high_s16(v), vget_high_s16(cs));
+        diff = vmlal_s16(diff, vget_low_s16(v), vget_low_s16(cd));
+        diff = vmlal_s16(diff, vget_high_s16(v), vget_high_s16(cd));
+    }
+    /* Reduce both accumulators at once: sum in lane 0, diff in lane 1 */
+    acc = vpadd_s32(vadd_s32(vget_low_s32(sum), vget_high_s32(sum)),
+                    vadd_s32(vget_low_s32(diff), vget_high_s32(diff)));
+
+    /* See the comment in the SSE2 version about the shift */
+    *xlow = vget_lane_s32(acc, 0) >> 14;
+    *xhigh = vget_lane_s32(acc, 1) >> 14;
+}
+#else
+static __inline void qmf_tx(const int16_t x[], int *xlow, int *xhigh)
+{
+    int sum = 0;
+    int diff = 0;
+    int i;
+
+    for (i = 0;  i < 24;  i++)
+    {
+        sum += x[i]*qmf_sum_coeffs[i];
+        diff += x[i]*qmf_diff_coeffs[i];
+    }
+    /* We shift by 12 to allow for the QMF filters (DC gain = 4096), plus 1
+       to allow for us summing two filters, plus 1 to allow for the 15 bit
+       input to the G.722 algorithm. */
+    *xlow = sum >> 14;
+    *xhigh = diff >> 14;
+}
+#endif
+/*- End of function --------------------------------------------------------*/
+
+/* Runs the ADPCM encoder of both bands over one pair of band samples */
+static __inline int encode_bands(g722_encode_state_t *s, int xlow, int xhigh)
 {
     int dlow;
     int dhigh;
@@ -284,154 +391,202 @@ int g722_encode(g722_encode_state_t *s, uint8_t g722_data[],
     int eh;
     int mih;
     int i;
-    int j;
-    /* Low and high band PCM from the QMF */
-    int xlow;
-    int xhigh;
-    int g722_bytes;
-    /* Even and odd tap accumulators */
-    int sumeven;
-    int sumodd;
     int ihigh;
     int ilow;
     int code;
 
-    g722_bytes = 0;
-    xhigh = 0;
-    for (j = 0;  j < len;  )
-    {
-        if (s->itu_test_mode)
-        {
-            xlow =
-            xhigh = amp[j++] >> 1;
-        }
-        else
-        {
-            {
-                /* Apply the transmit QMF */
-                /* Shuffle the buffer down */
-                for (i = 0;  i < 22;  i++)
-                    s->x[i] = s->x[i + 2];
-                //TODO: if len is odd, then this can be a buffer overrun
-                s->x[22] = amp[j++];
-                s->x[23] = amp[j++];
-    
-                /* Discard every other QMF output */
-                sumeven = 0;
-                sumodd = 0;
-                for (i = 0;  i < 12;  i++)
-                {
-                    sumodd += s->x[2*i]*qmf_coeffs[i];
-                    sumeven += s->x[2*i + 1]*qmf_coeffs[11 - i];
-                }
-                /* We shift by 12 to allow for the QMF filters (DC gain = 4096), plus 1
-                   to allow for us summing two filters, plus 1 to allow for the 15 bit
-                   input to the G.722 algorithm. */
-                xlow = (sumeven + sumodd) >> 14;
-                xhigh = (sumeven - sumodd) >> 14;
-
 #ifdef RUN_LIKE_REFERENCE_G722
-                /* The following lines are only used to verify bit-exactness
-                 * with reference implementation of G.722. Higher precision
-                 * is achieved without limiting the values.
-                 */
-                xlow = limitValues(xlow);
-                xhigh = limitValues(xhigh);
+    /* The following lines are only used to verify bit-exactness
+     * with reference implementation of G.722. Higher precision
+     * is achieved without limiting the values.
+     */
+    if (!s->itu_test_mode)
+    {
+        xlow = limitValues(xlow);
+        xhigh = limitValues(xhigh);
+    }
 #endif
-            }
-        }
-        /* Block 1L, SUBTRA */
-        el = saturate(xlow - s->band[0].s);
 
-        /* Block 1L, QUANTL */
-        wd = (el >= 0)  ?  el  :  -(el + 1);
+    /* Block 1L, SUBTRA */
+    el = saturate(xlow - s->band[0].s);
 
-        for (i = 1;  i < 30;  i++)
-        {
-            wd1 = (q6[i]*s->band[0].det) >> 12;
-            if (wd < wd1)
-                break;
-        }
-        ilow = (el < 0)  ?  iln[i]  :  ilp[i];
-
-        /* Block 2L, INVQAL */
-        ril = ilow >> 2;
-        wd2 = qm4[ril];
-        dlow = (s->band[0].det*wd2) >> 15;
-
-        /* Block 3L, LOGSCL */
-        il4 = rl42[ril];
-        wd = (s->band[0].nb*127) >> 7;
-        s->band[0].nb = wd + wl[il4];
-        if (s->band[0].nb < 0)
-            s->band[0].nb = 0;
-        else if (s->band[0].nb > 18432)
-            s->band[0].nb = 18432;
-
-        /* Block 3L, SCALEL */
-        wd1 = (s->band[0].nb >> 6) & 31;
-        wd2 = 8 - (s->band[0].nb >> 11);
+    /* Block 1L, QUANTL */
+    wd = (el >= 0)  ?  el  :  -(el + 1);
+
+    for (i = 1;  i < 30;  i++)
+    {
+        wd1 = (q6[i]*s->band[0].det) >> 12;
+        if (wd < wd1)
+            break;
+    }
+    ilow = (el < 0)  ?  iln[i]  :  ilp[i];
+
+    /* Block 2L, INVQAL */
+    ril = ilow >> 2;
+    wd2 = qm4[ril];
+    dlow = (s->band[0].det*wd2) >> 15;
+
+    /* Block 3L, LOGSCL */
+    il4 = rl42[ril];
+    wd = (s->band[0].nb*127) >> 7;
+    s->band[0].nb = wd + wl[il4];
+    if (s->band[0].nb < 0)
+        s->band[0].nb = 0;
+    else if (s->band[0].nb > 18432)
+        s->band[0].nb = 18432;
+
+    /* Block 3L, SCALEL */
+    wd1 = (s->band[0].nb >> 6) & 31;
+    wd2 = 8 - (s->band[0].nb >> 11);
+    wd3 = (wd2 < 0)  ?  (ilb[wd1] << -wd2)  :  (ilb[wd1] >> wd2);
+    s->band[0].det = wd3 << 2;
+
+    block4(&s->band[0], dlow);
+    {
+        int nb;
+
+        /* Block 1H, SUBTRA */
+        eh = saturate(xhigh - s->band[1].s);
+
+        /* Block 1H, QUANTH */
+        wd = (eh >= 0)  ?  eh  :  -(eh + 1);
+        wd1 = (564*s->band[1].det) >> 12;
+        mih = (wd >= wd1)  ?  2  :  1;
+        ihigh = (eh < 0)  ?  ihn[mih]  :  ihp[mih];
+
+        /* Block 2H, INVQAH */
+        wd2 = qm2[ihigh];
+        dhigh = (s->band[1].det*wd2) >> 15;
+
+        /* Block 3H, LOGSCH */
+        ih2 = rh2[ihigh];
+        wd = (s->band[1].nb*127) >> 7;
+
+        nb = wd + wh[ih2];
+        if (nb < 0)
+            nb = 0;
+        else if (nb > 22528)
+            nb = 22528;
+        s->band[1].nb = nb;
+
+        /* Block 3H, SCALEH */
+        wd1 = (s->band[1].nb >> 6) & 31;
+        wd2 = 10 - (s->band[1].nb >> 11);
         wd3 = (wd2 < 0)  ?  (ilb[wd1] << -wd2)  :  (ilb[wd1] >> wd2);
-        s->band[0].det = wd3 << 2;
+        s->band[1].det = wd3 << 2;
 
-        block4(&s->band[0], dlow);
-        {
-	    int nb;
-
-            /* Block 1H, SUBTRA */
-            eh = saturate(xhigh - s->band[1].s);
-
-            /* Block 1H, QUANTH */
-            wd = (eh >= 0)  ?  eh  :  -(eh + 1);
-            wd1 = (564*s->band[1].det) >> 12;
-            mih = (wd >= wd1)  ?  2  :  1;
-            ihigh = (eh < 0)  ?  ihn[mih]  :  ihp[mih];
-
-            /* Block 2H, INVQAH */
-            wd2 = qm2[ihigh];
-            dhigh = (s->band[1].det*wd2) >> 15;
-
-            /* Block 3H, LOGSCH */
-            ih2 = rh2[ihigh];
-            wd = (s->band[1].nb*127) >> 7;
-
-            nb = wd + wh[ih2];
-            if (nb < 0)
-                nb = 0;
-            else if (nb > 22528)
-                nb = 22528;
-	    s->band[1].nb = nb;
-
-            /* Block 3H, SCALEH */
-            wd1 = (s->band[1].nb >> 6) & 31;
-            wd2 = 10 - (s->band[1].nb >> 11);
-            wd3 = (wd2 < 0)  ?  (ilb[wd1] << -wd2)  :  (ilb[wd1] >> wd2);
-            s->band[1].det = wd3 << 2;
-
-            block4(&s->band[1], dhigh);
+        block4(&s->band[1], dhigh);
 #if   BITS_PER_SAMPLE == 8
-            code = ((ihigh << 6) | ilow);
+        code = ((ihigh << 6) | ilow);
 #elif BITS_PER_SAMPLE == 7
-            code = ((ihigh << 6) | ilow) >> 1;
+        code = ((ihigh << 6) | ilow) >> 1;
 #elif BITS_PER_SAMPLE == 6
-            code = ((ihigh << 6) | ilow) >> 2;
+        code = ((ihigh << 6) | ilow) >> 2;
 #endif
-        }
+    }
+    return code;
+}
+/*- End of function --------------------------------------------------------*/
 
+static __inline int put_code(g722_encode_state_t *s, uint8_t g722_data[],
+                             int g722_bytes, int code)
+{
 #if PACKED_OUTPUT == 1
-            /* Pack the code bits */
-            s->out_buffer |= (code << s->out_bits);
-            s->out_bits += s->bits_per_sample;
-            if (s->out_bits >= 8)
-            {
-                g722_data[g722_bytes++] = (uint8_t) (s->out_buffer & 0xFF);
-                s->out_bits -= 8;
-                s->out_buffer >>= 8;
-            }
+    /* Pack the code bits */
+    s->out_buffer |= (code << s->out_bits);
+    s->out_bits += s->bits_per_sample;
+    if (s->out_bits >= 8)
+    {
+        g722_data[g722_bytes++] = (uint8_t) (s->out_buffer & 0xFF);
+        s->out_bits -= 8;
+        s->out_buffer >>= 8;
+    }
 #else
-            g722_data[g722_bytes++] = (uint8_t) code;
+    (void) s;
+    g722_data[g722_bytes++] = (uint8_t) code;
 #endif
+    return g722_bytes;
+}
+/*- End of function --------------------------------------------------------*/
+
+/* Encodes len samples of one channel, read every stride samples from amp[] */
+static int encode_channel(g722_encode_state_t *s, uint8_t g722_data[],
+                          const int16_t amp[], int stride, int len)
+{
+    /* History of the QMF followed by the block of new input samples */
+    int16_t x[24 + G722_QMF_BLOCK_LEN];
+    int g722_bytes;
+    int block_len;
+    int i;
+    int j;
+    int k;
+    int xlow;
+    int xhigh;
+
+    g722_bytes = 0;
+    if (s->itu_test_mode)
+    {
+        for (j = 0;  j < len;  j++)
+        {
+            xlow =
+            xhigh = amp[j*stride] >> 1;
+            g722_bytes = put_code(s, g722_data, g722_bytes,
+                                  encode_bands(s, xlow, xhigh));
+        }
+        return g722_bytes;
     }
+
+    /* Instead of shuffling the history down by two samples for each output,
+       the QMF slides over the history extended with a block of input. */
+    for (i = 0;  i < 24;  i++)
+        x[i] = (int16_t) s->x[i];
+
+    //TODO: if len is odd, then the last sample is ignored
+    for (j = 0;  j + 1 < len;  j += block_len)
+    {
+        block_len = len - j;
+        if (block_len > G722_QMF_BLOCK_LEN)
+            block_len = G722_QMF_BLOCK_LEN;
+        block_len &= ~1;
+
+        for (k = 0;  k < block_len;  k++)
+            x[24 + k] = amp[(j + k)*stride];
+
+        /* Discard every other QMF output */
+        for (k = 0;  k < block_len;  k += 2)
+        {
+            qmf_tx(&x[k + 2], &xlow, &xhigh);
+            g722_bytes = put_code(s, g722_data, g722_bytes,
+                                  encode_bands(s, xlow, xhigh));
+        }
+
+        memmove(x, &x[block_len], 24*sizeof(x[0]));
+    }
+
+    for (i = 0;  i < 24;  i++)
+        s->x[i] = x[i];
+    return g722_bytes;
+}
+/*- End of function --------------------------------------------------------*/
+
+int g722_encode(g722_encode_state_t *s, uint8_t g722_data[],
+                       const int16_t amp[], int len)
+{
+    return encode_channel(s, g722_data, amp, 1, len);
+}
+/*- End of function --------------------------------------------------------*/
+
+int g722_encode_stereo(g722_encode_state_t *left, g722_encode_state_t *right,
+                       uint8_t left_data[], uint8_t right_data[],
+                       const int16_t amp[], int len)
+{
+    int g722_bytes;
+
+    g722_bytes = 0;
+    if (left)
+        g722_bytes = encode_channel(left, left_data, amp, 2, len);
+    if (right)
+        g722_bytes = encode_channel(right, right_data, amp + 1, 2, len);
     return g722_bytes;
 }
 /*- End of function --------------------------------------------------------*/
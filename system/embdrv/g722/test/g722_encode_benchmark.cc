@@ -0,0 +1,119 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <base/logging.h>
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "embdrv/g722/g722_enc_dec.h"
+
+using ::benchmark::Counter;
+using ::benchmark::State;
+
+namespace {
+
+// Samples per channel of one hearing aid tick: 10 or 20 ms of 16 kHz audio
+constexpr int kSampleRate = 16000;
+
+std::vector<int16_t> Noise(size_t len, uint32_t seed) {
+  std::vector<int16_t> samples(len);
+  for (auto& sample : samples) {
+    seed = seed * 1664525u + 1013904223u;
+    sample = (int16_t)(seed >> 16) >> 1;
+  }
+  return samples;
+}
+
+std::vector<int16_t> Interleave(const std::vector<int16_t>& left,
+                                const std::vector<int16_t>& right) {
+  std::vector<int16_t> samples;
+  for (size_t i = 0; i < left.size(); i++) {
+    samples.push_back(left[i]);
+    samples.push_back(right[i]);
+  }
+  return samples;
+}
+
+/*
+ * Encodes one tick of binaural audio the way the hearing aid client used to,
+ * with one call per channel on deinterleaved samples.
+ */
+void BM_EncodeChannels(State& state) {
+  const int len = state.range(0);
+  std::vector<int16_t> left = Noise(len, 1);
+  std::vector<int16_t> right = Noise(len, 2);
+  std::vector<uint8_t> encoded_left(len / 2);
+  std::vector<uint8_t> encoded_right(len / 2);
+
+  g722_encode_state_t left_state;
+  g722_encode_state_t right_state;
+  g722_encode_init(&left_state, 64000, G722_PACKED);
+  g722_encode_init(&right_state, 64000, G722_PACKED);
+
+  for (auto _ : state) {
+    g722_encode(&left_state, encoded_left.data(), left.data(), len);
+    g722_encode(&right_state, encoded_right.data(), right.data(), len);
+    benchmark::ClobberMemory();
+  }
+
+  state.counters["audio_ms"] = Counter(
+      state.iterations() * len * 1000.0 / kSampleRate, Counter::kIsRate);
+}
+
+/*
+ * Encodes one tick of binaural audio in a single call on the interleaved
+ * samples.
+ */
+void BM_EncodeStereo(State& state) {
+  const int len = state.range(0);
+  std::vector<int16_t> stereo = Interleave(Noise(len, 1), Noise(len, 2));
+  std::vector<uint8_t> encoded_left(len / 2);
+  std::vector<uint8_t> encoded_right(len / 2);
+
+  g722_encode_state_t left_state;
+  g722_encode_state_t right_state;
+  g722_encode_init(&left_state, 64000, G722_PACKED);
+  g722_encode_init(&right_state, 64000, G722_PACKED);
+
+  for (auto _ : state) {
+    g722_encode_stereo(&left_state, &right_state, encoded_left.data(),
+                       encoded_right.data(), stereo.data(), len);
+    benchmark::ClobberMemory();
+  }
+
+  state.counters["audio_ms"] = Counter(
+      state.iterations() * len * 1000.0 / kSampleRate, Counter::kIsRate);
+}
+
+BENCHMARK(BM_EncodeChannels)->ArgName("len")->Arg(160)->Arg(320);
+BENCHMARK(BM_EncodeStereo)->ArgName("len")->Arg(160)->Arg(320);
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  // Disable LOG() output from libchrome
+  logging::LoggingSettings log_settings;
+  log_settings.logging_dest = logging::LoggingDestination::LOG_NONE;
+  CHECK(logging::InitLogging(log_settings)) << "Failed to set up logging";
+
+  ::benchmark::Initialize(&argc, argv);
+  if (::benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  ::benchmark::RunSpecifiedBenchmarks();
+}
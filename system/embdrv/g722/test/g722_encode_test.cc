@@ -0,0 +1,185 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "embdrv/g722/g722_enc_dec.h"
+
+namespace {
+
+// 10 ms of 16 kHz audio, as handed to the encoder on each hearing aid tick
+constexpr int kFrameLen = 160;
+constexpr int kNumFrames = 20;
+constexpr int kStreamLen = kFrameLen * kNumFrames;
+
+std::vector<int16_t> Sine(double frequency, int amplitude) {
+  std::vector<int16_t> samples(kStreamLen);
+  for (int i = 0; i < kStreamLen; i++) {
+    samples[i] = amplitude * std::sin(2 * M_PI * frequency * i / 16000.0);
+  }
+  return samples;
+}
+
+std::vector<int16_t> Noise(uint32_t seed) {
+  std::vector<int16_t> samples(kStreamLen);
+  for (auto& sample : samples) {
+    seed = seed * 1664525u + 1013904223u;
+    sample = seed >> 16;
+  }
+  return samples;
+}
+
+// Full scale square wave, saturating the quantizers
+std::vector<int16_t> Square() {
+  std::vector<int16_t> samples(kStreamLen);
+  for (int i = 0; i < kStreamLen; i++) {
+    samples[i] = (i / 20) % 2 ? INT16_MAX : INT16_MIN;
+  }
+  return samples;
+}
+
+uint32_t Fnv1a(const std::vector<uint8_t>& data) {
+  uint32_t hash = 2166136261u;
+  for (uint8_t byte : data) {
+    hash ^= byte;
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+std::vector<uint8_t> Encode(const std::vector<int16_t>& samples,
+                            int frame_len) {
+  g722_encode_state_t state;
+  g722_encode_init(&state, 64000, G722_PACKED);
+
+  std::vector<uint8_t> encoded;
+  std::vector<uint8_t> frame(frame_len);
+  for (size_t i = 0; i < samples.size(); i += frame_len) {
+    int len = g722_encode(&state, frame.data(), &samples[i], frame_len);
+    encoded.insert(encoded.end(), frame.begin(), frame.begin() + len);
+  }
+  return encoded;
+}
+
+std::vector<int16_t> Interleave(const std::vector<int16_t>& left,
+                                const std::vector<int16_t>& right) {
+  std::vector<int16_t> samples;
+  for (size_t i = 0; i < left.size(); i++) {
+    samples.push_back(left[i]);
+    samples.push_back(right[i]);
+  }
+  return samples;
+}
+
+// Outputs of the encoder before the QMF got vectorized, which must not change
+TEST(G722EncodeTest, bit_exact_with_reference) {
+  struct {
+    std::vector<int16_t> samples;
+    uint32_t hash;
+  } vectors[] = {
+      {Sine(1000, 8000), 0xe475f032},
+      {Noise(1), 0x619de0a1},
+      {Square(), 0xaea4ec1d},
+      {Sine(7000, 16000), 0xfc8db46e},
+  };
+
+  for (const auto& vector : vectors) {
+    std::vector<uint8_t> encoded = Encode(vector.samples, kFrameLen);
+    ASSERT_EQ(encoded.size(), (size_t)kStreamLen / 2);
+    EXPECT_EQ(Fnv1a(encoded), vector.hash);
+  }
+}
+
+TEST(G722EncodeTest, independent_of_frame_length) {
+  std::vector<int16_t> samples = Noise(2);
+  std::vector<uint8_t> encoded = Encode(samples, kFrameLen);
+
+  // Shorter and longer than the block the QMF history is extended by
+  for (int frame_len : {2, 10, 32, 320, 640}) {
+    EXPECT_EQ(Encode(samples, frame_len), encoded) << frame_len;
+  }
+}
+
+TEST(G722EncodeTest, stereo_matches_mono) {
+  std::vector<int16_t> left = Sine(1000, 8000);
+  std::vector<int16_t> right = Noise(3);
+  std::vector<int16_t> stereo = Interleave(left, right);
+
+  g722_encode_state_t left_state;
+  g722_encode_state_t right_state;
+  g722_encode_init(&left_state, 64000, G722_PACKED);
+  g722_encode_init(&right_state, 64000, G722_PACKED);
+
+  std::vector<uint8_t> encoded_left(kStreamLen / 2);
+  std::vector<uint8_t> encoded_right(kStreamLen / 2);
+  for (int i = 0; i < kStreamLen; i += kFrameLen) {
+    int len = g722_encode_stereo(&left_state, &right_state,
+                                 &encoded_left[i / 2], &encoded_right[i / 2],
+                                 &stereo[2 * i], kFrameLen);
+    ASSERT_EQ(len, kFrameLen / 2);
+  }
+
+  EXPECT_EQ(encoded_left, Encode(left, kFrameLen));
+  EXPECT_EQ(encoded_right, Encode(right, kFrameLen));
+}
+
+TEST(G722EncodeTest, stereo_skips_missing_channel) {
+  std::vector<int16_t> left = Square();
+  std::vector<int16_t> right = Sine(440, 12000);
+  std::vector<int16_t> stereo = Interleave(left, right);
+
+  g722_encode_state_t right_state;
+  g722_encode_init(&right_state, 64000, G722_PACKED);
+
+  std::vector<uint8_t> encoded_right(kStreamLen / 2);
+  for (int i = 0; i < kStreamLen; i += kFrameLen) {
+    g722_encode_stereo(nullptr, &right_state, nullptr, &encoded_right[i / 2],
+                       &stereo[2 * i], kFrameLen);
+  }
+
+  EXPECT_EQ(encoded_right, Encode(right, kFrameLen));
+}
+
+TEST(G722EncodeTest, stereo_leaves_same_state_as_mono) {
+  std::vector<int16_t> left = Noise(4);
+  std::vector<int16_t> right = Noise(5);
+  std::vector<int16_t> stereo = Interleave(left, right);
+  std::vector<uint8_t> encoded(kStreamLen);
+
+  g722_encode_state_t mono_left;
+  g722_encode_state_t mono_right;
+  g722_encode_state_t stereo_left;
+  g722_encode_state_t stereo_right;
+  g722_encode_init(&mono_left, 64000, G722_PACKED);
+  g722_encode_init(&mono_right, 64000, G722_PACKED);
+  g722_encode_init(&stereo_left, 64000, G722_PACKED);
+  g722_encode_init(&stereo_right, 64000, G722_PACKED);
+
+  g722_encode(&mono_left, encoded.data(), left.data(), kStreamLen);
+  g722_encode(&mono_right, encoded.data(), right.data(), kStreamLen);
+  g722_encode_stereo(&stereo_left, &stereo_right, encoded.data(),
+                     encoded.data(), stereo.data(), kStreamLen);
+
+  EXPECT_EQ(memcmp(&mono_left, &stereo_left, sizeof(mono_left)), 0);
+  EXPECT_EQ(memcmp(&mono_right, &stereo_right, sizeof(mono_right)), 0);
+}
+
+}  // namespace
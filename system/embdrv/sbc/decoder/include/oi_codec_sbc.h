@@ -67,6 +67,11 @@ Declarations of codec functions, data types, and macros.
 #define SBC_WBS_FRAME_LEN 62
 #define SBC_WBS_SAMPLES_PER_FRAME 128
 
+#define SBC_MSBC_BITPOOL 26
+#define SBC_MSBC_NROF_BLOCKS 15
+#define SBC_MSBC_FRAME_LEN 57
+#define SBC_MSBC_SAMPLES_PER_FRAME 120
+
 #define SBC_HEADER_LEN 4
 #define SBC_MAX_FRAME_LEN                    \
   (SBC_HEADER_LEN +                          \
@@ -79,6 +84,7 @@ Declarations of codec functions, data types, and macros.
 
 #define OI_SBC_SYNCWORD 0x9c
 #define OI_SBC_ENHANCED_SYNCWORD 0x9d
+#define OI_SBC_MSBC_SYNCWORD 0xad
 
 /**@name Sampling frequencies */
 /**@{*/
@@ -237,6 +243,8 @@ typedef struct {
   uint8_t limitFrameFormat;
   uint8_t restrictSubbands;
   uint8_t enhancedEnabled;
+  /* Boolean, set by OI_CODEC_SBC_DecoderConfigureMSbc() */
+  uint8_t mSbcEnabled;
   uint8_t bufferedBlocks;
 } OI_CODEC_SBC_DECODER_CONTEXT;
 
@@ -328,6 +336,19 @@ OI_STATUS OI_CODEC_SBC_DecoderConfigureRaw(
     uint8_t mode, uint8_t subbands, uint8_t blocks, uint8_t alloc,
     uint8_t maxBitpool);
 
+/**
+ * Configure a decoder context for mSBC, the wideband speech codec of HFP. mSBC
+ * frames start with their own syncword, and have a fixed configuration instead
+ * of a header: 16 kHz, mono, 8 subbands, 15 blocks, loudness allocation and a
+ * bitpool of 26. Once configured, OI_CODEC_SBC_DecodeFrame() only looks for
+ * mSBC frames. The context must have been initialized by calling
+ * OI_CODEC_SBC_DecoderReset().
+ *
+ * @param context   Pointer to a decoder context structure
+ */
+OI_STATUS OI_CODEC_SBC_DecoderConfigureMSbc(
+    OI_CODEC_SBC_DECODER_CONTEXT* context);
+
 /**
  * Decode one SBC frame. The frame has no header bytes. The context must have
  * been previously initialized by calling  OI_CODEC_SBC_DecoderConfigureRaw().
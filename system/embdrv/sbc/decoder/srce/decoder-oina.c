@@ -90,6 +90,28 @@ OI_STATUS OI_CODEC_SBC_DecoderConfigureRaw(
   return OI_OK;
 }
 
+OI_STATUS OI_CODEC_SBC_DecoderConfigureMSbc(
+    OI_CODEC_SBC_DECODER_CONTEXT* context) {
+  if (context->common.pcmStride < 1) {
+    return OI_STATUS_INVALID_PARAMETERS;
+  }
+
+  context->mSbcEnabled = TRUE;
+  context->common.frameInfo.enhanced = FALSE;
+  context->common.frameInfo.freqIndex = SBC_FREQ_16000;
+  context->common.frameInfo.mode = SBC_MONO;
+  context->common.frameInfo.subbands = SBC_SUBBANDS_8;
+  context->common.frameInfo.blocks = SBC_BLOCKS_16;
+  context->common.frameInfo.alloc = SBC_LOUDNESS;
+  context->common.frameInfo.bitpool = SBC_MSBC_BITPOOL;
+
+  OI_SBC_ExpandFrameFields(&context->common.frameInfo);
+  /* 15 blocks cannot be expressed in an SBC header */
+  context->common.frameInfo.nrof_blocks = SBC_MSBC_NROF_BLOCKS;
+
+  return OI_OK;
+}
+
 OI_STATUS OI_CODEC_SBC_DecodeRaw(OI_CODEC_SBC_DECODER_CONTEXT* context,
                                  uint8_t bitpool, const OI_BYTE** frameData,
                                  uint32_t* frameBytes, int16_t* pcmData,
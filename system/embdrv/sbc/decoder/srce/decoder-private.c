@@ -90,7 +90,16 @@ INLINE void OI_SBC_ReadHeader(OI_CODEC_SBC_COMMON_CONTEXT* common,
   OI_CODEC_SBC_FRAME_INFO* frame = &common->frameInfo;
   uint8_t d1;
 
-  OI_ASSERT(data[0] == OI_SBC_SYNCWORD || data[0] == OI_SBC_ENHANCED_SYNCWORD);
+  OI_ASSERT(data[0] == OI_SBC_SYNCWORD || data[0] == OI_SBC_ENHANCED_SYNCWORD ||
+            data[0] == OI_SBC_MSBC_SYNCWORD);
+
+  /* The configuration of mSBC frames is fixed, and was set by
+   * OI_CODEC_SBC_DecoderConfigureMSbc(): bytes 1 and 2 are reserved */
+  if (data[0] == OI_SBC_MSBC_SYNCWORD) {
+    frame->bitpool = SBC_MSBC_BITPOOL;
+    frame->crc = data[3];
+    return;
+  }
 
   /* Avoid filling out all these strucutures if we already remember the values
    * from last time. Just in case we get a stream corresponding to data[1] ==
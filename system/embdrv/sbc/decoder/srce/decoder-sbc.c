@@ -42,7 +42,8 @@
 /**
  * Scans through a buffer looking for a codec syncword. If the decoder has been
  * set for enhanced operation using OI_CODEC_SBC_DecoderReset(), it will search
- * for both a standard and an enhanced syncword.
+ * for both a standard and an enhanced syncword. If it has been configured for
+ * mSBC, it only searches for the mSBC syncword.
  */
 PRIVATE OI_STATUS FindSyncword(OI_CODEC_SBC_DECODER_CONTEXT* context,
                                const OI_BYTE** frameData,
@@ -56,6 +57,19 @@ PRIVATE OI_STATUS FindSyncword(OI_CODEC_SBC_DECODER_CONTEXT* context,
     return OI_CODEC_SBC_NOT_ENOUGH_HEADER_DATA;
   }
 
+  if (context->mSbcEnabled) {
+    /* An mSBC context only looks for mSBC frames */
+    while (*frameBytes && (**frameData != OI_SBC_MSBC_SYNCWORD)) {
+      (*frameBytes)--;
+      (*frameData)++;
+    }
+    if (*frameBytes) {
+      context->common.frameInfo.enhanced = FALSE;
+      return OI_OK;
+    }
+    return OI_CODEC_SBC_NO_SYNCWORD;
+  }
+
 #ifdef SBC_ENHANCED
   if (context->limitFrameFormat && context->enhancedEnabled) {
     /* If the context is restricted, only search for specified SYNCWORD */
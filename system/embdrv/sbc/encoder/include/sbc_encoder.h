@@ -66,6 +66,15 @@
 #define SBC_BLOCK_2 12
 #define SBC_BLOCK_3 16
 
+/* mSBC, the wideband speech codec of HFP, is SBC with a fixed configuration:
+ * 16 kHz, mono, 8 subbands, 15 blocks, loudness allocation and bitpool 26 */
+#define SBC_FORMAT_GENERAL 0
+#define SBC_FORMAT_MSBC 1
+
+#define SBC_MSBC_SYNCWORD 0xAD
+#define SBC_MSBC_BLOCKS 15
+#define SBC_MSBC_BITPOOL 26
+
 #define SBC_NULL 0
 
 #ifndef SBC_MAX_NUM_FRAME
@@ -172,6 +181,7 @@ typedef struct SBC_ENC_PARAMS_TAG {
   int16_t s16BitPool;          /* 16*numOfSb for mono & dual;
                                  32*numOfSb for stereo & joint stereo */
   uint16_t u16BitRate;
+  int16_t Format; /* SBC_FORMAT_GENERAL or SBC_FORMAT_MSBC */
 #if (SBC_JOINT_STE_INCLUDED == TRUE)
   int16_t as16Join[SBC_MAX_NUM_OF_SUBBANDS]; /*1 if JS, 0 otherwise*/
 #endif
@@ -325,8 +325,20 @@ AclManager::~AclManager() = default;
 void AclManager::impl::Dump(
     std::promise<flatbuffers::Offset<AclManagerData>> promise, flatbuffers::FlatBufferBuilder* fb_builder) const {
   auto title = fb_builder->CreateString("----- Acl Manager Dumpsys -----");
+  flatbuffers::Offset<LeAddressManagerData> le_address_manager_data;
+  if (le_impl_ != nullptr && le_impl_->le_address_manager_ != nullptr) {
+    auto statistics = le_impl_->le_address_manager_->GetStatistics();
+    LeAddressManagerDataBuilder le_address_manager_builder(*fb_builder);
+    le_address_manager_builder.add_pause_count(statistics.pause_count);
+    le_address_manager_builder.add_total_pause_time_ms(statistics.total_pause_time.count());
+    le_address_manager_builder.add_max_pause_time_ms(statistics.max_pause_time.count());
+    le_address_manager_builder.add_list_updates_requested(statistics.list_updates_requested);
+    le_address_manager_builder.add_list_commands_sent(statistics.list_commands_sent);
+    le_address_manager_data = le_address_manager_builder.Finish();
+  }
   AclManagerDataBuilder builder(*fb_builder);
   builder.add_title(title);
+  builder.add_le_address_manager(le_address_manager_data);
   flatbuffers::Offset<AclManagerData> dumpsys_data = builder.Finish();
   promise.set_value(dumpsys_data);
 }
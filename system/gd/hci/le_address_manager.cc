@@ -15,6 +15,10 @@
  */
 
 #include "hci/le_address_manager.h"
+
+#include <algorithm>
+#include <vector>
+
 #include "common/init_flags.h"
 #include "os/log.h"
 #include "os/rand.h"
@@ -23,6 +27,8 @@ namespace bluetooth {
 namespace hci {
 
 static constexpr uint8_t BLE_ADDR_MASK = 0xc0u;
+// Twice the HCI command timeout, only hit when a complete is lost on the way back
+static constexpr std::chrono::milliseconds kOutstandingCommandTimeoutMs = 2 * HciLayer::kHciTimeoutMs;
 
 LeAddressManager::LeAddressManager(
     common::Callback<void(std::unique_ptr<CommandBuilder>)> enqueue_command,
@@ -34,13 +40,16 @@ LeAddressManager::LeAddressManager(
       handler_(handler),
       public_address_(public_address),
       connect_list_size_(connect_list_size),
-      resolving_list_size_(resolving_list_size){};
+      resolving_list_size_(resolving_list_size),
+      outstanding_command_alarm_(std::make_unique<os::Alarm>(handler)){};
 
 LeAddressManager::~LeAddressManager() {
   if (address_rotation_alarm_ != nullptr) {
     address_rotation_alarm_->Cancel();
     address_rotation_alarm_.reset();
   }
+  outstanding_command_alarm_->Cancel();
+  outstanding_command_alarm_.reset();
 }
 
 // Aborts if called more than once
@@ -211,15 +220,37 @@ AddressWithType LeAddressManager::GetAnotherAddress() {
 void LeAddressManager::pause_registered_clients() {
   for (auto& client : registered_clients_) {
     if (client.second != ClientState::PAUSED && client.second != ClientState::WAITING_FOR_PAUSE) {
+      on_clients_paused();
       client.second = ClientState::WAITING_FOR_PAUSE;
       client.first->OnPause();
     }
   }
 }
 
-void LeAddressManager::push_command(Command command) {
-  pause_registered_clients();
-  cached_commands_.push(std::move(command));
+void LeAddressManager::on_clients_paused() {
+  if (pause_start_.has_value()) {
+    return;
+  }
+  pause_start_ = std::chrono::steady_clock::now();
+  std::unique_lock<std::mutex> lock(statistics_mutex_);
+  statistics_.pause_count++;
+}
+
+void LeAddressManager::on_clients_resumed() {
+  if (!pause_start_.has_value()) {
+    return;
+  }
+  auto pause_time =
+      std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - *pause_start_);
+  pause_start_.reset();
+  std::unique_lock<std::mutex> lock(statistics_mutex_);
+  statistics_.total_pause_time += pause_time;
+  statistics_.max_pause_time = std::max(statistics_.max_pause_time, pause_time);
+}
+
+LeAddressManager::Statistics LeAddressManager::GetStatistics() {
+  std::unique_lock<std::mutex> lock(statistics_mutex_);
+  return statistics_;
 }
 
 void LeAddressManager::ack_pause(LeAddressManagerCallback* callback) {
@@ -246,11 +277,12 @@ void LeAddressManager::ack_pause(LeAddressManagerCallback* callback) {
 
 void LeAddressManager::resume_registered_clients() {
   // Do not resume clients if cached command is not empty
-  if (!cached_commands_.empty()) {
+  if (!cached_commands_.empty() || has_pending_list_updates()) {
     handle_next_command();
     return;
   }
 
+  on_clients_resumed();
   for (auto& client : registered_clients_) {
     client.second = ClientState::WAITING_FOR_RESUME;
     client.first->OnResume();
@@ -380,9 +412,30 @@ void LeAddressManager::handle_next_command() {
     }
   }
 
-  ASSERT(!cached_commands_.empty());
+  if (outstanding_command_.has_value()) {
+    // The next command is sent when this one completes
+    return;
+  }
+
+  // List updates queued while the previous batch was sent go out in the same pause
+  if (cached_commands_.empty()) {
+    flush_connect_list_updates();
+    flush_resolving_list_updates();
+  }
+
+  if (cached_commands_.empty()) {
+    // The pending updates cancelled out or were already in the controller
+    resume_registered_clients();
+    return;
+  }
+
   auto command = std::move(cached_commands_.front());
   cached_commands_.pop();
+  outstanding_command_ =
+      Command{command.command_type, nullptr, command.connect_list_entry, command.resolving_list_entry};
+  outstanding_command_alarm_->Schedule(
+      common::BindOnce(&LeAddressManager::on_outstanding_command_timeout, common::Unretained(this)),
+      kOutstandingCommandTimeoutMs);
 
   if (command.command_type == CommandType::ROTATE_RANDOM_ADDRESS) {
     rotate_random_address();
@@ -393,9 +446,12 @@ void LeAddressManager::handle_next_command() {
 
 void LeAddressManager::AddDeviceToFilterAcceptList(
     FilterAcceptListAddressType connect_list_address_type, bluetooth::hci::Address address) {
-  auto packet_builder = hci::LeAddDeviceToFilterAcceptListBuilder::Create(connect_list_address_type, address);
-  Command command = {CommandType::ADD_DEVICE_TO_CONNECT_LIST, std::move(packet_builder)};
-  handler_->BindOnceOn(this, &LeAddressManager::push_command, std::move(command)).Invoke();
+  handler_->BindOnceOn(
+      this,
+      &LeAddressManager::queue_connect_list_update,
+      ConnectListEntry(connect_list_address_type, address),
+      true)
+      .Invoke();
 }
 
 void LeAddressManager::AddDeviceToResolvingList(
@@ -403,98 +459,207 @@ void LeAddressManager::AddDeviceToResolvingList(
     Address peer_identity_address,
     const std::array<uint8_t, 16>& peer_irk,
     const std::array<uint8_t, 16>& local_irk) {
-  // Disable Address resolution
-  auto disable_builder = hci::LeSetAddressResolutionEnableBuilder::Create(hci::Enable::DISABLED);
-  Command disable = {CommandType::SET_ADDRESS_RESOLUTION_ENABLE, std::move(disable_builder)};
-  cached_commands_.push(std::move(disable));
-
-  auto packet_builder = hci::LeAddDeviceToResolvingListBuilder::Create(
-      peer_identity_address_type, peer_identity_address, peer_irk, local_irk);
-  Command command = {CommandType::ADD_DEVICE_TO_RESOLVING_LIST, std::move(packet_builder)};
-  cached_commands_.push(std::move(command));
-
-  if (supports_ble_privacy_) {
-    auto packet_builder =
-        hci::LeSetPrivacyModeBuilder::Create(peer_identity_address_type, peer_identity_address, PrivacyMode::DEVICE);
-    Command command = {CommandType::LE_SET_PRIVACY_MODE, std::move(packet_builder)};
-    cached_commands_.push(std::move(command));
-  }
-
-  // Enable Address resolution
-  auto enable_builder = hci::LeSetAddressResolutionEnableBuilder::Create(hci::Enable::ENABLED);
-  Command enable = {CommandType::SET_ADDRESS_RESOLUTION_ENABLE, std::move(enable_builder)};
-  cached_commands_.push(std::move(enable));
-
-  if (registered_clients_.empty()) {
-    handler_->BindOnceOn(this, &LeAddressManager::handle_next_command).Invoke();
-  } else {
-    handler_->BindOnceOn(this, &LeAddressManager::pause_registered_clients).Invoke();
-  }
+  handler_->BindOnceOn(
+      this,
+      &LeAddressManager::queue_resolving_list_update,
+      ResolvingListEntry(peer_identity_address_type, peer_identity_address),
+      std::optional<ResolvingListKeys>(ResolvingListKeys{peer_irk, local_irk}))
+      .Invoke();
 }
 
 void LeAddressManager::RemoveDeviceFromFilterAcceptList(
     FilterAcceptListAddressType connect_list_address_type, bluetooth::hci::Address address) {
-  auto packet_builder = hci::LeRemoveDeviceFromFilterAcceptListBuilder::Create(connect_list_address_type, address);
-  Command command = {CommandType::REMOVE_DEVICE_FROM_CONNECT_LIST, std::move(packet_builder)};
-  handler_->BindOnceOn(this, &LeAddressManager::push_command, std::move(command)).Invoke();
+  handler_->BindOnceOn(
+      this,
+      &LeAddressManager::queue_connect_list_update,
+      ConnectListEntry(connect_list_address_type, address),
+      false)
+      .Invoke();
 }
 
 void LeAddressManager::RemoveDeviceFromResolvingList(
     PeerAddressType peer_identity_address_type, Address peer_identity_address) {
-  // Disable Address resolution
-  auto disable_builder = hci::LeSetAddressResolutionEnableBuilder::Create(hci::Enable::DISABLED);
-  Command disable = {CommandType::SET_ADDRESS_RESOLUTION_ENABLE, std::move(disable_builder)};
-  cached_commands_.push(std::move(disable));
+  handler_->BindOnceOn(
+      this,
+      &LeAddressManager::queue_resolving_list_update,
+      ResolvingListEntry(peer_identity_address_type, peer_identity_address),
+      std::optional<ResolvingListKeys>())
+      .Invoke();
+}
 
-  auto packet_builder =
-      hci::LeRemoveDeviceFromResolvingListBuilder::Create(peer_identity_address_type, peer_identity_address);
-  Command command = {CommandType::REMOVE_DEVICE_FROM_RESOLVING_LIST, std::move(packet_builder)};
-  cached_commands_.push(std::move(command));
+void LeAddressManager::ClearFilterAcceptList() {
+  handler_->BindOnceOn(this, &LeAddressManager::queue_connect_list_clear).Invoke();
+}
 
-  // Enable Address resolution
-  auto enable_builder = hci::LeSetAddressResolutionEnableBuilder::Create(hci::Enable::ENABLED);
-  Command enable = {CommandType::SET_ADDRESS_RESOLUTION_ENABLE, std::move(enable_builder)};
-  cached_commands_.push(std::move(enable));
+void LeAddressManager::ClearResolvingList() {
+  handler_->BindOnceOn(this, &LeAddressManager::queue_resolving_list_clear).Invoke();
+}
 
+void LeAddressManager::queue_connect_list_update(ConnectListEntry entry, bool add) {
+  pending_connect_list_updates_[entry] = add;
+  on_list_update_queued();
+}
+
+void LeAddressManager::queue_connect_list_clear() {
+  pending_connect_list_updates_.clear();
+  pending_connect_list_clear_ = true;
+  on_list_update_queued();
+}
+
+void LeAddressManager::queue_resolving_list_update(ResolvingListEntry entry, std::optional<ResolvingListKeys> keys) {
+  pending_resolving_list_updates_[entry] = keys;
+  on_list_update_queued();
+}
+
+void LeAddressManager::queue_resolving_list_clear() {
+  pending_resolving_list_updates_.clear();
+  pending_resolving_list_clear_ = true;
+  on_list_update_queued();
+}
+
+void LeAddressManager::on_list_update_queued() {
+  {
+    std::unique_lock<std::mutex> lock(statistics_mutex_);
+    statistics_.list_updates_requested++;
+  }
   if (registered_clients_.empty()) {
-    handler_->BindOnceOn(this, &LeAddressManager::handle_next_command).Invoke();
+    handle_next_command();
   } else {
-    handler_->BindOnceOn(this, &LeAddressManager::pause_registered_clients).Invoke();
+    pause_registered_clients();
   }
 }
 
-void LeAddressManager::ClearFilterAcceptList() {
-  auto packet_builder = hci::LeClearFilterAcceptListBuilder::Create();
-  Command command = {CommandType::CLEAR_CONNECT_LIST, std::move(packet_builder)};
-  handler_->BindOnceOn(this, &LeAddressManager::push_command, std::move(command)).Invoke();
+bool LeAddressManager::has_pending_list_updates() const {
+  return pending_connect_list_clear_ || !pending_connect_list_updates_.empty() || pending_resolving_list_clear_ ||
+         !pending_resolving_list_updates_.empty();
 }
 
-void LeAddressManager::ClearResolvingList() {
-  // Disable Address resolution
-  auto disable_builder = hci::LeSetAddressResolutionEnableBuilder::Create(hci::Enable::DISABLED);
-  Command disable = {CommandType::SET_ADDRESS_RESOLUTION_ENABLE, std::move(disable_builder)};
-  cached_commands_.push(std::move(disable));
+void LeAddressManager::flush_connect_list_updates() {
+  size_t queued_commands = cached_commands_.size();
 
-  auto packet_builder = hci::LeClearResolvingListBuilder::Create();
-  Command command = {CommandType::CLEAR_RESOLVING_LIST, std::move(packet_builder)};
-  cached_commands_.push(std::move(command));
+  if (pending_connect_list_clear_) {
+    // Clearing and adding back what is kept is only worth it when that takes fewer commands than removing what
+    // is not kept
+    size_t adds = 0;
+    size_t kept = 0;
+    for (const auto& update : pending_connect_list_updates_) {
+      if (update.second) {
+        adds++;
+        kept += connect_list_.count(update.first);
+      }
+    }
+    if (1 + adds <= (connect_list_.size() - kept) + (adds - kept)) {
+      auto packet_builder = hci::LeClearFilterAcceptListBuilder::Create();
+      cached_commands_.push({CommandType::CLEAR_CONNECT_LIST, std::move(packet_builder)});
+      connect_list_.clear();
+    } else {
+      for (const auto& entry : connect_list_) {
+        pending_connect_list_updates_.emplace(entry, false);
+      }
+    }
+    pending_connect_list_clear_ = false;
+  }
 
-  // Enable Address resolution
+  // Remove first to make room for the additions
+  for (const auto& update : pending_connect_list_updates_) {
+    if (!update.second && connect_list_.erase(update.first) > 0) {
+      auto packet_builder =
+          hci::LeRemoveDeviceFromFilterAcceptListBuilder::Create(update.first.first, update.first.second);
+      cached_commands_.push({CommandType::REMOVE_DEVICE_FROM_CONNECT_LIST, std::move(packet_builder), update.first});
+    }
+  }
+  for (const auto& update : pending_connect_list_updates_) {
+    if (update.second && connect_list_.insert(update.first).second) {
+      auto packet_builder = hci::LeAddDeviceToFilterAcceptListBuilder::Create(update.first.first, update.first.second);
+      cached_commands_.push({CommandType::ADD_DEVICE_TO_CONNECT_LIST, std::move(packet_builder), update.first});
+    }
+  }
+  pending_connect_list_updates_.clear();
+
+  std::unique_lock<std::mutex> lock(statistics_mutex_);
+  statistics_.list_commands_sent += cached_commands_.size() - queued_commands;
+}
+
+void LeAddressManager::flush_resolving_list_updates() {
+  std::vector<Command> commands;
+
+  if (pending_resolving_list_clear_) {
+    size_t adds = 0;
+    size_t kept = 0;
+    for (const auto& update : pending_resolving_list_updates_) {
+      if (update.second.has_value()) {
+        adds++;
+        auto entry = resolving_list_.find(update.first);
+        if (entry != resolving_list_.end() && entry->second == *update.second) {
+          kept++;
+        }
+      }
+    }
+    if (1 + adds <= (resolving_list_.size() - kept) + (adds - kept)) {
+      auto packet_builder = hci::LeClearResolvingListBuilder::Create();
+      commands.push_back({CommandType::CLEAR_RESOLVING_LIST, std::move(packet_builder)});
+      resolving_list_.clear();
+    } else {
+      for (const auto& entry : resolving_list_) {
+        pending_resolving_list_updates_.emplace(entry.first, std::nullopt);
+      }
+    }
+    pending_resolving_list_clear_ = false;
+  }
+
+  // Remove first to make room for the additions, including entries whose keys changed
+  for (const auto& update : pending_resolving_list_updates_) {
+    auto entry = resolving_list_.find(update.first);
+    if (entry == resolving_list_.end() || (update.second.has_value() && entry->second == *update.second)) {
+      continue;
+    }
+    resolving_list_.erase(entry);
+    auto packet_builder =
+        hci::LeRemoveDeviceFromResolvingListBuilder::Create(update.first.first, update.first.second);
+    commands.push_back(
+        {CommandType::REMOVE_DEVICE_FROM_RESOLVING_LIST, std::move(packet_builder), {}, update.first});
+  }
+  for (const auto& update : pending_resolving_list_updates_) {
+    if (!update.second.has_value() || !resolving_list_.emplace(update.first, *update.second).second) {
+      continue;
+    }
+    auto packet_builder = hci::LeAddDeviceToResolvingListBuilder::Create(
+        update.first.first, update.first.second, update.second->peer_irk, update.second->local_irk);
+    commands.push_back({CommandType::ADD_DEVICE_TO_RESOLVING_LIST, std::move(packet_builder), {}, update.first});
+
+    if (supports_ble_privacy_) {
+      auto packet_builder =
+          hci::LeSetPrivacyModeBuilder::Create(update.first.first, update.first.second, PrivacyMode::DEVICE);
+      commands.push_back({CommandType::LE_SET_PRIVACY_MODE, std::move(packet_builder)});
+    }
+  }
+  pending_resolving_list_updates_.clear();
+
+  if (commands.empty()) {
+    return;
+  }
+
+  // The resolving list can only be changed while address resolution is disabled, once for the whole batch
+  auto disable_builder = hci::LeSetAddressResolutionEnableBuilder::Create(hci::Enable::DISABLED);
+  cached_commands_.push({CommandType::SET_ADDRESS_RESOLUTION_ENABLE, std::move(disable_builder)});
+  for (auto& command : commands) {
+    cached_commands_.push(std::move(command));
+  }
   auto enable_builder = hci::LeSetAddressResolutionEnableBuilder::Create(hci::Enable::ENABLED);
-  Command enable = {CommandType::SET_ADDRESS_RESOLUTION_ENABLE, std::move(enable_builder)};
-  cached_commands_.push(std::move(enable));
+  cached_commands_.push({CommandType::SET_ADDRESS_RESOLUTION_ENABLE, std::move(enable_builder)});
 
-  handler_->BindOnceOn(this, &LeAddressManager::pause_registered_clients).Invoke();
+  std::unique_lock<std::mutex> lock(statistics_mutex_);
+  statistics_.list_commands_sent += commands.size();
 }
 
 template <class View>
-void LeAddressManager::on_command_complete(CommandCompleteView view) {
+ErrorCode LeAddressManager::on_command_complete(CommandCompleteView view) {
   auto op_code = view.GetCommandOpCode();
 
   auto complete_view = View::Create(view);
   if (!complete_view.IsValid()) {
     LOG_ERROR("Received %s complete with invalid packet", hci::OpCodeText(op_code).c_str());
-    return;
+    return ErrorCode::UNSPECIFIED_ERROR;
   }
   auto status = complete_view.GetStatus();
   if (status != ErrorCode::SUCCESS) {
@@ -503,16 +668,76 @@ void LeAddressManager::on_command_complete(CommandCompleteView view) {
         hci::OpCodeText(op_code).c_str(),
         ErrorCodeText(complete_view.GetStatus()).c_str());
   }
+  return status;
+}
+
+OpCode LeAddressManager::command_type_op_code(CommandType command_type) {
+  switch (command_type) {
+    case CommandType::ROTATE_RANDOM_ADDRESS:
+      return OpCode::LE_SET_RANDOM_ADDRESS;
+    case CommandType::ADD_DEVICE_TO_CONNECT_LIST:
+      return OpCode::LE_ADD_DEVICE_TO_FILTER_ACCEPT_LIST;
+    case CommandType::REMOVE_DEVICE_FROM_CONNECT_LIST:
+      return OpCode::LE_REMOVE_DEVICE_FROM_FILTER_ACCEPT_LIST;
+    case CommandType::CLEAR_CONNECT_LIST:
+      return OpCode::LE_CLEAR_FILTER_ACCEPT_LIST;
+    case CommandType::ADD_DEVICE_TO_RESOLVING_LIST:
+      return OpCode::LE_ADD_DEVICE_TO_RESOLVING_LIST;
+    case CommandType::REMOVE_DEVICE_FROM_RESOLVING_LIST:
+      return OpCode::LE_REMOVE_DEVICE_FROM_RESOLVING_LIST;
+    case CommandType::CLEAR_RESOLVING_LIST:
+      return OpCode::LE_CLEAR_RESOLVING_LIST;
+    case CommandType::SET_ADDRESS_RESOLUTION_ENABLE:
+      return OpCode::LE_SET_ADDRESS_RESOLUTION_ENABLE;
+    case CommandType::LE_SET_PRIVACY_MODE:
+      return OpCode::LE_SET_PRIVACY_MODE;
+  }
+  return OpCode::NONE;
+}
+
+std::optional<LeAddressManager::Command> LeAddressManager::take_outstanding_command() {
+  std::optional<Command> command = std::move(outstanding_command_);
+  outstanding_command_.reset();
+  outstanding_command_alarm_->Cancel();
+  return command;
+}
+
+void LeAddressManager::on_outstanding_command_timeout() {
+  if (!outstanding_command_.has_value()) {
+    return;
+  }
+  LOG_WARN(
+      "No complete received for %s, sending the next command",
+      OpCodeText(command_type_op_code(outstanding_command_->command_type)).c_str());
+  take_outstanding_command();
+  check_cached_commands();
 }
 
 void LeAddressManager::OnCommandComplete(bluetooth::hci::CommandCompleteView view) {
   if (!view.IsValid()) {
+    // Completions come back in order, so this one can only be for the outstanding command
     LOG_ERROR("Received command complete with invalid packet");
+    take_outstanding_command();
+    handler_->BindOnceOn(this, &LeAddressManager::check_cached_commands).Invoke();
     return;
   }
   auto op_code = view.GetCommandOpCode();
   LOG_INFO("Received command complete with op_code %s", OpCodeText(op_code).c_str());
 
+  std::optional<Command> completed;
+  if (outstanding_command_.has_value()) {
+    if (command_type_op_code(outstanding_command_->command_type) == op_code) {
+      completed = take_outstanding_command();
+    } else {
+      // Complete for a command sent outside of the queue, e.g. the initial random address; the outstanding
+      // command completes next
+      LOG_WARN(
+          "Received %s complete while waiting for %s",
+          OpCodeText(op_code).c_str(),
+          OpCodeText(command_type_op_code(outstanding_command_->command_type)).c_str());
+    }
+  }
+
   switch (op_code) {
     case OpCode::LE_SET_RANDOM_ADDRESS: {
       // The command was sent before any client registered, we can make sure all the clients paused when command
@@ -541,7 +766,10 @@ void LeAddressManager::OnCommandComplete(bluetooth::hci::CommandCompleteView vie
       break;
 
     case OpCode::LE_ADD_DEVICE_TO_RESOLVING_LIST:
-      on_command_complete<LeAddDeviceToResolvingListCompleteView>(view);
+      if (on_command_complete<LeAddDeviceToResolvingListCompleteView>(view) != ErrorCode::SUCCESS &&
+          completed.has_value()) {
+        resolving_list_.erase(completed->resolving_list_entry);
+      }
       break;
 
     case OpCode::LE_REMOVE_DEVICE_FROM_RESOLVING_LIST:
@@ -553,7 +781,10 @@ void LeAddressManager::OnCommandComplete(bluetooth::hci::CommandCompleteView vie
       break;
 
     case OpCode::LE_ADD_DEVICE_TO_FILTER_ACCEPT_LIST:
-      on_command_complete<LeAddDeviceToFilterAcceptListCompleteView>(view);
+      if (on_command_complete<LeAddDeviceToFilterAcceptListCompleteView>(view) != ErrorCode::SUCCESS &&
+          completed.has_value()) {
+        connect_list_.erase(completed->connect_list_entry);
+      }
       break;
 
     case OpCode::LE_REMOVE_DEVICE_FROM_FILTER_ACCEPT_LIST:
@@ -577,14 +808,15 @@ void LeAddressManager::OnCommandComplete(bluetooth::hci::CommandCompleteView vie
 }
 
 void LeAddressManager::check_cached_commands() {
+  bool has_commands = !cached_commands_.empty() || has_pending_list_updates();
   for (auto client : registered_clients_) {
-    if (client.second != ClientState::PAUSED && !cached_commands_.empty()) {
+    if (client.second != ClientState::PAUSED && has_commands) {
       pause_registered_clients();
       return;
     }
   }
 
-  if (cached_commands_.empty()) {
+  if (!has_commands) {
     resume_registered_clients();
   } else {
     handle_next_command();
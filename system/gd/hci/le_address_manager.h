@@ -15,9 +15,12 @@
  */
 #pragma once
 
+#include <chrono>
 #include <map>
 #include <mutex>
+#include <optional>
 #include <set>
+#include <utility>
 
 #include "common/callback.h"
 #include "hci/address_with_type.h"
@@ -94,6 +97,18 @@ class LeAddressManager {
   void OnCommandComplete(CommandCompleteView view);
   std::chrono::milliseconds GetNextPrivateAddressIntervalMs();
 
+  struct Statistics {
+    // Number of times the registered clients were paused, and for how long
+    uint32_t pause_count = 0;
+    std::chrono::milliseconds total_pause_time{0};
+    std::chrono::milliseconds max_pause_time{0};
+    // Filter accept and resolving list changes requested, and the list
+    // commands actually sent to the controller for them
+    uint32_t list_updates_requested = 0;
+    uint32_t list_commands_sent = 0;
+  };
+  Statistics GetStatistics();
+
  private:
   enum ClientState {
     WAITING_FOR_PAUSE,
@@ -114,13 +129,26 @@ class LeAddressManager {
     LE_SET_PRIVACY_MODE
   };
 
+  using ConnectListEntry = std::pair<FilterAcceptListAddressType, Address>;
+  using ResolvingListEntry = std::pair<PeerAddressType, Address>;
+
+  struct ResolvingListKeys {
+    std::array<uint8_t, 16> peer_irk;
+    std::array<uint8_t, 16> local_irk;
+    bool operator==(const ResolvingListKeys& other) const {
+      return peer_irk == other.peer_irk && local_irk == other.local_irk;
+    }
+  };
+
   struct Command {
     CommandType command_type;
     std::unique_ptr<CommandBuilder> command_packet;
+    // The list entry changed by the command, if any
+    ConnectListEntry connect_list_entry{};
+    ResolvingListEntry resolving_list_entry{};
   };
 
   void pause_registered_clients();
-  void push_command(Command command);
   void ack_pause(LeAddressManagerCallback* callback);
   void resume_registered_clients();
   void ack_resume(LeAddressManagerCallback* callback);
@@ -134,8 +162,21 @@ class LeAddressManager {
   hci::Address generate_nrpa();
   void handle_next_command();
   void check_cached_commands();
+  std::optional<Command> take_outstanding_command();
+  void on_outstanding_command_timeout();
+  void queue_connect_list_update(ConnectListEntry entry, bool add);
+  void queue_connect_list_clear();
+  void queue_resolving_list_update(ResolvingListEntry entry, std::optional<ResolvingListKeys> keys);
+  void queue_resolving_list_clear();
+  void on_list_update_queued();
+  bool has_pending_list_updates() const;
+  void flush_connect_list_updates();
+  void flush_resolving_list_updates();
+  void on_clients_paused();
+  void on_clients_resumed();
   template <class View>
-  void on_command_complete(CommandCompleteView view);
+  ErrorCode on_command_complete(CommandCompleteView view);
+  static OpCode command_type_op_code(CommandType command_type);
 
   common::Callback<void(std::unique_ptr<CommandBuilder>)> enqueue_command_;
   os::Handler* handler_;
@@ -153,6 +194,28 @@ class LeAddressManager {
   uint8_t resolving_list_size_;
   std::queue<Command> cached_commands_;
   bool supports_ble_privacy_{false};
+
+  // Filter accept and resolving list changes not turned into commands yet.
+  // Changes are coalesced per entry, the last one wins, and are only sent
+  // when they differ from what the controller already holds according to
+  // the mirrors below. All pending changes are sent in the same pause.
+  bool pending_connect_list_clear_{false};
+  std::map<ConnectListEntry, bool> pending_connect_list_updates_;
+  bool pending_resolving_list_clear_{false};
+  std::map<ResolvingListEntry, std::optional<ResolvingListKeys>> pending_resolving_list_updates_;
+
+  // What the controller lists hold once the commands sent so far complete
+  std::set<ConnectListEntry> connect_list_;
+  std::map<ResolvingListEntry, ResolvingListKeys> resolving_list_;
+
+  // The command sent to the controller and not completed yet, if any. It is
+  // dropped when its complete is lost, so that later commands still go out.
+  std::optional<Command> outstanding_command_;
+  std::unique_ptr<os::Alarm> outstanding_command_alarm_;
+
+  std::optional<std::chrono::steady_clock::time_point> pause_start_;
+  std::mutex statistics_mutex_;
+  Statistics statistics_;
 };
 
 }  // namespace hci
@@ -0,0 +1,217 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <array>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "hci/le_address_manager.h"
+#include "os/handler.h"
+#include "os/thread.h"
+#include "packet/raw_builder.h"
+
+using ::benchmark::State;
+
+namespace bluetooth {
+namespace hci {
+namespace {
+
+using packet::kLittleEndian;
+using packet::PacketView;
+using packet::RawBuilder;
+
+constexpr int kNumDevices = 256;
+constexpr uint8_t kListSize = 0xFF;
+
+PacketView<kLittleEndian> GetPacketView(std::unique_ptr<packet::BasePacketBuilder> packet) {
+  auto bytes = std::make_shared<std::vector<uint8_t>>();
+  bytes->reserve(packet->size());
+  BitInserter i(*bytes);
+  packet->Serialize(i);
+  return PacketView<kLittleEndian>(bytes);
+}
+
+Address DeviceAddress(int i) {
+  return Address({0x00, 0x11, 0x22, 0x33, static_cast<uint8_t>(i >> 8), static_cast<uint8_t>(i & 0xff)});
+}
+
+// Acknowledges pause and resume right away, like le_impl and the scanning and advertising managers do. Only used on
+// the handler thread.
+class ImmediateClient : public LeAddressManagerCallback {
+ public:
+  void OnPause() override {
+    paused_ = true;
+    le_address_manager_->AckPause(this);
+  }
+
+  void OnResume() override {
+    paused_ = false;
+    le_address_manager_->AckResume(this);
+    if (idle_promise_ != nullptr) {
+      idle_promise_->set_value();
+      idle_promise_.reset();
+    }
+  }
+
+  // Clients are only resumed once every queued update has been programmed
+  void NotifyWhenIdle(std::unique_ptr<std::promise<void>> promise) {
+    if (paused_) {
+      idle_promise_ = std::move(promise);
+    } else {
+      promise->set_value();
+    }
+  }
+
+  LeAddressManager* le_address_manager_ = nullptr;
+  bool paused_ = false;
+  std::unique_ptr<std::promise<void>> idle_promise_;
+};
+
+// Programs kNumDevices devices into the controller lists and waits until the clients are resumed. The controller
+// completes every command successfully on the next turn of the handler. Reports the list commands sent and the times
+// the clients were paused per iteration.
+class BM_LeAddressManagerListProgramming : public ::benchmark::Fixture {
+ protected:
+  void SetUp(State& st) override {
+    ::benchmark::Fixture::SetUp(st);
+    thread_ = std::make_unique<os::Thread>("le_address_manager_benchmark", os::Thread::Priority::NORMAL);
+    handler_ = std::make_unique<os::Handler>(thread_.get());
+    le_address_manager_ = std::make_unique<LeAddressManager>(
+        common::Bind(&BM_LeAddressManagerListProgramming::EnqueueCommand, common::Unretained(this)),
+        handler_.get(),
+        Address({0x01, 0x02, 0x03, 0x04, 0x05, 0x06}),
+        kListSize,
+        kListSize);
+    le_address_manager_->SetPrivacyPolicyForInitiatorAddress(
+        LeAddressManager::AddressPolicy::USE_PUBLIC_ADDRESS,
+        AddressWithType(),
+        {},
+        true,
+        std::chrono::milliseconds(0),
+        std::chrono::milliseconds(0));
+    client_.le_address_manager_ = le_address_manager_.get();
+    le_address_manager_->Register(&client_);
+  }
+
+  void TearDown(State& st) override {
+    le_address_manager_->UnregisterSync(&client_);
+    handler_->Clear();
+    le_address_manager_.reset();
+    handler_.reset();
+    thread_.reset();
+    ::benchmark::Fixture::TearDown(st);
+  }
+
+  void EnqueueCommand(std::unique_ptr<CommandBuilder> command) {
+    auto command_view = CommandView::Create(GetPacketView(std::move(command)));
+    std::vector<uint8_t> success = {static_cast<uint8_t>(ErrorCode::SUCCESS)};
+    auto event = EventView::Create(GetPacketView(
+        CommandCompleteBuilder::Create(uint8_t{1}, command_view.GetOpCode(), std::make_unique<RawBuilder>(success))));
+    handler_->Post(common::BindOnce(
+        &LeAddressManager::OnCommandComplete,
+        common::Unretained(le_address_manager_.get()),
+        CommandCompleteView::Create(event)));
+  }
+
+  template <typename Updates>
+  void RunAndWait(Updates updates) {
+    updates();
+    // Runs after all the updates were queued on the handler
+    auto promise = std::make_unique<std::promise<void>>();
+    auto idle = promise->get_future();
+    handler_->Post(common::BindOnce(
+        &ImmediateClient::NotifyWhenIdle, common::Unretained(&client_), common::Passed(std::move(promise))));
+    idle.wait();
+  }
+
+  template <typename Updates>
+  void Run(State& state, Updates updates) {
+    uint64_t commands_sent = 0;
+    uint64_t pauses = 0;
+    for (auto _ : state) {
+      auto before = le_address_manager_->GetStatistics();
+      RunAndWait(updates);
+      auto after = le_address_manager_->GetStatistics();
+      commands_sent += after.list_commands_sent - before.list_commands_sent;
+      pauses += after.pause_count - before.pause_count;
+
+      state.PauseTiming();
+      RunAndWait([this]() {
+        le_address_manager_->ClearFilterAcceptList();
+        le_address_manager_->ClearResolvingList();
+      });
+      state.ResumeTiming();
+    }
+    state.counters["list_commands"] = ::benchmark::Counter(commands_sent, ::benchmark::Counter::kAvgIterations);
+    state.counters["pauses"] = ::benchmark::Counter(pauses, ::benchmark::Counter::kAvgIterations);
+    state.SetItemsProcessed(state.iterations() * kNumDevices);
+  }
+
+  void AddToFilterAcceptList() {
+    for (int i = 0; i < kNumDevices; i++) {
+      le_address_manager_->AddDeviceToFilterAcceptList(FilterAcceptListAddressType::PUBLIC, DeviceAddress(i));
+    }
+  }
+
+  void AddToResolvingList() {
+    std::array<uint8_t, 16> peer_irk = {0xec, 0x02, 0x34, 0xa3, 0x57, 0xc8, 0xad, 0x05,
+                                        0x34, 0x10, 0x10, 0xa6, 0x0a, 0x39, 0x7d, 0x9b};
+    std::array<uint8_t, 16> local_irk = {};
+    for (int i = 0; i < kNumDevices; i++) {
+      le_address_manager_->AddDeviceToResolvingList(
+          PeerAddressType::PUBLIC_DEVICE_OR_IDENTITY_ADDRESS, DeviceAddress(i), peer_irk, local_irk);
+    }
+  }
+
+  std::unique_ptr<os::Thread> thread_;
+  std::unique_ptr<os::Handler> handler_;
+  std::unique_ptr<LeAddressManager> le_address_manager_;
+  ImmediateClient client_;
+};
+
+BENCHMARK_F(BM_LeAddressManagerListProgramming, filter_accept_list)(State& state) {
+  Run(state, [this]() { AddToFilterAcceptList(); });
+}
+
+BENCHMARK_F(BM_LeAddressManagerListProgramming, resolving_list)(State& state) {
+  Run(state, [this]() { AddToResolvingList(); });
+}
+
+BENCHMARK_F(BM_LeAddressManagerListProgramming, both_lists)(State& state) {
+  Run(state, [this]() {
+    AddToFilterAcceptList();
+    AddToResolvingList();
+  });
+}
+
+// Every device is added, removed again and added back, as happens when a connection attempt is cancelled and
+// restarted. Only the final state is programmed.
+BENCHMARK_F(BM_LeAddressManagerListProgramming, filter_accept_list_churn)(State& state) {
+  Run(state, [this]() {
+    for (int i = 0; i < kNumDevices; i++) {
+      le_address_manager_->AddDeviceToFilterAcceptList(FilterAcceptListAddressType::PUBLIC, DeviceAddress(i));
+      le_address_manager_->RemoveDeviceFromFilterAcceptList(FilterAcceptListAddressType::PUBLIC, DeviceAddress(i));
+    }
+    AddToFilterAcceptList();
+  });
+}
+
+}  // namespace
+}  // namespace hci
+}  // namespace bluetooth
@@ -70,6 +70,11 @@ class TestHciLayer : public HciLayer {
     return CommandView::Create(GetPacketView(std::move(last)));
   }
 
+  bool IsCommandQueueEmpty() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return command_queue_.empty();
+  }
+
   CommandView GetCommand(OpCode op_code) {
     if (!command_queue_.empty()) {
       std::lock_guard<std::mutex> lock(mutex_);
@@ -216,6 +221,7 @@ TEST_F(LeAddressManagerTest, rotator_address_for_single_client) {
       LeAddressManager::AddressPolicy::USE_RESOLVABLE_ADDRESS,
       remote_address,
       irk,
+      false,
       minimum_rotation_time,
       maximum_rotation_time);
 
@@ -238,6 +244,7 @@ TEST_F(LeAddressManagerTest, rotator_non_resolvable_address_for_single_client) {
       LeAddressManager::AddressPolicy::USE_NON_RESOLVABLE_ADDRESS,
       remote_address,
       irk,
+      false,
       minimum_rotation_time,
       maximum_rotation_time);
 
@@ -262,6 +269,7 @@ TEST_F(LeAddressManagerTest, DISABLED_rotator_address_for_multiple_clients) {
       LeAddressManager::AddressPolicy::USE_RESOLVABLE_ADDRESS,
       remote_address,
       irk,
+      false,
       minimum_rotation_time,
       maximum_rotation_time);
   le_address_manager_->Register(clients[0].get());
@@ -299,6 +307,7 @@ class LeAddressManagerWithSingleClientTest : public LeAddressManagerTest {
         LeAddressManager::AddressPolicy::USE_RESOLVABLE_ADDRESS,
         remote_address,
         irk,
+        false,
         minimum_rotation_time,
         maximum_rotation_time);
 
@@ -315,6 +324,14 @@ class LeAddressManagerWithSingleClientTest : public LeAddressManagerTest {
         handler_->BindOnce(&LeAddressManager::OnCommandComplete, common::Unretained(le_address_manager_)));
   }
 
+  // Checks the address resolution enable command sent around each resolving list batch
+  void ExpectAddressResolutionEnable(Enable enable) {
+    auto packet = test_hci_layer_->GetCommand(OpCode::LE_SET_ADDRESS_RESOLUTION_ENABLE);
+    auto packet_view = LeSetAddressResolutionEnableView::Create(LeSecurityCommandView::Create(packet));
+    ASSERT_TRUE(packet_view.IsValid());
+    ASSERT_EQ(enable, packet_view.GetAddressResolutionEnable());
+  }
+
   void TearDown() override {
     le_address_manager_->Unregister(clients[0].get());
     sync_handler(handler_);
@@ -385,6 +402,9 @@ TEST_F(LeAddressManagerWithSingleClientTest, add_device_to_resolving_list) {
   test_hci_layer_->SetCommandFuture();
   le_address_manager_->AddDeviceToResolvingList(
       PeerAddressType::RANDOM_DEVICE_OR_IDENTITY_ADDRESS, address, peer_irk, local_irk);
+  ExpectAddressResolutionEnable(Enable::DISABLED);
+  test_hci_layer_->SetCommandFuture();
+  test_hci_layer_->IncomingEvent(LeSetAddressResolutionEnableCompleteBuilder::Create(0x01, ErrorCode::SUCCESS));
   auto packet = test_hci_layer_->GetCommand(OpCode::LE_ADD_DEVICE_TO_RESOLVING_LIST);
   auto packet_view = LeAddDeviceToResolvingListView::Create(LeSecurityCommandView::Create(packet));
   ASSERT_TRUE(packet_view.IsValid());
@@ -393,7 +413,10 @@ TEST_F(LeAddressManagerWithSingleClientTest, add_device_to_resolving_list) {
   ASSERT_EQ(peer_irk, packet_view.GetPeerIrk());
   ASSERT_EQ(local_irk, packet_view.GetLocalIrk());
 
+  test_hci_layer_->SetCommandFuture();
   test_hci_layer_->IncomingEvent(LeAddDeviceToResolvingListCompleteBuilder::Create(0x01, ErrorCode::SUCCESS));
+  ExpectAddressResolutionEnable(Enable::ENABLED);
+  test_hci_layer_->IncomingEvent(LeSetAddressResolutionEnableCompleteBuilder::Create(0x01, ErrorCode::SUCCESS));
   clients[0].get()->WaitForResume();
 }
 
@@ -405,17 +428,30 @@ TEST_F(LeAddressManagerWithSingleClientTest, remove_device_from_resolving_list)
   test_hci_layer_->SetCommandFuture();
   le_address_manager_->AddDeviceToResolvingList(
       PeerAddressType::RANDOM_DEVICE_OR_IDENTITY_ADDRESS, address, peer_irk, local_irk);
+  ExpectAddressResolutionEnable(Enable::DISABLED);
+  test_hci_layer_->SetCommandFuture();
+  test_hci_layer_->IncomingEvent(LeSetAddressResolutionEnableCompleteBuilder::Create(0x01, ErrorCode::SUCCESS));
   test_hci_layer_->GetCommand(OpCode::LE_ADD_DEVICE_TO_RESOLVING_LIST);
+  test_hci_layer_->SetCommandFuture();
   test_hci_layer_->IncomingEvent(LeAddDeviceToResolvingListCompleteBuilder::Create(0x01, ErrorCode::SUCCESS));
+  ExpectAddressResolutionEnable(Enable::ENABLED);
+  test_hci_layer_->IncomingEvent(LeSetAddressResolutionEnableCompleteBuilder::Create(0x01, ErrorCode::SUCCESS));
+  clients[0].get()->WaitForResume();
 
   test_hci_layer_->SetCommandFuture();
   le_address_manager_->RemoveDeviceFromResolvingList(PeerAddressType::RANDOM_DEVICE_OR_IDENTITY_ADDRESS, address);
+  ExpectAddressResolutionEnable(Enable::DISABLED);
+  test_hci_layer_->SetCommandFuture();
+  test_hci_layer_->IncomingEvent(LeSetAddressResolutionEnableCompleteBuilder::Create(0x01, ErrorCode::SUCCESS));
   auto packet = test_hci_layer_->GetCommand(OpCode::LE_REMOVE_DEVICE_FROM_RESOLVING_LIST);
   auto packet_view = LeRemoveDeviceFromResolvingListView::Create(LeSecurityCommandView::Create(packet));
   ASSERT_TRUE(packet_view.IsValid());
   ASSERT_EQ(PeerAddressType::RANDOM_DEVICE_OR_IDENTITY_ADDRESS, packet_view.GetPeerIdentityAddressType());
   ASSERT_EQ(address, packet_view.GetPeerIdentityAddress());
+  test_hci_layer_->SetCommandFuture();
   test_hci_layer_->IncomingEvent(LeRemoveDeviceFromResolvingListCompleteBuilder::Create(0x01, ErrorCode::SUCCESS));
+  ExpectAddressResolutionEnable(Enable::ENABLED);
+  test_hci_layer_->IncomingEvent(LeSetAddressResolutionEnableCompleteBuilder::Create(0x01, ErrorCode::SUCCESS));
   clients[0].get()->WaitForResume();
 }
 
@@ -427,15 +463,28 @@ TEST_F(LeAddressManagerWithSingleClientTest, clear_resolving_list) {
   test_hci_layer_->SetCommandFuture();
   le_address_manager_->AddDeviceToResolvingList(
       PeerAddressType::RANDOM_DEVICE_OR_IDENTITY_ADDRESS, address, peer_irk, local_irk);
+  ExpectAddressResolutionEnable(Enable::DISABLED);
+  test_hci_layer_->SetCommandFuture();
+  test_hci_layer_->IncomingEvent(LeSetAddressResolutionEnableCompleteBuilder::Create(0x01, ErrorCode::SUCCESS));
   test_hci_layer_->GetCommand(OpCode::LE_ADD_DEVICE_TO_RESOLVING_LIST);
+  test_hci_layer_->SetCommandFuture();
   test_hci_layer_->IncomingEvent(LeAddDeviceToResolvingListCompleteBuilder::Create(0x01, ErrorCode::SUCCESS));
+  ExpectAddressResolutionEnable(Enable::ENABLED);
+  test_hci_layer_->IncomingEvent(LeSetAddressResolutionEnableCompleteBuilder::Create(0x01, ErrorCode::SUCCESS));
+  clients[0].get()->WaitForResume();
 
   test_hci_layer_->SetCommandFuture();
   le_address_manager_->ClearResolvingList();
+  ExpectAddressResolutionEnable(Enable::DISABLED);
+  test_hci_layer_->SetCommandFuture();
+  test_hci_layer_->IncomingEvent(LeSetAddressResolutionEnableCompleteBuilder::Create(0x01, ErrorCode::SUCCESS));
   auto packet = test_hci_layer_->GetCommand(OpCode::LE_CLEAR_RESOLVING_LIST);
   auto packet_view = LeClearResolvingListView::Create(LeSecurityCommandView::Create(packet));
   ASSERT_TRUE(packet_view.IsValid());
+  test_hci_layer_->SetCommandFuture();
   test_hci_layer_->IncomingEvent(LeClearResolvingListCompleteBuilder::Create(0x01, ErrorCode::SUCCESS));
+  ExpectAddressResolutionEnable(Enable::ENABLED);
+  test_hci_layer_->IncomingEvent(LeSetAddressResolutionEnableCompleteBuilder::Create(0x01, ErrorCode::SUCCESS));
   clients[0].get()->WaitForResume();
 }
 
@@ -459,5 +508,103 @@ TEST_F(LeAddressManagerWithSingleClientTest, register_during_command_complete) {
   clients[1].get()->WaitForResume();
 }
 
+TEST_F(LeAddressManagerWithSingleClientTest, skip_device_already_in_connect_list) {
+  Address address;
+  Address::FromString("01:02:03:04:05:06", address);
+  Address other_address;
+  Address::FromString("01:02:03:04:05:07", other_address);
+  test_hci_layer_->SetCommandFuture();
+  le_address_manager_->AddDeviceToFilterAcceptList(FilterAcceptListAddressType::RANDOM, address);
+  test_hci_layer_->GetCommand(OpCode::LE_ADD_DEVICE_TO_FILTER_ACCEPT_LIST);
+  test_hci_layer_->IncomingEvent(LeAddDeviceToFilterAcceptListCompleteBuilder::Create(0x01, ErrorCode::SUCCESS));
+  clients[0].get()->WaitForResume();
+
+  // Already in the controller list, nothing is sent for it
+  le_address_manager_->AddDeviceToFilterAcceptList(FilterAcceptListAddressType::RANDOM, address);
+  sync_handler(handler_);
+  clients[0].get()->WaitForResume();
+
+  test_hci_layer_->SetCommandFuture();
+  le_address_manager_->AddDeviceToFilterAcceptList(FilterAcceptListAddressType::RANDOM, other_address);
+  auto packet = test_hci_layer_->GetCommand(OpCode::LE_ADD_DEVICE_TO_FILTER_ACCEPT_LIST);
+  auto packet_view = LeAddDeviceToFilterAcceptListView::Create(
+      LeConnectionManagementCommandView::Create(AclCommandView::Create(packet)));
+  ASSERT_TRUE(packet_view.IsValid());
+  ASSERT_EQ(other_address, packet_view.GetAddress());
+  test_hci_layer_->IncomingEvent(LeAddDeviceToFilterAcceptListCompleteBuilder::Create(0x01, ErrorCode::SUCCESS));
+  clients[0].get()->WaitForResume();
+
+  auto statistics = le_address_manager_->GetStatistics();
+  ASSERT_EQ(3u, statistics.list_updates_requested);
+  ASSERT_EQ(2u, statistics.list_commands_sent);
+}
+
+TEST_F(LeAddressManagerWithSingleClientTest, add_then_remove_sends_nothing) {
+  Address address;
+  Address::FromString("01:02:03:04:05:06", address);
+  // Queue both from the handler so that they are coalesced while the client is being paused
+  handler_->Post(common::BindOnce(
+      [](LeAddressManager* le_address_manager, Address address) {
+        le_address_manager->AddDeviceToFilterAcceptList(FilterAcceptListAddressType::RANDOM, address);
+        le_address_manager->RemoveDeviceFromFilterAcceptList(FilterAcceptListAddressType::RANDOM, address);
+      },
+      common::Unretained(le_address_manager_),
+      address));
+  sync_handler(handler_);
+  sync_handler(handler_);
+  clients[0].get()->WaitForResume();
+  ASSERT_TRUE(test_hci_layer_->IsCommandQueueEmpty());
+
+  auto statistics = le_address_manager_->GetStatistics();
+  ASSERT_EQ(2u, statistics.list_updates_requested);
+  ASSERT_EQ(0u, statistics.list_commands_sent);
+}
+
+TEST_F(LeAddressManagerWithSingleClientTest, resolving_list_batch_disables_resolution_once) {
+  Address address;
+  Address::FromString("01:02:03:04:05:06", address);
+  Address other_address;
+  Address::FromString("01:02:03:04:05:07", other_address);
+  Octet16 peer_irk = {0xec, 0x02, 0x34, 0xa3, 0x57, 0xc8, 0xad, 0x05, 0x34, 0x10, 0x10, 0xa6, 0x0a, 0x39, 0x7d, 0x9b};
+  Octet16 local_irk = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10};
+  test_hci_layer_->SetCommandFuture();
+  handler_->Post(common::BindOnce(
+      [](LeAddressManager* le_address_manager,
+         Address address,
+         Address other_address,
+         Octet16 peer_irk,
+         Octet16 local_irk) {
+        le_address_manager->AddDeviceToResolvingList(
+            PeerAddressType::RANDOM_DEVICE_OR_IDENTITY_ADDRESS, address, peer_irk, local_irk);
+        le_address_manager->AddDeviceToResolvingList(
+            PeerAddressType::RANDOM_DEVICE_OR_IDENTITY_ADDRESS, other_address, peer_irk, local_irk);
+      },
+      common::Unretained(le_address_manager_),
+      address,
+      other_address,
+      peer_irk,
+      local_irk));
+
+  ExpectAddressResolutionEnable(Enable::DISABLED);
+  test_hci_layer_->SetCommandFuture();
+  test_hci_layer_->IncomingEvent(LeSetAddressResolutionEnableCompleteBuilder::Create(0x01, ErrorCode::SUCCESS));
+  for (const auto& expected_address : {address, other_address}) {
+    auto packet = test_hci_layer_->GetCommand(OpCode::LE_ADD_DEVICE_TO_RESOLVING_LIST);
+    auto packet_view = LeAddDeviceToResolvingListView::Create(LeSecurityCommandView::Create(packet));
+    ASSERT_TRUE(packet_view.IsValid());
+    ASSERT_EQ(expected_address, packet_view.GetPeerIdentityAddress());
+    test_hci_layer_->SetCommandFuture();
+    test_hci_layer_->IncomingEvent(LeAddDeviceToResolvingListCompleteBuilder::Create(0x01, ErrorCode::SUCCESS));
+  }
+  ExpectAddressResolutionEnable(Enable::ENABLED);
+  test_hci_layer_->IncomingEvent(LeSetAddressResolutionEnableCompleteBuilder::Create(0x01, ErrorCode::SUCCESS));
+  clients[0].get()->WaitForResume();
+  ASSERT_TRUE(test_hci_layer_->IsCommandQueueEmpty());
+
+  auto statistics = le_address_manager_->GetStatistics();
+  ASSERT_EQ(2u, statistics.list_updates_requested);
+  ASSERT_EQ(2u, statistics.list_commands_sent);
+}
+
 }  // namespace hci
 }  // namespace bluetooth
@@ -15,16 +15,22 @@
  */
 #include "hci/le_advertising_manager.h"
 
+#include <algorithm>
+#include <chrono>
 #include <memory>
 #include <mutex>
+#include <optional>
+#include <set>
 
 #include "common/init_flags.h"
+#include "common/strings.h"
 #include "hci/acl_manager.h"
 #include "hci/controller.h"
 #include "hci/hci_layer.h"
 #include "hci/hci_packets.h"
 #include "hci/le_advertising_interface.h"
 #include "module.h"
+#include "os/alarm.h"
 #include "os/handler.h"
 #include "os/log.h"
 #include "os/system_properties.h"
@@ -34,6 +40,11 @@ namespace hci {
 
 const ModuleFactory LeAdvertisingManager::Factory = ModuleFactory([]() { return new LeAdvertisingManager(); });
 constexpr int kIdLocal = 0xff;  // Id for advertiser not register from Java layer
+// Number of advertisers, which take turns on the advertising sets of the controller when there are more of them
+constexpr char kMaxAdvertisersProperty[] = "bluetooth.le.max_advertisers";
+// How long advertisers stay on air before the next ones take their turn
+constexpr char kAdvertisingSliceProperty[] = "bluetooth.le.advertising_slice_ms";
+constexpr std::chrono::milliseconds kDefaultAdvertisingSlice = std::chrono::milliseconds(1000);
 
 enum class AdvertisingApiType {
   LEGACY = 1,
@@ -64,8 +75,52 @@ struct Advertiser {
   bool directed = false;
   bool in_use = false;
   std::unique_ptr<os::Alarm> address_rotation_alarm;
+  // Enabled by its owner, whether or not it is on air
+  bool enabled = false;
+  // Advertising set of the controller holding the advertiser, kInvalidHandle while it has none
+  uint8_t handle = LeAdvertisingManager::kInvalidHandle;
+  // What to load into an advertising set, when the advertiser takes its turn on one
+  ExtendedAdvertisingConfig config;
+  std::vector<GapData> advertisement;
+  std::vector<GapData> scan_response;
+  std::optional<PeriodicAdvertisingParameters> periodic_parameters;
+  std::vector<GapData> periodic_data;
+  bool periodic_enabled = false;
 };
 
+// Advertising or scan response data of an advertising set, remembered once the controller holds it
+struct SentData {
+  // Unknown when empty, such as while commands setting it are in flight or after one of them failed
+  std::optional<std::vector<GapData>> data;
+  // Held by the controller once the fragments in flight succeed
+  std::vector<GapData> last_sent;
+  uint8_t in_flight = 0;
+  bool failed = false;
+};
+
+// An advertising set of the controller, taken in turns by advertisers
+struct HardwareAdvertisingSet {
+  AdvertiserId owner = LeAdvertisingManager::kInvalidId;
+  // Whether the parameters and data of the owner were sent to the controller
+  bool loaded = false;
+  SentData advertisement;
+  SentData scan_response;
+};
+
+// Enable or disable of an advertising set, sent with the other pending ones in a single command
+struct PendingEnableChange {
+  AdvertiserId advertiser_id;
+  uint8_t handle;
+  // Whether the owner of the advertiser asked for it, and expects a callback
+  bool report;
+};
+
+static bool IsSameData(const std::vector<GapData>& a, const std::vector<GapData>& b) {
+  return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](const GapData& x, const GapData& y) {
+    return x.data_type_ == y.data_type_ && x.data_ == y.data_;
+  });
+}
+
 ExtendedAdvertisingConfig::ExtendedAdvertisingConfig(const AdvertisingConfig& config) : AdvertisingConfig(config) {
   switch (config.advertising_type) {
     case AdvertisingType::ADV_IND:
@@ -113,10 +168,6 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
     le_advertising_interface_ =
         hci_layer_->GetLeAdvertisingInterface(module_handler_->BindOn(this, &LeAdvertisingManager::impl::handle_event));
     num_instances_ = controller_->GetLeNumberOfSupportedAdverisingSets();
-    enabled_sets_ = std::vector<EnabledSet>(num_instances_);
-    for (size_t i = 0; i < enabled_sets_.size(); i++) {
-      enabled_sets_[i].advertising_handle_ = kInvalidHandle;
-    }
 
     if (controller_->SupportsBleExtendedAdvertising()) {
       advertising_api_type_ = AdvertisingApiType::EXTENDED;
@@ -137,6 +188,49 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
             handler->BindOnceOn(this, &impl::on_read_advertising_physical_channel_tx_power));
       }
     }
+
+    enabled_sets_ = std::vector<EnabledSet>(num_instances_);
+    for (size_t i = 0; i < enabled_sets_.size(); i++) {
+      enabled_sets_[i].advertising_handle_ = kInvalidHandle;
+    }
+    max_advertisers_ = num_instances_;
+    if (advertising_api_type_ == AdvertisingApiType::EXTENDED) {
+      auto max_advertisers = os::GetSystemProperty(kMaxAdvertisersProperty);
+      if (max_advertisers) {
+        auto max_advertisers_number = common::Uint64FromString(max_advertisers.value());
+        if (max_advertisers_number && max_advertisers_number.value() > num_instances_) {
+          max_advertisers_ = std::min<uint64_t>(max_advertisers_number.value(), kInvalidId);
+        }
+      }
+    }
+    if (max_advertisers_ > num_instances_) {
+      start_scheduler();
+    } else if (advertising_api_type_ == AdvertisingApiType::EXTENDED) {
+      // Each advertiser keeps the advertising set of its id
+      hardware_sets_ = std::vector<HardwareAdvertisingSet>(num_instances_);
+      for (size_t handle = 0; handle < hardware_sets_.size(); handle++) {
+        hardware_sets_[handle].owner = handle;
+        hardware_sets_[handle].loaded = true;
+      }
+    }
+  }
+
+  void start_scheduler() {
+    auto slice = os::GetSystemProperty(kAdvertisingSliceProperty);
+    if (slice) {
+      auto slice_number = common::Uint64FromString(slice.value());
+      if (slice_number && slice_number.value() > 0) {
+        slice_duration_ = std::chrono::milliseconds(slice_number.value());
+      }
+    }
+    LOG_INFO(
+        "%zu advertisers on %zu advertising sets, in slices of %lld ms",
+        max_advertisers_,
+        num_instances_,
+        static_cast<long long>(slice_duration_.count()));
+    scheduler_ = std::make_unique<LeAdvertisingScheduler>(num_instances_);
+    hardware_sets_ = std::vector<HardwareAdvertisingSet>(num_instances_);
+    slice_alarm_ = std::make_unique<os::Alarm>(module_handler_);
   }
 
   size_t GetNumberOfAdvertisingInstances() const {
@@ -180,19 +274,32 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
     }
     LOG_VERBOSE("Received LE Advertising Set Terminated with status %s", ErrorCodeText(event_view.GetStatus()).c_str());
 
-    uint8_t advertiser_id = event_view.GetAdvertisingHandle();
+    uint8_t handle = event_view.GetAdvertisingHandle();
+    AdvertiserId advertiser_id = get_owner(handle);
+    if (advertiser_id == kInvalidId) {
+      LOG_WARN("Advertising set %d terminated without owner", handle);
+      return;
+    }
 
     if (advertising_sets_[advertiser_id].address_rotation_alarm != nullptr) {
       advertising_sets_[advertiser_id].address_rotation_alarm->Cancel();
       advertising_sets_[advertiser_id].address_rotation_alarm.reset();
     }
-    enabled_sets_[advertiser_id].advertising_handle_ = kInvalidHandle;
+    enabled_sets_[handle].advertising_handle_ = kInvalidHandle;
+    if (scheduler_ != nullptr) {
+      // The controller took it off air, its slot is free for the next in line
+      scheduler_->Disable(advertiser_id);
+    }
 
-    AddressWithType advertiser_address = advertising_sets_[event_view.GetAdvertisingHandle()].current_address;
+    AddressWithType advertiser_address = advertising_sets_[advertiser_id].current_address;
 
     auto status = event_view.GetStatus();
     acl_manager_->OnAdvertisingSetTerminated(status, event_view.GetConnectionHandle(), advertiser_address);
     if (status == ErrorCode::LIMIT_REACHED || status == ErrorCode::ADVERTISING_TIMEOUT) {
+      if (scheduler_ != nullptr) {
+        advertising_sets_[advertiser_id].enabled = false;
+        schedule_advertisers(false);
+      }
       if (id_map_[advertiser_id] == kIdLocal) {
         if (!advertising_sets_[advertiser_id].timeout_callback.is_null()) {
           advertising_sets_[advertiser_id].timeout_callback.Run((uint8_t)status);
@@ -210,8 +317,41 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
           advertising_sets_[advertiser_id].max_extended_advertising_events == 0) {
         LOG_INFO("Reenable advertising");
         enable_advertiser(advertiser_id, true, 0, 0);
+        return;
       }
     }
+    if (scheduler_ != nullptr) {
+      advertising_sets_[advertiser_id].enabled = false;
+      schedule_advertisers(false);
+    }
+  }
+
+  // Advertiser loaded into the advertising set of the controller
+  AdvertiserId get_owner(uint8_t handle) const {
+    if (scheduler_ == nullptr) {
+      return handle;
+    }
+    if (handle >= hardware_sets_.size()) {
+      return kInvalidId;
+    }
+    return hardware_sets_[handle].owner;
+  }
+
+  // Advertising set of the controller holding the advertiser
+  uint8_t get_handle(AdvertiserId advertiser_id) {
+    if (scheduler_ == nullptr) {
+      return advertiser_id;
+    }
+    return advertising_sets_[advertiser_id].handle;
+  }
+
+  // Whether commands for the advertiser go to the controller, rather than wait for its turn on an advertising set
+  bool is_loaded(AdvertiserId advertiser_id) {
+    if (scheduler_ == nullptr) {
+      return true;
+    }
+    uint8_t handle = advertising_sets_[advertiser_id].handle;
+    return handle != kInvalidHandle && hardware_sets_[handle].owner == advertiser_id && hardware_sets_[handle].loaded;
   }
 
   AdvertiserId allocate_advertiser() {
@@ -219,11 +359,11 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
     AdvertiserId id = advertising_api_type_ == AdvertisingApiType::ANDROID_HCI ? 1 : 0;
     {
       std::unique_lock lock(id_mutex_);
-      while (id < num_instances_ && advertising_sets_.count(id) != 0) {
+      while (id < max_advertisers_ && advertising_sets_.count(id) != 0) {
         id++;
       }
-      if (id == num_instances_) {
-        LOG_WARN("Number of max instances %d reached", (uint16_t)num_instances_);
+      if (id == max_advertisers_) {
+        LOG_WARN("Number of max instances %d reached", (uint16_t)max_advertisers_);
         return kInvalidId;
       }
       advertising_sets_[id].in_use = true;
@@ -238,14 +378,27 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
       return;
     }
     if (advertising_api_type_ == AdvertisingApiType::EXTENDED) {
-      le_advertising_interface_->EnqueueCommand(
-          hci::LeRemoveAdvertisingSetBuilder::Create(advertiser_id),
-          module_handler_->BindOnce(impl::check_status<LeRemoveAdvertisingSetCompleteView>));
+      // Invalid if the next in line took its advertising set over when it stopped
+      uint8_t handle = get_handle(advertiser_id);
+      if (handle != kInvalidHandle) {
+        le_advertising_interface_->EnqueueCommand(
+            hci::LeRemoveAdvertisingSetBuilder::Create(handle),
+            module_handler_->BindOnce(impl::check_status<LeRemoveAdvertisingSetCompleteView>));
+        // The controller forgets the data of the removed advertising set
+        hardware_sets_[handle].advertisement = SentData{};
+        hardware_sets_[handle].scan_response = SentData{};
+        if (scheduler_ != nullptr) {
+          hardware_sets_[handle] = HardwareAdvertisingSet{};
+        }
+      }
 
       if (advertising_sets_[advertiser_id].address_rotation_alarm != nullptr) {
         advertising_sets_[advertiser_id].address_rotation_alarm->Cancel();
         advertising_sets_[advertiser_id].address_rotation_alarm.reset();
       }
+      if (scheduler_ != nullptr) {
+        scheduler_->Remove(advertiser_id);
+      }
     }
     advertising_sets_.erase(advertiser_id);
     if (advertising_sets_.empty() && address_manager_registered) {
@@ -373,7 +526,11 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
     advertising_sets_[id].max_extended_advertising_events = max_ext_adv_events;
     advertising_sets_[id].handler = handler;
 
-    set_parameters(id, config);
+    if (scheduler_ == nullptr) {
+      set_parameters(id, config);
+    } else {
+      store_parameters(id, config);
+    }
 
     auto address_policy = le_address_manager_->GetAddressPolicy();
     switch (config.own_address_type) {
@@ -381,14 +538,19 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
         if (address_policy == LeAddressManager::AddressPolicy::USE_NON_RESOLVABLE_ADDRESS ||
             address_policy == LeAddressManager::AddressPolicy::USE_RESOLVABLE_ADDRESS) {
           AddressWithType address_with_type = le_address_manager_->GetAnotherAddress();
-          le_advertising_interface_->EnqueueCommand(
-              hci::LeSetExtendedAdvertisingRandomAddressBuilder::Create(id, address_with_type.GetAddress()),
-              module_handler_->BindOnceOn(
-                  this,
-                  &impl::on_set_advertising_set_random_address_complete<
-                      LeSetExtendedAdvertisingRandomAddressCompleteView>,
-                  id,
-                  address_with_type));
+          if (scheduler_ == nullptr) {
+            le_advertising_interface_->EnqueueCommand(
+                hci::LeSetExtendedAdvertisingRandomAddressBuilder::Create(id, address_with_type.GetAddress()),
+                module_handler_->BindOnceOn(
+                    this,
+                    &impl::on_set_advertising_set_random_address_complete<
+                        LeSetExtendedAdvertisingRandomAddressCompleteView>,
+                    id,
+                    address_with_type));
+          } else {
+            // Sent when the advertiser takes its turn on an advertising set
+            advertising_sets_[id].current_address = address_with_type;
+          }
 
           // start timer for random address
           advertising_sets_[id].address_rotation_alarm = std::make_unique<os::Alarm>(module_handler_);
@@ -397,10 +559,12 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
               le_address_manager_->GetNextPrivateAddressIntervalMs());
         } else {
           advertising_sets_[id].current_address = le_address_manager_->GetCurrentAddress();
-          le_advertising_interface_->EnqueueCommand(
-              hci::LeSetExtendedAdvertisingRandomAddressBuilder::Create(
-                  id, advertising_sets_[id].current_address.GetAddress()),
-              module_handler_->BindOnce(impl::check_status<LeSetExtendedAdvertisingRandomAddressCompleteView>));
+          if (scheduler_ == nullptr) {
+            le_advertising_interface_->EnqueueCommand(
+                hci::LeSetExtendedAdvertisingRandomAddressBuilder::Create(
+                    id, advertising_sets_[id].current_address.GetAddress()),
+                module_handler_->BindOnce(impl::check_status<LeSetExtendedAdvertisingRandomAddressCompleteView>));
+          }
         }
         break;
       case OwnAddressType::PUBLIC_DEVICE_ADDRESS:
@@ -411,28 +575,47 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
         // For resolvable address types, set the Peer address and type, and the controller generates the address.
         LOG_ALWAYS_FATAL("Unsupported Advertising Type %s", OwnAddressTypeText(config.own_address_type).c_str());
     }
+    if (scheduler_ == nullptr) {
+      if (config.advertising_type == AdvertisingType::ADV_IND ||
+          config.advertising_type == AdvertisingType::ADV_NONCONN_IND) {
+        set_data(id, true, config.scan_response);
+      }
+      set_data(id, false, config.advertisement);
+
+      if (!config.periodic_data.empty()) {
+        set_periodic_parameter(id, config.periodic_advertising_parameters);
+        set_periodic_data(id, config.periodic_data);
+        enable_periodic_advertising(id, true);
+      }
+
+      if (!paused) {
+        enable_advertiser(id, true, duration, max_ext_adv_events);
+      } else {
+        EnabledSet curr_set;
+        curr_set.advertising_handle_ = id;
+        curr_set.duration_ = duration;
+        curr_set.max_extended_advertising_events_ = max_ext_adv_events;
+        std::vector<EnabledSet> enabled_sets = {curr_set};
+        enabled_sets_[id] = curr_set;
+      }
+      return;
+    }
+
     if (config.advertising_type == AdvertisingType::ADV_IND ||
         config.advertising_type == AdvertisingType::ADV_NONCONN_IND) {
-      set_data(id, true, config.scan_response);
+      advertising_sets_[id].scan_response = prepare_data(id, true, config.scan_response);
     }
-    set_data(id, false, config.advertisement);
+    advertising_sets_[id].advertisement = prepare_data(id, false, config.advertisement);
 
     if (!config.periodic_data.empty()) {
-      set_periodic_parameter(id, config.periodic_advertising_parameters);
-      set_periodic_data(id, config.periodic_data);
-      enable_periodic_advertising(id, true);
+      advertising_sets_[id].periodic_parameters = config.periodic_advertising_parameters;
+      advertising_sets_[id].periodic_data = config.periodic_data;
+      advertising_sets_[id].periodic_enabled = true;
     }
 
-    if (!paused) {
-      enable_advertiser(id, true, duration, max_ext_adv_events);
-    } else {
-      EnabledSet curr_set;
-      curr_set.advertising_handle_ = id;
-      curr_set.duration_ = duration;
-      curr_set.max_extended_advertising_events_ = max_ext_adv_events;
-      std::vector<EnabledSet> enabled_sets = {curr_set};
-      enabled_sets_[id] = curr_set;
-    }
+    // The parameters, address and data are sent once the advertiser gets an advertising set, right before it is
+    // enabled. While paused, it is enabled on resume.
+    enable_advertiser(id, true, duration, max_ext_adv_events);
   }
 
   void stop_advertising(AdvertiserId advertiser_id) {
@@ -459,6 +642,11 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
             module_handler_->BindOnce(impl::check_status<LeMultiAdvtCompleteView>));
         break;
       case (AdvertisingApiType::EXTENDED): {
+        if (scheduler_ != nullptr) {
+          stop_scheduled_advertiser(advertiser_id);
+          return;
+        }
+        send_pending_enable_change(advertiser_id);
         le_advertising_interface_->EnqueueCommand(
             hci::LeSetExtendedAdvertisingEnableBuilder::Create(Enable::DISABLED, enabled_vector),
             module_handler_->BindOnce(impl::check_status<LeSetExtendedAdvertisingEnableCompleteView>));
@@ -473,9 +661,36 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
     enabled_sets_[advertiser_id].advertising_handle_ = kInvalidHandle;
   }
 
+  void stop_scheduled_advertiser(AdvertiserId advertiser_id) {
+    // Sent in order with the pending changes
+    flush_enable_changes();
+    advertising_sets_[advertiser_id].enabled = false;
+    scheduler_->Disable(advertiser_id);
+    if (is_loaded(advertiser_id)) {
+      uint8_t handle = get_handle(advertiser_id);
+      EnabledSet curr_set;
+      curr_set.advertising_handle_ = handle;
+      std::vector<EnabledSet> enabled_vector{curr_set};
+      le_advertising_interface_->EnqueueCommand(
+          hci::LeSetExtendedAdvertisingEnableBuilder::Create(Enable::DISABLED, enabled_vector),
+          module_handler_->BindOnce(impl::check_status<LeSetExtendedAdvertisingEnableCompleteView>));
+
+      le_advertising_interface_->EnqueueCommand(
+          hci::LeSetPeriodicAdvertisingEnableBuilder::Create(Enable::DISABLED, handle),
+          module_handler_->BindOnce(impl::check_status<LeSetPeriodicAdvertisingEnableCompleteView>));
+
+      std::unique_lock lock(id_mutex_);
+      enabled_sets_[handle].advertising_handle_ = kInvalidHandle;
+    }
+    // The advertising set is free for the next in line
+    schedule_advertisers(false);
+  }
+
   void set_advertising_set_random_address(AdvertiserId advertiser_id) {
     // This function should only be trigger by enabled advertising set
-    if (enabled_sets_[advertiser_id].advertising_handle_ == kInvalidHandle) {
+    bool enabled = scheduler_ != nullptr ? advertising_sets_[advertiser_id].enabled
+                                         : enabled_sets_[advertiser_id].advertising_handle_ != kInvalidHandle;
+    if (!enabled) {
       if (advertising_sets_[advertiser_id].address_rotation_alarm != nullptr) {
         advertising_sets_[advertiser_id].address_rotation_alarm->Cancel();
         advertising_sets_[advertiser_id].address_rotation_alarm.reset();
@@ -483,15 +698,26 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
       return;
     }
 
+    if (!is_loaded(advertiser_id)) {
+      // Sent when the advertiser takes its turn on an advertising set
+      advertising_sets_[advertiser_id].current_address = le_address_manager_->GetAnotherAddress();
+      advertising_sets_[advertiser_id].address_rotation_alarm->Schedule(
+          common::BindOnce(&impl::set_advertising_set_random_address, common::Unretained(this), advertiser_id),
+          le_address_manager_->GetNextPrivateAddressIntervalMs());
+      return;
+    }
+
     // TODO handle duration and max_extended_advertising_events_
+    uint8_t handle = get_handle(advertiser_id);
+    bool on_air = enabled_sets_[handle].advertising_handle_ != kInvalidHandle;
     EnabledSet curr_set;
-    curr_set.advertising_handle_ = advertiser_id;
+    curr_set.advertising_handle_ = handle;
     curr_set.duration_ = advertising_sets_[advertiser_id].duration;
     curr_set.max_extended_advertising_events_ = advertising_sets_[advertiser_id].max_extended_advertising_events;
     std::vector<EnabledSet> enabled_sets = {curr_set};
 
     // For connectable advertising, we should disable it first
-    if (advertising_sets_[advertiser_id].connectable) {
+    if (on_air && advertising_sets_[advertiser_id].connectable) {
       le_advertising_interface_->EnqueueCommand(
           hci::LeSetExtendedAdvertisingEnableBuilder::Create(Enable::DISABLED, enabled_sets),
           module_handler_->BindOnce(impl::check_status<LeSetExtendedAdvertisingEnableCompleteView>));
@@ -499,14 +725,14 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
 
     AddressWithType address_with_type = le_address_manager_->GetAnotherAddress();
     le_advertising_interface_->EnqueueCommand(
-        hci::LeSetExtendedAdvertisingRandomAddressBuilder::Create(advertiser_id, address_with_type.GetAddress()),
+        hci::LeSetExtendedAdvertisingRandomAddressBuilder::Create(handle, address_with_type.GetAddress()),
         module_handler_->BindOnceOn(
             this,
             &impl::on_set_advertising_set_random_address_complete<LeSetExtendedAdvertisingRandomAddressCompleteView>,
             advertiser_id,
             address_with_type));
 
-    if (advertising_sets_[advertiser_id].connectable) {
+    if (on_air && advertising_sets_[advertiser_id].connectable) {
       le_advertising_interface_->EnqueueCommand(
           hci::LeSetExtendedAdvertisingEnableBuilder::Create(Enable::ENABLED, enabled_sets),
           module_handler_->BindOnce(impl::check_status<LeSetExtendedAdvertisingEnableCompleteView>));
@@ -527,10 +753,23 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
         advertiser_id, static_cast<uint8_t>(current_address.GetAddressType()), current_address.GetAddress());
   }
 
-  void set_parameters(AdvertiserId advertiser_id, ExtendedAdvertisingConfig config) {
+  void store_parameters(AdvertiserId advertiser_id, const ExtendedAdvertisingConfig& config) {
     advertising_sets_[advertiser_id].connectable = config.connectable;
     advertising_sets_[advertiser_id].tx_power = config.tx_power;
     advertising_sets_[advertiser_id].directed = config.directed;
+    if (scheduler_ == nullptr) {
+      return;
+    }
+    // Sent again whenever the advertiser takes its turn on an advertising set
+    advertising_sets_[advertiser_id].config = config;
+    if (advertising_sets_[advertiser_id].enabled) {
+      scheduler_->Enable(advertiser_id, is_pinned(advertiser_id));
+    }
+  }
+
+  void set_parameters(AdvertiserId advertiser_id, ExtendedAdvertisingConfig config) {
+    send_pending_enable_change(advertiser_id);
+    store_parameters(advertiser_id, config);
 
     switch (advertising_api_type_) {
       case (AdvertisingApiType::LEGACY): {
@@ -566,77 +805,94 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
             module_handler_->BindOnceOn(this, &impl::check_status_with_id<LeMultiAdvtCompleteView>, advertiser_id));
       } break;
       case (AdvertisingApiType::EXTENDED): {
-        // sid must be in range 0x00 to 0x0F. Since no controller supports more than
-        // 16 advertisers, it's safe to make sid equal to id.
-        config.sid = advertiser_id % kAdvertisingSetIdMask;
-
-        if (config.legacy_pdus) {
-          LegacyAdvertisingProperties legacy_properties = LegacyAdvertisingProperties::ADV_IND;
-          if (config.connectable && config.directed) {
-            if (config.high_duty_directed_connectable) {
-              legacy_properties = LegacyAdvertisingProperties::ADV_DIRECT_IND_HIGH;
-            } else {
-              legacy_properties = LegacyAdvertisingProperties::ADV_DIRECT_IND_LOW;
-            }
-          }
-          if (config.scannable && !config.connectable) {
-            legacy_properties = LegacyAdvertisingProperties::ADV_SCAN_IND;
-          }
-          if (!config.scannable && !config.connectable) {
-            legacy_properties = LegacyAdvertisingProperties::ADV_NONCONN_IND;
+        if (!is_loaded(advertiser_id)) {
+          // Sent when the advertiser takes its turn on an advertising set
+          if (should_report(advertiser_id)) {
+            advertising_callbacks_->OnAdvertisingParametersUpdated(
+                advertiser_id,
+                advertising_sets_[advertiser_id].tx_power,
+                AdvertisingCallback::AdvertisingStatus::SUCCESS);
           }
+          return;
+        }
+        send_extended_parameters(advertiser_id, config, true);
+      } break;
+    }
+  }
 
-          le_advertising_interface_->EnqueueCommand(
-              LeSetExtendedAdvertisingLegacyParametersBuilder::Create(
-                  advertiser_id,
-                  legacy_properties,
-                  config.interval_min,
-                  config.interval_max,
-                  config.channel_map,
-                  config.own_address_type,
-                  config.peer_address_type,
-                  config.peer_address,
-                  config.filter_policy,
-                  config.tx_power,
-                  config.sid,
-                  config.enable_scan_request_notifications),
-              module_handler_->BindOnceOn(
-                  this,
-                  &impl::on_set_extended_advertising_parameters_complete<
-                      LeSetExtendedAdvertisingParametersCompleteView>,
-                  advertiser_id));
+  void send_extended_parameters(AdvertiserId advertiser_id, ExtendedAdvertisingConfig config, bool report) {
+    uint8_t handle = get_handle(advertiser_id);
+    // sid must be in range 0x00 to 0x0F. Advertisers beyond 16 share a sid with another one, the advertising
+    // set being told apart by the address too.
+    config.sid = advertiser_id % kAdvertisingSetIdMask;
+
+    if (config.legacy_pdus) {
+      LegacyAdvertisingProperties legacy_properties = LegacyAdvertisingProperties::ADV_IND;
+      if (config.connectable && config.directed) {
+        if (config.high_duty_directed_connectable) {
+          legacy_properties = LegacyAdvertisingProperties::ADV_DIRECT_IND_HIGH;
         } else {
-          uint8_t legacy_properties = (config.connectable ? 0x1 : 0x00) | (config.scannable ? 0x2 : 0x00) |
-                                      (config.directed ? 0x4 : 0x00) |
-                                      (config.high_duty_directed_connectable ? 0x8 : 0x00);
-          uint8_t extended_properties = (config.anonymous ? 0x20 : 0x00) | (config.include_tx_power ? 0x40 : 0x00);
-          extended_properties = extended_properties >> 5;
-
-          le_advertising_interface_->EnqueueCommand(
-              hci::LeSetExtendedAdvertisingParametersBuilder::Create(
-                  advertiser_id,
-                  legacy_properties,
-                  extended_properties,
-                  config.interval_min,
-                  config.interval_max,
-                  config.channel_map,
-                  config.own_address_type,
-                  config.peer_address_type,
-                  config.peer_address,
-                  config.filter_policy,
-                  config.tx_power,
-                  (config.use_le_coded_phy ? PrimaryPhyType::LE_CODED : PrimaryPhyType::LE_1M),
-                  config.secondary_max_skip,
-                  config.secondary_advertising_phy,
-                  config.sid,
-                  config.enable_scan_request_notifications),
-              module_handler_->BindOnceOn(
-                  this,
-                  &impl::on_set_extended_advertising_parameters_complete<
-                      LeSetExtendedAdvertisingParametersCompleteView>,
-                  advertiser_id));
+          legacy_properties = LegacyAdvertisingProperties::ADV_DIRECT_IND_LOW;
         }
-      } break;
+      }
+      if (config.scannable && !config.connectable) {
+        legacy_properties = LegacyAdvertisingProperties::ADV_SCAN_IND;
+      }
+      if (!config.scannable && !config.connectable) {
+        legacy_properties = LegacyAdvertisingProperties::ADV_NONCONN_IND;
+      }
+
+      le_advertising_interface_->EnqueueCommand(
+          LeSetExtendedAdvertisingLegacyParametersBuilder::Create(
+              handle,
+              legacy_properties,
+              config.interval_min,
+              config.interval_max,
+              config.channel_map,
+              config.own_address_type,
+              config.peer_address_type,
+              config.peer_address,
+              config.filter_policy,
+              config.tx_power,
+              config.sid,
+              config.enable_scan_request_notifications),
+          module_handler_->BindOnceOn(
+              this,
+              &impl::on_set_extended_advertising_parameters_complete<
+                  LeSetExtendedAdvertisingParametersCompleteView>,
+              advertiser_id,
+              report));
+    } else {
+      uint8_t legacy_properties = (config.connectable ? 0x1 : 0x00) | (config.scannable ? 0x2 : 0x00) |
+                                  (config.directed ? 0x4 : 0x00) |
+                                  (config.high_duty_directed_connectable ? 0x8 : 0x00);
+      uint8_t extended_properties = (config.anonymous ? 0x20 : 0x00) | (config.include_tx_power ? 0x40 : 0x00);
+      extended_properties = extended_properties >> 5;
+
+      le_advertising_interface_->EnqueueCommand(
+          hci::LeSetExtendedAdvertisingParametersBuilder::Create(
+              handle,
+              legacy_properties,
+              extended_properties,
+              config.interval_min,
+              config.interval_max,
+              config.channel_map,
+              config.own_address_type,
+              config.peer_address_type,
+              config.peer_address,
+              config.filter_policy,
+              config.tx_power,
+              (config.use_le_coded_phy ? PrimaryPhyType::LE_CODED : PrimaryPhyType::LE_1M),
+              config.secondary_max_skip,
+              config.secondary_advertising_phy,
+              config.sid,
+              config.enable_scan_request_notifications),
+          module_handler_->BindOnceOn(
+              this,
+              &impl::on_set_extended_advertising_parameters_complete<
+                  LeSetExtendedAdvertisingParametersCompleteView>,
+              advertiser_id,
+              report));
     }
   }
 
@@ -659,7 +915,7 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
     return true;
   };
 
-  void set_data(AdvertiserId advertiser_id, bool set_scan_rsp, std::vector<GapData> data) {
+  std::vector<GapData> prepare_data(AdvertiserId advertiser_id, bool set_scan_rsp, std::vector<GapData> data) {
     if (!set_scan_rsp && advertising_sets_[advertiser_id].connectable) {
       GapData gap_data;
       gap_data.data_type_ = GapDataType::FLAGS;
@@ -678,6 +934,12 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
         break;
       }
     }
+    return data;
+  }
+
+  void set_data(AdvertiserId advertiser_id, bool set_scan_rsp, std::vector<GapData> data) {
+    send_pending_enable_change(advertiser_id);
+    data = prepare_data(advertiser_id, set_scan_rsp, std::move(data));
 
     switch (advertising_api_type_) {
       case (AdvertisingApiType::LEGACY): {
@@ -740,61 +1002,110 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
           return;
         }
 
-        if (data_len <= kLeMaximumFragmentLength) {
-          send_data_fragment(advertiser_id, set_scan_rsp, data, Operation::COMPLETE_ADVERTISEMENT);
+        if (set_scan_rsp) {
+          advertising_sets_[advertiser_id].scan_response = data;
         } else {
-          std::vector<GapData> sub_data;
-          uint16_t sub_data_len = 0;
-          Operation operation = Operation::FIRST_FRAGMENT;
-
-          for (size_t i = 0; i < data.size(); i++) {
-            if (sub_data_len + data[i].size() > kLeMaximumFragmentLength) {
-              send_data_fragment(advertiser_id, set_scan_rsp, sub_data, operation);
-              operation = Operation::INTERMEDIATE_FRAGMENT;
-              sub_data_len = 0;
-              sub_data.clear();
-            }
-            sub_data.push_back(data[i]);
-            sub_data_len += data[i].size();
-          }
-          send_data_fragment(advertiser_id, set_scan_rsp, sub_data, Operation::LAST_FRAGMENT);
+          advertising_sets_[advertiser_id].advertisement = data;
+        }
+        if (!is_loaded(advertiser_id)) {
+          // Sent when the advertiser takes its turn on an advertising set
+          report_data_set(advertiser_id, set_scan_rsp);
+          return;
+        }
+        const SentData& sent = sent_data(get_handle(advertiser_id), set_scan_rsp);
+        if (sent.data.has_value() && IsSameData(sent.data.value(), data)) {
+          LOG_VERBOSE("Skipping unchanged data of advertiser %d", advertiser_id);
+          report_data_set(advertiser_id, set_scan_rsp);
+          return;
         }
+        send_extended_data(advertiser_id, set_scan_rsp, data, true);
       } break;
     }
   }
 
-  void send_data_fragment(
-      AdvertiserId advertiser_id, bool set_scan_rsp, std::vector<GapData> data, Operation operation) {
-    if (operation == Operation::COMPLETE_ADVERTISEMENT || operation == Operation::LAST_FRAGMENT) {
-      if (set_scan_rsp) {
-        le_advertising_interface_->EnqueueCommand(
-            hci::LeSetExtendedAdvertisingScanResponseBuilder::Create(
-                advertiser_id, operation, kFragment_preference, data),
-            module_handler_->BindOnceOn(
-                this, &impl::check_status_with_id<LeSetExtendedAdvertisingScanResponseCompleteView>, advertiser_id));
-      } else {
-        le_advertising_interface_->EnqueueCommand(
-            hci::LeSetExtendedAdvertisingDataBuilder::Create(advertiser_id, operation, kFragment_preference, data),
-            module_handler_->BindOnceOn(
-                this, &impl::check_status_with_id<LeSetExtendedAdvertisingDataCompleteView>, advertiser_id));
-      }
+  void report_data_set(AdvertiserId advertiser_id, bool set_scan_rsp) {
+    if (!should_report(advertiser_id)) {
+      return;
+    }
+    if (set_scan_rsp) {
+      advertising_callbacks_->OnScanResponseDataSet(advertiser_id, AdvertisingCallback::AdvertisingStatus::SUCCESS);
     } else {
-      // For first and intermediate fragment, do not trigger advertising_callbacks_.
-      if (set_scan_rsp) {
-        le_advertising_interface_->EnqueueCommand(
-            hci::LeSetExtendedAdvertisingScanResponseBuilder::Create(
-                advertiser_id, operation, kFragment_preference, data),
-            module_handler_->BindOnce(impl::check_status<LeSetExtendedAdvertisingScanResponseCompleteView>));
-      } else {
-        le_advertising_interface_->EnqueueCommand(
-            hci::LeSetExtendedAdvertisingDataBuilder::Create(advertiser_id, operation, kFragment_preference, data),
-            module_handler_->BindOnce(impl::check_status<LeSetExtendedAdvertisingDataCompleteView>));
+      advertising_callbacks_->OnAdvertisingDataSet(advertiser_id, AdvertisingCallback::AdvertisingStatus::SUCCESS);
+    }
+  }
+
+  SentData& sent_data(uint8_t handle, bool set_scan_rsp) {
+    return set_scan_rsp ? hardware_sets_[handle].scan_response : hardware_sets_[handle].advertisement;
+  }
+
+  void send_extended_data(AdvertiserId advertiser_id, bool set_scan_rsp, std::vector<GapData> data, bool report) {
+    // Remembered once each fragment succeeds
+    SentData& sent = sent_data(get_handle(advertiser_id), set_scan_rsp);
+    sent.data.reset();
+    sent.last_sent = data;
+    sent.failed = false;
+
+    uint16_t data_len = 0;
+    for (size_t i = 0; i < data.size(); i++) {
+      data_len += data[i].size();
+    }
+    if (data_len <= kLeMaximumFragmentLength) {
+      send_data_fragment(advertiser_id, set_scan_rsp, data, Operation::COMPLETE_ADVERTISEMENT, report);
+    } else {
+      std::vector<GapData> sub_data;
+      uint16_t sub_data_len = 0;
+      Operation operation = Operation::FIRST_FRAGMENT;
+
+      for (size_t i = 0; i < data.size(); i++) {
+        if (sub_data_len + data[i].size() > kLeMaximumFragmentLength) {
+          send_data_fragment(advertiser_id, set_scan_rsp, sub_data, operation, report);
+          operation = Operation::INTERMEDIATE_FRAGMENT;
+          sub_data_len = 0;
+          sub_data.clear();
+        }
+        sub_data.push_back(data[i]);
+        sub_data_len += data[i].size();
       }
+      send_data_fragment(advertiser_id, set_scan_rsp, sub_data, Operation::LAST_FRAGMENT, report);
+    }
+  }
+
+  void send_data_fragment(
+      AdvertiserId advertiser_id, bool set_scan_rsp, std::vector<GapData> data, Operation operation, bool report) {
+    uint8_t handle = get_handle(advertiser_id);
+    // For first and intermediate fragment, do not trigger advertising_callbacks_.
+    bool last_fragment = operation == Operation::COMPLETE_ADVERTISEMENT || operation == Operation::LAST_FRAGMENT;
+    sent_data(handle, set_scan_rsp).in_flight++;
+    if (set_scan_rsp) {
+      le_advertising_interface_->EnqueueCommand(
+          hci::LeSetExtendedAdvertisingScanResponseBuilder::Create(handle, operation, kFragment_preference, data),
+          module_handler_->BindOnceOn(
+              this,
+              &impl::on_set_extended_advertising_data_complete<LeSetExtendedAdvertisingScanResponseCompleteView>,
+              advertiser_id,
+              handle,
+              true,
+              report && last_fragment));
+    } else {
+      le_advertising_interface_->EnqueueCommand(
+          hci::LeSetExtendedAdvertisingDataBuilder::Create(handle, operation, kFragment_preference, data),
+          module_handler_->BindOnceOn(
+              this,
+              &impl::on_set_extended_advertising_data_complete<LeSetExtendedAdvertisingDataCompleteView>,
+              advertiser_id,
+              handle,
+              false,
+              report && last_fragment));
     }
   }
 
   void enable_advertiser(
       AdvertiserId advertiser_id, bool enable, uint16_t duration, uint8_t max_extended_advertising_events) {
+    if (scheduler_ != nullptr) {
+      enable_scheduled_advertiser(advertiser_id, enable, duration, max_extended_advertising_events);
+      return;
+    }
+
     EnabledSet curr_set;
     curr_set.advertising_handle_ = advertiser_id;
     curr_set.duration_ = duration;
@@ -819,13 +1130,15 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
                 this, &impl::on_set_advertising_enable_complete<LeMultiAdvtCompleteView>, enable, enabled_sets));
       } break;
       case (AdvertisingApiType::EXTENDED): {
-        le_advertising_interface_->EnqueueCommand(
-            hci::LeSetExtendedAdvertisingEnableBuilder::Create(enable_value, enabled_sets),
-            module_handler_->BindOnceOn(
-                this,
-                &impl::on_set_extended_advertising_enable_complete<LeSetExtendedAdvertisingEnableCompleteView>,
-                enable,
-                enabled_sets));
+        // Each change asked for is sent, and reported, in order
+        send_pending_enable_change(advertiser_id);
+        if (enable) {
+          enabled_sets_[advertiser_id] = curr_set;
+          pending_enables_.push_back({advertiser_id, advertiser_id, true});
+        } else {
+          pending_disables_.push_back({advertiser_id, advertiser_id, true});
+        }
+        post_flush_enable_changes();
       } break;
     }
 
@@ -842,22 +1155,329 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
     }
   }
 
+  void enable_scheduled_advertiser(
+      AdvertiserId advertiser_id, bool enable, uint16_t duration, uint8_t max_extended_advertising_events) {
+    if (has_pending_enable_change(advertiser_id)) {
+      // Each change asked for is sent, and reported, in order
+      flush_enable_changes();
+    }
+
+    Advertiser& advertiser = advertising_sets_[advertiser_id];
+    if (enable) {
+      advertiser.enabled = true;
+      advertiser.duration = duration;
+      advertiser.max_extended_advertising_events = max_extended_advertising_events;
+      scheduler_->Enable(advertiser_id, is_pinned(advertiser_id));
+      if (scheduler_->IsOnAir(advertiser_id)) {
+        // Enabled again, with the new duration
+        start_on_air(advertiser_id, true);
+        return;
+      }
+      pending_reports_.insert(advertiser_id);
+      schedule_advertisers(false);
+      if (pending_reports_.erase(advertiser_id) != 0) {
+        // Enabled nonetheless, it goes on air on its turn
+        report_enabled(advertiser_id, true, AdvertisingCallback::AdvertisingStatus::SUCCESS);
+      }
+      return;
+    }
+
+    advertiser.enabled = false;
+    if (scheduler_->IsOnAir(advertiser_id)) {
+      stop_on_air(advertiser_id, true);
+    } else {
+      report_enabled(advertiser_id, false, AdvertisingCallback::AdvertisingStatus::SUCCESS);
+    }
+    scheduler_->Disable(advertiser_id);
+    if (advertiser.address_rotation_alarm != nullptr) {
+      advertiser.address_rotation_alarm->Cancel();
+      advertiser.address_rotation_alarm.reset();
+    }
+    schedule_advertisers(false);
+  }
+
+  void set_scheduling_policy(AdvertiserId advertiser_id, AdvertisingSchedulingPolicy policy) {
+    if (scheduler_ == nullptr) {
+      LOG_INFO("Advertisers are only scheduled with the extended advertising API");
+      return;
+    }
+    scheduler_->SetPolicy(advertiser_id, policy);
+    schedule_advertisers(false);
+  }
+
+  // Counted down by the controller, or advertising on the periodic side too, so not to be taken off air
+  bool is_pinned(AdvertiserId advertiser_id) {
+    const Advertiser& advertiser = advertising_sets_[advertiser_id];
+    return advertiser.duration != 0 || advertiser.max_extended_advertising_events != 0 || advertiser.directed ||
+           advertiser.periodic_enabled;
+  }
+
+  void schedule_advertisers(bool end_of_slice) {
+    auto changes = scheduler_->Schedule(end_of_slice);
+    for (AdvertiserId advertiser_id : changes.stopped) {
+      stop_on_air(advertiser_id, false);
+    }
+    for (AdvertiserId advertiser_id : changes.started) {
+      start_on_air(advertiser_id, pending_reports_.erase(advertiser_id) != 0);
+    }
+
+    bool needs_slicing = scheduler_->NeedsSlicing();
+    if (needs_slicing == slice_alarm_armed_) {
+      return;
+    }
+    slice_alarm_armed_ = needs_slicing;
+    if (needs_slicing) {
+      slice_alarm_->Schedule(common::BindOnce(&impl::on_slice_end, common::Unretained(this)), slice_duration_);
+    } else {
+      slice_alarm_->Cancel();
+    }
+  }
+
+  void on_slice_end() {
+    slice_alarm_armed_ = false;
+    if (!paused) {
+      // Taken off air by the end of the slice only once on air for real
+      flush_enable_changes();
+    }
+    // The advertisers on air stay there while paused
+    schedule_advertisers(!paused);
+  }
+
+  void start_on_air(AdvertiserId advertiser_id, bool report) {
+    if (has_pending_enable_change(advertiser_id)) {
+      flush_enable_changes();
+    }
+    uint8_t handle = get_handle(advertiser_id);
+    if (handle == kInvalidHandle) {
+      handle = acquire_handle(advertiser_id);
+    }
+    if (handle == kInvalidHandle) {
+      // Tried again on the next slice
+      scheduler_->Defer(advertiser_id);
+      if (report) {
+        pending_reports_.insert(advertiser_id);
+      }
+      return;
+    }
+    Advertiser& advertiser = advertising_sets_[advertiser_id];
+    enabled_sets_[handle].advertising_handle_ = handle;
+    enabled_sets_[handle].duration_ = advertiser.duration;
+    enabled_sets_[handle].max_extended_advertising_events_ = advertiser.max_extended_advertising_events;
+    pending_enables_.push_back({advertiser_id, handle, report});
+    post_flush_enable_changes();
+  }
+
+  void stop_on_air(AdvertiserId advertiser_id, bool report) {
+    if (has_pending_enable_change(advertiser_id)) {
+      flush_enable_changes();
+    }
+    uint8_t handle = get_handle(advertiser_id);
+    enabled_sets_[handle].advertising_handle_ = kInvalidHandle;
+    pending_disables_.push_back({advertiser_id, handle, report});
+    post_flush_enable_changes();
+  }
+
+  // Picks an advertising set for the advertiser: a free one if any, or else one whose advertiser is off air, rather
+  // than one still doing periodic advertising
+  uint8_t acquire_handle(AdvertiserId advertiser_id) {
+    uint8_t handle = kInvalidHandle;
+    uint8_t periodic_handle = kInvalidHandle;
+    for (uint8_t i = 0; i < hardware_sets_.size(); i++) {
+      if (enabled_sets_[i].advertising_handle_ != kInvalidHandle) {
+        continue;
+      }
+      AdvertiserId owner = hardware_sets_[i].owner;
+      if (owner == kInvalidId) {
+        handle = i;
+        break;
+      }
+      if (advertising_sets_[owner].periodic_enabled) {
+        periodic_handle = periodic_handle == kInvalidHandle ? i : periodic_handle;
+      } else if (handle == kInvalidHandle) {
+        handle = i;
+      }
+    }
+    if (handle == kInvalidHandle) {
+      handle = periodic_handle;
+    }
+    if (handle == kInvalidHandle) {
+      LOG_WARN("No advertising set for advertiser %d", advertiser_id);
+      return kInvalidHandle;
+    }
+
+    AdvertiserId owner = hardware_sets_[handle].owner;
+    if (owner != kInvalidId) {
+      LOG_VERBOSE("Advertiser %d takes advertising set %d over from advertiser %d", advertiser_id, handle, owner);
+      if (advertising_sets_[owner].periodic_enabled) {
+        // Enabled again when the owner gets an advertising set back
+        LOG_WARN("Periodic advertising of advertiser %d stops until it is on air again", owner);
+        le_advertising_interface_->EnqueueCommand(
+            hci::LeSetPeriodicAdvertisingEnableBuilder::Create(Enable::DISABLED, handle),
+            module_handler_->BindOnce(impl::check_status<LeSetPeriodicAdvertisingEnableCompleteView>));
+      }
+      advertising_sets_[owner].handle = kInvalidHandle;
+    }
+    hardware_sets_[handle] = HardwareAdvertisingSet{};
+    hardware_sets_[handle].owner = advertiser_id;
+    advertising_sets_[advertiser_id].handle = handle;
+    return handle;
+  }
+
+  // Sends the parameters, address and data of the advertiser to its advertising set
+  void load_advertiser(AdvertiserId advertiser_id) {
+    uint8_t handle = get_handle(advertiser_id);
+    Advertiser& advertiser = advertising_sets_[advertiser_id];
+    hardware_sets_[handle].loaded = true;
+
+    send_extended_parameters(advertiser_id, advertiser.config, false);
+    if (advertiser.config.own_address_type == OwnAddressType::RANDOM_DEVICE_ADDRESS) {
+      le_advertising_interface_->EnqueueCommand(
+          hci::LeSetExtendedAdvertisingRandomAddressBuilder::Create(handle, advertiser.current_address.GetAddress()),
+          module_handler_->BindOnceOn(
+              this,
+              &impl::on_set_advertising_set_random_address_complete<LeSetExtendedAdvertisingRandomAddressCompleteView>,
+              advertiser_id,
+              advertiser.current_address));
+    }
+    if (advertiser.config.advertising_type == AdvertisingType::ADV_IND ||
+        advertiser.config.advertising_type == AdvertisingType::ADV_NONCONN_IND) {
+      send_extended_data(advertiser_id, true, advertiser.scan_response, false);
+    }
+    send_extended_data(advertiser_id, false, advertiser.advertisement, false);
+
+    if (advertiser.periodic_parameters.has_value()) {
+      send_periodic_parameters(advertiser_id, advertiser.periodic_parameters.value(), false);
+    }
+    if (!advertiser.periodic_data.empty()) {
+      send_periodic_data(advertiser_id, advertiser.periodic_data, false);
+    }
+    if (advertiser.periodic_enabled) {
+      le_advertising_interface_->EnqueueCommand(
+          hci::LeSetPeriodicAdvertisingEnableBuilder::Create(Enable::ENABLED, handle),
+          module_handler_->BindOnceOn(
+              this, &impl::check_load_status<LeSetPeriodicAdvertisingEnableCompleteView>, advertiser_id));
+    }
+  }
+
+  bool has_pending_enable_change(AdvertiserId advertiser_id) const {
+    auto is_advertiser = [advertiser_id](const PendingEnableChange& change) {
+      return change.advertiser_id == advertiser_id;
+    };
+    return std::any_of(pending_enables_.begin(), pending_enables_.end(), is_advertiser) ||
+           std::any_of(pending_disables_.begin(), pending_disables_.end(), is_advertiser);
+  }
+
+  // Commands for an advertiser go to the controller after the enable changes it asked for before them
+  void send_pending_enable_change(AdvertiserId advertiser_id) {
+    if (has_pending_enable_change(advertiser_id)) {
+      flush_enable_changes();
+    }
+  }
+
+  void post_flush_enable_changes() {
+    if (flush_posted_) {
+      return;
+    }
+    // Changes made by the tasks already queued, such as for many advertisers enabled at once, go in the same command
+    flush_posted_ = true;
+    module_handler_->CallOn(this, &impl::flush_enable_changes);
+  }
+
+  void flush_enable_changes() {
+    flush_posted_ = false;
+    if (!pending_disables_.empty()) {
+      std::vector<EnabledSet> enabled_sets;
+      std::vector<AdvertiserId> reported;
+      for (const PendingEnableChange& change : pending_disables_) {
+        EnabledSet curr_set;
+        curr_set.advertising_handle_ = change.handle;
+        enabled_sets.push_back(curr_set);
+        if (change.report) {
+          reported.push_back(change.advertiser_id);
+        }
+      }
+      pending_disables_.clear();
+      le_advertising_interface_->EnqueueCommand(
+          hci::LeSetExtendedAdvertisingEnableBuilder::Create(Enable::DISABLED, enabled_sets),
+          module_handler_->BindOnceOn(
+              this,
+              &impl::on_set_extended_advertising_enable_complete<LeSetExtendedAdvertisingEnableCompleteView>,
+              false,
+              reported));
+    }
+
+    if (pending_enables_.empty()) {
+      return;
+    }
+    std::vector<EnabledSet> enabled_sets;
+    std::vector<AdvertiserId> reported;
+    for (const PendingEnableChange& change : pending_enables_) {
+      // The advertising set it took over is disabled by now
+      if (!hardware_sets_[change.handle].loaded) {
+        load_advertiser(change.advertiser_id);
+      }
+      enabled_sets.push_back(enabled_sets_[change.handle]);
+      if (change.report) {
+        reported.push_back(change.advertiser_id);
+      }
+    }
+    pending_enables_.clear();
+    if (paused) {
+      // Enabled on resume
+      for (AdvertiserId advertiser_id : reported) {
+        report_enabled(advertiser_id, true, AdvertisingCallback::AdvertisingStatus::SUCCESS);
+      }
+      return;
+    }
+    le_advertising_interface_->EnqueueCommand(
+        hci::LeSetExtendedAdvertisingEnableBuilder::Create(Enable::ENABLED, enabled_sets),
+        module_handler_->BindOnceOn(
+            this,
+            &impl::on_set_extended_advertising_enable_complete<LeSetExtendedAdvertisingEnableCompleteView>,
+            true,
+            reported));
+  }
+
   void set_periodic_parameter(
       AdvertiserId advertiser_id, PeriodicAdvertisingParameters periodic_advertising_parameters) {
+    send_pending_enable_change(advertiser_id);
+    advertising_sets_[advertiser_id].periodic_parameters = periodic_advertising_parameters;
+    if (!is_loaded(advertiser_id)) {
+      // Sent when the advertiser takes its turn on an advertising set
+      if (should_report(advertiser_id)) {
+        advertising_callbacks_->OnPeriodicAdvertisingParametersUpdated(
+            advertiser_id, AdvertisingCallback::AdvertisingStatus::SUCCESS);
+      }
+      return;
+    }
+    send_periodic_parameters(advertiser_id, periodic_advertising_parameters, true);
+  }
+
+  void send_periodic_parameters(
+      AdvertiserId advertiser_id, PeriodicAdvertisingParameters periodic_advertising_parameters, bool report) {
     uint8_t include_tx_power = periodic_advertising_parameters.properties >>
                                PeriodicAdvertisingParameters::AdvertisingProperty::INCLUDE_TX_POWER;
 
-    le_advertising_interface_->EnqueueCommand(
-        hci::LeSetPeriodicAdvertisingParamBuilder::Create(
-            advertiser_id,
-            periodic_advertising_parameters.min_interval,
-            periodic_advertising_parameters.max_interval,
-            include_tx_power),
-        module_handler_->BindOnceOn(
-            this, &impl::check_status_with_id<LeSetPeriodicAdvertisingParamCompleteView>, advertiser_id));
+    auto command = hci::LeSetPeriodicAdvertisingParamBuilder::Create(
+        get_handle(advertiser_id),
+        periodic_advertising_parameters.min_interval,
+        periodic_advertising_parameters.max_interval,
+        include_tx_power);
+    if (report) {
+      le_advertising_interface_->EnqueueCommand(
+          std::move(command),
+          module_handler_->BindOnceOn(
+              this, &impl::check_status_with_id<LeSetPeriodicAdvertisingParamCompleteView>, advertiser_id));
+    } else {
+      le_advertising_interface_->EnqueueCommand(
+          std::move(command),
+          module_handler_->BindOnceOn(
+              this, &impl::check_load_status<LeSetPeriodicAdvertisingParamCompleteView>, advertiser_id));
+    }
   }
 
   void set_periodic_data(AdvertiserId advertiser_id, std::vector<GapData> data) {
+    send_pending_enable_change(advertiser_id);
     uint16_t data_len = 0;
     // check data size
     for (size_t i = 0; i < data.size(); i++) {
@@ -882,8 +1502,25 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
       return;
     }
 
+    advertising_sets_[advertiser_id].periodic_data = data;
+    if (!is_loaded(advertiser_id)) {
+      // Sent when the advertiser takes its turn on an advertising set
+      if (should_report(advertiser_id)) {
+        advertising_callbacks_->OnPeriodicAdvertisingDataSet(
+            advertiser_id, AdvertisingCallback::AdvertisingStatus::SUCCESS);
+      }
+      return;
+    }
+    send_periodic_data(advertiser_id, data, true);
+  }
+
+  void send_periodic_data(AdvertiserId advertiser_id, std::vector<GapData> data, bool report) {
+    uint16_t data_len = 0;
+    for (size_t i = 0; i < data.size(); i++) {
+      data_len += data[i].size();
+    }
     if (data_len <= kLeMaximumFragmentLength) {
-      send_periodic_data_fragment(advertiser_id, data, Operation::COMPLETE_ADVERTISEMENT);
+      send_periodic_data_fragment(advertiser_id, data, Operation::COMPLETE_ADVERTISEMENT, report);
     } else {
       std::vector<GapData> sub_data;
       uint16_t sub_data_len = 0;
@@ -891,7 +1528,7 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
 
       for (size_t i = 0; i < data.size(); i++) {
         if (sub_data_len + data[i].size() > kLeMaximumFragmentLength) {
-          send_periodic_data_fragment(advertiser_id, sub_data, operation);
+          send_periodic_data_fragment(advertiser_id, sub_data, operation, report);
           operation = Operation::INTERMEDIATE_FRAGMENT;
           sub_data_len = 0;
           sub_data.clear();
@@ -899,38 +1536,64 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
         sub_data.push_back(data[i]);
         sub_data_len += data[i].size();
       }
-      send_periodic_data_fragment(advertiser_id, sub_data, Operation::LAST_FRAGMENT);
+      send_periodic_data_fragment(advertiser_id, sub_data, Operation::LAST_FRAGMENT, report);
     }
   }
 
-  void send_periodic_data_fragment(AdvertiserId advertiser_id, std::vector<GapData> data, Operation operation) {
-    if (operation == Operation::COMPLETE_ADVERTISEMENT || operation == Operation::LAST_FRAGMENT) {
+  void send_periodic_data_fragment(
+      AdvertiserId advertiser_id, std::vector<GapData> data, Operation operation, bool report) {
+    uint8_t handle = get_handle(advertiser_id);
+    if (report && (operation == Operation::COMPLETE_ADVERTISEMENT || operation == Operation::LAST_FRAGMENT)) {
       le_advertising_interface_->EnqueueCommand(
-          hci::LeSetPeriodicAdvertisingDataBuilder::Create(advertiser_id, operation, data),
+          hci::LeSetPeriodicAdvertisingDataBuilder::Create(handle, operation, data),
           module_handler_->BindOnceOn(
               this, &impl::check_status_with_id<LeSetPeriodicAdvertisingDataCompleteView>, advertiser_id));
-    } else {
+    } else if (report) {
       // For first and intermediate fragment, do not trigger advertising_callbacks_.
       le_advertising_interface_->EnqueueCommand(
-          hci::LeSetPeriodicAdvertisingDataBuilder::Create(advertiser_id, operation, data),
+          hci::LeSetPeriodicAdvertisingDataBuilder::Create(handle, operation, data),
           module_handler_->BindOnce(impl::check_status<LeSetPeriodicAdvertisingDataCompleteView>));
+    } else {
+      le_advertising_interface_->EnqueueCommand(
+          hci::LeSetPeriodicAdvertisingDataBuilder::Create(handle, operation, data),
+          module_handler_->BindOnceOn(
+              this, &impl::check_load_status<LeSetPeriodicAdvertisingDataCompleteView>, advertiser_id));
     }
   }
 
   void enable_periodic_advertising(AdvertiserId advertiser_id, bool enable) {
+    send_pending_enable_change(advertiser_id);
     Enable enable_value = enable ? Enable::ENABLED : Enable::DISABLED;
+    advertising_sets_[advertiser_id].periodic_enabled = enable;
+    if (scheduler_ != nullptr && advertising_sets_[advertiser_id].enabled) {
+      // Advertisers with periodic advertising are kept on air
+      scheduler_->Enable(advertiser_id, is_pinned(advertiser_id));
+    }
 
-    le_advertising_interface_->EnqueueCommand(
-        hci::LeSetPeriodicAdvertisingEnableBuilder::Create(enable_value, advertiser_id),
-        module_handler_->BindOnceOn(
-            this,
-            &impl::on_set_periodic_advertising_enable_complete<LeSetPeriodicAdvertisingEnableCompleteView>,
-            enable,
-            advertiser_id));
+    if (!is_loaded(advertiser_id)) {
+      // Sent when the advertiser takes its turn on an advertising set
+      if (should_report(advertiser_id)) {
+        advertising_callbacks_->OnPeriodicAdvertisingEnabled(
+            advertiser_id, enable, AdvertisingCallback::AdvertisingStatus::SUCCESS);
+      }
+    } else {
+      le_advertising_interface_->EnqueueCommand(
+          hci::LeSetPeriodicAdvertisingEnableBuilder::Create(enable_value, get_handle(advertiser_id)),
+          module_handler_->BindOnceOn(
+              this,
+              &impl::on_set_periodic_advertising_enable_complete<LeSetPeriodicAdvertisingEnableCompleteView>,
+              enable,
+              advertiser_id));
+    }
+    if (scheduler_ != nullptr) {
+      schedule_advertisers(false);
+    }
   }
 
   void OnPause() override {
     paused = true;
+    // Queued changes go out before the advertising sets are disabled, and enabled ones wait for resume
+    flush_enable_changes();
     if (!advertising_sets_.empty()) {
       std::vector<EnabledSet> enabled_sets = {};
       for (size_t i = 0; i < enabled_sets_.size(); i++) {
@@ -1032,6 +1695,20 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
 
   AdvertisingApiType advertising_api_type_{0};
 
+  // Advertisers beyond num_instances_ take turns on the advertising sets, with the extended advertising API only
+  size_t max_advertisers_ = 0;
+  std::chrono::milliseconds slice_duration_{kDefaultAdvertisingSlice};
+  std::unique_ptr<LeAdvertisingScheduler> scheduler_;
+  std::vector<HardwareAdvertisingSet> hardware_sets_;
+  std::unique_ptr<os::Alarm> slice_alarm_;
+  bool slice_alarm_armed_ = false;
+  // Sent in one command each, once the tasks already queued are done
+  std::vector<PendingEnableChange> pending_disables_;
+  std::vector<PendingEnableChange> pending_enables_;
+  bool flush_posted_ = false;
+  // Advertisers enabled by the upper layer, to be reported once on air
+  std::set<AdvertiserId> pending_reports_;
+
   void on_read_advertising_physical_channel_tx_power(CommandCompleteView view) {
     auto complete_view = LeReadAdvertisingPhysicalChannelTxPowerCompleteView::Create(view);
     if (!complete_view.IsValid()) {
@@ -1089,7 +1766,7 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
 
   template <class View>
   void on_set_extended_advertising_enable_complete(
-      bool enable, std::vector<EnabledSet> enabled_sets, CommandCompleteView view) {
+      bool enable, std::vector<AdvertiserId> advertiser_ids, CommandCompleteView view) {
     ASSERT(view.IsValid());
     auto complete_view = LeSetExtendedAdvertisingEnableCompleteView::Create(view);
     ASSERT(complete_view.IsValid());
@@ -1099,38 +1776,44 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
       advertising_status = AdvertisingCallback::AdvertisingStatus::INTERNAL_ERROR;
     }
 
+    for (AdvertiserId advertiser_id : advertiser_ids) {
+      // Removed while the command was in flight
+      if (advertising_sets_.count(advertiser_id) == 0) {
+        continue;
+      }
+      report_enabled(advertiser_id, enable, advertising_status);
+    }
+  }
+
+  void report_enabled(AdvertiserId id, bool enable, AdvertisingCallback::AdvertisingStatus advertising_status) {
     if (advertising_callbacks_ == nullptr) {
       return;
     }
 
-    for (EnabledSet enabled_set : enabled_sets) {
-      int8_t tx_power = advertising_sets_[enabled_set.advertising_handle_].tx_power;
-      bool started = advertising_sets_[enabled_set.advertising_handle_].started;
-      uint8_t id = enabled_set.advertising_handle_;
-      if (id == kInvalidHandle) {
-        continue;
-      }
-
-      if (id_map_[id] == kIdLocal) {
-        if (!advertising_sets_[enabled_set.advertising_handle_].status_callback.is_null()) {
-          advertising_sets_[enabled_set.advertising_handle_].status_callback.Run(advertising_status);
-          advertising_sets_[enabled_set.advertising_handle_].status_callback.Reset();
-        }
-        continue;
+    if (id_map_[id] == kIdLocal) {
+      if (!advertising_sets_[id].status_callback.is_null()) {
+        advertising_sets_[id].status_callback.Run(advertising_status);
+        advertising_sets_[id].status_callback.Reset();
       }
+      return;
+    }
 
-      if (started) {
-        advertising_callbacks_->OnAdvertisingEnabled(id, enable, advertising_status);
-      } else {
-        int reg_id = id_map_[id];
-        advertising_sets_[enabled_set.advertising_handle_].started = true;
-        advertising_callbacks_->OnAdvertisingSetStarted(reg_id, id, tx_power, advertising_status);
-      }
+    if (advertising_sets_[id].started) {
+      advertising_callbacks_->OnAdvertisingEnabled(id, enable, advertising_status);
+    } else {
+      int reg_id = id_map_[id];
+      advertising_sets_[id].started = true;
+      advertising_callbacks_->OnAdvertisingSetStarted(reg_id, id, advertising_sets_[id].tx_power, advertising_status);
     }
   }
 
+  // Whether the upper layer hears about the outcome of commands for the advertiser
+  bool should_report(AdvertiserId id) {
+    return advertising_callbacks_ != nullptr && advertising_sets_[id].started && id_map_[id] != kIdLocal;
+  }
+
   template <class View>
-  void on_set_extended_advertising_parameters_complete(AdvertiserId id, CommandCompleteView view) {
+  void on_set_extended_advertising_parameters_complete(AdvertiserId id, bool report, CommandCompleteView view) {
     ASSERT(view.IsValid());
     auto complete_view = LeSetExtendedAdvertisingParametersCompleteView::Create(view);
     ASSERT(complete_view.IsValid());
@@ -1139,9 +1822,12 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
       LOG_INFO("Got a command complete with status %s", ErrorCodeText(complete_view.GetStatus()).c_str());
       advertising_status = AdvertisingCallback::AdvertisingStatus::INTERNAL_ERROR;
     }
+    if (advertising_sets_.count(id) == 0) {
+      return;
+    }
     advertising_sets_[id].tx_power = complete_view.GetSelectedTxPower();
 
-    if (advertising_sets_[id].started && id_map_[id] != kIdLocal) {
+    if (report && should_report(id)) {
       advertising_callbacks_->OnAdvertisingParametersUpdated(id, advertising_sets_[id].tx_power, advertising_status);
     }
   }
@@ -1248,6 +1934,47 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
     }
   }
 
+  // For commands the upper layer does not hear about, such as the ones loading an advertiser for its turn on an
+  // advertising set
+  template <class View>
+  void check_load_status(AdvertiserId id, CommandCompleteView view) {
+    ASSERT(view.IsValid());
+    auto status_view = View::Create(view);
+    ASSERT(status_view.IsValid());
+    if (status_view.GetStatus() != ErrorCode::SUCCESS) {
+      LOG_WARN(
+          "Advertiser %d got a Command complete %s, status %s",
+          id,
+          OpCodeText(view.GetCommandOpCode()).c_str(),
+          ErrorCodeText(status_view.GetStatus()).c_str());
+    }
+  }
+
+  // The data in the controller is unknown after a failure, so the next one is sent even if unchanged
+  template <class View>
+  void on_set_extended_advertising_data_complete(
+      AdvertiserId id, uint8_t handle, bool set_scan_rsp, bool report, CommandCompleteView view) {
+    if (report) {
+      check_status_with_id<View>(id, view);
+    } else {
+      check_load_status<View>(id, view);
+    }
+    SentData& sent = sent_data(handle, set_scan_rsp);
+    // Taken over, or removed, while the command was in flight
+    if (hardware_sets_[handle].owner != id || sent.in_flight == 0) {
+      return;
+    }
+    sent.in_flight--;
+    auto status_view = View::Create(view);
+    ASSERT(status_view.IsValid());
+    if (status_view.GetStatus() != ErrorCode::SUCCESS) {
+      sent.failed = true;
+      sent.data.reset();
+    } else if (sent.in_flight == 0 && !sent.failed) {
+      sent.data = sent.last_sent;
+    }
+  }
+
   template <class View>
   static void check_status(CommandCompleteView view) {
     ASSERT(view.IsValid());
@@ -1473,6 +2200,10 @@ void LeAdvertisingManager::RemoveAdvertiser(AdvertiserId advertiser_id) {
   CallOn(pimpl_.get(), &impl::remove_advertiser, advertiser_id);
 }
 
+void LeAdvertisingManager::SetSchedulingPolicy(AdvertiserId advertiser_id, AdvertisingSchedulingPolicy policy) {
+  CallOn(pimpl_.get(), &impl::set_scheduling_policy, advertiser_id, policy);
+}
+
 void LeAdvertisingManager::RegisterAdvertisingCallback(AdvertisingCallback* advertising_callback) {
   CallOn(pimpl_.get(), &impl::register_advertising_callback, advertising_callback);
 }
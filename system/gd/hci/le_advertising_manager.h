@@ -20,6 +20,7 @@
 #include "common/callback.h"
 #include "hci/address_with_type.h"
 #include "hci/hci_packets.h"
+#include "hci/le_advertising_scheduler.h"
 #include "module.h"
 
 namespace bluetooth {
@@ -68,8 +69,6 @@ class ExtendedAdvertisingConfig : public AdvertisingConfig {
   ExtendedAdvertisingConfig(const AdvertisingConfig& config);
 };
 
-using AdvertiserId = uint8_t;
-
 class AdvertisingCallback {
  public:
   enum AdvertisingStatus {
@@ -145,6 +144,9 @@ class LeAdvertisingManager : public bluetooth::Module {
 
   void RemoveAdvertiser(AdvertiserId advertiser_id);
 
+  // Decides when the advertiser goes on air, when there are more of them than advertising sets in the controller
+  void SetSchedulingPolicy(AdvertiserId advertiser_id, AdvertisingSchedulingPolicy policy);
+
   void RegisterAdvertisingCallback(AdvertisingCallback* advertising_callback);
 
   static const ModuleFactory Factory;
@@ -29,6 +29,7 @@
 #include "hci/address.h"
 #include "hci/controller.h"
 #include "hci/hci_layer.h"
+#include "os/system_properties.h"
 #include "os/thread.h"
 #include "packet/raw_builder.h"
 
@@ -66,12 +67,22 @@ class TestController : public Controller {
     return 0x0672;
   }
 
+  bool SupportsBleExtendedAdvertising() const override {
+    return IsSupported(OpCode::LE_SET_EXTENDED_ADVERTISING_PARAMETERS);
+  }
+
+  VendorCapabilities GetVendorCapabilities() const override {
+    VendorCapabilities vendor_capabilities{};
+    vendor_capabilities.max_advt_instances_ = num_advertisers;
+    return vendor_capabilities;
+  }
+
   uint8_t num_advertisers{0};
 
  protected:
   void Start() override {}
   void Stop() override {}
-  void ListDependencies(ModuleList* list) override {}
+  void ListDependencies(ModuleList* list) const override {}
 
  private:
   std::set<OpCode> supported_opcodes_{};
@@ -164,6 +175,11 @@ class TestHciLayer : public HciLayer {
     return command;
   }
 
+  bool IsCommandQueueEmpty() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return command_queue_.empty();
+  }
+
   void RegisterEventHandler(EventCode event_code, common::ContextualCallback<void(EventView)> event_handler) override {
     registered_events_[event_code] = event_handler;
   }
@@ -207,7 +223,7 @@ class TestHciLayer : public HciLayer {
     command_status_callbacks.pop_front();
   }
 
-  void ListDependencies(ModuleList* list) override {}
+  void ListDependencies(ModuleList* list) const override {}
   void Start() override {
     RegisterEventHandler(EventCode::COMMAND_COMPLETE,
                          GetHandler()->BindOn(this, &TestHciLayer::CommandCompleteCallback));
@@ -282,7 +298,7 @@ class TestAclManager : public AclManager {
     delete thread_;
   }
 
-  void ListDependencies(ModuleList* list) override {}
+  void ListDependencies(ModuleList* list) const override {}
 
   void SetRandomAddress(Address address) {}
 
@@ -305,7 +321,7 @@ class LeAdvertisingManagerTest : public ::testing::Test {
     fake_registry_.InjectTestModule(&AclManager::Factory, test_acl_manager_);
     client_handler_ = fake_registry_.GetTestModuleHandler(&HciLayer::Factory);
     ASSERT_NE(client_handler_, nullptr);
-    test_controller_->num_advertisers = 1;
+    test_controller_->num_advertisers = num_advertisers_;
     le_advertising_manager_ = fake_registry_.Start<LeAdvertisingManager>(&thread_);
     le_advertising_manager_->RegisterAdvertisingCallback(&mock_advertising_callback_);
   }
@@ -322,6 +338,8 @@ class LeAdvertisingManagerTest : public ::testing::Test {
   os::Thread& thread_ = fake_registry_.GetTestThread();
   LeAdvertisingManager* le_advertising_manager_ = nullptr;
   os::Handler* client_handler_ = nullptr;
+  // Advertising sets of the controller
+  uint8_t num_advertisers_ = 1;
 
   const common::Callback<void(Address, AddressType)> scan_callback =
       common::Bind(&LeAdvertisingManagerTest::on_scan, common::Unretained(this));
@@ -391,6 +409,7 @@ class LeAdvertisingAPITest : public LeAdvertisingManagerTest {
     ExtendedAdvertisingConfig advertising_config{};
     advertising_config.advertising_type = AdvertisingType::ADV_IND;
     advertising_config.own_address_type = OwnAddressType::PUBLIC_DEVICE_ADDRESS;
+    advertising_config.channel_map = 1;
     std::vector<GapData> gap_data{};
     GapData data_item{};
     data_item.data_type_ = GapDataType::FLAGS;
@@ -453,6 +472,7 @@ class LeAndroidHciAdvertisingAPITest : public LeAndroidHciAdvertisingManagerTest
     ExtendedAdvertisingConfig advertising_config{};
     advertising_config.advertising_type = AdvertisingType::ADV_IND;
     advertising_config.own_address_type = OwnAddressType::PUBLIC_DEVICE_ADDRESS;
+    advertising_config.channel_map = 1;
     std::vector<GapData> gap_data{};
     GapData data_item{};
     data_item.data_type_ = GapDataType::FLAGS;
@@ -470,8 +490,8 @@ class LeAndroidHciAdvertisingAPITest : public LeAndroidHciAdvertisingManagerTest
     ASSERT_NE(LeAdvertisingManager::kInvalidId, advertiser_id_);
     std::vector<SubOcf> sub_ocf = {
         SubOcf::SET_PARAM,
-        SubOcf::SET_DATA,
         SubOcf::SET_SCAN_RESP,
+        SubOcf::SET_DATA,
         SubOcf::SET_RANDOM_ADDR,
         SubOcf::SET_ENABLE,
     };
@@ -505,6 +525,8 @@ class LeExtendedAdvertisingManagerTest : public LeAdvertisingManagerTest {
 class LeExtendedAdvertisingAPITest : public LeExtendedAdvertisingManagerTest {
  protected:
   void SetUp() override {
+    // One advertising set per advertiser, with room for a second one
+    num_advertisers_ = 2;
     LeExtendedAdvertisingManagerTest::SetUp();
 
     // start advertising set
@@ -568,6 +590,7 @@ TEST_F(LeAdvertisingManagerTest, create_advertiser_test) {
   ExtendedAdvertisingConfig advertising_config{};
   advertising_config.advertising_type = AdvertisingType::ADV_IND;
   advertising_config.own_address_type = OwnAddressType::PUBLIC_DEVICE_ADDRESS;
+  advertising_config.channel_map = 1;
   std::vector<GapData> gap_data{};
   GapData data_item{};
   data_item.data_type_ = GapDataType::FLAGS;
@@ -619,6 +642,7 @@ TEST_F(LeAndroidHciAdvertisingManagerTest, create_advertiser_test) {
   ExtendedAdvertisingConfig advertising_config{};
   advertising_config.advertising_type = AdvertisingType::ADV_IND;
   advertising_config.own_address_type = OwnAddressType::PUBLIC_DEVICE_ADDRESS;
+  advertising_config.channel_map = 1;
   std::vector<GapData> gap_data{};
   GapData data_item{};
   data_item.data_type_ = GapDataType::FLAGS;
@@ -635,7 +659,7 @@ TEST_F(LeAndroidHciAdvertisingManagerTest, create_advertiser_test) {
       0x00, advertising_config, scan_callback, set_terminated_callback, 0, 0, client_handler_);
   ASSERT_NE(LeAdvertisingManager::kInvalidId, id);
   std::vector<SubOcf> sub_ocf = {
-      SubOcf::SET_PARAM, SubOcf::SET_DATA, SubOcf::SET_SCAN_RESP, SubOcf::SET_RANDOM_ADDR, SubOcf::SET_ENABLE,
+      SubOcf::SET_PARAM, SubOcf::SET_SCAN_RESP, SubOcf::SET_DATA, SubOcf::SET_RANDOM_ADDR, SubOcf::SET_ENABLE,
   };
   EXPECT_CALL(
       mock_advertising_callback_, OnAdvertisingSetStarted(0, id, 0, AdvertisingCallback::AdvertisingStatus::SUCCESS));
@@ -1215,6 +1239,312 @@ TEST_F(LeExtendedAdvertisingAPITest, disable_enable_periodic_advertiser_test) {
   sync_client_handler();
 }
 
+TEST_F(LeExtendedAdvertisingAPITest, set_same_data_skips_command) {
+  std::vector<GapData> advertising_data{};
+  GapData data_item{};
+  data_item.data_type_ = GapDataType::COMPLETE_LOCAL_NAME;
+  data_item.data_ = {'t', 'e', 's', 't', ' ', 'd', 'e', 'v', 'i', 'c', 'e'};
+  advertising_data.push_back(data_item);
+  test_hci_layer_->SetCommandFuture();
+  le_advertising_manager_->SetData(advertiser_id_, false, advertising_data);
+  test_hci_layer_->GetCommand(OpCode::LE_SET_EXTENDED_ADVERTISING_DATA);
+  EXPECT_CALL(
+      mock_advertising_callback_,
+      OnAdvertisingDataSet(advertiser_id_, AdvertisingCallback::AdvertisingStatus::SUCCESS));
+  test_hci_layer_->IncomingEvent(LeSetExtendedAdvertisingDataCompleteBuilder::Create(uint8_t{1}, ErrorCode::SUCCESS));
+  fake_registry_.SynchronizeModuleHandler(&LeAdvertisingManager::Factory, std::chrono::milliseconds(20));
+  sync_client_handler();
+
+  // The controller already has the data
+  EXPECT_CALL(
+      mock_advertising_callback_,
+      OnAdvertisingDataSet(advertiser_id_, AdvertisingCallback::AdvertisingStatus::SUCCESS));
+  le_advertising_manager_->SetData(advertiser_id_, false, advertising_data);
+  fake_registry_.SynchronizeModuleHandler(&LeAdvertisingManager::Factory, std::chrono::milliseconds(20));
+  sync_client_handler();
+  EXPECT_TRUE(test_hci_layer_->IsCommandQueueEmpty());
+}
+
+TEST_F(LeExtendedAdvertisingAPITest, enable_changes_share_a_command) {
+  ExtendedAdvertisingConfig advertising_config{};
+  advertising_config.advertising_type = AdvertisingType::ADV_IND;
+  advertising_config.own_address_type = OwnAddressType::PUBLIC_DEVICE_ADDRESS;
+  advertising_config.channel_map = 1;
+  advertising_config.sid = 0x02;
+  test_hci_layer_->SetCommandFuture();
+  auto second_id = le_advertising_manager_->ExtendedCreateAdvertiser(
+      0x01, advertising_config, scan_callback, set_terminated_callback, 0, 0, client_handler_);
+  ASSERT_NE(LeAdvertisingManager::kInvalidId, second_id);
+  EXPECT_CALL(
+      mock_advertising_callback_,
+      OnAdvertisingSetStarted(0x01, second_id, -23, AdvertisingCallback::AdvertisingStatus::SUCCESS));
+  std::vector<OpCode> adv_opcodes = {
+      OpCode::LE_SET_EXTENDED_ADVERTISING_PARAMETERS,
+      OpCode::LE_SET_EXTENDED_ADVERTISING_SCAN_RESPONSE,
+      OpCode::LE_SET_EXTENDED_ADVERTISING_DATA,
+      OpCode::LE_SET_EXTENDED_ADVERTISING_ENABLE,
+  };
+  std::vector<uint8_t> success_vector{static_cast<uint8_t>(ErrorCode::SUCCESS)};
+  for (size_t i = 0; i < adv_opcodes.size(); i++) {
+    test_hci_layer_->GetCommand(adv_opcodes[i]);
+    if (adv_opcodes[i] == OpCode::LE_SET_EXTENDED_ADVERTISING_PARAMETERS) {
+      test_hci_layer_->IncomingEvent(LeSetExtendedAdvertisingParametersCompleteBuilder::Create(
+          uint8_t{1}, ErrorCode::SUCCESS, static_cast<uint8_t>(-23)));
+    } else {
+      test_hci_layer_->IncomingEvent(
+          CommandCompleteBuilder::Create(uint8_t{1}, adv_opcodes[i], std::make_unique<RawBuilder>(success_vector)));
+    }
+    test_hci_layer_->SetCommandFuture();
+  }
+  sync_client_handler();
+  test_hci_layer_->ResetCommandFuture();
+
+  // Both advertisers are disabled before the manager gets to handle the first change
+  std::promise<void> queued;
+  std::future<void> queued_future = queued.get_future();
+  fake_registry_.GetTestModuleHandler(&LeAdvertisingManager::Factory)
+      ->Post(common::BindOnce([](std::future<void>* future) { future->wait(); }, &queued_future));
+  test_hci_layer_->SetCommandFuture();
+  le_advertising_manager_->EnableAdvertiser(advertiser_id_, false, 0x00, 0x00);
+  le_advertising_manager_->EnableAdvertiser(second_id, false, 0x00, 0x00);
+  queued.set_value();
+
+  auto command = LeSetExtendedAdvertisingEnableView::Create(
+      LeAdvertisingCommandView::Create(test_hci_layer_->GetCommand(OpCode::LE_SET_EXTENDED_ADVERTISING_ENABLE)));
+  ASSERT_TRUE(command.IsValid());
+  EXPECT_EQ(Enable::DISABLED, command.GetEnable());
+  EXPECT_EQ(2UL, command.GetEnabledSets().size());
+  EXPECT_CALL(
+      mock_advertising_callback_,
+      OnAdvertisingEnabled(advertiser_id_, false, AdvertisingCallback::AdvertisingStatus::SUCCESS));
+  EXPECT_CALL(
+      mock_advertising_callback_, OnAdvertisingEnabled(second_id, false, AdvertisingCallback::AdvertisingStatus::SUCCESS));
+  test_hci_layer_->IncomingEvent(LeSetExtendedAdvertisingEnableCompleteBuilder::Create(uint8_t{1}, ErrorCode::SUCCESS));
+  fake_registry_.SynchronizeModuleHandler(&LeAdvertisingManager::Factory, std::chrono::milliseconds(20));
+  sync_client_handler();
+  EXPECT_TRUE(test_hci_layer_->IsCommandQueueEmpty());
+}
+
+class LeExtendedAdvertisingMultiplexTest : public LeExtendedAdvertisingManagerTest {
+ protected:
+  void SetUp() override {
+    // Two advertisers on the single advertising set of the controller
+    os::SetSystemProperty("bluetooth.le.max_advertisers", "2");
+    os::SetSystemProperty("bluetooth.le.advertising_slice_ms", slice_ms_);
+    LeExtendedAdvertisingManagerTest::SetUp();
+  }
+
+  void TearDown() override {
+    LeExtendedAdvertisingManagerTest::TearDown();
+    os::ClearSystemPropertiesForHost();
+  }
+
+  AdvertiserId CreateAdvertiser(int reg_id) {
+    ExtendedAdvertisingConfig advertising_config{};
+    advertising_config.advertising_type = AdvertisingType::ADV_IND;
+    advertising_config.own_address_type = OwnAddressType::PUBLIC_DEVICE_ADDRESS;
+    GapData data_item{};
+    data_item.data_type_ = GapDataType::COMPLETE_LOCAL_NAME;
+    data_item.data_ = {'d', 'e', 'v', 'i', 'c', 'e', static_cast<uint8_t>('0' + reg_id)};
+    advertising_config.advertisement = {data_item};
+    advertising_config.scan_response = {data_item};
+    advertising_config.channel_map = 1;
+    advertising_config.sid = 0x01;
+    return le_advertising_manager_->ExtendedCreateAdvertiser(
+        reg_id, advertising_config, scan_callback, set_terminated_callback, 0, 0, client_handler_);
+  }
+
+  // Expects the commands in order, sent by the same task, and completes them
+  void ExpectCommands(const std::vector<OpCode>& op_codes) {
+    std::vector<uint8_t> success_vector{static_cast<uint8_t>(ErrorCode::SUCCESS)};
+    for (size_t i = 0; i < op_codes.size(); i++) {
+      test_hci_layer_->GetCommand(op_codes[i]);
+      if (i == 0) {
+        // The others are queued by now
+        sync_client_handler();
+      }
+      if (op_codes[i] == OpCode::LE_SET_EXTENDED_ADVERTISING_PARAMETERS) {
+        test_hci_layer_->IncomingEvent(LeSetExtendedAdvertisingParametersCompleteBuilder::Create(
+            uint8_t{1}, ErrorCode::SUCCESS, static_cast<uint8_t>(-23)));
+      } else {
+        test_hci_layer_->IncomingEvent(
+            CommandCompleteBuilder::Create(uint8_t{1}, op_codes[i], std::make_unique<RawBuilder>(success_vector)));
+      }
+    }
+    sync_client_handler();
+  }
+
+  const std::vector<OpCode> load_and_enable_opcodes_ = {
+      OpCode::LE_SET_EXTENDED_ADVERTISING_PARAMETERS,
+      OpCode::LE_SET_EXTENDED_ADVERTISING_SCAN_RESPONSE,
+      OpCode::LE_SET_EXTENDED_ADVERTISING_DATA,
+      OpCode::LE_SET_EXTENDED_ADVERTISING_ENABLE,
+  };
+  const char* slice_ms_ = "10000";
+};
+
+class LeExtendedAdvertisingTimeSliceTest : public LeExtendedAdvertisingMultiplexTest {
+ protected:
+  void SetUp() override {
+    slice_ms_ = "100";
+    LeExtendedAdvertisingMultiplexTest::SetUp();
+  }
+};
+
+TEST_F(LeExtendedAdvertisingMultiplexTest, advertiser_waits_for_advertising_set) {
+  test_hci_layer_->SetCommandFuture();
+  EXPECT_CALL(
+      mock_advertising_callback_,
+      OnAdvertisingSetStarted(0x00, ::testing::_, -23, AdvertisingCallback::AdvertisingStatus::SUCCESS));
+  auto first_id = CreateAdvertiser(0x00);
+  ASSERT_NE(LeAdvertisingManager::kInvalidId, first_id);
+  ExpectCommands(load_and_enable_opcodes_);
+
+  // Started right away, although it waits for its turn on air
+  EXPECT_CALL(
+      mock_advertising_callback_,
+      OnAdvertisingSetStarted(0x01, ::testing::_, ::testing::_, AdvertisingCallback::AdvertisingStatus::SUCCESS));
+  auto second_id = CreateAdvertiser(0x01);
+  ASSERT_NE(LeAdvertisingManager::kInvalidId, second_id);
+  fake_registry_.SynchronizeModuleHandler(&LeAdvertisingManager::Factory, std::chrono::milliseconds(20));
+  sync_client_handler();
+  EXPECT_TRUE(test_hci_layer_->IsCommandQueueEmpty());
+
+  // Its data is sent once it is on air
+  GapData data_item{};
+  data_item.data_type_ = GapDataType::SHORTENED_LOCAL_NAME;
+  data_item.data_ = {'d', 'e', 'v'};
+  EXPECT_CALL(
+      mock_advertising_callback_,
+      OnAdvertisingDataSet(second_id, AdvertisingCallback::AdvertisingStatus::SUCCESS));
+  le_advertising_manager_->SetData(second_id, false, {data_item});
+  fake_registry_.SynchronizeModuleHandler(&LeAdvertisingManager::Factory, std::chrono::milliseconds(20));
+  sync_client_handler();
+  EXPECT_TRUE(test_hci_layer_->IsCommandQueueEmpty());
+
+  // Disabling the first one lets the second one on air right away
+  test_hci_layer_->SetCommandFuture();
+  EXPECT_CALL(
+      mock_advertising_callback_,
+      OnAdvertisingEnabled(first_id, false, AdvertisingCallback::AdvertisingStatus::SUCCESS));
+  le_advertising_manager_->EnableAdvertiser(first_id, false, 0x00, 0x00);
+  std::vector<OpCode> op_codes = {OpCode::LE_SET_EXTENDED_ADVERTISING_ENABLE};
+  op_codes.insert(op_codes.end(), load_and_enable_opcodes_.begin(), load_and_enable_opcodes_.end());
+  ExpectCommands(op_codes);
+}
+
+TEST_F(LeExtendedAdvertisingMultiplexTest, removed_advertiser_leaves_advertising_set) {
+  test_hci_layer_->SetCommandFuture();
+  EXPECT_CALL(
+      mock_advertising_callback_,
+      OnAdvertisingSetStarted(0x00, ::testing::_, -23, AdvertisingCallback::AdvertisingStatus::SUCCESS));
+  auto first_id = CreateAdvertiser(0x00);
+  ASSERT_NE(LeAdvertisingManager::kInvalidId, first_id);
+  ExpectCommands(load_and_enable_opcodes_);
+
+  EXPECT_CALL(
+      mock_advertising_callback_,
+      OnAdvertisingSetStarted(0x01, ::testing::_, ::testing::_, AdvertisingCallback::AdvertisingStatus::SUCCESS));
+  ASSERT_NE(LeAdvertisingManager::kInvalidId, CreateAdvertiser(0x01));
+  sync_client_handler();
+
+  // The second one takes the advertising set over, so it is not removed
+  test_hci_layer_->SetCommandFuture();
+  le_advertising_manager_->RemoveAdvertiser(first_id);
+  std::vector<OpCode> op_codes = {
+      OpCode::LE_SET_EXTENDED_ADVERTISING_ENABLE, OpCode::LE_SET_PERIODIC_ADVERTISING_ENABLE};
+  op_codes.insert(op_codes.end(), load_and_enable_opcodes_.begin(), load_and_enable_opcodes_.end());
+  ExpectCommands(op_codes);
+  fake_registry_.SynchronizeModuleHandler(&LeAdvertisingManager::Factory, std::chrono::milliseconds(20));
+  EXPECT_TRUE(test_hci_layer_->IsCommandQueueEmpty());
+}
+
+TEST_F(LeExtendedAdvertisingMultiplexTest, set_same_data_skips_command) {
+  test_hci_layer_->SetCommandFuture();
+  EXPECT_CALL(
+      mock_advertising_callback_,
+      OnAdvertisingSetStarted(0x00, ::testing::_, -23, AdvertisingCallback::AdvertisingStatus::SUCCESS));
+  auto id = CreateAdvertiser(0x00);
+  ASSERT_NE(LeAdvertisingManager::kInvalidId, id);
+  ExpectCommands(load_and_enable_opcodes_);
+
+  std::vector<GapData> advertising_data{};
+  GapData data_item{};
+  data_item.data_type_ = GapDataType::COMPLETE_LOCAL_NAME;
+  data_item.data_ = {'t', 'e', 's', 't', ' ', 'd', 'e', 'v', 'i', 'c', 'e'};
+  advertising_data.push_back(data_item);
+  test_hci_layer_->SetCommandFuture();
+  le_advertising_manager_->SetData(id, false, advertising_data);
+  test_hci_layer_->GetCommand(OpCode::LE_SET_EXTENDED_ADVERTISING_DATA);
+  EXPECT_CALL(mock_advertising_callback_, OnAdvertisingDataSet(id, AdvertisingCallback::AdvertisingStatus::SUCCESS));
+  test_hci_layer_->IncomingEvent(LeSetExtendedAdvertisingDataCompleteBuilder::Create(uint8_t{1}, ErrorCode::SUCCESS));
+  fake_registry_.SynchronizeModuleHandler(&LeAdvertisingManager::Factory, std::chrono::milliseconds(20));
+  sync_client_handler();
+
+  // The controller already has the data
+  EXPECT_CALL(mock_advertising_callback_, OnAdvertisingDataSet(id, AdvertisingCallback::AdvertisingStatus::SUCCESS));
+  le_advertising_manager_->SetData(id, false, advertising_data);
+  fake_registry_.SynchronizeModuleHandler(&LeAdvertisingManager::Factory, std::chrono::milliseconds(20));
+  sync_client_handler();
+  EXPECT_TRUE(test_hci_layer_->IsCommandQueueEmpty());
+}
+
+TEST_F(LeExtendedAdvertisingMultiplexTest, failed_data_is_sent_again) {
+  test_hci_layer_->SetCommandFuture();
+  EXPECT_CALL(
+      mock_advertising_callback_,
+      OnAdvertisingSetStarted(0x00, ::testing::_, -23, AdvertisingCallback::AdvertisingStatus::SUCCESS));
+  auto id = CreateAdvertiser(0x00);
+  ASSERT_NE(LeAdvertisingManager::kInvalidId, id);
+  ExpectCommands(load_and_enable_opcodes_);
+
+  std::vector<GapData> advertising_data{};
+  GapData data_item{};
+  data_item.data_type_ = GapDataType::COMPLETE_LOCAL_NAME;
+  data_item.data_ = {'t', 'e', 's', 't', ' ', 'd', 'e', 'v', 'i', 'c', 'e'};
+  advertising_data.push_back(data_item);
+  test_hci_layer_->SetCommandFuture();
+  le_advertising_manager_->SetData(id, false, advertising_data);
+  test_hci_layer_->GetCommand(OpCode::LE_SET_EXTENDED_ADVERTISING_DATA);
+  EXPECT_CALL(
+      mock_advertising_callback_, OnAdvertisingDataSet(id, AdvertisingCallback::AdvertisingStatus::INTERNAL_ERROR));
+  test_hci_layer_->IncomingEvent(
+      LeSetExtendedAdvertisingDataCompleteBuilder::Create(uint8_t{1}, ErrorCode::MEMORY_CAPACITY_EXCEEDED));
+  fake_registry_.SynchronizeModuleHandler(&LeAdvertisingManager::Factory, std::chrono::milliseconds(20));
+  sync_client_handler();
+
+  // The controller does not have the data
+  test_hci_layer_->SetCommandFuture();
+  le_advertising_manager_->SetData(id, false, advertising_data);
+  test_hci_layer_->GetCommand(OpCode::LE_SET_EXTENDED_ADVERTISING_DATA);
+  EXPECT_CALL(mock_advertising_callback_, OnAdvertisingDataSet(id, AdvertisingCallback::AdvertisingStatus::SUCCESS));
+  test_hci_layer_->IncomingEvent(LeSetExtendedAdvertisingDataCompleteBuilder::Create(uint8_t{1}, ErrorCode::SUCCESS));
+  sync_client_handler();
+}
+
+TEST_F(LeExtendedAdvertisingTimeSliceTest, advertisers_take_turns) {
+  test_hci_layer_->SetCommandFuture();
+  EXPECT_CALL(
+      mock_advertising_callback_,
+      OnAdvertisingSetStarted(0x00, ::testing::_, -23, AdvertisingCallback::AdvertisingStatus::SUCCESS));
+  ASSERT_NE(LeAdvertisingManager::kInvalidId, CreateAdvertiser(0x00));
+  ExpectCommands(load_and_enable_opcodes_);
+
+  EXPECT_CALL(
+      mock_advertising_callback_,
+      OnAdvertisingSetStarted(0x01, ::testing::_, ::testing::_, AdvertisingCallback::AdvertisingStatus::SUCCESS));
+  ASSERT_NE(LeAdvertisingManager::kInvalidId, CreateAdvertiser(0x01));
+  sync_client_handler();
+
+  // At the end of each slice, the advertiser on air leaves the advertising set to the other one, silently
+  std::vector<OpCode> op_codes = {OpCode::LE_SET_EXTENDED_ADVERTISING_ENABLE};
+  op_codes.insert(op_codes.end(), load_and_enable_opcodes_.begin(), load_and_enable_opcodes_.end());
+  for (int slice = 0; slice < 2; slice++) {
+    test_hci_layer_->SetCommandFuture();
+    ExpectCommands(op_codes);
+  }
+}
+
 }  // namespace
 }  // namespace hci
 }  // namespace bluetooth
@@ -0,0 +1,185 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "hci/le_advertising_scheduler.h"
+
+#include <algorithm>
+
+namespace bluetooth {
+namespace hci {
+
+namespace {
+constexpr uint32_t kFullSlice = 100;
+}  // namespace
+
+LeAdvertisingScheduler::LeAdvertisingScheduler(size_t num_slots) : num_slots_(num_slots) {}
+
+void LeAdvertisingScheduler::Enable(AdvertiserId advertiser_id, bool pinned) {
+  auto it = entries_.find(advertiser_id);
+  if (it != entries_.end()) {
+    it->second.pinned = pinned;
+    return;
+  }
+
+  Entry entry;
+  entry.pinned = pinned;
+  entry.last_on_air_slice = slice_;
+  // Start level with the advertisers already taking turns, rather than owed all the slices they had
+  if (!entries_.empty()) {
+    entry.pass = std::min_element(entries_.begin(), entries_.end(), [](const auto& a, const auto& b) {
+                   return a.second.pass < b.second.pass;
+                 })->second.pass;
+  }
+  entries_[advertiser_id] = entry;
+}
+
+void LeAdvertisingScheduler::Disable(AdvertiserId advertiser_id) {
+  entries_.erase(advertiser_id);
+}
+
+void LeAdvertisingScheduler::Defer(AdvertiserId advertiser_id) {
+  auto it = entries_.find(advertiser_id);
+  if (it != entries_.end()) {
+    it->second.on_air = false;
+  }
+}
+
+void LeAdvertisingScheduler::SetPolicy(AdvertiserId advertiser_id, AdvertisingSchedulingPolicy policy) {
+  policy.duty_cycle_percent = std::clamp<uint8_t>(policy.duty_cycle_percent, 1, kFullSlice);
+  policies_[advertiser_id] = policy;
+}
+
+void LeAdvertisingScheduler::Remove(AdvertiserId advertiser_id) {
+  entries_.erase(advertiser_id);
+  policies_.erase(advertiser_id);
+}
+
+LeAdvertisingScheduler::Changes LeAdvertisingScheduler::Schedule(bool end_of_slice) {
+  if (end_of_slice) {
+    slice_++;
+    for (auto& [advertiser_id, entry] : entries_) {
+      if (entry.on_air) {
+        entry.last_on_air_slice = slice_;
+        if (!entry.pinned) {
+          entry.pass++;
+          entry.credit -= std::min(entry.credit, kFullSlice);
+        }
+      }
+      entry.credit = std::min(entry.credit + GetPolicy(advertiser_id).duty_cycle_percent, kFullSlice);
+    }
+  }
+
+  std::vector<AdvertiserId> selected;
+  std::vector<AdvertiserId> waiting;
+  for (const auto& [advertiser_id, entry] : entries_) {
+    if (entry.on_air && (entry.pinned || !end_of_slice)) {
+      selected.push_back(advertiser_id);
+    } else if (IsEligible(entry)) {
+      waiting.push_back(advertiser_id);
+    }
+  }
+  std::sort(waiting.begin(), waiting.end(), [this](AdvertiserId a, AdvertiserId b) { return RanksBefore(a, b); });
+
+  for (AdvertiserId advertiser_id : waiting) {
+    if (selected.size() < num_slots_) {
+      selected.push_back(advertiser_id);
+      continue;
+    }
+    // Within a slice, only a higher priority takes the place of an advertiser on air, the lowest ranked one
+    auto victim = selected.end();
+    for (auto it = selected.begin(); it != selected.end(); it++) {
+      if (Preempts(advertiser_id, *it) && (victim == selected.end() || RanksBefore(*victim, *it))) {
+        victim = it;
+      }
+    }
+    if (victim == selected.end()) {
+      break;
+    }
+    *victim = advertiser_id;
+  }
+
+  Changes changes;
+  for (auto& [advertiser_id, entry] : entries_) {
+    bool on_air = std::find(selected.begin(), selected.end(), advertiser_id) != selected.end();
+    if (entry.on_air && !on_air) {
+      changes.stopped.push_back(advertiser_id);
+    } else if (!entry.on_air && on_air) {
+      changes.started.push_back(advertiser_id);
+    }
+    entry.on_air = on_air;
+  }
+  return changes;
+}
+
+bool LeAdvertisingScheduler::IsOnAir(AdvertiserId advertiser_id) const {
+  auto it = entries_.find(advertiser_id);
+  return it != entries_.end() && it->second.on_air;
+}
+
+bool LeAdvertisingScheduler::NeedsSlicing() const {
+  for (const auto& [advertiser_id, entry] : entries_) {
+    if (!entry.on_air) {
+      return true;
+    }
+    if (!entry.pinned && GetPolicy(advertiser_id).duty_cycle_percent < kFullSlice) {
+      return true;
+    }
+  }
+  return false;
+}
+
+AdvertisingSchedulingPolicy LeAdvertisingScheduler::GetPolicy(AdvertiserId advertiser_id) const {
+  auto it = policies_.find(advertiser_id);
+  return it == policies_.end() ? AdvertisingSchedulingPolicy{} : it->second;
+}
+
+bool LeAdvertisingScheduler::IsEligible(const Entry& entry) const {
+  return entry.pinned || entry.credit >= kFullSlice;
+}
+
+bool LeAdvertisingScheduler::RanksBefore(AdvertiserId a, AdvertiserId b) const {
+  const Entry& entry_a = entries_.at(a);
+  const Entry& entry_b = entries_.at(b);
+  if (entry_a.pinned != entry_b.pinned) {
+    return entry_a.pinned;
+  }
+  auto priority_a = GetPolicy(a).priority;
+  auto priority_b = GetPolicy(b).priority;
+  if (priority_a != priority_b) {
+    return priority_a > priority_b;
+  }
+  if (entry_a.pass != entry_b.pass) {
+    return entry_a.pass < entry_b.pass;
+  }
+  // Then the one waiting for longer
+  if (entry_a.last_on_air_slice != entry_b.last_on_air_slice) {
+    return entry_a.last_on_air_slice < entry_b.last_on_air_slice;
+  }
+  if (entry_a.on_air != entry_b.on_air) {
+    return entry_a.on_air;
+  }
+  return a < b;
+}
+
+bool LeAdvertisingScheduler::Preempts(AdvertiserId waiting, AdvertiserId on_air) const {
+  const Entry& entry = entries_.at(on_air);
+  if (entry.pinned) {
+    return false;
+  }
+  return entries_.at(waiting).pinned || GetPolicy(waiting).priority > GetPolicy(on_air).priority;
+}
+
+}  // namespace hci
+}  // namespace bluetooth
@@ -0,0 +1,102 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+namespace bluetooth {
+namespace hci {
+
+using AdvertiserId = uint8_t;
+
+class AdvertisingSchedulingPolicy {
+ public:
+  enum class Priority : uint8_t { LOW = 0, NORMAL = 1, HIGH = 2 };
+  // Advertisers of a higher priority go on air first when more are enabled than the controller can advertise
+  Priority priority = Priority::NORMAL;
+  // Share of the time slices the advertiser may be on air, from 1 to 100
+  uint8_t duty_cycle_percent = 100;
+};
+
+/**
+ * Picks which of the enabled advertisers are on air, when there may be more of them than hardware advertising sets.
+ *
+ * Time is cut in slices. At the end of each slice, the advertisers go on air by order of priority, then of the slices
+ * they were on air for, so that advertisers of the same priority take turns. An advertiser with a duty cycle below 100
+ * percent earns that much of a slice for each slice, and needs a whole one to go on air.
+ *
+ * Pinned advertisers, such as those counting a duration in the controller, come first and are never taken off air.
+ */
+class LeAdvertisingScheduler {
+ public:
+  struct Changes {
+    std::vector<AdvertiserId> stopped;
+    std::vector<AdvertiserId> started;
+  };
+
+  explicit LeAdvertisingScheduler(size_t num_slots);
+
+  // The advertiser wants to be on air. Calling it again updates whether it is pinned.
+  void Enable(AdvertiserId advertiser_id, bool pinned);
+
+  // The advertiser is off air, and no longer wants to be on air
+  void Disable(AdvertiserId advertiser_id);
+
+  // The advertiser could not go on air as picked, and waits for the next schedule with its turns kept
+  void Defer(AdvertiserId advertiser_id);
+
+  // The policy applies until the advertiser is removed
+  void SetPolicy(AdvertiserId advertiser_id, AdvertisingSchedulingPolicy policy);
+  void Remove(AdvertiserId advertiser_id);
+
+  /**
+   * Picks the advertisers on air. At the end of a slice, all of them are picked again. Otherwise, the advertisers on
+   * air stay there, unless one of a higher priority waits, and only free slots are given away.
+   */
+  Changes Schedule(bool end_of_slice);
+
+  bool IsOnAir(AdvertiserId advertiser_id) const;
+
+  // Whether the advertisers on air may change at the end of the slice
+  bool NeedsSlicing() const;
+
+ private:
+  struct Entry {
+    bool pinned = false;
+    bool on_air = false;
+    // Slices spent on air, relative to the other advertisers
+    uint64_t pass = 0;
+    // In percent of a slice
+    uint32_t credit = 100;
+    uint64_t last_on_air_slice = 0;
+  };
+
+  AdvertisingSchedulingPolicy GetPolicy(AdvertiserId advertiser_id) const;
+  bool IsEligible(const Entry& entry) const;
+  bool RanksBefore(AdvertiserId a, AdvertiserId b) const;
+  bool Preempts(AdvertiserId waiting, AdvertiserId on_air) const;
+
+  const size_t num_slots_;
+  uint64_t slice_ = 0;
+  std::map<AdvertiserId, Entry> entries_;
+  std::map<AdvertiserId, AdvertisingSchedulingPolicy> policies_;
+};
+
+}  // namespace hci
+}  // namespace bluetooth
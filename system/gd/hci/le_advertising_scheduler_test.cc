@@ -0,0 +1,181 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hci/le_advertising_scheduler.h"
+
+#include <gtest/gtest.h>
+
+#include <map>
+
+namespace bluetooth {
+namespace hci {
+namespace {
+
+using Priority = AdvertisingSchedulingPolicy::Priority;
+
+AdvertisingSchedulingPolicy MakePolicy(Priority priority, uint8_t duty_cycle_percent = 100) {
+  AdvertisingSchedulingPolicy policy;
+  policy.priority = priority;
+  policy.duty_cycle_percent = duty_cycle_percent;
+  return policy;
+}
+
+class LeAdvertisingSchedulerTest : public ::testing::Test {
+ protected:
+  // Ends num_slices slices, and counts the slices each advertiser is on air for
+  std::map<AdvertiserId, int> RunSlices(LeAdvertisingScheduler* scheduler, int num_slices, size_t num_slots) {
+    std::map<AdvertiserId, int> slices_on_air;
+    for (int i = 0; i < num_slices; i++) {
+      scheduler->Schedule(true);
+      size_t on_air = 0;
+      for (AdvertiserId id = 0; id < 16; id++) {
+        if (scheduler->IsOnAir(id)) {
+          slices_on_air[id]++;
+          on_air++;
+        }
+      }
+      EXPECT_LE(on_air, num_slots);
+    }
+    return slices_on_air;
+  }
+};
+
+TEST_F(LeAdvertisingSchedulerTest, fills_free_slots) {
+  LeAdvertisingScheduler scheduler(2);
+  scheduler.Enable(0, false);
+  scheduler.Enable(1, false);
+
+  auto changes = scheduler.Schedule(false);
+  EXPECT_EQ(changes.started, std::vector<AdvertiserId>({0, 1}));
+  EXPECT_TRUE(changes.stopped.empty());
+  EXPECT_FALSE(scheduler.NeedsSlicing());
+
+  // Nothing changes at the end of the slice while everyone fits
+  changes = scheduler.Schedule(true);
+  EXPECT_TRUE(changes.started.empty());
+  EXPECT_TRUE(changes.stopped.empty());
+}
+
+TEST_F(LeAdvertisingSchedulerTest, advertisers_beyond_capacity_take_turns) {
+  LeAdvertisingScheduler scheduler(2);
+  for (AdvertiserId id = 0; id < 5; id++) {
+    scheduler.Enable(id, false);
+  }
+  scheduler.Schedule(false);
+  EXPECT_TRUE(scheduler.NeedsSlicing());
+
+  auto slices_on_air = RunSlices(&scheduler, 10, 2);
+  for (AdvertiserId id = 0; id < 5; id++) {
+    EXPECT_EQ(slices_on_air[id], 4) << "advertiser " << (int)id;
+  }
+}
+
+TEST_F(LeAdvertisingSchedulerTest, higher_priority_takes_place_within_slice) {
+  LeAdvertisingScheduler scheduler(1);
+  scheduler.Enable(0, false);
+  scheduler.Schedule(false);
+
+  scheduler.SetPolicy(1, MakePolicy(Priority::HIGH));
+  scheduler.Enable(1, false);
+  auto changes = scheduler.Schedule(false);
+  EXPECT_EQ(changes.stopped, std::vector<AdvertiserId>({0}));
+  EXPECT_EQ(changes.started, std::vector<AdvertiserId>({1}));
+
+  // Lower priorities wait for as long as a higher one is enabled
+  auto slices_on_air = RunSlices(&scheduler, 5, 1);
+  EXPECT_EQ(slices_on_air[1], 5);
+  EXPECT_EQ(slices_on_air[0], 0);
+}
+
+TEST_F(LeAdvertisingSchedulerTest, same_priority_waits_for_end_of_slice) {
+  LeAdvertisingScheduler scheduler(1);
+  scheduler.Enable(0, false);
+  scheduler.Schedule(false);
+
+  scheduler.Enable(1, false);
+  auto changes = scheduler.Schedule(false);
+  EXPECT_TRUE(changes.started.empty());
+  EXPECT_TRUE(changes.stopped.empty());
+
+  changes = scheduler.Schedule(true);
+  EXPECT_EQ(changes.stopped, std::vector<AdvertiserId>({0}));
+  EXPECT_EQ(changes.started, std::vector<AdvertiserId>({1}));
+}
+
+TEST_F(LeAdvertisingSchedulerTest, duty_cycle_limits_time_on_air) {
+  LeAdvertisingScheduler scheduler(4);
+  scheduler.SetPolicy(0, MakePolicy(Priority::NORMAL, 25));
+  scheduler.Enable(0, false);
+  scheduler.Schedule(false);
+  EXPECT_TRUE(scheduler.IsOnAir(0));
+  EXPECT_TRUE(scheduler.NeedsSlicing());
+
+  // On air one slice out of four, although slots are free
+  auto slices_on_air = RunSlices(&scheduler, 20, 4);
+  EXPECT_EQ(slices_on_air[0], 5);
+}
+
+TEST_F(LeAdvertisingSchedulerTest, pinned_advertiser_stays_on_air) {
+  LeAdvertisingScheduler scheduler(1);
+  scheduler.Enable(0, true);
+  scheduler.Schedule(false);
+
+  scheduler.SetPolicy(1, MakePolicy(Priority::HIGH));
+  scheduler.Enable(1, false);
+  auto changes = scheduler.Schedule(false);
+  EXPECT_TRUE(changes.started.empty());
+  EXPECT_TRUE(changes.stopped.empty());
+
+  auto slices_on_air = RunSlices(&scheduler, 3, 1);
+  EXPECT_EQ(slices_on_air[0], 3);
+
+  // Its slot goes to the next in line once it is disabled
+  scheduler.Disable(0);
+  changes = scheduler.Schedule(false);
+  EXPECT_EQ(changes.started, std::vector<AdvertiserId>({1}));
+  EXPECT_FALSE(scheduler.NeedsSlicing());
+}
+
+TEST_F(LeAdvertisingSchedulerTest, newcomer_shares_slots_evenly) {
+  LeAdvertisingScheduler scheduler(1);
+  scheduler.Enable(0, false);
+  scheduler.Schedule(false);
+  RunSlices(&scheduler, 10, 1);
+
+  // The advertiser alone so far is not owed ten slices to the newcomer
+  scheduler.Enable(1, false);
+  scheduler.Schedule(false);
+  auto slices_on_air = RunSlices(&scheduler, 10, 1);
+  EXPECT_EQ(slices_on_air[0], 5);
+  EXPECT_EQ(slices_on_air[1], 5);
+}
+
+TEST_F(LeAdvertisingSchedulerTest, deferred_advertiser_goes_on_air_later) {
+  LeAdvertisingScheduler scheduler(1);
+  scheduler.Enable(0, false);
+  scheduler.Schedule(false);
+  scheduler.Defer(0);
+  EXPECT_FALSE(scheduler.IsOnAir(0));
+  EXPECT_TRUE(scheduler.NeedsSlicing());
+
+  auto changes = scheduler.Schedule(true);
+  EXPECT_EQ(changes.started, std::vector<AdvertiserId>({0}));
+  EXPECT_FALSE(scheduler.NeedsSlicing());
+}
+
+}  // namespace
+}  // namespace hci
+}  // namespace bluetooth
@@ -27,16 +27,40 @@
 bluetooth::l2cap::classic::internal::DumpsysHelper::DumpsysHelper(const LinkManager& link_manager)
     : link_manager_(link_manager) {}
 
+flatbuffers::Offset<bluetooth::l2cap::classic::ChannelData>
+bluetooth::l2cap::classic::internal::DumpsysHelper::DumpChannel(
+    flatbuffers::FlatBufferBuilder* fb_builder,
+    Cid cid,
+    const l2cap::internal::DataPipelineManager& data_pipeline_manager) const {
+  l2cap::internal::Scheduler::ChannelStatistics statistics;
+  bool has_statistics = data_pipeline_manager.GetChannelStatistics(cid, &statistics);
+
+  ChannelDataBuilder builder(*fb_builder);
+  builder.add_cid(cid);
+  if (has_statistics) {
+    builder.add_tx_priority_class(static_cast<int>(statistics.priority_class));
+    builder.add_tx_weight(statistics.weight);
+    builder.add_tx_queue_depth(statistics.queue_depth);
+    builder.add_tx_max_queue_depth(statistics.max_queue_depth);
+    builder.add_tx_packets(statistics.packets_sent);
+    builder.add_tx_bytes(statistics.bytes_sent);
+    if (statistics.packets_sent != 0) {
+      builder.add_tx_average_wait_us(statistics.total_wait_time.count() / statistics.packets_sent);
+    }
+    builder.add_tx_max_wait_us(statistics.max_wait_time.count());
+  }
+  return builder.Finish();
+}
+
 std::vector<flatbuffers::Offset<bluetooth::l2cap::classic::ChannelData>>
 bluetooth::l2cap::classic::internal::DumpsysHelper::DumpActiveDynamicChannels(
     flatbuffers::FlatBufferBuilder* fb_builder,
-    const l2cap::internal::DynamicChannelAllocator& channel_allocator) const {
+    const l2cap::internal::DynamicChannelAllocator& channel_allocator,
+    const l2cap::internal::DataPipelineManager& data_pipeline_manager) const {
   std::vector<flatbuffers::Offset<bluetooth::l2cap::classic::ChannelData>> channel_offsets;
 
   for (auto it = channel_allocator.channels_.cbegin(); it != channel_allocator.channels_.cend(); ++it) {
-    ChannelDataBuilder builder(*fb_builder);
-    builder.add_cid(it->first);
-    channel_offsets.push_back(builder.Finish());
+    channel_offsets.push_back(DumpChannel(fb_builder, it->first, data_pipeline_manager));
   }
   return channel_offsets;
 }
@@ -46,13 +70,12 @@ bluetooth::l2cap::classic::internal::DumpsysHelper::DumpActiveFixedChannels(
     flatbuffers::FlatBufferBuilder* fb_builder,
     const bluetooth::l2cap::internal::FixedChannelAllocator<
         bluetooth::l2cap::classic::internal::FixedChannelImpl,
-        bluetooth::l2cap::classic::internal::Link>& channel_allocator) const {
+        bluetooth::l2cap::classic::internal::Link>& channel_allocator,
+    const l2cap::internal::DataPipelineManager& data_pipeline_manager) const {
   std::vector<flatbuffers::Offset<bluetooth::l2cap::classic::ChannelData>> channel_offsets;
 
   for (auto it = channel_allocator.channels_.cbegin(); it != channel_allocator.channels_.cend(); ++it) {
-    ChannelDataBuilder builder(*fb_builder);
-    builder.add_cid(it->first);
-    channel_offsets.push_back(builder.Finish());
+    channel_offsets.push_back(DumpChannel(fb_builder, it->first, data_pipeline_manager));
   }
   return channel_offsets;
 }
@@ -65,10 +88,12 @@ bluetooth::l2cap::classic::internal::DumpsysHelper::DumpActiveLinks(flatbuffers:
 
   for (auto it = links->cbegin(); it != links->cend(); ++it) {
     auto link_address = fb_builder->CreateString(it->second.ToString());
-    auto dynamic_channel_offsets = DumpActiveDynamicChannels(fb_builder, it->second.dynamic_channel_allocator_);
+    auto dynamic_channel_offsets = DumpActiveDynamicChannels(
+        fb_builder, it->second.dynamic_channel_allocator_, it->second.data_pipeline_manager_);
     auto dynamic_channels = fb_builder->CreateVector(dynamic_channel_offsets);
 
-    auto fixed_channel_offsets = DumpActiveFixedChannels(fb_builder, it->second.fixed_channel_allocator_);
+    auto fixed_channel_offsets =
+        DumpActiveFixedChannels(fb_builder, it->second.fixed_channel_allocator_, it->second.data_pipeline_manager_);
     auto fixed_channels = fb_builder->CreateVector(fixed_channel_offsets);
 
     LinkDataBuilder builder(*fb_builder);
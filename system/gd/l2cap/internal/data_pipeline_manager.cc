@@ -22,11 +22,25 @@
 #include "l2cap/internal/data_pipeline_manager.h"
 #include "l2cap/internal/sender.h"
 #include "os/log.h"
+#include "os/system_properties.h"
 
 namespace bluetooth {
 namespace l2cap {
 namespace internal {
 
+namespace {
+constexpr char kSchedulerProperty[] = "bluetooth.l2cap.scheduler";
+constexpr char kWeightedFairScheduler[] = "weighted_fair";
+}  // namespace
+
+std::unique_ptr<Scheduler> DataPipelineManager::CreateScheduler(
+    DataPipelineManager* data_pipeline_manager, LowerQueueUpEnd* link_queue_up_end, os::Handler* handler) {
+  if (os::GetSystemProperty(kSchedulerProperty) == kWeightedFairScheduler) {
+    return std::make_unique<WeightedFair>(data_pipeline_manager, link_queue_up_end, handler);
+  }
+  return std::make_unique<Fifo>(data_pipeline_manager, link_queue_up_end, handler);
+}
+
 void DataPipelineManager::AttachChannel(Cid cid, std::shared_ptr<ChannelImpl> channel, ChannelMode mode) {
   ASSERT(sender_map_.find(cid) == sender_map_.end());
   sender_map_.emplace(std::piecewise_construct, std::forward_as_tuple(cid),
@@ -62,6 +76,16 @@ void DataPipelineManager::SetChannelTxPriority(Cid cid, bool high_priority) {
   scheduler_->SetChannelTxPriority(cid, high_priority);
 }
 
+void DataPipelineManager::SetChannelTxParameters(
+    Cid cid, Scheduler::TxPriorityClass priority_class, uint16_t weight) {
+  ASSERT(sender_map_.find(cid) != sender_map_.end());
+  scheduler_->SetChannelTxParameters(cid, priority_class, weight);
+}
+
+bool DataPipelineManager::GetChannelStatistics(Cid cid, Scheduler::ChannelStatistics* statistics) const {
+  return scheduler_->GetChannelStatistics(cid, statistics);
+}
+
 }  // namespace internal
 }  // namespace l2cap
 }  // namespace bluetooth
@@ -28,6 +28,7 @@
 #include "l2cap/internal/receiver.h"
 #include "l2cap/internal/scheduler.h"
 #include "l2cap/internal/scheduler_fifo.h"
+#include "l2cap/internal/scheduler_weighted_fair.h"
 #include "l2cap/l2cap_packets.h"
 #include "l2cap/mtu.h"
 #include "os/handler.h"
@@ -56,7 +57,7 @@ class DataPipelineManager {
   using LowerQueueUpEnd = common::BidiQueueEnd<LowerEnqueue, LowerDequeue>;
 
   DataPipelineManager(os::Handler* handler, ILink* link, LowerQueueUpEnd* link_queue_up_end)
-      : handler_(handler), link_(link), scheduler_(std::make_unique<Fifo>(this, link_queue_up_end, handler)),
+      : handler_(handler), link_(link), scheduler_(CreateScheduler(this, link_queue_up_end, handler)),
         receiver_(link_queue_up_end, handler, this) {}
 
   using ChannelMode = Sender::ChannelMode;
@@ -67,9 +68,15 @@ class DataPipelineManager {
   virtual void OnPacketSent(Cid cid);
   virtual void UpdateClassicConfiguration(Cid cid, classic::internal::ChannelConfigurationState config);
   virtual void SetChannelTxPriority(Cid cid, bool high_priority);
+  virtual void SetChannelTxParameters(Cid cid, Scheduler::TxPriorityClass priority_class, uint16_t weight);
+  virtual bool GetChannelStatistics(Cid cid, Scheduler::ChannelStatistics* statistics) const;
   virtual ~DataPipelineManager() = default;
 
  private:
+  // Use the weighted fair scheduler if the system property asks for it, otherwise the FIFO one
+  static std::unique_ptr<Scheduler> CreateScheduler(
+      DataPipelineManager* data_pipeline_manager, LowerQueueUpEnd* link_queue_up_end, os::Handler* handler);
+
   os::Handler* handler_;
   ILink* link_;
   std::unordered_map<Cid, Sender> sender_map_;
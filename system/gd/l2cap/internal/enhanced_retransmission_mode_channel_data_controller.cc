@@ -18,13 +18,12 @@
 
 #include <map>
 #include <queue>
+#include <unordered_set>
 #include <vector>
 
 #include "common/bind.h"
 #include "l2cap/internal/ilink.h"
 #include "os/alarm.h"
-#include "packet/fragmenting_inserter.h"
-#include "packet/raw_builder.h"
 
 namespace bluetooth {
 namespace l2cap {
@@ -80,9 +79,9 @@ struct ErtmController::impl {
   int unacked_frames_ = 0;
   // TODO: Instead of having a map, we may consider about a better data structure
   // Map from TxSeq to (SAR, SDU size for START packet, information payload)
-  std::map<uint8_t, std::tuple<SegmentationAndReassembly, uint16_t, std::shared_ptr<packet::RawBuilder>>> unacked_list_;
+  std::map<uint8_t, std::tuple<SegmentationAndReassembly, uint16_t, SduSegmentBuilder>> unacked_list_;
   // Stores (SAR, SDU size for START packet, information payload)
-  std::queue<std::tuple<SegmentationAndReassembly, uint16_t, std::unique_ptr<packet::RawBuilder>>> pending_frames_;
+  std::queue<std::tuple<SegmentationAndReassembly, uint16_t, SduSegmentBuilder>> pending_frames_;
   int retry_count_ = 0;
   std::map<uint8_t /* tx_seq, */, int /* count */> retry_i_frames_;
   bool rnr_sent_ = false;
@@ -97,7 +96,7 @@ struct ErtmController::impl {
 
   // Events (@see 8.6.5.4)
 
-  void data_request(SegmentationAndReassembly sar, std::unique_ptr<packet::RawBuilder> pdu, uint16_t sdu_size = 0) {
+  void data_request(SegmentationAndReassembly sar, SduSegmentBuilder pdu, uint16_t sdu_size = 0) {
     // Note: sdu_size only applies to START packet
     if (tx_state_ == TxState::XMIT && !remote_busy() && rem_window_not_full()) {
       send_data(sar, sdu_size, std::move(pdu));
@@ -574,38 +573,35 @@ struct ErtmController::impl {
 
   // Actions (@see 8.6.5.6)
 
-  void _send_i_frame(SegmentationAndReassembly sar, std::unique_ptr<CopyablePacketBuilder> segment, uint8_t req_seq,
-                     uint8_t tx_seq, uint16_t sdu_size = 0, Final f = Final::NOT_SET) {
+  void _send_i_frame(SegmentationAndReassembly sar, const SduSegmentBuilder& segment, uint8_t req_seq, uint8_t tx_seq,
+                     uint16_t sdu_size = 0, Final f = Final::NOT_SET) {
+    // Only the headers are built again, the payload still refers to the SDU serialized when it was queued
+    auto payload = std::make_unique<SduSegmentBuilder>(segment);
     std::unique_ptr<packet::BasePacketBuilder> builder;
     if (sar == SegmentationAndReassembly::START) {
       if (controller_->fcs_enabled_) {
         builder = EnhancedInformationStartFrameWithFcsBuilder::Create(controller_->remote_cid_, tx_seq, f, req_seq,
-                                                                      sdu_size, std::move(segment));
+                                                                      sdu_size, std::move(payload));
       } else {
         builder = EnhancedInformationStartFrameBuilder::Create(controller_->remote_cid_, tx_seq, f, req_seq, sdu_size,
-                                                               std::move(segment));
+                                                               std::move(payload));
       }
     } else {
       if (controller_->fcs_enabled_) {
         builder = EnhancedInformationFrameWithFcsBuilder::Create(controller_->remote_cid_, tx_seq, f, req_seq, sar,
-                                                                 std::move(segment));
+                                                                 std::move(payload));
       } else {
         builder = EnhancedInformationFrameBuilder::Create(controller_->remote_cid_, tx_seq, f, req_seq, sar,
-                                                          std::move(segment));
+                                                          std::move(payload));
       }
     }
     controller_->send_pdu(std::move(builder));
   }
 
-  void send_data(SegmentationAndReassembly sar, uint16_t sdu_size, std::unique_ptr<packet::RawBuilder> segment,
+  void send_data(SegmentationAndReassembly sar, uint16_t sdu_size, SduSegmentBuilder segment,
                  Final f = Final::NOT_SET) {
-    std::shared_ptr<packet::RawBuilder> shared_segment(segment.release());
-    unacked_list_.emplace(std::piecewise_construct, std::forward_as_tuple(next_tx_seq_),
-                          std::forward_as_tuple(sar, sdu_size, shared_segment));
-
-    std::unique_ptr<CopyablePacketBuilder> copyable_packet_builder =
-        std::make_unique<CopyablePacketBuilder>(std::get<2>(unacked_list_.find(next_tx_seq_)->second));
-    _send_i_frame(sar, std::move(copyable_packet_builder), buffer_seq_, next_tx_seq_, sdu_size, f);
+    _send_i_frame(sar, segment, buffer_seq_, next_tx_seq_, sdu_size, f);
+    unacked_list_.insert_or_assign(next_tx_seq_, std::make_tuple(sar, sdu_size, std::move(segment)));
     unacked_frames_++;
     frames_sent_++;
     retry_i_frames_[next_tx_seq_] = 1;
@@ -613,12 +609,12 @@ struct ErtmController::impl {
     start_retrans_timer();
   }
 
-  void pend_data(SegmentationAndReassembly sar, uint16_t sdu_size, std::unique_ptr<packet::RawBuilder> data) {
+  void pend_data(SegmentationAndReassembly sar, uint16_t sdu_size, SduSegmentBuilder data) {
     pending_frames_.emplace(std::make_tuple(sar, sdu_size, std::move(data)));
   }
 
   void process_req_seq(uint8_t req_seq) {
-    for (int i = expected_ack_seq_; i < req_seq; i++) {
+    for (uint8_t i = expected_ack_seq_; i != req_seq; i = (i + 1) % kMaxTxWin) {
       unacked_list_.erase(i);
       retry_i_frames_[i] = 0;
     }
@@ -756,14 +752,12 @@ struct ErtmController::impl {
         CloseChannel();
         return;
       }
-      std::unique_ptr<CopyablePacketBuilder> copyable_packet_builder =
-          std::make_unique<CopyablePacketBuilder>(std::get<2>(unacked_list_.find(i)->second));
-      _send_i_frame(std::get<0>(unacked_list_.find(i)->second), std::move(copyable_packet_builder), buffer_seq_, i,
-                    std::get<1>(unacked_list_.find(i)->second), f);
+      auto& frame = unacked_list_.find(i)->second;
+      _send_i_frame(std::get<0>(frame), std::get<2>(frame), buffer_seq_, i, std::get<1>(frame), f);
       retry_i_frames_[i]++;
       frames_sent_++;
       f = Final::NOT_SET;
-      i++;
+      i = (i + 1) % kMaxTxWin;
     }
     if (i != req_seq) {
       start_retrans_timer();
@@ -776,10 +770,8 @@ struct ErtmController::impl {
       LOG_ERROR("Received invalid SREJ");
       return;
     }
-    std::unique_ptr<CopyablePacketBuilder> copyable_packet_builder =
-        std::make_unique<CopyablePacketBuilder>(std::get<2>(unacked_list_.find(req_seq)->second));
-    _send_i_frame(std::get<0>(unacked_list_.find(req_seq)->second), std::move(copyable_packet_builder), buffer_seq_,
-                  req_seq, std::get<1>(unacked_list_.find(req_seq)->second), f);
+    auto& frame = unacked_list_.find(req_seq)->second;
+    _send_i_frame(std::get<0>(frame), std::get<2>(frame), buffer_seq_, req_seq, std::get<1>(frame), f);
     retry_i_frames_[req_seq]++;
     start_retrans_timer();
   }
@@ -812,21 +804,20 @@ struct ErtmController::impl {
 // Segmentation is handled here
 void ErtmController::OnSdu(std::unique_ptr<packet::BasePacketBuilder> sdu) {
   auto sdu_size = sdu->size();
-  std::vector<std::unique_ptr<packet::RawBuilder>> segments;
-  auto size_each_packet = (remote_mps_ - 4 /* basic L2CAP header */ - 2 /* SDU length */ - 2 /* Enhanced control */ -
-                           (fcs_enabled_ ? 2 : 0));
-  packet::FragmentingInserter fragmenting_inserter(size_each_packet, std::back_insert_iterator(segments));
-  sdu->Serialize(fragmenting_inserter);
-  fragmenting_inserter.finalize();
-  if (segments.size() == 1) {
-    pimpl_->data_request(SegmentationAndReassembly::UNSEGMENTED, std::move(segments[0]));
+  size_t size_each_packet = (remote_mps_ - 4 /* basic L2CAP header */ - 2 /* SDU length */ - 2 /* Enhanced control */ -
+                             (fcs_enabled_ ? 2 : 0));
+  // Serialized once, every I-frame of the SDU refers to its own slice of it until it is acknowledged
+  auto bytes = std::make_shared<const std::vector<uint8_t>>(sdu->SerializeToBytes());
+  if (sdu_size <= size_each_packet) {
+    pimpl_->data_request(SegmentationAndReassembly::UNSEGMENTED, SduSegmentBuilder(bytes, 0, sdu_size));
     return;
   }
-  pimpl_->data_request(SegmentationAndReassembly::START, std::move(segments[0]), sdu_size);
-  for (size_t i = 1; i < segments.size() - 1; i++) {
-    pimpl_->data_request(SegmentationAndReassembly::CONTINUATION, std::move(segments[i]));
+  pimpl_->data_request(SegmentationAndReassembly::START, SduSegmentBuilder(bytes, 0, size_each_packet), sdu_size);
+  size_t offset = size_each_packet;
+  for (; sdu_size - offset > size_each_packet; offset += size_each_packet) {
+    pimpl_->data_request(SegmentationAndReassembly::CONTINUATION, SduSegmentBuilder(bytes, offset, size_each_packet));
   }
-  pimpl_->data_request(SegmentationAndReassembly::END, std::move(segments.back()));
+  pimpl_->data_request(SegmentationAndReassembly::END, SduSegmentBuilder(bytes, offset, sdu_size - offset));
 }
 
 void ErtmController::OnPdu(packet::PacketView<true> pdu) {
@@ -988,8 +979,15 @@ void ErtmController::stage_for_reassembly(SegmentationAndReassembly sar, uint16_
         return;
       }
       // TODO: Enforce MTU
+      if (payload.size() > sdu_size) {
+        LOG_WARN("Received invalid START I-Frame");
+        close_channel();
+        return;
+      }
       sar_state_ = SegmentationAndReassembly::START;
-      reassembly_stage_ = payload;
+      reassembly_buffer_ = std::make_shared<std::vector<uint8_t>>();
+      reassembly_buffer_->reserve(sdu_size);
+      reassembly_buffer_->insert(reassembly_buffer_->end(), payload.begin(), payload.end());
       remaining_sdu_continuation_packet_size_ = sdu_size - payload.size();
       break;
     case SegmentationAndReassembly::CONTINUATION:
@@ -998,7 +996,15 @@ void ErtmController::stage_for_reassembly(SegmentationAndReassembly sar, uint16_
         close_channel();
         return;
       }
-      reassembly_stage_.AppendPacketView(payload);
+      if (payload.size() > remaining_sdu_continuation_packet_size_) {
+        LOG_WARN("Received invalid CONTINUATION I-Frame");
+        sar_state_ = SegmentationAndReassembly::END;
+        reassembly_buffer_.reset();
+        remaining_sdu_continuation_packet_size_ = 0;
+        close_channel();
+        return;
+      }
+      reassembly_buffer_->insert(reassembly_buffer_->end(), payload.begin(), payload.end());
       remaining_sdu_continuation_packet_size_ -= payload.size();
       break;
     case SegmentationAndReassembly::END:
@@ -1008,17 +1014,17 @@ void ErtmController::stage_for_reassembly(SegmentationAndReassembly sar, uint16_
         return;
       }
       sar_state_ = SegmentationAndReassembly::END;
-      remaining_sdu_continuation_packet_size_ -= payload.size();
-      if (remaining_sdu_continuation_packet_size_ != 0) {
+      if (payload.size() != remaining_sdu_continuation_packet_size_) {
         LOG_WARN("Received invalid END I-Frame");
-        reassembly_stage_ =
-            PacketViewForReassembly(PacketView<kLittleEndian>(std::make_shared<std::vector<uint8_t>>()));
+        reassembly_buffer_.reset();
         remaining_sdu_continuation_packet_size_ = 0;
         close_channel();
         return;
       }
-      reassembly_stage_.AppendPacketView(payload);
-      enqueue_buffer_.Enqueue(std::make_unique<packet::PacketView<kLittleEndian>>(reassembly_stage_), handler_);
+      reassembly_buffer_->insert(reassembly_buffer_->end(), payload.begin(), payload.end());
+      remaining_sdu_continuation_packet_size_ = 0;
+      enqueue_buffer_.Enqueue(
+          std::make_unique<packet::PacketView<kLittleEndian>>(std::move(reassembly_buffer_)), handler_);
       if (enqueue_buffer_.Size() == kEnqueueBufferBusyThreshold) {
         pimpl_->local_busy_detected();
         enqueue_buffer_.NotifyOnEmpty(common::BindOnce(&impl::local_busy_clear, common::Unretained(pimpl_.get())));
@@ -1049,12 +1055,17 @@ void ErtmController::close_channel() {
   link_->SendDisconnectionRequest(cid_, remote_cid_);
 }
 
-size_t ErtmController::CopyablePacketBuilder::size() const {
-  return builder_->size();
-}
-
-void ErtmController::CopyablePacketBuilder::Serialize(BitInserter& it) const {
-  builder_->Serialize(it);
+size_t ErtmController::GetRetransmissionBufferBytes() const {
+  // The I-frames of an SDU share its buffer, count it once
+  size_t bytes = 0;
+  std::unordered_set<const std::vector<uint8_t>*> sdus;
+  for (const auto& frame : pimpl_->unacked_list_) {
+    const auto* sdu = std::get<2>(frame.second).GetSdu().get();
+    if (sdus.insert(sdu).second) {
+      bytes += sdu->size();
+    }
+  }
+  return bytes;
 }
 
 }  // namespace internal
@@ -19,19 +19,20 @@
 #include <memory>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "common/bidi_queue.h"
 #include "l2cap/cid.h"
 #include "l2cap/internal/channel_impl.h"
 #include "l2cap/internal/data_controller.h"
 #include "l2cap/internal/scheduler.h"
+#include "l2cap/internal/sdu_segment_builder.h"
 #include "l2cap/l2cap_packets.h"
 #include "l2cap/mtu.h"
 #include "os/handler.h"
 #include "os/queue.h"
 #include "packet/base_packet_builder.h"
 #include "packet/packet_view.h"
-#include "packet/raw_builder.h"
 
 namespace bluetooth {
 namespace l2cap {
@@ -52,6 +53,8 @@ class ErtmController : public DataController {
   std::unique_ptr<packet::BasePacketBuilder> GetNextPacket() override;
   void EnableFcs(bool enabled) override;
   void SetRetransmissionAndFlowControlOptions(const RetransmissionAndFlowControlConfigurationOption& option) override;
+  // Bytes of serialized SDUs kept for retransmission by the I-frames waiting for an acknowledgement
+  size_t GetRetransmissionBufferBytes() const;
 
  private:
   ILink* link_;
@@ -72,27 +75,8 @@ class ErtmController : public DataController {
   uint16_t remote_tx_window_ = 10;
   uint16_t remote_mps_ = 1010;
 
-  class PacketViewForReassembly : public packet::PacketView<kLittleEndian> {
-   public:
-    PacketViewForReassembly(const PacketView& packetView) : PacketView(packetView) {}
-    void AppendPacketView(packet::PacketView<kLittleEndian> to_append) {
-      Append(to_append);
-    }
-  };
-
-  class CopyablePacketBuilder : public packet::BasePacketBuilder {
-   public:
-    CopyablePacketBuilder(std::shared_ptr<packet::RawBuilder> builder) : builder_(std::move(builder)) {}
-
-    void Serialize(BitInserter& it) const override;
-
-    size_t size() const override;
-
-   private:
-    std::shared_ptr<packet::RawBuilder> builder_;
-  };
-
-  PacketViewForReassembly reassembly_stage_{PacketView<kLittleEndian>(std::make_shared<std::vector<uint8_t>>())};
+  // The SDU being reassembled, allocated with the SDU length from its START I-frame
+  std::shared_ptr<std::vector<uint8_t>> reassembly_buffer_;
   SegmentationAndReassembly sar_state_ = SegmentationAndReassembly::END;
   uint16_t remaining_sdu_continuation_packet_size_ = 0;
 
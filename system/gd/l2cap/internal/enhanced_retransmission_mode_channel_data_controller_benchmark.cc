@@ -0,0 +1,143 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "l2cap/internal/enhanced_retransmission_mode_channel_data_controller.h"
+#include "l2cap/internal/loopback_test_util.h"
+#include "os/handler.h"
+#include "os/mock_queue.h"
+#include "os/thread.h"
+#include "packet/raw_builder.h"
+
+using ::benchmark::State;
+
+namespace bluetooth {
+namespace l2cap {
+namespace internal {
+namespace {
+
+constexpr Cid kCid = 0x0040;
+constexpr size_t kSduSize = 8192;
+constexpr uint16_t kMps = 1010;
+constexpr uint8_t kTxWindow = 32;
+
+packet::PacketView<packet::kLittleEndian> ToPacketView(std::unique_ptr<packet::BasePacketBuilder> packet) {
+  return packet::PacketView<packet::kLittleEndian>(std::make_shared<std::vector<uint8_t>>(packet->SerializeToBytes()));
+}
+
+// Two ERTM channels connected back to back by a lossy link. Every loss_interval-th I-frame of the sender is dropped,
+// unless it's the last one it has ready, so that the receiver notices the gap and rejects it instead of waiting for
+// the retransmission timer.
+class BM_ErtmLoopback : public ::benchmark::Fixture {
+ protected:
+  void SetUp(State& st) override {
+    ::benchmark::Fixture::SetUp(st);
+    thread_ = std::make_unique<os::Thread>("ertm_benchmark", os::Thread::Priority::NORMAL);
+    handler_ = std::make_unique<os::Handler>(thread_.get());
+    RetransmissionAndFlowControlConfigurationOption option;
+    option.tx_window_size_ = kTxWindow;
+    option.max_transmit_ = 0xff;
+    // Losses are recovered by REJ, keep the timers out of the way
+    option.retransmission_time_out_ = 0xffff;
+    option.monitor_time_out_ = 0xffff;
+    option.maximum_pdu_size_ = kMps;
+    sender_ = std::make_unique<ErtmController>(
+        &sender_link_, kCid, kCid, &sender_queue_end_, handler_.get(), &sender_scheduler_);
+    receiver_ = std::make_unique<ErtmController>(
+        &receiver_link_, kCid, kCid, &receiver_queue_end_, handler_.get(), &receiver_scheduler_);
+    sender_->SetRetransmissionAndFlowControlOptions(option);
+    receiver_->SetRetransmissionAndFlowControlOptions(option);
+  }
+
+  void TearDown(State& st) override {
+    sender_.reset();
+    receiver_.reset();
+    handler_->Clear();
+    handler_.reset();
+    thread_.reset();
+    ::benchmark::Fixture::TearDown(st);
+  }
+
+  void Transfer(int64_t loss_interval) {
+    while (sender_scheduler_.ready_packets > 0 || receiver_scheduler_.ready_packets > 0) {
+      while (sender_scheduler_.ready_packets > 0) {
+        sender_scheduler_.ready_packets--;
+        auto pdu = sender_->GetNextPacket();
+        if (loss_interval > 0 && ++frames_sent_ % loss_interval == 0 && sender_scheduler_.ready_packets > 0) {
+          frames_dropped_++;
+          continue;
+        }
+        receiver_->OnPdu(ToPacketView(std::move(pdu)));
+      }
+      peak_retransmission_buffer_bytes_ =
+          std::max(peak_retransmission_buffer_bytes_, sender_->GetRetransmissionBufferBytes());
+      while (receiver_scheduler_.ready_packets > 0) {
+        receiver_scheduler_.ready_packets--;
+        sender_->OnPdu(ToPacketView(receiver_->GetNextPacket()));
+      }
+    }
+    while (receiver_enqueue_.registered_handler != nullptr) {
+      receiver_enqueue_.run_enqueue();
+      bytes_received_ += receiver_enqueue_.enqueued.front()->size();
+      receiver_enqueue_.enqueued.pop();
+    }
+  }
+
+  std::unique_ptr<os::Thread> thread_;
+  std::unique_ptr<os::Handler> handler_;
+  testing::LoopbackLink sender_link_;
+  testing::LoopbackLink receiver_link_;
+  testing::CountingScheduler sender_scheduler_;
+  testing::CountingScheduler receiver_scheduler_;
+  os::MockIQueueEnqueue<ErtmController::UpperEnqueue> sender_enqueue_;
+  os::MockIQueueDequeue<ErtmController::UpperDequeue> sender_dequeue_;
+  ErtmController::UpperQueueDownEnd sender_queue_end_{&sender_enqueue_, &sender_dequeue_};
+  os::MockIQueueEnqueue<ErtmController::UpperEnqueue> receiver_enqueue_;
+  os::MockIQueueDequeue<ErtmController::UpperDequeue> receiver_dequeue_;
+  ErtmController::UpperQueueDownEnd receiver_queue_end_{&receiver_enqueue_, &receiver_dequeue_};
+  std::unique_ptr<ErtmController> sender_;
+  std::unique_ptr<ErtmController> receiver_;
+  int64_t frames_sent_ = 0;
+  int64_t frames_dropped_ = 0;
+  int64_t bytes_received_ = 0;
+  size_t peak_retransmission_buffer_bytes_ = 0;
+};
+
+BENCHMARK_DEFINE_F(BM_ErtmLoopback, transfer_sdu)(State& state) {
+  std::vector<uint8_t> sdu(kSduSize, 0x5a);
+  for (auto _ : state) {
+    sender_->OnSdu(std::make_unique<packet::RawBuilder>(sdu));
+    Transfer(state.range(0));
+  }
+  if (sender_link_.disconnected || receiver_link_.disconnected) {
+    state.SkipWithError("Channel disconnected");
+  }
+  state.SetBytesProcessed(bytes_received_);
+  state.counters["frames_dropped"] = ::benchmark::Counter(frames_dropped_, ::benchmark::Counter::kAvgIterations);
+  state.counters["retransmission_buffer_bytes"] = peak_retransmission_buffer_bytes_;
+}
+
+// No loss, 2% and 10% of the I-frames lost
+BENCHMARK_REGISTER_F(BM_ErtmLoopback, transfer_sdu)->Arg(0)->Arg(50)->Arg(10);
+
+}  // namespace
+}  // namespace internal
+}  // namespace l2cap
+}  // namespace bluetooth
@@ -50,6 +50,23 @@ void sync_handler(os::Handler* handler) {
   EXPECT_EQ(status, std::future_status::ready);
 }
 
+// Payload of an I-frame without FCS, and its TxSeq
+std::pair<std::string, uint8_t> GetIFramePayload(std::unique_ptr<packet::BasePacketBuilder> packet) {
+  auto standard_view = StandardFrameView::Create(BasicFrameView::Create(GetPacketView(std::move(packet))));
+  EXPECT_TRUE(standard_view.IsValid());
+  auto i_frame_view = EnhancedInformationFrameView::Create(standard_view);
+  EXPECT_TRUE(i_frame_view.IsValid());
+  PacketView<kLittleEndian> payload = i_frame_view.GetPayload();
+  if (i_frame_view.GetSar() == SegmentationAndReassembly::START) {
+    payload = EnhancedInformationStartFrameView::Create(i_frame_view).GetPayload();
+  }
+  return {std::string(payload.begin(), payload.end()), i_frame_view.GetTxSeq()};
+}
+
+PacketView<kLittleEndian> CreateSFrame(SupervisoryFunction s, uint8_t req_seq) {
+  return GetPacketView(EnhancedSupervisoryFrameBuilder::Create(1, s, Poll::NOT_SET, Final::NOT_SET, req_seq));
+}
+
 class ErtmDataControllerTest : public ::testing::Test {
  protected:
   void SetUp() override {
@@ -204,6 +221,80 @@ TEST_F(ErtmDataControllerTest, receive_packet_with_fcs) {
   EXPECT_EQ(data, "abcd");
 }
 
+TEST_F(ErtmDataControllerTest, transmit_segmented) {
+  common::BidiQueue<Scheduler::UpperEnqueue, Scheduler::UpperDequeue> channel_queue{10};
+  testing::MockScheduler scheduler;
+  testing::MockILink link;
+  ErtmController controller{&link, 1, 1, channel_queue.GetDownEnd(), queue_handler_, &scheduler};
+  RetransmissionAndFlowControlConfigurationOption option;
+  option.tx_window_size_ = 10;
+  option.max_transmit_ = 20;
+  option.retransmission_time_out_ = 2000;
+  option.monitor_time_out_ = 12000;
+  // Two bytes of payload in each I-frame
+  option.maximum_pdu_size_ = 10;
+  controller.SetRetransmissionAndFlowControlOptions(option);
+  EXPECT_CALL(scheduler, OnPacketsReady(1, 1)).Times(3);
+  controller.OnSdu(CreateSdu({'a', 'b', 'c', 'd', 'e'}));
+  EXPECT_EQ(GetIFramePayload(controller.GetNextPacket()), std::make_pair(std::string("ab"), uint8_t{0}));
+  EXPECT_EQ(GetIFramePayload(controller.GetNextPacket()), std::make_pair(std::string("cd"), uint8_t{1}));
+  EXPECT_EQ(GetIFramePayload(controller.GetNextPacket()), std::make_pair(std::string("e"), uint8_t{2}));
+  // The three I-frames share the SDU
+  EXPECT_EQ(controller.GetRetransmissionBufferBytes(), 5u);
+}
+
+TEST_F(ErtmDataControllerTest, retransmit_after_reject) {
+  common::BidiQueue<Scheduler::UpperEnqueue, Scheduler::UpperDequeue> channel_queue{10};
+  testing::MockScheduler scheduler;
+  testing::MockILink link;
+  ErtmController controller{&link, 1, 1, channel_queue.GetDownEnd(), queue_handler_, &scheduler};
+  EXPECT_CALL(scheduler, OnPacketsReady(1, 1)).Times(3);
+  controller.OnSdu(CreateSdu({'a', 'b'}));
+  controller.OnSdu(CreateSdu({'c', 'd'}));
+  EXPECT_EQ(GetIFramePayload(controller.GetNextPacket()), std::make_pair(std::string("ab"), uint8_t{0}));
+  EXPECT_EQ(GetIFramePayload(controller.GetNextPacket()), std::make_pair(std::string("cd"), uint8_t{1}));
+  EXPECT_EQ(controller.GetRetransmissionBufferBytes(), 4u);
+  // The remote got the first I-frame only
+  controller.OnPdu(CreateSFrame(SupervisoryFunction::REJECT, 1));
+  EXPECT_EQ(controller.GetRetransmissionBufferBytes(), 2u);
+  EXPECT_EQ(GetIFramePayload(controller.GetNextPacket()), std::make_pair(std::string("cd"), uint8_t{1}));
+  controller.OnPdu(CreateSFrame(SupervisoryFunction::RECEIVER_READY, 2));
+  EXPECT_EQ(controller.GetRetransmissionBufferBytes(), 0u);
+}
+
+TEST_F(ErtmDataControllerTest, tx_seq_wraps_around) {
+  common::BidiQueue<Scheduler::UpperEnqueue, Scheduler::UpperDequeue> channel_queue{10};
+  testing::MockScheduler scheduler;
+  testing::MockILink link;
+  ErtmController controller{&link, 1, 1, channel_queue.GetDownEnd(), queue_handler_, &scheduler};
+  EXPECT_CALL(scheduler, OnPacketsReady(1, 1)).Times(::testing::AnyNumber());
+  for (int i = 0; i < 70; i++) {
+    controller.OnSdu(CreateSdu({static_cast<uint8_t>('a' + i % 26)}));
+    EXPECT_EQ(GetIFramePayload(controller.GetNextPacket()).second, i % 64);
+    controller.OnPdu(CreateSFrame(SupervisoryFunction::RECEIVER_READY, (i + 1) % 64));
+  }
+  EXPECT_EQ(controller.GetRetransmissionBufferBytes(), 0u);
+  controller.OnSdu(CreateSdu({'z'}));
+  EXPECT_EQ(GetIFramePayload(controller.GetNextPacket()), std::make_pair(std::string("z"), uint8_t{6}));
+  controller.OnPdu(CreateSFrame(SupervisoryFunction::REJECT, 6));
+  EXPECT_EQ(GetIFramePayload(controller.GetNextPacket()), std::make_pair(std::string("z"), uint8_t{6}));
+}
+
+TEST_F(ErtmDataControllerTest, reassemble_continuation_longer_than_sdu_will_disconnect) {
+  common::BidiQueue<Scheduler::UpperEnqueue, Scheduler::UpperDequeue> channel_queue{10};
+  testing::MockScheduler scheduler;
+  testing::MockILink link;
+  ErtmController controller{&link, 1, 1, channel_queue.GetDownEnd(), queue_handler_, &scheduler};
+  auto builder1 = EnhancedInformationStartFrameBuilder::Create(1, 0, Final::NOT_SET, 0, 3, CreateSdu({'a'}));
+  controller.OnPdu(GetPacketView(std::move(builder1)));
+  auto builder2 = EnhancedInformationFrameBuilder::Create(
+      1, 1, Final::NOT_SET, 0, SegmentationAndReassembly::CONTINUATION, CreateSdu({'b', 'c', 'd'}));
+  EXPECT_CALL(link, SendDisconnectionRequest(1, 1));
+  controller.OnPdu(GetPacketView(std::move(builder2)));
+  sync_handler(queue_handler_);
+  EXPECT_EQ(channel_queue.GetUpEnd()->TryDequeue(), nullptr);
+}
+
 }  // namespace
 }  // namespace internal
 }  // namespace l2cap
@@ -16,10 +16,10 @@
 
 #include "l2cap/internal/le_credit_based_channel_data_controller.h"
 
+#include <algorithm>
+
 #include "l2cap/l2cap_packets.h"
 #include "l2cap/le/internal/link.h"
-#include "packet/fragmenting_inserter.h"
-#include "packet/raw_builder.h"
 
 namespace bluetooth {
 namespace l2cap {
@@ -40,38 +40,39 @@ void LeCreditBasedDataController::OnSdu(std::unique_ptr<packet::BasePacketBuilde
   if (sdu_size > mtu_) {
     LOG_WARN("Received sdu_size %d > mtu %d", static_cast<int>(sdu_size), mtu_);
   }
-  std::vector<std::unique_ptr<packet::RawBuilder>> segments;
-  // TODO: We don't need to waste 2 bytes for continuation segment.
-  packet::FragmentingInserter fragmenting_inserter(mps_ - 2, std::back_insert_iterator(segments));
-  sdu->Serialize(fragmenting_inserter);
-  fragmenting_inserter.finalize();
-  std::unique_ptr<BasicFrameBuilder> builder;
-  builder = FirstLeInformationFrameBuilder::Create(remote_cid_, sdu_size, std::move(segments[0]));
-  pdu_queue_.emplace(std::move(builder));
-  for (size_t i = 1; i < segments.size(); i++) {
-    builder = BasicFrameBuilder::Create(remote_cid_, std::move(segments[i]));
-    pdu_queue_.emplace(std::move(builder));
-  }
-  if (credits_ >= segments.size()) {
-    scheduler_->OnPacketsReady(cid_, segments.size());
-    credits_ -= segments.size();
+  size_t pdus = number_of_pdus(sdu_size);
+  sdu_queue_.push(PendingSdu{std::make_shared<const std::vector<uint8_t>>(sdu->SerializeToBytes()), 0});
+  statistics_.tx_sdus++;
+  if (credits_ >= pdus) {
+    scheduler_->OnPacketsReady(cid_, pdus);
+    credits_ -= pdus;
   } else if (credits_ > 0) {
     scheduler_->OnPacketsReady(cid_, credits_);
-    pending_frames_count_ += (segments.size() - credits_);
+    pending_frames_count_ += (pdus - credits_);
+    statistics_.credit_stalled_pdus += (pdus - credits_);
     credits_ = 0;
   } else {
-    pending_frames_count_ += segments.size();
+    pending_frames_count_ += pdus;
+    statistics_.credit_stalled_pdus += pdus;
   }
 }
 
 void LeCreditBasedDataController::OnPdu(packet::PacketView<true> pdu) {
+  // The remote spent a credit on this PDU, even if we drop it
+  statistics_.rx_pdus++;
+  if (rx_credits_ > 0) {
+    rx_credits_--;
+  }
+  rx_credits_to_return_++;
   auto basic_frame_view = BasicFrameView::Create(pdu);
   if (!basic_frame_view.IsValid()) {
     LOG_WARN("Received invalid frame");
     return;
   }
-  if (basic_frame_view.size() > mps_) {
-    LOG_WARN("Received frame size %d > mps %d, dropping the packet", static_cast<int>(basic_frame_view.size()), mps_);
+  // The MPS limits the information payload, not the basic L2CAP header
+  auto frame_payload_size = basic_frame_view.GetPayload().size();
+  if (frame_payload_size > mps_) {
+    LOG_WARN("Received frame size %d > mps %d, dropping the packet", static_cast<int>(frame_payload_size), mps_);
     return;
   }
   if (remaining_sdu_continuation_packet_size_ == 0) {
@@ -84,28 +85,56 @@ void LeCreditBasedDataController::OnPdu(packet::PacketView<true> pdu) {
     auto sdu_size = start_frame_view.GetL2capSduLength();
     remaining_sdu_continuation_packet_size_ = sdu_size - payload.size();
     reassembly_stage_ = payload;
+    statistics_.rx_bytes += payload.size();
   } else {
     auto payload = basic_frame_view.GetPayload();
     remaining_sdu_continuation_packet_size_ -= payload.size();
     reassembly_stage_.AppendPacketView(payload);
+    statistics_.rx_bytes += payload.size();
   }
   if (remaining_sdu_continuation_packet_size_ == 0) {
     enqueue_buffer_.Enqueue(std::make_unique<PacketView<kLittleEndian>>(reassembly_stage_), handler_);
+    statistics_.rx_sdus++;
   } else if (remaining_sdu_continuation_packet_size_ < 0 || reassembly_stage_.size() > mtu_) {
     LOG_WARN("Received larger SDU size than expected");
     reassembly_stage_ = PacketViewForReassembly(PacketView<kLittleEndian>(std::make_shared<std::vector<uint8_t>>()));
     remaining_sdu_continuation_packet_size_ = 0;
     link_->SendDisconnectionRequest(cid_, remote_cid_);
   }
-  // TODO: Improve the logic by sending credit only after user dequeued the SDU
-  link_->SendLeCredit(cid_, 1);
+  maybe_return_credits();
+}
+
+// Only the first PDU of an SDU carries the SDU length, continuation PDUs are filled up to the MPS
+size_t LeCreditBasedDataController::number_of_pdus(size_t sdu_size) const {
+  size_t first_pdu_payload_size = mps_ - 2;
+  if (sdu_size <= first_pdu_payload_size) {
+    return 1;
+  }
+  return 1 + (sdu_size - first_pdu_payload_size + mps_ - 1) / mps_;
 }
 
 std::unique_ptr<packet::BasePacketBuilder> LeCreditBasedDataController::GetNextPacket() {
-  ASSERT(!pdu_queue_.empty());
-  auto next = std::move(pdu_queue_.front());
-  pdu_queue_.pop();
-  return next;
+  ASSERT(!sdu_queue_.empty());
+  auto& sdu = sdu_queue_.front();
+  size_t sdu_size = sdu.bytes->size();
+  size_t segment_size;
+  std::unique_ptr<BasicFrameBuilder> builder;
+  if (sdu.offset == 0) {
+    segment_size = std::min<size_t>(sdu_size, mps_ - 2);
+    builder = FirstLeInformationFrameBuilder::Create(
+        remote_cid_, sdu_size, std::make_unique<SduSegmentBuilder>(sdu.bytes, 0, segment_size));
+  } else {
+    segment_size = std::min<size_t>(sdu_size - sdu.offset, mps_);
+    builder = BasicFrameBuilder::Create(
+        remote_cid_, std::make_unique<SduSegmentBuilder>(sdu.bytes, sdu.offset, segment_size));
+  }
+  sdu.offset += segment_size;
+  if (sdu.offset == sdu_size) {
+    sdu_queue_.pop();
+  }
+  statistics_.tx_pdus++;
+  statistics_.tx_bytes += segment_size;
+  return builder;
 }
 
 void LeCreditBasedDataController::SetMtu(Mtu mtu) {
@@ -122,10 +151,11 @@ void LeCreditBasedDataController::OnCredit(uint16_t credits) {
     link_->SendDisconnectionRequest(cid_, remote_cid_);
   }
   credits_ = total_credits;
+  statistics_.credits_received += credits;
   if (pending_frames_count_ > 0 && credits_ >= pending_frames_count_) {
     scheduler_->OnPacketsReady(cid_, pending_frames_count_);
-    pending_frames_count_ = 0;
     credits_ -= pending_frames_count_;
+    pending_frames_count_ = 0;
   } else if (pending_frames_count_ > 0) {
     scheduler_->OnPacketsReady(cid_, credits_);
     pending_frames_count_ -= credits_;
@@ -133,6 +163,40 @@ void LeCreditBasedDataController::OnCredit(uint16_t credits) {
   }
 }
 
+void LeCreditBasedDataController::SetInitialRxCredits(uint16_t credits) {
+  initial_rx_credits_ = credits;
+  rx_credits_ = credits;
+}
+
+const LeCreditBasedDataController::Statistics& LeCreditBasedDataController::GetStatistics() const {
+  return statistics_;
+}
+
+void LeCreditBasedDataController::maybe_return_credits() {
+  if (rx_credits_to_return_ == 0 || rx_credits_ > initial_rx_credits_ / 4) {
+    return;
+  }
+  if (enqueue_buffer_.Size() > 0) {
+    // The user hasn't taken the SDUs we already received, so don't let the remote send more until it does
+    if (!waiting_for_enqueue_buffer_empty_) {
+      waiting_for_enqueue_buffer_empty_ = true;
+      enqueue_buffer_.NotifyOnEmpty(common::BindOnce(
+          &LeCreditBasedDataController::on_enqueue_buffer_empty, common::Unretained(this)));
+    }
+    return;
+  }
+  link_->SendLeCredit(cid_, rx_credits_to_return_);
+  statistics_.credits_returned += rx_credits_to_return_;
+  statistics_.credit_packets_sent++;
+  rx_credits_ += rx_credits_to_return_;
+  rx_credits_to_return_ = 0;
+}
+
+void LeCreditBasedDataController::on_enqueue_buffer_empty() {
+  waiting_for_enqueue_buffer_empty_ = false;
+  maybe_return_credits();
+}
+
 }  // namespace internal
 }  // namespace l2cap
 }  // namespace bluetooth
@@ -17,8 +17,10 @@
 #pragma once
 
 #include <memory>
+#include <queue>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "common/bidi_queue.h"
 #include "l2cap/cid.h"
@@ -26,6 +28,7 @@
 #include "l2cap/internal/data_controller.h"
 #include "l2cap/internal/ilink.h"
 #include "l2cap/internal/scheduler.h"
+#include "l2cap/internal/sdu_segment_builder.h"
 #include "l2cap/l2cap_packets.h"
 #include "l2cap/mtu.h"
 #include "os/handler.h"
@@ -55,21 +58,57 @@ class LeCreditBasedDataController : public DataController {
   // TODO: Set MTU and MPS from signalling channel
   void SetMtu(Mtu mtu);
   void SetMps(uint16_t mps);
-  // TODO: Handle credits
+  // Credits received from the remote, allowing us to send that many more PDUs
   void OnCredit(uint16_t credits);
+  // Credits we granted to the remote when the channel was opened. Credits for received PDUs are returned in one batch
+  // once the remote is down to a quarter of them, instead of one LE Flow Control Credit per PDU.
+  void SetInitialRxCredits(uint16_t credits);
+
+  struct Statistics {
+    uint64_t tx_sdus = 0;
+    uint64_t tx_pdus = 0;
+    uint64_t tx_bytes = 0;
+    uint64_t rx_sdus = 0;
+    uint64_t rx_pdus = 0;
+    uint64_t rx_bytes = 0;
+    // Credits the remote gave us, and how many PDUs had to wait for one
+    uint64_t credits_received = 0;
+    uint64_t credit_stalled_pdus = 0;
+    // Credits we gave back to the remote, and in how many LE Flow Control Credit packets
+    uint64_t credits_returned = 0;
+    uint64_t credit_packets_sent = 0;
+  };
+  const Statistics& GetStatistics() const;
 
  private:
   Cid cid_;
   Cid remote_cid_;
   os::EnqueueBuffer<UpperEnqueue> enqueue_buffer_;
   os::Handler* handler_;
-  std::queue<std::unique_ptr<packet::BasePacketBuilder>> pdu_queue_;
   Scheduler* scheduler_;
   ILink* link_;
   Mtu mtu_ = 512;
   uint16_t mps_ = 251;
   uint16_t credits_ = 0;
   uint16_t pending_frames_count_ = 0;
+  uint16_t initial_rx_credits_ = 0;
+  // Credits the remote has left, and credits for received PDUs we haven't returned yet
+  uint16_t rx_credits_ = 0;
+  uint16_t rx_credits_to_return_ = 0;
+  bool waiting_for_enqueue_buffer_empty_ = false;
+  Statistics statistics_;
+
+  // Serialized SDUs waiting to be sent, with the offset of the first byte not yet put in a PDU. PDUs are cut from
+  // them one at a time when the scheduler asks for the next packet.
+  struct PendingSdu {
+    std::shared_ptr<const std::vector<uint8_t>> bytes;
+    size_t offset;
+  };
+  std::queue<PendingSdu> sdu_queue_;
+
+  size_t number_of_pdus(size_t sdu_size) const;
+  void maybe_return_credits();
+  void on_enqueue_buffer_empty();
 
   class PacketViewForReassembly : public packet::PacketView<kLittleEndian> {
    public:
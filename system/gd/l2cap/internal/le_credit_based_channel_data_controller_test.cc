@@ -19,6 +19,7 @@
 #include <gtest/gtest.h>
 
 #include "l2cap/internal/ilink_mock.h"
+#include "l2cap/internal/loopback_test_util.h"
 #include "l2cap/internal/scheduler_mock.h"
 #include "l2cap/l2cap_packets.h"
 #include "packet/raw_builder.h"
@@ -64,11 +65,49 @@ class LeCreditBasedDataControllerTest : public ::testing::Test {
     delete thread_;
   }
 
+  // The controller runs on the same handler that moves received SDUs to the channel queue
+  void ReceivePdu(LeCreditBasedDataController& controller, std::unique_ptr<packet::BasePacketBuilder> pdu) {
+    queue_handler_->Post(common::BindOnce(
+        &LeCreditBasedDataController::OnPdu, common::Unretained(&controller), GetPacketView(std::move(pdu))));
+    sync_handler(queue_handler_);
+  }
+
+  // Received SDUs get to the channel queue from the reactor, not through the handler, so wait on the queue itself
+  std::unique_ptr<Scheduler::UpperEnqueue> DequeueSdu(
+      common::BidiQueueEnd<Scheduler::UpperDequeue, Scheduler::UpperEnqueue>* channel_queue_up_end) {
+    std::promise<std::unique_ptr<Scheduler::UpperEnqueue>> promise;
+    auto future = promise.get_future();
+    channel_queue_up_end->RegisterDequeue(
+        user_handler_,
+        common::Bind(
+            [](common::BidiQueueEnd<Scheduler::UpperDequeue, Scheduler::UpperEnqueue>* up_end,
+               std::promise<std::unique_ptr<Scheduler::UpperEnqueue>>* promise) {
+              up_end->UnregisterDequeue();
+              promise->set_value(up_end->TryDequeue());
+            },
+            common::Unretained(channel_queue_up_end),
+            common::Unretained(&promise)));
+    if (future.wait_for(std::chrono::milliseconds(300)) != std::future_status::ready) {
+      channel_queue_up_end->UnregisterDequeue();
+      return nullptr;
+    }
+    return future.get();
+  }
+
   os::Thread* thread_ = nullptr;
   os::Handler* user_handler_ = nullptr;
   os::Handler* queue_handler_ = nullptr;
 };
 
+// Send every PDU the sender has credits for to the receiver, as the scheduler and the link would
+void TransferReadyPdus(
+    testing::CountingScheduler* scheduler, LeCreditBasedDataController* sender, LeCreditBasedDataController* receiver) {
+  while (scheduler->ready_packets > 0) {
+    scheduler->ready_packets--;
+    receiver->OnPdu(GetPacketView(sender->GetNextPacket()));
+  }
+}
+
 TEST_F(LeCreditBasedDataControllerTest, transmit_unsegmented) {
   common::BidiQueue<Scheduler::UpperEnqueue, Scheduler::UpperDequeue> channel_queue{10};
   testing::MockScheduler scheduler;
@@ -121,6 +160,53 @@ TEST_F(LeCreditBasedDataControllerTest, transmit_segmented) {
   EXPECT_EQ(data, "cd");
 }
 
+TEST_F(LeCreditBasedDataControllerTest, transmit_segmented_fills_mps) {
+  common::BidiQueue<Scheduler::UpperEnqueue, Scheduler::UpperDequeue> channel_queue{10};
+  testing::MockScheduler scheduler;
+  testing::MockILink link;
+  LeCreditBasedDataController controller{&link, 0x41, 0x41, channel_queue.GetDownEnd(), queue_handler_, &scheduler};
+  controller.OnCredit(10);
+  controller.SetMps(4);
+  // Only the first PDU carries the SDU length: 'ab', 'cdef' and 'ghij'
+  EXPECT_CALL(scheduler, OnPacketsReady(0x41, 3));
+  controller.OnSdu(CreateSdu({'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'i', 'j'}));
+  std::vector<std::string> payloads;
+  for (int i = 0; i < 3; i++) {
+    auto pdu_view = BasicFrameView::Create(GetPacketView(controller.GetNextPacket()));
+    EXPECT_TRUE(pdu_view.IsValid());
+    PacketView<kLittleEndian> payload = pdu_view.GetPayload();
+    if (i == 0) {
+      auto first_le_info_view = FirstLeInformationFrameView::Create(pdu_view);
+      EXPECT_TRUE(first_le_info_view.IsValid());
+      EXPECT_EQ(first_le_info_view.GetL2capSduLength(), 10);
+      payload = first_le_info_view.GetPayload();
+    }
+    payloads.emplace_back(payload.begin(), payload.end());
+  }
+  EXPECT_EQ(payloads, std::vector<std::string>({"ab", "cdef", "ghij"}));
+  EXPECT_EQ(controller.GetStatistics().tx_pdus, 3u);
+  EXPECT_EQ(controller.GetStatistics().tx_bytes, 10u);
+}
+
+TEST_F(LeCreditBasedDataControllerTest, transmit_waits_for_credits) {
+  common::BidiQueue<Scheduler::UpperEnqueue, Scheduler::UpperDequeue> channel_queue{10};
+  testing::MockScheduler scheduler;
+  testing::MockILink link;
+  LeCreditBasedDataController controller{&link, 0x41, 0x41, channel_queue.GetDownEnd(), queue_handler_, &scheduler};
+  controller.SetMps(4);
+  controller.OnCredit(1);
+  EXPECT_CALL(scheduler, OnPacketsReady(0x41, 1));
+  controller.OnSdu(CreateSdu({'a', 'b', 'c', 'd'}));
+  EXPECT_EQ(controller.GetStatistics().credit_stalled_pdus, 1u);
+  EXPECT_CALL(scheduler, OnPacketsReady(0x41, 1));
+  controller.OnCredit(3);
+  // Only the two credits left over are available for the three PDUs of the next SDU
+  EXPECT_CALL(scheduler, OnPacketsReady(0x41, 2));
+  controller.OnSdu(CreateSdu({'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h'}));
+  EXPECT_EQ(controller.GetStatistics().credit_stalled_pdus, 2u);
+  EXPECT_EQ(controller.GetStatistics().credits_received, 4u);
+}
+
 TEST_F(LeCreditBasedDataControllerTest, receive_unsegmented) {
   common::BidiQueue<Scheduler::UpperEnqueue, Scheduler::UpperDequeue> channel_queue{10};
   testing::MockScheduler scheduler;
@@ -131,9 +217,8 @@ TEST_F(LeCreditBasedDataControllerTest, receive_unsegmented) {
   auto builder = FirstLeInformationFrameBuilder::Create(0x41, 4, std::move(segment));
   auto base_view = GetPacketView(std::move(builder));
   controller.OnPdu(base_view);
-  sync_handler(queue_handler_);
-  auto payload = channel_queue.GetUpEnd()->TryDequeue();
-  EXPECT_NE(payload, nullptr);
+  auto payload = DequeueSdu(channel_queue.GetUpEnd());
+  ASSERT_NE(payload, nullptr);
   std::string data = std::string(payload->begin(), payload->end());
   EXPECT_EQ(data, "abcd");
 }
@@ -144,18 +229,15 @@ TEST_F(LeCreditBasedDataControllerTest, receive_segmented) {
   testing::MockILink link;
   LeCreditBasedDataController controller{&link, 0x41, 0x41, channel_queue.GetDownEnd(), queue_handler_, &scheduler};
   controller.OnCredit(10);
+  controller.SetInitialRxCredits(2);
+  // Both credits come back in one packet, once the SDU is in the channel queue
+  EXPECT_CALL(link, SendLeCredit(0x41, 2));
   auto segment1 = CreateSdu({'a', 'b', 'c', 'd'});
-  auto builder1 = FirstLeInformationFrameBuilder::Create(0x41, 7, std::move(segment1));
-  auto base_view = GetPacketView(std::move(builder1));
-  controller.OnPdu(base_view);
+  ReceivePdu(controller, FirstLeInformationFrameBuilder::Create(0x41, 7, std::move(segment1)));
   auto segment2 = CreateSdu({'e', 'f', 'g'});
-  auto builder2 = BasicFrameBuilder::Create(0x41, std::move(segment2));
-  base_view = GetPacketView(std::move(builder2));
-  EXPECT_CALL(link, SendLeCredit(0x41, 1));
-  controller.OnPdu(base_view);
-  sync_handler(queue_handler_);
-  auto payload = channel_queue.GetUpEnd()->TryDequeue();
-  EXPECT_NE(payload, nullptr);
+  ReceivePdu(controller, BasicFrameBuilder::Create(0x41, std::move(segment2)));
+  auto payload = DequeueSdu(channel_queue.GetUpEnd());
+  ASSERT_NE(payload, nullptr);
   std::string data = std::string(payload->begin(), payload->end());
   EXPECT_EQ(data, "abcdefg");
 }
@@ -179,6 +261,107 @@ TEST_F(LeCreditBasedDataControllerTest, receive_segmented_with_wrong_sdu_length)
   EXPECT_EQ(payload, nullptr);
 }
 
+TEST_F(LeCreditBasedDataControllerTest, return_credits_in_batches) {
+  common::BidiQueue<Scheduler::UpperEnqueue, Scheduler::UpperDequeue> channel_queue{10};
+  testing::MockScheduler scheduler;
+  testing::MockILink link;
+  LeCreditBasedDataController controller{&link, 0x41, 0x41, channel_queue.GetDownEnd(), queue_handler_, &scheduler};
+  controller.SetInitialRxCredits(8);
+  // Nothing is returned until the remote is down to 2 credits
+  EXPECT_CALL(link, SendLeCredit(0x41, 6));
+  for (int i = 0; i < 6; i++) {
+    ReceivePdu(controller, FirstLeInformationFrameBuilder::Create(0x41, 1, CreateSdu({'a'})));
+  }
+  // The credits go back once the last SDU is in the channel queue
+  for (int i = 0; i < 6; i++) {
+    ASSERT_NE(DequeueSdu(channel_queue.GetUpEnd()), nullptr);
+  }
+  auto& statistics = controller.GetStatistics();
+  EXPECT_EQ(statistics.rx_pdus, 6u);
+  EXPECT_EQ(statistics.rx_sdus, 6u);
+  EXPECT_EQ(statistics.rx_bytes, 6u);
+  EXPECT_EQ(statistics.credits_returned, 6u);
+  EXPECT_EQ(statistics.credit_packets_sent, 1u);
+}
+
+TEST_F(LeCreditBasedDataControllerTest, hold_credits_until_user_dequeues) {
+  common::BidiQueue<Scheduler::UpperEnqueue, Scheduler::UpperDequeue> channel_queue{1};
+  testing::MockScheduler scheduler;
+  testing::MockILink link;
+  LeCreditBasedDataController controller{&link, 0x41, 0x41, channel_queue.GetDownEnd(), queue_handler_, &scheduler};
+  controller.SetInitialRxCredits(4);
+  EXPECT_CALL(link, SendLeCredit(0x41, 3));
+  for (int i = 0; i < 3; i++) {
+    ReceivePdu(controller, FirstLeInformationFrameBuilder::Create(0x41, 1, CreateSdu({'a'})));
+  }
+  // The channel queue only has room for one SDU, the user has to take them before the remote may send more
+  EXPECT_EQ(controller.GetStatistics().credit_packets_sent, 0u);
+  for (int i = 0; i < 3; i++) {
+    EXPECT_NE(DequeueSdu(channel_queue.GetUpEnd()), nullptr);
+  }
+  EXPECT_EQ(controller.GetStatistics().credit_packets_sent, 1u);
+}
+
+TEST_F(LeCreditBasedDataControllerTest, loopback_throughput) {
+  constexpr size_t kNumSdus = 20;
+  constexpr size_t kSduSize = 1000;
+  constexpr uint16_t kMps = 251;
+  constexpr uint16_t kInitialCredits = 10;
+  common::BidiQueue<Scheduler::UpperEnqueue, Scheduler::UpperDequeue> sender_queue{10};
+  common::BidiQueue<Scheduler::UpperEnqueue, Scheduler::UpperDequeue> receiver_queue{10};
+  testing::CountingScheduler sender_scheduler;
+  testing::CountingScheduler receiver_scheduler;
+  testing::LoopbackLink sender_link;
+  testing::LoopbackLink receiver_link;
+  LeCreditBasedDataController sender{
+      &sender_link, 0x41, 0x42, sender_queue.GetDownEnd(), queue_handler_, &sender_scheduler};
+  LeCreditBasedDataController receiver{
+      &receiver_link, 0x42, 0x41, receiver_queue.GetDownEnd(), queue_handler_, &receiver_scheduler};
+  receiver_link.peer = &sender;
+  for (auto* controller : {&sender, &receiver}) {
+    controller->SetMtu(kSduSize);
+    controller->SetMps(kMps);
+  }
+  sender.OnCredit(kInitialCredits);
+  receiver.SetInitialRxCredits(kInitialCredits);
+
+  for (size_t i = 0; i < kNumSdus; i++) {
+    sender.OnSdu(CreateSdu(std::vector<uint8_t>(kSduSize, static_cast<uint8_t>(i))));
+  }
+  std::vector<std::unique_ptr<Scheduler::UpperEnqueue>> received;
+  for (size_t round = 0; round < 10 * kNumSdus && received.size() < kNumSdus; round++) {
+    queue_handler_->Post(common::BindOnce(
+        &TransferReadyPdus,
+        common::Unretained(&sender_scheduler),
+        common::Unretained(&sender),
+        common::Unretained(&receiver)));
+    sync_handler(queue_handler_);
+    while (auto sdu = receiver_queue.GetUpEnd()->TryDequeue()) {
+      received.push_back(std::move(sdu));
+    }
+    sync_handler(queue_handler_);
+  }
+
+  ASSERT_EQ(received.size(), kNumSdus);
+  for (size_t i = 0; i < kNumSdus; i++) {
+    EXPECT_EQ(
+        std::vector<uint8_t>(received[i]->begin(), received[i]->end()),
+        std::vector<uint8_t>(kSduSize, static_cast<uint8_t>(i)));
+  }
+  EXPECT_FALSE(receiver_link.disconnected);
+  // 249 bytes in the first PDU of each SDU, then 251 bytes in the others
+  auto& sender_statistics = sender.GetStatistics();
+  EXPECT_EQ(sender_statistics.tx_pdus, kNumSdus * 4u);
+  EXPECT_EQ(sender_statistics.tx_bytes, kNumSdus * kSduSize);
+  auto& receiver_statistics = receiver.GetStatistics();
+  EXPECT_EQ(receiver_statistics.rx_pdus, sender_statistics.tx_pdus);
+  EXPECT_EQ(receiver_statistics.rx_bytes, kNumSdus * kSduSize);
+  // Each credit packet gives back at least three quarters of the initial credits
+  EXPECT_GT(receiver_statistics.credit_packets_sent, 0u);
+  EXPECT_LE(
+      receiver_statistics.credit_packets_sent * (kInitialCredits - kInitialCredits / 4), receiver_statistics.rx_pdus);
+}
+
 }  // namespace
 }  // namespace internal
 }  // namespace l2cap
@@ -0,0 +1,61 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "l2cap/internal/ilink.h"
+#include "l2cap/internal/le_credit_based_channel_data_controller.h"
+#include "l2cap/internal/scheduler.h"
+
+// Fakes for tests and benchmarks that connect two data controllers back to back
+namespace bluetooth {
+namespace l2cap {
+namespace internal {
+namespace testing {
+
+// Link of one side of a loopback channel. With a peer set, the LE credits it returns go straight to the sending side.
+class LoopbackLink : public ILink {
+ public:
+  void SendDisconnectionRequest(Cid local_cid, Cid remote_cid) override {
+    disconnected = true;
+  }
+  hci::AddressWithType GetDevice() const override {
+    return hci::AddressWithType();
+  }
+  void SendLeCredit(Cid local_cid, uint16_t credit) override {
+    if (peer != nullptr) {
+      peer->OnCredit(credit);
+    }
+  }
+
+  LeCreditBasedDataController* peer = nullptr;
+  bool disconnected = false;
+};
+
+// Counts the packets the controller has ready, for the caller to pull with GetNextPacket()
+class CountingScheduler : public Scheduler {
+ public:
+  void OnPacketsReady(Cid cid, int number_packets) override {
+    ready_packets += number_packets;
+  }
+
+  int ready_packets = 0;
+};
+
+}  // namespace testing
+}  // namespace internal
+}  // namespace l2cap
+}  // namespace bluetooth
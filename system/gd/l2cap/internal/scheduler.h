@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <chrono>
 #include <cstdint>
 
 #include "common/bidi_queue.h"
@@ -49,6 +50,31 @@ class Scheduler {
   using LowerDequeue = UpperEnqueue;
   using LowerQueueUpEnd = common::BidiQueueEnd<LowerEnqueue, LowerDequeue>;
 
+  /**
+   * Strict priority classes of channels. A channel is only served when no channel of a higher class has packets to
+   * send.
+   */
+  enum class TxPriorityClass : uint8_t {
+    HIGH = 0,
+    NORMAL = 1,
+    BULK = 2,
+  };
+  static constexpr size_t kNumTxPriorityClasses = 3;
+
+  /**
+   * Queueing statistics of a channel, reported in dumpsys
+   */
+  struct ChannelStatistics {
+    TxPriorityClass priority_class = TxPriorityClass::NORMAL;
+    uint16_t weight = 1;
+    size_t queue_depth = 0;
+    size_t max_queue_depth = 0;
+    uint64_t packets_sent = 0;
+    uint64_t bytes_sent = 0;
+    std::chrono::microseconds total_wait_time{0};
+    std::chrono::microseconds max_wait_time{0};
+  };
+
   /**
    * Callback from the sender to indicate that the scheduler could dequeue number_packets from it
    */
@@ -60,6 +86,23 @@ class Scheduler {
    */
   virtual void SetChannelTxPriority(Cid cid, bool high_priority) {}
 
+  /**
+   * Set the priority class of a channel, and its share of the link relative to the other channels of the same class.
+   * Schedulers without weights only use the priority class.
+   */
+  virtual void SetChannelTxParameters(Cid cid, TxPriorityClass priority_class, uint16_t weight) {
+    SetChannelTxPriority(cid, priority_class == TxPriorityClass::HIGH);
+  }
+
+  /**
+   * Get the queueing statistics of a channel.
+   *
+   * @return false if the channel is unknown or the scheduler doesn't keep statistics
+   */
+  virtual bool GetChannelStatistics(Cid cid, ChannelStatistics* statistics) const {
+    return false;
+  }
+
   /**
    * Called by data controller to indicate that a channel is closed and packets should be dropped
    */
@@ -0,0 +1,136 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <memory>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "l2cap/internal/data_controller.h"
+#include "l2cap/internal/data_pipeline_manager.h"
+#include "l2cap/internal/scheduler_fifo.h"
+#include "l2cap/internal/scheduler_weighted_fair.h"
+#include "os/handler.h"
+#include "os/mock_queue.h"
+#include "os/thread.h"
+#include "packet/raw_builder.h"
+
+using ::benchmark::State;
+
+namespace bluetooth {
+namespace l2cap {
+namespace internal {
+namespace {
+
+constexpr Cid kBulkCid = 0x0040;
+constexpr Cid kControlCid = 0x0041;
+constexpr int kBulkBacklog = 64;
+constexpr size_t kBulkPduSize = 1000;
+constexpr size_t kControlPduSize = 8;
+
+class FakeDataController : public DataController {
+ public:
+  explicit FakeDataController(size_t pdu_size) : pdu_size_(pdu_size) {}
+  void OnSdu(std::unique_ptr<packet::BasePacketBuilder> sdu) override {}
+  void OnPdu(packet::PacketView<true> pdu) override {}
+  std::unique_ptr<packet::BasePacketBuilder> GetNextPacket() override {
+    return std::make_unique<packet::RawBuilder>(std::vector<uint8_t>(pdu_size_));
+  }
+  void EnableFcs(bool enabled) override {}
+  void SetRetransmissionAndFlowControlOptions(const RetransmissionAndFlowControlConfigurationOption& option) override {}
+
+ private:
+  size_t pdu_size_;
+};
+
+class FakeDataPipelineManager : public DataPipelineManager {
+ public:
+  FakeDataPipelineManager(os::Handler* handler, LowerQueueUpEnd* link_queue_up_end)
+      : DataPipelineManager(handler, nullptr, link_queue_up_end) {}
+  DataController* GetDataController(Cid cid) override {
+    return cid == kBulkCid ? &bulk_ : &control_;
+  }
+  void OnPacketSent(Cid cid) override {}
+
+ private:
+  FakeDataController bulk_{kBulkPduSize};
+  FakeDataController control_{kControlPduSize};
+};
+
+// A bulk channel has a backlog of full size PDUs when a control PDU is queued on another channel of the same class.
+// Reports how many bytes the link sends before the control PDU, which is its queueing delay at any link rate.
+template <typename SchedulerType>
+class BM_L2capSchedulerMixedTraffic : public ::benchmark::Fixture {
+ protected:
+  void SetUp(State& st) override {
+    ::benchmark::Fixture::SetUp(st);
+    thread_ = std::make_unique<os::Thread>("scheduler_benchmark", os::Thread::Priority::NORMAL);
+    handler_ = std::make_unique<os::Handler>(thread_.get());
+    data_pipeline_manager_ = std::make_unique<FakeDataPipelineManager>(handler_.get(), &queue_end_);
+    scheduler_ = std::make_unique<SchedulerType>(data_pipeline_manager_.get(), &queue_end_, handler_.get());
+  }
+
+  void TearDown(State& st) override {
+    scheduler_.reset();
+    data_pipeline_manager_.reset();
+    handler_->Clear();
+    handler_.reset();
+    thread_.reset();
+    ::benchmark::Fixture::TearDown(st);
+  }
+
+  void RunMixedTraffic(State& state) {
+    uint64_t bytes_before_control = 0;
+    for (auto _ : state) {
+      scheduler_->OnPacketsReady(kBulkCid, kBulkBacklog);
+      scheduler_->OnPacketsReady(kControlCid, 1);
+      bool control_sent = false;
+      while (enqueue_.registered_handler != nullptr) {
+        enqueue_.run_enqueue();
+        size_t size = enqueue_.enqueued.front()->size();
+        enqueue_.enqueued.pop();
+        if (size == kControlPduSize) {
+          control_sent = true;
+        } else if (!control_sent) {
+          bytes_before_control += size;
+        }
+      }
+    }
+    state.counters["control_delay_bytes"] =
+        ::benchmark::Counter(bytes_before_control, ::benchmark::Counter::kAvgIterations);
+    state.SetItemsProcessed(state.iterations() * (kBulkBacklog + 1));
+  }
+
+  std::unique_ptr<os::Thread> thread_;
+  std::unique_ptr<os::Handler> handler_;
+  os::MockIQueueDequeue<Scheduler::LowerDequeue> dequeue_;
+  os::MockIQueueEnqueue<Scheduler::LowerEnqueue> enqueue_;
+  common::BidiQueueEnd<Scheduler::LowerEnqueue, Scheduler::LowerDequeue> queue_end_{&enqueue_, &dequeue_};
+  std::unique_ptr<FakeDataPipelineManager> data_pipeline_manager_;
+  std::unique_ptr<SchedulerType> scheduler_;
+};
+
+BENCHMARK_TEMPLATE_F(BM_L2capSchedulerMixedTraffic, fifo, Fifo)(State& state) {
+  RunMixedTraffic(state);
+}
+
+BENCHMARK_TEMPLATE_F(BM_L2capSchedulerMixedTraffic, weighted_fair, WeightedFair)(State& state) {
+  RunMixedTraffic(state);
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace l2cap
+}  // namespace bluetooth
@@ -0,0 +1,187 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "l2cap/internal/scheduler_weighted_fair.h"
+
+#include <algorithm>
+
+#include "l2cap/internal/data_pipeline_manager.h"
+#include "os/log.h"
+
+namespace bluetooth {
+namespace l2cap {
+namespace internal {
+
+WeightedFair::WeightedFair(
+    DataPipelineManager* data_pipeline_manager, LowerQueueUpEnd* link_queue_up_end, os::Handler* handler)
+    : data_pipeline_manager_(data_pipeline_manager), link_queue_up_end_(link_queue_up_end), handler_(handler) {
+  ASSERT(link_queue_up_end_ != nullptr && handler_ != nullptr);
+}
+
+// Invoked from some external Handler context
+WeightedFair::~WeightedFair() {
+  try_unregister_link_queue_enqueue();
+}
+
+// Invoked within L2CAP Handler context
+void WeightedFair::OnPacketsReady(Cid cid, int number_packets) {
+  if (number_packets == 0) {
+    return;
+  }
+  Channel& channel = channels_[cid];
+  channel.ready_times.emplace_back(Clock::now(), number_packets);
+  channel.statistics.queue_depth += number_packets;
+  channel.statistics.max_queue_depth = std::max(channel.statistics.max_queue_depth, channel.statistics.queue_depth);
+  if (!channel.active) {
+    activate(cid, channel);
+  }
+  try_register_link_queue_enqueue();
+}
+
+// Invoked within L2CAP Handler context
+void WeightedFair::SetChannelTxPriority(Cid cid, bool high_priority) {
+  auto it = channels_.find(cid);
+  if (it == channels_.end()) {
+    if (!high_priority) {
+      // Also called when the channel is detached, don't bring it back
+      return;
+    }
+    SetChannelTxParameters(cid, TxPriorityClass::HIGH, 1);
+    return;
+  }
+  SetChannelTxParameters(
+      cid, high_priority ? TxPriorityClass::HIGH : TxPriorityClass::NORMAL, it->second.statistics.weight);
+}
+
+// Invoked within L2CAP Handler context
+void WeightedFair::SetChannelTxParameters(Cid cid, TxPriorityClass priority_class, uint16_t weight) {
+  Channel& channel = channels_[cid];
+  auto old_class = channel.statistics.priority_class;
+  if (channel.active && old_class != priority_class) {
+    auto& old_active_channels = active_channels_[static_cast<size_t>(old_class)];
+    old_active_channels.erase(std::find(old_active_channels.begin(), old_active_channels.end(), cid));
+    active_channels_[static_cast<size_t>(priority_class)].push_back(cid);
+  }
+  channel.statistics.priority_class = priority_class;
+  channel.statistics.weight = std::max<uint16_t>(weight, 1);
+}
+
+void WeightedFair::RemoveChannel(Cid cid) {
+  auto it = channels_.find(cid);
+  if (it == channels_.end()) {
+    return;
+  }
+  if (it->second.active) {
+    auto& active_channels = active_channels_[static_cast<size_t>(it->second.statistics.priority_class)];
+    active_channels.erase(std::find(active_channels.begin(), active_channels.end(), cid));
+  }
+  channels_.erase(it);
+  if (!has_pending_packets()) {
+    try_unregister_link_queue_enqueue();
+  }
+}
+
+bool WeightedFair::GetChannelStatistics(Cid cid, ChannelStatistics* statistics) const {
+  auto it = channels_.find(cid);
+  if (it == channels_.end()) {
+    return false;
+  }
+  *statistics = it->second.statistics;
+  return true;
+}
+
+bool WeightedFair::has_pending_packets() const {
+  return std::any_of(active_channels_.begin(), active_channels_.end(), [](const std::deque<Cid>& active_channels) {
+    return !active_channels.empty();
+  });
+}
+
+void WeightedFair::activate(Cid cid, Channel& channel) {
+  channel.active = true;
+  channel.deficit = kQuantumBytes * channel.statistics.weight;
+  active_channels_[static_cast<size_t>(channel.statistics.priority_class)].push_back(cid);
+}
+
+// Pick the channel at the head of the highest priority class that still has some deficit left, moving the others to
+// the back of the round with their quantum added.
+Cid WeightedFair::next_channel() {
+  for (auto& active_channels : active_channels_) {
+    if (active_channels.empty()) {
+      continue;
+    }
+    while (true) {
+      Cid cid = active_channels.front();
+      Channel& channel = channels_.find(cid)->second;
+      if (channel.deficit > 0) {
+        return cid;
+      }
+      channel.deficit += kQuantumBytes * channel.statistics.weight;
+      active_channels.pop_front();
+      active_channels.push_back(cid);
+    }
+  }
+  LOG_ALWAYS_FATAL("No channel has packets to send");
+  return kInvalidCid;
+}
+
+// Invoked from some external Queue Reactable context
+std::unique_ptr<WeightedFair::UpperDequeue> WeightedFair::link_queue_enqueue_callback() {
+  ASSERT(has_pending_packets());
+  Cid cid = next_channel();
+  Channel& channel = channels_.find(cid)->second;
+  auto packet = data_pipeline_manager_->GetDataController(cid)->GetNextPacket();
+
+  auto& ready_time = channel.ready_times.front();
+  auto wait_time = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - ready_time.first);
+  if (--ready_time.second == 0) {
+    channel.ready_times.pop_front();
+  }
+  channel.statistics.queue_depth--;
+  channel.statistics.packets_sent++;
+  channel.statistics.bytes_sent += packet->size();
+  channel.statistics.total_wait_time += wait_time;
+  channel.statistics.max_wait_time = std::max(channel.statistics.max_wait_time, wait_time);
+  channel.deficit -= packet->size();
+  if (channel.statistics.queue_depth == 0) {
+    active_channels_[static_cast<size_t>(channel.statistics.priority_class)].pop_front();
+    channel.active = false;
+    channel.deficit = 0;
+  }
+
+  data_pipeline_manager_->OnPacketSent(cid);
+  if (!has_pending_packets()) {
+    try_unregister_link_queue_enqueue();
+  }
+  return packet;
+}
+
+void WeightedFair::try_register_link_queue_enqueue() {
+  if (link_queue_enqueue_registered_.exchange(true)) {
+    return;
+  }
+  link_queue_up_end_->RegisterEnqueue(
+      handler_, common::Bind(&WeightedFair::link_queue_enqueue_callback, common::Unretained(this)));
+}
+
+void WeightedFair::try_unregister_link_queue_enqueue() {
+  if (link_queue_enqueue_registered_.exchange(false)) {
+    link_queue_up_end_->UnregisterEnqueue();
+  }
+}
+
+}  // namespace internal
+}  // namespace l2cap
+}  // namespace bluetooth
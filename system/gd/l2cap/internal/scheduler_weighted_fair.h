@@ -0,0 +1,87 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <unordered_map>
+#include <utility>
+
+#include "common/bidi_queue.h"
+#include "common/bind.h"
+#include "l2cap/cid.h"
+#include "l2cap/internal/scheduler.h"
+#include "os/handler.h"
+#include "os/queue.h"
+
+namespace bluetooth {
+namespace l2cap {
+namespace internal {
+class DataPipelineManager;
+
+/**
+ * Weighted fair scheduler, as deficit round robin.
+ *
+ * Channels of a higher TxPriorityClass are always served first. Within a class, each channel with packets gets a turn
+ * in round robin, and may send up to kQuantumBytes * weight bytes in that turn, so a bulk channel sending large PDUs
+ * can't hold the link while a control channel of the same class waits behind it.
+ */
+class WeightedFair : public Scheduler {
+ public:
+  // Bytes a channel of weight 1 may send per turn, about one classic ACL packet
+  static constexpr int64_t kQuantumBytes = 1021;
+
+  WeightedFair(DataPipelineManager* data_pipeline_manager, LowerQueueUpEnd* link_queue_up_end, os::Handler* handler);
+  ~WeightedFair();
+  void OnPacketsReady(Cid cid, int number_packets) override;
+  void SetChannelTxPriority(Cid cid, bool high_priority) override;
+  void SetChannelTxParameters(Cid cid, TxPriorityClass priority_class, uint16_t weight) override;
+  void RemoveChannel(Cid cid) override;
+  bool GetChannelStatistics(Cid cid, ChannelStatistics* statistics) const override;
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Channel {
+    ChannelStatistics statistics;
+    int64_t deficit = 0;
+    bool active = false;
+    // When the pending packets became ready, with how many became ready at that time
+    std::deque<std::pair<Clock::time_point, int>> ready_times;
+  };
+
+  DataPipelineManager* data_pipeline_manager_;
+  LowerQueueUpEnd* link_queue_up_end_;
+  os::Handler* handler_;
+  std::unordered_map<Cid, Channel> channels_;
+  // Channels with pending packets, per priority class, in round robin order
+  std::array<std::deque<Cid>, kNumTxPriorityClasses> active_channels_;
+  std::atomic_bool link_queue_enqueue_registered_ = false;
+
+  bool has_pending_packets() const;
+  void activate(Cid cid, Channel& channel);
+  Cid next_channel();
+  void try_register_link_queue_enqueue();
+  void try_unregister_link_queue_enqueue();
+  std::unique_ptr<LowerEnqueue> link_queue_enqueue_callback();
+};
+
+}  // namespace internal
+}  // namespace l2cap
+}  // namespace bluetooth
@@ -0,0 +1,178 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "l2cap/internal/scheduler_weighted_fair.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+
+#include "l2cap/internal/data_controller_mock.h"
+#include "l2cap/internal/data_pipeline_manager_mock.h"
+#include "os/handler.h"
+#include "os/mock_queue.h"
+#include "os/thread.h"
+#include "packet/raw_builder.h"
+
+namespace bluetooth {
+namespace l2cap {
+namespace internal {
+namespace {
+
+using ::testing::_;
+using ::testing::Return;
+
+// A PDU of the given size whose first byte tells which channel sent it
+std::unique_ptr<packet::BasePacketBuilder> CreatePdu(Cid cid, size_t size) {
+  std::vector<uint8_t> payload(size, 0);
+  payload[0] = static_cast<uint8_t>(cid);
+  return std::make_unique<packet::RawBuilder>(std::move(payload));
+}
+
+class MyDataController : public testing::MockDataController {
+ public:
+  std::unique_ptr<BasePacketBuilder> GetNextPacket() override {
+    auto next = std::move(next_packets.front());
+    next_packets.pop();
+    return next;
+  }
+
+  std::queue<std::unique_ptr<BasePacketBuilder>> next_packets;
+};
+
+class L2capSchedulerWeightedFairTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    thread_ = new os::Thread("test_thread", os::Thread::Priority::NORMAL);
+    queue_handler_ = new os::Handler(thread_);
+    mock_data_pipeline_manager_ = new testing::MockDataPipelineManager(queue_handler_, &queue_end_);
+    scheduler_ = new WeightedFair(mock_data_pipeline_manager_, &queue_end_, queue_handler_);
+    EXPECT_CALL(*mock_data_pipeline_manager_, GetDataController(1)).WillRepeatedly(Return(&data_controller_1_));
+    EXPECT_CALL(*mock_data_pipeline_manager_, GetDataController(2)).WillRepeatedly(Return(&data_controller_2_));
+    EXPECT_CALL(*mock_data_pipeline_manager_, OnPacketSent(_)).Times(::testing::AnyNumber());
+  }
+
+  void TearDown() override {
+    delete scheduler_;
+    delete mock_data_pipeline_manager_;
+    queue_handler_->Clear();
+    delete queue_handler_;
+    delete thread_;
+  }
+
+  void QueuePdus(Cid cid, int number_packets, size_t size) {
+    auto& data_controller = cid == 1 ? data_controller_1_ : data_controller_2_;
+    for (int i = 0; i < number_packets; i++) {
+      data_controller.next_packets.push(CreatePdu(cid, size));
+    }
+    scheduler_->OnPacketsReady(cid, number_packets);
+  }
+
+  // Channels of the PDUs sent on the link, in order
+  std::vector<Cid> SentChannels(unsigned number_packets) {
+    enqueue_.run_enqueue(number_packets);
+    std::vector<Cid> channels;
+    while (!enqueue_.enqueued.empty()) {
+      auto bytes = enqueue_.enqueued.front()->SerializeToBytes();
+      channels.push_back(bytes[0]);
+      enqueue_.enqueued.pop();
+    }
+    return channels;
+  }
+
+  os::Thread* thread_ = nullptr;
+  os::Handler* queue_handler_ = nullptr;
+  os::MockIQueueDequeue<Scheduler::LowerDequeue> dequeue_;
+  os::MockIQueueEnqueue<Scheduler::LowerEnqueue> enqueue_;
+  common::BidiQueueEnd<Scheduler::LowerEnqueue, Scheduler::LowerDequeue> queue_end_{&enqueue_, &dequeue_};
+  testing::MockDataPipelineManager* mock_data_pipeline_manager_ = nullptr;
+  MyDataController data_controller_1_;
+  MyDataController data_controller_2_;
+  WeightedFair* scheduler_ = nullptr;
+};
+
+TEST_F(L2capSchedulerWeightedFairTest, send_packet) {
+  QueuePdus(1, 1, 10);
+  ASSERT_EQ(SentChannels(1), std::vector<Cid>({1}));
+  ASSERT_EQ(enqueue_.registered_handler, nullptr);
+}
+
+TEST_F(L2capSchedulerWeightedFairTest, prioritize_channel) {
+  scheduler_->SetChannelTxPriority(1, true);
+  QueuePdus(2, 2, 10);
+  QueuePdus(1, 2, 10);
+  ASSERT_EQ(SentChannels(4), std::vector<Cid>({1, 1, 2, 2}));
+}
+
+TEST_F(L2capSchedulerWeightedFairTest, bulk_class_yields_to_normal) {
+  scheduler_->SetChannelTxParameters(1, Scheduler::TxPriorityClass::BULK, 1);
+  QueuePdus(1, 2, 10);
+  QueuePdus(2, 2, 10);
+  ASSERT_EQ(SentChannels(4), std::vector<Cid>({2, 2, 1, 1}));
+}
+
+TEST_F(L2capSchedulerWeightedFairTest, share_link_by_weight) {
+  scheduler_->SetChannelTxParameters(1, Scheduler::TxPriorityClass::NORMAL, 3);
+  QueuePdus(1, 6, WeightedFair::kQuantumBytes);
+  QueuePdus(2, 2, WeightedFair::kQuantumBytes);
+  ASSERT_EQ(SentChannels(8), std::vector<Cid>({1, 1, 1, 2, 1, 1, 1, 2}));
+}
+
+TEST_F(L2capSchedulerWeightedFairTest, mixed_traffic_latency) {
+  // A bulk transfer has a long backlog of full size PDUs when a control PDU shows up on another channel of the same
+  // class. The control PDU waits for one turn of the bulk channel, not for its whole backlog.
+  QueuePdus(1, 50, 1000);
+  QueuePdus(2, 1, 8);
+  auto sent = SentChannels(51);
+  ASSERT_EQ(sent.size(), 51u);
+  auto control_position = std::find(sent.begin(), sent.end(), 2) - sent.begin();
+  ASSERT_LE(control_position, 2);
+}
+
+TEST_F(L2capSchedulerWeightedFairTest, remove_channel) {
+  QueuePdus(1, 1, 10);
+  QueuePdus(2, 1, 10);
+  scheduler_->RemoveChannel(1);
+  ASSERT_EQ(SentChannels(2), std::vector<Cid>({2}));
+  ASSERT_EQ(enqueue_.registered_handler, nullptr);
+}
+
+TEST_F(L2capSchedulerWeightedFairTest, channel_statistics) {
+  Scheduler::ChannelStatistics statistics;
+  ASSERT_FALSE(scheduler_->GetChannelStatistics(1, &statistics));
+
+  scheduler_->SetChannelTxParameters(1, Scheduler::TxPriorityClass::BULK, 4);
+  QueuePdus(1, 3, 100);
+  SentChannels(2);
+  ASSERT_TRUE(scheduler_->GetChannelStatistics(1, &statistics));
+  ASSERT_EQ(statistics.priority_class, Scheduler::TxPriorityClass::BULK);
+  ASSERT_EQ(statistics.weight, 4);
+  ASSERT_EQ(statistics.queue_depth, 1u);
+  ASSERT_EQ(statistics.max_queue_depth, 3u);
+  ASSERT_EQ(statistics.packets_sent, 2u);
+  ASSERT_EQ(statistics.bytes_sent, 200u);
+  ASSERT_GE(statistics.max_wait_time.count(), 0);
+
+  scheduler_->RemoveChannel(1);
+  scheduler_->SetChannelTxPriority(1, false);
+  ASSERT_FALSE(scheduler_->GetChannelStatistics(1, &statistics));
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace l2cap
+}  // namespace bluetooth
@@ -0,0 +1,44 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "l2cap/internal/sdu_segment_builder.h"
+
+#include "os/log.h"
+
+namespace bluetooth {
+namespace l2cap {
+namespace internal {
+
+SduSegmentBuilder::SduSegmentBuilder(std::shared_ptr<const std::vector<uint8_t>> sdu, size_t offset, size_t size)
+    : sdu_(std::move(sdu)), offset_(offset), size_(size) {
+  ASSERT(sdu_ != nullptr && offset_ + size_ <= sdu_->size());
+}
+
+void SduSegmentBuilder::Serialize(packet::BitInserter& it) const {
+  it.insert_bytes(sdu_->data() + offset_, size_);
+}
+
+size_t SduSegmentBuilder::size() const {
+  return size_;
+}
+
+const std::shared_ptr<const std::vector<uint8_t>>& SduSegmentBuilder::GetSdu() const {
+  return sdu_;
+}
+
+}  // namespace internal
+}  // namespace l2cap
+}  // namespace bluetooth
@@ -0,0 +1,55 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "packet/base_packet_builder.h"
+#include "packet/bit_inserter.h"
+
+namespace bluetooth {
+namespace l2cap {
+namespace internal {
+
+/**
+ * Information payload of one PDU: a slice of an SDU that was serialized once when it was queued.
+ *
+ * Copies share the serialized SDU, so a frame kept for retransmission can be sent again with new headers without
+ * copying or serializing its payload again.
+ */
+class SduSegmentBuilder : public packet::BasePacketBuilder {
+ public:
+  SduSegmentBuilder(std::shared_ptr<const std::vector<uint8_t>> sdu, size_t offset, size_t size);
+
+  void Serialize(packet::BitInserter& it) const override;
+
+  size_t size() const override;
+
+  // The serialized SDU this segment refers to
+  const std::shared_ptr<const std::vector<uint8_t>>& GetSdu() const;
+
+ private:
+  std::shared_ptr<const std::vector<uint8_t>> sdu_;
+  size_t offset_;
+  size_t size_;
+};
+
+}  // namespace internal
+}  // namespace l2cap
+}  // namespace bluetooth
@@ -260,6 +260,7 @@ void LeSignallingManager::on_security_result_for_incoming(Psm psm, PendingConnec
   data_controller->SetMtu(actual_mtu);
   data_controller->SetMps(std::min(request.max_pdu_size, local_mps));
   data_controller->OnCredit(request.initial_credits);
+  data_controller->SetInitialRxCredits(link_->GetInitialCredit());
   auto user_channel = std::make_unique<DynamicChannel>(new_channel, handler_, link_, actual_mtu);
   dynamic_service_manager_->GetService(psm)->NotifyChannelCreation(std::move(user_channel));
 }
@@ -297,6 +298,7 @@ void LeSignallingManager::OnConnectionResponse(SignalId signal_id, Cid remote_ci
   data_controller->SetMtu(actual_mtu);
   data_controller->SetMps(std::min(mps, command_just_sent_.mps_));
   data_controller->OnCredit(initial_credits);
+  data_controller->SetInitialRxCredits(command_just_sent_.credits_);
   std::unique_ptr<DynamicChannel> user_channel =
       std::make_unique<DynamicChannel>(new_channel, handler_, link_, actual_mtu);
   link_->NotifyChannelCreation(new_channel->GetCid(), std::move(user_channel));
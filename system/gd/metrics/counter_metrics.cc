@@ -18,6 +18,7 @@
 #include "metrics/counter_metrics.h"
 
 #include "common/bind.h"
+#include "counter_metrics_generated.h"
 #include "os/log.h"
 #include "os/metrics.h"
 
@@ -58,18 +59,18 @@ bool CounterMetrics::Count(int32_t key, int64_t count) {
     LOG_WARN("count is not larger than 0. count: %s, key: %d", std::to_string(count).c_str(), key);
     return false;
   }
-  int64_t total = 0;
-  std::lock_guard<std::mutex> lock(mutex_);
-  if (counters_.find(key) != counters_.end()) {
-    total = counters_[key];
+  CounterId id = registry_.RegisterCounter(key);
+  if (id == CounterRegistry::kInvalidCounterId) {
+    return false;
   }
+  int64_t total = registry_.Pending(id);
   if (LLONG_MAX - total < count) {
-      LOG_WARN("Counter metric overflows. count %s current total: %s key: %d",
-               std::to_string(count).c_str(), std::to_string(total).c_str(), key);
-      counters_[key] = LLONG_MAX;
-      return false;
+    LOG_WARN("Counter metric overflows. count %s current total: %s key: %d",
+             std::to_string(count).c_str(), std::to_string(total).c_str(), key);
+    registry_.Increment(id, LLONG_MAX - total);
+    return false;
   }
-  counters_[key] = total + count;
+  registry_.Increment(id, count);
   return true;
 }
 
@@ -82,12 +83,36 @@ void CounterMetrics::DrainBufferedCounters() {
     LOG_WARN("Counter metrics isn't initialized");
     return ;
   }
-  std::lock_guard<std::mutex> lock(mutex_);
   LOG_INFO("Draining buffered counters");
-  for (auto const& pair : counters_) {
-    WriteCounter(pair.first, pair.second);
+  registry_.Drain([this](int32_t key, int64_t count) { WriteCounter(key, count); });
+}
+
+DumpsysDataFinisher CounterMetrics::GetDumpsysData(flatbuffers::FlatBufferBuilder* fb_builder) const {
+  ASSERT(fb_builder != nullptr);
+
+  std::vector<flatbuffers::Offset<CounterData>> counter_offsets;
+  for (const auto& counter : registry_.GetCounters()) {
+    counter_offsets.push_back(CreateCounterData(*fb_builder, counter.key, counter.pending, counter.drained));
   }
-  counters_.clear();
+  std::vector<flatbuffers::Offset<HistogramData>> histogram_offsets;
+  for (const auto& histogram : registry_.GetHistograms()) {
+    histogram_offsets.push_back(CreateHistogramDataDirect(
+        *fb_builder, histogram.name.c_str(), histogram.count, histogram.sum, &histogram.buckets));
+  }
+
+  auto title = fb_builder->CreateString("----- Counter Metrics Dumpsys -----");
+  auto counters = fb_builder->CreateVector(counter_offsets);
+  auto histograms = fb_builder->CreateVector(histogram_offsets);
+
+  CounterMetricsDataBuilder builder(*fb_builder);
+  builder.add_title(title);
+  builder.add_counters(counters);
+  builder.add_histograms(histograms);
+  flatbuffers::Offset<CounterMetricsData> dumpsys_data = builder.Finish();
+
+  return [dumpsys_data](DumpsysDataBuilder* dumpsys_builder) {
+    dumpsys_builder->add_counter_metrics_dumpsys_data(dumpsys_data);
+  };
 }
 
 }  // namespace metrics
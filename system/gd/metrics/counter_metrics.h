@@ -15,8 +15,7 @@
  */
 #pragma once
 
-#include <unordered_map>
-
+#include "metrics/counter_registry.h"
 #include "module.h"
 #include "os/repeating_alarm.h"
 
@@ -35,6 +34,7 @@ class CounterMetrics : public bluetooth::Module {
   std::string ToString() const override {
     return std::string("BluetoothCounterMetrics");
   }
+  DumpsysDataFinisher GetDumpsysData(flatbuffers::FlatBufferBuilder* builder) const override;  // Module
   void DrainBufferedCounters();
   virtual void WriteCounter(int32_t key, int64_t count);
   virtual bool IsInitialized() {
@@ -42,8 +42,8 @@ class CounterMetrics : public bluetooth::Module {
   }
 
  private:
-  std::unordered_map<int32_t, int64_t> counters_;
-  mutable std::mutex mutex_;
+  // Counts go to the registry of the process, along with the ones of the hot paths updating it directly
+  CounterRegistry& registry_ = CounterRegistry::Get();
   std::unique_ptr<os::RepeatingAlarm> alarm_;
   bool initialized_ {false};
 };
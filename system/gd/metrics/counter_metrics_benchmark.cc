@@ -0,0 +1,74 @@
+/*
+ * Copyright 2021 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <mutex>
+#include <unordered_map>
+
+#include "benchmark/benchmark.h"
+#include "metrics/counter_registry.h"
+
+using ::benchmark::State;
+using ::bluetooth::metrics::CounterId;
+using ::bluetooth::metrics::CounterRegistry;
+using ::bluetooth::metrics::HistogramId;
+
+namespace {
+
+constexpr int32_t kKey = 1;
+
+// Counters as kept before the registry: a map updated under a single mutex
+class MutexCounters {
+ public:
+  void Count(int32_t key, int64_t count) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    counters_[key] += count;
+  }
+
+ private:
+  std::unordered_map<int32_t, int64_t> counters_;
+  std::mutex mutex_;
+};
+
+MutexCounters mutex_counters;
+CounterRegistry registry;
+
+void BM_MutexCounter(State& state) {
+  for (auto _ : state) {
+    mutex_counters.Count(kKey, 1);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_MutexCounter)->ThreadRange(1, 8)->UseRealTime();
+
+void BM_RegistryCounter(State& state) {
+  CounterId id = registry.RegisterCounter(kKey);
+  for (auto _ : state) {
+    registry.Increment(id);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RegistryCounter)->ThreadRange(1, 8)->UseRealTime();
+
+void BM_RegistryHistogram(State& state) {
+  HistogramId id = registry.RegisterHistogram("latency_us");
+  int64_t value = 0;
+  for (auto _ : state) {
+    registry.Record(id, value++ & 0xfff);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RegistryHistogram)->ThreadRange(1, 8)->UseRealTime();
+
+}  // namespace
@@ -0,0 +1,165 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#define LOG_TAG "BluetoothCounterMetrics"
+
+#include "metrics/counter_registry.h"
+
+#include <algorithm>
+#include <climits>
+
+#include "os/log.h"
+
+namespace bluetooth {
+namespace metrics {
+
+namespace {
+// Keys of the slots no counter is registered to
+constexpr int32_t kEmptyKey = INT32_MIN;
+
+size_t BucketIndex(int64_t value) {
+  if (value < 1) return 0;
+  size_t index = 64 - __builtin_clzll(static_cast<uint64_t>(value));
+  return std::min(index, CounterRegistry::kNumHistogramBuckets - 1);
+}
+}  // namespace
+
+constexpr size_t CounterRegistry::kMaxCounters;
+constexpr size_t CounterRegistry::kMaxHistograms;
+constexpr size_t CounterRegistry::kNumShards;
+constexpr size_t CounterRegistry::kNumHistogramBuckets;
+constexpr CounterId CounterRegistry::kInvalidCounterId;
+constexpr HistogramId CounterRegistry::kInvalidHistogramId;
+
+CounterRegistry::CounterRegistry() : shards_(std::make_unique<Shard[]>(kNumShards)) {
+  for (auto& key : keys_) {
+    key.store(kEmptyKey, std::memory_order_relaxed);
+  }
+}
+
+CounterRegistry& CounterRegistry::Get() {
+  static CounterRegistry* instance = new CounterRegistry();
+  return *instance;
+}
+
+size_t CounterRegistry::ShardIndex() {
+  // Threads take shards in turn the first time they update anything
+  static std::atomic<size_t> next_shard{0};
+  thread_local size_t shard = next_shard.fetch_add(1, std::memory_order_relaxed) % kNumShards;
+  return shard;
+}
+
+CounterId CounterRegistry::RegisterCounter(int32_t key) {
+  if (key == kEmptyKey) {
+    LOG_WARN("Invalid counter key %d", key);
+    return kInvalidCounterId;
+  }
+  // Open addressing, registered keys are never removed
+  size_t start = static_cast<uint32_t>(key) % kMaxCounters;
+  for (size_t i = 0; i < kMaxCounters; i++) {
+    size_t slot = (start + i) % kMaxCounters;
+    int32_t slot_key = keys_[slot].load(std::memory_order_acquire);
+    if (slot_key == kEmptyKey &&
+        keys_[slot].compare_exchange_strong(slot_key, key, std::memory_order_acq_rel, std::memory_order_acquire)) {
+      return slot;
+    }
+    if (slot_key == key) {
+      return slot;
+    }
+  }
+  LOG_WARN("No room left to register counter key %d", key);
+  return kInvalidCounterId;
+}
+
+HistogramId CounterRegistry::RegisterHistogram(const std::string& name) {
+  std::lock_guard<std::mutex> lock(histogram_mutex_);
+  for (size_t id = 0; id < histogram_names_.size(); id++) {
+    if (histogram_names_[id] == name) {
+      return id;
+    }
+  }
+  if (histogram_names_.size() == kMaxHistograms) {
+    LOG_WARN("No room left to register histogram %s", name.c_str());
+    return kInvalidHistogramId;
+  }
+  histogram_names_.push_back(name);
+  return histogram_names_.size() - 1;
+}
+
+void CounterRegistry::Record(HistogramId id, int64_t value) {
+  if (id >= kMaxHistograms) return;
+  Histogram& histogram = GetShard().histograms[id];
+  histogram.count.fetch_add(1, std::memory_order_relaxed);
+  histogram.sum.fetch_add(value, std::memory_order_relaxed);
+  histogram.buckets[BucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+}
+
+int64_t CounterRegistry::Pending(CounterId id) const {
+  if (id >= kMaxCounters) return 0;
+  int64_t total = 0;
+  for (size_t shard = 0; shard < kNumShards; shard++) {
+    total += shards_[shard].counters[id].load(std::memory_order_relaxed);
+  }
+  return total;
+}
+
+void CounterRegistry::Drain(const std::function<void(int32_t key, int64_t count)>& write_counter) {
+  std::lock_guard<std::mutex> lock(drain_mutex_);
+  for (size_t id = 0; id < kMaxCounters; id++) {
+    int32_t key = keys_[id].load(std::memory_order_acquire);
+    if (key == kEmptyKey) continue;
+    // Updates racing with the exchange land either in this drain or in the next one
+    int64_t count = 0;
+    for (size_t shard = 0; shard < kNumShards; shard++) {
+      count += shards_[shard].counters[id].exchange(0, std::memory_order_relaxed);
+    }
+    if (count == 0) continue;
+    drained_[id] = (LLONG_MAX - drained_[id] < count) ? LLONG_MAX : drained_[id] + count;
+    write_counter(key, count);
+  }
+}
+
+std::vector<CounterRegistry::CounterSnapshot> CounterRegistry::GetCounters() const {
+  std::lock_guard<std::mutex> lock(drain_mutex_);
+  std::vector<CounterSnapshot> counters;
+  for (size_t id = 0; id < kMaxCounters; id++) {
+    int32_t key = keys_[id].load(std::memory_order_acquire);
+    if (key == kEmptyKey) continue;
+    counters.push_back({.key = key, .pending = Pending(id), .drained = drained_[id]});
+  }
+  return counters;
+}
+
+std::vector<CounterRegistry::HistogramSnapshot> CounterRegistry::GetHistograms() const {
+  std::lock_guard<std::mutex> lock(histogram_mutex_);
+  std::vector<HistogramSnapshot> histograms;
+  for (size_t id = 0; id < histogram_names_.size(); id++) {
+    HistogramSnapshot snapshot = {
+        .name = histogram_names_[id], .count = 0, .sum = 0, .buckets = std::vector<int64_t>(kNumHistogramBuckets)};
+    for (size_t shard = 0; shard < kNumShards; shard++) {
+      const Histogram& histogram = shards_[shard].histograms[id];
+      snapshot.count += histogram.count.load(std::memory_order_relaxed);
+      snapshot.sum += histogram.sum.load(std::memory_order_relaxed);
+      for (size_t bucket = 0; bucket < kNumHistogramBuckets; bucket++) {
+        snapshot.buckets[bucket] += histogram.buckets[bucket].load(std::memory_order_relaxed);
+      }
+    }
+    histograms.push_back(std::move(snapshot));
+  }
+  return histograms;
+}
+
+}  // namespace metrics
+}  // namespace bluetooth
@@ -0,0 +1,125 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace bluetooth {
+namespace metrics {
+
+using CounterId = size_t;
+using HistogramId = size_t;
+
+/**
+ * Counters and histograms cheap enough to update on hot paths, such as for each HCI packet.
+ *
+ * Each counter or histogram is registered once, which gives it an id to update it with. Updates go to one of a few
+ * shards of atomic slots, picked per thread, so that threads updating the same counter seldom share a cache line.
+ * Neither updates nor reads take a lock: reads sum the shards, and draining exchanges the slots with 0.
+ */
+class CounterRegistry {
+ public:
+  static constexpr size_t kMaxCounters = 256;
+  static constexpr size_t kMaxHistograms = 16;
+  static constexpr size_t kNumShards = 8;
+  // Bucket 0 counts values below 1, bucket i values in [2^(i-1), 2^i), the last bucket is open
+  static constexpr size_t kNumHistogramBuckets = 32;
+  static constexpr CounterId kInvalidCounterId = SIZE_MAX;
+  static constexpr HistogramId kInvalidHistogramId = SIZE_MAX;
+
+  struct CounterSnapshot {
+    int32_t key;
+    // Counted since the last drain
+    int64_t pending;
+    // Reported by all the drains so far
+    int64_t drained;
+  };
+
+  struct HistogramSnapshot {
+    std::string name;
+    int64_t count;
+    int64_t sum;
+    std::vector<int64_t> buckets;
+  };
+
+  CounterRegistry();
+  CounterRegistry(const CounterRegistry&) = delete;
+  CounterRegistry& operator=(const CounterRegistry&) = delete;
+
+  // Registry of the process, drained by CounterMetrics
+  static CounterRegistry& Get();
+
+  // Returns the id of the counter reported under key, registering it on first use. Returns kInvalidCounterId when the
+  // registry is full, updates of which are ignored.
+  CounterId RegisterCounter(int32_t key);
+
+  // Returns the id of the histogram named name, registering it on first use
+  HistogramId RegisterHistogram(const std::string& name);
+
+  void Increment(CounterId id, int64_t value = 1) {
+    if (id >= kMaxCounters) return;
+    GetShard().counters[id].fetch_add(value, std::memory_order_relaxed);
+  }
+
+  // Records a sample, such as a latency in microseconds
+  void Record(HistogramId id, int64_t value);
+
+  // Sum of the counts since the last drain
+  int64_t Pending(CounterId id) const;
+
+  // Resets the counts of each counter, reporting those which counted anything since the last drain
+  void Drain(const std::function<void(int32_t key, int64_t count)>& write_counter);
+
+  std::vector<CounterSnapshot> GetCounters() const;
+  std::vector<HistogramSnapshot> GetHistograms() const;
+
+ private:
+  struct Histogram {
+    std::atomic<int64_t> count;
+    std::atomic<int64_t> sum;
+    std::atomic<int64_t> buckets[kNumHistogramBuckets];
+  };
+
+  // Aligned so that shards never share a cache line
+  struct alignas(64) Shard {
+    std::atomic<int64_t> counters[kMaxCounters];
+    Histogram histograms[kMaxHistograms];
+  };
+
+  Shard& GetShard() {
+    return shards_[ShardIndex()];
+  }
+  static size_t ShardIndex();
+
+  std::unique_ptr<Shard[]> shards_;
+  std::atomic<int32_t> keys_[kMaxCounters];
+
+  mutable std::mutex drain_mutex_;
+  int64_t drained_[kMaxCounters] = {};
+
+  mutable std::mutex histogram_mutex_;
+  std::vector<std::string> histogram_names_;
+};
+
+}  // namespace metrics
+}  // namespace bluetooth
@@ -0,0 +1,120 @@
+/*
+ * Copyright 2021 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "metrics/counter_registry.h"
+
+#include <map>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace bluetooth {
+namespace metrics {
+namespace {
+
+constexpr int kNumThreads = 8;
+constexpr int kIncrementsPerThread = 100000;
+
+class CounterRegistryTest : public ::testing::Test {
+ protected:
+  std::map<int32_t, int64_t> Drain() {
+    std::map<int32_t, int64_t> counters;
+    registry_.Drain([&counters](int32_t key, int64_t count) { counters[key] = count; });
+    return counters;
+  }
+
+  CounterRegistry registry_;
+};
+
+TEST_F(CounterRegistryTest, register_is_idempotent) {
+  CounterId id = registry_.RegisterCounter(42);
+  ASSERT_NE(id, CounterRegistry::kInvalidCounterId);
+  ASSERT_EQ(registry_.RegisterCounter(42), id);
+  ASSERT_NE(registry_.RegisterCounter(42 + CounterRegistry::kMaxCounters), id);
+}
+
+TEST_F(CounterRegistryTest, full_registry_ignores_updates) {
+  for (size_t key = 0; key < CounterRegistry::kMaxCounters; key++) {
+    ASSERT_NE(registry_.RegisterCounter(key), CounterRegistry::kInvalidCounterId);
+  }
+  CounterId id = registry_.RegisterCounter(-1);
+  ASSERT_EQ(id, CounterRegistry::kInvalidCounterId);
+  registry_.Increment(id, 1);
+  ASSERT_EQ(registry_.Pending(id), 0);
+}
+
+TEST_F(CounterRegistryTest, drain_reports_and_resets) {
+  CounterId id_1 = registry_.RegisterCounter(1);
+  CounterId id_2 = registry_.RegisterCounter(2);
+  registry_.RegisterCounter(3);
+  registry_.Increment(id_1, 2);
+  registry_.Increment(id_1, 3);
+  registry_.Increment(id_2);
+
+  ASSERT_EQ(Drain(), (std::map<int32_t, int64_t>{{1, 5}, {2, 1}}));
+  ASSERT_EQ(registry_.Pending(id_1), 0);
+  ASSERT_TRUE(Drain().empty());
+
+  registry_.Increment(id_1, 7);
+  auto counters = registry_.GetCounters();
+  ASSERT_EQ(counters.size(), 3u);
+  for (const auto& counter : counters) {
+    if (counter.key != 1) continue;
+    ASSERT_EQ(counter.pending, 7);
+    ASSERT_EQ(counter.drained, 5);
+  }
+}
+
+TEST_F(CounterRegistryTest, concurrent_increments_and_drains) {
+  CounterId id = registry_.RegisterCounter(1);
+  int64_t drained = 0;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kNumThreads; i++) {
+    threads.emplace_back([this, id]() {
+      for (int j = 0; j < kIncrementsPerThread; j++) registry_.Increment(id);
+    });
+  }
+  for (int i = 0; i < 100; i++) drained += Drain()[1];
+  for (auto& thread : threads) thread.join();
+  drained += Drain()[1];
+
+  // Nothing gets lost to the drains racing with the increments
+  ASSERT_EQ(drained, kNumThreads * kIncrementsPerThread);
+}
+
+TEST_F(CounterRegistryTest, histogram_buckets) {
+  HistogramId id = registry_.RegisterHistogram("latency_us");
+  ASSERT_EQ(registry_.RegisterHistogram("latency_us"), id);
+  registry_.Record(id, 0);
+  registry_.Record(id, 1);
+  registry_.Record(id, 3);
+  registry_.Record(id, 1000);
+  registry_.Record(id, INT64_MAX);
+
+  auto histograms = registry_.GetHistograms();
+  ASSERT_EQ(histograms.size(), 1u);
+  ASSERT_EQ(histograms[0].name, "latency_us");
+  ASSERT_EQ(histograms[0].count, 5);
+  ASSERT_EQ(histograms[0].buckets[0], 1);
+  ASSERT_EQ(histograms[0].buckets[1], 1);
+  ASSERT_EQ(histograms[0].buckets[2], 1);
+  ASSERT_EQ(histograms[0].buckets[10], 1);
+  ASSERT_EQ(histograms[0].buckets[CounterRegistry::kNumHistogramBuckets - 1], 1);
+}
+
+}  // namespace
+}  // namespace metrics
+}  // namespace bluetooth
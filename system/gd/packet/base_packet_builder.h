@@ -38,6 +38,24 @@ class BasePacketBuilder {
   // Write to the vector with the given iterator.
   virtual void Serialize(BitInserter& it) const = 0;
 
+  // Replace the content of the vector with the packet. The capacity of the vector is kept, so
+  // callers sending many packets can reuse one buffer (or take one from a pool) instead of
+  // allocating for each of them. Builders whose packets always have the same size return their
+  // generated kSize from size(), so the reservation doesn't walk the fields.
+  void SerializeInto(std::vector<uint8_t>& bytes) const {
+    bytes.clear();
+    bytes.reserve(size());
+    BitInserter it(bytes);
+    Serialize(it);
+  }
+
+  // Serialize into a new vector, allocated once with the final size of the packet.
+  std::vector<uint8_t> SerializeToBytes() const {
+    std::vector<uint8_t> bytes;
+    SerializeInto(bytes);
+    return bytes;
+  }
+
   void SetFlushable(bool is_flushable) {
     is_flushable_ = is_flushable;
   }
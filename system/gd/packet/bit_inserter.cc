@@ -44,5 +44,15 @@ void BitInserter::insert_byte(uint8_t byte) {
   insert_bits(byte, 8);
 }
 
+void BitInserter::insert_bytes(const uint8_t* bytes, size_t num_bytes) {
+  if (num_saved_bits_ == 0) {
+    ByteInserter::insert_bytes(bytes, num_bytes);
+    return;
+  }
+  for (size_t i = 0; i < num_bytes; i++) {
+    insert_bits(bytes[i], 8);
+  }
+}
+
 }  // namespace packet
 }  // namespace bluetooth
@@ -78,5 +78,24 @@ TEST(BitInserterTest, observerTest) {
   ASSERT_EQ(result.size(), copy.size());
 }
 
+TEST(BitInserterTest, insertBytes) {
+  std::vector<uint8_t> bytes;
+  BitInserter it(bytes);
+  std::vector<uint8_t> copy;
+  it.RegisterObserver(ByteObserver([&copy](uint8_t byte) { copy.push_back(byte); }, []() { return 0; }));
+
+  const uint8_t aligned[] = {0x01, 0x02, 0x03};
+  it.insert_bytes(aligned, sizeof(aligned));
+  it.insert_bits(0b0101, 4);
+  const uint8_t unaligned[] = {0xab, 0xcd};
+  it.insert_bytes(unaligned, sizeof(unaligned));
+  it.insert_bits(0b1010, 4);
+
+  std::vector<uint8_t> result = {0x01, 0x02, 0x03, 0xb5, 0xda, 0xac};
+  ASSERT_EQ(result, bytes);
+  ASSERT_EQ(result, copy);
+  it.UnregisterObserver();
+}
+
 }  // namespace packet
 }  // namespace bluetooth
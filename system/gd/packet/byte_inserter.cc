@@ -48,5 +48,14 @@ void ByteInserter::insert_byte(uint8_t byte) {
   std::back_insert_iterator<std::vector<uint8_t>>::operator=(byte);
 }
 
+void ByteInserter::insert_bytes(const uint8_t* bytes, size_t num_bytes) {
+  if (!registered_observers_.empty()) {
+    for (size_t i = 0; i < num_bytes; i++) {
+      on_byte(bytes[i]);
+    }
+  }
+  container->insert(container->end(), bytes, bytes + num_bytes);
+}
+
 }  // namespace packet
 }  // namespace bluetooth
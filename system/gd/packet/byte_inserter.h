@@ -33,6 +33,9 @@ class ByteInserter : public std::back_insert_iterator<std::vector<uint8_t>> {
 
   virtual void insert_byte(uint8_t byte);
 
+  // Insert num_bytes bytes at once, same as calling insert_byte() for each of them
+  virtual void insert_bytes(const uint8_t* bytes, size_t num_bytes);
+
   void RegisterObserver(const ByteObserver& observer);
 
   ByteObserver UnregisterObserver();
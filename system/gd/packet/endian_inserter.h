@@ -42,13 +42,15 @@ class EndianInserter {
   template <typename FixedWidthPODType, typename std::enable_if<std::is_pod<FixedWidthPODType>::value, int>::type = 0>
   void insert(FixedWidthPODType value, BitInserter& it) const {
     uint8_t* raw_bytes = (uint8_t*)&value;
+    if (little_endian == true) {
+      it.insert_bytes(raw_bytes, sizeof(FixedWidthPODType));
+      return;
+    }
+    uint8_t swapped_bytes[sizeof(FixedWidthPODType)];
     for (size_t i = 0; i < sizeof(FixedWidthPODType); i++) {
-      if (little_endian == true) {
-        it.insert_byte(raw_bytes[i]);
-      } else {
-        it.insert_byte(raw_bytes[sizeof(FixedWidthPODType) - i - 1]);
-      }
+      swapped_bytes[i] = raw_bytes[sizeof(FixedWidthPODType) - i - 1];
     }
+    it.insert_bytes(swapped_bytes, sizeof(FixedWidthPODType));
   }
 
   // Write sizeof(FixedWidthCustomType) bytes using the iterator
@@ -57,13 +59,16 @@ class EndianInserter {
       typename std::enable_if<std::is_base_of<CustomFieldFixedSizeInterface<T>, T>::value, int>::type = 0>
   void insert(const T& value, BitInserter& it) const {
     auto* raw_bytes = value.data();
-    for (size_t i = 0; i < CustomFieldFixedSizeInterface<T>::length(); i++) {
-      if (little_endian == true) {
-        it.insert_byte(raw_bytes[i]);
-      } else {
-        it.insert_byte(raw_bytes[CustomFieldFixedSizeInterface<T>::length() - i - 1]);
-      }
+    constexpr size_t length = CustomFieldFixedSizeInterface<T>::length();
+    if (little_endian == true) {
+      it.insert_bytes(raw_bytes, length);
+      return;
     }
+    uint8_t swapped_bytes[length];
+    for (size_t i = 0; i < length; i++) {
+      swapped_bytes[i] = raw_bytes[length - i - 1];
+    }
+    it.insert_bytes(swapped_bytes, length);
   }
 
   // Write num_bits bits using the iterator
@@ -72,13 +77,16 @@ class EndianInserter {
   void insert(FixedWidthIntegerType value, BitInserter& it, size_t num_bits) const {
     ASSERT(num_bits <= (sizeof(FixedWidthIntegerType) * 8));
 
-    for (size_t i = 0; i < num_bits / 8; i++) {
+    uint8_t bytes[sizeof(FixedWidthIntegerType)];
+    size_t num_bytes = num_bits / 8;
+    for (size_t i = 0; i < num_bytes; i++) {
       if (little_endian == true) {
-        it.insert_byte(static_cast<uint8_t>(value >> (i * 8)));
+        bytes[i] = static_cast<uint8_t>(value >> (i * 8));
       } else {
-        it.insert_byte(static_cast<uint8_t>(value >> (((num_bits / 8) - i - 1) * 8)));
+        bytes[i] = static_cast<uint8_t>(value >> ((num_bytes - i - 1) * 8));
       }
     }
+    it.insert_bytes(bytes, num_bytes);
     if (num_bits % 8) {
       it.insert_bits(static_cast<uint8_t>(value >> ((num_bits / 8) * 8)), num_bits % 8);
     }
@@ -97,6 +105,10 @@ class EndianInserter {
   void insert_vector(const std::vector<FixedWidthIntegerType>& vec, BitInserter& it) const {
     static_assert(std::is_pod<FixedWidthIntegerType>::value,
                   "EndianInserter::insert requires a vector with elements of a fixed-size.");
+    if (sizeof(FixedWidthIntegerType) == 1) {
+      it.insert_bytes(reinterpret_cast<const uint8_t*>(vec.data()), vec.size());
+      return;
+    }
     for (const auto& element : vec) {
       insert(element, it);
     }
@@ -33,6 +33,8 @@ class FragmentingInserter : public BitInserter {
 
   void insert_bits(uint8_t byte, size_t num_bits) override;
 
+  void insert_bytes(const uint8_t* bytes, size_t num_bytes) override;
+
   void finalize();
 
  protected:
@@ -0,0 +1,111 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <array>
+#include <memory>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "hci/hci_packets.h"
+#include "l2cap/l2cap_packets.h"
+#include "packet/bit_inserter.h"
+#include "packet/raw_builder.h"
+#include "security/smp_packets.h"
+
+using ::benchmark::State;
+
+namespace bluetooth {
+namespace packet {
+namespace {
+
+constexpr size_t kAclPayloadSize = 1000;
+
+std::unique_ptr<BasePacketBuilder> MakeCommand() {
+  return hci::ReadRemoteVersionInformationBuilder::Create(0x0001);
+}
+
+std::unique_ptr<BasePacketBuilder> MakeLocalNameCommand() {
+  std::array<uint8_t, 248> name{};
+  name.fill('a');
+  return hci::WriteLocalNameBuilder::Create(name);
+}
+
+std::unique_ptr<BasePacketBuilder> MakeL2capAcl() {
+  std::vector<uint8_t> payload(kAclPayloadSize, 0x5a);
+  auto l2cap = l2cap::BasicFrameBuilder::Create(0x0040, std::make_unique<RawBuilder>(std::move(payload)));
+  return hci::AclBuilder::Create(
+      0x0001,
+      hci::PacketBoundaryFlag::FIRST_AUTOMATICALLY_FLUSHABLE,
+      hci::BroadcastFlag::POINT_TO_POINT,
+      std::move(l2cap));
+}
+
+std::unique_ptr<BasePacketBuilder> MakeSmpRandom() {
+  std::array<uint8_t, 16> random{};
+  return security::PairingRandomBuilder::Create(random);
+}
+
+// How the HCI layer serialized outgoing packets before: no reservation, the
+// vector grows as bytes are appended.
+void BM_SerializeUnreserved(State& state, std::unique_ptr<BasePacketBuilder> (*make_packet)()) {
+  auto packet = make_packet();
+  for (auto _ : state) {
+    std::vector<uint8_t> bytes;
+    BitInserter it(bytes);
+    packet->Serialize(it);
+    benchmark::DoNotOptimize(bytes.data());
+  }
+  state.SetBytesProcessed(state.iterations() * packet->size());
+}
+
+void BM_SerializeToBytes(State& state, std::unique_ptr<BasePacketBuilder> (*make_packet)()) {
+  auto packet = make_packet();
+  for (auto _ : state) {
+    std::vector<uint8_t> bytes = packet->SerializeToBytes();
+    benchmark::DoNotOptimize(bytes.data());
+  }
+  state.SetBytesProcessed(state.iterations() * packet->size());
+}
+
+void BM_SerializeIntoReusedBuffer(State& state, std::unique_ptr<BasePacketBuilder> (*make_packet)()) {
+  auto packet = make_packet();
+  std::vector<uint8_t> bytes;
+  for (auto _ : state) {
+    packet->SerializeInto(bytes);
+    benchmark::DoNotOptimize(bytes.data());
+  }
+  state.SetBytesProcessed(state.iterations() * packet->size());
+}
+
+BENCHMARK_CAPTURE(BM_SerializeUnreserved, hci_command, MakeCommand);
+BENCHMARK_CAPTURE(BM_SerializeToBytes, hci_command, MakeCommand);
+BENCHMARK_CAPTURE(BM_SerializeIntoReusedBuffer, hci_command, MakeCommand);
+
+BENCHMARK_CAPTURE(BM_SerializeUnreserved, hci_local_name, MakeLocalNameCommand);
+BENCHMARK_CAPTURE(BM_SerializeToBytes, hci_local_name, MakeLocalNameCommand);
+BENCHMARK_CAPTURE(BM_SerializeIntoReusedBuffer, hci_local_name, MakeLocalNameCommand);
+
+BENCHMARK_CAPTURE(BM_SerializeUnreserved, l2cap_acl, MakeL2capAcl);
+BENCHMARK_CAPTURE(BM_SerializeToBytes, l2cap_acl, MakeL2capAcl);
+BENCHMARK_CAPTURE(BM_SerializeIntoReusedBuffer, l2cap_acl, MakeL2capAcl);
+
+BENCHMARK_CAPTURE(BM_SerializeUnreserved, smp_random, MakeSmpRandom);
+BENCHMARK_CAPTURE(BM_SerializeToBytes, smp_random, MakeSmpRandom);
+BENCHMARK_CAPTURE(BM_SerializeIntoReusedBuffer, smp_random, MakeSmpRandom);
+
+}  // namespace
+}  // namespace packet
+}  // namespace bluetooth
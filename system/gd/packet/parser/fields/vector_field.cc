@@ -18,6 +18,7 @@
 
 #include "fields/count_field.h"
 #include "fields/custom_field.h"
+#include "fields/scalar_field.h"
 #include "util.h"
 
 const std::string VectorField::kFieldType = "VectorField";
@@ -197,6 +198,10 @@ void VectorField::GenParameterValidator(std::ostream&) const {
 }
 
 void VectorField::GenInserter(std::ostream& s) const {
+  if (element_field_->GetFieldType() == ScalarField::kFieldType && element_field_->GetSize().bits() == 8) {
+    s << "i.insert_bytes(" << GetName() << "_.data(), " << GetName() << "_.size());";
+    return;
+  }
   s << "for (const auto& val_ : " << GetName() << "_) {";
   element_field_->GenInserter(s);
   s << "}\n";
@@ -96,7 +96,7 @@ void PacketDef::GenTestingParserFromBytes(std::ostream& s) const {
   s << "\n#if defined(PACKET_FUZZ_TESTING) || defined(PACKET_TESTING) || defined(FUZZ_TARGET)\n";
 
   s << "static " << name_ << "View FromBytes(std::vector<uint8_t> bytes) {";
-  s << "auto vec = std::make_shared<std::vector<uint8_t>>(bytes);";
+  s << "auto vec = std::make_shared<std::vector<uint8_t>>(std::move(bytes));";
   s << "return " << name_ << "View::Create(";
   auto ancestor_ptr = parent_;
   size_t parent_parens = 0;
@@ -373,7 +373,10 @@ void PacketDef::GenBuilderDefinition(std::ostream& s) const {
   GenSerialize(s);
   s << "\n";
 
-  GenSize(s);
+  GenFixedSize(s);
+  s << "\n";
+
+  GenSize(s, HasFixedSize());
   s << "\n";
 
   s << " protected:\n";
@@ -393,6 +396,27 @@ void PacketDef::GenBuilderDefinition(std::ostream& s) const {
   s << "\n";
 }
 
+bool PacketDef::HasFixedSize() const {
+  if (fields_.HasPayloadOrBody()) {
+    return false;
+  }
+  // GetSize() counts both the padded field and the padding
+  for (const ParentDef* def = this; def != nullptr; def = def->parent_) {
+    if (def->fields_.GetFieldsWithTypes({PaddingField::kFieldType}).size() != 0) {
+      return false;
+    }
+  }
+  Size packet_size = GetSize();
+  return !packet_size.empty() && !packet_size.has_dynamic() && packet_size.bits() % 8 == 0;
+}
+
+void PacketDef::GenFixedSize(std::ostream& s) const {
+  if (!HasFixedSize()) {
+    return;
+  }
+  s << "static constexpr size_t kSize = " << GetSize().bytes() << ";";
+}
+
 void PacketDef::GenTestingFromView(std::ostream& s) const {
   s << "#if defined(PACKET_FUZZ_TESTING) || defined(PACKET_TESTING) || defined(FUZZ_TARGET)\n";
 
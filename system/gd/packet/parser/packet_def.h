@@ -65,6 +65,12 @@ class PacketDef : public ParentDef {
 
   void GenTestingFromView(std::ostream& s) const;
 
+  // True when every packet made by the builder has the same size, whatever the field values.
+  bool HasFixedSize() const;
+
+  // Emit kSize, the size in bytes of every packet made by the builder, when HasFixedSize().
+  void GenFixedSize(std::ostream& s) const;
+
   void GenRustChildEnums(std::ostream& s) const;
 
   void GenRustStructDeclarations(std::ostream& s) const;
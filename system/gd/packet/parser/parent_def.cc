@@ -269,7 +269,7 @@ void ParentDef::GenMembers(std::ostream& s) const {
   }
 }
 
-void ParentDef::GenSize(std::ostream& s) const {
+void ParentDef::GenSize(std::ostream& s, bool fixed_size) const {
   auto header_fields = fields_.GetFieldsBeforePayloadOrBody();
   auto footer_fields = fields_.GetFieldsAfterPayloadOrBody();
 
@@ -338,6 +338,12 @@ void ParentDef::GenSize(std::ostream& s) const {
   }
 
   s << "public:";
+  if (fixed_size) {
+    s << "virtual size_t size() const override {";
+    s << "return kSize;";
+    s << "}\n";
+    return;
+  }
   s << "virtual size_t size() const override {";
   s << "return (BitsOfHeader() / 8)";
   if (fields_.HasPayload()) {
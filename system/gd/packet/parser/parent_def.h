@@ -58,7 +58,8 @@ class ParentDef : public TypeDef {
 
   void GenMembers(std::ostream& s) const;
 
-  void GenSize(std::ostream& s) const;
+  // With fixed_size, size() returns the kSize constant of the class instead of adding up the fields.
+  void GenSize(std::ostream& s, bool fixed_size = false) const;
 
   void GenSerialize(std::ostream& s) const;
 
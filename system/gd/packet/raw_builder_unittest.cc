@@ -108,5 +108,17 @@ TEST(RawBuilderTest, testMaxBytes) {
   ASSERT_EQ(count, packet);
 }
 
+TEST(RawBuilderTest, serializeIntoReusesBuffer) {
+  std::unique_ptr<RawBuilder> count_builder = std::make_unique<RawBuilder>(count);
+  std::vector<uint8_t> packet(2 * count.size(), 0xff);
+  const uint8_t* buffer = packet.data();
+
+  count_builder->SerializeInto(packet);
+
+  ASSERT_EQ(count, packet);
+  ASSERT_EQ(buffer, packet.data());
+  ASSERT_EQ(count, count_builder->SerializeToBytes());
+}
+
 }  // namespace packet
 }  // namespace bluetooth
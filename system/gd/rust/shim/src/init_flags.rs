@@ -11,6 +11,7 @@ mod ffi {
         fn btaa_hci_is_enabled() -> bool;
         fn gd_rust_is_enabled() -> bool;
         fn gd_link_policy_is_enabled() -> bool;
+        fn message_loop_task_queue_is_enabled() -> bool;
     }
 }
 
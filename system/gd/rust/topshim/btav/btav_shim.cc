@@ -48,6 +48,13 @@ class AvrcpMediaInterfaceImpl : public MediaInterface {
       [[maybe_unused]] std::string media_id,
       [[maybe_unused]] FolderItemsCallback folder_cb) override {}
 
+  void GetFolderItemsRange(
+      [[maybe_unused]] uint16_t player_id,
+      [[maybe_unused]] std::string media_id,
+      [[maybe_unused]] uint32_t start_item,
+      [[maybe_unused]] uint32_t end_item,
+      [[maybe_unused]] FolderItemsRangeCallback folder_cb) override {}
+
   void SetBrowsedPlayer(
       [[maybe_unused]] uint16_t player_id, [[maybe_unused]] SetBrowsedPlayerCallback browse_cb) override {}
 
@@ -355,6 +355,26 @@ std::vector<std::string> ConfigCache::GetPersistentSections() const {
   return paired_devices;
 }
 
+std::vector<ConfigCache::SectionAndProperties> ConfigCache::GetPersistentSectionsWithProperties() const {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  auto keystore = os::ParameterProvider::GetBtKeystoreInterface();
+  std::vector<SectionAndProperties> sections;
+  sections.reserve(persistent_devices_.size());
+  for (const auto& section : persistent_devices_) {
+    SectionAndProperties& copy = sections.emplace_back();
+    copy.section = section.first;
+    copy.properties.reserve(section.second.size());
+    for (const auto& property : section.second) {
+      if (keystore != nullptr && property.second == kEncryptedStr) {
+        copy.properties.emplace(property.first, keystore->get_key(section.first + "-" + property.first));
+      } else {
+        copy.properties.emplace(property.first, property.second);
+      }
+    }
+  }
+  return sections;
+}
+
 void ConfigCache::Commit(std::queue<MutationEntry>& mutation_entries) {
   std::lock_guard<std::recursive_mutex> lock(mutex_);
   while (!mutation_entries.empty()) {
@@ -22,6 +22,7 @@
 #include <queue>
 #include <string>
 #include <string_view>
+#include <unordered_map>
 #include <unordered_set>
 #include <utility>
 #include <vector>
@@ -75,6 +76,13 @@ class ConfigCache {
   virtual std::optional<std::string> GetProperty(const std::string& section, const std::string& property) const;
   // Returns a copy of persistent device MAC addresses
   virtual std::vector<std::string> GetPersistentSections() const;
+  // Returns a copy of all persistent sections with their properties, taken under one lock. Encrypted values are read
+  // from the keystore like GetProperty() does
+  struct SectionAndProperties {
+    std::string section;
+    std::unordered_map<std::string, std::string> properties;
+  };
+  virtual std::vector<SectionAndProperties> GetPersistentSectionsWithProperties() const;
   // Return true if a section is persistent
   virtual bool IsPersistentSection(const std::string& section) const;
   // Return true if a section has one of the properties in |property_names|
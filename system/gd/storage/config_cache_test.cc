@@ -217,6 +217,20 @@ TEST(ConfigCacheTest, get_persistent_devices_test) {
   ASSERT_THAT(config.GetPersistentSections(), ElementsAre("AA:BB:CC:DD:EE:FF"));
 }
 
+TEST(ConfigCacheTest, get_persistent_sections_with_properties_test) {
+  ConfigCache config(100, Device::kLinkKeyProperties);
+  config.SetProperty("A", "B", "C");
+  config.SetProperty("AA:BB:CC:DD:EE:FF", "Name", "Temporary");
+  config.SetProperty("CC:DD:EE:FF:00:11", "LinkKey", "AABBAABBCCDDEE");
+  config.SetProperty("CC:DD:EE:FF:00:11", "Name", "Bonded");
+  auto sections = config.GetPersistentSectionsWithProperties();
+  ASSERT_EQ(sections.size(), 1u);
+  ASSERT_EQ(sections[0].section, "CC:DD:EE:FF:00:11");
+  ASSERT_THAT(
+      sections[0].properties,
+      UnorderedElementsAre(Pair("LinkKey", "AABBAABBCCDDEE"), Pair("Name", "Bonded")));
+}
+
 TEST(ConfigCacheTest, appoaching_temporary_config_limit_test) {
   ConfigCache config(2, Device::kLinkKeyProperties);
   for (int i = 0; i < 10; ++i) {
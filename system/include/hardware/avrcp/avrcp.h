@@ -128,6 +128,19 @@ class MediaInterface {
   virtual void GetFolderItems(uint16_t player_id, std::string media_id,
                               FolderItemsCallback folder_cb) = 0;
 
+  // Range query used for paging through large folders. The callback receives
+  // the total number of items in the folder and a contiguous window of items
+  // starting at |first_item|. The window must contain the items from
+  // |start_item| to |end_item| (inclusive) that exist in the folder but may
+  // contain more, so media layers without native paging support can simply
+  // return the whole folder with |first_item| set to 0.
+  using FolderItemsRangeCallback =
+      base::Callback<void(uint32_t total_items, uint32_t first_item,
+                          std::vector<ListItem>)>;
+  virtual void GetFolderItemsRange(uint16_t player_id, std::string media_id,
+                                   uint32_t start_item, uint32_t end_item,
+                                   FolderItemsRangeCallback folder_cb) = 0;
+
   using SetBrowsedPlayerCallback = base::Callback<void(
       bool success, std::string root_id, uint32_t num_items)>;
   virtual void SetBrowsedPlayer(uint16_t player_id,
@@ -1174,6 +1174,16 @@ void DumpsysHid(int fd) {
                   bthh_connection_state_text(p_dev->dev_status).c_str(),
                   (p_dev->ready_for_data) ? ("T") : ("F"),
                   static_cast<int>(p_dev->hh_poll_thread_id));
+      const auto& stats = p_dev->input_stats;
+      LOG_DUMPSYS(fd,
+                  "    input reports:%llu drops:%llu latency_us avg:%llu "
+                  "max:%llu",
+                  (unsigned long long)stats.reports,
+                  (unsigned long long)stats.drops,
+                  (unsigned long long)(stats.reports ? stats.total_latency_us /
+                                                           stats.reports
+                                                     : 0),
+                  (unsigned long long)stats.max_latency_us);
     }
   }
   for (unsigned i = 0; i < BTIF_HH_MAX_ADDED_DEV; i++) {
@@ -34,6 +34,9 @@ void ACL_IgnoreLeConnectionFrom(const tBLE_BD_ADDR& legacy_address_with_type);
 void ACL_Disconnect(uint16_t handle, bool is_classic, tHCI_STATUS reason,
                     std::string comment);
 void ACL_WriteData(uint16_t handle, BT_HDR* p_buf);
+// Same as ACL_WriteData, but |p_buf| is only read: it stays owned by the
+// caller, which may send it again.
+void ACL_WriteSharedData(uint16_t handle, const BT_HDR* p_buf);
 void ACL_ConfigureLePrivacy(bool is_le_privacy_enabled);
 void ACL_Shutdown();
 void ACL_IgnoreAllLeConnections();
@@ -156,6 +156,20 @@ std::vector<std::string> BtifConfigInterface::GetPersistentDevices() {
   return GetStorage()->GetConfigCache()->GetPersistentSections();
 }
 
+std::vector<
+    std::pair<std::string, std::unordered_map<std::string, std::string>>>
+BtifConfigInterface::GetPersistentDevicesWithProperties() {
+  std::vector<
+      std::pair<std::string, std::unordered_map<std::string, std::string>>>
+      devices;
+  for (auto& section :
+       GetStorage()->GetConfigCache()->GetPersistentSectionsWithProperties()) {
+    devices.emplace_back(std::move(section.section),
+                         std::move(section.properties));
+  }
+  return devices;
+}
+
 void BtifConfigInterface::ConvertEncryptOrDecryptKeyIfNeeded() {
   GetStorage()->GetConfigCache()->ConvertEncryptOrDecryptKeyIfNeeded();
 }
@@ -19,6 +19,8 @@
 #include <list>
 #include <optional>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace bluetooth {
@@ -53,6 +55,10 @@ class BtifConfigInterface {
   static bool RemoveProperty(const std::string& section,
                              const std::string& key);
   static std::vector<std::string> GetPersistentDevices();
+  // All persistent devices with every property of their section, in one pass
+  static std::vector<
+      std::pair<std::string, std::unordered_map<std::string, std::string>>>
+  GetPersistentDevicesWithProperties();
   static void ConvertEncryptOrDecryptKeyIfNeeded();
   static void Save();
   static void Flush();
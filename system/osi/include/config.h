@@ -17,31 +17,132 @@
 // - All strings are case sensitive.
 
 #include <stdbool.h>
+#include <atomic>
 #include <list>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 
 // The default section name to use if a key/value pair is not defined within
 // a section.
 #define CONFIG_DEFAULT_SECTION "Global"
 
+// Hash index from the names of the elements of a std::list, |Name| being the
+// member holding the name, to their position in the list. List iterators stay
+// valid until their element is erased and the keys are views of the names
+// stored in the list nodes, so the index only needs updating when elements are
+// added or erased. A copied index cannot point into the copied list: copies
+// start out stale and are rebuilt on their first lookup. That build is
+// serialized, so that lookups through a const config may run concurrently.
+template <typename T, std::string T::*Name>
+class config_index_t {
+ public:
+  using iterator = typename std::list<T>::iterator;
+  using const_iterator = typename std::list<T>::const_iterator;
+
+  config_index_t() = default;
+  config_index_t(const config_index_t&) {}
+  config_index_t(config_index_t&& other) noexcept
+      : index_(std::move(other.index_)), valid_(other.valid_.load()) {
+    other.Reset();
+  }
+  config_index_t& operator=(const config_index_t&) {
+    Reset();
+    return *this;
+  }
+  config_index_t& operator=(config_index_t&& other) noexcept {
+    index_ = std::move(other.index_);
+    valid_ = other.valid_.load();
+    other.Reset();
+    return *this;
+  }
+
+  const_iterator Find(const std::list<T>& list, std::string_view name) const {
+    if (!valid_.load(std::memory_order_acquire)) Rebuild(list);
+    auto it = index_.find(name);
+    return it == index_.end() ? list.end() : it->second;
+  }
+
+  iterator Find(std::list<T>& list, std::string_view name) {
+    const_iterator it = Find(static_cast<const std::list<T>&>(list), name);
+    // Erasing an empty range turns the position into a mutable iterator.
+    return list.erase(it, it);
+  }
+
+  // Must be called after |it| was added to the list.
+  void Add(iterator it) {
+    if (valid_.load(std::memory_order_relaxed)) {
+      index_.emplace((*it).*Name, it);
+    }
+  }
+
+  // Must be called before |it| is erased from the list. If the element's name
+  // no longer leads to it, e.g. because the element was moved from, the index
+  // is rebuilt on the next lookup instead.
+  void Remove(iterator it) {
+    if (!valid_.load(std::memory_order_relaxed)) return;
+    auto found = index_.find((*it).*Name);
+    if (found != index_.end() && found->second == it) {
+      index_.erase(found);
+    } else {
+      Reset();
+    }
+  }
+
+  void Reset() {
+    index_.clear();
+    valid_.store(false, std::memory_order_relaxed);
+  }
+
+ private:
+  void Rebuild(const std::list<T>& list) const {
+    std::lock_guard<std::mutex> lock(rebuild_mutex_);
+    if (valid_.load(std::memory_order_relaxed)) return;
+    index_.clear();
+    index_.reserve(list.size());
+    for (auto it = list.begin(); it != list.end(); ++it) {
+      index_.emplace((*it).*Name, it);
+    }
+    valid_.store(true, std::memory_order_release);
+  }
+
+  mutable std::unordered_map<std::string_view, const_iterator> index_;
+  mutable std::atomic<bool> valid_{false};
+  mutable std::mutex rebuild_mutex_;
+};
+
 struct entry_t {
   std::string key;
   std::string value;
 };
 
+// |entries| and |sections| may be iterated and their elements' values
+// modified directly, but elements must only be added or removed through the
+// methods below so that the lookup indexes stay in sync.
 struct section_t {
   std::string name;
   std::list<entry_t> entries;
   void Set(std::string key, std::string value);
   std::list<entry_t>::iterator Find(const std::string& key);
+  std::list<entry_t>::const_iterator Find(const std::string& key) const;
   bool Has(const std::string& key);
+  std::list<entry_t>::iterator Erase(std::list<entry_t>::iterator entry);
+
+  config_index_t<entry_t, &entry_t::key> index;
 };
 
 struct config_t {
   std::list<section_t> sections;
   std::list<section_t>::iterator Find(const std::string& section);
+  std::list<section_t>::const_iterator Find(const std::string& section) const;
   bool Has(const std::string& section);
+  std::list<section_t>::iterator Add(section_t section);
+  std::list<section_t>::iterator Erase(std::list<section_t>::iterator section);
+  void Clear();
+
+  config_index_t<section_t, &section_t::name> index;
 };
 
 // Creates a new config object with no entries (i.e. not backed by a file).
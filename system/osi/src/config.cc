@@ -28,68 +28,88 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
-#include <sstream>
-#include <type_traits>
+#include <string_view>
 
 #include "check.h"
+#include "osi/include/osi.h"
 
 void section_t::Set(std::string key, std::string value) {
-  for (entry_t& entry : entries) {
-    if (entry.key == key) {
-      entry.value = value;
-      return;
-    }
+  auto entry = Find(key);
+  if (entry != entries.end()) {
+    entry->value = std::move(value);
+    return;
   }
   // add a new key to the section
   entries.emplace_back(
       entry_t{.key = std::move(key), .value = std::move(value)});
+  index.Add(std::prev(entries.end()));
 }
 
 std::list<entry_t>::iterator section_t::Find(const std::string& key) {
-  return std::find_if(
-      entries.begin(), entries.end(),
-      [&key](const entry_t& entry) { return entry.key == key; });
+  return index.Find(entries, key);
+}
+
+std::list<entry_t>::const_iterator section_t::Find(
+    const std::string& key) const {
+  return index.Find(entries, key);
 }
 
 bool section_t::Has(const std::string& key) {
   return Find(key) != entries.end();
 }
 
+std::list<entry_t>::iterator section_t::Erase(
+    std::list<entry_t>::iterator entry) {
+  index.Remove(entry);
+  return entries.erase(entry);
+}
+
 std::list<section_t>::iterator config_t::Find(const std::string& section) {
-  return std::find_if(
-      sections.begin(), sections.end(),
-      [&section](const section_t& sec) { return sec.name == section; });
+  return index.Find(sections, section);
+}
+
+std::list<section_t>::const_iterator config_t::Find(
+    const std::string& section) const {
+  return index.Find(sections, section);
 }
 
 bool config_t::Has(const std::string& key) {
   return Find(key) != sections.end();
 }
 
-static bool config_parse(FILE* fp, config_t* config);
+std::list<section_t>::iterator config_t::Add(section_t section) {
+  sections.emplace_back(std::move(section));
+  auto added = std::prev(sections.end());
+  index.Add(added);
+  return added;
+}
 
-template <typename T,
-          class = typename std::enable_if<std::is_same<
-              config_t, typename std::remove_const<T>::type>::value>>
-static auto section_find(T& config, const std::string& section) {
-  return std::find_if(
-      config.sections.begin(), config.sections.end(),
-      [&section](const section_t& sec) { return sec.name == section; });
+std::list<section_t>::iterator config_t::Erase(
+    std::list<section_t>::iterator section) {
+  index.Remove(section);
+  return sections.erase(section);
 }
 
+void config_t::Clear() {
+  sections.clear();
+  index.Reset();
+}
+
+static bool config_parse(const char* data, size_t size, config_t* config);
+
 static const entry_t* entry_find(const config_t& config,
                                  const std::string& section,
                                  const std::string& key) {
-  auto sec = section_find(config, section);
+  auto sec = config.Find(section);
   if (sec == config.sections.end()) return nullptr;
 
-  for (const entry_t& entry : sec->entries) {
-    if (entry.key == key) return &entry;
-  }
-
-  return nullptr;
+  auto entry = sec->Find(key);
+  if (entry == sec->entries.end()) return nullptr;
+  return &*entry;
 }
 
 std::unique_ptr<config_t> config_new_empty(void) {
@@ -99,20 +119,44 @@ std::unique_ptr<config_t> config_new_empty(void) {
 std::unique_ptr<config_t> config_new(const char* filename) {
   CHECK(filename != nullptr);
 
-  std::unique_ptr<config_t> config = config_new_empty();
-
-  FILE* fp = fopen(filename, "rt");
-  if (!fp) {
+  int fd = open(filename, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
     LOG(ERROR) << __func__ << ": unable to open file '" << filename
                << "': " << strerror(errno);
     return nullptr;
   }
 
-  if (!config_parse(fp, config.get())) {
+  struct stat st;
+  if (fstat(fd, &st) < 0) {
+    LOG(ERROR) << __func__ << ": unable to stat file '" << filename
+               << "': " << strerror(errno);
+    close(fd);
+    return nullptr;
+  }
+
+  std::unique_ptr<config_t> config = config_new_empty();
+  size_t size = st.st_size;
+  if (size == 0) {
+    close(fd);
+    return config;
+  }
+
+  // Parse straight from the page cache instead of copying the file line by
+  // line; the mapping is only needed while parsing.
+  void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    LOG(ERROR) << __func__ << ": unable to map file '" << filename
+               << "': " << strerror(errno);
+    return nullptr;
+  }
+  madvise(data, size, MADV_SEQUENTIAL);
+
+  if (!config_parse(static_cast<const char*>(data), size, config.get())) {
     config.reset();
   }
 
-  fclose(fp);
+  munmap(data, size);
   return config;
 }
 
@@ -130,19 +174,11 @@ std::string checksum_read(const char* filename) {
 }
 
 std::unique_ptr<config_t> config_new_clone(const config_t& src) {
-  std::unique_ptr<config_t> ret = config_new_empty();
-
-  for (const section_t& sec : src.sections) {
-    for (const entry_t& entry : sec.entries) {
-      config_set_string(ret.get(), sec.name, entry.key, entry.value);
-    }
-  }
-
-  return ret;
+  return std::make_unique<config_t>(src);
 }
 
 bool config_has_section(const config_t& config, const std::string& section) {
-  return (section_find(config, section) != config.sections.end());
+  return (config.Find(section) != config.sections.end());
 }
 
 bool config_has_key(const config_t& config, const std::string& section,
@@ -210,56 +246,77 @@ void config_set_string(config_t* config, const std::string& section,
                        const std::string& key, const std::string& value) {
   CHECK(config);
 
-  auto sec = section_find(*config, section);
+  auto sec = config->Find(section);
   if (sec == config->sections.end()) {
-    config->sections.emplace_back(section_t{.name = section});
-    sec = std::prev(config->sections.end());
+    sec = config->Add(section_t{.name = section});
   }
 
-  std::string value_no_newline;
   size_t newline_position = value.find('\n');
   if (newline_position != std::string::npos) {
     android_errorWriteLog(0x534e4554, "70808273");
-    value_no_newline = value.substr(0, newline_position);
+    sec->Set(key, value.substr(0, newline_position));
   } else {
-    value_no_newline = value;
-  }
-
-  for (entry_t& entry : sec->entries) {
-    if (entry.key == key) {
-      entry.value = value_no_newline;
-      return;
-    }
+    sec->Set(key, value);
   }
-
-  sec->entries.emplace_back(entry_t{.key = key, .value = value_no_newline});
 }
 
 bool config_remove_section(config_t* config, const std::string& section) {
   CHECK(config);
 
-  auto sec = section_find(*config, section);
+  auto sec = config->Find(section);
   if (sec == config->sections.end()) return false;
 
-  config->sections.erase(sec);
+  config->Erase(sec);
   return true;
 }
 
 bool config_remove_key(config_t* config, const std::string& section,
                        const std::string& key) {
   CHECK(config);
-  auto sec = section_find(*config, section);
+  auto sec = config->Find(section);
   if (sec == config->sections.end()) return false;
 
-  for (auto entry = sec->entries.begin(); entry != sec->entries.end();
-       ++entry) {
-    if (entry->key == key) {
-      sec->entries.erase(entry);
-      return true;
+  auto entry = sec->Find(key);
+  if (entry == sec->entries.end()) return false;
+
+  sec->Erase(entry);
+  return true;
+}
+
+// Writes |config| to |fd|. The file is serialized into a single buffer sized
+// up front, so that it goes out in as few write() calls as possible without
+// reallocating or going through stream formatting; most values are only a few
+// bytes long, which makes one iovec per key and value slower than copying.
+static bool config_write(int fd, const config_t& config) {
+  size_t size = 0;
+  for (const section_t& section : config.sections) {
+    size += section.name.size() + sizeof("[]\n\n") - 1;
+    for (const entry_t& entry : section.entries) {
+      size += entry.key.size() + entry.value.size() + sizeof(" = \n") - 1;
     }
   }
 
-  return false;
+  std::string serialized;
+  serialized.reserve(size);
+  for (const section_t& section : config.sections) {
+    serialized.append("[").append(section.name).append("]\n");
+    for (const entry_t& entry : section.entries) {
+      serialized.append(entry.key).append(" = ").append(entry.value);
+      serialized.push_back('\n');
+    }
+    serialized.push_back('\n');
+  }
+
+  const char* data = serialized.data();
+  size_t remaining = serialized.size();
+  while (remaining > 0) {
+    ssize_t written;
+    OSI_NO_INTR(written = write(fd, data, remaining));
+    if (written < 0) return false;
+    data += written;
+    remaining -= written;
+  }
+  return true;
 }
 
 bool config_save(const config_t& config, const std::string& filename) {
@@ -268,15 +325,13 @@ bool config_save(const config_t& config, const std::string& filename) {
   // Steps to ensure content of config file gets to disk:
   //
   // 1) Open and write to temp file (e.g. bt_config.conf.new).
-  // 2) Flush the stream buffer to the temp file.
-  // 3) Sync the temp file to disk with fsync().
-  // 4) Rename temp file to actual config file (e.g. bt_config.conf).
+  // 2) Sync the temp file to disk with fsync().
+  // 3) Rename temp file to actual config file (e.g. bt_config.conf).
   //    This ensures atomic update.
-  // 5) Sync directory that has the conf file with fsync().
+  // 4) Sync directory that has the conf file with fsync().
   //    This ensures directory entries are up-to-date.
   int dir_fd = -1;
-  FILE* fp = nullptr;
-  std::stringstream serialized;
+  int fd = -1;
 
   // Build temp config file based on config file (e.g. bt_config.conf.new).
   const std::string temp_filename = filename + ".new";
@@ -296,48 +351,34 @@ bool config_save(const config_t& config, const std::string& filename) {
     goto error;
   }
 
-  fp = fopen(temp_filename.c_str(), "wt");
-  if (!fp) {
+  fd = open(temp_filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+            S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP);
+  if (fd < 0) {
     LOG(ERROR) << __func__ << ": unable to write to file '" << temp_filename
                << "': " << strerror(errno);
     goto error;
   }
 
-  for (const section_t& section : config.sections) {
-    serialized << "[" << section.name << "]" << std::endl;
-
-    for (const entry_t& entry : section.entries)
-      serialized << entry.key << " = " << entry.value << std::endl;
-
-    serialized << std::endl;
-  }
-
-  if (fprintf(fp, "%s", serialized.str().c_str()) < 0) {
+  if (!config_write(fd, config)) {
     LOG(ERROR) << __func__ << ": unable to write to file '" << temp_filename
                << "': " << strerror(errno);
     goto error;
   }
 
-  // Flush the stream buffer to the temp file.
-  if (fflush(fp) < 0) {
-    LOG(ERROR) << __func__ << ": unable to write flush buffer to file '"
-               << temp_filename << "': " << strerror(errno);
-    goto error;
-  }
-
   // Sync written temp file out to disk. fsync() is blocking until data makes it
   // to disk.
-  if (fsync(fileno(fp)) < 0) {
+  if (fsync(fd) < 0) {
     LOG(WARNING) << __func__ << ": unable to fsync file '" << temp_filename
                  << "': " << strerror(errno);
   }
 
-  if (fclose(fp) == EOF) {
+  if (close(fd) < 0) {
     LOG(ERROR) << __func__ << ": unable to close file '" << temp_filename
                << "': " << strerror(errno);
+    fd = -1;
     goto error;
   }
-  fp = nullptr;
+  fd = -1;
 
   // Change the file's permissions to Read/Write by User and Group
   if (chmod(temp_filename.c_str(), S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP) ==
@@ -372,7 +413,7 @@ error:
   // This indicates there is a write issue.  Unlink as partial data is not
   // acceptable.
   unlink(temp_filename.c_str());
-  if (fp) fclose(fp);
+  if (fd != -1) close(fd);
   if (dir_fd != -1) close(dir_fd);
   return false;
 }
@@ -478,53 +519,69 @@ error2:
   return false;
 }
 
-static char* trim(char* str) {
-  while (isspace(*str)) ++str;
-
-  if (!*str) return str;
-
-  char* end_str = str + strlen(str) - 1;
-  while (end_str > str && isspace(*end_str)) --end_str;
-
-  end_str[1] = '\0';
+static std::string_view trim(std::string_view str) {
+  while (!str.empty() && isspace(static_cast<unsigned char>(str.front())))
+    str.remove_prefix(1);
+  while (!str.empty() && isspace(static_cast<unsigned char>(str.back())))
+    str.remove_suffix(1);
   return str;
 }
 
-static bool config_parse(FILE* fp, config_t* config) {
-  CHECK(fp != nullptr);
+static bool config_parse(const char* data, size_t size, config_t* config) {
+  CHECK(data != nullptr);
   CHECK(config != nullptr);
 
   int line_num = 0;
-  char line[4096];
-  char section[4096];
-  strcpy(section, CONFIG_DEFAULT_SECTION);
-
-  while (fgets(line, sizeof(line), fp)) {
-    char* line_ptr = trim(line);
+  std::string_view section = CONFIG_DEFAULT_SECTION;
+  // Section the previous key went to, so that consecutive keys of a section
+  // don't each look it up again. Sections are only created once they get a
+  // key, as empty sections are treated as if they do not exist.
+  section_t* current = nullptr;
+
+  const char* end = data + size;
+  while (data < end) {
+    const char* newline =
+        static_cast<const char*>(memchr(data, '\n', end - data));
+    const char* line_end = newline ? newline : end;
+    std::string_view line(data, line_end - data);
+    data = newline ? newline + 1 : end;
     ++line_num;
 
+    // Anything after a NUL byte is ignored, as it always has been.
+    size_t nul = line.find('\0');
+    if (nul != std::string_view::npos) line = line.substr(0, nul);
+
+    line = trim(line);
+
     // Skip blank and comment lines.
-    if (*line_ptr == '\0' || *line_ptr == '#') continue;
+    if (line.empty() || line.front() == '#') continue;
 
-    if (*line_ptr == '[') {
-      size_t len = strlen(line_ptr);
-      if (line_ptr[len - 1] != ']') {
+    if (line.front() == '[') {
+      if (line.back() != ']') {
         VLOG(1) << __func__ << ": unterminated section name on line "
                 << line_num;
         return false;
       }
-      strncpy(section, line_ptr + 1, len - 2);  // NOLINT (len < 4096)
-      section[len - 2] = '\0';
+      section = line.substr(1, line.size() - 2);
+      current = nullptr;
     } else {
-      char* split = strchr(line_ptr, '=');
-      if (!split) {
+      size_t split = line.find('=');
+      if (split == std::string_view::npos) {
         VLOG(1) << __func__ << ": no key/value separator found on line "
                 << line_num;
         return false;
       }
 
-      *split = '\0';
-      config_set_string(config, section, trim(line_ptr), trim(split + 1));
+      if (current == nullptr) {
+        std::string name(section);
+        auto sec = config->Find(name);
+        if (sec == config->sections.end()) {
+          sec = config->Add(section_t{.name = std::move(name)});
+        }
+        current = &*sec;
+      }
+      current->Set(std::string(trim(line.substr(0, split))),
+                   std::string(trim(line.substr(split + 1))));
     }
   }
   return true;
@@ -0,0 +1,124 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <base/logging.h>
+#include <benchmark/benchmark.h>
+#include <stdio.h>
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "osi/include/config.h"
+
+using ::benchmark::State;
+
+namespace {
+
+// Sections of the generated config; with the keys below they add up to a
+// config of about 2 MB
+#define NUM_SECTIONS 4000
+
+const char* const kKeys[] = {
+    "Name",        "DevClass",    "DevType",     "AddrType",
+    "Service",     "LinkKey",     "LinkKeyType", "PinLength",
+    "LE_KEY_PENC", "LE_KEY_PID",  "LE_KEY_LID",  "Timestamp",
+};
+
+const std::filesystem::path kConfigFile =
+    std::filesystem::temp_directory_path() / "config_benchmark.conf";
+
+std::string SectionName(int i) {
+  char name[18];
+  snprintf(name, sizeof(name), "00:11:22:33:%02x:%02x", (i >> 8) & 0xff,
+           i & 0xff);
+  return name;
+}
+
+std::unique_ptr<config_t> GenerateConfig() {
+  std::unique_ptr<config_t> config = config_new_empty();
+  std::string value(30, 'a');
+  for (int i = 0; i < NUM_SECTIONS; i++) {
+    std::string section = SectionName(i);
+    for (const char* key : kKeys) {
+      config_set_string(config.get(), section, key, value);
+    }
+  }
+  return config;
+}
+
+class BM_Config : public ::benchmark::Fixture {
+ protected:
+  void SetUp(State& st) override {
+    ::benchmark::Fixture::SetUp(st);
+    config_ = GenerateConfig();
+    CHECK(config_save(*config_, kConfigFile));
+  }
+
+  void TearDown(State& st) override {
+    config_.reset();
+    std::filesystem::remove(kConfigFile);
+    ::benchmark::Fixture::TearDown(st);
+  }
+
+  std::unique_ptr<config_t> config_;
+};
+
+BENCHMARK_F(BM_Config, load)(State& state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(config_new(kConfigFile.c_str()));
+  }
+  state.SetBytesProcessed(state.iterations() *
+                          std::filesystem::file_size(kConfigFile));
+}
+
+BENCHMARK_F(BM_Config, lookup)(State& state) {
+  std::vector<std::string> sections;
+  for (int i = 0; i < NUM_SECTIONS; i++) sections.push_back(SectionName(i));
+  for (auto _ : state) {
+    for (const std::string& section : sections) {
+      for (const char* key : kKeys) {
+        benchmark::DoNotOptimize(
+            config_get_string(*config_, section, key, nullptr));
+      }
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * NUM_SECTIONS *
+                          (sizeof(kKeys) / sizeof(kKeys[0])));
+}
+
+BENCHMARK_F(BM_Config, save)(State& state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(config_save(*config_, kConfigFile));
+  }
+  state.SetBytesProcessed(state.iterations() *
+                          std::filesystem::file_size(kConfigFile));
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  // Disable LOG() output from libchrome
+  logging::LoggingSettings log_settings;
+  log_settings.logging_dest = logging::LoggingDestination::LOG_NONE;
+  CHECK(logging::InitLogging(log_settings)) << "Failed to set up logging";
+  ::benchmark::Initialize(&argc, argv);
+  if (::benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  ::benchmark::RunSpecifiedBenchmarks();
+}
@@ -20,6 +20,8 @@
 #include <gtest/gtest.h>
 
 #include <filesystem>
+#include <thread>
+#include <vector>
 
 #include "AllocationTestHarness.h"
 
@@ -134,6 +136,53 @@ TEST_F(ConfigTest, section_set) {
   EXPECT_EQ(entry_iter->value, "bar");
 }
 
+TEST_F(ConfigTest, section_erase) {
+  std::unique_ptr<config_t> config = config_new(CONFIG_FILE);
+  ASSERT_NE(config, nullptr);
+  auto section_iter = config->Find("DID");
+  ASSERT_NE(section_iter, config->sections.end());
+  auto entry_iter = section_iter->Find("version");
+  ASSERT_NE(entry_iter, section_iter->entries.end());
+  section_iter->Erase(entry_iter);
+  EXPECT_FALSE(section_iter->Has("version"));
+  EXPECT_TRUE(section_iter->Has("productId"));
+  section_iter->Set("version", "0x1437");
+  EXPECT_EQ(section_iter->Find("version")->value, "0x1437");
+  config->Erase(section_iter);
+  EXPECT_FALSE(config->Has("DID"));
+  EXPECT_TRUE(config->Has(CONFIG_DEFAULT_SECTION));
+}
+
+TEST_F(ConfigTest, config_copy_has_own_index) {
+  std::unique_ptr<config_t> config = config_new(CONFIG_FILE);
+  ASSERT_NE(config, nullptr);
+  config_t copy = *config;
+  config->Erase(config->Find("DID"));
+  auto section_iter = copy.Find("DID");
+  ASSERT_NE(section_iter, copy.sections.end());
+  EXPECT_EQ(section_iter->Find("version")->value, "0x1436");
+  section_t moved = std::move(*section_iter);
+  copy.Erase(section_iter);
+  EXPECT_FALSE(copy.Has("DID"));
+  EXPECT_TRUE(moved.Has("productId"));
+}
+
+TEST_F(ConfigTest, config_concurrent_const_lookups) {
+  std::unique_ptr<config_t> config = config_new(CONFIG_FILE);
+  ASSERT_NE(config, nullptr);
+  // A copy starts without an index; readers race to build it.
+  const config_t copy = *config;
+  std::vector<std::thread> readers;
+  for (int i = 0; i < 4; i++) {
+    readers.emplace_back([&copy] {
+      EXPECT_TRUE(config_has_section(copy, "DID"));
+      EXPECT_EQ(config_get_int(copy, "DID", "version", 0), 0x1436);
+      EXPECT_FALSE(config_has_key(copy, "DID", "bad key"));
+    });
+  }
+  for (auto& reader : readers) reader.join();
+}
+
 TEST_F(ConfigTest, config_new_empty) {
   std::unique_ptr<config_t> config = config_new_empty();
   EXPECT_TRUE(config.get() != NULL);
@@ -249,6 +298,41 @@ TEST_F(ConfigTest, config_save_basic) {
   EXPECT_TRUE(config_save(*config, CONFIG_FILE));
 }
 
+TEST_F(ConfigTest, config_duplicate_sections_merged) {
+  std::unique_ptr<config_t> config = config_new(CONFIG_FILE);
+  ASSERT_NE(config, nullptr);
+  EXPECT_EQ(config->sections.size(), 2u);
+  EXPECT_EQ(config->sections.front().name, CONFIG_DEFAULT_SECTION);
+  EXPECT_EQ(config_get_int(*config, "DID", "recordNumber", 0), 1);
+  EXPECT_EQ(config_get_int(*config, "DID", "version", 0), 0x1436);
+}
+
+TEST_F(ConfigTest, config_save_round_trip) {
+  std::unique_ptr<config_t> config = config_new(CONFIG_FILE);
+  ASSERT_NE(config, nullptr);
+  config_set_string(config.get(), "New", "key", "value with = sign");
+  config_set_string(config.get(), "New", "empty", "");
+  EXPECT_TRUE(config_remove_key(config.get(), "DID", "productId"));
+  EXPECT_TRUE(config_save(*config, CONFIG_FILE));
+
+  std::unique_ptr<config_t> saved = config_new(CONFIG_FILE);
+  ASSERT_NE(saved, nullptr);
+  ASSERT_EQ(saved->sections.size(), config->sections.size());
+  auto saved_section = saved->sections.begin();
+  for (const section_t& section : config->sections) {
+    EXPECT_EQ(saved_section->name, section.name);
+    ASSERT_EQ(saved_section->entries.size(), section.entries.size());
+    auto saved_entry = saved_section->entries.begin();
+    for (const entry_t& entry : section.entries) {
+      EXPECT_EQ(saved_entry->key, entry.key);
+      EXPECT_EQ(saved_entry->value, entry.value);
+      saved_entry++;
+    }
+    saved_section++;
+  }
+  EXPECT_FALSE(config_has_key(*saved, "DID", "productId"));
+}
+
 TEST_F(ConfigTest, checksum_read) {
   auto tmp_dir = std::filesystem::temp_directory_path();
   auto filename = tmp_dir / "test.checksum";
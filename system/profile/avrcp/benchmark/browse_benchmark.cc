@@ -0,0 +1,169 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <base/bind.h>
+#include <base/logging.h>
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+#include "avrcp_packet.h"
+#include "device.h"
+#include "packet_test_helper.h"
+#include "stack_config.h"
+#include "types/raw_address.h"
+
+using ::benchmark::State;
+
+namespace bluetooth {
+namespace avrcp {
+
+#define LIBRARY_SIZE 50000
+#define BROWSE_MTU 1024
+
+// A media layer with a flat library of songs that answers every request
+// synchronously. Folder requests always return the whole folder, like the
+// Java media layer does.
+class FakeLibraryMediaInterface : public MediaInterface {
+ public:
+  FakeLibraryMediaInterface() {
+    for (int i = 0; i < LIBRARY_SIZE; i++) {
+      SongInfo song;
+      song.media_id = "song_" + std::to_string(i);
+      song.attributes.insert(
+          AttributeEntry(Attribute::TITLE, "Title " + std::to_string(i)));
+      song.attributes.insert(
+          AttributeEntry(Attribute::ARTIST_NAME, "Artist"));
+      song.attributes.insert(
+          AttributeEntry(Attribute::ALBUM_NAME, "Album"));
+      library_.push_back({ListItem::SONG, FolderInfo(), song});
+    }
+  }
+
+  void SendKeyEvent(uint8_t key, KeyState state) override {}
+  void GetSongInfo(SongInfoCallback info_cb) override {}
+  void GetPlayStatus(PlayStatusCallback status_cb) override {}
+  void GetNowPlayingList(NowPlayingCallback now_playing_cb) override {}
+  void GetMediaPlayerList(MediaListCallback list_cb) override {}
+  void GetFolderItems(uint16_t player_id, std::string media_id,
+                      FolderItemsCallback folder_cb) override {
+    folder_fetches_++;
+    folder_cb.Run(library_);
+  }
+  void GetFolderItemsRange(uint16_t player_id, std::string media_id,
+                           uint32_t start_item, uint32_t end_item,
+                           FolderItemsRangeCallback folder_cb) override {
+    folder_fetches_++;
+    folder_cb.Run(library_.size(), 0, library_);
+  }
+  void SetBrowsedPlayer(uint16_t player_id,
+                        SetBrowsedPlayerCallback browse_cb) override {}
+  void PlayItem(uint16_t player_id, bool now_playing,
+                std::string media_id) override {}
+  void SetActiveDevice(const RawAddress& address) override {}
+  void RegisterUpdateCallback(MediaCallbacks* callback) override {}
+  void UnregisterUpdateCallback(MediaCallbacks* callback) override {}
+
+  std::vector<ListItem> library_;
+  int folder_fetches_ = 0;
+};
+
+class FakeA2dpInterface : public A2dpInterface {
+ public:
+  RawAddress active_peer() override { return RawAddress(); }
+  bool is_peer_in_silence_mode(const RawAddress& peer_address) override {
+    return false;
+  }
+};
+
+bool get_pts_avrcp_test(void) { return false; }
+
+const stack_config_t interface = {
+    nullptr, get_pts_avrcp_test, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr};
+
+static std::shared_ptr<BrowsePacket> MakeGetFolderItemsRequest(
+    uint32_t start_item, uint32_t end_item) {
+  auto request = TestPacketType<BrowsePacket>::Make();
+  GetFolderItemsRequestBuilder::MakeBuilder(Scope::VFS, start_item, end_item,
+                                            {})
+      ->Serialize(request);
+  return request;
+}
+
+// Pages through the whole library |state.range(0)| items at a time, the way a
+// head unit fills its browsing list. When |invalidate| is set the UIDs are
+// reported as changed before every page, which forces a full fetch of the
+// folder for every request like the uncached implementation did.
+static void PageThroughLibrary(State& state, bool invalidate) {
+  FakeLibraryMediaInterface media_interface;
+  FakeA2dpInterface a2dp_interface;
+  const uint32_t page_size = state.range(0);
+  int pages = 0;
+
+  for (auto _ : state) {
+    Device device(RawAddress::kAny, true,
+                  base::Bind([](uint8_t, bool,
+                                std::unique_ptr<::bluetooth::PacketBuilder>) {
+                  }),
+                  0xFFFF, BROWSE_MTU);
+    device.RegisterInterfaces(&media_interface, &a2dp_interface, nullptr);
+
+    for (uint32_t start = 0; start < LIBRARY_SIZE; start += page_size) {
+      if (invalidate) device.SendFolderUpdate(false, false, true);
+      device.BrowseMessageReceived(
+          1, MakeGetFolderItemsRequest(start, start + page_size - 1));
+      pages++;
+    }
+  }
+
+  state.counters["pages"] = pages;
+  state.counters["folder_fetches"] = media_interface.folder_fetches_;
+  state.SetItemsProcessed(pages);
+}
+
+static void BM_PageLibraryCached(State& state) {
+  PageThroughLibrary(state, false);
+}
+BENCHMARK(BM_PageLibraryCached)->Arg(10)->Arg(50)->Unit(benchmark::kMillisecond);
+
+static void BM_PageLibraryUncached(State& state) {
+  PageThroughLibrary(state, true);
+}
+BENCHMARK(BM_PageLibraryUncached)
+    ->Arg(50)
+    ->Iterations(1)
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace avrcp
+}  // namespace bluetooth
+
+const stack_config_t* stack_config_get_interface(void) {
+  return &bluetooth::avrcp::interface;
+}
+
+int main(int argc, char** argv) {
+  // Disable LOG() output from libchrome
+  logging::LoggingSettings log_settings;
+  log_settings.logging_dest = logging::LoggingDestination::LOG_NONE;
+  CHECK(logging::InitLogging(log_settings)) << "Failed to set up logging";
+  ::benchmark::Initialize(&argc, argv);
+  if (::benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  ::benchmark::RunSpecifiedBenchmarks();
+}
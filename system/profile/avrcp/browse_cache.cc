@@ -0,0 +1,149 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "browse_cache.h"
+
+#include <algorithm>
+
+namespace bluetooth {
+namespace avrcp {
+
+bool BrowseCache::FolderWindow::Covers(uint32_t start_item,
+                                       uint32_t end_item) const {
+  // Anything past the end of the folder is known not to exist.
+  if (start_item >= total_items) return true;
+
+  uint32_t last_item = std::min(end_item, total_items - 1);
+  return start_item >= first_item && last_item < first_item + items.size();
+}
+
+const BrowseCache::FolderWindow* BrowseCache::GetFolder(
+    uint16_t player_id, const std::string& folder_id) const {
+  auto it = folders_.find(FolderKey(player_id, folder_id));
+  if (it == folders_.end()) return nullptr;
+  return &it->second;
+}
+
+const BrowseCache::FolderWindow& BrowseCache::UpdateFolder(
+    uint16_t player_id, const std::string& folder_id, uint32_t total_items,
+    uint32_t first_item, std::vector<ListItem> items) {
+  FolderKey key(player_id, folder_id);
+  auto it = folders_.find(key);
+
+  if (it == folders_.end()) {
+    if (folders_.size() >= kMaxCachedFolders) {
+      folders_.erase(folder_order_.front());
+      folder_order_.pop_front();
+    }
+    folder_order_.push_back(key);
+    it = folders_.emplace(key, FolderWindow()).first;
+  } else {
+    FolderWindow& window = it->second;
+    uint32_t window_end = window.first_item + window.items.size();
+    uint32_t new_end = first_item + items.size();
+
+    // Extend the cached window if the new items overlap or are adjacent to it.
+    if (window.total_items == total_items && first_item <= window_end &&
+        new_end >= window.first_item) {
+      if (first_item < window.first_item) {
+        window.items.insert(
+            window.items.begin(),
+            std::make_move_iterator(items.begin()),
+            std::make_move_iterator(items.begin() +
+                                    (window.first_item - first_item)));
+        window.first_item = first_item;
+      }
+      if (new_end > window_end) {
+        window.items.insert(
+            window.items.end(),
+            std::make_move_iterator(items.end() - (new_end - window_end)),
+            std::make_move_iterator(items.end()));
+      }
+      return window;
+    }
+  }
+
+  FolderWindow& window = it->second;
+  window.total_items = total_items;
+  window.first_item = first_item;
+  window.items = std::move(items);
+  return window;
+}
+
+void BrowseCache::InvalidateFolders() {
+  folders_.clear();
+  folder_order_.clear();
+}
+
+const BrowseCache::NowPlayingList& BrowseCache::UpdateNowPlaying(
+    std::string curr_song_id, std::vector<SongInfo> songs) {
+  now_playing_.curr_song_id = std::move(curr_song_id);
+  now_playing_.songs = std::move(songs);
+  has_now_playing_ = true;
+  return now_playing_;
+}
+
+void BrowseCache::InvalidateNowPlaying() {
+  has_now_playing_ = false;
+  now_playing_ = NowPlayingList();
+}
+
+const BrowseCache::PlayerList& BrowseCache::UpdatePlayerList(
+    uint16_t curr_player, std::vector<MediaPlayerInfo> players) {
+  player_list_.curr_player = curr_player;
+  player_list_.players = std::move(players);
+  has_player_list_ = true;
+  return player_list_;
+}
+
+void BrowseCache::InvalidatePlayerList() {
+  has_player_list_ = false;
+  player_list_ = PlayerList();
+}
+
+void BrowseCache::IncrementUidCounter() {
+  uid_counter_++;
+  InvalidateFolders();
+  InvalidateNowPlaying();
+}
+
+void BrowseCache::Clear() {
+  InvalidateFolders();
+  InvalidateNowPlaying();
+  InvalidatePlayerList();
+}
+
+std::ostream& operator<<(std::ostream& out, const BrowseCache& c) {
+  out << "Browse Cache: uid_counter=" << c.uid_counter_;
+  if (c.has_player_list_) {
+    out << " players=" << c.player_list_.players.size();
+  }
+  if (c.has_now_playing_) {
+    out << " now_playing=" << c.now_playing_.songs.size();
+  }
+  out << std::endl;
+  for (const auto& key : c.folder_order_) {
+    const auto& window = c.folders_.at(key);
+    out << "  player=" << key.first << " folder=\"" << key.second
+        << "\" items=[" << window.first_item << ", "
+        << window.first_item + window.items.size() << ") of "
+        << window.total_items << std::endl;
+  }
+  return out;
+}
+
+}  // namespace avrcp
+}  // namespace bluetooth
@@ -0,0 +1,124 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <deque>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "hardware/avrcp/avrcp.h"
+
+namespace bluetooth {
+namespace avrcp {
+
+// A per device cache of the lists returned by the media layer while browsing.
+// Remote devices page through folders a handful of items at a time, so without
+// this cache every page would cost a full fetch of the folder from the media
+// layer. Folder entries are keyed by the browsed player and the folder media
+// ID. Folder and now playing entries are dropped whenever the media layer
+// reports a folder or now playing change, and when the UID counter moves on.
+class BrowseCache {
+ public:
+  // The maximum number of folders kept per device. Head units usually only
+  // browse the current folder and its parents, so keep a small working set.
+  static constexpr size_t kMaxCachedFolders = 8;
+
+  // A contiguous window of items from a folder along with the total number of
+  // items in that folder.
+  struct FolderWindow {
+    uint32_t total_items = 0;
+    uint32_t first_item = 0;
+    std::vector<ListItem> items;
+
+    // Returns true if every item of the folder within [start_item, end_item]
+    // is present in this window.
+    bool Covers(uint32_t start_item, uint32_t end_item) const;
+
+    // Returns the item at |index| in the folder. The index must be covered by
+    // the window.
+    const ListItem& At(uint32_t index) const {
+      return items[index - first_item];
+    }
+  };
+
+  struct NowPlayingList {
+    std::string curr_song_id;
+    std::vector<SongInfo> songs;
+  };
+
+  struct PlayerList {
+    uint16_t curr_player = 0;
+    std::vector<MediaPlayerInfo> players;
+  };
+
+  // Returns the cached window for the folder or nullptr if it isn't cached.
+  const FolderWindow* GetFolder(uint16_t player_id,
+                                const std::string& folder_id) const;
+
+  // Merges a window returned by the media layer into the cache and returns the
+  // resulting window. A window that doesn't touch the cached one, or that
+  // reports a different folder size, replaces it.
+  const FolderWindow& UpdateFolder(uint16_t player_id,
+                                   const std::string& folder_id,
+                                   uint32_t total_items, uint32_t first_item,
+                                   std::vector<ListItem> items);
+  void InvalidateFolders();
+
+  const NowPlayingList* GetNowPlaying() const {
+    return has_now_playing_ ? &now_playing_ : nullptr;
+  }
+  const NowPlayingList& UpdateNowPlaying(std::string curr_song_id,
+                                         std::vector<SongInfo> songs);
+  void InvalidateNowPlaying();
+
+  const PlayerList* GetPlayerList() const {
+    return has_player_list_ ? &player_list_ : nullptr;
+  }
+  const PlayerList& UpdatePlayerList(uint16_t curr_player,
+                                     std::vector<MediaPlayerInfo> players);
+  void InvalidatePlayerList();
+
+  // Called when the media layer reports that the UIDs changed. All folder and
+  // now playing entries were fetched under the previous counter so they are
+  // dropped.
+  void IncrementUidCounter();
+  uint16_t GetUidCounter() const { return uid_counter_; }
+
+  void Clear();
+
+  friend std::ostream& operator<<(std::ostream& out, const BrowseCache& c);
+
+ private:
+  using FolderKey = std::pair<uint16_t, std::string>;
+
+  uint16_t uid_counter_ = 0;
+
+  std::map<FolderKey, FolderWindow> folders_;
+  // Insertion order of |folders_| used to evict the oldest folder.
+  std::deque<FolderKey> folder_order_;
+
+  bool has_now_playing_ = false;
+  NowPlayingList now_playing_;
+
+  bool has_player_list_ = false;
+  PlayerList player_list_;
+};
+
+}  // namespace avrcp
+}  // namespace bluetooth
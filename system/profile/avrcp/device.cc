@@ -845,22 +845,41 @@ void Device::HandleGetFolderItems(uint8_t label,
   DEVICE_VLOG(2) << __func__ << ": scope=" << pkt->GetScope();
 
   switch (pkt->GetScope()) {
-    case Scope::MEDIA_PLAYER_LIST:
+    case Scope::MEDIA_PLAYER_LIST: {
+      const auto* list = browse_cache_.GetPlayerList();
+      if (list != nullptr) {
+        SendMediaPlayerListResponse(label, *pkt, *list);
+        break;
+      }
       media_interface_->GetMediaPlayerList(
           base::Bind(&Device::GetMediaPlayerListResponse,
                      weak_ptr_factory_.GetWeakPtr(), label, pkt));
-      break;
-    case Scope::VFS:
-      media_interface_->GetFolderItems(
-          curr_browsed_player_id_, CurrentFolder(),
+    } break;
+    case Scope::VFS: {
+      const auto* window =
+          browse_cache_.GetFolder(curr_browsed_player_id_, CurrentFolder());
+      if (window != nullptr &&
+          window->Covers(pkt->GetStartItem(), pkt->GetEndItem())) {
+        SendVFSListResponse(label, *pkt, *window);
+        break;
+      }
+      media_interface_->GetFolderItemsRange(
+          curr_browsed_player_id_, CurrentFolder(), pkt->GetStartItem(),
+          pkt->GetEndItem(),
           base::Bind(&Device::GetVFSListResponse,
-                     weak_ptr_factory_.GetWeakPtr(), label, pkt));
-      break;
-    case Scope::NOW_PLAYING:
+                     weak_ptr_factory_.GetWeakPtr(), label, pkt,
+                     curr_browsed_player_id_, CurrentFolder()));
+    } break;
+    case Scope::NOW_PLAYING: {
+      const auto* list = browse_cache_.GetNowPlaying();
+      if (list != nullptr) {
+        SendNowPlayingListResponse(label, *pkt, *list);
+        break;
+      }
       media_interface_->GetNowPlayingList(
           base::Bind(&Device::GetNowPlayingListResponse,
                      weak_ptr_factory_.GetWeakPtr(), label, pkt));
-      break;
+    } break;
     default:
       DEVICE_LOG(ERROR) << __func__ << ": " << pkt->GetScope();
       auto response = GetFolderItemsResponseBuilder::MakePlayerListBuilder(Status::INVALID_PARAMETER, 0, browse_mtu_);
@@ -880,24 +899,49 @@ void Device::HandleGetTotalNumberOfItems(
 
   DEVICE_VLOG(2) << __func__ << ": scope=" << pkt->GetScope();
 
+  // The item count is answered from the browse cache whenever possible so the
+  // remote can size its list without the media layer materializing it.
   switch (pkt->GetScope()) {
     case Scope::MEDIA_PLAYER_LIST: {
+      const auto* list = browse_cache_.GetPlayerList();
+      if (list != nullptr) {
+        auto builder = GetTotalNumberOfItemsResponseBuilder::MakeBuilder(
+            Status::NO_ERROR, 0x0000, list->players.size());
+        send_message(label, true, std::move(builder));
+        break;
+      }
       media_interface_->GetMediaPlayerList(
           base::Bind(&Device::GetTotalNumberOfItemsMediaPlayersResponse,
                      weak_ptr_factory_.GetWeakPtr(), label));
       break;
     }
-    case Scope::VFS:
-      media_interface_->GetFolderItems(
-          curr_browsed_player_id_, CurrentFolder(),
+    case Scope::VFS: {
+      const auto* window =
+          browse_cache_.GetFolder(curr_browsed_player_id_, CurrentFolder());
+      if (window != nullptr) {
+        auto builder = GetTotalNumberOfItemsResponseBuilder::MakeBuilder(
+            Status::NO_ERROR, 0x0000, window->total_items);
+        send_message(label, true, std::move(builder));
+        break;
+      }
+      media_interface_->GetFolderItemsRange(
+          curr_browsed_player_id_, CurrentFolder(), 0, 0,
           base::Bind(&Device::GetTotalNumberOfItemsVFSResponse,
-                     weak_ptr_factory_.GetWeakPtr(), label));
-      break;
-    case Scope::NOW_PLAYING:
+                     weak_ptr_factory_.GetWeakPtr(), label,
+                     curr_browsed_player_id_, CurrentFolder()));
+    } break;
+    case Scope::NOW_PLAYING: {
+      const auto* list = browse_cache_.GetNowPlaying();
+      if (list != nullptr) {
+        auto builder = GetTotalNumberOfItemsResponseBuilder::MakeBuilder(
+            Status::NO_ERROR, 0x0000, list->songs.size());
+        send_message(label, true, std::move(builder));
+        break;
+      }
       media_interface_->GetNowPlayingList(
           base::Bind(&Device::GetTotalNumberOfItemsNowPlayingResponse,
                      weak_ptr_factory_.GetWeakPtr(), label));
-      break;
+    } break;
     default:
       DEVICE_LOG(ERROR) << __func__ << ": " << pkt->GetScope();
       break;
@@ -914,11 +958,18 @@ void Device::GetTotalNumberOfItemsMediaPlayersResponse(
 }
 
 void Device::GetTotalNumberOfItemsVFSResponse(uint8_t label,
+                                              uint16_t player_id,
+                                              std::string folder_id,
+                                              uint32_t total_items,
+                                              uint32_t first_item,
                                               std::vector<ListItem> list) {
-  DEVICE_VLOG(2) << __func__ << ": num_items=" << list.size();
+  DEVICE_VLOG(2) << __func__ << ": num_items=" << total_items;
+
+  CacheFolderItems(player_id, folder_id, total_items, first_item,
+                   std::move(list));
 
   auto builder = GetTotalNumberOfItemsResponseBuilder::MakeBuilder(
-      Status::NO_ERROR, 0x0000, list.size());
+      Status::NO_ERROR, 0x0000, total_items);
   send_message(label, true, std::move(builder));
 }
 
@@ -972,19 +1023,31 @@ void Device::HandleChangePath(uint8_t label,
                    << "\"";
   }
 
-  media_interface_->GetFolderItems(
-      curr_browsed_player_id_, CurrentFolder(),
+  const auto* window =
+      browse_cache_.GetFolder(curr_browsed_player_id_, CurrentFolder());
+  if (window != nullptr) {
+    auto builder = ChangePathResponseBuilder::MakeBuilder(Status::NO_ERROR,
+                                                          window->total_items);
+    send_message(label, true, std::move(builder));
+    return;
+  }
+
+  media_interface_->GetFolderItemsRange(
+      curr_browsed_player_id_, CurrentFolder(), 0, 0,
       base::Bind(&Device::ChangePathResponse, weak_ptr_factory_.GetWeakPtr(),
-                 label, pkt));
+                 label, pkt, curr_browsed_player_id_, CurrentFolder()));
 }
 
 void Device::ChangePathResponse(uint8_t label,
                                 std::shared_ptr<ChangePathRequest> pkt,
+                                uint16_t player_id, std::string folder_id,
+                                uint32_t total_items, uint32_t first_item,
                                 std::vector<ListItem> list) {
-  // TODO (apanicke): Reconstruct the VFS ID's here. Right now it gets
-  // reconstructed in GetFolderItemsVFS
+  CacheFolderItems(player_id, folder_id, total_items, first_item,
+                   std::move(list));
+
   auto builder =
-      ChangePathResponseBuilder::MakeBuilder(Status::NO_ERROR, list.size());
+      ChangePathResponseBuilder::MakeBuilder(Status::NO_ERROR, total_items);
   send_message(label, true, std::move(builder));
 }
 
@@ -1151,15 +1214,6 @@ void Device::GetMediaPlayerListResponse(
     uint16_t curr_player, std::vector<MediaPlayerInfo> players) {
   DEVICE_VLOG(2) << __func__;
 
-  if (players.size() == 0) {
-    auto no_items_rsp = GetFolderItemsResponseBuilder::MakePlayerListBuilder(
-        Status::RANGE_OUT_OF_BOUNDS, 0x0000, browse_mtu_);
-    send_message(label, true, std::move(no_items_rsp));
-  }
-
-  auto builder = GetFolderItemsResponseBuilder::MakePlayerListBuilder(
-      Status::NO_ERROR, 0x0000, browse_mtu_);
-
   // Move the current player to the first slot due to some carkits always
   // connecting to the first listed player rather than using the ID
   // returned by Addressed Player Changed
@@ -1173,11 +1227,29 @@ void Device::GetMediaPlayerListResponse(
     }
   }
 
-  for (size_t i = pkt->GetStartItem();
-       i <= pkt->GetEndItem() && i < players.size(); i++) {
+  const auto& list =
+      browse_cache_.UpdatePlayerList(curr_player, std::move(players));
+  SendMediaPlayerListResponse(label, *pkt, list);
+}
+
+void Device::SendMediaPlayerListResponse(uint8_t label,
+                                         const GetFolderItemsRequest& pkt,
+                                         const BrowseCache::PlayerList& list) {
+  const auto& players = list.players;
+  if (players.size() == 0) {
+    auto no_items_rsp = GetFolderItemsResponseBuilder::MakePlayerListBuilder(
+        Status::RANGE_OUT_OF_BOUNDS, 0x0000, browse_mtu_);
+    send_message(label, true, std::move(no_items_rsp));
+  }
+
+  auto builder = GetFolderItemsResponseBuilder::MakePlayerListBuilder(
+      Status::NO_ERROR, 0x0000, browse_mtu_);
+
+  for (size_t i = pkt.GetStartItem();
+       i <= pkt.GetEndItem() && i < players.size(); i++) {
     MediaPlayerItem item(players[i].id, players[i].name,
                          players[i].browsing_supported);
-    builder->AddMediaPlayer(item);
+    if (!builder->AddMediaPlayer(item)) break;
   }
 
   send_message(label, true, std::move(builder));
@@ -1195,16 +1267,13 @@ std::set<AttributeEntry> filter_attributes_requested(
   return result;
 }
 
-void Device::GetVFSListResponse(uint8_t label,
-                                std::shared_ptr<GetFolderItemsRequest> pkt,
-                                std::vector<ListItem> items) {
-  DEVICE_VLOG(2) << __func__ << ": start_item=" << pkt->GetStartItem()
-                 << " end_item=" << pkt->GetEndItem();
-
-  // The builder will automatically correct the status if there are zero items
-  auto builder = GetFolderItemsResponseBuilder::MakeVFSBuilder(
-      Status::NO_ERROR, 0x0000, browse_mtu_);
-
+const BrowseCache::FolderWindow& Device::CacheFolderItems(
+    uint16_t player_id, const std::string& folder_id, uint32_t total_items,
+    uint32_t first_item, std::vector<ListItem> items) {
+  // Add the elements retrieved from the media layer and map them to UIDs.
+  // These items do not need to correspond with the now playing list as the
+  // UID's only need to be unique in the context of the current scope and the
+  // current folder. Items already in the cache keep the UIDs they were given.
   // TODO (apanicke): Add test that checks if vfs_ids_ is the correct size after
   // an operation.
   for (const auto& item : items) {
@@ -1215,21 +1284,53 @@ void Device::GetVFSListResponse(uint8_t label,
     }
   }
 
-  // Add the elements retrieved in the last get folder items request and map
-  // them to UIDs The maps will be cleared every time a directory change
-  // happens. These items do not need to correspond with the now playing list as
-  // the UID's only need to be unique in the context of the current scope and
-  // the current folder
-  for (auto i = pkt->GetStartItem(); i <= pkt->GetEndItem() && i < items.size();
-       i++) {
-    if (items[i].type == ListItem::FOLDER) {
-      auto folder = items[i].folder;
+  return browse_cache_.UpdateFolder(player_id, folder_id, total_items,
+                                    first_item, std::move(items));
+}
+
+void Device::GetVFSListResponse(uint8_t label,
+                                std::shared_ptr<GetFolderItemsRequest> pkt,
+                                uint16_t player_id, std::string folder_id,
+                                uint32_t total_items, uint32_t first_item,
+                                std::vector<ListItem> items) {
+  DEVICE_VLOG(2) << __func__ << ": start_item=" << pkt->GetStartItem()
+                 << " end_item=" << pkt->GetEndItem()
+                 << " total_items=" << total_items;
+
+  const auto& window = CacheFolderItems(player_id, folder_id, total_items,
+                                        first_item, std::move(items));
+  if (!window.Covers(pkt->GetStartItem(), pkt->GetEndItem())) {
+    DEVICE_LOG(ERROR) << __func__ << ": Media layer returned items ["
+                      << window.first_item << ", "
+                      << window.first_item + window.items.size()
+                      << ") which don't cover the request";
+    auto builder = GetFolderItemsResponseBuilder::MakeVFSBuilder(
+        Status::INTERNAL_ERROR, 0x0000, browse_mtu_);
+    send_message(label, true, std::move(builder));
+    return;
+  }
+
+  SendVFSListResponse(label, *pkt, window);
+}
+
+void Device::SendVFSListResponse(uint8_t label,
+                                 const GetFolderItemsRequest& pkt,
+                                 const BrowseCache::FolderWindow& window) {
+  // The builder will automatically correct the status if there are zero items
+  auto builder = GetFolderItemsResponseBuilder::MakeVFSBuilder(
+      Status::NO_ERROR, 0x0000, browse_mtu_);
+
+  for (auto i = pkt.GetStartItem();
+       i <= pkt.GetEndItem() && i < window.total_items; i++) {
+    const auto& list_item = window.At(i);
+    if (list_item.type == ListItem::FOLDER) {
+      const auto& folder = list_item.folder;
       // right now we always use folders of mixed type
       FolderItem folder_item(vfs_ids_.get_uid(folder.media_id), 0x00,
                              folder.is_playable, folder.name);
       if (!builder->AddFolder(folder_item)) break;
-    } else if (items[i].type == ListItem::SONG) {
-      auto song = items[i].song;
+    } else if (list_item.type == ListItem::SONG) {
+      auto song = list_item.song;
 
       // Filter out DEFAULT_COVER_ART handle if this device has no client
       if (!HasBipClient()) {
@@ -1243,11 +1344,11 @@ void Device::GetVFSListResponse(uint8_t label,
       MediaElementItem song_item(vfs_ids_.get_uid(song.media_id), title,
                                  std::set<AttributeEntry>());
 
-      if (pkt->GetNumAttributes() == 0x00) {  // All attributes requested
+      if (pkt.GetNumAttributes() == 0x00) {  // All attributes requested
         song_item.attributes_ = std::move(song.attributes);
       } else {
         song_item.attributes_ =
-            filter_attributes_requested(song, pkt->GetAttributesRequested());
+            filter_attributes_requested(song, pkt.GetAttributesRequested());
       }
 
       // If we fail to add a song, don't accidentally add one later that might
@@ -1261,18 +1362,28 @@ void Device::GetVFSListResponse(uint8_t label,
 
 void Device::GetNowPlayingListResponse(
     uint8_t label, std::shared_ptr<GetFolderItemsRequest> pkt,
-    std::string /* unused curr_song_id */, std::vector<SongInfo> song_list) {
+    std::string curr_song_id, std::vector<SongInfo> song_list) {
   DEVICE_VLOG(2) << __func__;
-  auto builder = GetFolderItemsResponseBuilder::MakeNowPlayingBuilder(
-      Status::NO_ERROR, 0x0000, browse_mtu_);
 
   now_playing_ids_.clear();
   for (const SongInfo& song : song_list) {
     now_playing_ids_.insert(song.media_id);
   }
 
-  for (size_t i = pkt->GetStartItem();
-       i <= pkt->GetEndItem() && i < song_list.size(); i++) {
+  const auto& list =
+      browse_cache_.UpdateNowPlaying(curr_song_id, std::move(song_list));
+  SendNowPlayingListResponse(label, *pkt, list);
+}
+
+void Device::SendNowPlayingListResponse(
+    uint8_t label, const GetFolderItemsRequest& pkt,
+    const BrowseCache::NowPlayingList& list) {
+  auto builder = GetFolderItemsResponseBuilder::MakeNowPlayingBuilder(
+      Status::NO_ERROR, 0x0000, browse_mtu_);
+
+  const auto& song_list = list.songs;
+  for (size_t i = pkt.GetStartItem();
+       i <= pkt.GetEndItem() && i < song_list.size(); i++) {
     auto song = song_list[i];
 
     // Filter out DEFAULT_COVER_ART handle if this device has no client
@@ -1285,11 +1396,11 @@ void Device::GetNowPlayingListResponse(
                      : "No Song Info";
 
     MediaElementItem item(i + 1, title, std::set<AttributeEntry>());
-    if (pkt->GetNumAttributes() == 0x00) {
+    if (pkt.GetNumAttributes() == 0x00) {
       item.attributes_ = std::move(song.attributes);
     } else {
       item.attributes_ =
-          filter_attributes_requested(song, pkt->GetAttributesRequested());
+          filter_attributes_requested(song, pkt.GetAttributesRequested());
     }
 
     // If we fail to add a song, don't accidentally add one later that might
@@ -1339,6 +1450,10 @@ void Device::SetBrowsedPlayerResponse(
 
   curr_browsed_player_id_ = pkt->GetPlayerId();
 
+  // The media layer may have reloaded the player's content while switching.
+  browse_cache_.InvalidateFolders();
+  browse_cache_.InvalidateNowPlaying();
+
   // Clear the path and push the new root.
   current_path_ = std::stack<std::string>();
   current_path_.push(root_id);
@@ -1357,6 +1472,8 @@ void Device::SendMediaUpdate(bool metadata, bool play_status, bool queue) {
                  << " ; is_silence=" << is_silence;
 
   if (queue) {
+    browse_cache_.InvalidateFolders();
+    browse_cache_.InvalidateNowPlaying();
     HandleNowPlayingUpdate();
   }
 
@@ -1375,6 +1492,21 @@ void Device::SendFolderUpdate(bool available_players, bool addressed_player,
   CHECK(media_interface_);
   DEVICE_VLOG(4) << __func__;
 
+  // The player list is ordered with the addressed player first so it is stale
+  // when either the available or addressed players change.
+  if (available_players || addressed_player) {
+    browse_cache_.InvalidatePlayerList();
+  }
+
+  // The media layer doesn't always report UID changes along with a content
+  // change, so any folder update drops the cached folders and now playing list.
+  browse_cache_.InvalidateFolders();
+  browse_cache_.InvalidateNowPlaying();
+
+  if (uids) {
+    browse_cache_.IncrementUidCounter();
+  }
+
   if (available_players) {
     HandleAvailablePlayerUpdate();
   }
@@ -1531,6 +1663,7 @@ std::ostream& operator<<(std::ostream& out, const Device& d) {
   out << "Current Folder: \"" << d.CurrentFolder() << "\"\n";
   out << "MTU Sizes: CTRL=" << d.ctrl_mtu_ << " BROWSE=" << d.browse_mtu_
       << std::endl;
+  out << d.browse_cache_;
   // TODO (apanicke): Add supported features as well as media keys
   return out;
 }
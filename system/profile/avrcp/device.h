@@ -38,6 +38,7 @@
 #include "packet/avrcp/set_addressed_player.h"
 #include "packet/avrcp/set_browsed_player.h"
 #include "packet/avrcp/vendor_packet.h"
+#include "profile/avrcp/browse_cache.h"
 #include "profile/avrcp/media_id_map.h"
 #include "raw_address.h"
 
@@ -210,6 +211,8 @@ class Device {
       uint16_t curr_player, std::vector<MediaPlayerInfo> players);
   virtual void GetVFSListResponse(uint8_t label,
                                   std::shared_ptr<GetFolderItemsRequest> pkt,
+                                  uint16_t player_id, std::string folder_id,
+                                  uint32_t total_items, uint32_t first_item,
                                   std::vector<ListItem> items);
   virtual void GetNowPlayingListResponse(
       uint8_t label, std::shared_ptr<GetFolderItemsRequest> pkt,
@@ -221,6 +224,10 @@ class Device {
   virtual void GetTotalNumberOfItemsMediaPlayersResponse(
       uint8_t label, uint16_t curr_player, std::vector<MediaPlayerInfo> list);
   virtual void GetTotalNumberOfItemsVFSResponse(uint8_t label,
+                                                uint16_t player_id,
+                                                std::string folder_id,
+                                                uint32_t total_items,
+                                                uint32_t first_item,
                                                 std::vector<ListItem> items);
   virtual void GetTotalNumberOfItemsNowPlayingResponse(
       uint8_t label, std::string curr_song_id, std::vector<SongInfo> song_list);
@@ -247,6 +254,8 @@ class Device {
                                 std::shared_ptr<ChangePathRequest> request);
   virtual void ChangePathResponse(uint8_t label,
                                   std::shared_ptr<ChangePathRequest> request,
+                                  uint16_t player_id, std::string folder_id,
+                                  uint32_t total_items, uint32_t first_item,
                                   std::vector<ListItem> list);
 
   // PLAY ITEM
@@ -291,6 +300,23 @@ class Device {
     return current_path_.top();
   }
 
+  // Stores a window of a folder in the browse cache and assigns UIDs to the new
+  // items.
+  const BrowseCache::FolderWindow& CacheFolderItems(
+      uint16_t player_id, const std::string& folder_id, uint32_t total_items,
+      uint32_t first_item, std::vector<ListItem> items);
+
+  // Build the Get Folder Items responses from the browse cache. Items are only
+  // materialized until the browse MTU is reached.
+  void SendMediaPlayerListResponse(uint8_t label,
+                                   const GetFolderItemsRequest& pkt,
+                                   const BrowseCache::PlayerList& list);
+  void SendVFSListResponse(uint8_t label, const GetFolderItemsRequest& pkt,
+                           const BrowseCache::FolderWindow& window);
+  void SendNowPlayingListResponse(uint8_t label,
+                                  const GetFolderItemsRequest& pkt,
+                                  const BrowseCache::NowPlayingList& list);
+
   void send_message(uint8_t label, bool browse,
                     std::unique_ptr<::bluetooth::PacketBuilder> message) {
     active_labels_.erase(label);
@@ -328,6 +354,8 @@ class Device {
   MediaIdMap vfs_ids_;
   MediaIdMap now_playing_ids_;
 
+  BrowseCache browse_cache_;
+
   uint32_t play_pos_interval_ = 0;
 
   SongInfo last_song_info_;
@@ -25,6 +25,12 @@ class FakeMediaInterface : public MediaInterface {
   using FolderItemsCallback = base::Callback<void(std::vector<ListItem>)>;
   virtual void GetFolderItems(uint16_t player_id, std::string media_id,
                               FolderItemsCallback folder_cb) {}
+  using FolderItemsRangeCallback =
+      base::Callback<void(uint32_t total_items, uint32_t first_item,
+                          std::vector<ListItem>)>;
+  virtual void GetFolderItemsRange(uint16_t player_id, std::string media_id,
+                                   uint32_t start_item, uint32_t end_item,
+                                   FolderItemsRangeCallback folder_cb) {}
   using SetBrowsedPlayerCallback = base::Callback<void(
       bool success, std::string root_id, uint32_t num_items)>;
   virtual void SetBrowsedPlayer(uint16_t player_id,
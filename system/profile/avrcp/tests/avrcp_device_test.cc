@@ -957,6 +957,132 @@ TEST_F(AvrcpDeviceTest, getFolderItemsMtuTest) {
       1, TestBrowsePacket::Make(get_folder_items_request_vfs));
 }
 
+TEST_F(AvrcpDeviceTest, getFolderItemsCachedTest) {
+  MockMediaInterface interface;
+  NiceMock<MockA2dpInterface> a2dp_interface;
+
+  test_device->RegisterInterfaces(&interface, &a2dp_interface, nullptr);
+
+  std::vector<ListItem> list = {
+      {ListItem::FOLDER, {"test_id0", true, "Test Folder0"}, SongInfo()},
+      {ListItem::FOLDER, {"test_id1", true, "Test Folder1"}, SongInfo()},
+      {ListItem::FOLDER, {"test_id2", true, "Test Folder2"}, SongInfo()},
+  };
+
+  // The folder is only fetched once for the item count and both pages.
+  EXPECT_CALL(interface, GetFolderItems(_, "", _))
+      .Times(1)
+      .WillOnce(InvokeCb<2>(list));
+
+  auto total_response = GetTotalNumberOfItemsResponseBuilder::MakeBuilder(
+      Status::NO_ERROR, 0, list.size());
+  EXPECT_CALL(response_cb,
+              Call(1, true, matchPacket(std::move(total_response))))
+      .Times(1);
+  SendBrowseMessage(
+      1, TestBrowsePacket::Make(get_total_number_of_items_request_vfs));
+
+  auto first_page = GetFolderItemsResponseBuilder::MakeVFSBuilder(
+      Status::NO_ERROR, 0x0000, 0xFFFF);
+  first_page->AddFolder(FolderItem(1, 0, true, "Test Folder0"));
+  first_page->AddFolder(FolderItem(2, 0, true, "Test Folder1"));
+  EXPECT_CALL(response_cb, Call(2, true, matchPacket(std::move(first_page))))
+      .Times(1);
+  auto request = TestBrowsePacket::Make();
+  GetFolderItemsRequestBuilder::MakeBuilder(Scope::VFS, 0, 1, {})
+      ->Serialize(request);
+  SendBrowseMessage(2, request);
+
+  auto second_page = GetFolderItemsResponseBuilder::MakeVFSBuilder(
+      Status::NO_ERROR, 0x0000, 0xFFFF);
+  second_page->AddFolder(FolderItem(3, 0, true, "Test Folder2"));
+  EXPECT_CALL(response_cb, Call(3, true, matchPacket(std::move(second_page))))
+      .Times(1);
+  request = TestBrowsePacket::Make();
+  GetFolderItemsRequestBuilder::MakeBuilder(Scope::VFS, 2, 3, {})
+      ->Serialize(request);
+  SendBrowseMessage(3, request);
+
+  // A UIDs changed update from the media layer drops the cached folder.
+  Mock::VerifyAndClearExpectations(&interface);
+  EXPECT_CALL(interface, GetFolderItems(_, "", _))
+      .Times(1)
+      .WillOnce(InvokeCb<2>(list));
+  test_device->SendFolderUpdate(false, false, true);
+
+  total_response = GetTotalNumberOfItemsResponseBuilder::MakeBuilder(
+      Status::NO_ERROR, 0, list.size());
+  EXPECT_CALL(response_cb,
+              Call(4, true, matchPacket(std::move(total_response))))
+      .Times(1);
+  SendBrowseMessage(
+      4, TestBrowsePacket::Make(get_total_number_of_items_request_vfs));
+}
+
+TEST_F(AvrcpDeviceTest, getFolderItemsContentChangedTest) {
+  MockMediaInterface interface;
+  NiceMock<MockA2dpInterface> a2dp_interface;
+
+  test_device->RegisterInterfaces(&interface, &a2dp_interface, nullptr);
+
+  std::vector<ListItem> list0 = {
+      {ListItem::FOLDER, {"test_id0", true, "Test Folder0"}, SongInfo()},
+      {ListItem::FOLDER, {"test_id1", true, "Test Folder1"}, SongInfo()},
+  };
+  std::vector<ListItem> list1 = {
+      {ListItem::FOLDER, {"test_id0", true, "Test Folder0"}, SongInfo()},
+      {ListItem::FOLDER, {"test_id2", true, "Test Folder2"}, SongInfo()},
+  };
+  std::vector<ListItem> list2 = {
+      {ListItem::FOLDER, {"test_id3", true, "Test Folder3"}, SongInfo()},
+  };
+  EXPECT_CALL(interface, GetFolderItems(_, "", _))
+      .Times(3)
+      .WillOnce(InvokeCb<2>(list0))
+      .WillOnce(InvokeCb<2>(list1))
+      .WillOnce(InvokeCb<2>(list2));
+
+  auto response = GetFolderItemsResponseBuilder::MakeVFSBuilder(
+      Status::NO_ERROR, 0x0000, 0xFFFF);
+  response->AddFolder(FolderItem(1, 0, true, "Test Folder0"));
+  response->AddFolder(FolderItem(2, 0, true, "Test Folder1"));
+  EXPECT_CALL(response_cb, Call(1, true, matchPacket(std::move(response))))
+      .Times(1);
+  auto request = TestBrowsePacket::Make();
+  GetFolderItemsRequestBuilder::MakeBuilder(Scope::VFS, 0, 1, {})
+      ->Serialize(request);
+  SendBrowseMessage(1, request);
+
+  // The media layer reports a content change without a UIDs change, the next
+  // page is fetched again rather than served from the cache.
+  test_device->SendFolderUpdate(true, true, false);
+
+  response = GetFolderItemsResponseBuilder::MakeVFSBuilder(Status::NO_ERROR,
+                                                           0x0000, 0xFFFF);
+  response->AddFolder(FolderItem(1, 0, true, "Test Folder0"));
+  response->AddFolder(FolderItem(3, 0, true, "Test Folder2"));
+  EXPECT_CALL(response_cb, Call(2, true, matchPacket(std::move(response))))
+      .Times(1);
+  SendBrowseMessage(2, request);
+
+  // Setting the browsed player drops the cached folders as well.
+  EXPECT_CALL(interface, SetBrowsedPlayer(_, _))
+      .WillOnce(InvokeCb<1>(true, "", list2.size()));
+  auto browsed_player_response = SetBrowsedPlayerResponseBuilder::MakeBuilder(
+      Status::NO_ERROR, 0x0000, list2.size(), 0, "");
+  EXPECT_CALL(response_cb,
+              Call(3, true, matchPacket(std::move(browsed_player_response))))
+      .Times(1);
+  SendBrowseMessage(3, TestBrowsePacket::Make(set_browsed_player_id_0_request));
+
+  response = GetFolderItemsResponseBuilder::MakeVFSBuilder(Status::NO_ERROR,
+                                                           0x0000, 0xFFFF);
+  response->AddFolder(FolderItem(4, 0, true, "Test Folder3"));
+  EXPECT_CALL(response_cb, Call(4, true, matchPacket(std::move(response))))
+      .Times(1);
+  SendBrowseMessage(4, request);
+}
+
 TEST_F(AvrcpDeviceTest, changePathTest) {
   MockMediaInterface interface;
   NiceMock<MockA2dpInterface> a2dp_interface;
@@ -979,8 +1105,10 @@ TEST_F(AvrcpDeviceTest, changePathTest) {
   ListItem item3 = {ListItem::FOLDER, info3, SongInfo()};
   ListItem item4 = {ListItem::FOLDER, info4, SongInfo()};
   std::vector<ListItem> list1 = {item2, item3, item4};
+  // Test Folder1 is fetched once when changing into it, the folder items
+  // request and changing back up into it are both served from the cache.
   EXPECT_CALL(interface, GetFolderItems(_, "test_id1", _))
-      .Times(3)
+      .Times(1)
       .WillRepeatedly(InvokeCb<2>(list1));
 
   std::vector<ListItem> list2 = {};
@@ -44,6 +44,19 @@ class MockMediaInterface : public MediaInterface {
   MOCK_METHOD1(GetMediaPlayerList, void(MediaInterface::MediaListCallback));
   MOCK_METHOD3(GetFolderItems, void(uint16_t, std::string,
                                     MediaInterface::FolderItemsCallback));
+  // Behave like a media layer without native paging support so tests can
+  // keep setting expectations on GetFolderItems.
+  void GetFolderItemsRange(
+      uint16_t player_id, std::string media_id, uint32_t start_item,
+      uint32_t end_item,
+      MediaInterface::FolderItemsRangeCallback folder_cb) override {
+    auto cb_lambda = [](MediaInterface::FolderItemsRangeCallback cb,
+                        std::vector<ListItem> item_list) {
+      uint32_t total_items = item_list.size();
+      cb.Run(total_items, 0, std::move(item_list));
+    };
+    GetFolderItems(player_id, media_id, base::Bind(cb_lambda, folder_cb));
+  }
   MOCK_METHOD2(SetBrowsedPlayer,
                void(uint16_t, MediaInterface::SetBrowsedPlayerCallback));
   MOCK_METHOD3(PlayItem, void(uint16_t, bool, std::string));
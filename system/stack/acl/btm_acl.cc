@@ -2653,6 +2653,17 @@ void acl_send_data_packet_br_edr(const RawAddress& bd_addr, BT_HDR* p_buf) {
     return bluetooth::shim::ACL_WriteData(p_acl->hci_handle, p_buf);
 }
 
+void acl_send_shared_data_packet_br_edr(const RawAddress& bd_addr,
+                                        const BT_HDR* p_buf) {
+  tACL_CONN* p_acl = internal_.btm_bda_to_acl(bd_addr, BT_TRANSPORT_BR_EDR);
+  if (p_acl == nullptr) {
+    LOG_WARN("Acl br_edr data write for unknown device:%s",
+             PRIVATE_ADDRESS(bd_addr));
+    return;
+  }
+  bluetooth::shim::ACL_WriteSharedData(p_acl->hci_handle, p_buf);
+}
+
 void acl_send_data_packet_ble(const RawAddress& bd_addr, BT_HDR* p_buf) {
     tACL_CONN* p_acl = internal_.btm_bda_to_acl(bd_addr, BT_TRANSPORT_LE);
     if (p_acl == nullptr) {
@@ -72,8 +72,11 @@ void BTM_SecAddBleDevice(const RawAddress& bd_addr, tBT_DEVICE_TYPE dev_type,
     p_dev_rec = btm_sec_allocate_dev_rec();
 
     p_dev_rec->bd_addr = bd_addr;
-    p_dev_rec->hci_handle = BTM_GetHCIConnHandle(bd_addr, BT_TRANSPORT_BR_EDR);
-    p_dev_rec->ble_hci_handle = BTM_GetHCIConnHandle(bd_addr, BT_TRANSPORT_LE);
+    btm_sec_dev_rec_set_handle(
+        p_dev_rec, BT_TRANSPORT_BR_EDR,
+        BTM_GetHCIConnHandle(bd_addr, BT_TRANSPORT_BR_EDR));
+    btm_sec_dev_rec_set_handle(p_dev_rec, BT_TRANSPORT_LE,
+                               BTM_GetHCIConnHandle(bd_addr, BT_TRANSPORT_LE));
 
     /* update conn params, use default value for background connection params */
     p_dev_rec->conn_params.min_conn_int = BTM_BLE_CONN_PARAM_UNDEF;
@@ -1171,7 +1174,8 @@ void btm_sec_save_le_key(const RawAddress& bd_addr, tBTM_LE_KEY_TYPE key_type,
             p_keys->pid_key.identity_addr_type);
         /* update device record address as identity address */
         p_rec->bd_addr = p_keys->pid_key.identity_addr;
-        /* combine DUMO device security record if needed */
+        /* combine DUMO device security record if needed, this re-files the
+         * record under its identity address */
         btm_consolidate_dev(p_rec);
         break;
 
@@ -1719,7 +1723,7 @@ void btm_ble_connected(const RawAddress& bda, uint16_t handle, uint8_t enc_mode,
   } else {
     LOG_INFO("Updating device record timestamp for existing ble connection");
     // TODO() Why is timestamp a counter ?
-    p_dev_rec->timestamp = btm_cb.dev_rec_count++;
+    btm_sec_dev_rec_touch(p_dev_rec);
   }
 
   if (is_ble_addr_type_known(addr_type))
@@ -1729,7 +1733,7 @@ void btm_ble_connected(const RawAddress& bda, uint16_t handle, uint8_t enc_mode,
         "Please do not update device record from anonymous le advertisement");
 
   p_dev_rec->ble.pseudo_addr = bda;
-  p_dev_rec->ble_hci_handle = handle;
+  btm_sec_dev_rec_set_handle(p_dev_rec, BT_TRANSPORT_LE, handle);
   p_dev_rec->device_type |= BT_DEVICE_TYPE_BLE;
   p_dev_rec->role_central = (role == HCI_ROLE_CENTRAL) ? true : false;
 
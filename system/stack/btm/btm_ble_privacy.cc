@@ -557,6 +557,7 @@ void btm_ble_resolving_list_load_dev(tBTM_SEC_DEV_REC& dev_rec) {
         .bda = dev_rec.bd_addr,
         .type = dev_rec.ble.AddressType(),
     };
+    btm_cb.sec_dev_rec_index.Update(&dev_rec);
   }
 
   bluetooth::shim::ACL_AddToAddressResolution(
@@ -74,7 +74,9 @@ bool BTM_SecAddDevice(const RawAddress& bd_addr, DEV_CLASS dev_class,
         PRIVATE_ADDRESS(bd_addr), key_type, bd_name);
 
     p_dev_rec->bd_addr = bd_addr;
-    p_dev_rec->hci_handle = BTM_GetHCIConnHandle(bd_addr, BT_TRANSPORT_BR_EDR);
+    btm_sec_dev_rec_set_handle(
+        p_dev_rec, BT_TRANSPORT_BR_EDR,
+        BTM_GetHCIConnHandle(bd_addr, BT_TRANSPORT_BR_EDR));
 
     /* use default value for background connection params */
     /* update conn params, use default value for background connection params */
@@ -85,7 +87,7 @@ bool BTM_SecAddDevice(const RawAddress& bd_addr, DEV_CLASS dev_class,
         PRIVATE_ADDRESS(bd_addr), key_type);
 
     /* "Bump" timestamp for existing record */
-    p_dev_rec->timestamp = btm_cb.dev_rec_count++;
+    btm_sec_dev_rec_touch(p_dev_rec);
 
     /* TODO(eisenbach):
      * Small refactor, but leaving original logic for now.
@@ -133,6 +135,7 @@ bool BTM_SecAddDevice(const RawAddress& bd_addr, DEV_CLASS dev_class,
 void wipe_secrets_and_remove(tBTM_SEC_DEV_REC* p_dev_rec) {
   p_dev_rec->link_key.fill(0);
   memset(&p_dev_rec->ble.keys, 0, sizeof(tBTM_SEC_BLE_KEYS));
+  btm_cb.sec_dev_rec_index.Remove(p_dev_rec);
   list_remove(btm_cb.sec_dev_rec, p_dev_rec);
 }
 
@@ -260,8 +263,11 @@ tBTM_SEC_DEV_REC* btm_sec_alloc_dev(const RawAddress& bd_addr) {
 
   p_dev_rec->bd_addr = bd_addr;
 
-  p_dev_rec->ble_hci_handle = BTM_GetHCIConnHandle(bd_addr, BT_TRANSPORT_LE);
-  p_dev_rec->hci_handle = BTM_GetHCIConnHandle(bd_addr, BT_TRANSPORT_BR_EDR);
+  btm_sec_dev_rec_set_handle(p_dev_rec, BT_TRANSPORT_LE,
+                             BTM_GetHCIConnHandle(bd_addr, BT_TRANSPORT_LE));
+  btm_sec_dev_rec_set_handle(
+      p_dev_rec, BT_TRANSPORT_BR_EDR,
+      BTM_GetHCIConnHandle(bd_addr, BT_TRANSPORT_BR_EDR));
 
   return (p_dev_rec);
 }
@@ -334,6 +340,15 @@ bool is_handle_equal(void* data, void* context) {
  *
  ******************************************************************************/
 tBTM_SEC_DEV_REC* btm_find_dev_by_handle(uint16_t handle) {
+  if (handle == HCI_INVALID_HANDLE) return NULL;
+
+  tBTM_SEC_DEV_REC* p_dev_rec = btm_cb.sec_dev_rec_index.FindByHandle(handle);
+  if (p_dev_rec != nullptr && !is_handle_equal(p_dev_rec, &handle)) {
+    return p_dev_rec;
+  }
+
+  /* The handle may have been assigned in place, without going through
+   * btm_sec_dev_rec_set_handle */
   list_node_t* n = list_foreach(btm_cb.sec_dev_rec, is_handle_equal, &handle);
   if (n) return static_cast<tBTM_SEC_DEV_REC*>(list_node(n));
 
@@ -365,11 +380,23 @@ bool is_address_equal(void* data, void* context) {
 tBTM_SEC_DEV_REC* btm_find_dev(const RawAddress& bd_addr) {
   if (btm_cb.sec_dev_rec == nullptr) return nullptr;
 
+  tBTM_SEC_DEV_REC* p_dev_rec =
+      btm_cb.sec_dev_rec_index.FindByAddress(bd_addr);
+  if (p_dev_rec != nullptr && p_dev_rec->bd_addr == bd_addr) return p_dev_rec;
+
+  // If a LE random address is looking for device record
+  p_dev_rec = btm_cb.sec_dev_rec_index.FindByPseudoAddress(bd_addr);
+  if (p_dev_rec != nullptr && p_dev_rec->ble.pseudo_addr == bd_addr) {
+    return p_dev_rec;
+  }
+
+  /* The address may have been assigned in place, without a following
+   * index update, or be a resolvable private address of a known record */
   list_node_t* n =
       list_foreach(btm_cb.sec_dev_rec, is_address_equal, (void*)&bd_addr);
-  if (n) return static_cast<tBTM_SEC_DEV_REC*>(list_node(n));
+  if (n == nullptr) return NULL;
 
-  return NULL;
+  return static_cast<tBTM_SEC_DEV_REC*>(list_node(n));
 }
 
 /*******************************************************************************
@@ -427,6 +454,8 @@ void btm_consolidate_dev(tBTM_SEC_DEV_REC* p_target_rec) {
       }
     }
   }
+
+  btm_cb.sec_dev_rec_index.Update(p_target_rec);
 }
 
 /*******************************************************************************
@@ -462,37 +491,7 @@ tBTM_SEC_DEV_REC* btm_find_or_alloc_dev(const RawAddress& bd_addr) {
  *
  ******************************************************************************/
 static tBTM_SEC_DEV_REC* btm_find_oldest_dev_rec(void) {
-  tBTM_SEC_DEV_REC* p_oldest = NULL;
-  uint32_t ts_oldest = 0xFFFFFFFF;
-  tBTM_SEC_DEV_REC* p_oldest_paired = NULL;
-  uint32_t ts_oldest_paired = 0xFFFFFFFF;
-
-  list_node_t* end = list_end(btm_cb.sec_dev_rec);
-  for (list_node_t* node = list_begin(btm_cb.sec_dev_rec); node != end;
-       node = list_next(node)) {
-    tBTM_SEC_DEV_REC* p_dev_rec =
-        static_cast<tBTM_SEC_DEV_REC*>(list_node(node));
-
-    if ((p_dev_rec->sec_flags &
-         (BTM_SEC_LINK_KEY_KNOWN | BTM_SEC_LE_LINK_KEY_KNOWN)) == 0) {
-      // Device is not paired
-      if (p_dev_rec->timestamp < ts_oldest) {
-        p_oldest = p_dev_rec;
-        ts_oldest = p_dev_rec->timestamp;
-      }
-    } else {
-      // Paired device
-      if (p_dev_rec->timestamp < ts_oldest_paired) {
-        p_oldest_paired = p_dev_rec;
-        ts_oldest_paired = p_dev_rec->timestamp;
-      }
-    }
-  }
-
-  // If we did not find any non-paired devices, use the oldest paired one...
-  if (ts_oldest == 0xFFFFFFFF) p_oldest = p_oldest_paired;
-
-  return p_oldest;
+  return btm_cb.sec_dev_rec_index.FindOldest();
 }
 
 /*******************************************************************************
@@ -518,6 +517,7 @@ tBTM_SEC_DEV_REC* btm_sec_allocate_dev_rec(void) {
   p_dev_rec =
       static_cast<tBTM_SEC_DEV_REC*>(osi_calloc(sizeof(tBTM_SEC_DEV_REC)));
   list_append(btm_cb.sec_dev_rec, p_dev_rec);
+  btm_cb.sec_dev_rec_index.Add(p_dev_rec);
 
   // Initialize defaults
   p_dev_rec->sec_flags = BTM_SEC_IN_USE;
@@ -528,6 +528,42 @@ tBTM_SEC_DEV_REC* btm_sec_allocate_dev_rec(void) {
   return p_dev_rec;
 }
 
+/*******************************************************************************
+ *
+ * Function         btm_sec_dev_rec_touch
+ *
+ * Description      Bump the timestamp of a device record and make it the most
+ *                  recently used one, the last to be reused when the device
+ *                  database is full.
+ *
+ * Returns          none
+ *
+ ******************************************************************************/
+void btm_sec_dev_rec_touch(tBTM_SEC_DEV_REC* p_dev_rec) {
+  p_dev_rec->timestamp = btm_cb.dev_rec_count++;
+  btm_cb.sec_dev_rec_index.Touch(p_dev_rec);
+}
+
+/*******************************************************************************
+ *
+ * Function         btm_sec_dev_rec_set_handle
+ *
+ * Description      Assign the ACL handle of a device record on the given
+ *                  transport and re-file the record under it.
+ *
+ * Returns          none
+ *
+ ******************************************************************************/
+void btm_sec_dev_rec_set_handle(tBTM_SEC_DEV_REC* p_dev_rec,
+                                tBT_TRANSPORT transport, uint16_t handle) {
+  if (transport == BT_TRANSPORT_LE) {
+    p_dev_rec->ble_hci_handle = handle;
+  } else {
+    p_dev_rec->hci_handle = handle;
+  }
+  btm_cb.sec_dev_rec_index.Update(p_dev_rec);
+}
+
 /*******************************************************************************
  *
  * Function         btm_get_bond_type_dev
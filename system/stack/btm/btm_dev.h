@@ -146,6 +146,33 @@ tBTM_SEC_DEV_REC* btm_find_or_alloc_dev(const RawAddress& bd_addr);
  ******************************************************************************/
 tBTM_SEC_DEV_REC* btm_sec_allocate_dev_rec(void);
 
+/*******************************************************************************
+ *
+ * Function         btm_sec_dev_rec_touch
+ *
+ * Description      Bump the timestamp of a device record and make it the most
+ *                  recently used one, the last to be reused when the device
+ *                  database is full.
+ *
+ * Returns          none
+ *
+ ******************************************************************************/
+void btm_sec_dev_rec_touch(tBTM_SEC_DEV_REC* p_dev_rec);
+
+/*******************************************************************************
+ *
+ * Function         btm_sec_dev_rec_set_handle
+ *
+ * Description      Assign the ACL handle of a device record on the given
+ *                  transport and re-file the record under it, so that
+ *                  btm_find_dev_by_handle finds it.
+ *
+ * Returns          none
+ *
+ ******************************************************************************/
+void btm_sec_dev_rec_set_handle(tBTM_SEC_DEV_REC* p_dev_rec,
+                                tBT_TRANSPORT transport, uint16_t handle);
+
 /*******************************************************************************
  *
  * Function         btm_get_bond_type_dev
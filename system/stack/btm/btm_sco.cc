@@ -33,6 +33,7 @@
 #include "osi/include/allocator.h"
 #include "osi/include/log.h"
 #include "osi/include/osi.h"
+#include "stack/btm/btm_sco_wbs.h"
 #include "stack/btm/btm_sec.h"
 #include "stack/btm/security_device_record.h"
 #include "stack/include/acl_api.h"
@@ -88,6 +89,8 @@ static tBTM_STATUS BTM_ChangeEScoLinkParms(uint16_t sco_inx,
 
 static uint16_t btm_sco_voice_settings_to_legacy(enh_esco_params_t* p_parms);
 
+static void btm_sco_set_data_path(enh_esco_params_t* p_setup);
+
 /*******************************************************************************
  *
  * Function         btm_esco_conn_rsp
@@ -142,7 +145,7 @@ static void btm_esco_conn_rsp(uint16_t sco_inx, uint8_t hci_status,
     if (controller_get_interface()
             ->supports_enhanced_setup_synchronous_connection()) {
       /* Use the saved SCO routing */
-      p_setup->input_data_path = p_setup->output_data_path = ESCO_DATA_PATH;
+      btm_sco_set_data_path(p_setup);
 
       BTM_TRACE_DEBUG(
           "%s: txbw 0x%x, rxbw 0x%x, lat 0x%x, retrans 0x%02x, "
@@ -200,18 +203,23 @@ void btm_route_sco_data(BT_HDR* p_msg) {
     return;
   }
   uint16_t handle = handle_with_flags & 0xFFF;
+  uint8_t packet_status = (handle_with_flags >> 12) & 0x3;
   ASSERT_LOG(handle <= 0xEFF, "Require handle <= 0xEFF, but is 0x%X", handle);
+  bool wbs = bluetooth::audio::sco::wbs::is_active();
   auto* active_sco = btm_get_active_sco();
   if (active_sco != nullptr && active_sco->hci_handle == handle) {
-    // TODO: For MSBC, we need to decode here
-    bluetooth::audio::sco::write(payload, length);
+    if (wbs) {
+      bluetooth::audio::sco::wbs::write(payload, length, packet_status);
+    } else {
+      bluetooth::audio::sco::write(payload, length);
+    }
   }
   osi_free(p_msg);
   // For Chrome OS, we send the outgoing data after receiving an incoming one
   uint8_t out_buf[BTM_SCO_DATA_SIZE_MAX];
-  auto size_read = bluetooth::audio::sco::read(out_buf, length);
+  auto size_read = wbs ? bluetooth::audio::sco::wbs::read(out_buf, length)
+                       : bluetooth::audio::sco::read(out_buf, length);
   auto data = std::vector<uint8_t>(out_buf, out_buf + size_read);
-  // TODO: For MSBC, we need to encode here
   btm_send_sco_packet(std::move(data));
 }
 
@@ -345,7 +353,7 @@ static tBTM_STATUS btm_send_connect_request(uint16_t acl_handle,
       LOG_INFO("Sending enhanced SCO connect request over handle:0x%04x",
                acl_handle);
       /* Use the saved SCO routing */
-      p_setup->input_data_path = p_setup->output_data_path = ESCO_DATA_PATH;
+      btm_sco_set_data_path(p_setup);
       LOG(INFO) << __func__ << std::hex << ": enhanced parameter list"
                 << " txbw=0x" << unsigned(p_setup->transmit_bandwidth)
                 << ", rxbw=0x" << unsigned(p_setup->receive_bandwidth)
@@ -764,6 +772,11 @@ void btm_sco_connected(const RawAddress& bda, uint16_t hci_handle,
       (*p->p_conn_cb)(xx);
 
       bluetooth::audio::sco::open();
+      if (ESCO_DATA_PATH == ESCO_DATA_PATH_HCI &&
+          p->esco.setup.transmit_coding_format.coding_format ==
+              ESCO_CODING_FORMAT_MSBC) {
+        bluetooth::audio::sco::wbs::init();
+      }
 
       return;
     }
@@ -976,6 +989,11 @@ void btm_sco_on_disconnected(uint16_t hci_handle, tHCI_REASON reason) {
                  base::StringPrintf("handle:0x%04x reason:%s", hci_handle,
                                     hci_reason_code_text(reason).c_str()));
 
+  if (bluetooth::audio::sco::wbs::is_active()) {
+    std::string stats = bluetooth::audio::sco::wbs::cleanup().ToString();
+    LOG_INFO("mSBC call quality handle:0x%04x %s", hci_handle, stats.c_str());
+    BTM_LogHistory(kBtmLogTag, bd_addr, "mSBC quality", stats);
+  }
   bluetooth::audio::sco::cleanup();
 }
 
@@ -1176,7 +1194,7 @@ static tBTM_STATUS BTM_ChangeEScoLinkParms(uint16_t sco_inx,
     if (controller_get_interface()
             ->supports_enhanced_setup_synchronous_connection()) {
       /* Use the saved SCO routing */
-      p_setup->input_data_path = p_setup->output_data_path = ESCO_DATA_PATH;
+      btm_sco_set_data_path(p_setup);
 
       btsnd_hcic_enhanced_set_up_synchronous_connection(p_sco->hci_handle,
                                                         p_setup);
@@ -1302,6 +1320,33 @@ bool BTM_IsScoActiveByBdaddr(const RawAddress& remote_bda) {
   return (false);
 }
 
+/*******************************************************************************
+ *
+ * Function         btm_sco_set_data_path
+ *
+ * Description      This function routes the SCO data of an enhanced (e)SCO
+ *                  setup to ESCO_DATA_PATH. When mSBC is routed over HCI, it
+ *                  is encoded and decoded on the host, and the controller
+ *                  carries the frames transparently.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+static void btm_sco_set_data_path(enh_esco_params_t* p_setup) {
+  p_setup->input_data_path = p_setup->output_data_path = ESCO_DATA_PATH;
+  if (ESCO_DATA_PATH != ESCO_DATA_PATH_HCI ||
+      p_setup->transmit_coding_format.coding_format !=
+          ESCO_CODING_FORMAT_MSBC) {
+    return;
+  }
+  p_setup->input_coding_format.coding_format = ESCO_CODING_FORMAT_TRANSPNT;
+  p_setup->output_coding_format.coding_format = ESCO_CODING_FORMAT_TRANSPNT;
+  p_setup->input_bandwidth = TXRX_64KBITS_RATE;
+  p_setup->output_bandwidth = TXRX_64KBITS_RATE;
+  p_setup->input_coded_data_size = 8;
+  p_setup->output_coded_data_size = 8;
+}
+
 /*******************************************************************************
  *
  * Function         btm_sco_voice_settings_2_legacy
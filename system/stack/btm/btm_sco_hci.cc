@@ -22,6 +22,7 @@
 
 #include "osi/include/log.h"
 #include "stack/btm/btm_sco.h"
+#include "stack/btm/btm_sco_wbs.h"
 #include "udrv/include/uipc.h"
 
 #if ESCO_DATA_PATH == ESCO_DATA_PATH_PCM
@@ -33,6 +34,14 @@ void cleanup() {}
 size_t read(uint8_t*, uint32_t) { return 0; }
 size_t write(const uint8_t*, uint32_t) { return 0; }
 }  // namespace bluetooth::audio::sco
+
+namespace bluetooth::audio::sco::wbs {
+void init() {}
+Stats cleanup() { return Stats(); }
+bool is_active() { return false; }
+size_t write(const uint8_t*, uint32_t, uint8_t) { return 0; }
+size_t read(uint8_t*, uint32_t) { return 0; }
+}  // namespace bluetooth::audio::sco::wbs
 #else
 
 #define SCO_DATA_READ_POLL_MS 10
@@ -44,6 +53,12 @@ namespace {
 
 std::unique_ptr<tUIPC_STATE> sco_uipc = nullptr;
 
+std::unique_ptr<bluetooth::audio::sco::wbs::Codec> wbs_codec = nullptr;
+
+// Audio read from the socket, waiting to make up a whole frame
+int16_t wbs_tx_pcm[bluetooth::audio::sco::wbs::kSamplesPerFrame];
+size_t wbs_tx_pcm_len = 0;
+
 void sco_data_cb(tUIPC_CH_ID, tUIPC_EVENT event) {
   switch (event) {
     case UIPC_OPEN_EVT:
@@ -84,6 +99,7 @@ void open() {
 }
 
 void cleanup() {
+  wbs::cleanup();
   if (sco_uipc == nullptr) {
     return;
   }
@@ -107,6 +123,71 @@ size_t write(const uint8_t* p_buf, uint32_t len) {
   return UIPC_Send(*sco_uipc, UIPC_CH_ID_AV_AUDIO, 0, p_buf, len);
 }
 
+namespace wbs {
+
+void init() {
+  if (wbs_codec != nullptr) {
+    LOG_WARN("Re-initializing mSBC codec that is already running");
+  }
+  wbs_codec = std::make_unique<Codec>();
+  wbs_tx_pcm_len = 0;
+}
+
+Stats cleanup() {
+  if (wbs_codec == nullptr) {
+    return Stats();
+  }
+  Stats stats = wbs_codec->stats();
+  wbs_codec = nullptr;
+  return stats;
+}
+
+bool is_active() { return wbs_codec != nullptr; }
+
+size_t write(const uint8_t* p_buf, uint32_t len, uint8_t status) {
+  if (wbs_codec == nullptr) {
+    LOG_WARN("Write to uninitialized mSBC codec");
+    return 0;
+  }
+  wbs_codec->EnqueuePacket(p_buf, len, status);
+  int16_t pcm[kSamplesPerFrame];
+  size_t written = 0;
+  while (wbs_codec->DecodeFrame(pcm)) {
+    written +=
+        sco::write(reinterpret_cast<const uint8_t*>(pcm), kPcmFrameSize);
+  }
+  return written;
+}
+
+size_t read(uint8_t* p_buf, uint32_t len) {
+  if (wbs_codec == nullptr) {
+    LOG_WARN("Read from uninitialized mSBC codec");
+    return 0;
+  }
+  // The link sets the pace: every packet received is answered with a packet
+  // of the same size, encoded from as many frames of audio as needed
+  uint8_t* pcm = reinterpret_cast<uint8_t*>(wbs_tx_pcm);
+  bool late = false;
+  while (wbs_codec->EncodedSize() < len) {
+    if (!late) {
+      wbs_tx_pcm_len +=
+          sco::read(pcm + wbs_tx_pcm_len, kPcmFrameSize - wbs_tx_pcm_len);
+      late = wbs_tx_pcm_len < kPcmFrameSize;
+    }
+    if (late) {
+      // The audio server is late: send silence rather than nothing, and keep
+      // what was read for the next frame
+      wbs_codec->EncodeSilence();
+      continue;
+    }
+    wbs_codec->EncodeFrame(wbs_tx_pcm);
+    wbs_tx_pcm_len = 0;
+  }
+  return wbs_codec->DequeuePacket(p_buf, len);
+}
+
+}  // namespace wbs
+
 }  // namespace sco
 }  // namespace audio
 }  // namespace bluetooth
@@ -0,0 +1,145 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "stack/btm/btm_sco_plc.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace bluetooth::audio::sco {
+
+namespace {
+
+// Lost frames substituted at full amplitude, then the attenuation applied to
+// each of the following ones
+constexpr size_t kFullAmplitudeFrames = 2;
+constexpr float kAttenuationPerFrame = 0.7f;
+
+// Bounds on the amplitude of the substitution relative to its source
+constexpr float kMinScale = 0.75f;
+constexpr float kMaxScale = 1.2f;
+
+int16_t Clip(float sample) {
+  return static_cast<int16_t>(std::clamp(std::lround(sample), -32768L, 32767L));
+}
+
+}  // namespace
+
+PacketLossConcealment::PacketLossConcealment() {
+  memset(history_, 0, sizeof(history_));
+  // Raised cosine, rising from 0 towards 1
+  for (size_t i = 0; i < kOverlapSamples; i++) {
+    overlap_window_[i] =
+        0.5f - 0.5f * std::cos(M_PI * (i + 0.5f) / kOverlapSamples);
+  }
+}
+
+void PacketLossConcealment::GoodFrame(int16_t* frame) {
+  if (bad_frames_ > 0) {
+    // The decoder output is not reliable until it has converged again: keep
+    // the substitution for a while, then fade into the decoded audio
+    const int16_t* substitute = history_ + kHistorySamples;
+    for (size_t i = 0; i < kConvergeSamples; i++) {
+      frame[i] = Clip(substitute[i] * gain_);
+    }
+    for (size_t i = 0; i < kOverlapSamples; i++) {
+      size_t j = kConvergeSamples + i;
+      frame[j] = Clip(substitute[j] * gain_ * (1 - overlap_window_[i]) +
+                      frame[j] * overlap_window_[i]);
+    }
+    bad_frames_ = 0;
+  }
+
+  memmove(history_, history_ + kFrameSamples,
+          (kHistorySamples - kFrameSamples) * sizeof(int16_t));
+  memcpy(history_ + kHistorySamples - kFrameSamples, frame,
+         kFrameSamples * sizeof(int16_t));
+}
+
+void PacketLossConcealment::BadFrame(int16_t* frame) {
+  if (bad_frames_ == 0) {
+    match_ = FindBestMatch();
+    scale_ = AmplitudeRatio(match_);
+    gain_ = 1;
+  }
+  bad_frames_++;
+
+  // The history is shifted by a frame after each substitution, so reading at
+  // the same offset carries on where the previous frame stopped. As in the
+  // HFP reference, only the first substitution is scaled.
+  int16_t* substitute = history_ + kHistorySamples;
+  for (size_t i = 0; i < kSubstituteSamples; i++) {
+    substitute[i] = Clip(history_[match_ + i] * scale_);
+  }
+  scale_ = 1;
+
+  // Fade out long losses, from the gain of the previous frame to the gain of
+  // this one. The history keeps the substitution at full amplitude.
+  float gain_start = gain_;
+  if (bad_frames_ > kFullAmplitudeFrames) gain_ *= kAttenuationPerFrame;
+  for (size_t i = 0; i < kFrameSamples; i++) {
+    float gain = gain_start + (gain_ - gain_start) * i / kFrameSamples;
+    frame[i] = Clip(substitute[i] * gain);
+  }
+
+  memmove(history_, history_ + kFrameSamples,
+          (kHistorySamples + kSubstituteSamples - kFrameSamples) *
+              sizeof(int16_t));
+}
+
+// Returns the offset in the history of the audio that followed the best
+// match of the last kTemplateSamples, by normalized cross-correlation
+size_t PacketLossConcealment::FindBestMatch() const {
+  const int16_t* pattern = history_ + kHistorySamples - kTemplateSamples;
+  float energy = 0;
+  for (size_t i = 0; i < kTemplateSamples; i++) {
+    energy += static_cast<float>(history_[i]) * history_[i];
+  }
+
+  size_t best = 0;
+  float best_score = -INFINITY;
+  for (size_t start = 0; start < kWindowSamples; start++) {
+    float correlation = 0;
+    for (size_t i = 0; i < kTemplateSamples; i++) {
+      correlation += static_cast<float>(history_[start + i]) * pattern[i];
+    }
+    float score = energy > 0 ? correlation / std::sqrt(energy) : 0;
+    if (score > best_score) {
+      best_score = score;
+      best = start;
+    }
+    // Slide the energy of the candidate window by one sample
+    float out = history_[start];
+    float in = history_[start + kTemplateSamples];
+    energy += in * in - out * out;
+  }
+  return best + kTemplateSamples;
+}
+
+// Returns the ratio between the amplitude of the last kTemplateSamples and
+// the amplitude of their match, which ends at |match|
+float PacketLossConcealment::AmplitudeRatio(size_t match) const {
+  float current = 0, matched = 0;
+  for (size_t i = 0; i < kTemplateSamples; i++) {
+    current += std::abs(history_[kHistorySamples - kTemplateSamples + i]);
+    matched += std::abs(history_[match - kTemplateSamples + i]);
+  }
+  if (current == 0 || matched == 0) return 0;
+  return std::clamp(current / matched, kMinScale, kMaxScale);
+}
+
+}  // namespace bluetooth::audio::sco
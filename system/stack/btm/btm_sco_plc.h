@@ -0,0 +1,71 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace bluetooth::audio::sco {
+
+/*
+ * Packet loss concealment for wideband speech, by waveform substitution as
+ * recommended for mSBC by the HFP specification.
+ *
+ * A lost frame is replaced by what followed the best match of the last 4 ms
+ * in the last 23 ms of audio, scaled to the current amplitude. Consecutive
+ * lost frames carry on with the same substitution, and fade out after a few
+ * frames. The first good frame after a loss keeps the substitution while the
+ * decoder converges again, then overlap-adds into the decoded audio.
+ */
+class PacketLossConcealment {
+ public:
+  static constexpr size_t kFrameSamples = 120;  // 7.5 ms at 16 kHz
+
+  PacketLossConcealment();
+
+  // Records a decoded |frame|, smoothing it in place if it follows lost ones
+  void GoodFrame(int16_t* frame);
+
+  // Writes the substitution for a lost frame to |frame|
+  void BadFrame(int16_t* frame);
+
+  // Number of lost frames since the last good one
+  size_t ConsecutiveBadFrames() const { return bad_frames_; }
+
+ private:
+  static constexpr size_t kWindowSamples = 256;    // Searched for a match
+  static constexpr size_t kTemplateSamples = 64;   // Matched
+  static constexpr size_t kConvergeSamples = 36;   // Decoder reconvergence
+  static constexpr size_t kOverlapSamples = 16;    // Overlap-add
+  static constexpr size_t kHistorySamples = kWindowSamples + kFrameSamples - 1;
+  static constexpr size_t kSubstituteSamples =
+      kFrameSamples + kConvergeSamples + kOverlapSamples;
+
+  size_t FindBestMatch() const;
+  float AmplitudeRatio(size_t match) const;
+
+  // The last kHistorySamples of audio, followed by the substitution of the
+  // frame being concealed
+  int16_t history_[kHistorySamples + kSubstituteSamples];
+  float overlap_window_[kOverlapSamples];
+  size_t bad_frames_ = 0;
+  size_t match_ = 0;
+  float scale_ = 0;
+  float gain_ = 1;
+};
+
+}  // namespace bluetooth::audio::sco
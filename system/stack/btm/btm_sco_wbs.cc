@@ -0,0 +1,203 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "stack/btm/btm_sco_wbs.h"
+
+#include <base/logging.h>
+#include <base/strings/stringprintf.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace bluetooth::audio::sco::wbs {
+
+namespace {
+
+// The H2 synchronization header: 0x01, then the 2 bit sequence number, with
+// each bit repeated, in the upper nibble of 0x?8
+constexpr uint8_t kH2Sync = 0x01;
+constexpr uint8_t kH2Sequence[] = {0x08, 0x38, 0xc8, 0xf8};
+constexpr size_t kH2HeaderSize = 2;
+
+int H2Sequence(uint8_t octet) {
+  for (int i = 0; i < 4; i++) {
+    if (octet == kH2Sequence[i]) return i;
+  }
+  return -1;
+}
+
+}  // namespace
+
+double Stats::FrameLossRatio() const {
+  uint64_t frames = decoded_frames + concealed_frames;
+  return frames ? static_cast<double>(concealed_frames) / frames : 0;
+}
+
+std::string Stats::ToString() const {
+  return base::StringPrintf(
+      "rx_packets:%llu erroneous:%llu decoded:%llu concealed:%llu "
+      "frame_loss:%.2f%% discarded_octets:%llu sequence_errors:%llu "
+      "encoded:%llu tx_underruns:%llu",
+      (unsigned long long)rx_packets, (unsigned long long)rx_erroneous_packets,
+      (unsigned long long)decoded_frames, (unsigned long long)concealed_frames,
+      100 * FrameLossRatio(), (unsigned long long)discarded_octets,
+      (unsigned long long)sequence_errors, (unsigned long long)encoded_frames,
+      (unsigned long long)tx_underruns);
+}
+
+Codec::Codec() {
+  // The decoder does not clear the synthesis filter state it keeps there
+  memset(decoder_data_, 0, sizeof(decoder_data_));
+  OI_STATUS status = OI_CODEC_SBC_DecoderReset(
+      &decoder_context_, decoder_data_, sizeof(decoder_data_), 1, 1, false);
+  CHECK(OI_SUCCESS(status)) << "Unable to reset the mSBC decoder: " << status;
+  status = OI_CODEC_SBC_DecoderConfigureMSbc(&decoder_context_);
+  CHECK(OI_SUCCESS(status)) << "Unable to configure the mSBC decoder";
+
+  memset(&encoder_params_, 0, sizeof(encoder_params_));
+  encoder_params_.Format = SBC_FORMAT_MSBC;
+  SBC_Encoder_Init(&encoder_params_);
+}
+
+void Codec::EnqueuePacket(const uint8_t* data, size_t len, uint8_t status) {
+  stats_.rx_packets++;
+  if (status != kCorrectlyReceived) stats_.rx_erroneous_packets++;
+
+  // Frames are decoded as soon as they are complete: this only happens if
+  // the packets do not carry mSBC at all
+  if (rx_len_ + len > kBufferSize) {
+    size_t excess = std::min(rx_len_ + len - kBufferSize, rx_len_);
+    stats_.discarded_octets += excess;
+    ConsumeRx(excess);
+    if (len > kBufferSize) {
+      stats_.discarded_octets += len - kBufferSize;
+      data += len - kBufferSize;
+      len = kBufferSize;
+    }
+  }
+  memcpy(rx_ + rx_len_, data, len);
+  memset(rx_status_ + rx_len_, status, len);
+  rx_len_ += len;
+}
+
+bool Codec::DecodeFrame(int16_t* pcm) {
+  while (rx_len_ >= kFrameSize) {
+    size_t offset = FindHeader();
+    if (offset != 0 && !Erroneous(kFrameSize) && offset < kFrameSize) {
+      // Octets in front of the header are left over from a frame that was
+      // cut short, or are not mSBC at all: synchronize on the header
+      stats_.discarded_octets += offset;
+      ConsumeRx(offset);
+      continue;
+    }
+
+    bool decoded = false;
+    if (offset == 0 && !Erroneous(kFrameSize)) {
+      int sequence = H2Sequence(rx_[1]);
+      if (expected_sequence_ >= 0 && sequence != expected_sequence_) {
+        stats_.sequence_errors++;
+      }
+      expected_sequence_ = (sequence + 1) % 4;
+
+      const OI_BYTE* frame = rx_ + kH2HeaderSize;
+      uint32_t frame_len = kFrameSize - kH2HeaderSize;
+      uint32_t pcm_len = kPcmFrameSize;
+      OI_STATUS status = OI_CODEC_SBC_DecodeFrame(&decoder_context_, &frame,
+                                                  &frame_len, pcm, &pcm_len);
+      decoded = OI_SUCCESS(status) && pcm_len == kPcmFrameSize;
+    } else {
+      // Keep the timing of the frames: the frame in place was either not
+      // received correctly, or its header was damaged
+      expected_sequence_ = -1;
+    }
+    ConsumeRx(kFrameSize);
+
+    if (decoded) {
+      stats_.decoded_frames++;
+      plc_.GoodFrame(pcm);
+    } else {
+      stats_.concealed_frames++;
+      plc_.BadFrame(pcm);
+    }
+    return true;
+  }
+  return false;
+}
+
+void Codec::EncodeFrame(const int16_t* pcm) {
+  if (tx_len_ + kFrameSize > kBufferSize) {
+    LOG(WARNING) << __func__ << ": Dropping an encoded frame, "
+                 << tx_len_ << " octets waiting to be sent";
+    return;
+  }
+
+  int16_t input[kSamplesPerFrame];
+  memcpy(input, pcm, sizeof(input));
+
+  uint8_t* frame = tx_ + tx_len_;
+  frame[0] = kH2Sync;
+  frame[1] = kH2Sequence[tx_sequence_];
+  tx_sequence_ = (tx_sequence_ + 1) % 4;
+  uint32_t len = SBC_Encode(&encoder_params_, input, frame + kH2HeaderSize);
+  CHECK(len == kFrameSize - kH2HeaderSize - 1)
+      << "Unexpected mSBC frame length " << len;
+  frame[kFrameSize - 1] = 0;  // Padding
+  tx_len_ += kFrameSize;
+  stats_.encoded_frames++;
+}
+
+void Codec::EncodeSilence() {
+  int16_t silence[kSamplesPerFrame] = {};
+  EncodeFrame(silence);
+  stats_.tx_underruns++;
+}
+
+size_t Codec::DequeuePacket(uint8_t* data, size_t len) {
+  len = std::min(len, tx_len_);
+  memcpy(data, tx_, len);
+  memmove(tx_, tx_ + len, tx_len_ - len);
+  tx_len_ -= len;
+  return len;
+}
+
+// Returns the offset of the first H2 header followed by an mSBC syncword in
+// the received octets, or |rx_len_| if there is none
+size_t Codec::FindHeader() const {
+  for (size_t i = 0; i + kH2HeaderSize < rx_len_; i++) {
+    if (rx_[i] == kH2Sync && H2Sequence(rx_[i + 1]) >= 0 &&
+        rx_[i + kH2HeaderSize] == OI_SBC_MSBC_SYNCWORD) {
+      return i;
+    }
+  }
+  return rx_len_;
+}
+
+// Whether any of the first |len| received octets came in a packet that was
+// not correctly received
+bool Codec::Erroneous(size_t len) const {
+  for (size_t i = 0; i < len; i++) {
+    if (rx_status_[i] != kCorrectlyReceived) return true;
+  }
+  return false;
+}
+
+void Codec::ConsumeRx(size_t len) {
+  memmove(rx_, rx_ + len, rx_len_ - len);
+  memmove(rx_status_, rx_status_ + len, rx_len_ - len);
+  rx_len_ -= len;
+}
+
+}  // namespace bluetooth::audio::sco::wbs
@@ -0,0 +1,137 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "embdrv/sbc/decoder/include/oi_codec_sbc.h"
+#include "embdrv/sbc/encoder/include/sbc_encoder.h"
+#include "stack/btm/btm_sco_plc.h"
+
+// Wideband speech over SCO-over-HCI: mSBC encoded and decoded on the host
+namespace bluetooth::audio::sco::wbs {
+
+// mSBC frames are carried in 60 octets over the air: an H2 synchronization
+// header, the 57 octets of the frame and an octet of padding
+constexpr size_t kFrameSize = 60;
+constexpr size_t kSamplesPerFrame = PacketLossConcealment::kFrameSamples;
+constexpr size_t kPcmFrameSize = kSamplesPerFrame * sizeof(int16_t);
+
+// Packet_Status_Flag of the HCI synchronous data packets
+enum PacketStatus : uint8_t {
+  kCorrectlyReceived = 0,
+  kPossiblyInvalid = 1,
+  kNoDataReceived = 2,
+  kPartiallyLost = 3,
+};
+
+// Quality of the speech received, and sent, over a call
+struct Stats {
+  uint64_t rx_packets = 0;
+  uint64_t rx_erroneous_packets = 0;  // Not reported as correctly received
+  uint64_t decoded_frames = 0;
+  uint64_t concealed_frames = 0;   // Lost or not decodable
+  uint64_t discarded_octets = 0;   // Skipped to find an H2 header again
+  uint64_t sequence_errors = 0;    // H2 sequence number out of order
+  uint64_t encoded_frames = 0;
+  uint64_t tx_underruns = 0;  // Silence encoded for want of audio to send
+
+  // Ratio of the received frames that had to be concealed
+  double FrameLossRatio() const;
+  std::string ToString() const;
+};
+
+/*
+ * The host side mSBC codec of a SCO link.
+ *
+ * Received SCO packets need not be aligned on frames: their octets are
+ * buffered, along with their packet status, until a complete frame is found
+ * behind its H2 header. Frames that were not received correctly, or do not
+ * decode, are concealed. Encoded frames are likewise buffered until sent in
+ * packets of whatever size the link uses.
+ */
+class Codec {
+ public:
+  Codec();
+
+  // Buffers a SCO packet received from the controller
+  void EnqueuePacket(const uint8_t* data, size_t len, uint8_t status);
+
+  // Decodes, or conceals, the next buffered frame into |pcm|. Returns false
+  // if no complete frame is buffered.
+  bool DecodeFrame(int16_t* pcm);
+
+  // Encodes a frame of audio, for transmission
+  void EncodeFrame(const int16_t* pcm);
+
+  // Encodes a frame of silence, when there is no audio to send in time
+  void EncodeSilence();
+
+  // Number of encoded octets waiting to be sent
+  size_t EncodedSize() const { return tx_len_; }
+
+  // Copies up to |len| encoded octets to |data|, and returns how many
+  size_t DequeuePacket(uint8_t* data, size_t len);
+
+  const Stats& stats() const { return stats_; }
+
+ private:
+  static constexpr size_t kBufferSize = 8 * kFrameSize;
+
+  size_t FindHeader() const;
+  bool Erroneous(size_t len) const;
+  void ConsumeRx(size_t len);
+
+  OI_CODEC_SBC_DECODER_CONTEXT decoder_context_;
+  uint32_t decoder_data_[CODEC_DATA_WORDS(1, SBC_CODEC_FAST_FILTER_BUFFERS)];
+  // The SBC encoder keeps its filter state in globals, shared with A2DP:
+  // both are never encoding at the same time
+  SBC_ENC_PARAMS encoder_params_;
+  PacketLossConcealment plc_;
+
+  // Received octets, and the status of the packet each came in
+  uint8_t rx_[kBufferSize];
+  uint8_t rx_status_[kBufferSize];
+  size_t rx_len_ = 0;
+  int expected_sequence_ = -1;
+
+  uint8_t tx_[kBufferSize];
+  size_t tx_len_ = 0;
+  uint8_t tx_sequence_ = 0;
+
+  Stats stats_;
+};
+
+// Sets up the codec when a SCO link carrying mSBC over HCI is connected
+void init();
+
+// Tears down the codec, and returns the quality of the call it carried
+Stats cleanup();
+
+// Whether SCO data is encoded and decoded on the host
+bool is_active();
+
+// Decodes a packet received from the controller, and writes the audio to the
+// socket (audio server)
+size_t write(const uint8_t* p_buf, uint32_t len, uint8_t status);
+
+// Reads audio from the socket, and encodes it into a packet of |len| octets
+size_t read(uint8_t* p_buf, uint32_t len);
+
+}  // namespace bluetooth::audio::sco::wbs
@@ -1539,7 +1539,9 @@ tBTM_STATUS btm_sec_l2cap_access_req_by_requirement(
   /* Find or get oldest record */
   tBTM_SEC_DEV_REC* p_dev_rec = btm_find_or_alloc_dev(bd_addr);
 
-  p_dev_rec->hci_handle = BTM_GetHCIConnHandle(bd_addr, BT_TRANSPORT_BR_EDR);
+  btm_sec_dev_rec_set_handle(
+      p_dev_rec, BT_TRANSPORT_BR_EDR,
+      BTM_GetHCIConnHandle(bd_addr, BT_TRANSPORT_BR_EDR));
 
   if ((!is_originator) && (security_required & BTM_SEC_MODE4_LEVEL4)) {
     bool local_supports_sc =
@@ -3483,7 +3485,7 @@ void btm_sec_connected(const RawAddress& bda, uint16_t handle,
         p_dev_rec->sec_bd_name);
 
     bit_shift = (handle == p_dev_rec->ble_hci_handle) ? 8 : 0;
-    p_dev_rec->timestamp = btm_cb.dev_rec_count++;
+    btm_sec_dev_rec_touch(p_dev_rec);
     if (p_dev_rec->sm4 & BTM_SM4_CONN_PEND) {
       /* tell L2CAP it's a bonding connection. */
       if ((btm_cb.pairing_state != BTM_PAIR_STATE_IDLE) &&
@@ -3669,7 +3671,7 @@ void btm_sec_connected(const RawAddress& bda, uint16_t handle,
                                       p_dev_rec->sec_flags));
   }
 
-  p_dev_rec->hci_handle = handle;
+  btm_sec_dev_rec_set_handle(p_dev_rec, BT_TRANSPORT_BR_EDR, handle);
   btm_acl_created(bda, handle, assigned_role, BT_TRANSPORT_BR_EDR);
 
   /* role may not be correct here, it will be updated by l2cap, but we need to
@@ -3804,7 +3806,7 @@ void btm_sec_disconnected(uint16_t handle, tHCI_REASON reason,
   /* see sec_flags processing in btm_acl_removed */
 
   if (transport == BT_TRANSPORT_LE) {
-    p_dev_rec->ble_hci_handle = HCI_INVALID_HANDLE;
+    btm_sec_dev_rec_set_handle(p_dev_rec, BT_TRANSPORT_LE, HCI_INVALID_HANDLE);
     p_dev_rec->sec_flags &= ~(BTM_SEC_LE_AUTHENTICATED | BTM_SEC_LE_ENCRYPTED |
                               BTM_SEC_ROLE_SWITCHED);
     p_dev_rec->enc_key_size = 0;
@@ -3820,7 +3822,8 @@ void btm_sec_disconnected(uint16_t handle, tHCI_REASON reason,
       btm_ble_advertiser_notify_terminated_legacy(HCI_SUCCESS, handle);
     }
   } else {
-    p_dev_rec->hci_handle = HCI_INVALID_HANDLE;
+    btm_sec_dev_rec_set_handle(p_dev_rec, BT_TRANSPORT_BR_EDR,
+                               HCI_INVALID_HANDLE);
     p_dev_rec->sec_flags &=
         ~(BTM_SEC_AUTHENTICATED | BTM_SEC_ENCRYPTED | BTM_SEC_ROLE_SWITCHED |
           BTM_SEC_16_DIGIT_PIN_AUTHED);
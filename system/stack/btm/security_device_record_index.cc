@@ -0,0 +1,161 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "stack/btm/security_device_record_index.h"
+
+#include "stack/include/hcidefs.h"
+
+namespace {
+
+template <typename Key>
+tBTM_SEC_DEV_REC* find_first(
+    const std::unordered_multimap<Key, tBTM_SEC_DEV_REC*>& index,
+    const Key& key) {
+  auto it = index.find(key);
+  return (it == index.end()) ? nullptr : it->second;
+}
+
+void link_address(std::unordered_multimap<RawAddress, tBTM_SEC_DEV_REC*>& index,
+                  const RawAddress& bd_addr, tBTM_SEC_DEV_REC* p_dev_rec) {
+  if (bd_addr.IsEmpty()) return;
+  index.emplace(bd_addr, p_dev_rec);
+}
+
+void link_handle(std::unordered_multimap<uint16_t, tBTM_SEC_DEV_REC*>& index,
+                 uint16_t handle, tBTM_SEC_DEV_REC* p_dev_rec) {
+  if (handle == HCI_INVALID_HANDLE) return;
+  index.emplace(handle, p_dev_rec);
+}
+
+template <typename Key>
+void unlink(std::unordered_multimap<Key, tBTM_SEC_DEV_REC*>& index,
+            const Key& key, const tBTM_SEC_DEV_REC* p_dev_rec) {
+  auto range = index.equal_range(key);
+  for (auto it = range.first; it != range.second; ++it) {
+    if (it->second == p_dev_rec) {
+      index.erase(it);
+      return;
+    }
+  }
+}
+
+}  // namespace
+
+SecurityDeviceRecordIndex::Keys SecurityDeviceRecordIndex::KeysOf(
+    const tBTM_SEC_DEV_REC* p_dev_rec) {
+  return Keys{
+      .bd_addr = p_dev_rec->bd_addr,
+      .pseudo_addr = p_dev_rec->ble.pseudo_addr,
+      .identity_addr = p_dev_rec->ble.identity_address_with_type.bda,
+      .hci_handle = p_dev_rec->hci_handle,
+      .ble_hci_handle = p_dev_rec->ble_hci_handle,
+  };
+}
+
+void SecurityDeviceRecordIndex::Link(tBTM_SEC_DEV_REC* p_dev_rec,
+                                     const Keys& keys) {
+  link_address(by_address_, keys.bd_addr, p_dev_rec);
+  link_address(by_pseudo_address_, keys.pseudo_addr, p_dev_rec);
+  link_address(by_identity_address_, keys.identity_addr, p_dev_rec);
+  link_handle(by_handle_, keys.hci_handle, p_dev_rec);
+  if (keys.ble_hci_handle != keys.hci_handle) {
+    link_handle(by_handle_, keys.ble_hci_handle, p_dev_rec);
+  }
+}
+
+void SecurityDeviceRecordIndex::Unlink(tBTM_SEC_DEV_REC* p_dev_rec,
+                                       const Keys& keys) {
+  unlink(by_address_, keys.bd_addr, p_dev_rec);
+  unlink(by_pseudo_address_, keys.pseudo_addr, p_dev_rec);
+  unlink(by_identity_address_, keys.identity_addr, p_dev_rec);
+  unlink(by_handle_, keys.hci_handle, p_dev_rec);
+  if (keys.ble_hci_handle != keys.hci_handle) {
+    unlink(by_handle_, keys.ble_hci_handle, p_dev_rec);
+  }
+}
+
+void SecurityDeviceRecordIndex::Add(tBTM_SEC_DEV_REC* p_dev_rec) {
+  if (Contains(p_dev_rec)) return;
+  Entry entry{
+      .lru_position = lru_.insert(lru_.end(), p_dev_rec),
+      .keys = KeysOf(p_dev_rec),
+  };
+  Link(p_dev_rec, entry.keys);
+  records_.emplace(p_dev_rec, entry);
+}
+
+void SecurityDeviceRecordIndex::Remove(tBTM_SEC_DEV_REC* p_dev_rec) {
+  auto it = records_.find(p_dev_rec);
+  if (it == records_.end()) return;
+  lru_.erase(it->second.lru_position);
+  Unlink(p_dev_rec, it->second.keys);
+  records_.erase(it);
+}
+
+void SecurityDeviceRecordIndex::Update(tBTM_SEC_DEV_REC* p_dev_rec) {
+  auto it = records_.find(p_dev_rec);
+  if (it == records_.end()) return;
+  Keys keys = KeysOf(p_dev_rec);
+  if (keys == it->second.keys) return;
+  Unlink(p_dev_rec, it->second.keys);
+  Link(p_dev_rec, keys);
+  it->second.keys = keys;
+}
+
+void SecurityDeviceRecordIndex::Touch(tBTM_SEC_DEV_REC* p_dev_rec) {
+  auto it = records_.find(p_dev_rec);
+  if (it == records_.end()) return;
+  lru_.splice(lru_.end(), lru_, it->second.lru_position);
+}
+
+tBTM_SEC_DEV_REC* SecurityDeviceRecordIndex::FindByAddress(
+    const RawAddress& bd_addr) const {
+  return find_first(by_address_, bd_addr);
+}
+
+tBTM_SEC_DEV_REC* SecurityDeviceRecordIndex::FindByPseudoAddress(
+    const RawAddress& bd_addr) const {
+  return find_first(by_pseudo_address_, bd_addr);
+}
+
+tBTM_SEC_DEV_REC* SecurityDeviceRecordIndex::FindByIdentityAddress(
+    const RawAddress& bd_addr) const {
+  return find_first(by_identity_address_, bd_addr);
+}
+
+tBTM_SEC_DEV_REC* SecurityDeviceRecordIndex::FindByHandle(
+    uint16_t handle) const {
+  return find_first(by_handle_, handle);
+}
+
+tBTM_SEC_DEV_REC* SecurityDeviceRecordIndex::FindOldest() const {
+  for (tBTM_SEC_DEV_REC* p_dev_rec : lru_) {
+    if ((p_dev_rec->sec_flags &
+         (BTM_SEC_LINK_KEY_KNOWN | BTM_SEC_LE_LINK_KEY_KNOWN)) == 0) {
+      return p_dev_rec;
+    }
+  }
+  return lru_.empty() ? nullptr : lru_.front();
+}
+
+void SecurityDeviceRecordIndex::Clear() {
+  lru_.clear();
+  records_.clear();
+  by_address_.clear();
+  by_pseudo_address_.clear();
+  by_identity_address_.clear();
+  by_handle_.clear();
+}
@@ -0,0 +1,103 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+
+#include "stack/btm/security_device_record.h"
+#include "types/raw_address.h"
+
+/*
+ * Hash indexes over the security device records kept in btm_cb.sec_dev_rec,
+ * along with their least recently used order.
+ *
+ * The records stay owned by the list. The indexes are authoritative: whoever
+ * assigns the BD address, pseudo address, identity address or an ACL handle
+ * of a registered record must call Update() so that the record is filed under
+ * its new keys. Empty addresses and HCI_INVALID_HANDLE are never indexed.
+ */
+class SecurityDeviceRecordIndex {
+ public:
+  /* Register a newly allocated record as the most recently used one */
+  void Add(tBTM_SEC_DEV_REC* p_dev_rec);
+
+  /* Forget a record that is about to be freed */
+  void Remove(tBTM_SEC_DEV_REC* p_dev_rec);
+
+  /* Re-file a record after any of its keys was assigned */
+  void Update(tBTM_SEC_DEV_REC* p_dev_rec);
+
+  /* Mark a record as the most recently used one */
+  void Touch(tBTM_SEC_DEV_REC* p_dev_rec);
+
+  bool Contains(const tBTM_SEC_DEV_REC* p_dev_rec) const {
+    return records_.count(const_cast<tBTM_SEC_DEV_REC*>(p_dev_rec)) != 0;
+  }
+
+  /* Return the first registered record filed under the key, or nullptr */
+  tBTM_SEC_DEV_REC* FindByAddress(const RawAddress& bd_addr) const;
+  tBTM_SEC_DEV_REC* FindByPseudoAddress(const RawAddress& bd_addr) const;
+  tBTM_SEC_DEV_REC* FindByIdentityAddress(const RawAddress& bd_addr) const;
+  tBTM_SEC_DEV_REC* FindByHandle(uint16_t handle) const;
+
+  /* Return the least recently used record that is not paired, or the least
+   * recently used paired record if all of them are paired. */
+  tBTM_SEC_DEV_REC* FindOldest() const;
+
+  size_t Size() const { return lru_.size(); }
+
+  void Clear();
+
+ private:
+  /* the keys a record is currently filed under */
+  struct Keys {
+    RawAddress bd_addr;
+    RawAddress pseudo_addr;
+    RawAddress identity_addr;
+    uint16_t hci_handle;
+    uint16_t ble_hci_handle;
+
+    bool operator==(const Keys& other) const {
+      return bd_addr == other.bd_addr && pseudo_addr == other.pseudo_addr &&
+             identity_addr == other.identity_addr &&
+             hci_handle == other.hci_handle &&
+             ble_hci_handle == other.ble_hci_handle;
+    }
+  };
+
+  struct Entry {
+    std::list<tBTM_SEC_DEV_REC*>::iterator lru_position;
+    Keys keys;
+  };
+
+  static Keys KeysOf(const tBTM_SEC_DEV_REC* p_dev_rec);
+  void Link(tBTM_SEC_DEV_REC* p_dev_rec, const Keys& keys);
+  void Unlink(tBTM_SEC_DEV_REC* p_dev_rec, const Keys& keys);
+
+  /* least recently used first */
+  std::list<tBTM_SEC_DEV_REC*> lru_;
+  std::unordered_map<tBTM_SEC_DEV_REC*, Entry> records_;
+
+  /* several records may share a key until btm_consolidate_dev merges them */
+  std::unordered_multimap<RawAddress, tBTM_SEC_DEV_REC*> by_address_;
+  std::unordered_multimap<RawAddress, tBTM_SEC_DEV_REC*> by_pseudo_address_;
+  std::unordered_multimap<RawAddress, tBTM_SEC_DEV_REC*> by_identity_address_;
+  /* keyed by both the BR/EDR and the LE ACL handles */
+  std::unordered_multimap<uint16_t, tBTM_SEC_DEV_REC*> by_handle_;
+};
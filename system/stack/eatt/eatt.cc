@@ -15,7 +15,10 @@
  * limitations under the License.
  */
 
+#include <cinttypes>
+
 #include "eatt_impl.h"
+#include "main/shim/dumpsys.h"
 #include "stack/include/bt_hdr.h"
 #include "stack/l2cap/l2c_int.h"
 #include "types/raw_address.h"
@@ -45,6 +48,7 @@ struct EattExtension::impl {
     reg_info_.pL2CA_DisconnectInd_Cb = eatt_disconnect_ind;
     reg_info_.pL2CA_Error_Cb = eatt_error_cb;
     reg_info_.pL2CA_DataInd_Cb = eatt_data_ind;
+    reg_info_.pL2CA_CongestionStatus_Cb = eatt_congestion_cb;
 
     if (L2CA_RegisterLECoc(BT_PSM_EATT, reg_info_, BTM_SEC_NONE, {}) == 0) {
       LOG(ERROR) << __func__ << " cannot register EATT";
@@ -110,6 +114,11 @@ struct EattExtension::impl {
     if (p_eatt_impl) p_eatt_impl->eatt_l2cap_data_ind(lcid, data_p);
   }
 
+  static void eatt_congestion_cb(uint16_t lcid, bool congested) {
+    auto p_eatt_impl = GetImplInstance();
+    if (p_eatt_impl) p_eatt_impl->eatt_l2cap_congestion_cb(lcid, congested);
+  }
+
   std::unique_ptr<eatt_impl> eatt_impl_;
   tL2CAP_APPL_INFO reg_info_;
 };
@@ -161,6 +170,12 @@ EattChannel* EattExtension::GetChannelAvailableForIndication(
   return pimpl_->eatt_impl_->get_channel_available_for_indication(bd_addr);
 }
 
+EattChannel* EattExtension::GetChannelAvailableForNotification(
+    const RawAddress& bd_addr, uint16_t len) {
+  return pimpl_->eatt_impl_->get_channel_available_for_notification(bd_addr,
+                                                                    len);
+}
+
 void EattExtension::FreeGattResources(const RawAddress& bd_addr) {
   pimpl_->eatt_impl_->free_gatt_resources(bd_addr);
 }
@@ -201,6 +216,31 @@ void EattExtension::StopAppIndicationTimer(const RawAddress& bd_addr,
   pimpl_->eatt_impl_->stop_app_indication_timer(bd_addr, cid);
 }
 
+void EattExtension::Dump(int fd) {
+  eatt_impl* p_eatt_impl = pimpl_->eatt_impl_.get();
+  if (!p_eatt_impl) return;
+
+  dprintf(fd, "\nEATT channels:\n");
+  for (const eatt_device& eatt_dev : p_eatt_impl->devices_) {
+    if (eatt_dev.eatt_channels.empty()) continue;
+
+    dprintf(fd, "  %s channels:%zu busy_requests:%u grown:%d\n",
+            PRIVATE_ADDRESS(eatt_dev.bda_), eatt_dev.eatt_channels.size(),
+            eatt_dev.busy_requests_, eatt_dev.grown_);
+    for (const auto& el : eatt_dev.eatt_channels) {
+      const EattChannel& c = *el.second;
+      dprintf(fd,
+              "    cid:0x%04x state:%d tx_mtu:%u rx_mtu:%u outstanding:%zu "
+              "max_outstanding:%zu l2cap_queued:%u requests:%u tx_pdus:%u "
+              "tx_bytes:%" PRIu64 "\n",
+              c.cid_, static_cast<int>(c.state_), c.tx_mtu_, c.rx_mtu_,
+              c.cl_cmd_q_.size(), c.max_cl_queued_,
+              eatt_impl::l2cap_queued(c), c.cl_requests_, c.tx_pdus_,
+              c.tx_bytes_);
+    }
+  }
+}
+
 void EattExtension::Start() { pimpl_->Start(); }
 
 void EattExtension::Stop() { pimpl_->Stop(); }
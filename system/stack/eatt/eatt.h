@@ -24,6 +24,9 @@
 
 #define EATT_MIN_MTU_MPS (64)
 #define EATT_DEFAULT_MTU (256)
+/* Client requests in a row finding every channel busy before more channels
+ * are opened */
+#define EATT_BUSY_REQUESTS_TO_GROW (16)
 
 namespace bluetooth {
 namespace eatt {
@@ -54,6 +57,13 @@ class EattChannel {
   alarm_t* ind_confirmation_timer_;
   /* GATT client command queue */
   std::queue<tGATT_CMD_Q> cl_cmd_q_;
+  /* Scheduling order, rotates among equally loaded channels */
+  uint32_t last_scheduled_;
+  /* Utilization counters, reported in dumpsys */
+  uint32_t cl_requests_;
+  size_t max_cl_queued_;
+  uint32_t tx_pdus_;
+  uint64_t tx_bytes_;
 
   EattChannel(RawAddress& bda, uint16_t cid, uint16_t tx_mtu, uint16_t rx_mtu)
       : bda_(bda),
@@ -63,7 +73,12 @@ class EattChannel {
         state_(EattChannelState::EATT_CHANNEL_PENDING),
         indicate_handle_(0),
         ind_ack_timer_(NULL),
-        ind_confirmation_timer_(NULL) {}
+        ind_confirmation_timer_(NULL),
+        last_scheduled_(0),
+        cl_requests_(0),
+        max_cl_queued_(0),
+        tx_pdus_(0),
+        tx_bytes_(0) {}
 
   ~EattChannel() {
     if (ind_ack_timer_ != NULL) {
@@ -196,6 +211,17 @@ class EattExtension {
   virtual EattChannel* GetChannelAvailableForIndication(
       const RawAddress& bd_addr);
 
+  /**
+   * Get the least loaded EATT channel to send a notification on.
+   *
+   * @param bd_addr peer device address
+   * @param len length of the notified value
+   *
+   * @return pointer to EATT channel.
+   */
+  virtual EattChannel* GetChannelAvailableForNotification(
+      const RawAddress& bd_addr, uint16_t len);
+
   /**
    * Free Resources.
    *
@@ -224,11 +250,13 @@ class EattExtension {
   virtual EattChannel* GetChannelWithQueuedData(const RawAddress& bd_addr);
 
   /**
-   * Get EATT channel available to send GATT request.
+   * Get the least loaded EATT channel to send GATT request. Opens more
+   * channels when all of them stay busy.
    *
    * @param bd_addr peer device address
    *
-   * @return pointer to EATT channel.
+   * @return pointer to EATT channel, or nullptr when the ATT fixed channel
+   * has less outstanding.
    */
   virtual EattChannel* GetChannelAvailableForClientRequest(
       const RawAddress& bd_addr);
@@ -267,6 +295,13 @@ class EattExtension {
    */
   virtual void StopAppIndicationTimer(const RawAddress& bd_addr, uint16_t cid);
 
+  /**
+   * Dumps the utilization of the EATT channels
+   *
+   * @param fd file descriptor to dump to
+   */
+  void Dump(int fd);
+
   /**
    * Starts the EattExtension module
    */
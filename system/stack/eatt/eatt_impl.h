@@ -17,8 +17,12 @@
 
 #include <base/logging.h>
 
+#include <algorithm>
+#include <list>
 #include <map>
 #include <queue>
+#include <tuple>
+#include <unordered_map>
 
 #include "acl_api.h"
 #include "bind_helpers.h"
@@ -38,6 +42,10 @@ namespace eatt {
 
 #define BLE_GATT_SVR_SUP_FEAT_EATT_BITMASK 0x01
 
+/* Channels opened to a device at most: the set opened on connection, and one
+ * more set opened when those cannot keep up with the client requests */
+#define EATT_MAX_CHANNELS (2 * L2CAP_CREDIT_BASED_MAX_CIDS)
+
 class eatt_device {
  public:
   RawAddress bda_;
@@ -48,14 +56,29 @@ class eatt_device {
 
   std::map<uint16_t, std::shared_ptr<EattChannel>> eatt_channels;
 
+  /* Last scheduling order handed to a channel */
+  uint32_t schedule_seq_;
+  /* Client requests in a row that found every channel busy */
+  uint16_t busy_requests_;
+  /* Whether more channels were opened on this connection */
+  bool grown_;
+
   eatt_device(const RawAddress& bd_addr, uint16_t mtu, uint16_t mps)
-      : rx_mtu_(mtu), rx_mps_(mps), eatt_tcb_(nullptr) {
+      : rx_mtu_(mtu),
+        rx_mps_(mps),
+        eatt_tcb_(nullptr),
+        schedule_seq_(0),
+        busy_requests_(0),
+        grown_(false) {
     bda_ = bd_addr;
   }
 };
 
 struct eatt_impl {
-  std::vector<eatt_device> devices_;
+  /* A list, as devices are referenced by pointer from devices_by_cid_ */
+  std::list<eatt_device> devices_;
+  /* Android CIDs are unique across the ACL connections */
+  std::unordered_map<uint16_t, eatt_device*> devices_by_cid_;
   uint16_t psm_;
   uint16_t default_mtu_;
   uint16_t max_mps_;
@@ -70,15 +93,8 @@ struct eatt_impl {
   ~eatt_impl() = default;
 
   eatt_device* find_device_by_cid(uint16_t lcid) {
-    /* This works only because Android CIDs are unique across the ACL
-     * connections */
-    auto iter = find_if(devices_.begin(), devices_.end(),
-                        [&lcid](const eatt_device& ed) {
-                          auto it = ed.eatt_channels.find(lcid);
-                          return it != ed.eatt_channels.end();
-                        });
-
-    return (iter == devices_.end()) ? nullptr : &(*iter);
+    auto iter = devices_by_cid_.find(lcid);
+    return (iter == devices_by_cid_.end()) ? nullptr : iter->second;
   }
 
   EattChannel* find_channel_by_cid(uint16_t lcid) {
@@ -90,17 +106,36 @@ struct eatt_impl {
   }
 
   EattChannel* find_channel_by_cid(const RawAddress& bdaddr, uint16_t lcid) {
-    eatt_device* eatt_dev = find_device_by_address(bdaddr);
-    if (!eatt_dev) return nullptr;
+    eatt_device* eatt_dev = find_device_by_cid(lcid);
+    if (!eatt_dev || eatt_dev->bda_ != bdaddr) return nullptr;
 
     auto it = eatt_dev->eatt_channels.find(lcid);
     return (it == eatt_dev->eatt_channels.end()) ? nullptr : it->second.get();
   }
 
+  EattChannel* add_channel(eatt_device* eatt_dev, uint16_t lcid,
+                           uint16_t tx_mtu) {
+    auto chan = std::make_shared<EattChannel>(eatt_dev->bda_, lcid, tx_mtu,
+                                              eatt_dev->rx_mtu_);
+    eatt_dev->eatt_channels.insert({lcid, chan});
+    devices_by_cid_[lcid] = eatt_dev;
+    return chan.get();
+  }
+
+  void reset_load(eatt_device* eatt_dev) {
+    eatt_dev->busy_requests_ = 0;
+    eatt_dev->grown_ = false;
+  }
+
   void remove_channel_by_cid(eatt_device* eatt_dev, uint16_t lcid) {
     eatt_dev->eatt_channels.erase(lcid);
+    devices_by_cid_.erase(lcid);
+    if (eatt_dev->eatt_tcb_) eatt_dev->eatt_tcb_->notif_q.RemoveBearer(lcid);
 
-    if (eatt_dev->eatt_channels.size() == 0) eatt_dev->eatt_tcb_ = NULL;
+    if (eatt_dev->eatt_channels.size() == 0) {
+      eatt_dev->eatt_tcb_ = NULL;
+      reset_load(eatt_dev);
+    }
   }
 
   void remove_channel_by_cid(uint16_t lcid) {
@@ -145,10 +180,7 @@ struct eatt_impl {
       EattChannel* channel = find_eatt_channel_by_cid(bda, cid);
       CHECK(!channel);
 
-      auto chan = std::make_shared<EattChannel>(eatt_dev->bda_, cid, peer_mtu,
-                                                eatt_dev->rx_mtu_);
-      eatt_dev->eatt_channels.insert({cid, chan});
-
+      EattChannel* chan = add_channel(eatt_dev, cid, peer_mtu);
       chan->EattChannelSetState(EattChannelState::EATT_CHANNEL_OPENED);
       eatt_dev->eatt_tcb_->eatt++;
 
@@ -278,6 +310,16 @@ struct eatt_impl {
     osi_free(data_p);
   }
 
+  void eatt_l2cap_congestion_cb(uint16_t lcid, bool congested) {
+    eatt_device* eatt_dev = find_device_by_cid(lcid);
+    if (!eatt_dev || !eatt_dev->eatt_tcb_) {
+      LOG(ERROR) << __func__ << " unknown cid: " << loghex(lcid);
+      return;
+    }
+
+    gatt_sr_notif_congestion(*eatt_dev->eatt_tcb_, lcid, congested);
+  }
+
   bool is_eatt_supported_by_peer(const RawAddress& bd_addr) {
     return gatt_profile_get_eatt_support(bd_addr);
   }
@@ -291,7 +333,7 @@ struct eatt_impl {
   }
 
   eatt_device* add_eatt_device(const RawAddress& bd_addr) {
-    devices_.push_back(eatt_device(bd_addr, default_mtu_, max_mps_));
+    devices_.emplace_back(bd_addr, default_mtu_, max_mps_);
     eatt_device* eatt_dev = &devices_.back();
     return eatt_dev;
   }
@@ -322,10 +364,7 @@ struct eatt_impl {
 
     for (uint16_t cid : connecting_cids) {
       LOG(INFO) << " \t cid: " << loghex(cid);
-
-      auto chan = std::make_shared<EattChannel>(eatt_dev->bda_, cid, 0,
-                                                eatt_dev->rx_mtu_);
-      eatt_dev->eatt_channels.insert({cid, chan});
+      add_channel(eatt_dev, cid, 0);
     }
 
     if (eatt_dev->eatt_tcb_) {
@@ -340,19 +379,7 @@ struct eatt_impl {
 
   EattChannel* find_eatt_channel_by_cid(const RawAddress& bd_addr,
                                         uint16_t cid) {
-    eatt_device* eatt_dev = find_device_by_address(bd_addr);
-
-    LOG(INFO) << __func__ << bd_addr << " " << +cid;
-
-    if (!eatt_dev) return nullptr;
-
-    auto iter = find_if(
-        eatt_dev->eatt_channels.begin(), eatt_dev->eatt_channels.end(),
-        [&cid](const std::pair<uint16_t, std::shared_ptr<EattChannel>>& el) {
-          return el.first == cid;
-        });
-
-    return iter == eatt_dev->eatt_channels.end() ? nullptr : iter->second.get();
+    return find_channel_by_cid(bd_addr, cid);
   }
 
   EattChannel* find_eatt_channel_by_transid(const RawAddress& bd_addr,
@@ -385,31 +412,119 @@ struct eatt_impl {
     return (iter != eatt_dev->eatt_channels.end());
   };
 
+  /* Packets L2CAP still holds for the channel */
+  static uint16_t l2cap_queued(const EattChannel& channel) {
+    return L2CA_FlushChannel(channel.cid_, L2CAP_FLUSH_CHANS_GET);
+  }
+
+  /* Returns the opened channel accepted by |usable| with the lowest |load|.
+   * Loads end with the scheduling order, so that equally loaded channels take
+   * turns. */
+  template <typename Usable, typename Load>
+  EattChannel* least_loaded_channel(eatt_device* eatt_dev, Usable usable,
+                                    Load load) {
+    EattChannel* best = nullptr;
+    decltype(load(*best)) best_load{};
+    for (const auto& el : eatt_dev->eatt_channels) {
+      EattChannel& channel = *el.second;
+      if (channel.state_ != EattChannelState::EATT_CHANNEL_OPENED) continue;
+      if (!usable(channel)) continue;
+
+      auto channel_load = load(channel);
+      if (!best || channel_load < best_load) {
+        best = &channel;
+        best_load = channel_load;
+      }
+    }
+    return best;
+  }
+
+  void schedule(eatt_device* eatt_dev, EattChannel* channel) {
+    channel->last_scheduled_ = ++eatt_dev->schedule_seq_;
+  }
+
   EattChannel* get_channel_available_for_indication(const RawAddress& bd_addr) {
     eatt_device* eatt_dev = find_device_by_address(bd_addr);
-    auto iter = find_if(
-        eatt_dev->eatt_channels.begin(), eatt_dev->eatt_channels.end(),
-        [](const std::pair<uint16_t, std::shared_ptr<EattChannel>>& el) {
-          return !GATT_HANDLE_IS_VALID(el.second->indicate_handle_);
-        });
+    if (!eatt_dev) return nullptr;
 
-    return (iter == eatt_dev->eatt_channels.end()) ? nullptr
-                                                   : iter->second.get();
+    EattChannel* channel = least_loaded_channel(
+        eatt_dev,
+        [](const EattChannel& c) {
+          return !GATT_HANDLE_IS_VALID(c.indicate_handle_);
+        },
+        [](const EattChannel& c) {
+          return std::make_tuple(l2cap_queued(c), c.last_scheduled_);
+        });
+    if (channel) schedule(eatt_dev, channel);
+    return channel;
   };
 
+  EattChannel* get_channel_available_for_notification(
+      const RawAddress& bd_addr, uint16_t len) {
+    eatt_device* eatt_dev = find_device_by_address(bd_addr);
+    if (!eatt_dev || !eatt_dev->eatt_tcb_) return nullptr;
+
+    /* Avoid congested channels, then those a value of |len| would be
+     * truncated on */
+    const GattNotificationQueue& notif_q = eatt_dev->eatt_tcb_->notif_q;
+    EattChannel* channel = least_loaded_channel(
+        eatt_dev, [](const EattChannel& c) { return true; },
+        [&notif_q, len](const EattChannel& c) {
+          return std::make_tuple(notif_q.IsCongested(c.cid_),
+                                 c.tx_mtu_ < GATT_HDR_SIZE + len,
+                                 l2cap_queued(c), c.last_scheduled_);
+        });
+    if (channel) schedule(eatt_dev, channel);
+    return channel;
+  }
+
+  /* Every channel had a client request outstanding: when this lasts, open
+   * another set of channels */
+  void on_channels_busy(eatt_device* eatt_dev) {
+    if (++eatt_dev->busy_requests_ < EATT_BUSY_REQUESTS_TO_GROW) return;
+    eatt_dev->busy_requests_ = 0;
+
+    if (eatt_dev->grown_) return;
+    if (eatt_dev->eatt_channels.size() + L2CAP_CREDIT_BASED_MAX_CIDS >
+        EATT_MAX_CHANNELS)
+      return;
+    if (L2CA_GetBleConnRole(eatt_dev->bda_) != HCI_ROLE_CENTRAL) return;
+
+    LOG(INFO) << __func__ << " " << eatt_dev->bda_ << " all "
+              << +eatt_dev->eatt_channels.size()
+              << " channels busy, opening more";
+    eatt_dev->grown_ = true;
+    connect_eatt(eatt_dev);
+  }
+
   EattChannel* get_channel_available_for_client_request(
       const RawAddress& bd_addr) {
     eatt_device* eatt_dev = find_device_by_address(bd_addr);
     if (!eatt_dev) return nullptr;
 
-    auto iter = find_if(
-        eatt_dev->eatt_channels.begin(), eatt_dev->eatt_channels.end(),
-        [](const std::pair<uint16_t, std::shared_ptr<EattChannel>>& el) {
-          return el.second->cl_cmd_q_.empty();
+    EattChannel* channel = least_loaded_channel(
+        eatt_dev, [](const EattChannel& c) { return true; },
+        [](const EattChannel& c) {
+          return std::make_tuple(c.cl_cmd_q_.size(), l2cap_queued(c),
+                                 c.last_scheduled_);
         });
+    if (!channel) return nullptr;
 
-    return (iter == eatt_dev->eatt_channels.end()) ? nullptr
-                                                   : iter->second.get();
+    if (channel->cl_cmd_q_.empty()) {
+      eatt_dev->busy_requests_ = 0;
+    } else {
+      on_channels_busy(eatt_dev);
+      /* Wait on the ATT fixed channel instead when it has less outstanding */
+      if (eatt_dev->eatt_tcb_ &&
+          eatt_dev->eatt_tcb_->cl_cmd_q.size() < channel->cl_cmd_q_.size())
+        return nullptr;
+    }
+
+    schedule(eatt_dev, channel);
+    channel->cl_requests_++;
+    channel->max_cl_queued_ =
+        std::max(channel->max_cl_queued_, channel->cl_cmd_q_.size() + 1);
+    return channel;
   }
 
   void free_gatt_resources(const RawAddress& bd_addr) {
@@ -620,10 +735,13 @@ struct eatt_impl {
       /* When initiating disconnection, stack will not notify us that it is
        * done. We need to assume success
        */
+      devices_by_cid_.erase(cid);
+      eatt_dev->eatt_tcb_->notif_q.RemoveBearer(cid);
       iter = eatt_dev->eatt_channels.erase(iter);
     }
     eatt_dev->eatt_tcb_->eatt = 0;
     eatt_dev->eatt_tcb_ = nullptr;
+    reset_load(eatt_dev);
   }
 
   void connect(const RawAddress& bd_addr) {
@@ -27,6 +27,7 @@
 #include "l2c_api.h"
 #include "osi/include/allocator.h"
 #include "osi/include/log.h"
+#include "stack/eatt/eatt.h"
 #include "stack/include/bt_hdr.h"
 #include "stack/include/bt_types.h"
 #include "types/bluetooth/uuid.h"
@@ -39,6 +40,8 @@
 
 using base::StringPrintf;
 using bluetooth::Uuid;
+using bluetooth::eatt::EattChannel;
+using bluetooth::eatt::EattExtension;
 /**********************************************************************
  *   ATT protocl message building utility                              *
  **********************************************************************/
@@ -339,6 +342,14 @@ tGATT_STATUS attp_send_msg_to_l2cap(tGATT_TCB& tcb, uint16_t lcid,
     l2cap_ret = L2CA_SendFixedChnlData(lcid, tcb.peer_bda, p_toL2CAP);
   } else {
     LOG_DEBUG("Sending ATT message on lcid:%hu", lcid);
+    EattChannel* channel =
+        tcb.eatt ? EattExtension::GetInstance()->FindEattChannelByCid(
+                       tcb.peer_bda, lcid)
+                 : nullptr;
+    if (channel) {
+      channel->tx_pdus_++;
+      channel->tx_bytes_ += p_toL2CAP->len;
+    }
     l2cap_ret = (uint16_t)L2CA_DataWrite(lcid, p_toL2CAP);
   }
 
@@ -347,6 +358,8 @@ tGATT_STATUS attp_send_msg_to_l2cap(tGATT_TCB& tcb, uint16_t lcid,
     return GATT_INTERNAL_ERROR;
   } else if (l2cap_ret == L2CAP_DW_CONGESTED) {
     VLOG(1) << StringPrintf("ATT congested, message accepted");
+    /* Hold notifications back until L2CAP reports the channel relieved */
+    gatt_sr_notif_congestion(tcb, lcid, true);
     return GATT_CONGESTED;
   }
   return GATT_SUCCESS;
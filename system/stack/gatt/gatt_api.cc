@@ -492,13 +492,13 @@ tGATT_STATUS GATTS_HandleValueIndication(uint16_t conn_id, uint16_t attr_handle,
  *                  val_len: Length of the indicated attribute value.
  *                  p_val: Pointer to the indicated attribute value data.
  *
- * Returns          GATT_SUCCESS if sucessfully sent; otherwise error code.
+ * Returns          GATT_SUCCESS if sucessfully sent, GATT_CONGESTED if sent or
+ *                  queued while the bearer is congested; otherwise error code.
  *
  ******************************************************************************/
 tGATT_STATUS GATTS_HandleValueNotification(uint16_t conn_id,
                                            uint16_t attr_handle,
                                            uint16_t val_len, uint8_t* p_val) {
-  tGATT_VALUE notif;
   tGATT_IF gatt_if = GATT_GET_GATT_IF(conn_id);
   uint8_t tcb_idx = GATT_GET_TCB_IDX(conn_id);
   tGATT_REG* p_reg = gatt_get_regcb(gatt_if);
@@ -515,25 +515,63 @@ tGATT_STATUS GATTS_HandleValueNotification(uint16_t conn_id,
     return GATT_ILLEGAL_PARAMETER;
   }
 
-  memset(&notif, 0, sizeof(notif));
-  notif.handle = attr_handle;
-  notif.len = val_len;
-  memcpy(notif.value, p_val, val_len);
-  notif.auth_req = GATT_AUTH_REQ_NONE;
+  uint16_t cid =
+      gatt_tcb_get_cid_for_notification(*p_tcb, p_reg->eatt_support, val_len);
 
-  tGATT_STATUS cmd_sent;
-  tGATT_SR_MSG gatt_sr_msg;
-  gatt_sr_msg.attr_value = notif;
+  return gatt_sr_send_notification(*p_tcb, cid, p_reg->notif_supersede,
+                                   attr_handle, val_len, p_val);
+}
+
+/*******************************************************************************
+ *
+ * Function         GATTS_SetNotificationSupersede
+ *
+ * Description      This function lets notifications of an application, held
+ *                  back by a congested bearer, be replaced by a newer value
+ *                  for the same attribute rather than queued behind it.
+ *
+ * Parameter        gatt_if: application interface.
+ *                  supersede: whether only the latest value matters.
+ *
+ * Returns          None.
+ *
+ ******************************************************************************/
+void GATTS_SetNotificationSupersede(tGATT_IF gatt_if, bool supersede) {
+  tGATT_REG* p_reg = gatt_get_regcb(gatt_if);
+  if (p_reg == NULL) {
+    LOG(ERROR) << __func__ << ": unknown gatt_if: " << +gatt_if;
+    return;
+  }
+  p_reg->notif_supersede = supersede;
+}
+
+/*******************************************************************************
+ *
+ * Function         GATTS_DumpNotificationStats
+ *
+ * Description      This function dumps the counters of the notifications sent
+ *                  over each connection.
+ *
+ * Parameter        fd: file descriptor to dump to.
+ *
+ * Returns          None.
+ *
+ ******************************************************************************/
+void GATTS_DumpNotificationStats(int fd) {
+  GattNotificationStats total = gatt_cb.closed_notif_stats;
 
-  uint16_t cid = gatt_tcb_get_att_cid(*p_tcb, p_reg->eatt_support);
+  dprintf(fd, "\nGATT server notifications:\n");
+  for (int i = 0; i < GATT_MAX_PHY_CHANNEL; i++) {
+    tGATT_TCB& tcb = gatt_cb.tcb[i];
+    if (!tcb.in_use) continue;
 
-  BT_HDR* p_buf =
-      attp_build_sr_msg(*p_tcb, GATT_HANDLE_VALUE_NOTIF, &gatt_sr_msg);
-  if (p_buf != NULL) {
-    cmd_sent = attp_send_sr_msg(*p_tcb, cid, p_buf);
-  } else
-    cmd_sent = GATT_NO_RESOURCES;
-  return cmd_sent;
+    dprintf(fd, "  %s multi_notif:%d depth:%zu %s\n",
+            PRIVATE_ADDRESS(tcb.peer_bda),
+            gatt_sr_is_cl_multi_notif_supported(tcb), tcb.notif_q.Depth(),
+            tcb.notif_q.stats().ToString().c_str());
+    total += tcb.notif_q.stats();
+  }
+  dprintf(fd, "  total %s\n", total.ToString().c_str());
 }
 
 /*******************************************************************************
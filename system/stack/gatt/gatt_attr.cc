@@ -855,6 +855,20 @@ bool gatt_sr_is_cl_change_aware(tGATT_TCB& tcb) {
   return tcb.is_robust_cache_change_aware;
 }
 
+/*******************************************************************************
+ *
+ * Function         gatt_sr_is_cl_multi_notif_supported
+ *
+ * Description      Check if the client takes Multiple Handle Value
+ *                  Notifications
+ *
+ * Returns          true if supported by client side, otherwise false
+ *
+ ******************************************************************************/
+bool gatt_sr_is_cl_multi_notif_supported(tGATT_TCB& tcb) {
+  return (tcb.cl_supp_feat & BLE_GATT_CL_SUP_FEAT_MULTI_NOTIF_BITMASK);
+}
+
 /*******************************************************************************
  *
  * Function         gatt_sr_init_cl_status
@@ -196,8 +196,9 @@ void gatt_act_read(tGATT_CLCB* p_clcb, uint16_t offset) {
       break;
 
     case GATT_READ_MULTIPLE:
-      op_code = GATT_REQ_READ_MULTI;
       memcpy(&msg.read_multi, p_clcb->p_attr_buf, sizeof(tGATT_READ_MULTI));
+      op_code = msg.read_multi.variable_len ? GATT_REQ_READ_MULTI_VAR
+                                            : GATT_REQ_READ_MULTI;
       break;
 
     case GATT_READ_INC_SRV_UUID128:
@@ -996,7 +997,8 @@ void gatt_process_read_rsp(tGATT_TCB& tcb, tGATT_CLCB* p_clcb,
 
   if (p_clcb->operation == GATTC_OPTYPE_READ) {
     if (p_clcb->op_subtype != GATT_READ_BY_HANDLE) {
-      p_clcb->counter = len;
+      /* Read Multiple responses may be as long as the MTU allows */
+      p_clcb->counter = std::min(len, (uint16_t)GATT_MAX_ATTR_LEN);
       gatt_end_operation(p_clcb, GATT_SUCCESS, (void*)p);
     } else {
       /* allocate GKI buffer holding up long attribute value  */
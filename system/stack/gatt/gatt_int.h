@@ -33,6 +33,7 @@
 #include "btu.h"
 #include "gatt_api.h"
 #include "osi/include/fixed_queue.h"
+#include "stack/gatt/notification_queue.h"
 #include "stack/include/bt_hdr.h"
 #include "types/bluetooth/uuid.h"
 #include "types/raw_address.h"
@@ -198,6 +199,7 @@ typedef struct {
   bool in_use{false};
   uint8_t listening{0}; /* if adv for all has been enabled */
   bool eatt_support{false};
+  bool notif_supersede{false}; /* queued notifications replaced by newer ones */
   std::string name;
 } tGATT_REG;
 
@@ -333,6 +335,9 @@ typedef struct {
   std::queue<tGATT_CMD_Q> cl_cmd_q;
   alarm_t* ind_ack_timer; /* local app confirm to indication timer */
 
+  /* notifications held back by congested bearers */
+  GattNotificationQueue notif_q;
+
   // TODO(hylo): support byte array data
   /* Client supported feature*/
   uint8_t cl_supp_feat;
@@ -445,6 +450,9 @@ typedef struct {
   tGATT_APPL_INFO cb_info;
 
   tGATT_HDL_CFG hdl_cfg;
+
+  /* notifications sent over connections since closed */
+  GattNotificationStats closed_notif_stats;
 } tGATT_CB;
 
 #define GATT_SIZE_OF_SRV_CHG_HNDL_RANGE 4
@@ -487,6 +495,7 @@ extern bool gatt_cl_read_sr_supp_feat_req(
     base::OnceCallback<void(const RawAddress&, uint8_t)> cb);
 
 extern bool gatt_sr_is_cl_change_aware(tGATT_TCB& tcb);
+extern bool gatt_sr_is_cl_multi_notif_supported(tGATT_TCB& tcb);
 extern void gatt_sr_init_cl_status(tGATT_TCB& tcb);
 extern void gatt_sr_update_cl_status(tGATT_TCB& tcb, bool chg_unaware);
 
@@ -566,6 +575,11 @@ extern void gatt_sr_send_req_callback(uint16_t conn_id, uint32_t trans_id,
                                       uint8_t op_code, tGATTS_DATA* p_req_data);
 extern uint32_t gatt_sr_enqueue_cmd(tGATT_TCB& tcb, uint16_t cid,
                                     uint8_t op_code, uint16_t handle);
+extern tGATT_STATUS gatt_sr_send_notification(tGATT_TCB& tcb, uint16_t cid,
+                                              bool supersede, uint16_t handle,
+                                              uint16_t len, uint8_t* p_val);
+extern void gatt_sr_notif_congestion(tGATT_TCB& tcb, uint16_t cid,
+                                     bool congested);
 extern bool gatt_cancel_open(tGATT_IF gatt_if, const RawAddress& bda);
 extern void gatt_notify_phy_updated(tGATT_STATUS status, uint16_t handle,
                                     uint8_t tx_phy, uint8_t rx_phy);
@@ -583,6 +597,9 @@ extern bool gatt_tcb_get_cid_available_for_indication(
 extern bool gatt_tcb_find_indicate_handle(tGATT_TCB& tcb, uint16_t cid,
                                           uint16_t* indicated_handle_p);
 extern uint16_t gatt_tcb_get_att_cid(tGATT_TCB& tcb, bool eatt_support);
+extern uint16_t gatt_tcb_get_cid_for_notification(tGATT_TCB& tcb,
+                                                  bool eatt_support,
+                                                  uint16_t len);
 extern uint16_t gatt_tcb_get_payload_size_tx(tGATT_TCB& tcb, uint16_t cid);
 extern uint16_t gatt_tcb_get_payload_size_rx(tGATT_TCB& tcb, uint16_t cid);
 extern void gatt_clcb_dealloc(tGATT_CLCB* p_clcb);
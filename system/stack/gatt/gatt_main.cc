@@ -501,11 +501,14 @@ static void gatt_le_connect_cback(uint16_t chan, const RawAddress& bd_addr,
 }
 
 /** This function is called to process the congestion callback from lcb */
-static void gatt_channel_congestion(tGATT_TCB* p_tcb, bool congested) {
+static void gatt_channel_congestion(tGATT_TCB* p_tcb, uint16_t cid,
+                                    bool congested) {
   uint8_t i = 0;
   tGATT_REG* p_reg = NULL;
   uint16_t conn_id;
 
+  if (p_tcb != NULL) gatt_sr_notif_congestion(*p_tcb, cid, congested);
+
   /* if uncongested, check to see if there is any more pending data */
   if (p_tcb != NULL && !congested) {
     gatt_cl_send_next_cmd_inq(*p_tcb);
@@ -568,7 +571,7 @@ static void gatt_le_cong_cback(const RawAddress& remote_bda, bool congested) {
   if (!p_tcb) return;
 
   /* if uncongested, check to see if there is any more pending data */
-    gatt_channel_congestion(p_tcb, congested);
+    gatt_channel_congestion(p_tcb, L2CAP_ATT_CID, congested);
 }
 
 /*******************************************************************************
@@ -766,7 +769,7 @@ static void gatt_l2cif_congest_cback(uint16_t lcid, bool congested) {
   tGATT_TCB* p_tcb = gatt_find_tcb_by_cid(lcid);
 
   if (p_tcb != NULL) {
-    gatt_channel_congestion(p_tcb, congested);
+    gatt_channel_congestion(p_tcb, lcid, congested);
   }
 }
 
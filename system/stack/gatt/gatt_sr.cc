@@ -89,6 +89,56 @@ uint32_t gatt_sr_enqueue_cmd(tGATT_TCB& tcb, uint16_t cid, uint8_t op_code,
   return trans_id;
 }
 
+/* Send the notifications queued on a bearer, coalesced if the client takes
+ * Multiple Handle Value Notifications */
+static tGATT_STATUS gatt_sr_flush_notif(tGATT_TCB& tcb, uint16_t cid) {
+  return tcb.notif_q.Flush(
+      cid, gatt_tcb_get_payload_size_tx(tcb, cid),
+      gatt_sr_is_cl_multi_notif_supported(tcb), [&tcb, cid](BT_HDR* p_buf) {
+        return attp_send_msg_to_l2cap(tcb, cid, p_buf);
+      });
+}
+
+/*******************************************************************************
+ *
+ * Function         gatt_sr_send_notification
+ *
+ * Description      This function sends a handle value notification on a
+ *                  bearer, or queues it while the bearer is congested.
+ *
+ * Returns          GATT_SUCCESS if sent, GATT_CONGESTED if sent or queued on
+ *                  a congested bearer, GATT_BUSY if too many notifications are
+ *                  queued already; otherwise error code.
+ *
+ ******************************************************************************/
+tGATT_STATUS gatt_sr_send_notification(tGATT_TCB& tcb, uint16_t cid,
+                                       bool supersede, uint16_t handle,
+                                       uint16_t len, uint8_t* p_val) {
+  if (!tcb.notif_q.Enqueue(cid, handle, p_val, len, supersede)) {
+    LOG(WARNING) << __func__ << ": too many notifications queued for "
+                 << tcb.peer_bda;
+    return GATT_BUSY;
+  }
+
+  if (tcb.notif_q.IsCongested(cid)) return GATT_CONGESTED;
+  return gatt_sr_flush_notif(tcb, cid);
+}
+
+/*******************************************************************************
+ *
+ * Function         gatt_sr_notif_congestion
+ *
+ * Description      This function tracks the congestion of a bearer, and sends
+ *                  the notifications queued on it once relieved.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+void gatt_sr_notif_congestion(tGATT_TCB& tcb, uint16_t cid, bool congested) {
+  tcb.notif_q.SetCongested(cid, congested);
+  if (!congested && tcb.notif_q.HasPending(cid)) gatt_sr_flush_notif(tcb, cid);
+}
+
 /*******************************************************************************
  *
  * Function         gatt_sr_cmd_empty
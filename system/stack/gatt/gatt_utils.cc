@@ -1109,6 +1109,32 @@ uint16_t gatt_tcb_get_att_cid(tGATT_TCB& tcb, bool eatt_support) {
   return tcb.att_lcid;
 }
 
+/*******************************************************************************
+ *
+ * Function         gatt_tcb_get_cid_for_notification
+ *
+ * Description      This function gets cid to send a notification of |len|
+ *                  octets on
+ *
+ * Returns          Least loaded CID
+ *
+ ******************************************************************************/
+uint16_t gatt_tcb_get_cid_for_notification(tGATT_TCB& tcb, bool eatt_support,
+                                           uint16_t len) {
+  if (eatt_support && tcb.eatt) {
+    EattChannel* channel =
+        EattExtension::GetInstance()->GetChannelAvailableForNotification(
+            tcb.peer_bda, len);
+    /* Only fall back to the ATT fixed channel when all EATT ones are
+     * congested */
+    if (channel && (!tcb.notif_q.IsCongested(channel->cid_) ||
+                    tcb.notif_q.IsCongested(tcb.att_lcid))) {
+      return channel->cid_;
+    }
+  }
+  return tcb.att_lcid;
+}
+
 /*******************************************************************************
  *
  * Function         gatt_tcb_get_payload_size_tx
@@ -1574,6 +1600,7 @@ void gatt_cleanup_upon_disc(const RawAddress& bda, tGATT_DISCONN_REASON reason,
   gatt_free_pending_ind(p_tcb);
   fixed_queue_free(p_tcb->sr_cmd.multi_rsp_q, NULL);
   p_tcb->sr_cmd.multi_rsp_q = NULL;
+  gatt_cb.closed_notif_stats += p_tcb->notif_q.stats();
 
   for (uint8_t i = 0; i < GATT_MAX_APPS; i++) {
     tGATT_REG* p_reg = &gatt_cb.cl_rcb[i];
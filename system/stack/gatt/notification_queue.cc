@@ -0,0 +1,198 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "stack/gatt/notification_queue.h"
+
+#include <base/strings/stringprintf.h>
+
+#include <algorithm>
+
+#include "osi/include/allocator.h"
+#include "stack/include/bt_types.h"
+#include "stack/include/l2c_api.h"
+
+namespace {
+
+/* Opcode and handle of a Handle Value Notification */
+constexpr size_t kNotifHeaderSize = 3;
+/* Handle and length of each value in a Multiple Handle Value Notification */
+constexpr size_t kMultiNotifTupleHeaderSize = 4;
+
+}  // namespace
+
+double GattNotificationStats::CoalescingRatio() const {
+  return pdus ? static_cast<double>(sent) / pdus : 0;
+}
+
+GattNotificationStats& GattNotificationStats::operator+=(
+    const GattNotificationStats& other) {
+  enqueued += other.enqueued;
+  sent += other.sent;
+  pdus += other.pdus;
+  multi_pdus += other.multi_pdus;
+  superseded += other.superseded;
+  rejected += other.rejected;
+  dropped += other.dropped;
+  congestions += other.congestions;
+  max_depth = std::max(max_depth, other.max_depth);
+  return *this;
+}
+
+std::string GattNotificationStats::ToString() const {
+  return base::StringPrintf(
+      "enqueued:%llu sent:%llu pdus:%llu multi_pdus:%llu "
+      "coalescing_ratio:%.2f superseded:%llu rejected:%llu dropped:%llu "
+      "congestions:%llu max_depth:%zu",
+      (unsigned long long)enqueued, (unsigned long long)sent,
+      (unsigned long long)pdus, (unsigned long long)multi_pdus,
+      CoalescingRatio(), (unsigned long long)superseded,
+      (unsigned long long)rejected, (unsigned long long)dropped,
+      (unsigned long long)congestions, max_depth);
+}
+
+bool GattNotificationQueue::Enqueue(uint16_t cid, uint16_t handle,
+                                    const uint8_t* p_value, uint16_t len,
+                                    bool supersede) {
+  std::deque<Notification>& queue = queues_[cid];
+
+  if (supersede) {
+    auto it = std::find_if(
+        queue.begin(), queue.end(),
+        [handle](const Notification& notif) { return notif.handle == handle; });
+    if (it != queue.end()) {
+      it->value.assign(p_value, p_value + len);
+      stats_.enqueued++;
+      stats_.superseded++;
+      return true;
+    }
+  }
+
+  if (depth_ >= kMaxQueued) {
+    stats_.rejected++;
+    return false;
+  }
+
+  queue.push_back({handle, std::vector<uint8_t>(p_value, p_value + len)});
+  depth_++;
+  stats_.enqueued++;
+  stats_.max_depth = std::max(stats_.max_depth, depth_);
+  return true;
+}
+
+tGATT_STATUS GattNotificationQueue::Flush(uint16_t cid, uint16_t mtu,
+                                          bool multi_notif,
+                                          const SendCallback& send) {
+  auto it = queues_.find(cid);
+  if (it == queues_.end()) return GATT_SUCCESS;
+
+  std::deque<Notification>& queue = it->second;
+  tGATT_STATUS result = GATT_SUCCESS;
+  while (!queue.empty() && !IsCongested(cid)) {
+    size_t count;
+    BT_HDR* p_buf = BuildPdu(queue, mtu, multi_notif, &count);
+    tGATT_STATUS status = send(p_buf);
+
+    /* The PDU belongs to L2CAP now, whether it made it or not */
+    queue.erase(queue.begin(), queue.begin() + count);
+    depth_ -= count;
+
+    if (status == GATT_SUCCESS || status == GATT_CONGESTED) {
+      stats_.sent += count;
+      stats_.pdus++;
+      if (count > 1) stats_.multi_pdus++;
+    } else {
+      stats_.dropped += count;
+      result = status;
+    }
+    if (status == GATT_CONGESTED) SetCongested(cid, true);
+  }
+
+  if (queue.empty()) queues_.erase(it);
+  return IsCongested(cid) ? GATT_CONGESTED : result;
+}
+
+void GattNotificationQueue::SetCongested(uint16_t cid, bool congested) {
+  if (!congested) {
+    congested_.erase(cid);
+  } else if (congested_.insert(cid).second) {
+    stats_.congestions++;
+  }
+}
+
+bool GattNotificationQueue::HasPending(uint16_t cid) const {
+  auto it = queues_.find(cid);
+  return it != queues_.end() && !it->second.empty();
+}
+
+void GattNotificationQueue::RemoveBearer(uint16_t cid) {
+  auto it = queues_.find(cid);
+  if (it != queues_.end()) {
+    depth_ -= it->second.size();
+    stats_.dropped += it->second.size();
+    queues_.erase(it);
+  }
+  congested_.erase(cid);
+}
+
+/* Build the next PDU out of the front of |queue|: as many values as fit in a
+ * Multiple Handle Value Notification, or a Handle Value Notification if no
+ * two of them do. */
+BT_HDR* GattNotificationQueue::BuildPdu(const std::deque<Notification>& queue,
+                                        uint16_t mtu, bool multi_notif,
+                                        size_t* count) const {
+  size_t len = 1;
+  size_t fits = 0;
+  if (multi_notif) {
+    for (const Notification& notif : queue) {
+      size_t tuple_len = kMultiNotifTupleHeaderSize + notif.value.size();
+      if (len + tuple_len > mtu) break;
+      len += tuple_len;
+      fits++;
+    }
+  }
+
+  if (fits < 2) {
+    const Notification& notif = queue.front();
+    size_t value_len = std::min(notif.value.size(),
+                                mtu > kNotifHeaderSize
+                                    ? size_t{mtu} - kNotifHeaderSize
+                                    : size_t{0});
+    BT_HDR* p_buf = (BT_HDR*)osi_malloc(sizeof(BT_HDR) + L2CAP_MIN_OFFSET +
+                                        kNotifHeaderSize + value_len);
+    p_buf->offset = L2CAP_MIN_OFFSET;
+    p_buf->len = kNotifHeaderSize + value_len;
+    uint8_t* p = (uint8_t*)(p_buf + 1) + L2CAP_MIN_OFFSET;
+    UINT8_TO_STREAM(p, GATT_HANDLE_VALUE_NOTIF);
+    UINT16_TO_STREAM(p, notif.handle);
+    ARRAY_TO_STREAM(p, notif.value.data(), (int)value_len);
+    *count = 1;
+    return p_buf;
+  }
+
+  BT_HDR* p_buf = (BT_HDR*)osi_malloc(sizeof(BT_HDR) + L2CAP_MIN_OFFSET + len);
+  p_buf->offset = L2CAP_MIN_OFFSET;
+  p_buf->len = len;
+  uint8_t* p = (uint8_t*)(p_buf + 1) + L2CAP_MIN_OFFSET;
+  UINT8_TO_STREAM(p, GATT_HANDLE_MULTI_VALUE_NOTIF);
+  for (size_t i = 0; i < fits; i++) {
+    const Notification& notif = queue[i];
+    UINT16_TO_STREAM(p, notif.handle);
+    UINT16_TO_STREAM(p, notif.value.size());
+    ARRAY_TO_STREAM(p, notif.value.data(), (int)notif.value.size());
+  }
+  *count = fits;
+  return p_buf;
+}
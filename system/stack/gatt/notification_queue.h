@@ -0,0 +1,106 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "stack/include/bt_hdr.h"
+#include "stack/include/gatt_api.h"
+
+/* Counters of the notifications sent by the server over a connection */
+struct GattNotificationStats {
+  uint64_t enqueued = 0;    /* notifications passed down by applications */
+  uint64_t sent = 0;        /* notifications sent, in whatever PDU */
+  uint64_t pdus = 0;        /* ATT PDUs they were sent in */
+  uint64_t multi_pdus = 0;  /* of which Multiple Handle Value Notifications */
+  uint64_t superseded = 0;  /* replaced by a newer value before being sent */
+  uint64_t rejected = 0;    /* refused, the queue being full */
+  uint64_t dropped = 0;     /* lost to L2CAP failures */
+  uint64_t congestions = 0; /* times a bearer reported being congested */
+  size_t max_depth = 0;     /* highest number of notifications queued */
+
+  /* Average number of notifications carried by each PDU */
+  double CoalescingRatio() const;
+  GattNotificationStats& operator+=(const GattNotificationStats& other);
+  std::string ToString() const;
+};
+
+/*
+ * The notifications a GATT server has pending towards a client, per ATT
+ * bearer.
+ *
+ * A notification is sent right away while its bearer takes data. Once L2CAP
+ * reports the bearer congested, notifications wait here rather than being
+ * refused by L2CAP, and go out when it is relieved: several at once in
+ * Multiple Handle Value Notifications if the client supports them, and with
+ * values superseded by a newer one for the same handle dropped, for
+ * applications that asked for it.
+ */
+class GattNotificationQueue {
+ public:
+  /* Bound on the notifications queued over a connection, beyond which
+   * applications are pushed back */
+  static constexpr size_t kMaxQueued = 256;
+
+  /* Hands an ATT PDU over to L2CAP for a bearer */
+  using SendCallback = std::function<tGATT_STATUS(BT_HDR* p_buf)>;
+
+  /* Queue a notification for |cid|. Returns false if the queue is full. */
+  bool Enqueue(uint16_t cid, uint16_t handle, const uint8_t* p_value,
+               uint16_t len, bool supersede);
+
+  /* Send what is queued for |cid|, in PDUs of up to |mtu| octets, until
+   * L2CAP reports the bearer congested. Returns GATT_CONGESTED if it did,
+   * GATT_SUCCESS otherwise. */
+  tGATT_STATUS Flush(uint16_t cid, uint16_t mtu, bool multi_notif,
+                     const SendCallback& send);
+
+  void SetCongested(uint16_t cid, bool congested);
+  bool IsCongested(uint16_t cid) const { return congested_.count(cid) != 0; }
+
+  /* Whether anything is queued for |cid| */
+  bool HasPending(uint16_t cid) const;
+
+  /* Number of notifications queued over all bearers */
+  size_t Depth() const { return depth_; }
+
+  /* Forget what was queued for a bearer that got closed */
+  void RemoveBearer(uint16_t cid);
+
+  const GattNotificationStats& stats() const { return stats_; }
+
+ private:
+  struct Notification {
+    uint16_t handle;
+    std::vector<uint8_t> value;
+  };
+
+  BT_HDR* BuildPdu(const std::deque<Notification>& queue, uint16_t mtu,
+                   bool multi_notif, size_t* count) const;
+
+  std::map<uint16_t, std::deque<Notification>> queues_;
+  std::set<uint16_t> congested_;
+  size_t depth_ = 0;
+  GattNotificationStats stats_;
+};
@@ -857,7 +857,8 @@ extern tGATT_STATUS GATTS_HandleValueIndication(uint16_t conn_id,
  *                  val_len: Length of the indicated attribute value.
  *                  p_val: Pointer to the indicated attribute value data.
  *
- * Returns          GATT_SUCCESS if sucessfully sent; otherwise error code.
+ * Returns          GATT_SUCCESS if sucessfully sent, GATT_CONGESTED if sent or
+ *                  queued while the bearer is congested; otherwise error code.
  *
  ******************************************************************************/
 extern tGATT_STATUS GATTS_HandleValueNotification(uint16_t conn_id,
@@ -865,6 +866,36 @@ extern tGATT_STATUS GATTS_HandleValueNotification(uint16_t conn_id,
                                                   uint16_t val_len,
                                                   uint8_t* p_val);
 
+/*******************************************************************************
+ *
+ * Function         GATTS_SetNotificationSupersede
+ *
+ * Description      This function lets notifications of an application, held
+ *                  back by a congested bearer, be replaced by a newer value
+ *                  for the same attribute rather than queued behind it.
+ *
+ * Parameter        gatt_if: application interface.
+ *                  supersede: whether only the latest value matters.
+ *
+ * Returns          None.
+ *
+ ******************************************************************************/
+extern void GATTS_SetNotificationSupersede(tGATT_IF gatt_if, bool supersede);
+
+/*******************************************************************************
+ *
+ * Function         GATTS_DumpNotificationStats
+ *
+ * Description      This function dumps the counters of the notifications sent
+ *                  over each connection.
+ *
+ * Parameter        fd: file descriptor to dump to.
+ *
+ * Returns          None.
+ *
+ ******************************************************************************/
+extern void GATTS_DumpNotificationStats(int fd);
+
 /*******************************************************************************
  *
  * Function         GATTS_SendRsp
@@ -32,6 +32,9 @@ bool acl_create_le_connection(const RawAddress& bd_addr);
 bool acl_create_le_connection_with_id(uint8_t id, const RawAddress& bd_addr);
 void acl_reject_connection_request(const RawAddress& bd_addr, uint8_t reason);
 void acl_send_data_packet_br_edr(const RawAddress& bd_addr, BT_HDR* p_buf);
+// Sends |p_buf| without taking it: the caller keeps it, e.g. for retransmission
+void acl_send_shared_data_packet_br_edr(const RawAddress& bd_addr,
+                                        const BT_HDR* p_buf);
 void acl_send_data_packet_ble(const RawAddress& bd_addr, BT_HDR* p_buf);
 void acl_write_automatic_flush_timeout(const RawAddress& bd_addr,
                                        uint16_t flush_timeout);
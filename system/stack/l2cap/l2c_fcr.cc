@@ -212,15 +212,16 @@ void l2c_fcr_cleanup(tL2C_CCB* p_ccb) {
 
   osi_free_and_reset((void**)&p_fcrb->p_rx_sdu);
 
+  /* retrans_q only refers to buffers owned by waiting_for_ack_q */
+  fixed_queue_free(p_fcrb->retrans_q, NULL);
+  p_fcrb->retrans_q = NULL;
+
   fixed_queue_free(p_fcrb->waiting_for_ack_q, osi_free);
   p_fcrb->waiting_for_ack_q = NULL;
 
   fixed_queue_free(p_fcrb->srej_rcv_hold_q, osi_free);
   p_fcrb->srej_rcv_hold_q = NULL;
 
-  fixed_queue_free(p_fcrb->retrans_q, osi_free);
-  p_fcrb->retrans_q = NULL;
-
   memset(p_fcrb, 0, sizeof(tL2C_FCRB));
 }
 
@@ -876,6 +877,10 @@ static bool process_reqseq(tL2C_CCB* p_ccb, uint16_t ctrl_word) {
       if ((ls == L2CAP_FCR_UNSEG_SDU) || (ls == L2CAP_FCR_END_SDU))
         full_sdus_xmitted++;
 
+      /* Drop any pending retransmission of the frame before releasing it */
+      while (fixed_queue_try_remove_from_queue(p_fcrb->retrans_q, p_tmp) !=
+             NULL) {
+      }
       osi_free(p_tmp);
     }
 
@@ -1332,9 +1337,8 @@ static bool retransmit_i_frames(tL2C_CCB* p_ccb, uint8_t tx_seq) {
       }
     }
 
-    /* Also flush our retransmission queue */
-    while (!fixed_queue_is_empty(p_ccb->fcrb.retrans_q))
-      osi_free(fixed_queue_try_dequeue(p_ccb->fcrb.retrans_q));
+    /* Also flush our retransmission queue, its frames stay waiting for ack */
+    fixed_queue_flush(p_ccb->fcrb.retrans_q, NULL);
 
     if (list_ack != NULL) node_ack = list_begin(list_ack);
   }
@@ -1344,14 +1348,10 @@ static bool retransmit_i_frames(tL2C_CCB* p_ccb, uint8_t tx_seq) {
       p_buf = (BT_HDR*)list_node(node_ack);
       node_ack = list_next(node_ack);
 
-      BT_HDR* p_buf2 = l2c_fcr_clone_buf(p_buf, p_buf->offset, p_buf->len);
-      if (p_buf2) {
-        p_buf2->layer_specific = p_buf->layer_specific;
+      /* The frame is shared with waiting_for_ack_q, which keeps owning it */
+      fixed_queue_enqueue(p_ccb->fcrb.retrans_q, p_buf);
 
-        fixed_queue_enqueue(p_ccb->fcrb.retrans_q, p_buf2);
-      }
-
-      if ((tx_seq != L2C_FCR_RETX_ALL_PKTS) || (p_buf2 == NULL)) break;
+      if (tx_seq != L2C_FCR_RETX_ALL_PKTS) break;
     }
   }
 
@@ -1390,6 +1390,9 @@ BT_HDR* l2c_fcr_get_next_xmit_sdu_seg(tL2C_CCB* p_ccb,
   */
   p_buf = (BT_HDR*)fixed_queue_try_dequeue(p_ccb->fcrb.retrans_q);
   if (p_buf != NULL) {
+    /* Drop the FCS of the last transmission, it is computed again below */
+    p_buf->len -= L2CAP_FCS_LEN;
+
     /* Update Rx Seq and FCS if we acked some packets while this one was queued
      */
     prepare_I_frame(p_ccb, p_buf, true);
@@ -1486,28 +1489,9 @@ BT_HDR* l2c_fcr_get_next_xmit_sdu_seg(tL2C_CCB* p_ccb,
   prepare_I_frame(p_ccb, p_xmit, false);
 
   if (p_ccb->peer_cfg.fcr.mode == L2CAP_FCR_ERTM_MODE) {
-    BT_HDR* p_wack =
-        l2c_fcr_clone_buf(p_xmit, HCI_DATA_PREAMBLE_SIZE, p_xmit->len);
-
-    if (!p_wack) {
-      L2CAP_TRACE_ERROR(
-          "L2CAP - no buffer for xmit cloning, CID: 0x%04x  Length: %u",
-          p_ccb->local_cid, p_xmit->len);
-
-      /* We will not save the FCS in case we reconfigure and change options */
-      p_xmit->len -= L2CAP_FCS_LEN;
-
-      /* Pretend we sent it and it got lost */
-      fixed_queue_enqueue(p_ccb->fcrb.waiting_for_ack_q, p_xmit);
-      return (NULL);
-    } else {
-      /* We will not save the FCS in case we reconfigure and change options */
-      p_wack->len -= L2CAP_FCS_LEN;
-
-      p_wack->layer_specific = p_xmit->layer_specific;
-      fixed_queue_enqueue(p_ccb->fcrb.waiting_for_ack_q, p_wack);
-    }
-
+    /* The frame is not copied: the link sends it as a shared buffer and
+     * waiting_for_ack_q keeps it for retransmission until it is acked */
+    fixed_queue_enqueue(p_ccb->fcrb.waiting_for_ack_q, p_xmit);
   }
 
   return (p_xmit);
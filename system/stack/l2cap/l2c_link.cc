@@ -55,8 +55,9 @@ void btm_acl_set_paging(bool value);
 void btm_ble_decrement_link_topology_mask(uint8_t link_role);
 void btm_sco_acl_removed(const RawAddress* bda);
 
-static void l2c_link_send_to_lower(tL2C_LCB* p_lcb, BT_HDR* p_buf);
-static BT_HDR* l2cu_get_next_buffer_to_send(tL2C_LCB* p_lcb);
+static void l2c_link_send_to_lower(tL2C_LCB* p_lcb, BT_HDR* p_buf,
+                                   bool is_shared);
+static BT_HDR* l2cu_get_next_buffer_to_send(tL2C_LCB* p_lcb, bool* p_is_shared);
 
 /*******************************************************************************
  *
@@ -945,7 +946,7 @@ void l2c_link_check_send_pkts(tL2C_LCB* p_lcb, uint16_t local_cid,
         LOG_DEBUG("Sending to lower layer");
         p_buf = (BT_HDR*)list_front(p_lcb->link_xmit_data_q);
         list_remove(p_lcb->link_xmit_data_q, p_buf);
-        l2c_link_send_to_lower(p_lcb, p_buf);
+        l2c_link_send_to_lower(p_lcb, p_buf, false);
       } else if (single_write) {
         /* If only doing one write, break out */
         LOG_DEBUG("single_write is true, skipping");
@@ -954,10 +955,11 @@ void l2c_link_check_send_pkts(tL2C_LCB* p_lcb, uint16_t local_cid,
       /* If nothing on the link queue, check the channel queue */
       else {
         LOG_DEBUG("Check next buffer");
-        p_buf = l2cu_get_next_buffer_to_send(p_lcb);
+        bool is_shared;
+        p_buf = l2cu_get_next_buffer_to_send(p_lcb, &is_shared);
         if (p_buf != NULL) {
           LOG_DEBUG("Sending next buffer");
-          l2c_link_send_to_lower(p_lcb, p_buf);
+          l2c_link_send_to_lower(p_lcb, p_buf, is_shared);
         }
       }
     }
@@ -1001,7 +1003,7 @@ void l2c_link_check_send_pkts(tL2C_LCB* p_lcb, uint16_t local_cid,
       LOG_DEBUG("Sending to lower layer");
       p_buf = (BT_HDR*)list_front(p_lcb->link_xmit_data_q);
       list_remove(p_lcb->link_xmit_data_q, p_buf);
-      l2c_link_send_to_lower(p_lcb, p_buf);
+      l2c_link_send_to_lower(p_lcb, p_buf, false);
     }
 
     if (!single_write) {
@@ -1012,13 +1014,14 @@ void l2c_link_check_send_pkts(tL2C_LCB* p_lcb, uint16_t local_cid,
               (l2cb.controller_le_xmit_window != 0 &&
                (p_lcb->transport == BT_TRANSPORT_LE))) &&
              (p_lcb->sent_not_acked < p_lcb->link_xmit_quota)) {
-        p_buf = l2cu_get_next_buffer_to_send(p_lcb);
+        bool is_shared;
+        p_buf = l2cu_get_next_buffer_to_send(p_lcb, &is_shared);
         if (p_buf == NULL) {
           LOG_DEBUG("No next buffer, skipping");
           break;
         }
         LOG_DEBUG("Sending to lower layer");
-        l2c_link_send_to_lower(p_lcb, p_buf);
+        l2c_link_send_to_lower(p_lcb, p_buf, is_shared);
       }
     }
 
@@ -1049,20 +1052,31 @@ void l2c_OnHciModeChangeSendPendingPackets(RawAddress remote) {
  *
  * Function         l2c_link_send_to_lower
  *
- * Description      This function queues the buffer for HCI transmission
+ * Description      This function queues the buffer for HCI transmission.
+ *                  A shared buffer is an eRTM I-frame that stays in the
+ *                  channel's waiting_for_ack_q: it is only read by the lower
+ *                  layer, and given back without its HCI header so that it
+ *                  can be retransmitted as is.
  *
  ******************************************************************************/
-static void l2c_link_send_to_lower_br_edr(tL2C_LCB* p_lcb, BT_HDR* p_buf) {
+static void l2c_link_send_to_lower_br_edr(tL2C_LCB* p_lcb, BT_HDR* p_buf,
+                                          bool is_shared) {
   const uint16_t link_xmit_quota = p_lcb->link_xmit_quota;
 
   if (link_xmit_quota == 0) {
     l2cb.round_robin_unacked++;
   }
   p_lcb->sent_not_acked++;
-  p_buf->layer_specific = 0;
   l2cb.controller_xmit_window--;
 
-  acl_send_data_packet_br_edr(p_lcb->remote_bd_addr, p_buf);
+  if (is_shared) {
+    acl_send_shared_data_packet_br_edr(p_lcb->remote_bd_addr, p_buf);
+    p_buf->offset += HCI_DATA_PREAMBLE_SIZE;
+    p_buf->len -= HCI_DATA_PREAMBLE_SIZE;
+  } else {
+    p_buf->layer_specific = 0;
+    acl_send_data_packet_br_edr(p_lcb->remote_bd_addr, p_buf);
+  }
   LOG_DEBUG("TotalWin=%d,Hndl=0x%x,Quota=%d,Unack=%d,RRQuota=%d,RRUnack=%d",
             l2cb.controller_xmit_window, p_lcb->Handle(),
             p_lcb->link_xmit_quota, p_lcb->sent_not_acked,
@@ -1086,10 +1100,13 @@ static void l2c_link_send_to_lower_ble(tL2C_LCB* p_lcb, BT_HDR* p_buf) {
             l2cb.ble_round_robin_quota, l2cb.ble_round_robin_unacked);
 }
 
-static void l2c_link_send_to_lower(tL2C_LCB* p_lcb, BT_HDR* p_buf) {
+static void l2c_link_send_to_lower(tL2C_LCB* p_lcb, BT_HDR* p_buf,
+                                   bool is_shared) {
   if (p_lcb->transport == BT_TRANSPORT_BR_EDR) {
-    l2c_link_send_to_lower_br_edr(p_lcb, p_buf);
+    l2c_link_send_to_lower_br_edr(p_lcb, p_buf, is_shared);
   } else {
+    /* eRTM, the only user of shared buffers, is BR/EDR only */
+    CHECK(!is_shared);
     l2c_link_send_to_lower_ble(p_lcb, p_buf);
   }
 }
@@ -1420,13 +1437,16 @@ tL2C_CCB* l2cu_get_next_channel_in_rr(tL2C_LCB* p_lcb) {
  * Description      get the next buffer to send on a link. It also adjusts the
  *                  CCB queue to do a basic priority and round-robin scheduling.
  *
- * Returns          pointer to buffer or NULL
+ * Returns          pointer to buffer or NULL. |p_is_shared| is set when
+ *                  the buffer is an eRTM I-frame that L2CAP keeps.
  *
  ******************************************************************************/
-BT_HDR* l2cu_get_next_buffer_to_send(tL2C_LCB* p_lcb) {
+BT_HDR* l2cu_get_next_buffer_to_send(tL2C_LCB* p_lcb, bool* p_is_shared) {
   tL2C_CCB* p_ccb;
   BT_HDR* p_buf;
 
+  *p_is_shared = false;
+
   /* Highest priority are fixed channels */
   int xx;
 
@@ -1450,6 +1470,7 @@ BT_HDR* l2cu_get_next_buffer_to_send(tL2C_LCB* p_lcb) {
 
       p_buf = l2c_fcr_get_next_xmit_sdu_seg(p_ccb, 0);
       if (p_buf != NULL) {
+        *p_is_shared = (p_ccb->peer_cfg.fcr.mode == L2CAP_FCR_ERTM_MODE);
         l2cu_check_channel_congestion(p_ccb);
         l2cu_set_acl_hci_header(p_buf, p_ccb);
         return (p_buf);
@@ -1495,6 +1516,7 @@ BT_HDR* l2cu_get_next_buffer_to_send(tL2C_LCB* p_lcb) {
     if (p_ccb->peer_cfg.fcr.mode != L2CAP_FCR_BASIC_MODE) {
       p_buf = l2c_fcr_get_next_xmit_sdu_seg(p_ccb, 0);
       if (p_buf == NULL) return (NULL);
+      *p_is_shared = (p_ccb->peer_cfg.fcr.mode == L2CAP_FCR_ERTM_MODE);
     } else {
       p_buf = (BT_HDR*)fixed_queue_try_dequeue(p_ccb->xmit_hold_q);
       if (NULL == p_buf) {
@@ -0,0 +1,307 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "stack/btm/btm_sco_plc.h"
+#include "stack/btm/btm_sco_wbs.h"
+
+using bluetooth::audio::sco::PacketLossConcealment;
+using namespace bluetooth::audio::sco::wbs;
+
+namespace {
+
+// A SCO packet as received from the controller
+struct TracePacket {
+  uint8_t status;
+  std::vector<uint8_t> data;
+};
+
+using Trace = std::vector<TracePacket>;
+
+constexpr double kSampleRate = 16000;
+constexpr double kToneFrequency = 440;
+constexpr double kToneAmplitude = 8000;
+
+std::vector<int16_t> Tone(size_t frames) {
+  std::vector<int16_t> pcm(frames * kSamplesPerFrame);
+  for (size_t i = 0; i < pcm.size(); i++) {
+    pcm[i] = kToneAmplitude * std::sin(2 * M_PI * kToneFrequency * i /
+                                       kSampleRate);
+  }
+  return pcm;
+}
+
+// Encodes |pcm| into the packets of |packet_size| octets a controller would
+// receive over a clean link
+Trace Record(const std::vector<int16_t>& pcm, size_t packet_size) {
+  Codec encoder;
+  Trace trace;
+  for (size_t i = 0; i < pcm.size(); i += kSamplesPerFrame) {
+    encoder.EncodeFrame(&pcm[i]);
+    bool last = i + kSamplesPerFrame >= pcm.size();
+    while (encoder.EncodedSize() >= packet_size ||
+           (last && encoder.EncodedSize() > 0)) {
+      TracePacket packet{kCorrectlyReceived,
+                         std::vector<uint8_t>(packet_size)};
+      packet.data.resize(
+          encoder.DequeuePacket(packet.data.data(), packet_size));
+      trace.push_back(std::move(packet));
+    }
+  }
+  return trace;
+}
+
+// Feeds |trace| to a codec the way btm_route_sco_data() does, and collects
+// the audio decoded
+std::vector<int16_t> Replay(const Trace& trace, Stats* stats) {
+  Codec decoder;
+  std::vector<int16_t> pcm;
+  int16_t frame[kSamplesPerFrame];
+  for (const auto& packet : trace) {
+    decoder.EnqueuePacket(packet.data.data(), packet.data.size(),
+                          packet.status);
+    while (decoder.DecodeFrame(frame)) {
+      pcm.insert(pcm.end(), frame, frame + kSamplesPerFrame);
+    }
+  }
+  *stats = decoder.stats();
+  return pcm;
+}
+
+// Signal to noise ratio, in dB, of |decoded| against |reference| delayed by
+// the codec
+double Snr(const std::vector<int16_t>& reference,
+           const std::vector<int16_t>& decoded, size_t from, size_t to) {
+  // Delay of the SBC analysis and synthesis filters, for 8 subbands
+  constexpr size_t kDelay = 73;
+  double signal = 0, noise = 0;
+  for (size_t i = std::max(from, kDelay); i < to && i < decoded.size(); i++) {
+    double ref = reference[i - kDelay];
+    signal += ref * ref;
+    noise += (decoded[i] - ref) * (decoded[i] - ref);
+  }
+  return 10 * std::log10(signal / std::max(noise, 1.0));
+}
+
+// Largest jump between consecutive samples of |pcm|
+int MaxStep(const std::vector<int16_t>& pcm, size_t from, size_t to) {
+  int step = 0;
+  for (size_t i = std::max<size_t>(from, 1); i < to && i < pcm.size(); i++) {
+    step = std::max(step, std::abs(pcm[i] - pcm[i - 1]));
+  }
+  return step;
+}
+
+// Reads a trace recorded from a SCO link: a packet per line, its status
+// followed by its octets in hexadecimal
+bool LoadTrace(const std::string& path, Trace* trace) {
+  std::ifstream file(path);
+  if (!file) return false;
+  std::string line;
+  while (std::getline(file, line)) {
+    std::istringstream fields(line);
+    unsigned status;
+    if (!(fields >> status)) continue;
+    TracePacket packet{static_cast<uint8_t>(status), {}};
+    std::string hex;
+    fields >> hex;
+    for (size_t i = 0; i + 1 < hex.size(); i += 2) {
+      packet.data.push_back(std::stoul(hex.substr(i, 2), nullptr, 16));
+    }
+    trace->push_back(std::move(packet));
+  }
+  return true;
+}
+
+class ScoWbsTest : public ::testing::Test {
+ protected:
+  static constexpr size_t kFrames = 100;
+
+  void SetUp() override { tone_ = Tone(kFrames); }
+
+  std::vector<int16_t> tone_;
+};
+
+TEST_F(ScoWbsTest, frames_are_h2_framed) {
+  Trace trace = Record(tone_, kFrameSize);
+  ASSERT_EQ(trace.size(), kFrames);
+  const uint8_t sequence[] = {0x08, 0x38, 0xc8, 0xf8};
+  for (size_t i = 0; i < trace.size(); i++) {
+    ASSERT_EQ(trace[i].data[0], 0x01);
+    ASSERT_EQ(trace[i].data[1], sequence[i % 4]);
+    ASSERT_EQ(trace[i].data[2], 0xad);
+    ASSERT_EQ(trace[i].data[3], 0x00);
+    ASSERT_EQ(trace[i].data[4], 0x00);
+  }
+}
+
+TEST_F(ScoWbsTest, clean_link) {
+  for (size_t packet_size : {24, 48, 60}) {
+    Stats stats;
+    auto pcm = Replay(Record(tone_, packet_size), &stats);
+    ASSERT_EQ(stats.decoded_frames, kFrames) << packet_size;
+    ASSERT_EQ(stats.concealed_frames, 0u);
+    ASSERT_EQ(stats.sequence_errors, 0u);
+    ASSERT_EQ(stats.discarded_octets, 0u);
+    ASSERT_EQ(pcm.size(), tone_.size());
+    ASSERT_GT(Snr(tone_, pcm, 0, pcm.size()), 40) << packet_size;
+  }
+}
+
+TEST_F(ScoWbsTest, packet_status_is_concealed) {
+  Trace trace = Record(tone_, kFrameSize);
+  trace[40].status = kNoDataReceived;
+  memset(trace[40].data.data(), 0, kFrameSize);
+  trace[60].status = kPossiblyInvalid;
+  trace[61].status = kPartiallyLost;
+
+  Stats stats;
+  auto pcm = Replay(trace, &stats);
+  ASSERT_EQ(stats.rx_erroneous_packets, 3u);
+  ASSERT_EQ(stats.concealed_frames, 3u);
+  ASSERT_EQ(stats.decoded_frames, kFrames - 3);
+  ASSERT_EQ(stats.discarded_octets, 0u);
+  // The timing is kept: the audio after the losses lines up again
+  ASSERT_EQ(pcm.size(), tone_.size());
+  ASSERT_GT(Snr(tone_, pcm, 70 * kSamplesPerFrame, pcm.size()), 40);
+}
+
+TEST_F(ScoWbsTest, concealment_is_continuous) {
+  Trace trace = Record(tone_, kFrameSize);
+  for (size_t i = 50; i < 53; i++) trace[i].status = kNoDataReceived;
+
+  Stats stats;
+  auto pcm = Replay(trace, &stats);
+  ASSERT_EQ(stats.concealed_frames, 3u);
+
+  // A tone is predictable: the substitution follows it without clicks, and
+  // close enough to the original
+  int clean_step = MaxStep(pcm, 0, 50 * kSamplesPerFrame);
+  ASSERT_LE(MaxStep(pcm, 50 * kSamplesPerFrame, 54 * kSamplesPerFrame),
+            clean_step * 3 / 2);
+  ASSERT_GT(Snr(tone_, pcm, 50 * kSamplesPerFrame, 53 * kSamplesPerFrame),
+            10);
+}
+
+TEST_F(ScoWbsTest, long_loss_fades_out) {
+  Trace trace = Record(tone_, kFrameSize);
+  for (size_t i = 20; i < 40; i++) trace[i].status = kNoDataReceived;
+
+  Stats stats;
+  auto pcm = Replay(trace, &stats);
+  ASSERT_EQ(stats.concealed_frames, 20u);
+  int last = 0;
+  for (size_t i = 39 * kSamplesPerFrame; i < 40 * kSamplesPerFrame; i++) {
+    last = std::max(last, std::abs(pcm[i]));
+  }
+  ASSERT_LT(last, kToneAmplitude / 100);
+}
+
+TEST_F(ScoWbsTest, resynchronizes_after_lost_octets) {
+  Trace trace = Record(tone_, 24);
+  // A controller dropping part of a packet, and the rest of the frame it
+  // belonged to then arriving in front of the next header
+  trace[30].data.resize(10);
+  Stats stats;
+  auto pcm = Replay(trace, &stats);
+  ASSERT_GT(stats.discarded_octets, 0u);
+  ASSERT_EQ(stats.decoded_frames + stats.concealed_frames, kFrames - 1);
+  ASSERT_GE(stats.decoded_frames, kFrames - 2);
+}
+
+TEST_F(ScoWbsTest, garbage_is_skipped) {
+  Trace trace = Record(tone_, kFrameSize);
+  trace.insert(trace.begin() + 10,
+               TracePacket{kCorrectlyReceived, std::vector<uint8_t>(7, 0x5a)});
+  Stats stats;
+  Replay(trace, &stats);
+  ASSERT_EQ(stats.discarded_octets, 7u);
+  ASSERT_EQ(stats.decoded_frames, kFrames);
+  ASSERT_EQ(stats.sequence_errors, 0u);
+}
+
+TEST_F(ScoWbsTest, missing_frame_is_a_sequence_error) {
+  Trace trace = Record(tone_, kFrameSize);
+  trace.erase(trace.begin() + 10);
+  Stats stats;
+  Replay(trace, &stats);
+  ASSERT_EQ(stats.sequence_errors, 1u);
+  ASSERT_EQ(stats.decoded_frames, kFrames - 1);
+}
+
+TEST_F(ScoWbsTest, corrupted_frame_is_concealed) {
+  Trace trace = Record(tone_, kFrameSize);
+  // Reported as correctly received, but failing the CRC, which covers the
+  // scale factors following the frame header
+  trace[25].data[7] ^= 0xff;
+  Stats stats;
+  auto pcm = Replay(trace, &stats);
+  ASSERT_EQ(stats.concealed_frames, 1u);
+  ASSERT_EQ(pcm.size(), tone_.size());
+}
+
+TEST_F(ScoWbsTest, silence_on_underrun) {
+  Codec codec;
+  codec.EncodeSilence();
+  ASSERT_EQ(codec.EncodedSize(), kFrameSize);
+  ASSERT_EQ(codec.stats().tx_underruns, 1u);
+  ASSERT_EQ(codec.stats().encoded_frames, 1u);
+
+  Trace trace(1, TracePacket{kCorrectlyReceived,
+                             std::vector<uint8_t>(kFrameSize)});
+  codec.DequeuePacket(trace[0].data.data(), kFrameSize);
+  Stats stats;
+  auto pcm = Replay(trace, &stats);
+  ASSERT_EQ(stats.decoded_frames, 1u);
+  for (int16_t sample : pcm) ASSERT_EQ(sample, 0);
+}
+
+TEST(ScoPlcTest, silence_is_concealed_by_silence) {
+  PacketLossConcealment plc;
+  int16_t frame[PacketLossConcealment::kFrameSamples];
+  plc.BadFrame(frame);
+  plc.BadFrame(frame);
+  ASSERT_EQ(plc.ConsecutiveBadFrames(), 2u);
+  for (int16_t sample : frame) ASSERT_EQ(sample, 0);
+  plc.GoodFrame(frame);
+  ASSERT_EQ(plc.ConsecutiveBadFrames(), 0u);
+}
+
+// Replays a trace recorded from a real link, named by SCO_WBS_TRACE, and
+// reports the quality of the call it carried
+TEST(ScoWbsTraceTest, recorded_trace) {
+  const char* path = getenv("SCO_WBS_TRACE");
+  if (path == nullptr) GTEST_SKIP() << "SCO_WBS_TRACE is not set";
+  Trace trace;
+  ASSERT_TRUE(LoadTrace(path, &trace)) << "Unable to read " << path;
+  Stats stats;
+  Replay(trace, &stats);
+  std::cout << stats.ToString() << std::endl;
+  ASSERT_EQ(stats.rx_packets, trace.size());
+}
+
+}  // namespace
@@ -0,0 +1,152 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <base/logging.h>
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include "osi/include/allocator.h"
+#include "osi/include/list.h"
+#include "stack/btm/security_device_record.h"
+#include "stack/btm/security_device_record_index.h"
+#include "types/raw_address.h"
+
+using ::benchmark::State;
+
+namespace {
+
+#define NUM_RECORDS 1000
+
+// The predicates btm_find_dev() and btm_find_dev_by_handle() walk the list
+// with, minus random address resolution.
+bool is_address_equal(void* data, void* context) {
+  tBTM_SEC_DEV_REC* p_dev_rec = static_cast<tBTM_SEC_DEV_REC*>(data);
+  const RawAddress* bd_addr = static_cast<RawAddress*>(context);
+  return !(p_dev_rec->bd_addr == *bd_addr ||
+           p_dev_rec->ble.pseudo_addr == *bd_addr);
+}
+
+bool is_handle_equal(void* data, void* context) {
+  tBTM_SEC_DEV_REC* p_dev_rec = static_cast<tBTM_SEC_DEV_REC*>(data);
+  uint16_t* handle = static_cast<uint16_t*>(context);
+  return !(p_dev_rec->hci_handle == *handle ||
+           p_dev_rec->ble_hci_handle == *handle);
+}
+
+class BM_SecDevRec : public ::benchmark::Fixture {
+ protected:
+  void SetUp(State& st) override {
+    ::benchmark::Fixture::SetUp(st);
+    records_ = list_new(osi_free);
+    for (int i = 0; i < NUM_RECORDS; i++) {
+      tBTM_SEC_DEV_REC* p_dev_rec =
+          static_cast<tBTM_SEC_DEV_REC*>(osi_calloc(sizeof(tBTM_SEC_DEV_REC)));
+      p_dev_rec->bd_addr = RawAddress(
+          {0x00, 0x11, 0x22, 0x33, (uint8_t)(i >> 8), (uint8_t)(i & 0xff)});
+      p_dev_rec->hci_handle = 2 * i;
+      p_dev_rec->ble_hci_handle = 2 * i + 1;
+      // Most of the database is made of bonded devices
+      p_dev_rec->sec_flags =
+          (i < NUM_RECORDS - 10) ? BTM_SEC_LINK_KEY_KNOWN : 0;
+      p_dev_rec->timestamp = i;
+      list_append(records_, p_dev_rec);
+      index_.Add(p_dev_rec);
+      addresses_.push_back(p_dev_rec->bd_addr);
+    }
+  }
+
+  void TearDown(State& st) override {
+    index_.Clear();
+    list_free(records_);
+    addresses_.clear();
+    ::benchmark::Fixture::TearDown(st);
+  }
+
+  list_t* records_;
+  SecurityDeviceRecordIndex index_;
+  std::vector<RawAddress> addresses_;
+};
+
+BENCHMARK_F(BM_SecDevRec, find_by_address_list)(State& state) {
+  size_t i = 0;
+  for (auto _ : state) {
+    RawAddress& bd_addr = addresses_[i++ % addresses_.size()];
+    benchmark::DoNotOptimize(list_foreach(records_, is_address_equal, &bd_addr));
+  }
+}
+
+BENCHMARK_F(BM_SecDevRec, find_by_address_index)(State& state) {
+  size_t i = 0;
+  for (auto _ : state) {
+    RawAddress& bd_addr = addresses_[i++ % addresses_.size()];
+    benchmark::DoNotOptimize(index_.FindByAddress(bd_addr));
+  }
+}
+
+BENCHMARK_F(BM_SecDevRec, find_by_handle_list)(State& state) {
+  uint16_t handle = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(list_foreach(records_, is_handle_equal, &handle));
+    handle = (handle + 1) % (2 * NUM_RECORDS);
+  }
+}
+
+BENCHMARK_F(BM_SecDevRec, find_by_handle_index)(State& state) {
+  uint16_t handle = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(index_.FindByHandle(handle));
+    handle = (handle + 1) % (2 * NUM_RECORDS);
+  }
+}
+
+BENCHMARK_F(BM_SecDevRec, find_oldest_list)(State& state) {
+  for (auto _ : state) {
+    tBTM_SEC_DEV_REC* p_oldest = nullptr;
+    uint32_t ts_oldest = 0xFFFFFFFF;
+    for (list_node_t* node = list_begin(records_); node != list_end(records_);
+         node = list_next(node)) {
+      tBTM_SEC_DEV_REC* p_dev_rec =
+          static_cast<tBTM_SEC_DEV_REC*>(list_node(node));
+      if ((p_dev_rec->sec_flags & BTM_SEC_LINK_KEY_KNOWN) == 0 &&
+          p_dev_rec->timestamp < ts_oldest) {
+        p_oldest = p_dev_rec;
+        ts_oldest = p_dev_rec->timestamp;
+      }
+    }
+    benchmark::DoNotOptimize(p_oldest);
+  }
+}
+
+BENCHMARK_F(BM_SecDevRec, find_oldest_index)(State& state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(index_.FindOldest());
+  }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  // Disable LOG() output from libchrome
+  logging::LoggingSettings log_settings;
+  log_settings.logging_dest = logging::LoggingDestination::LOG_NONE;
+  CHECK(logging::InitLogging(log_settings)) << "Failed to set up logging";
+  ::benchmark::Initialize(&argc, argv);
+  if (::benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  ::benchmark::RunSpecifiedBenchmarks();
+}
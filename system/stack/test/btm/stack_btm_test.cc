@@ -308,8 +308,9 @@ TEST_F(StackBtmWithInitFreeTest, btm_sec_encrypt_change) {
   ASSERT_NE(nullptr, device_record);
   ASSERT_EQ(BTM_SEC_IN_USE, device_record->sec_flags);
   device_record->bd_addr = bd_addr;
-  device_record->hci_handle = classic_handle;
-  device_record->ble_hci_handle = ble_handle;
+  btm_sec_dev_rec_set_handle(device_record, BT_TRANSPORT_BR_EDR,
+                             classic_handle);
+  btm_sec_dev_rec_set_handle(device_record, BT_TRANSPORT_LE, ble_handle);
 
   // With classic device encryption enable
   btm_sec_encrypt_change(classic_handle, HCI_SUCCESS, 0x01);
@@ -349,10 +350,67 @@ TEST_F(StackBtmWithInitFreeTest, BTM_SetEncryption) {
   tBTM_SEC_DEV_REC* device_record = btm_sec_allocate_dev_rec();
   ASSERT_NE(nullptr, device_record);
   device_record->bd_addr = bd_addr;
-  device_record->hci_handle = 0x1234;
+  btm_sec_dev_rec_set_handle(device_record, BT_TRANSPORT_BR_EDR, 0x1234);
 
   ASSERT_EQ(BTM_WRONG_MODE, BTM_SetEncryption(bd_addr, transport, p_callback,
                                               nullptr, sec_act));
 
   wipe_secrets_and_remove(device_record);
 }
+
+TEST_F(StackBtmWithInitFreeTest, sec_dev_rec_index) {
+  const RawAddress bd_addr_1 = RawAddress({0x11, 0x22, 0x33, 0x44, 0x55, 0x01});
+  const RawAddress bd_addr_2 = RawAddress({0x11, 0x22, 0x33, 0x44, 0x55, 0x02});
+  const RawAddress bd_addr_3 = RawAddress({0x11, 0x22, 0x33, 0x44, 0x55, 0x03});
+
+  tBTM_SEC_DEV_REC* record_1 = btm_sec_allocate_dev_rec();
+  record_1->bd_addr = bd_addr_1;
+  btm_cb.sec_dev_rec_index.Update(record_1);
+  btm_sec_dev_rec_set_handle(record_1, BT_TRANSPORT_BR_EDR, 0x0001);
+  tBTM_SEC_DEV_REC* record_2 = btm_sec_allocate_dev_rec();
+  record_2->bd_addr = bd_addr_2;
+  btm_cb.sec_dev_rec_index.Update(record_2);
+  btm_sec_dev_rec_set_handle(record_2, BT_TRANSPORT_LE, 0x0002);
+
+  ASSERT_EQ(record_1, btm_find_dev(bd_addr_1));
+  ASSERT_EQ(record_1, btm_find_dev_by_handle(0x0001));
+  ASSERT_EQ(record_2, btm_find_dev_by_handle(0x0002));
+  ASSERT_EQ(nullptr, btm_find_dev_by_handle(HCI_INVALID_HANDLE));
+
+  // Records are re-filed under their new keys
+  btm_sec_dev_rec_set_handle(record_2, BT_TRANSPORT_LE, HCI_INVALID_HANDLE);
+  btm_sec_dev_rec_set_handle(record_1, BT_TRANSPORT_LE, 0x0002);
+  ASSERT_EQ(record_1, btm_find_dev_by_handle(0x0002));
+
+  // Keys assigned in place are still found, and stale ones are not returned
+  record_1->hci_handle = 0x0003;
+  ASSERT_EQ(record_1, btm_find_dev_by_handle(0x0003));
+  ASSERT_EQ(nullptr, btm_find_dev_by_handle(0x0001));
+  btm_sec_dev_rec_set_handle(record_1, BT_TRANSPORT_BR_EDR, 0x0001);
+  record_2->ble.pseudo_addr = bd_addr_3;
+  btm_cb.sec_dev_rec_index.Update(record_2);
+  ASSERT_EQ(record_2, btm_find_dev(bd_addr_3));
+  ASSERT_EQ(record_2, btm_find_dev(bd_addr_2));
+
+  // Removed records are not returned anymore
+  wipe_secrets_and_remove(record_1);
+  ASSERT_EQ(nullptr, btm_find_dev(bd_addr_1));
+  ASSERT_EQ(nullptr, btm_find_dev_by_handle(0x0002));
+  ASSERT_EQ(record_2, btm_find_dev(bd_addr_2));
+
+  // Unpaired records are reused before paired ones, least recently used first
+  record_2->sec_flags |= BTM_SEC_LINK_KEY_KNOWN;
+  tBTM_SEC_DEV_REC* record_3 = btm_sec_allocate_dev_rec();
+  tBTM_SEC_DEV_REC* record_4 = btm_sec_allocate_dev_rec();
+  ASSERT_EQ(record_3, btm_cb.sec_dev_rec_index.FindOldest());
+  btm_sec_dev_rec_touch(record_3);
+  ASSERT_EQ(record_4, btm_cb.sec_dev_rec_index.FindOldest());
+  record_3->sec_flags |= BTM_SEC_LE_LINK_KEY_KNOWN;
+  record_4->sec_flags |= BTM_SEC_LINK_KEY_KNOWN;
+  ASSERT_EQ(record_2, btm_cb.sec_dev_rec_index.FindOldest());
+
+  wipe_secrets_and_remove(record_2);
+  wipe_secrets_and_remove(record_3);
+  wipe_secrets_and_remove(record_4);
+  ASSERT_EQ(0UL, btm_cb.sec_dev_rec_index.Size());
+}
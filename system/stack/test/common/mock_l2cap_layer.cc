@@ -64,6 +64,10 @@ uint8_t L2CA_DataWrite(uint16_t cid, BT_HDR* p_data) {
   return l2cap_interface->DataWrite(cid, p_data);
 }
 
+uint16_t L2CA_FlushChannel(uint16_t lcid, uint16_t num_to_flush) {
+  return l2cap_interface->FlushChannel(lcid, num_to_flush);
+}
+
 uint16_t L2CA_RegisterLECoc(uint16_t psm, const tL2CAP_APPL_INFO& cb_info,
                             uint16_t sec_level, tL2CAP_LE_CFG_INFO cfg) {
   return l2cap_interface->RegisterLECoc(psm, cb_info, sec_level);
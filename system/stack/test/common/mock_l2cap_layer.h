@@ -40,6 +40,7 @@ class L2capInterface {
   virtual bool ConfigRequest(uint16_t cid, tL2CAP_CFG_INFO* p_cfg) = 0;
   virtual bool ConfigResponse(uint16_t cid, tL2CAP_CFG_INFO* p_cfg) = 0;
   virtual uint8_t DataWrite(uint16_t cid, BT_HDR* p_data) = 0;
+  virtual uint16_t FlushChannel(uint16_t cid, uint16_t num_to_flush) = 0;
   virtual uint16_t RegisterLECoc(uint16_t psm, const tL2CAP_APPL_INFO &cb_info, uint16_t sec_level) = 0;
   virtual void DeregisterLECoc(uint16_t psm) = 0;
   virtual bool ConnectCreditBasedRsp(const RawAddress& bd_addr, uint8_t id,
@@ -69,6 +70,7 @@ class MockL2capInterface : public L2capInterface {
   MOCK_METHOD2(ConfigRequest, bool(uint16_t cid, tL2CAP_CFG_INFO* p_cfg));
   MOCK_METHOD2(ConfigResponse, bool(uint16_t cid, tL2CAP_CFG_INFO* p_cfg));
   MOCK_METHOD2(DataWrite, uint8_t(uint16_t cid, BT_HDR* p_data));
+  MOCK_METHOD2(FlushChannel, uint16_t(uint16_t cid, uint16_t num_to_flush));
   MOCK_METHOD3(RegisterLECoc,
                uint16_t(uint16_t psm, const tL2CAP_APPL_INFO &cb_info, uint16_t sec_level));
   MOCK_METHOD1(DeregisterLECoc, void(uint16_t psm));
@@ -18,6 +18,8 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <queue>
+#include <set>
 #include <vector>
 
 #include "bind_helpers.h"
@@ -443,4 +445,127 @@ TEST_F(EattTest, DoubleDisconnect) {
   /* Force second disconnect */
   eatt_instance_->Disconnect(test_address);
 }
+
+TEST_F(EattTest, ClientRequestsSpreadOverChannels) {
+  ON_CALL(l2cap_interface_, FlushChannel(_, L2CAP_FLUSH_CHANS_GET))
+      .WillByDefault(Return(0));
+  ConnectDeviceEattSupported(3);
+
+  /* Idle channels take turns */
+  std::set<uint16_t> scheduled_cids;
+  for (size_t i = 0; i < connected_cids_.size(); i++) {
+    EattChannel* channel =
+        eatt_instance_->GetChannelAvailableForClientRequest(test_address);
+    ASSERT_TRUE(channel != nullptr);
+    scheduled_cids.insert(channel->cid_);
+  }
+  ASSERT_EQ(scheduled_cids.size(), connected_cids_.size());
+
+  /* Busy channels are skipped */
+  EattChannel* busy_1 =
+      eatt_instance_->FindEattChannelByCid(test_address, connected_cids_[0]);
+  EattChannel* busy_2 =
+      eatt_instance_->FindEattChannelByCid(test_address, connected_cids_[1]);
+  busy_1->cl_cmd_q_.push(tGATT_CMD_Q{});
+  busy_2->cl_cmd_q_.push(tGATT_CMD_Q{});
+  for (int i = 0; i < 3; i++) {
+    EattChannel* channel =
+        eatt_instance_->GetChannelAvailableForClientRequest(test_address);
+    ASSERT_TRUE(channel != nullptr);
+    ASSERT_EQ(channel->cid_, connected_cids_[2]);
+  }
+  ASSERT_EQ(busy_1->cl_requests_ + busy_2->cl_requests_, 2u);
+
+  DisconnectEattDevice(connected_cids_);
+}
+
+TEST_F(EattTest, ClientRequestsAvoidQueuedChannels) {
+  ConnectDeviceEattSupported(3);
+
+  /* The first channel still has packets waiting for credits */
+  ON_CALL(l2cap_interface_, FlushChannel(_, L2CAP_FLUSH_CHANS_GET))
+      .WillByDefault(Return(0));
+  ON_CALL(l2cap_interface_,
+          FlushChannel(connected_cids_[0], L2CAP_FLUSH_CHANS_GET))
+      .WillByDefault(Return(4));
+
+  for (int i = 0; i < 4; i++) {
+    EattChannel* channel =
+        eatt_instance_->GetChannelAvailableForClientRequest(test_address);
+    ASSERT_TRUE(channel != nullptr);
+    ASSERT_NE(channel->cid_, connected_cids_[0]);
+  }
+
+  DisconnectEattDevice(connected_cids_);
+}
+
+TEST_F(EattTest, MoreChannelsOpenedUnderSustainedLoad) {
+  ON_CALL(l2cap_interface_, FlushChannel(_, L2CAP_FLUSH_CHANS_GET))
+      .WillByDefault(Return(0));
+  ConnectDeviceEattSupported(5);
+
+  for (uint16_t cid : connected_cids_) {
+    eatt_instance_->FindEattChannelByCid(test_address, cid)->cl_cmd_q_.push(
+        tGATT_CMD_Q{});
+  }
+  /* The ATT fixed channel is busier still */
+  test_tcb.cl_cmd_q.push(tGATT_CMD_Q{});
+  test_tcb.cl_cmd_q.push(tGATT_CMD_Q{});
+
+  std::vector<uint16_t> more_cids{66, 67, 68, 69, 70};
+  EXPECT_CALL(l2cap_interface_,
+              ConnectCreditBasedReq(BT_PSM_EATT, test_address, _))
+      .WillOnce(Return(more_cids));
+
+  for (int i = 0; i < 2 * EATT_BUSY_REQUESTS_TO_GROW; i++) {
+    EattChannel* channel =
+        eatt_instance_->GetChannelAvailableForClientRequest(test_address);
+    ASSERT_TRUE(channel != nullptr);
+  }
+
+  for (uint16_t cid : more_cids) {
+    l2cap_app_info_.pL2CA_CreditBasedConnectCfm_Cb(
+        test_address, cid, EATT_MIN_MTU_MPS, L2CAP_CONN_OK);
+  }
+  ASSERT_EQ(test_tcb.eatt, 10);
+
+  /* New requests go to the new, idle channels */
+  EattChannel* channel =
+      eatt_instance_->GetChannelAvailableForClientRequest(test_address);
+  ASSERT_TRUE(channel != nullptr);
+  ASSERT_TRUE(channel->cl_cmd_q_.empty());
+
+  test_tcb.cl_cmd_q = std::queue<tGATT_CMD_Q>();
+  connected_cids_.insert(connected_cids_.end(), more_cids.begin(),
+                         more_cids.end());
+  DisconnectEattDevice(connected_cids_);
+}
+
+TEST_F(EattTest, NotificationsAvoidCongestedChannels) {
+  ON_CALL(l2cap_interface_, FlushChannel(_, L2CAP_FLUSH_CHANS_GET))
+      .WillByDefault(Return(0));
+  ConnectDeviceEattSupported(3);
+
+  test_tcb.notif_q.SetCongested(connected_cids_[0], true);
+  for (int i = 0; i < 4; i++) {
+    EattChannel* channel =
+        eatt_instance_->GetChannelAvailableForNotification(test_address, 20);
+    ASSERT_TRUE(channel != nullptr);
+    ASSERT_NE(channel->cid_, connected_cids_[0]);
+  }
+
+  /* Values too long for the other channels go where they fit */
+  EattChannel* large_mtu =
+      eatt_instance_->FindEattChannelByCid(test_address, connected_cids_[2]);
+  large_mtu->EattChannelSetTxMTU(EATT_DEFAULT_MTU);
+  for (int i = 0; i < 2; i++) {
+    EattChannel* channel = eatt_instance_->GetChannelAvailableForNotification(
+        test_address, EATT_MIN_MTU_MPS);
+    ASSERT_TRUE(channel != nullptr);
+    ASSERT_EQ(channel->cid_, connected_cids_[2]);
+  }
+
+  DisconnectEattDevice(connected_cids_);
+  ASSERT_FALSE(test_tcb.notif_q.IsCongested(connected_cids_[0]));
+}
 }  // namespace
@@ -80,6 +80,11 @@ tGATT_STATUS attp_send_cl_msg(tGATT_TCB& tcb, tGATT_CLCB* p_clcb,
 tGATT_STATUS attp_send_sr_msg(tGATT_TCB& tcb, uint16_t cid, BT_HDR* p_msg) {
   return GATT_SUCCESS;
 }
+tGATT_STATUS attp_send_msg_to_l2cap(tGATT_TCB& tcb, uint16_t cid,
+                                    BT_HDR* p_toL2CAP) {
+  osi_free(p_toL2CAP);
+  return GATT_SUCCESS;
+}
 
 void gatt_act_discovery(tGATT_CLCB* p_clcb) {}
 bool gatt_disconnect(tGATT_TCB* p_tcb) { return false; }
@@ -154,6 +159,7 @@ void ApplicationRequestCallback(uint16_t conn_id, uint32_t trans_id,
 }
 
 bool gatt_sr_is_cl_change_aware(tGATT_TCB& tcb) { return false; }
+bool gatt_sr_is_cl_multi_notif_supported(tGATT_TCB& tcb) { return false; }
 void gatt_sr_init_cl_status(tGATT_TCB& p_tcb) {}
 void gatt_sr_update_cl_status(tGATT_TCB& p_tcb, bool chg_aware) {
   p_tcb.is_robust_cache_change_aware = chg_aware;
@@ -0,0 +1,120 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <base/logging.h>
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "osi/include/allocator.h"
+#include "stack/gatt/notification_queue.h"
+
+using ::benchmark::Counter;
+using ::benchmark::State;
+
+namespace {
+
+constexpr uint16_t kCid = 0x0004;
+constexpr uint16_t kMtu = 247;
+// Characteristics updated by a sensor server, round robin
+constexpr uint16_t kNumHandles = 8;
+// PDUs L2CAP takes before reporting the channel congested: roughly what the
+// controller buffers for a link
+constexpr size_t kL2capQuota = 4;
+// Notifications produced while the link is congested, before it is relieved:
+// each characteristic gets updated twice
+constexpr size_t kHeldBackPerRelief = 2 * kNumHandles;
+// L2CAP basic header in front of each ATT PDU
+constexpr size_t kL2capHeaderSize = 4;
+
+/*
+ * Pushes notifications as fast as a link relieved every kL2capQuota PDUs
+ * takes them, coalesced into Multiple Handle Value Notifications or not, and
+ * with superseded values dropped or not. Reports the notifications carried by
+ * each PDU, and the octets handed to L2CAP for each notification.
+ */
+void BM_Notify(State& state) {
+  const bool multi_notif = state.range(0);
+  const uint16_t value_len = state.range(1);
+  const bool supersede = state.range(2);
+  std::vector<uint8_t> value(value_len, 0x5a);
+
+  GattNotificationQueue queue;
+  size_t in_flight = 0;
+  uint64_t octets = 0;
+  auto send = [&](BT_HDR* p_buf) {
+    octets += kL2capHeaderSize + p_buf->len;
+    osi_free(p_buf);
+    return ++in_flight >= kL2capQuota ? GATT_CONGESTED : GATT_SUCCESS;
+  };
+
+  // The controller completed the packets in flight
+  auto relieve = [&]() {
+    in_flight = 0;
+    queue.SetCongested(kCid, false);
+    queue.Flush(kCid, kMtu, multi_notif, send);
+  };
+
+  uint16_t handle = 0;
+  size_t held_back = 0;
+  for (auto _ : state) {
+    handle = handle % kNumHandles + 1;
+    // Without coalescing the producer outruns the link, and waits on it
+    while (!queue.Enqueue(kCid, handle, value.data(), value_len, supersede)) {
+      held_back = 0;
+      relieve();
+    }
+    if (!queue.IsCongested(kCid)) {
+      queue.Flush(kCid, kMtu, multi_notif, send);
+    } else if (++held_back >= kHeldBackPerRelief) {
+      held_back = 0;
+      relieve();
+    }
+  }
+
+  const GattNotificationStats& stats = queue.stats();
+  state.counters["notifs_per_pdu"] = stats.CoalescingRatio();
+  state.counters["octets_per_notif"] =
+      stats.sent ? static_cast<double>(octets) / stats.sent : 0;
+  state.counters["notifs"] = Counter(stats.enqueued, Counter::kIsRate);
+  state.counters["superseded"] = Counter(stats.superseded, Counter::kIsRate);
+}
+
+BENCHMARK(BM_Notify)
+    ->ArgNames({"multi", "len", "supersede"})
+    ->Args({0, 4, 0})
+    ->Args({1, 4, 0})
+    ->Args({0, 20, 0})
+    ->Args({1, 20, 0})
+    ->Args({1, 20, 1})
+    ->Args({0, 100, 0})
+    ->Args({1, 100, 0});
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  // Disable LOG() output from libchrome
+  logging::LoggingSettings log_settings;
+  log_settings.logging_dest = logging::LoggingDestination::LOG_NONE;
+  CHECK(logging::InitLogging(log_settings)) << "Failed to set up logging";
+
+  ::benchmark::Initialize(&argc, argv);
+  if (::benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  ::benchmark::RunSpecifiedBenchmarks();
+}
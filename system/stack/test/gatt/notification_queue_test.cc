@@ -0,0 +1,192 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "stack/gatt/notification_queue.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "osi/include/allocator.h"
+
+namespace {
+
+constexpr uint16_t kCid = 0x0004;
+constexpr uint16_t kMtu = 23;
+
+class GattNotificationQueueTest : public ::testing::Test {
+ protected:
+  // Records the PDUs handed to L2CAP, which reports the channel congested
+  // once |congest_after_| of them went out
+  tGATT_STATUS Send(BT_HDR* p_buf) {
+    const uint8_t* p = (const uint8_t*)(p_buf + 1) + p_buf->offset;
+    pdus_.emplace_back(p, p + p_buf->len);
+    osi_free(p_buf);
+    return pdus_.size() >= congest_after_ ? GATT_CONGESTED : GATT_SUCCESS;
+  }
+
+  tGATT_STATUS Flush(bool multi_notif) {
+    return queue_.Flush(kCid, kMtu, multi_notif,
+                        [this](BT_HDR* p_buf) { return Send(p_buf); });
+  }
+
+  void Enqueue(uint16_t handle, std::vector<uint8_t> value,
+               bool supersede = false) {
+    ASSERT_TRUE(
+        queue_.Enqueue(kCid, handle, value.data(), value.size(), supersede));
+  }
+
+  GattNotificationQueue queue_;
+  std::vector<std::vector<uint8_t>> pdus_;
+  size_t congest_after_ = SIZE_MAX;
+};
+
+TEST_F(GattNotificationQueueTest, single_notification) {
+  Enqueue(0x0010, {0x01, 0x02});
+  EXPECT_EQ(Flush(true), GATT_SUCCESS);
+
+  ASSERT_EQ(pdus_.size(), 1u);
+  EXPECT_EQ(pdus_[0], std::vector<uint8_t>({0x1b, 0x10, 0x00, 0x01, 0x02}));
+  EXPECT_EQ(queue_.Depth(), 0u);
+  EXPECT_FALSE(queue_.HasPending(kCid));
+}
+
+TEST_F(GattNotificationQueueTest, coalesced_once_relieved) {
+  queue_.SetCongested(kCid, true);
+  Enqueue(0x0010, {0x01, 0x02});
+  Enqueue(0x0020, {0x03});
+  Enqueue(0x0030, {0x04, 0x05, 0x06});
+  EXPECT_EQ(Flush(true), GATT_CONGESTED);
+  EXPECT_TRUE(pdus_.empty());
+  EXPECT_EQ(queue_.Depth(), 3u);
+
+  queue_.SetCongested(kCid, false);
+  EXPECT_EQ(Flush(true), GATT_SUCCESS);
+
+  ASSERT_EQ(pdus_.size(), 1u);
+  EXPECT_EQ(pdus_[0],
+            std::vector<uint8_t>({0x23, 0x10, 0x00, 0x02, 0x00, 0x01, 0x02,
+                                  0x20, 0x00, 0x01, 0x00, 0x03, 0x30, 0x00,
+                                  0x03, 0x00, 0x04, 0x05, 0x06}));
+  EXPECT_EQ(queue_.stats().sent, 3u);
+  EXPECT_EQ(queue_.stats().pdus, 1u);
+  EXPECT_EQ(queue_.stats().multi_pdus, 1u);
+  EXPECT_EQ(queue_.stats().CoalescingRatio(), 3.0);
+  EXPECT_EQ(queue_.stats().max_depth, 3u);
+}
+
+TEST_F(GattNotificationQueueTest, not_coalesced_without_client_support) {
+  queue_.SetCongested(kCid, true);
+  Enqueue(0x0010, {0x01});
+  Enqueue(0x0020, {0x02});
+  queue_.SetCongested(kCid, false);
+  EXPECT_EQ(Flush(false), GATT_SUCCESS);
+
+  ASSERT_EQ(pdus_.size(), 2u);
+  EXPECT_EQ(pdus_[0], std::vector<uint8_t>({0x1b, 0x10, 0x00, 0x01}));
+  EXPECT_EQ(pdus_[1], std::vector<uint8_t>({0x1b, 0x20, 0x00, 0x02}));
+  EXPECT_EQ(queue_.stats().multi_pdus, 0u);
+}
+
+TEST_F(GattNotificationQueueTest, split_on_mtu) {
+  queue_.SetCongested(kCid, true);
+  // 1 + 3 * (4 + 5) octets do not fit in 23: the third one goes alone
+  Enqueue(0x0010, std::vector<uint8_t>(5, 0x01));
+  Enqueue(0x0020, std::vector<uint8_t>(5, 0x02));
+  Enqueue(0x0030, std::vector<uint8_t>(5, 0x03));
+  // Too long for a tuple, truncated to the MTU as a notification of its own
+  Enqueue(0x0040, std::vector<uint8_t>(30, 0x04));
+  queue_.SetCongested(kCid, false);
+  EXPECT_EQ(Flush(true), GATT_SUCCESS);
+
+  ASSERT_EQ(pdus_.size(), 3u);
+  EXPECT_EQ(pdus_[0][0], 0x23);
+  EXPECT_EQ(pdus_[0].size(), 19u);
+  EXPECT_EQ(pdus_[1][0], 0x1b);
+  EXPECT_EQ(pdus_[1].size(), 8u);
+  EXPECT_EQ(pdus_[2][0], 0x1b);
+  EXPECT_EQ(pdus_[2].size(), kMtu);
+  EXPECT_EQ(queue_.stats().sent, 4u);
+}
+
+TEST_F(GattNotificationQueueTest, superseded_values) {
+  queue_.SetCongested(kCid, true);
+  Enqueue(0x0010, {0x01}, true);
+  Enqueue(0x0020, {0x02}, true);
+  Enqueue(0x0010, {0x03}, true);
+  // Applications that did not opt in have all their values sent
+  Enqueue(0x0020, {0x04}, false);
+  EXPECT_EQ(queue_.Depth(), 3u);
+
+  queue_.SetCongested(kCid, false);
+  EXPECT_EQ(Flush(true), GATT_SUCCESS);
+
+  ASSERT_EQ(pdus_.size(), 1u);
+  EXPECT_EQ(pdus_[0],
+            std::vector<uint8_t>({0x23, 0x10, 0x00, 0x01, 0x00, 0x03, 0x20,
+                                  0x00, 0x01, 0x00, 0x02, 0x20, 0x00, 0x01,
+                                  0x00, 0x04}));
+  EXPECT_EQ(queue_.stats().enqueued, 4u);
+  EXPECT_EQ(queue_.stats().superseded, 1u);
+}
+
+TEST_F(GattNotificationQueueTest, stops_on_congestion) {
+  queue_.SetCongested(kCid, true);
+  for (uint16_t handle = 1; handle <= 4; handle++) {
+    Enqueue(handle, std::vector<uint8_t>(15, 0x00));
+  }
+  queue_.SetCongested(kCid, false);
+
+  congest_after_ = 1;
+  EXPECT_EQ(Flush(true), GATT_CONGESTED);
+  EXPECT_EQ(pdus_.size(), 1u);
+  EXPECT_TRUE(queue_.IsCongested(kCid));
+  EXPECT_EQ(queue_.Depth(), 3u);
+  EXPECT_EQ(queue_.stats().congestions, 2u);
+
+  congest_after_ = SIZE_MAX;
+  queue_.SetCongested(kCid, false);
+  EXPECT_EQ(Flush(true), GATT_SUCCESS);
+  EXPECT_EQ(pdus_.size(), 4u);
+  EXPECT_EQ(queue_.Depth(), 0u);
+}
+
+TEST_F(GattNotificationQueueTest, pushes_back_when_full) {
+  queue_.SetCongested(kCid, true);
+  uint8_t value = 0;
+  for (size_t i = 0; i < GattNotificationQueue::kMaxQueued; i++) {
+    EXPECT_TRUE(queue_.Enqueue(kCid, i + 1, &value, 1, false));
+  }
+  EXPECT_FALSE(queue_.Enqueue(kCid, 0x0001, &value, 1, false));
+  EXPECT_EQ(queue_.stats().rejected, 1u);
+
+  // A superseding value takes no room of its own
+  EXPECT_TRUE(queue_.Enqueue(kCid, 0x0001, &value, 1, true));
+}
+
+TEST_F(GattNotificationQueueTest, bearer_removed) {
+  queue_.SetCongested(kCid, true);
+  Enqueue(0x0010, {0x01});
+  Enqueue(0x0020, {0x02});
+  queue_.RemoveBearer(kCid);
+
+  EXPECT_EQ(queue_.Depth(), 0u);
+  EXPECT_FALSE(queue_.IsCongested(kCid));
+  EXPECT_EQ(queue_.stats().dropped, 2u);
+}
+
+}  // namespace
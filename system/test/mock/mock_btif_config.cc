@@ -62,6 +62,8 @@ struct btif_config_get_bin btif_config_get_bin;
 struct btif_config_get_bin_length btif_config_get_bin_length;
 struct btif_config_set_bin btif_config_set_bin;
 struct btif_config_get_paired_devices btif_config_get_paired_devices;
+struct btif_config_get_paired_device_records
+    btif_config_get_paired_device_records;
 struct btif_config_remove btif_config_remove;
 struct btif_config_save btif_config_save;
 struct btif_config_flush btif_config_flush;
@@ -129,6 +131,10 @@ std::vector<RawAddress> btif_config_get_paired_devices() {
   mock_function_count_map[__func__]++;
   return test::mock::btif_config::btif_config_get_paired_devices();
 }
+std::vector<BtifBondedDeviceRecord> btif_config_get_paired_device_records() {
+  mock_function_count_map[__func__]++;
+  return test::mock::btif_config::btif_config_get_paired_device_records();
+}
 bool btif_config_remove(const std::string& section, const std::string& key) {
   mock_function_count_map[__func__]++;
   return test::mock::btif_config::btif_config_remove(section, key);
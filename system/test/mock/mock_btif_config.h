@@ -193,6 +193,17 @@ struct btif_config_get_paired_devices {
   std::vector<RawAddress> operator()() { return body(); };
 };
 extern struct btif_config_get_paired_devices btif_config_get_paired_devices;
+// Name: btif_config_get_paired_device_records
+// Params:
+// Returns: std::vector<BtifBondedDeviceRecord>
+struct btif_config_get_paired_device_records {
+  std::vector<BtifBondedDeviceRecord> records;
+  std::function<std::vector<BtifBondedDeviceRecord>()> body{
+      [this]() { return records; }};
+  std::vector<BtifBondedDeviceRecord> operator()() { return body(); };
+};
+extern struct btif_config_get_paired_device_records
+    btif_config_get_paired_device_records;
 // Name: btif_config_remove
 // Params: const std::string& section, const std::string& key
 // Returns: bool
@@ -0,0 +1,100 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Generated mock file from original source file
+ *   Functions generated:17
+ */
+
+#include <map>
+#include <string>
+
+extern std::map<std::string, int> mock_function_count_map;
+
+#include "common/audio_tick_scheduler.h"
+#include "common/message_loop_thread.h"
+
+#ifndef UNUSED_ATTR
+#define UNUSED_ATTR
+#endif
+
+using namespace bluetooth::common;
+
+constexpr uint64_t AudioTickStats::kLatenessBucketUpperUs[];
+
+AudioTickTimeline::AudioTickTimeline(uint64_t period_us,
+                                     size_t max_catch_up_ticks,
+                                     bool follow_reference)
+    : nominal_period_ns_(period_us * 1000),
+      period_ns_(period_us * 1000),
+      max_catch_up_ticks_(max_catch_up_ticks),
+      follow_reference_(follow_reference) {
+  mock_function_count_map[__func__]++;
+}
+void AudioTickTimeline::Start(uint64_t now_us) {
+  mock_function_count_map[__func__]++;
+}
+bool AudioTickTimeline::NextTick(uint64_t now_us, AudioTick* tick) {
+  mock_function_count_map[__func__]++;
+  return false;
+}
+void AudioTickTimeline::OnReferenceTimestamp(uint64_t now_us,
+                                             uint32_t reference_us) {
+  mock_function_count_map[__func__]++;
+}
+void AudioTickTimeline::RecordLateness(uint64_t lateness_us) {
+  mock_function_count_map[__func__]++;
+}
+void AudioTickTimeline::ResetDrift() { mock_function_count_map[__func__]++; }
+AudioTickScheduler::~AudioTickScheduler() {
+  mock_function_count_map[__func__]++;
+}
+bool AudioTickScheduler::Start(const base::WeakPtr<MessageLoopThread>& thread,
+                               const base::Location& from_here, Task task,
+                               base::TimeDelta period,
+                               const Options& options) {
+  mock_function_count_map[__func__]++;
+  return false;
+}
+void AudioTickScheduler::Cancel() { mock_function_count_map[__func__]++; }
+void AudioTickScheduler::CancelAndWait() {
+  mock_function_count_map[__func__]++;
+}
+bool AudioTickScheduler::IsScheduled() const {
+  mock_function_count_map[__func__]++;
+  return false;
+}
+void AudioTickScheduler::OnReferenceTimestamp(uint32_t reference_us) {
+  mock_function_count_map[__func__]++;
+}
+AudioTickStats AudioTickScheduler::GetStats() const {
+  mock_function_count_map[__func__]++;
+  return {};
+}
+void AudioTickScheduler::DebugDump(int fd) const {
+  mock_function_count_map[__func__]++;
+}
+void AudioTickScheduler::CancelHelper(std::promise<void> promise) {
+  mock_function_count_map[__func__]++;
+}
+void AudioTickScheduler::CancelClosure(std::promise<void> promise) {
+  mock_function_count_map[__func__]++;
+}
+bool AudioTickScheduler::ScheduleNextTick(const base::Location& from_here) {
+  mock_function_count_map[__func__]++;
+  return false;
+}
+void AudioTickScheduler::RunTask() { mock_function_count_map[__func__]++; }
@@ -36,6 +36,10 @@ MessageLoopThread::MessageLoopThread(const std::string& thread_name)
 
 MessageLoopThread::MessageLoopThread(const std::string& thread_name,
                                      bool is_main)
+    : MessageLoopThread(thread_name, is_main, Backend::kMessageLoop) {}
+
+MessageLoopThread::MessageLoopThread(const std::string& thread_name,
+                                     bool is_main, Backend backend)
     : thread_name_(thread_name),
       message_loop_(nullptr),
       run_loop_(nullptr),
@@ -45,6 +49,7 @@ MessageLoopThread::MessageLoopThread(const std::string& thread_name,
       weak_ptr_factory_(this),
       shutting_down_(false),
       is_main_(is_main),
+      backend_(backend),
       rust_thread_(nullptr) {}
 
 MessageLoopThread::~MessageLoopThread() { ShutDown(); }
@@ -0,0 +1,64 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Generated mock file from original source file
+ *   Functions generated:12
+ */
+
+#include <map>
+#include <string>
+
+extern std::map<std::string, int> mock_function_count_map;
+
+#include "common/task_queue.h"
+
+#ifndef UNUSED_ATTR
+#define UNUSED_ATTR
+#endif
+
+using namespace bluetooth::common;
+
+constexpr size_t TaskQueue::kDefaultMaxTasksPerDrain;
+
+TaskQueue::TaskQueue(size_t max_tasks_per_drain)
+    : max_tasks_per_drain_(max_tasks_per_drain),
+      head_(&stub_),
+      tail_(&stub_) {
+  mock_function_count_map[__func__]++;
+}
+TaskQueue::~TaskQueue() { mock_function_count_map[__func__]++; }
+void TaskQueue::Open(btbase::AbstractMessageLoop* message_loop) {
+  mock_function_count_map[__func__]++;
+}
+void TaskQueue::Close() { mock_function_count_map[__func__]++; }
+bool TaskQueue::TryPost(base::OnceClosure* task,
+                        const base::TimeDelta& delay) {
+  mock_function_count_map[__func__]++;
+  return false;
+}
+void TaskQueue::Enqueue(Node* node) { mock_function_count_map[__func__]++; }
+TaskQueue::Task* TaskQueue::Dequeue(bool* busy) {
+  mock_function_count_map[__func__]++;
+  return nullptr;
+}
+void TaskQueue::ScheduleDrain() { mock_function_count_map[__func__]++; }
+void TaskQueue::Drain() { mock_function_count_map[__func__]++; }
+void TaskQueue::RunDueTimers() { mock_function_count_map[__func__]++; }
+void TaskQueue::ArmTimer() { mock_function_count_map[__func__]++; }
+void TaskQueue::OnTimer(uint64_t deadline_us) {
+  mock_function_count_map[__func__]++;
+}
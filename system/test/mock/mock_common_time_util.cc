@@ -16,7 +16,7 @@
 
 /*
  * Generated mock file from original source file
- *   Functions generated:3
+ *   Functions generated:4
  */
 
 #include <map>
@@ -43,6 +43,10 @@ uint64_t time_get_os_boottime_us() {
   mock_function_count_map[__func__]++;
   return 0;
 }
+uint64_t time_get_os_monotonic_us() {
+  mock_function_count_map[__func__]++;
+  return 0;
+}
 uint64_t time_gettimeofday_us() {
   mock_function_count_map[__func__]++;
   return 0;
@@ -85,6 +85,11 @@ std::vector<std::string>
 bluetooth::shim::BtifConfigInterface::GetPersistentDevices() {
   return std::vector<std::string>();
 }
+std::vector<
+    std::pair<std::string, std::unordered_map<std::string, std::string>>>
+bluetooth::shim::BtifConfigInterface::GetPersistentDevicesWithProperties() {
+  return {};
+}
 void bluetooth::shim::BtifConfigInterface::
     ConvertEncryptOrDecryptKeyIfNeeded(){};
 void bluetooth::shim::BtifConfigInterface::Save(){};
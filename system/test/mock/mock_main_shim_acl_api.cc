@@ -16,7 +16,7 @@
 
 /*
  * Generated mock file from original source file
- *   Functions generated:5
+ *   Functions generated:6
  */
 
 #include <map>
@@ -60,6 +60,10 @@ void bluetooth::shim::ACL_ConfigureLePrivacy(bool is_le_privacy_enabled) {
 void bluetooth::shim::ACL_WriteData(uint16_t handle, BT_HDR* p_buf) {
   mock_function_count_map[__func__]++;
 }
+void bluetooth::shim::ACL_WriteSharedData(uint16_t handle,
+                                          const BT_HDR* p_buf) {
+  mock_function_count_map[__func__]++;
+}
 void bluetooth::shim::ACL_Disconnect(uint16_t handle, bool is_classic,
                                      tHCI_STATUS reason, std::string comment) {
   mock_function_count_map[__func__]++;
@@ -17,7 +17,7 @@
 
 /*
  * Generated mock file from original source file
- *   Functions generated:14
+ *   Functions generated:15
  *
  *  mockcify.pl ver 0.5.0
  */
@@ -220,6 +220,18 @@ struct ACL_WriteData {
 };
 extern struct ACL_WriteData ACL_WriteData;
 
+// Name: ACL_WriteSharedData
+// Params: uint16_t handle, const BT_HDR* p_buf
+// Return: void
+struct ACL_WriteSharedData {
+  std::function<void(uint16_t handle, const BT_HDR* p_buf)> body{
+      [](uint16_t handle, const BT_HDR* p_buf) {}};
+  void operator()(uint16_t handle, const BT_HDR* p_buf) {
+    body(handle, p_buf);
+  };
+};
+extern struct ACL_WriteSharedData ACL_WriteSharedData;
+
 }  // namespace main_shim_acl_api
 }  // namespace mock
 }  // namespace test
@@ -58,8 +58,12 @@ struct config_set_string config_set_string;
 struct config_set_uint64 config_set_uint64;
 struct config_t_Find config_t_Find;
 struct config_t_Has config_t_Has;
+struct config_t_Add config_t_Add;
+struct config_t_Erase config_t_Erase;
+struct config_t_Clear config_t_Clear;
 struct section_t_Find section_t_Find;
 struct section_t_Has section_t_Has;
+struct section_t_Erase section_t_Erase;
 struct section_t_Set section_t_Set;
 
 }  // namespace osi_config
@@ -163,6 +167,19 @@ bool config_t::Has(const std::string& key) {
   mock_function_count_map[__func__]++;
   return test::mock::osi_config::config_t_Has(key);
 }
+std::list<section_t>::iterator config_t::Add(section_t section) {
+  mock_function_count_map[__func__]++;
+  return test::mock::osi_config::config_t_Add(std::move(section));
+}
+std::list<section_t>::iterator config_t::Erase(
+    std::list<section_t>::iterator section) {
+  mock_function_count_map[__func__]++;
+  return test::mock::osi_config::config_t_Erase(section);
+}
+void config_t::Clear() {
+  mock_function_count_map[__func__]++;
+  test::mock::osi_config::config_t_Clear();
+}
 std::list<entry_t>::iterator section_t::Find(const std::string& key) {
   mock_function_count_map[__func__]++;
   return test::mock::osi_config::section_t_Find(key);
@@ -171,6 +188,11 @@ bool section_t::Has(const std::string& key) {
   mock_function_count_map[__func__]++;
   return test::mock::osi_config::section_t_Has(key);
 }
+std::list<entry_t>::iterator section_t::Erase(
+    std::list<entry_t>::iterator entry) {
+  mock_function_count_map[__func__]++;
+  return test::mock::osi_config::section_t_Erase(entry);
+}
 void section_t::Set(std::string key, std::string value) {
   mock_function_count_map[__func__]++;
   test::mock::osi_config::section_t_Set(key, value);
@@ -352,6 +352,45 @@ struct config_t_Has {
 };
 extern struct config_t_Has config_t_Has;
 
+// Name: config_t_Add
+// Params: section_t section
+// Return: std::list<section_t>::iterator
+struct config_t_Add {
+  std::list<section_t> section_;
+  std::function<std::list<section_t>::iterator(section_t section)> body{
+      [this](section_t section) { return section_.begin(); }};
+  std::list<section_t>::iterator operator()(section_t section) {
+    return body(std::move(section));
+  };
+};
+extern struct config_t_Add config_t_Add;
+
+// Name: config_t_Erase
+// Params: std::list<section_t>::iterator section
+// Return: std::list<section_t>::iterator
+struct config_t_Erase {
+  std::list<section_t> section_;
+  std::function<std::list<section_t>::iterator(
+      std::list<section_t>::iterator section)>
+      body{[this](std::list<section_t>::iterator section) {
+        return section_.begin();
+      }};
+  std::list<section_t>::iterator operator()(
+      std::list<section_t>::iterator section) {
+    return body(section);
+  };
+};
+extern struct config_t_Erase config_t_Erase;
+
+// Name: config_t_Clear
+// Params:
+// Return: void
+struct config_t_Clear {
+  std::function<void()> body{[]() {}};
+  void operator()() { body(); };
+};
+extern struct config_t_Clear config_t_Clear;
+
 // Name: section_t_Find
 // Params: const std::string& key
 // Return: std::list<entry_t>::iterator
@@ -376,6 +415,22 @@ struct section_t_Has {
 };
 extern struct section_t_Has section_t_Has;
 
+// Name: section_t_Erase
+// Params: std::list<entry_t>::iterator entry
+// Return: std::list<entry_t>::iterator
+struct section_t_Erase {
+  std::list<entry_t> list_;
+  std::function<std::list<entry_t>::iterator(
+      std::list<entry_t>::iterator entry)>
+      body{[this](std::list<entry_t>::iterator entry) {
+        return list_.begin();
+      }};
+  std::list<entry_t>::iterator operator()(std::list<entry_t>::iterator entry) {
+    return body(entry);
+  };
+};
+extern struct section_t_Erase section_t_Erase;
+
 // Name: section_t_Set
 // Params: std::string key, std::string value
 // Return: void
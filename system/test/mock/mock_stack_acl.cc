@@ -16,7 +16,7 @@
 
 /*
  * Generated mock file from original source file
- *   Functions generated:125
+ *   Functions generated:126
  *
  *  mockcify.pl ver 0.2.1
  */
@@ -63,6 +63,7 @@ struct acl_is_switch_role_idle acl_is_switch_role_idle;
 struct acl_peer_supports_ble_2m_phy acl_peer_supports_ble_2m_phy;
 struct acl_peer_supports_ble_coded_phy acl_peer_supports_ble_coded_phy;
 struct acl_send_data_packet_br_edr acl_send_data_packet_br_edr;
+struct acl_send_shared_data_packet_br_edr acl_send_shared_data_packet_br_edr;
 struct acl_peer_supports_ble_connection_parameters_request
     acl_peer_supports_ble_connection_parameters_request;
 struct acl_peer_supports_ble_packet_extension
@@ -294,6 +295,11 @@ void acl_send_data_packet_br_edr(const RawAddress& bd_addr, BT_HDR* p_buf) {
   mock_function_count_map[__func__]++;
   test::mock::stack_acl::acl_send_data_packet_br_edr(bd_addr, p_buf);
 }
+void acl_send_shared_data_packet_br_edr(const RawAddress& bd_addr,
+                                        const BT_HDR* p_buf) {
+  mock_function_count_map[__func__]++;
+  test::mock::stack_acl::acl_send_shared_data_packet_br_edr(bd_addr, p_buf);
+}
 void acl_create_classic_connection(const RawAddress& bd_addr,
                                    bool there_are_high_priority_channels,
                                    bool is_bonding) {
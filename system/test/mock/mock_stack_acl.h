@@ -16,7 +16,7 @@
 
 /*
  * Generated mock file from original source file
- *   Functions generated:125
+ *   Functions generated:126
  *
  *  mockcify.pl ver 0.2.1
  */
@@ -181,6 +181,18 @@ struct acl_send_data_packet_br_edr {
   };
 };
 extern struct acl_send_data_packet_br_edr acl_send_data_packet_br_edr;
+// Name: acl_send_shared_data_packet_br_edr
+// Params: const RawAddress& bd_addr, const BT_HDR* p_buf
+// Returns: void
+struct acl_send_shared_data_packet_br_edr {
+  std::function<void(const RawAddress& bd_addr, const BT_HDR* p_buf)> body{
+      [](const RawAddress& bd_addr, const BT_HDR* p_buf) {}};
+  void operator()(const RawAddress& bd_addr, const BT_HDR* p_buf) {
+    return body(bd_addr, p_buf);
+  };
+};
+extern struct acl_send_shared_data_packet_br_edr
+    acl_send_shared_data_packet_br_edr;
 // Name: acl_create_le_connection
 // Params: const RawAddress& bd_addr
 // Returns: bool
@@ -16,7 +16,7 @@
 
 /*
  * Generated mock file from original source file
- *   Functions generated:16
+ *   Functions generated:18
  */
 
 #include <map>
@@ -95,6 +95,13 @@ tBTM_SEC_DEV_REC* btm_sec_allocate_dev_rec(void) {
   mock_function_count_map[__func__]++;
   return nullptr;
 }
+void btm_sec_dev_rec_touch(tBTM_SEC_DEV_REC* p_dev_rec) {
+  mock_function_count_map[__func__]++;
+}
+void btm_sec_dev_rec_set_handle(tBTM_SEC_DEV_REC* p_dev_rec,
+                                tBT_TRANSPORT transport, uint16_t handle) {
+  mock_function_count_map[__func__]++;
+}
 tBTM_SEC_DEV_REC::tBTM_BOND_TYPE btm_get_bond_type_dev(
     const RawAddress& bd_addr) {
   mock_function_count_map[__func__]++;
@@ -48,10 +48,12 @@ struct GATTC_SendHandleValueConfirm GATTC_SendHandleValueConfirm;
 struct GATTC_Write GATTC_Write;
 struct GATTS_AddService GATTS_AddService;
 struct GATTS_DeleteService GATTS_DeleteService;
+struct GATTS_DumpNotificationStats GATTS_DumpNotificationStats;
 struct GATTS_HandleValueIndication GATTS_HandleValueIndication;
 struct GATTS_HandleValueNotification GATTS_HandleValueNotification;
 struct GATTS_NVRegister GATTS_NVRegister;
 struct GATTS_SendRsp GATTS_SendRsp;
+struct GATTS_SetNotificationSupersede GATTS_SetNotificationSupersede;
 struct GATTS_StopService GATTS_StopService;
 struct GATT_CancelConnect GATT_CancelConnect;
 struct GATT_Connect GATT_Connect;
@@ -140,6 +142,10 @@ bool GATTS_DeleteService(tGATT_IF gatt_if, Uuid* p_svc_uuid,
   return test::mock::stack_gatt_api::GATTS_DeleteService(gatt_if, p_svc_uuid,
                                                          svc_inst);
 }
+void GATTS_DumpNotificationStats(int fd) {
+  mock_function_count_map[__func__]++;
+  test::mock::stack_gatt_api::GATTS_DumpNotificationStats(fd);
+}
 tGATT_STATUS GATTS_HandleValueIndication(uint16_t conn_id, uint16_t attr_handle,
                                          uint16_t val_len, uint8_t* p_val) {
   mock_function_count_map[__func__]++;
@@ -163,6 +169,11 @@ tGATT_STATUS GATTS_SendRsp(uint16_t conn_id, uint32_t trans_id,
   return test::mock::stack_gatt_api::GATTS_SendRsp(conn_id, trans_id, status,
                                                    p_msg);
 }
+void GATTS_SetNotificationSupersede(tGATT_IF gatt_if, bool supersede) {
+  mock_function_count_map[__func__]++;
+  test::mock::stack_gatt_api::GATTS_SetNotificationSupersede(gatt_if,
+                                                             supersede);
+}
 void GATTS_StopService(uint16_t service_handle) {
   mock_function_count_map[__func__]++;
   test::mock::stack_gatt_api::GATTS_StopService(service_handle);
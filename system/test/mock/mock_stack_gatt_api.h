@@ -186,6 +186,15 @@ struct GATTS_DeleteService {
 };
 extern struct GATTS_DeleteService GATTS_DeleteService;
 
+// Name: GATTS_DumpNotificationStats
+// Params: int fd
+// Return: void
+struct GATTS_DumpNotificationStats {
+  std::function<void(int fd)> body{[](int fd) {}};
+  void operator()(int fd) { body(fd); };
+};
+extern struct GATTS_DumpNotificationStats GATTS_DumpNotificationStats;
+
 // Name: GATTS_HandleValueIndication
 // Params: uint16_t conn_id, uint16_t attr_handle, uint16_t val_len, uint8_t*
 // p_val Return: tGATT_STATUS
@@ -245,6 +254,18 @@ struct GATTS_SendRsp {
 };
 extern struct GATTS_SendRsp GATTS_SendRsp;
 
+// Name: GATTS_SetNotificationSupersede
+// Params: tGATT_IF gatt_if, bool supersede
+// Return: void
+struct GATTS_SetNotificationSupersede {
+  std::function<void(tGATT_IF gatt_if, bool supersede)> body{
+      [](tGATT_IF gatt_if, bool supersede) {}};
+  void operator()(tGATT_IF gatt_if, bool supersede) {
+    body(gatt_if, supersede);
+  };
+};
+extern struct GATTS_SetNotificationSupersede GATTS_SetNotificationSupersede;
+
 // Name: GATTS_StopService
 // Params: uint16_t service_handle
 // Return: void
@@ -49,6 +49,10 @@ bool gatt_sr_is_cl_change_aware(tGATT_TCB& tcb) {
   mock_function_count_map[__func__]++;
   return false;
 }
+bool gatt_sr_is_cl_multi_notif_supported(tGATT_TCB& tcb) {
+  mock_function_count_map[__func__]++;
+  return false;
+}
 tGATT_PROFILE_CLCB* gatt_profile_clcb_alloc(uint16_t conn_id,
                                             const RawAddress& bda,
                                             tBT_TRANSPORT tranport) {
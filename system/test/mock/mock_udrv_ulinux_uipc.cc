@@ -16,7 +16,7 @@
 
 /*
  * Generated mock file from original source file
- *   Functions generated:12
+ *   Functions generated:13
  */
 
 #include <cstdint>
@@ -59,6 +59,15 @@ uint32_t UIPC_Read(tUIPC_STATE& uipc, tUIPC_CH_ID ch_id, uint8_t* p_buf,
   mock_function_count_map[__func__]++;
   return 0;
 }
+const uint8_t* UIPC_AcquireRead(tUIPC_STATE& uipc, tUIPC_CH_ID ch_id,
+                                uint32_t len, uint32_t* p_len) {
+  mock_function_count_map[__func__]++;
+  *p_len = 0;
+  return nullptr;
+}
+void UIPC_ReleaseRead(tUIPC_STATE& uipc, tUIPC_CH_ID ch_id, uint32_t len) {
+  mock_function_count_map[__func__]++;
+}
 bool UIPC_Ioctl(tUIPC_STATE& uipc, tUIPC_CH_ID ch_id, uint32_t request,
                 void* param) {
   mock_function_count_map[__func__]++;
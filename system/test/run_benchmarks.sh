@@ -8,8 +8,21 @@
 #   $ ./test/run_benchmarks.sh bluetooth_benchmark_example
 
 known_benchmarks=(
+  bluetooth_benchmark_avrcp_browse
+  bluetooth_benchmark_bonded_devices
+  bluetooth_benchmark_bta_at_index
+  bluetooth_benchmark_g722_encode
+  bluetooth_benchmark_gatt_database
+  bluetooth_benchmark_gatt_notification_queue
+  bluetooth_benchmark_hh_uhid
+  bluetooth_benchmark_le_audio_configuration
+  bluetooth_benchmark_le_audio_set_configurations
+  bluetooth_benchmark_osi_config
+  bluetooth_benchmark_pan_tap
+  bluetooth_benchmark_sec_dev_rec
   bluetooth_benchmark_thread_performance
   bluetooth_benchmark_timer_performance
+  bluetooth_benchmark_uipc
 )
 
 usage() {
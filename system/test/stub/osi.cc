@@ -63,6 +63,25 @@ std::list<section_t>::iterator config_t::Find(const std::string& section) {
       sections.begin(), sections.end(),
       [&section](const section_t& sec) { return sec.name == section; });
 }
+std::list<entry_t>::iterator section_t::Erase(
+    std::list<entry_t>::iterator entry) {
+  mock_function_count_map[__func__]++;
+  return entries.erase(entry);
+}
+std::list<section_t>::iterator config_t::Add(section_t section) {
+  mock_function_count_map[__func__]++;
+  sections.emplace_back(std::move(section));
+  return std::prev(sections.end());
+}
+std::list<section_t>::iterator config_t::Erase(
+    std::list<section_t>::iterator section) {
+  mock_function_count_map[__func__]++;
+  return sections.erase(section);
+}
+void config_t::Clear() {
+  mock_function_count_map[__func__]++;
+  sections.clear();
+}
 
 bool checksum_save(const std::string& checksum, const std::string& filename) {
   mock_function_count_map[__func__]++;
@@ -0,0 +1,199 @@
+/******************************************************************************
+ *
+ *  Copyright 2022 The Android Open Source Project
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+#include <base/logging.h>
+#include <benchmark/benchmark.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <thread>
+
+#include "udrv/include/uipc_ring.h"
+
+using ::benchmark::State;
+
+namespace {
+
+// 20 ms of 48 kHz, 16 bit, stereo PCM: what the audio server writes per A2DP
+// tick.
+#define TICK_BYTES 3840
+#define RING_SIZE (32 * 1024)
+#define READ_POLL_MS 10
+
+uint64_t now_ns(clockid_t clock) {
+  struct timespec ts;
+  clock_gettime(clock, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+// Writes one tick of PCM every |tick_us| through |write_fn|, stamped with the
+// time it was written.
+void Produce(int ticks, int tick_us,
+             const std::function<void(const uint8_t*, uint32_t)>& write_fn) {
+  uint8_t pcm[TICK_BYTES];
+  memset(pcm, 0x55, sizeof(pcm));
+
+  struct timespec next;
+  clock_gettime(CLOCK_MONOTONIC, &next);
+  for (int i = 0; i < ticks; i++) {
+    next.tv_nsec += tick_us * 1000;
+    while (next.tv_nsec >= 1000000000) {
+      next.tv_nsec -= 1000000000;
+      next.tv_sec++;
+    }
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, nullptr);
+
+    uint64_t stamp = now_ns(CLOCK_MONOTONIC);
+    memcpy(pcm, &stamp, sizeof(stamp));
+    write_fn(pcm, sizeof(pcm));
+  }
+}
+
+// Reads one tick per benchmark iteration through |read_fn|, which returns the
+// write stamp of the tick, and reports how late and how irregularly the ticks
+// were delivered, and the CPU spent by both sides per tick.
+void Consume(State& state, const std::function<uint64_t()>& read_fn) {
+  double sum = 0, sum_sq = 0, max = 0;
+  uint64_t cpu_start = now_ns(CLOCK_PROCESS_CPUTIME_ID);
+
+  for (auto _ : state) {
+    uint64_t stamp = read_fn();
+    double latency_us = (now_ns(CLOCK_MONOTONIC) - stamp) / 1000.0;
+    sum += latency_us;
+    sum_sq += latency_us * latency_us;
+    max = std::max(max, latency_us);
+  }
+
+  double ticks = state.iterations();
+  double mean = sum / ticks;
+  state.counters["latency_us_mean"] = mean;
+  state.counters["latency_us_max"] = max;
+  state.counters["jitter_us"] =
+      std::sqrt(std::max(sum_sq / ticks - mean * mean, 0.0));
+  state.counters["cpu_us_per_tick"] =
+      (now_ns(CLOCK_PROCESS_CPUTIME_ID) - cpu_start) / 1000.0 / ticks;
+  state.SetBytesProcessed(state.iterations() * TICK_BYTES);
+}
+
+// The existing transport: the audio server writes to the socket and the media
+// task polls and receives into its buffer, as UIPC_Read() does.
+void BM_UipcSocket(State& state) {
+  int fds[2];
+  CHECK(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+
+  std::thread producer(Produce, state.max_iterations, state.range(0),
+                       [&](const uint8_t* p_buf, uint32_t len) {
+                         CHECK(send(fds[1], p_buf, len, 0) == (ssize_t)len);
+                       });
+
+  uint8_t buf[TICK_BYTES];
+  Consume(state, [&]() {
+    uint32_t n_read = 0;
+    while (n_read < TICK_BYTES) {
+      struct pollfd pfd = {.fd = fds[0], .events = POLLIN, .revents = 0};
+      poll(&pfd, 1, READ_POLL_MS);
+      ssize_t n = recv(fds[0], buf + n_read, TICK_BYTES - n_read, 0);
+      if (n > 0) n_read += n;
+    }
+    uint64_t stamp;
+    memcpy(&stamp, buf, sizeof(stamp));
+    return stamp;
+  });
+
+  producer.join();
+  close(fds[0]);
+  close(fds[1]);
+}
+BENCHMARK(BM_UipcSocket)
+    ->Arg(20000)
+    ->Iterations(250)
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+BENCHMARK(BM_UipcSocket)
+    ->Arg(2500)
+    ->Iterations(2000)
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+
+// The shared memory ring: the media task sleeps only while the ring is empty
+// and reads the PCM in place.
+void BM_UipcRing(State& state) {
+  int fds[2];
+  CHECK(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+
+  tUIPC_RING consumer_ring;
+  tUIPC_RING producer_ring;
+  CHECK(uipc_ring_create(consumer_ring, RING_SIZE));
+  CHECK(uipc_ring_send_setup(consumer_ring, fds[0]));
+  CHECK(uipc_ring_recv_setup(producer_ring, fds[1]));
+
+  std::thread producer(Produce, state.max_iterations, state.range(0),
+                       [&](const uint8_t* p_buf, uint32_t len) {
+                         CHECK(uipc_ring_write(producer_ring, p_buf, len) ==
+                               len);
+                       });
+
+  Consume(state, [&]() {
+    while (uipc_ring_wait(consumer_ring, TICK_BYTES, fds[0], READ_POLL_MS) !=
+           1) {
+    }
+    uint32_t len;
+    const uint8_t* p_data = uipc_ring_acquire(consumer_ring, &len);
+    uint64_t stamp;
+    memcpy(&stamp, p_data, sizeof(stamp));
+    benchmark::DoNotOptimize(p_data[TICK_BYTES - 1]);
+    uipc_ring_release(consumer_ring, TICK_BYTES);
+    return stamp;
+  });
+
+  producer.join();
+  uipc_ring_destroy(producer_ring);
+  uipc_ring_destroy(consumer_ring);
+  close(fds[0]);
+  close(fds[1]);
+}
+BENCHMARK(BM_UipcRing)
+    ->Arg(20000)
+    ->Iterations(250)
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+BENCHMARK(BM_UipcRing)
+    ->Arg(2500)
+    ->Iterations(2000)
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  // Disable LOG() output from libchrome
+  logging::LoggingSettings log_settings;
+  log_settings.logging_dest = logging::LoggingDestination::LOG_NONE;
+  CHECK(logging::InitLogging(log_settings)) << "Failed to set up logging";
+  ::benchmark::Initialize(&argc, argv);
+  if (::benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  ::benchmark::RunSpecifiedBenchmarks();
+}
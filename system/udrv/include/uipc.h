@@ -24,6 +24,7 @@
 #include <mutex>
 
 #include "stack/include/bt_hdr.h"
+#include "uipc_ring.h"
 
 #define UIPC_CH_ID_AV_CTRL 0
 #define UIPC_CH_ID_AV_AUDIO 1
@@ -51,6 +52,10 @@ typedef enum {
 #define UIPC_REQ_RX_FLUSH 1
 #define UIPC_REG_REMOVE_ACTIVE_READSET 3
 #define UIPC_SET_READ_POLL_TMO 4
+/* Carry data over a shared memory ring instead of the socket for the next
+ * client connecting to the channel. param is the ring size, 0 disables. Only
+ * supported on UIPC_CH_ID_AV_AUDIO. */
+#define UIPC_SET_SHM_RING 5
 
 typedef void(tUIPC_RCV_CBACK)(
     tUIPC_CH_ID ch_id,
@@ -67,6 +72,9 @@ typedef struct {
   int read_poll_tmo_ms;
   int task_evt_flags; /* event flags pending to be processed in read task */
   tUIPC_RCV_CBACK* cback;
+  uint32_t shm_ring_size; /* ring offered to new clients, 0 to use socket */
+  std::shared_ptr<tUIPC_RING> ring; /* set while the client uses the ring */
+  std::shared_ptr<tUIPC_RING> acquired_ring; /* held by the reader */
 } tUIPC_CHAN;
 
 struct tUIPC_STATE {
@@ -131,6 +139,29 @@ bool UIPC_Send(tUIPC_STATE& uipc, tUIPC_CH_ID ch_id, uint16_t msg_evt,
 uint32_t UIPC_Read(tUIPC_STATE& uipc, tUIPC_CH_ID ch_id, uint8_t* p_buf,
                    uint32_t len);
 
+/**
+ * Wait for data on a channel that uses a shared memory ring and access it
+ * without copying it. Every successful call must be followed by
+ * UIPC_ReleaseRead() before the next one.
+ *
+ * @param ch_id Channel ID
+ * @param len Bytes wanted; fewer may be available once the read poll timeout
+ *            expires
+ * @param p_len Set to the number of bytes available at the returned address
+ * @return pointer to the data, or nullptr if the channel doesn't use a ring
+ *         or got closed
+ */
+const uint8_t* UIPC_AcquireRead(tUIPC_STATE& uipc, tUIPC_CH_ID ch_id,
+                                uint32_t len, uint32_t* p_len);
+
+/**
+ * Consume data previously returned by UIPC_AcquireRead()
+ *
+ * @param ch_id Channel ID
+ * @param len Bytes consumed
+ */
+void UIPC_ReleaseRead(tUIPC_STATE& uipc, tUIPC_CH_ID ch_id, uint32_t len);
+
 /**
  * Control the UIPC parameter
  *
@@ -0,0 +1,143 @@
+/******************************************************************************
+ *
+ *  Copyright 2022 The Android Open Source Project
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+#ifndef UIPC_RING_H
+#define UIPC_RING_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+
+/*
+ * Single producer, single consumer byte ring shared between the audio server
+ * (producer) and the stack (consumer) to carry PCM on a UIPC data channel.
+ *
+ * The stack creates the ring when a client connects to a channel that has
+ * UIPC_SET_SHM_RING enabled, then sends a tUIPC_RING_SETUP message over the
+ * channel socket with the memfd of the ring and an eventfd attached as
+ * SCM_RIGHTS. The client maps the ring with uipc_ring_attach() and writes
+ * PCM with uipc_ring_write() from then on. The socket is kept open so that
+ * both sides still detect when the other one goes away.
+ *
+ * The data area is mapped twice back to back, so any readable or writable
+ * region of the ring is contiguous in memory. The consumer only has to sleep
+ * when the ring is empty; the producer signals the eventfd only when the
+ * consumer said it was about to sleep.
+ */
+
+#define UIPC_RING_MAGIC 0x55495052 /* "UIPR" */
+#define UIPC_RING_VERSION 1
+
+/* Layout of the shared header at the start of the ring memfd */
+typedef struct {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t size; /* size of the data area, a multiple of the page size */
+  uint32_t data_offset;
+
+  /* free running positions, only ever written by their owning side */
+  alignas(64) std::atomic<uint32_t> write_pos;
+  alignas(64) std::atomic<uint32_t> read_pos;
+  std::atomic<uint32_t> reader_waiting;
+} tUIPC_RING_SHM;
+
+/* Message sent over the channel socket along with the ring file descriptors */
+typedef struct {
+  uint32_t magic;
+  uint32_t size;
+} tUIPC_RING_SETUP;
+
+typedef struct {
+  int mem_fd;
+  int event_fd;
+  uint32_t size;
+  size_t map_len;
+  tUIPC_RING_SHM* shm;
+  uint8_t* data; /* 2 * size bytes, the second half mirrors the first */
+} tUIPC_RING;
+
+/**
+ * Create a ring of at least |size| bytes. Used by the consumer side.
+ *
+ * @return true on success, otherwise false
+ */
+bool uipc_ring_create(tUIPC_RING& ring, uint32_t size);
+
+/**
+ * Map a ring created by the other side. Takes ownership of both descriptors.
+ *
+ * @return true on success, otherwise false
+ */
+bool uipc_ring_attach(tUIPC_RING& ring, int mem_fd, int event_fd);
+
+/**
+ * Unmap the ring and close its descriptors
+ */
+void uipc_ring_destroy(tUIPC_RING& ring);
+
+/**
+ * Send the ring descriptors to the peer connected on |sock_fd|
+ *
+ * @return true on success, otherwise false
+ */
+bool uipc_ring_send_setup(const tUIPC_RING& ring, int sock_fd);
+
+/**
+ * Receive the ring descriptors sent by uipc_ring_send_setup() and attach to
+ * the ring. Used by the producer side.
+ *
+ * @return true on success, otherwise false
+ */
+bool uipc_ring_recv_setup(tUIPC_RING& ring, int sock_fd);
+
+/**
+ * Copy up to |len| bytes into the ring and wake the consumer if it sleeps.
+ *
+ * @return the number of bytes written
+ */
+uint32_t uipc_ring_write(tUIPC_RING& ring, const uint8_t* p_buf, uint32_t len);
+
+/**
+ * Get the readable part of the ring without copying it
+ *
+ * @param p_len set to the number of readable bytes
+ * @return pointer to the first readable byte
+ */
+const uint8_t* uipc_ring_acquire(tUIPC_RING& ring, uint32_t* p_len);
+
+/**
+ * Give back |len| bytes previously returned by uipc_ring_acquire()
+ */
+void uipc_ring_release(tUIPC_RING& ring, uint32_t len);
+
+/**
+ * Drop everything currently readable
+ */
+void uipc_ring_flush(tUIPC_RING& ring);
+
+/**
+ * Wait until at least |len| bytes are readable
+ *
+ * @param hangup_fd socket of the channel, watched for the peer going away
+ * @param timeout_ms how long to wait
+ * @return 1 if the data is available, 0 on timeout, -1 if the peer is gone
+ */
+int uipc_ring_wait(tUIPC_RING& ring, uint32_t len, int hangup_fd,
+                   int timeout_ms);
+
+#endif /* UIPC_RING_H */
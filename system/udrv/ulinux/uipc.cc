@@ -38,6 +38,7 @@
 #include <sys/stat.h>
 #include <sys/un.h>
 #include <unistd.h>
+#include <algorithm>
 #include <mutex>
 #include <set>
 
@@ -182,7 +183,6 @@ static int uipc_main_init(tUIPC_STATE& uipc) {
   memset(&uipc.read_set, 0, sizeof(uipc.read_set));
   uipc.max_fd = 0;
   memset(&uipc.signal_fds, 0, sizeof(uipc.signal_fds));
-  memset(&uipc.ch, 0, sizeof(uipc.ch));
 
   /* setup interrupt socket pair */
   if (socketpair(AF_UNIX, SOCK_STREAM, 0, uipc.signal_fds) < 0) {
@@ -196,8 +196,12 @@ static int uipc_main_init(tUIPC_STATE& uipc) {
     tUIPC_CHAN* p = &uipc.ch[i];
     p->srvfd = UIPC_DISCONNECTED;
     p->fd = UIPC_DISCONNECTED;
+    p->read_poll_tmo_ms = 0;
     p->task_evt_flags = 0;
     p->cback = NULL;
+    p->shm_ring_size = 0;
+    p->ring.reset();
+    p->acquired_ring.reset();
   }
 
   return 0;
@@ -229,6 +233,29 @@ static void uipc_check_task_flags_locked(tUIPC_STATE& uipc) {
   }
 }
 
+/* hand a new shared memory ring over to the client that just connected */
+static void uipc_setup_ring_locked(tUIPC_STATE& uipc, tUIPC_CH_ID ch_id) {
+  std::shared_ptr<tUIPC_RING> ring(new tUIPC_RING, [](tUIPC_RING* r) {
+    uipc_ring_destroy(*r);
+    delete r;
+  });
+
+  if (!uipc_ring_create(*ring, uipc.ch[ch_id].shm_ring_size) ||
+      !uipc_ring_send_setup(*ring, uipc.ch[ch_id].fd)) {
+    LOG_ERROR("CH %d : unable to set up ring, using socket", ch_id);
+    return;
+  }
+
+  LOG_DEBUG("CH %d : using ring of %u bytes", ch_id, ring->size);
+  uipc.ch[ch_id].ring = std::move(ring);
+}
+
+static std::shared_ptr<tUIPC_RING> uipc_get_ring(tUIPC_STATE& uipc,
+                                                 tUIPC_CH_ID ch_id) {
+  std::lock_guard<std::recursive_mutex> lock(uipc.mutex);
+  return uipc.ch[ch_id].ring;
+}
+
 static int uipc_check_fd_locked(tUIPC_STATE& uipc, tUIPC_CH_ID ch_id) {
   if (ch_id >= UIPC_CH_NUM) return -1;
 
@@ -241,10 +268,15 @@ static int uipc_check_fd_locked(tUIPC_STATE& uipc, tUIPC_CH_ID ch_id) {
       close(uipc.ch[ch_id].fd);
       FD_CLR(uipc.ch[ch_id].fd, &uipc.active_set);
       uipc.ch[ch_id].fd = UIPC_DISCONNECTED;
+      uipc.ch[ch_id].ring.reset();
     }
 
     uipc.ch[ch_id].fd = accept_server_socket(uipc.ch[ch_id].srvfd);
 
+    if ((uipc.ch[ch_id].fd >= 0) && uipc.ch[ch_id].shm_ring_size) {
+      uipc_setup_ring_locked(uipc, ch_id);
+    }
+
     LOG_DEBUG("NEW FD %d", uipc.ch[ch_id].fd);
 
     if ((uipc.ch[ch_id].fd >= 0) && uipc.ch[ch_id].cback) {
@@ -321,6 +353,11 @@ static void uipc_flush_ch_locked(tUIPC_STATE& uipc, tUIPC_CH_ID ch_id) {
   char buf[UIPC_FLUSH_BUFFER_SIZE];
   struct pollfd pfd;
 
+  if (uipc.ch[ch_id].ring) {
+    uipc_ring_flush(*uipc.ch[ch_id].ring);
+    return;
+  }
+
   pfd.events = POLLIN;
   pfd.fd = uipc.ch[ch_id].fd;
 
@@ -388,6 +425,7 @@ static int uipc_close_ch_locked(tUIPC_STATE& uipc, tUIPC_CH_ID ch_id) {
     close(uipc.ch[ch_id].fd);
     FD_CLR(uipc.ch[ch_id].fd, &uipc.active_set);
     uipc.ch[ch_id].fd = UIPC_DISCONNECTED;
+    uipc.ch[ch_id].ring.reset();
     wakeup = 1;
   }
 
@@ -619,6 +657,17 @@ uint32_t UIPC_Read(tUIPC_STATE& uipc, tUIPC_CH_ID ch_id, uint8_t* p_buf,
     return 0;
   }
 
+  if (uipc_get_ring(uipc, ch_id)) {
+    uint32_t avail = 0;
+    const uint8_t* p_data = UIPC_AcquireRead(uipc, ch_id, len, &avail);
+    if (p_data == nullptr) return 0;
+
+    n_read = std::min(avail, len);
+    memcpy(p_buf, p_data, n_read);
+    UIPC_ReleaseRead(uipc, ch_id, n_read);
+    return n_read;
+  }
+
   while (n_read < (int)len) {
     pfd.fd = fd;
     pfd.events = POLLIN | POLLHUP;
@@ -666,6 +715,63 @@ uint32_t UIPC_Read(tUIPC_STATE& uipc, tUIPC_CH_ID ch_id, uint8_t* p_buf,
   return n_read;
 }
 
+/*******************************************************************************
+ *
+ * Function         UIPC_AcquireRead
+ *
+ * Description      Called to access data of a shared memory ring channel
+ *                  without copying it.
+ *
+ * Returns          pointer to the data, nullptr if there is no ring.
+ *
+ ******************************************************************************/
+
+const uint8_t* UIPC_AcquireRead(tUIPC_STATE& uipc, tUIPC_CH_ID ch_id,
+                                uint32_t len, uint32_t* p_len) {
+  *p_len = 0;
+  if (ch_id >= UIPC_CH_NUM) {
+    LOG_ERROR("UIPC_AcquireRead : invalid ch id %d", ch_id);
+    return nullptr;
+  }
+
+  std::shared_ptr<tUIPC_RING> ring = uipc_get_ring(uipc, ch_id);
+  if (!ring) return nullptr;
+
+  int ret = uipc_ring_wait(*ring, len, uipc.ch[ch_id].fd,
+                           uipc.ch[ch_id].read_poll_tmo_ms);
+  if (ret < 0) {
+    std::lock_guard<std::recursive_mutex> lock(uipc.mutex);
+    uipc_close_locked(uipc, ch_id);
+    return nullptr;
+  }
+  if (ret == 0) {
+    LOG_WARN("ring timeout (%d ms)", uipc.ch[ch_id].read_poll_tmo_ms);
+  }
+
+  /* keep the ring mapped until the data is released, even if the channel
+   * gets closed in the meantime */
+  const uint8_t* p_data = uipc_ring_acquire(*ring, p_len);
+  uipc.ch[ch_id].acquired_ring = std::move(ring);
+  return p_data;
+}
+
+/*******************************************************************************
+ *
+ * Function         UIPC_ReleaseRead
+ *
+ * Description      Called to consume data returned by UIPC_AcquireRead.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+
+void UIPC_ReleaseRead(tUIPC_STATE& uipc, tUIPC_CH_ID ch_id, uint32_t len) {
+  if (ch_id >= UIPC_CH_NUM) return;
+
+  std::shared_ptr<tUIPC_RING> ring = std::move(uipc.ch[ch_id].acquired_ring);
+  if (ring) uipc_ring_release(*ring, len);
+}
+
 /*******************************************************************************
  *
  * Function         UIPC_Ioctl
@@ -703,6 +809,16 @@ extern bool UIPC_Ioctl(tUIPC_STATE& uipc, tUIPC_CH_ID ch_id, uint32_t request,
                 uipc.ch[ch_id].read_poll_tmo_ms);
       break;
 
+    case UIPC_SET_SHM_RING:
+      if (ch_id != UIPC_CH_ID_AV_AUDIO) {
+        LOG_WARN("UIPC_SET_SHM_RING : not supported on CH %d", ch_id);
+        break;
+      }
+      uipc.ch[ch_id].shm_ring_size = (intptr_t)param;
+      LOG_DEBUG("UIPC_SET_SHM_RING : CH %d, %u bytes", ch_id,
+                uipc.ch[ch_id].shm_ring_size);
+      break;
+
     default:
       LOG_DEBUG("UIPC_Ioctl : request not handled (%d)", request);
       break;
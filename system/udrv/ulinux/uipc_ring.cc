@@ -0,0 +1,355 @@
+/******************************************************************************
+ *
+ *  Copyright 2022 The Android Open Source Project
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+/*****************************************************************************
+ *
+ *  Filename:      uipc_ring.cc
+ *
+ *  Description:   Shared memory ring transport for UIPC data channels
+ *
+ *****************************************************************************/
+
+#include "uipc_ring.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "osi/include/log.h"
+#include "osi/include/osi.h"
+
+/*****************************************************************************
+ *  Constants & Macros
+ *****************************************************************************/
+
+#define UIPC_RING_NUM_FDS 2
+
+/*****************************************************************************
+ *   Helper functions
+ *****************************************************************************/
+
+static size_t uipc_ring_header_len() {
+  size_t page_size = sysconf(_SC_PAGESIZE);
+  return (sizeof(tUIPC_RING_SHM) + page_size - 1) & ~(page_size - 1);
+}
+
+static bool uipc_ring_valid_size(uint32_t size) {
+  size_t page_size = sysconf(_SC_PAGESIZE);
+  return size >= page_size && (size & (size - 1)) == 0;
+}
+
+static uint32_t uipc_ring_readable(const tUIPC_RING& ring) {
+  uint32_t w = ring.shm->write_pos.load(std::memory_order_acquire);
+  uint32_t r = ring.shm->read_pos.load(std::memory_order_relaxed);
+  /* the producer owns write_pos, never trust it to stay within the ring */
+  return std::min(w - r, ring.size);
+}
+
+static int64_t uipc_ring_now_ms() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/* Map the header followed by the data area twice, so that reads and writes
+ * that wrap around the end of the ring are still contiguous. */
+static bool uipc_ring_map(tUIPC_RING& ring, int mem_fd, uint32_t size) {
+  size_t hdr_len = uipc_ring_header_len();
+  size_t map_len = hdr_len + 2 * (size_t)size;
+
+  void* base =
+      mmap(NULL, map_len, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (base == MAP_FAILED) {
+    LOG_ERROR("failed to reserve ring mapping (%s)", strerror(errno));
+    return false;
+  }
+
+  uint8_t* p = (uint8_t*)base;
+  if (mmap(p, hdr_len + size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED,
+           mem_fd, 0) == MAP_FAILED ||
+      mmap(p + hdr_len + size, size, PROT_READ | PROT_WRITE,
+           MAP_SHARED | MAP_FIXED, mem_fd, hdr_len) == MAP_FAILED) {
+    LOG_ERROR("failed to map ring (%s)", strerror(errno));
+    munmap(base, map_len);
+    return false;
+  }
+
+  ring.mem_fd = mem_fd;
+  ring.size = size;
+  ring.map_len = map_len;
+  ring.shm = (tUIPC_RING_SHM*)p;
+  ring.data = p + hdr_len;
+  return true;
+}
+
+/*****************************************************************************
+ *
+ *   ring setup
+ *
+ ****************************************************************************/
+
+bool uipc_ring_create(tUIPC_RING& ring, uint32_t size) {
+  size_t page_size = sysconf(_SC_PAGESIZE);
+  uint32_t ring_size = page_size;
+  while (ring_size < size) ring_size <<= 1;
+
+  memset(&ring, 0, sizeof(ring));
+  ring.mem_fd = -1;
+  ring.event_fd = -1;
+
+  int mem_fd = memfd_create("uipc_ring", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+  if (mem_fd < 0) {
+    LOG_ERROR("memfd_create failed (%s)", strerror(errno));
+    return false;
+  }
+
+  /* the client must not be able to resize the ring under our feet */
+  if (ftruncate(mem_fd, uipc_ring_header_len() + ring_size) < 0 ||
+      fcntl(mem_fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) <
+          0) {
+    LOG_ERROR("failed to size ring (%s)", strerror(errno));
+    close(mem_fd);
+    return false;
+  }
+
+  if (!uipc_ring_map(ring, mem_fd, ring_size)) {
+    close(mem_fd);
+    return false;
+  }
+
+  ring.event_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+  if (ring.event_fd < 0) {
+    LOG_ERROR("eventfd failed (%s)", strerror(errno));
+    uipc_ring_destroy(ring);
+    return false;
+  }
+
+  ring.shm->magic = UIPC_RING_MAGIC;
+  ring.shm->version = UIPC_RING_VERSION;
+  ring.shm->size = ring_size;
+  ring.shm->data_offset = uipc_ring_header_len();
+  ring.shm->write_pos.store(0);
+  ring.shm->read_pos.store(0);
+  ring.shm->reader_waiting.store(0);
+
+  LOG_DEBUG("created ring of %u bytes", ring_size);
+  return true;
+}
+
+bool uipc_ring_attach(tUIPC_RING& ring, int mem_fd, int event_fd) {
+  memset(&ring, 0, sizeof(ring));
+  ring.mem_fd = -1;
+  ring.event_fd = -1;
+
+  struct stat st;
+  if (fstat(mem_fd, &st) < 0 || st.st_size < (off_t)uipc_ring_header_len()) {
+    LOG_ERROR("invalid ring descriptor");
+    close(mem_fd);
+    close(event_fd);
+    return false;
+  }
+
+  uint32_t size = st.st_size - uipc_ring_header_len();
+  if (!uipc_ring_valid_size(size) || !uipc_ring_map(ring, mem_fd, size)) {
+    LOG_ERROR("unable to attach ring of %u bytes", size);
+    close(mem_fd);
+    close(event_fd);
+    return false;
+  }
+
+  if (ring.shm->magic != UIPC_RING_MAGIC ||
+      ring.shm->version != UIPC_RING_VERSION || ring.shm->size != size) {
+    LOG_ERROR("ring header mismatch");
+    ring.event_fd = event_fd;
+    uipc_ring_destroy(ring);
+    return false;
+  }
+
+  ring.event_fd = event_fd;
+  return true;
+}
+
+void uipc_ring_destroy(tUIPC_RING& ring) {
+  if (ring.shm != NULL) munmap(ring.shm, ring.map_len);
+  if (ring.mem_fd >= 0) close(ring.mem_fd);
+  if (ring.event_fd >= 0) close(ring.event_fd);
+
+  memset(&ring, 0, sizeof(ring));
+  ring.mem_fd = -1;
+  ring.event_fd = -1;
+}
+
+bool uipc_ring_send_setup(const tUIPC_RING& ring, int sock_fd) {
+  tUIPC_RING_SETUP setup = {.magic = UIPC_RING_MAGIC, .size = ring.size};
+  struct iovec iov = {.iov_base = &setup, .iov_len = sizeof(setup)};
+  char control[CMSG_SPACE(sizeof(int) * UIPC_RING_NUM_FDS)];
+  memset(control, 0, sizeof(control));
+
+  struct msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+
+  struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_RIGHTS;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(int) * UIPC_RING_NUM_FDS);
+  int fds[UIPC_RING_NUM_FDS] = {ring.mem_fd, ring.event_fd};
+  memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+
+  ssize_t ret;
+  OSI_NO_INTR(ret = sendmsg(sock_fd, &msg, MSG_NOSIGNAL));
+  if (ret != sizeof(setup)) {
+    LOG_ERROR("failed to send ring setup (%s)", strerror(errno));
+    return false;
+  }
+  return true;
+}
+
+bool uipc_ring_recv_setup(tUIPC_RING& ring, int sock_fd) {
+  tUIPC_RING_SETUP setup;
+  struct iovec iov = {.iov_base = &setup, .iov_len = sizeof(setup)};
+  char control[CMSG_SPACE(sizeof(int) * UIPC_RING_NUM_FDS)];
+
+  struct msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+
+  ssize_t ret;
+  OSI_NO_INTR(ret = recvmsg(sock_fd, &msg, MSG_WAITALL | MSG_CMSG_CLOEXEC));
+
+  struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+  if (ret != sizeof(setup) || cmsg == NULL || cmsg->cmsg_level != SOL_SOCKET ||
+      cmsg->cmsg_type != SCM_RIGHTS ||
+      cmsg->cmsg_len != CMSG_LEN(sizeof(int) * UIPC_RING_NUM_FDS)) {
+    LOG_ERROR("invalid ring setup message");
+    return false;
+  }
+
+  int fds[UIPC_RING_NUM_FDS];
+  memcpy(fds, CMSG_DATA(cmsg), sizeof(fds));
+  if (setup.magic != UIPC_RING_MAGIC) {
+    close(fds[0]);
+    close(fds[1]);
+    return false;
+  }
+  return uipc_ring_attach(ring, fds[0], fds[1]);
+}
+
+/*****************************************************************************
+ *
+ *   producer
+ *
+ ****************************************************************************/
+
+uint32_t uipc_ring_write(tUIPC_RING& ring, const uint8_t* p_buf,
+                         uint32_t len) {
+  uint32_t w = ring.shm->write_pos.load(std::memory_order_relaxed);
+  uint32_t r = ring.shm->read_pos.load(std::memory_order_acquire);
+  uint32_t n = std::min(len, ring.size - std::min(w - r, ring.size));
+  if (n == 0) return 0;
+
+  memcpy(ring.data + (w & (ring.size - 1)), p_buf, n);
+  ring.shm->write_pos.store(w + n, std::memory_order_seq_cst);
+
+  /* pairs with the store of reader_waiting in uipc_ring_wait() */
+  if (ring.shm->reader_waiting.load(std::memory_order_seq_cst)) {
+    uint64_t one = 1;
+    ssize_t ret;
+    OSI_NO_INTR(ret = write(ring.event_fd, &one, sizeof(one)));
+    if (ret < 0 && errno != EAGAIN) {
+      LOG_WARN("failed to signal ring (%s)", strerror(errno));
+    }
+  }
+  return n;
+}
+
+/*****************************************************************************
+ *
+ *   consumer
+ *
+ ****************************************************************************/
+
+const uint8_t* uipc_ring_acquire(tUIPC_RING& ring, uint32_t* p_len) {
+  uint32_t r = ring.shm->read_pos.load(std::memory_order_relaxed);
+  *p_len = uipc_ring_readable(ring);
+  return ring.data + (r & (ring.size - 1));
+}
+
+void uipc_ring_release(tUIPC_RING& ring, uint32_t len) {
+  len = std::min(len, uipc_ring_readable(ring));
+  uint32_t r = ring.shm->read_pos.load(std::memory_order_relaxed);
+  ring.shm->read_pos.store(r + len, std::memory_order_release);
+}
+
+void uipc_ring_flush(tUIPC_RING& ring) {
+  uipc_ring_release(ring, ring.size);
+}
+
+int uipc_ring_wait(tUIPC_RING& ring, uint32_t len, int hangup_fd,
+                   int timeout_ms) {
+  len = std::min(len, ring.size);
+  int64_t deadline = uipc_ring_now_ms() + timeout_ms;
+
+  while (uipc_ring_readable(ring) < len) {
+    /* tell the producer to signal us, then check again so that a write that
+     * raced with the store above isn't missed */
+    ring.shm->reader_waiting.store(1, std::memory_order_seq_cst);
+    if (uipc_ring_readable(ring) >= len) break;
+
+    int remaining = std::max<int64_t>(deadline - uipc_ring_now_ms(), 0);
+    struct pollfd pfd[2] = {
+        {.fd = ring.event_fd, .events = POLLIN, .revents = 0},
+        {.fd = hangup_fd, .events = 0, .revents = 0},
+    };
+    int ret;
+    OSI_NO_INTR(ret = poll(pfd, 2, remaining));
+    ring.shm->reader_waiting.store(0, std::memory_order_relaxed);
+
+    if (ret < 0) {
+      LOG_ERROR("%s(): poll() failed (%s)", __func__, strerror(errno));
+      return -1;
+    }
+    if (pfd[1].revents & (POLLHUP | POLLERR | POLLNVAL)) {
+      LOG_WARN("ring : channel detached remotely");
+      return -1;
+    }
+    if (pfd[0].revents & POLLIN) {
+      uint64_t count;
+      (void)read(ring.event_fd, &count, sizeof(count));
+    }
+    if (ret == 0) return uipc_ring_readable(ring) >= len ? 1 : 0;
+  }
+
+  ring.shm->reader_waiting.store(0, std::memory_order_relaxed);
+  return 1;
+}